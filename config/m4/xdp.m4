@@ -0,0 +1,76 @@
+#
+# Copyright © 2001-2023 NVIDIA CORPORATION & AFFILIATES. ALL RIGHTS RESERVED.
+#
+# This software is available to you under a choice of one of two
+# licenses.  You may choose to be licensed under the terms of the GNU
+# General Public License (GPL) Version 2, available from the file
+# COPYING in the main directory of this source tree, or the
+# BSD license below:
+#
+#     Redistribution and use in source and binary forms, with or
+#     without modification, are permitted provided that the following
+#     conditions are met:
+#
+#      - Redistributions of source code must retain the above
+#        copyright notice, this list of conditions and the following
+#        disclaimer.
+#
+#      - Redistributions in binary form must reproduce the above
+#        copyright notice, this list of conditions and the following
+#        disclaimer in the documentation and/or other materials
+#        provided with the distribution.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+# NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+# BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+# ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+# CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+#
+
+# xdp.m4 - AF_XDP ring support
+#
+
+##########################
+# AF_XDP support
+#
+AC_DEFUN([XDP_CAPABILITY_SETUP],
+[
+AC_ARG_ENABLE([xdp],
+    AS_HELP_STRING([--enable-xdp],
+                   [Enable AF_XDP ring support (default=auto)]),
+    [],
+    [enable_xdp=auto]
+)
+
+prj_cv_xdp=0
+AS_IF([test "x$enable_xdp" != xno],
+    [
+    AC_CHECK_HEADER(
+        [linux/if_xdp.h],
+        [AC_LINK_IFELSE([AC_LANG_PROGRAM([[#include <linux/if_xdp.h>
+                                           #include <linux/bpf.h>
+                                           #include <linux/if_link.h>]],
+             [[struct xdp_umem_reg reg;
+               union bpf_attr attr;
+               int flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG | XDP_USE_NEED_WAKEUP;
+               int type = BPF_MAP_TYPE_XSKMAP;
+               int mode = XDP_FLAGS_SKB_MODE;
+               attr.link_create.attach_type = BPF_XDP;
+               (void)reg; (void)attr; (void)flags; (void)type; (void)mode;]])],
+             [prj_cv_xdp=1])
+        ])
+    ])
+
+AC_MSG_CHECKING([for AF_XDP support])
+if test "$prj_cv_xdp" -ne 0; then
+    AC_DEFINE_UNQUOTED([DEFINED_XDP], [1], [Define to 1 to enable AF_XDP ring])
+    AC_MSG_RESULT([yes])
+else
+    AS_IF([test "x$enable_xdp" == xyes],
+        [AC_MSG_ERROR([AF_XDP support requested but linux/if_xdp.h or linux/bpf.h not found])],
+        [AC_MSG_RESULT([no])])
+fi
+])
@@ -0,0 +1,25 @@
+BULK_CLIENT_MHOST="vma-nolo05 r-aa-fatty01"
+BULK_SERVER_MHOST=vma-nolo06
+BULK_SERVER_DHOST=163.2.0.6
+
+BULK_TYPE="cps"
+BULK_PROTOS="http"
+BULK_THREADS="32"
+BULK_PAYLOADS="0B"
+BULK_CONNECTIONS="2400"
+BULK_STEP_DURATION="60"
+BULK_TLS_MODE="sw"
+
+# TCP Fast Open client instead of wrk: compare latency_mean_us in
+# client-*/wrk.out.json against the same plan with BULK_TFO=off (plain connect),
+# the difference is one RTT per connection
+BULK_TFO=on
+BULK_TFO_QLEN=4096
+
+# BULK_ENV_LIST as multiline string
+read -r -d '' BULK_ENV_LIST << 'EOF' || true
+# mode  proto   payload threads connections host         env
+*       *       *       *       *           vma-nolo05   default-x86
+*       *       *       *       *           vma-nolo06   default-x86
+*       *       *       *       *           r-aa-fatty01 default-x86
+EOF
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# Connections-per-second client for TCP Fast Open.
+# Every connection sends one HTTP request with 'Connection: close' and reads the
+# response until the peer closes. With --tfo the request goes out in the SYN via
+# MSG_FASTOPEN, so once the cookie is cached a connection costs one RTT less.
+# The summary is printed in the wrk json_report format plus the mean connection
+# latency, so the report tools can consume it unchanged.
+import argparse
+import json
+import multiprocessing
+import socket
+import threading
+import time
+
+
+def connection_loop(args, deadline, stats, lock):
+    addr = (args.host, args.port)
+    request = ("GET /%s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n"
+               % (args.path, args.host)).encode()
+    requests = 0
+    nbytes = 0
+    latency = 0.0
+    errors = {"connect": 0, "read": 0, "write": 0, "status": 0, "timeout": 0}
+
+    while time.monotonic() < deadline:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        start = time.monotonic()
+        try:
+            try:
+                if args.tfo:
+                    # blocking: a non-blocking MSG_FASTOPEN without a cookie fails
+                    # with EINPROGRESS instead of sending the data after the handshake
+                    sock.sendto(request, socket.MSG_FASTOPEN, addr)
+                    sock.settimeout(args.timeout)
+                else:
+                    sock.settimeout(args.timeout)
+                    sock.connect(addr)
+            except socket.timeout:
+                errors["timeout"] += 1
+                continue
+            except OSError:
+                errors["connect"] += 1
+                continue
+            try:
+                if not args.tfo:
+                    sock.sendall(request)
+            except OSError:
+                errors["write"] += 1
+                continue
+            response = b""
+            try:
+                while True:
+                    chunk = sock.recv(65536)
+                    if not chunk:
+                        break
+                    response += chunk
+            except socket.timeout:
+                errors["timeout"] += 1
+                continue
+            except OSError:
+                errors["read"] += 1
+                continue
+            if response[9:10] != b"2":
+                errors["status"] += 1
+            requests += 1
+            nbytes += len(response)
+            latency += time.monotonic() - start
+        finally:
+            sock.close()
+
+    with lock:
+        stats["requests"] += requests
+        stats["bytes"] += nbytes
+        stats["latency"] += latency
+        for key, value in errors.items():
+            stats["errors"][key] += value
+
+
+def worker(args, connections, deadline, queue):
+    stats = {"requests": 0, "bytes": 0, "latency": 0.0,
+             "errors": {"connect": 0, "read": 0, "write": 0, "status": 0, "timeout": 0}}
+    lock = threading.Lock()
+    threads = [threading.Thread(target=connection_loop, args=(args, deadline, stats, lock))
+               for _ in range(connections)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    queue.put(stats)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TCP Fast Open CPS client")
+    parser.add_argument("-t", "--threads", type=int, default=multiprocessing.cpu_count(),
+                        help="number of worker processes")
+    parser.add_argument("-c", "--connections", type=int, default=multiprocessing.cpu_count(),
+                        help="number of concurrent connections")
+    parser.add_argument("-d", "--duration", type=int, default=30, help="duration in seconds")
+    parser.add_argument("--timeout", type=float, default=2.0, help="socket timeout in seconds")
+    parser.add_argument("--tfo", action="store_true", help="send the request in the SYN")
+    parser.add_argument("peer", help="<host>[:port]")
+    parser.add_argument("path", nargs="?", default="0B.bin", help="requested file")
+    args = parser.parse_args()
+
+    args.host, _, port = args.peer.partition(":")
+    args.port = int(port) if port else 80
+    args.threads = max(1, min(args.threads, args.connections))
+
+    deadline = time.monotonic() + args.duration
+    queue = multiprocessing.Queue()
+    per_worker = [args.connections // args.threads] * args.threads
+    for i in range(args.connections % args.threads):
+        per_worker[i] += 1
+
+    start = time.monotonic()
+    workers = [multiprocessing.Process(target=worker, args=(args, n, deadline, queue))
+               for n in per_worker]
+    for proc in workers:
+        proc.start()
+    results = [queue.get() for _ in workers]
+    for proc in workers:
+        proc.join()
+    elapsed = time.monotonic() - start
+
+    summary = {"duration": int(elapsed * 1000000), "requests": 0, "bytes": 0,
+               "errors": {"connect": 0, "read": 0, "write": 0, "status": 0, "timeout": 0},
+               "tfo": args.tfo}
+    latency = 0.0
+    for stats in results:
+        summary["requests"] += stats["requests"]
+        summary["bytes"] += stats["bytes"]
+        latency += stats["latency"]
+        for key, value in stats["errors"].items():
+            summary["errors"][key] += value
+    if summary["requests"]:
+        summary["latency_mean_us"] = round(latency * 1000000 / summary["requests"], 1)
+
+    print(json.dumps({"json_report": summary}))
+
+
+if __name__ == "__main__":
+    main()
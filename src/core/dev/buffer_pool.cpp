@@ -34,6 +34,7 @@
 #include "buffer_pool.h"
 
 #include <stdlib.h>
+#include <pthread.h>
 #include <sys/param.h> // for MIN
 
 #include "utils/bullseye.h"
@@ -66,6 +67,27 @@ buffer_pool *g_buffer_pool_tx = NULL;
 // These buffer descriptors do not actually own a buffer.
 buffer_pool *g_buffer_pool_zc = NULL;
 
+typedef buffer_thread_caches<mem_buf_desc_t, BUFFER_POOL_CACHE_MAX> buffer_pool_thread_caches;
+
+// Pools which own per-thread caches, indexed by buffer_pool::m_cache_id.
+// An entry is cleared when the pool is destroyed, ids are never reused.
+// Caches of all live threads are linked, so a pool drains them on teardown.
+static lock_spin s_cache_lock("buffer_pool_cache");
+static buffer_pool *s_cache_pools[BUFFER_POOL_CACHE_MAX];
+static int s_cache_pools_num = 0;
+static LIST_HEAD(s_thread_caches);
+static pthread_key_t s_cache_key;
+static pthread_once_t s_cache_key_once = PTHREAD_ONCE_INIT;
+
+static __thread buffer_pool_thread_caches t_caches;
+static __thread bool t_cache_registered = false;
+
+static void cache_key_create()
+{
+    // The destructor returns cached buffers when a thread exits
+    pthread_key_create(&s_cache_key, buffer_pool::thread_caches_exit);
+}
+
 buffer_pool_area::buffer_pool_area(size_t buffer_nr)
 {
     m_ptr = malloc(sizeof(mem_buf_desc_t) * buffer_nr + MCE_ALIGNMENT);
@@ -79,7 +101,7 @@ buffer_pool_area::~buffer_pool_area()
 }
 
 // inlining a function only help in case it come before using it...
-inline void buffer_pool::put_buffer_helper(mem_buf_desc_t *buff)
+inline void buffer_pool::prepare_buffer(mem_buf_desc_t *buff)
 {
 #if VLIST_DEBUG
     if (buff->buffer_node.is_list_member()) {
@@ -95,15 +117,37 @@ inline void buffer_pool::put_buffer_helper(mem_buf_desc_t *buff)
         }
     }
 
-    buff->p_next_desc = m_p_head;
     assert(buff->lwip_pbuf.pbuf.type != PBUF_ZEROCOPY || this == g_buffer_pool_zc ||
            g_buffer_pool_zc == NULL);
     free_lwip_pbuf(&buff->lwip_pbuf);
+}
+
+inline void buffer_pool::put_buffer_helper(mem_buf_desc_t *buff)
+{
+    prepare_buffer(buff);
+    buff->p_next_desc = m_p_head;
     m_p_head = buff;
     m_n_buffers++;
     m_p_bpool_stat->n_buffer_pool_size++;
 }
 
+inline buffer_pool_cache *buffer_pool::get_thread_cache()
+{
+    if (m_cache_id < 0) {
+        return NULL;
+    }
+    if (unlikely(!t_cache_registered)) {
+        pthread_once(&s_cache_key_once, cache_key_create);
+        // Any non NULL value, so the key destructor is called on thread exit
+        pthread_setspecific(s_cache_key, &t_caches);
+        s_cache_lock.lock();
+        list_add_tail(&t_caches.node, &s_thread_caches);
+        s_cache_lock.unlock();
+        t_cache_registered = true;
+    }
+    return &t_caches.cache[m_cache_id];
+}
+
 void buffer_pool::expand(size_t count, void *data, size_t buf_size,
                          pbuf_free_custom_fn custom_free_function)
 {
@@ -153,10 +197,14 @@ buffer_pool::buffer_pool(size_t buffer_count, size_t buf_size,
                          pbuf_free_custom_fn custom_free_function, alloc_t alloc_func,
                          free_t free_func)
     : m_lock("buffer_pool")
+    , m_p_data_block(NULL)
+    , m_data_stride(0)
     , m_n_buffers(0)
     , m_n_buffers_created(0)
     , m_p_head(NULL)
     , m_allocator(alloc_func, free_func)
+    , m_cache_id(-1)
+    , m_cache_batch(safe_mce_sys().buffer_pool_cache_size)
 {
     size_t sz_aligned_element = 0;
     void *ptr_data = NULL;
@@ -169,6 +217,16 @@ buffer_pool::buffer_pool(size_t buffer_count, size_t buf_size,
     memset(m_p_bpool_stat, 0, sizeof(*m_p_bpool_stat));
     xlio_stats_instance_create_bpool_block(m_p_bpool_stat);
 
+    if (m_cache_batch) {
+        std::lock_guard<decltype(s_cache_lock)> lock(s_cache_lock);
+        if (s_cache_pools_num < BUFFER_POOL_CACHE_MAX) {
+            m_cache_id = s_cache_pools_num++;
+            s_cache_pools[m_cache_id] = this;
+        } else {
+            __log_info_dbg("pool %p works without thread cache", this);
+        }
+    }
+
     if (buf_size == 0) {
         m_size = 0;
     } else if (buffer_count) {
@@ -188,6 +246,8 @@ buffer_pool::buffer_pool(size_t buffer_count, size_t buf_size,
     if (m_size) {
         // Align pointers
         ptr_data = (void *)((unsigned long)((char *)data_block + MCE_ALIGNMENT) & (~MCE_ALIGNMENT));
+        m_p_data_block = ptr_data;
+        m_data_stride = sz_aligned_element;
     }
 
     expand(buffer_count, ptr_data, sz_aligned_element, custom_free_function);
@@ -204,6 +264,28 @@ buffer_pool::~buffer_pool()
 
 void buffer_pool::free_bpool_resources()
 {
+    if (m_cache_id >= 0) {
+        /* Pools are destroyed on teardown when the threads no longer use them,
+         * so the caches of other threads can be drained from here.
+         */
+        mem_buf_desc_t *first, *last;
+        size_t n;
+
+        s_cache_lock.lock();
+        n = buffer_thread_caches_drain<mem_buf_desc_t, BUFFER_POOL_CACHE_MAX>(
+            &s_thread_caches, m_cache_id, first, last);
+        s_cache_pools[m_cache_id] = NULL;
+        s_cache_lock.unlock();
+
+        if (n) {
+            std::lock_guard<decltype(m_lock)> lock(m_lock);
+            last->p_next_desc = m_p_head;
+            m_p_head = first;
+            m_n_buffers += n;
+            m_p_bpool_stat->n_buffer_pool_size += n;
+        }
+    }
+
     if (m_n_buffers == m_n_buffers_created) {
         __log_info_func("count %lu, missing %lu", m_n_buffers, m_n_buffers_created - m_n_buffers);
     } else {
@@ -231,36 +313,138 @@ void buffer_pool::print_val_tbl()
     __log_info_dbg("pool %p size: %ld buffers: %lu", this, m_size, m_n_buffers);
 }
 
-bool buffer_pool::get_buffers_thread_safe(descq_t &pDeque, ring_slave *desc_owner, size_t count,
-                                          uint32_t lkey)
+/*
+ * Make sure the pool has at least count free buffers.
+ * Must be called with m_lock held.
+ */
+inline bool buffer_pool::reserve_buffers(size_t count)
+{
+    if (likely(m_n_buffers >= count)) {
+        return true;
+    }
+
+    if (m_size == 0) {
+        __log_info_dbg("Expanding buffer_pool %p", this);
+        m_p_bpool_stat->n_buffer_pool_expands++;
+        expand(m_areas.front()->m_n_buffers, NULL, 0, m_custom_free_function);
+        if (m_n_buffers >= count) {
+            return true;
+        }
+    }
+    VLOG_PRINTF_INFO_ONCE_THEN_ALWAYS(VLOG_DEBUG, VLOG_FUNC,
+                                      "ERROR! not enough buffers in the pool (requested: %lu, "
+                                      "have: %lu, created: %lu, Buffer pool type: %s)",
+                                      count, m_n_buffers, m_n_buffers_created,
+                                      m_p_bpool_stat->is_rx ? "Rx" : "Tx");
+
+    m_p_bpool_stat->n_buffer_pool_no_bufs++;
+    return false;
+}
+
+/*
+ * Move a batch of buffers from the pool to the thread cache, so the cache
+ * holds at least count buffers and m_cache_batch buffers are left after
+ * the caller takes them.
+ */
+bool buffer_pool::cache_refill(buffer_pool_cache *cache, size_t count)
 {
     std::lock_guard<decltype(m_lock)> lock(m_lock);
 
-    mem_buf_desc_t *head;
+    mem_buf_desc_t *first, *last;
+    size_t need = count - cache->count;
 
-    __log_info_funcall("requested %lu, present %lu, created %lu", count, m_n_buffers,
+    if (unlikely(!reserve_buffers(need))) {
+        return false;
+    }
+
+    size_t n = std::min(m_n_buffers, need + m_cache_batch);
+    first = last = m_p_head;
+    for (size_t i = 1; i < n; ++i) {
+        last = last->p_next_desc;
+    }
+    m_p_head = last->p_next_desc;
+    m_n_buffers -= n;
+    m_p_bpool_stat->n_buffer_pool_size -= n;
+    m_p_bpool_stat->n_buffer_pool_cache_refills++;
+
+    cache->push_list(first, last, n);
+
+    return true;
+}
+
+/*
+ * Return the cold bottom part of the thread cache to the pool and
+ * leave keep buffers in the cache. The list is split outside of the lock.
+ */
+void buffer_pool::cache_flush(buffer_pool_cache *cache, size_t keep)
+{
+    mem_buf_desc_t *first, *last;
+    size_t n = cache->trim(keep, first, last);
+
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+
+    __log_info_funcall("flushing %zu, present %zu, created %zu", n, m_n_buffers,
                        m_n_buffers_created);
 
-    if (unlikely(m_n_buffers < count)) {
-        if (m_size == 0) {
-            __log_info_dbg("Expanding buffer_pool %p", this);
-            m_p_bpool_stat->n_buffer_pool_expands++;
-            expand(m_areas.front()->m_n_buffers, NULL, 0, m_custom_free_function);
-            if (m_n_buffers >= count) {
-                goto return_buffers;
-            }
+    last->p_next_desc = m_p_head;
+    m_p_head = first;
+    m_n_buffers += n;
+    m_p_bpool_stat->n_buffer_pool_size += n;
+    m_p_bpool_stat->n_buffer_pool_cache_flushes++;
+
+    if (unlikely(m_n_buffers > m_n_buffers_created)) {
+        buffersPanic();
+    }
+}
+
+void buffer_pool::flush_thread_caches(void *arg)
+{
+    NOT_IN_USE(arg);
+    std::lock_guard<decltype(s_cache_lock)> lock(s_cache_lock);
+
+    for (int i = 0; i < s_cache_pools_num; ++i) {
+        if (s_cache_pools[i] && t_caches.cache[i].count) {
+            s_cache_pools[i]->cache_flush(&t_caches.cache[i], 0);
+        }
+    }
+}
+
+void buffer_pool::thread_caches_exit(void *arg)
+{
+    flush_thread_caches(arg);
+
+    std::lock_guard<decltype(s_cache_lock)> lock(s_cache_lock);
+    list_del(&t_caches.node);
+}
+
+bool buffer_pool::get_buffers_thread_safe(descq_t &pDeque, ring_slave *desc_owner, size_t count,
+                                          uint32_t lkey)
+{
+    mem_buf_desc_t *head;
+    buffer_pool_cache *cache = get_thread_cache();
+
+    if (cache && count <= m_cache_batch) {
+        if (unlikely(cache->count < count) && !cache_refill(cache, count)) {
+            return false;
+        }
+        while (count-- > 0) {
+            head = cache->pop();
+            head->lkey = lkey;
+            head->p_desc_owner = desc_owner;
+            pDeque.push_back(head);
         }
-        VLOG_PRINTF_INFO_ONCE_THEN_ALWAYS(VLOG_DEBUG, VLOG_FUNC,
-                                          "ERROR! not enough buffers in the pool (requested: %lu, "
-                                          "have: %lu, created: %lu, Buffer pool type: %s)",
-                                          count, m_n_buffers, m_n_buffers_created,
-                                          m_p_bpool_stat->is_rx ? "Rx" : "Tx");
+        return true;
+    }
+
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
 
-        m_p_bpool_stat->n_buffer_pool_no_bufs++;
+    __log_info_funcall("requested %lu, present %lu, created %lu", count, m_n_buffers,
+                       m_n_buffers_created);
+
+    if (unlikely(!reserve_buffers(count))) {
         return false;
     }
 
-return_buffers:
     // pop buffers from the list
     m_n_buffers -= count;
     m_p_bpool_stat->n_buffer_pool_size -= count;
@@ -437,12 +621,41 @@ inline void buffer_pool::put_buffers(mem_buf_desc_t **buff_vec, size_t count)
 
 void buffer_pool::put_buffers_thread_safe(mem_buf_desc_t *buff_list)
 {
+    buffer_pool_cache *cache = get_thread_cache();
+
+    if (cache) {
+        mem_buf_desc_t *next;
+        while (buff_list) {
+            next = buff_list->p_next_desc;
+            prepare_buffer(buff_list);
+            cache->push(buff_list);
+            buff_list = next;
+        }
+        if (unlikely(cache->count > 2 * m_cache_batch)) {
+            cache_flush(cache, m_cache_batch);
+        }
+        return;
+    }
+
     std::lock_guard<decltype(m_lock)> lock(m_lock);
     put_buffers(buff_list);
 }
 
 void buffer_pool::put_buffers_thread_safe(mem_buf_desc_t **buff_vec, size_t count)
 {
+    buffer_pool_cache *cache = get_thread_cache();
+
+    if (cache) {
+        while (count-- > 0U) {
+            prepare_buffer(buff_vec[count]);
+            cache->push(buff_vec[count]);
+        }
+        if (unlikely(cache->count > 2 * m_cache_batch)) {
+            cache_flush(cache, m_cache_batch);
+        }
+        return;
+    }
+
     std::lock_guard<decltype(m_lock)> lock(m_lock);
     put_buffers(buff_vec, count);
 }
@@ -468,6 +681,15 @@ void buffer_pool::put_buffers(descq_t *buffers, size_t count)
 
 void buffer_pool::put_buffers_thread_safe(descq_t *buffers, size_t count)
 {
+    buffer_pool_cache *cache = get_thread_cache();
+
+    if (cache) {
+        for (size_t amount = std::min(count, buffers->size()); amount > 0; amount--) {
+            put_buffers_thread_safe(buffers->get_and_pop_back());
+        }
+        return;
+    }
+
     std::lock_guard<decltype(m_lock)> lock(m_lock);
     put_buffers(buffers, count);
 }
@@ -37,6 +37,7 @@
 #include "util/xlio_stats.h"
 #include "proto/mem_buf_desc.h"
 #include "dev/allocator.h"
+#include "dev/buffer_pool_cache.h"
 #include "util/xlio_list.h"
 #include "proto/mapping.h"
 #include "proto/mem_desc.h"
@@ -83,6 +84,11 @@ private:
 
 typedef xlio_list_t<buffer_pool_area, buffer_pool_area::node_offset> buffer_pool_area_list_t;
 
+/* Maximum number of buffer pools which can have per-thread caches */
+#define BUFFER_POOL_CACHE_MAX 8
+
+typedef buffer_cache<mem_buf_desc_t> buffer_pool_cache;
+
 /**
  * A buffer pool which internally sorts the buffers.
  */
@@ -130,12 +136,36 @@ public:
 
     void set_RX_TX_for_stats(bool rx);
 
+    /**
+     * Get the memory block which holds the buffers data.
+     * @param size Size of the block in bytes.
+     * @param stride Distance between data of adjacent buffers.
+     * @return Start of the block or NULL if the pool owns no data memory.
+     */
+    void *get_data_block(size_t &size, size_t &stride) const
+    {
+        size = m_n_buffers_created * m_data_stride;
+        stride = m_data_stride;
+        return m_p_data_block;
+    }
+
+    /**
+     * Return buffers of the calling thread caches to their pools.
+     */
+    static void flush_thread_caches(void *arg = NULL);
+    /**
+     * Flush and unregister the caches of an exiting thread.
+     */
+    static void thread_caches_exit(void *arg);
+
 private:
     lock_spin m_lock;
     // XXX-dummy buffer list head and count
     // to be replaced with a bucket-sorted array
 
     size_t m_size; /* pool size in bytes */
+    void *m_p_data_block; /* aligned start of the buffers data */
+    size_t m_data_stride;
     size_t m_n_buffers;
     size_t m_n_buffers_created;
     mem_buf_desc_t *m_p_head;
@@ -146,10 +176,23 @@ private:
     buffer_pool_area_list_t m_areas;
     pbuf_free_custom_fn m_custom_free_function;
 
+    /* Per-thread cache index, -1 if the cache is disabled for the pool */
+    int m_cache_id;
+    /* Cache low watermark and batch size, the high watermark is twice that */
+    size_t m_cache_batch;
+
+    /**
+     * Release resources attached to a buffer before it returns to the pool
+     */
+    inline void prepare_buffer(mem_buf_desc_t *buff);
     /**
      * Add a buffer to the pool
      */
     inline void put_buffer_helper(mem_buf_desc_t *buff);
+    inline bool reserve_buffers(size_t count);
+    inline buffer_pool_cache *get_thread_cache();
+    bool cache_refill(buffer_pool_cache *cache, size_t count);
+    void cache_flush(buffer_pool_cache *cache, size_t keep);
     void expand(size_t count, void *data, size_t buf_size,
                 pbuf_free_custom_fn custom_free_function);
 
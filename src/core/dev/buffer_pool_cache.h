@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BUFFER_POOL_CACHE_H
+#define BUFFER_POOL_CACHE_H
+
+#include <stddef.h>
+
+#include "util/list.h"
+
+/**
+ * Per-thread stack of free buffers in front of a buffer_pool.
+ * Buffers are linked by p_next_desc and exchanged with the global pool in
+ * batches under the pool lock. The structure has no constructor, so it can
+ * be a zero initialized thread local.
+ * @tail is valid only if @count is not zero.
+ */
+template <typename T> struct buffer_cache {
+    T *head;
+    T *tail;
+    size_t count;
+
+    inline void push(T *buff)
+    {
+        buff->p_next_desc = head;
+        if (count++ == 0) {
+            tail = buff;
+        }
+        head = buff;
+    }
+
+    inline T *pop()
+    {
+        T *buff = head;
+
+        head = buff->p_next_desc;
+        buff->p_next_desc = NULL;
+        --count;
+        return buff;
+    }
+
+    // Put the list first ... last of n buffers on top of the cache
+    void push_list(T *first, T *last, size_t n)
+    {
+        last->p_next_desc = head;
+        if (count == 0) {
+            tail = last;
+        }
+        head = first;
+        count += n;
+    }
+
+    /* Detach the cold bottom part of the cache and leave keep buffers in it.
+     * Returns the number of detached buffers and their list in first ... last.
+     */
+    size_t trim(size_t keep, T *&first, T *&last)
+    {
+        size_t n = count - keep;
+
+        last = tail;
+        if (keep == 0) {
+            first = head;
+            head = NULL;
+        } else {
+            T *split = head;
+            for (size_t i = 1; i < keep; ++i) {
+                split = split->p_next_desc;
+            }
+            first = split->p_next_desc;
+            split->p_next_desc = NULL;
+            tail = split;
+        }
+        count = keep;
+        return n;
+    }
+};
+
+/**
+ * Caches of a thread, one per pool which owns per-thread caches. Threads
+ * which use the caches are linked, so a pool can drain all of them.
+ */
+template <typename T, int N> struct buffer_thread_caches {
+    buffer_cache<T> cache[N];
+    struct list_head node;
+};
+
+/**
+ * Empty the caches with index id of all linked threads.
+ * Returns the number of buffers and their list in first ... last.
+ * The threads must not use these caches concurrently.
+ */
+template <typename T, int N>
+size_t buffer_thread_caches_drain(struct list_head *threads, int id, T *&first, T *&last)
+{
+    typedef buffer_thread_caches<T, N> thread_caches_t;
+    struct list_head *pos;
+    size_t total = 0;
+
+    first = last = NULL;
+    list_for_each(pos, threads)
+    {
+        buffer_cache<T> &cache = list_entry(pos, thread_caches_t, node)->cache[id];
+        T *cache_first, *cache_last;
+
+        if (cache.count == 0) {
+            continue;
+        }
+        total += cache.trim(0, cache_first, cache_last);
+        cache_last->p_next_desc = first;
+        if (!first) {
+            last = cache_last;
+        }
+        first = cache_first;
+    }
+    return total;
+}
+
+#endif /* BUFFER_POOL_CACHE_H */
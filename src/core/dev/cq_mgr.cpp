@@ -117,11 +117,6 @@ cq_mgr::cq_mgr(ring_simple *p_ring, ib_ctx_handler *p_ib_ctx_handler, int cq_siz
 
 void cq_mgr::configure(int cq_size)
 {
-    xlio_ibv_cq_init_attr attr;
-    memset(&attr, 0, sizeof(attr));
-
-    prep_ibv_cq(attr);
-
     struct ibv_context *context = m_p_ib_ctx_handler->get_ibv_context();
     int comp_vector = 0;
 #if defined(DEFINED_NGINX)
@@ -133,8 +128,7 @@ void cq_mgr::configure(int cq_size)
         comp_vector = g_worker_index % context->num_comp_vectors;
     }
 #endif
-    m_p_ibv_cq = xlio_ibv_create_cq(context, cq_size - 1, (void *)this, m_comp_event_channel,
-                                    comp_vector, &attr);
+    m_p_ibv_cq = create_ibv_cq(context, cq_size - 1, m_comp_event_channel, comp_vector);
     BULLSEYE_EXCLUDE_BLOCK_START
     if (!m_p_ibv_cq) {
         throw_xlio_exception("ibv_create_cq failed");
@@ -173,6 +167,17 @@ void cq_mgr::prep_ibv_cq(xlio_ibv_cq_init_attr &attr) const
     }
 }
 
+struct ibv_cq *cq_mgr::create_ibv_cq(struct ibv_context *context, int cqe,
+                                     struct ibv_comp_channel *channel, int comp_vector)
+{
+    xlio_ibv_cq_init_attr attr;
+    memset(&attr, 0, sizeof(attr));
+
+    prep_ibv_cq(attr);
+
+    return xlio_ibv_create_cq(context, cqe, (void *)this, channel, comp_vector, &attr);
+}
+
 uint32_t cq_mgr::clean_cq()
 {
     uint32_t ret_total = 0;
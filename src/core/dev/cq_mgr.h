@@ -202,6 +202,8 @@ protected:
 
     virtual void statistics_print();
     virtual void prep_ibv_cq(xlio_ibv_cq_init_attr &attr) const;
+    virtual struct ibv_cq *create_ibv_cq(struct ibv_context *context, int cqe,
+                                         struct ibv_comp_channel *channel, int comp_vector);
     // returns list of buffers to the owner.
     void process_tx_buffer_list(mem_buf_desc_t *p_mem_buf_desc);
 
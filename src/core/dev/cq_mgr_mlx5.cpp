@@ -55,13 +55,44 @@
 cq_mgr_mlx5::cq_mgr_mlx5(ring_simple *p_ring, ib_ctx_handler *p_ib_ctx_handler, uint32_t cq_size,
                          struct ibv_comp_channel *p_comp_event_channel, bool is_rx,
                          bool call_configure)
-    : cq_mgr(p_ring, p_ib_ctx_handler, cq_size, p_comp_event_channel, is_rx, call_configure)
+    : cq_mgr(p_ring, p_ib_ctx_handler, cq_size, p_comp_event_channel, is_rx, false)
     , m_qp(NULL)
     , m_rx_hot_buffer(NULL)
+    , m_b_sysvar_cq_rx_batch_prefetch(safe_mce_sys().cq_rx_batch_prefetch)
+    /* Mini CQEs carry only the byte count, per packet LRO, timestamp and stride
+     * fields would be lost
+     */
+    , m_b_rx_cqe_comp(is_rx && safe_mce_sys().rx_cqe_compression &&
+                      !safe_mce_sys().enable_striding_rq && !safe_mce_sys().rx_srq_num_wr &&
+                      !p_ring->m_lro.cap &&
+                      !p_ib_ctx_handler->get_ctx_time_converter_status())
 {
     cq_logfunc("");
 
     memset(&m_mlx5_cq, 0, sizeof(m_mlx5_cq));
+    memset(&m_cqe_zip, 0, sizeof(m_cqe_zip));
+
+    // Configured here rather than by cq_mgr so the CQ is created by create_ibv_cq() below
+    if (call_configure) {
+        configure(cq_size);
+    }
+}
+
+struct ibv_cq *cq_mgr_mlx5::create_ibv_cq(struct ibv_context *context, int cqe,
+                                          struct ibv_comp_channel *channel, int comp_vector)
+{
+    if (m_b_rx_cqe_comp) {
+        struct ibv_cq *cq =
+            xlio_ib_mlx5_create_cq_comp(context, cqe, (void *)this, channel, comp_vector);
+        if (cq) {
+            cq_logdbg("Created Rx CQ with CQE compression");
+            return cq;
+        }
+        cq_logdbg("CQE compression is not supported, using regular CQEs");
+        m_b_rx_cqe_comp = false;
+    }
+
+    return cq_mgr::create_ibv_cq(context, cqe, channel, comp_vector);
 }
 
 uint32_t cq_mgr_mlx5::clean_cq()
@@ -112,10 +143,36 @@ cq_mgr_mlx5::~cq_mgr_mlx5()
     cq_logdbg("destroying CQ as %s", (m_b_is_rx ? "Rx" : "Tx"));
 }
 
+/* SRQ WQEs are consumed in any order, so the buffer is known only from the
+ * WQE index of the CQE.
+ */
+inline mem_buf_desc_t *cq_mgr_mlx5::poll_srq(enum buff_status_e &status)
+{
+    xlio_mlx5_cqe *cqe = poll_cqe();
+    if (!cqe) {
+        return NULL;
+    }
+
+    mem_buf_desc_t *buff = m_qp->srq_take_buf(ntohs(cqe->wqe_counter));
+    // The buffer could be posted by another ring, it belongs to the receiver now
+    buff->p_desc_owner = m_p_ring;
+    cqe_to_mem_buff_desc(cqe, buff, status);
+    *m_mlx5_cq.dbrec = htonl(m_mlx5_cq.cq_ci & 0xffffff);
+
+    prefetch((uint8_t *)m_mlx5_cq.cq_buf +
+             ((m_mlx5_cq.cq_ci & (m_mlx5_cq.cqe_count - 1)) << m_mlx5_cq.cqe_size_log));
+
+    return buff;
+}
+
 mem_buf_desc_t *cq_mgr_mlx5::poll(enum buff_status_e &status)
 {
     mem_buf_desc_t *buff = NULL;
 
+    if (unlikely(m_qp->m_p_srq)) {
+        return poll_srq(status);
+    }
+
 #ifdef RDTSC_MEASURE_RX_XLIO_TCP_IDLE_POLL
     RDTSC_TAKE_END(RDTSC_FLOW_RX_XLIO_TCP_IDLE_POLL);
 #endif // RDTSC_MEASURE_RX_TCP_IDLE_POLLL
@@ -146,11 +203,8 @@ mem_buf_desc_t *cq_mgr_mlx5::poll(enum buff_status_e &status)
             return NULL;
         }
     }
-    xlio_mlx5_cqe *cqe = check_cqe();
+    xlio_mlx5_cqe *cqe = poll_cqe();
     if (likely(cqe)) {
-        /* Update the consumer index */
-        ++m_mlx5_cq.cq_ci;
-        rmb();
         cqe_to_mem_buff_desc(cqe, m_rx_hot_buffer, status);
 
         ++m_qp->m_mlx5_qp.rq.tail;
@@ -398,30 +452,35 @@ int cq_mgr_mlx5::poll_and_process_element_rx(uint64_t *p_cq_poll_sn, void *pv_fd
 
     buff_status_e status = BS_OK;
     uint32_t ret = 0;
-    while (ret < m_n_sysvar_cq_poll_batch_max) {
-        mem_buf_desc_t *buff = poll(status);
-        if (buff) {
-            ++ret;
-            if (cqe_process_rx(buff, status)) {
-                if ((++m_qp_rec.debt < (int)m_n_sysvar_rx_num_wr_to_post_recv) ||
-                    !compensate_qp_poll_success(buff)) {
-                    process_recv_buffer(buff, pv_fd_ready_array);
+    if (m_b_sysvar_cq_rx_batch_prefetch) {
+        ret = poll_and_process_batch_rx(pv_fd_ready_array);
+    } else {
+        while (ret < m_n_sysvar_cq_poll_batch_max) {
+            mem_buf_desc_t *buff = poll(status);
+            if (buff) {
+                ++ret;
+                if (cqe_process_rx(buff, status)) {
+                    if ((++m_qp_rec.debt < (int)m_n_sysvar_rx_num_wr_to_post_recv) ||
+                        !compensate_qp_poll_success(buff)) {
+                        process_recv_buffer(buff, pv_fd_ready_array);
+                    }
+                } else {
+                    m_p_cq_stat->n_rx_pkt_drop++;
+                    if (++m_qp_rec.debt >= (int)m_n_sysvar_rx_num_wr_to_post_recv) {
+                        compensate_qp_poll_failed();
+                    }
                 }
             } else {
-                m_p_cq_stat->n_rx_pkt_drop++;
-                if (++m_qp_rec.debt >= (int)m_n_sysvar_rx_num_wr_to_post_recv) {
-                    compensate_qp_poll_failed();
-                }
+                m_b_was_drained = true;
+                break;
             }
-        } else {
-            m_b_was_drained = true;
-            break;
         }
     }
 
     update_global_sn(*p_cq_poll_sn, ret);
 
     if (likely(ret > 0)) {
+        update_rx_batch_hist(ret);
         ret_rx_processed += ret;
         m_n_wce_counter += ret;
         m_p_ring->m_gro_mgr.flush_all(pv_fd_ready_array);
@@ -432,6 +491,64 @@ int cq_mgr_mlx5::poll_and_process_element_rx(uint64_t *p_cq_poll_sn, void *pv_fd
     return ret_rx_processed;
 }
 
+uint32_t cq_mgr_mlx5::poll_and_process_batch_rx(void *pv_fd_ready_array)
+{
+    /* Assume locked!!! */
+    mem_buf_desc_t *batch[MCE_MAX_CQ_POLL_BATCH];
+    buff_status_e status[MCE_MAX_CQ_POLL_BATCH];
+    uint32_t count = 0;
+    uint32_t i;
+
+    /* Harvest the ready completions first. Descriptors of the posted WQEs are
+     * prefetched ahead, so filling them from the CQEs does not stall on each one.
+     */
+    uint32_t posted = m_qp->m_mlx5_qp.rq.head - m_qp->m_mlx5_qp.rq.tail;
+    uint32_t ahead = std::min(posted, m_n_sysvar_cq_poll_batch_max);
+    for (i = 1; i < ahead; i++) {
+        uint32_t index = (m_qp->m_mlx5_qp.rq.tail + i) & (m_qp_rec.qp->m_rx_num_wr - 1);
+        prefetch((void *)m_qp->m_rq_wqe_idx_to_wrid[index]);
+    }
+    while (count < m_n_sysvar_cq_poll_batch_max) {
+        batch[count] = poll(status[count]);
+        if (!batch[count]) {
+            m_b_was_drained = true;
+            break;
+        }
+        ++count;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    /* Validate the batch, this prefetches the headers of every packet before any is steered.
+     * The QP is compensated each time the debt reaches the threshold, as in the per CQE loop,
+     * so a pool shortage drops and reposts every packet above the threshold, not only one.
+     */
+    for (i = 0; i < count; i++) {
+        batch[i] = cqe_process_rx(batch[i], status[i]);
+        if (batch[i]) {
+            if ((++m_qp_rec.debt >= (int)m_n_sysvar_rx_num_wr_to_post_recv) &&
+                compensate_qp_poll_success(batch[i])) {
+                // Out of buffers, the packet was dropped and its buffer reposted
+                batch[i] = NULL;
+            }
+        } else {
+            m_p_cq_stat->n_rx_pkt_drop++;
+            if (++m_qp_rec.debt >= (int)m_n_sysvar_rx_num_wr_to_post_recv) {
+                compensate_qp_poll_failed();
+            }
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        if (batch[i]) {
+            process_recv_buffer(batch[i], pv_fd_ready_array);
+        }
+    }
+
+    return count;
+}
+
 inline void cq_mgr_mlx5::cqe_to_xlio_wc(struct xlio_mlx5_cqe *cqe, xlio_ibv_wc *wc)
 {
     struct mlx5_err_cqe *ecqe = (struct mlx5_err_cqe *)cqe;
@@ -512,7 +629,12 @@ void cq_mgr_mlx5::handle_sq_wqe_prop(unsigned index)
      */
 
     do {
-        if (p->buf) {
+        if (unlikely(p->buf_list)) {
+            // Multi-packet WQE holds a list of buffers
+            mpw_release_chain(p->buf, [this](mem_buf_desc_t *buf) {
+                m_p_ring->mem_buf_desc_return_single_locked(buf);
+            });
+        } else if (p->buf) {
             m_p_ring->mem_buf_desc_return_single_locked(p->buf);
         }
         if (p->ti) {
@@ -77,9 +77,16 @@ protected:
     qp_mgr_eth_mlx5 *m_qp;
     xlio_ib_mlx5_cq_t m_mlx5_cq;
     mem_buf_desc_t *m_rx_hot_buffer;
+    const bool m_b_sysvar_cq_rx_batch_prefetch;
+    bool m_b_rx_cqe_comp;
+    xlio_mlx5_cqe_zip m_cqe_zip;
 
     inline struct xlio_mlx5_cqe *check_cqe(void);
+    inline struct xlio_mlx5_cqe *poll_cqe(void);
+    virtual struct ibv_cq *create_ibv_cq(struct ibv_context *context, int cqe,
+                                         struct ibv_comp_channel *channel, int comp_vector);
     virtual mem_buf_desc_t *poll(enum buff_status_e &status);
+    inline mem_buf_desc_t *poll_srq(enum buff_status_e &status);
     int poll_and_process_error_element_rx(struct xlio_mlx5_cqe *cqe, void *pv_fd_ready_array);
 
     inline struct xlio_mlx5_cqe *get_cqe(uint32_t &num_polled_cqes);
@@ -88,6 +95,8 @@ protected:
                                      enum buff_status_e &status);
     void cqe_to_xlio_wc(struct xlio_mlx5_cqe *cqe, xlio_ibv_wc *wc);
     inline void update_global_sn(uint64_t &cq_poll_sn, uint32_t rettotal);
+    inline void update_rx_batch_hist(uint32_t num_polled_cqes);
+    uint32_t poll_and_process_batch_rx(void *pv_fd_ready_array);
     void lro_update_hdr(struct xlio_mlx5_cqe *cqe, mem_buf_desc_t *p_rx_wc_buf_desc);
 
 private:
@@ -117,6 +126,11 @@ inline void cq_mgr_mlx5::update_global_sn(uint64_t &cq_poll_sn, uint32_t num_pol
     cq_poll_sn = m_n_global_sn;
 }
 
+inline void cq_mgr_mlx5::update_rx_batch_hist(uint32_t num_polled_cqes)
+{
+    ++m_p_cq_stat->n_rx_batch_hist[cq_rx_batch_bucket(num_polled_cqes)];
+}
+
 inline struct xlio_mlx5_cqe *cq_mgr_mlx5::get_cqe(uint32_t &num_polled_cqes)
 {
     struct xlio_mlx5_cqe *cqe_ret = nullptr;
@@ -59,5 +59,31 @@ inline struct xlio_mlx5_cqe *cq_mgr_mlx5::check_cqe(void)
     return NULL;
 }
 
+/* Get the next Rx CQE and move the consumer index past it.
+ * Compressed sessions are expanded one mini CQE per call.
+ */
+inline struct xlio_mlx5_cqe *cq_mgr_mlx5::poll_cqe(void)
+{
+    if (unlikely(m_cqe_zip.cnt)) {
+        m_p_cq_stat->n_rx_cqe_zip_packets++;
+        return xlio_ib_mlx5_cqe_zip_next(&m_cqe_zip, &m_mlx5_cq);
+    }
+
+    struct xlio_mlx5_cqe *cqe = check_cqe();
+    if (likely(cqe)) {
+        rmb();
+        if (unlikely(xlio_ib_mlx5_cqe_is_compressed(cqe))) {
+            xlio_ib_mlx5_cqe_zip_open(&m_cqe_zip, &m_mlx5_cq, cqe);
+            m_p_cq_stat->n_rx_cqe_zip_slots +=
+                1U + DIV_ROUND_UP(m_cqe_zip.cnt, XLIO_MLX5_MINI_CQE_ARRAY_SIZE);
+            m_p_cq_stat->n_rx_cqe_zip_packets++;
+            return xlio_ib_mlx5_cqe_zip_next(&m_cqe_zip, &m_mlx5_cq);
+        }
+        ++m_mlx5_cq.cq_ci;
+    }
+
+    return cqe;
+}
+
 #endif /* DEFINED_DIRECT_VERBS */
 #endif // CQ_MGR_MLX5_INL_H
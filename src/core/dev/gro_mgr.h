@@ -38,12 +38,12 @@
 #define MAX_AGGR_BYTE_PER_STREAM 0xFFFF
 #define MAX_GRO_BUFS             32
 
-class rfs_uc_tcp_gro;
+class rfs_uc;
 
 class gro_mgr {
 public:
     gro_mgr(uint32_t flow_max, uint32_t buf_max);
-    bool reserve_stream(rfs_uc_tcp_gro *rfs_uc_tcp_gro);
+    bool reserve_stream(rfs_uc *p_rfs);
     bool is_stream_max();
     inline uint32_t get_buf_max() { return m_n_buf_max; }
     inline uint32_t get_byte_max() { return MAX_AGGR_BYTE_PER_STREAM; }
@@ -56,7 +56,7 @@ private:
 
     uint32_t m_n_flow_count;
 
-    rfs_uc_tcp_gro **m_p_rfs_arr;
+    rfs_uc **m_p_rfs_arr;
 };
 
 #endif /* GRO_MGR_H_ */
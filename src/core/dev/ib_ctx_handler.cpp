@@ -41,6 +41,7 @@
 #include "ib/base/verbs_extra.h"
 #include "dev/time_converter_ib_ctx.h"
 #include "dev/time_converter_ptp.h"
+#include "dev/srq_mgr.h"
 #include "util/valgrind.h"
 #include "event/event_handler_manager.h"
 
@@ -59,6 +60,9 @@ ib_ctx_handler::ib_ctx_handler(struct ib_ctx_handler_desc *desc)
     , m_on_device_memory(0)
     , m_removed(false)
     , m_lock_umr("spin_lock_umr")
+    , m_lock_srq("spin_lock_srq")
+    , m_p_srq_mgr(NULL)
+    , m_srq_ref(0)
     , m_p_ctx_time_converter(NULL)
 {
     if (NULL == desc) {
@@ -192,6 +196,40 @@ ib_ctx_handler::~ib_ctx_handler()
     BULLSEYE_EXCLUDE_BLOCK_END
 }
 
+#if defined(DEFINED_DIRECT_VERBS)
+/*
+ * The SRQ is created by the first ring which asks for it and destroyed when
+ * the last QP attached to it is gone.
+ */
+srq_mgr *ib_ctx_handler::get_srq_mgr()
+{
+    std::lock_guard<decltype(m_lock_srq)> lock(m_lock_srq);
+
+    if (!m_p_srq_mgr) {
+        try {
+            m_p_srq_mgr = new srq_mgr(this, safe_mce_sys().rx_srq_num_wr);
+        } catch (xlio_exception &e) {
+            ibch_logdbg("SRQ is not available on %s: %s (errno=%d %m)", get_ibname(), e.message,
+                        errno);
+            return NULL;
+        }
+    }
+    ++m_srq_ref;
+
+    return m_p_srq_mgr;
+}
+
+void ib_ctx_handler::put_srq_mgr()
+{
+    std::lock_guard<decltype(m_lock_srq)> lock(m_lock_srq);
+
+    if (m_p_srq_mgr && --m_srq_ref == 0) {
+        delete m_p_srq_mgr;
+        m_p_srq_mgr = NULL;
+    }
+}
+#endif /* DEFINED_DIRECT_VERBS */
+
 void ib_ctx_handler::set_str()
 {
     char str_x[512] = {0};
@@ -45,6 +45,8 @@
 #include <mellanox/dpcp.h>
 #endif /* DEFINED_DPCP */
 
+class srq_mgr;
+
 typedef std::unordered_map<uint32_t, struct ibv_mr *> mr_map_lkey_t;
 
 struct pacing_caps_t {
@@ -101,6 +103,10 @@ public:
     bool is_packet_pacing_supported(uint32_t rate = 1);
     size_t get_on_device_memory_size() { return m_on_device_memory; }
     bool is_active(int port_num);
+#if defined(DEFINED_DIRECT_VERBS)
+    srq_mgr *get_srq_mgr();
+    void put_srq_mgr();
+#endif /* DEFINED_DIRECT_VERBS */
     bool is_mlx4() { return is_mlx4(get_ibname()); }
     static bool is_mlx4(const char *dev) { return strncmp(dev, "mlx4", 4) == 0; }
     virtual void handle_event_ibverbs_cb(void *ev_data, void *ctx);
@@ -127,6 +133,9 @@ private:
     size_t m_on_device_memory;
     bool m_removed;
     lock_spin m_lock_umr;
+    lock_spin m_lock_srq;
+    srq_mgr *m_p_srq_mgr;
+    int m_srq_ref;
     time_converter *m_p_ctx_time_converter;
     mr_map_lkey_t m_mr_map_lkey;
     std::unordered_map<void *, uint32_t> m_user_mem_lkey_map;
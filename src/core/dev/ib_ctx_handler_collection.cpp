@@ -156,14 +156,20 @@ void ib_ctx_handler_collection::update_tbl(const char *ifa_name)
     dev_list = xlio_ibv_get_device_list(&num_devices);
 
     BULLSEYE_EXCLUDE_BLOCK_START
+    if (!dev_list && (safe_mce_sys().ring_loopback || safe_mce_sys().ring_xdp)) {
+        /* Software rings operate without offload capable devices */
+        ibchc_logdbg("No IB capable devices found, software rings are used");
+        return;
+    }
     if (!dev_list) {
         ibchc_logerr("Failure in xlio_ibv_get_device_list() (error=%d %m)", errno);
         ibchc_logerr("Please check rdma configuration");
         throw_xlio_exception("No IB capable devices found!");
     }
     if (!num_devices) {
-        vlog_levels_t _level =
-            ifa_name ? VLOG_DEBUG : VLOG_ERROR; // Print an error only during initialization.
+        vlog_levels_t _level = (ifa_name || safe_mce_sys().ring_loopback || safe_mce_sys().ring_xdp)
+            ? VLOG_DEBUG
+            : VLOG_ERROR; // Print an error only during initialization.
         vlog_printf(_level, PRODUCT_NAME " does not detect IB capable devices\n");
         vlog_printf(_level, "No performance gain is expected in current configuration\n");
     }
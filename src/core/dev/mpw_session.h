@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MPW_SESSION_H
+#define MPW_SESSION_H
+
+#include <stdint.h>
+
+/*
+ * Enhanced multi-packet send WQE limits.
+ * DS count of a WQE is a 6 bit field, ctrl and eth segments take 2 of them.
+ */
+#define XLIO_MLX5_MPW_MAX_DS      63
+#define XLIO_MLX5_MPW_MAX_PACKETS 32
+
+/*
+ * Open enhanced multi-packet send WQE.
+ * Tracks the layout of the WQE being filled and the TX buffers of the packets
+ * inlined into it. Sizes are in octowords (DS), a WQEBB holds 4 of them.
+ * The buffers are chained by p_next_desc and the chain is released at once on
+ * completion, see mpw_release_chain(). The structure has no constructor, so it
+ * can be zero initialized.
+ */
+template <typename BUF> struct mpw_session {
+    enum { DS_SIZE = 16, HDR_DS = 2 };
+
+    uint8_t *wqe; // Open WQE or NULL
+    uint8_t *cur; // Next data segment
+    BUF *buf_head;
+    BUF *buf_tail;
+    uint16_t ds; // WQE size in octowords
+    uint16_t pkts;
+    uint8_t cs_flags;
+
+    static inline unsigned wqebbs(unsigned ds_num) { return (ds_num + 3) / 4; }
+
+    // Inline data segment of a packet: 4 bytes byte_count followed by the data
+    static inline uint16_t seg_ds(uint32_t len) { return (len + 4 + DS_SIZE - 1) / DS_SIZE; }
+
+    /* Whether a new WQE with one data segment can be opened at @hot.
+     * The WQE is kept contiguous, a regular WQE handles the SQ wrap around.
+     */
+    static inline bool can_open(const uint8_t *hot, uint16_t seg, const uint8_t *sq_end,
+                                unsigned credits)
+    {
+        return hot + (HDR_DS + seg) * DS_SIZE <= sq_end && wqebbs(HDR_DS + seg) <= credits;
+    }
+
+    // Whether the open WQE must be completed before a segment can be appended
+    inline bool must_close(uint16_t seg, uint8_t flags, const uint8_t *sq_end) const
+    {
+        return cs_flags != flags || pkts >= XLIO_MLX5_MPW_MAX_PACKETS ||
+            ds + seg > XLIO_MLX5_MPW_MAX_DS || cur + seg * DS_SIZE > sq_end;
+    }
+
+    inline void open(uint8_t *hot, uint8_t flags)
+    {
+        wqe = hot;
+        cur = hot + HDR_DS * DS_SIZE;
+        ds = HDR_DS;
+        pkts = 0;
+        cs_flags = flags;
+        buf_head = buf_tail = nullptr;
+    }
+
+    /* WQEBBs the WQE takes from the SQ by appending a segment. An empty WQE is
+     * not accounted yet, so it takes all of its WQEBBs with the first packet.
+     */
+    inline unsigned grow_wqebbs(uint16_t seg) const
+    {
+        return wqebbs(ds + seg) - (pkts ? wqebbs(ds) : 0);
+    }
+
+    // Reserve a data segment for a packet, returns its address
+    inline uint8_t *append(uint16_t seg, BUF *buf)
+    {
+        uint8_t *data = cur;
+
+        cur += seg * DS_SIZE;
+        ds += seg;
+        ++pkts;
+        if (buf) {
+            buf->p_next_desc = nullptr;
+            if (buf_tail) {
+                buf_tail->p_next_desc = buf;
+            } else {
+                buf_head = buf;
+            }
+            buf_tail = buf;
+        }
+        return data;
+    }
+};
+
+// Release the buffers of a completed multi-packet WQE
+template <typename BUF, typename F> inline void mpw_release_chain(BUF *buf, F release)
+{
+    while (buf) {
+        BUF *next = buf->p_next_desc;
+        buf->p_next_desc = nullptr;
+        release(buf);
+        buf = next;
+    }
+}
+
+#endif /* MPW_SESSION_H */
@@ -53,6 +53,8 @@
 #include "proto/L2_address.h"
 #include "dev/ib_ctx_handler_collection.h"
 #include "dev/ring_tap.h"
+#include "dev/ring_loopback.h"
+#include "dev/ring_xdp.h"
 #include "dev/ring_simple.h"
 #include "dev/ring_slave.h"
 #include "dev/ring_bond.h"
@@ -240,6 +242,11 @@ net_device_val::net_device_val(struct net_device_val_desc *desc)
 
     valid = false;
     ib_ctx = g_p_ib_ctx_handler_collection->get_ib_ctx(get_ifname_link());
+    if (safe_mce_sys().ring_loopback || safe_mce_sys().ring_xdp) {
+        /* Software loopback and AF_XDP rings do not require offload capable device */
+        m_bond = NO_BOND;
+        ib_ctx = NULL;
+    }
     switch (m_bond) {
     case NETVSC:
         if (get_type() == ARPHRD_ETHER) {
@@ -257,7 +264,11 @@ net_device_val::net_device_val(struct net_device_val_desc *desc)
         valid = verify_bond_or_eth_qp_creation();
         break;
     default:
-        valid = (bool)(ib_ctx && verify_eth_qp_creation(get_ifname_link()));
+        if (safe_mce_sys().ring_loopback || safe_mce_sys().ring_xdp) {
+            valid = (get_type() == ARPHRD_ETHER);
+        } else {
+            valid = (bool)(ib_ctx && verify_eth_qp_creation(get_ifname_link()));
+        }
         break;
     }
 
@@ -1276,8 +1287,8 @@ void net_device_val::ring_adapt_cq_moderation()
 void net_device_val::register_to_ibverbs_events(event_handler_ibverbs *handler)
 {
     for (size_t i = 0; i < m_slaves.size(); i++) {
-        bool found = false;
-        for (size_t j = 0; j < i; j++) {
+        bool found = !m_slaves[i]->p_ib_ctx; // software ring slaves have no device
+        for (size_t j = 0; j < i && !found; j++) {
             if (m_slaves[i]->p_ib_ctx == m_slaves[j]->p_ib_ctx) {
                 found =
                     true; // two slaves might be on two ports of the same device, register only once
@@ -1297,8 +1308,8 @@ void net_device_val::register_to_ibverbs_events(event_handler_ibverbs *handler)
 void net_device_val::unregister_to_ibverbs_events(event_handler_ibverbs *handler)
 {
     for (size_t i = 0; i < m_slaves.size(); i++) {
-        bool found = false;
-        for (size_t j = 0; j < i; j++) {
+        bool found = !m_slaves[i]->p_ib_ctx; // software ring slaves have no device
+        for (size_t j = 0; j < i && !found; j++) {
             if (m_slaves[i]->p_ib_ctx == m_slaves[j]->p_ib_ctx) {
                 found = true; // two slaves might be on two ports of the same device, unregister
                               // only once
@@ -1414,7 +1425,15 @@ ring *net_device_val_eth::create_ring(resource_allocation_key *key)
     try {
         switch (m_bond) {
         case NO_BOND:
-            ring = new ring_eth(get_if_idx());
+            if (safe_mce_sys().ring_loopback) {
+                ring = new ring_loopback(get_if_idx());
+#if defined(DEFINED_XDP)
+            } else if (safe_mce_sys().ring_xdp) {
+                ring = new ring_xdp(get_if_idx());
+#endif /* DEFINED_XDP */
+            } else {
+                ring = new ring_eth(get_if_idx());
+            }
             break;
         case ACTIVE_BACKUP:
         case LAG_8023ad:
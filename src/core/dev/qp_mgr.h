@@ -190,7 +190,7 @@ public:
     virtual void modify_qp_to_ready_state() = 0;
     virtual void modify_qp_to_error_state();
 
-    void release_rx_buffers();
+    virtual void release_rx_buffers();
     void release_tx_buffers();
     virtual void trigger_completion_for_all_sent_packets();
     uint32_t is_ratelimit_change(struct xlio_rate_limit_t &rate_limit);
@@ -279,6 +279,18 @@ public:
         return true;
     }
     virtual void credits_return(unsigned credits) { NOT_IN_USE(credits); }
+    /* Doorbell batching. While enabled, WQEs are posted to the SQ without
+     * ringing the doorbell. ring_delayed_doorbell() submits all WQEs posted
+     * so far with a single doorbell. Disabling flushes pending WQEs unless
+     * flush is false, in which case the caller rings the doorbell later and
+     * a multi-packet WQE session may stay open until then.
+     */
+    virtual void set_delayed_doorbell(bool enable, bool flush = true)
+    {
+        NOT_IN_USE(enable);
+        NOT_IN_USE(flush);
+    }
+    virtual void ring_delayed_doorbell() {}
     inline unsigned credits_calculate(xlio_ibv_send_wr *p_send_wqe)
     {
         /* Credit is a logical value which is opaque for users. Only qp_mgr can interpret the
@@ -126,14 +126,23 @@ qp_mgr_eth_mlx5::qp_mgr_eth_mlx5(struct qp_mgr_desc *desc, const uint32_t tx_num
     , m_sq_wqe_prop_last_signalled(0)
     , m_sq_free_credits(0)
     , m_rq_wqe_counter(0)
+    , m_p_srq(NULL)
+    , m_srq_done(NULL)
+    , m_srq_done_cnt(0)
+    , m_srq_fill(0)
     , m_sq_wqes(NULL)
     , m_sq_wqe_hot(NULL)
     , m_sq_wqes_end(NULL)
     , m_sq_wqe_hot_index(0)
     , m_sq_wqe_counter(0)
     , m_b_fence_needed(false)
+    , m_b_db_delayed(false)
+    , m_sq_wqe_db_pending(nullptr)
+    , m_b_mpw_enabled(false)
     , m_dm_enabled(false)
 {
+    memset(&m_mpw, 0, sizeof(m_mpw));
+
     // Check device capabilities for dummy send support
     m_hw_dummy_send_support = xlio_is_nop_supported(m_p_ib_ctx_handler->get_ibv_device_attr());
 
@@ -202,6 +211,11 @@ void qp_mgr_eth_mlx5::init_qp()
     m_sq_wqe_hot->eseg.inline_hdr_sz = htons(MLX5_ETH_INLINE_HEADER_SIZE);
     m_sq_wqe_hot->eseg.cs_flags = XLIO_TX_PACKET_L3_CSUM | XLIO_TX_PACKET_L4_CSUM;
 
+    memset(&m_mpw, 0, sizeof(m_mpw));
+    m_b_mpw_enabled = safe_mce_sys().tx_mpw &&
+        xlio_ib_mlx5_is_empw_supported(m_p_ib_ctx_handler->get_ibv_context());
+    qp_logdbg("Enhanced multi-packet WQE is %s", m_b_mpw_enabled ? "enabled" : "disabled");
+
     qp_logfunc("%p allocated for %d QPs sq_wqes:%p sq_wqes_end: %p and configured %d WRs "
                "BlueFlame: %p buf_size: %d offset: %d",
                m_qp, m_mlx5_qp.qpn, m_sq_wqes, m_sq_wqes_end, m_tx_num_wr, m_mlx5_qp.bf.reg,
@@ -231,6 +245,10 @@ void qp_mgr_eth_mlx5::init_device_memory()
 void qp_mgr_eth_mlx5::up()
 {
     init_qp();
+    if (m_p_srq) {
+        // A ring fills only the WQEs which are missing in the shared queue
+        m_srq_fill = m_p_srq->get_deficit();
+    }
     qp_mgr::up();
     init_device_memory();
 }
@@ -242,6 +260,11 @@ void qp_mgr_eth_mlx5::down()
     }
 
     qp_mgr::down();
+
+    if (m_p_srq) {
+        // Release the WQEs of the completions consumed by the CQ cleanup
+        srq_post(0);
+    }
 }
 
 void qp_mgr_eth_mlx5::destroy_tis_cache(void)
@@ -269,6 +292,22 @@ void qp_mgr_eth_mlx5::update_next_wqe_hot()
 //! Cleanup resources QP itself will be freed by base class DTOR
 qp_mgr_eth_mlx5::~qp_mgr_eth_mlx5()
 {
+    if (m_p_srq) {
+        srq_post(0);
+        // The SRQ can be destroyed only after the last QP attached to it
+        if (m_qp) {
+            IF_VERBS_FAILURE_EX(ibv_destroy_qp(m_qp), EIO)
+            {
+                qp_logdbg("QP destroy failure (errno = %d %m)", -errno);
+            }
+            ENDIF_VERBS_FAILURE;
+            m_qp = NULL;
+        }
+        m_p_ib_ctx_handler->put_srq_mgr();
+        m_p_srq = NULL;
+        delete[] m_srq_done;
+        m_srq_done = NULL;
+    }
     if (m_rq_wqe_idx_to_wrid) {
         if (0 != munmap(m_rq_wqe_idx_to_wrid, m_rx_num_wr * sizeof(*m_rq_wqe_idx_to_wrid))) {
             qp_logerr("Failed deallocating memory with munmap m_rq_wqe_idx_to_wrid (errno=%d %m)",
@@ -292,7 +331,79 @@ void qp_mgr_eth_mlx5::post_recv_buffer(mem_buf_desc_t *p_mem_buf_desc)
     m_ibv_rx_sg_array[m_curr_rx_wr].length = p_mem_buf_desc->sz_buffer;
     m_ibv_rx_sg_array[m_curr_rx_wr].lkey = p_mem_buf_desc->lkey;
 
-    post_recv_buffer_rq(p_mem_buf_desc);
+    if (m_p_srq) {
+        post_recv_buffer_srq(p_mem_buf_desc);
+    } else {
+        post_recv_buffer_rq(p_mem_buf_desc);
+    }
+}
+
+uint32_t qp_mgr_eth_mlx5::get_rx_max_wr_num()
+{
+    return (m_p_srq ? m_srq_fill : m_rx_num_wr);
+}
+
+void qp_mgr_eth_mlx5::post_recv_buffer_srq(mem_buf_desc_t *p_mem_buf_desc)
+{
+    // SRQ WQEs complete out of order, so there is no next buffer to prefetch
+    p_mem_buf_desc->p_prev_desc = NULL;
+    m_ibv_rx_wr_array[m_curr_rx_wr].wr_id = (uintptr_t)p_mem_buf_desc;
+
+    if (++m_curr_rx_wr == m_n_sysvar_rx_num_wr_to_post_recv) {
+        srq_post(m_curr_rx_wr);
+        m_curr_rx_wr = 0;
+    }
+}
+
+void qp_mgr_eth_mlx5::srq_post(uint32_t n_wr)
+{
+    uint32_t posted = m_p_srq->post_recv(m_srq_done, m_srq_done_cnt, m_ibv_rx_wr_array, n_wr);
+    m_srq_done_cnt = 0;
+
+    // Other rings have filled the shared queue meanwhile
+    for (uint32_t i = posted; i < n_wr; ++i) {
+        g_buffer_pool_rx_rwqe->put_buffers_thread_safe(
+            (mem_buf_desc_t *)(uintptr_t)m_ibv_rx_wr_array[i].wr_id);
+    }
+    if (posted) {
+        m_last_posted_rx_wr_id = m_ibv_rx_wr_array[posted - 1].wr_id;
+        qp_logfunc("Successful SRQ post of %u WQEs", posted);
+    }
+
+    m_p_ring->m_p_ring_stat->simple.n_rx_srq_posted = m_p_srq->get_posted();
+}
+
+void qp_mgr_eth_mlx5::release_rx_buffers()
+{
+    if (!m_p_srq) {
+        qp_mgr::release_rx_buffers();
+        return;
+    }
+
+    /* Posted buffers stay in the shared queue and QP error state doesn't flush
+     * them, so only the batch which is not posted yet is returned.
+     */
+    if (m_curr_rx_wr) {
+        qp_logdbg("Returning %d pending post_recv buffers to CQ owner", m_curr_rx_wr);
+        while (m_curr_rx_wr) {
+            --m_curr_rx_wr;
+            mem_buf_desc_t *p_mem_buf_desc =
+                (mem_buf_desc_t *)(uintptr_t)m_ibv_rx_wr_array[m_curr_rx_wr].wr_id;
+            m_p_ring->mem_buf_desc_return_to_owner_rx(p_mem_buf_desc);
+        }
+    }
+    m_last_posted_rx_wr_id = 0;
+}
+
+int qp_mgr_eth_mlx5::prepare_ibv_qp(xlio_ibv_qp_init_attr &qp_init_attr)
+{
+    if (m_p_srq) {
+        qp_init_attr.srq = m_p_srq->get_ibv_srq();
+        qp_init_attr.cap.max_recv_wr = 0;
+        qp_init_attr.cap.max_recv_sge = 0;
+    }
+
+    return qp_mgr_eth::prepare_ibv_qp(qp_init_attr);
 }
 
 void qp_mgr_eth_mlx5::post_recv_buffer_rq(mem_buf_desc_t *p_mem_buf_desc)
@@ -348,6 +459,19 @@ void qp_mgr_eth_mlx5::post_recv_buffer_rq(mem_buf_desc_t *p_mem_buf_desc)
 
 bool qp_mgr_eth_mlx5::init_rx_cq_mgr_prepare()
 {
+    if (safe_mce_sys().rx_srq_num_wr) {
+        m_p_srq = m_p_ib_ctx_handler->get_srq_mgr();
+    }
+    if (m_p_srq) {
+        m_srq_done = new uint16_t[m_n_sysvar_rx_num_wr_to_post_recv];
+        m_srq_done_cnt = 0;
+        // Completions of the whole shared queue can land on this CQ
+        m_rx_num_wr = m_p_srq->get_size();
+        m_p_ring->m_p_ring_stat->simple.n_rx_srq_size = m_rx_num_wr;
+        qp_logdbg("Using shared receive queue %p of %u WQEs", m_p_srq, m_rx_num_wr);
+        return true;
+    }
+
     m_rx_num_wr = align32pow2(m_rx_num_wr);
 
     m_rq_wqe_idx_to_wrid =
@@ -385,7 +509,8 @@ inline void qp_mgr_eth_mlx5::ring_doorbell(int db_method, int num_wqebb, int num
     /* TODO Refactor m_n_unsignedled_count, is_completion_need(), set_unsignaled_count():
      * Some logic is hidden inside the methods and in one branch the field is changed directly.
      */
-    if (!skip_comp && is_completion_need()) {
+    // A delayed batch requests a single completion, see ring_delayed_doorbell()
+    if (!skip_comp && !m_b_db_delayed && is_completion_need()) {
         ctrl->fm_ce_se |= MLX5_WQE_CTRL_CQ_UPDATE;
     }
     if (ctrl->fm_ce_se & MLX5_WQE_CTRL_CQ_UPDATE) {
@@ -400,6 +525,15 @@ inline void qp_mgr_eth_mlx5::ring_doorbell(int db_method, int num_wqebb, int num
 
     m_sq_wqe_counter = (m_sq_wqe_counter + num_wqebb + num_wqebb_top) & 0xFFFF;
 
+    if (m_b_db_delayed) {
+        // The WQE is in place, HW is notified by ring_delayed_doorbell()
+        m_sq_wqe_db_pending = m_sq_wqe_hot;
+        return;
+    }
+
+    // This doorbell also covers WQEs left pending by a deferred batch
+    m_sq_wqe_db_pending = nullptr;
+
     // Make sure that descriptors are written before
     // updating doorbell record and ringing the doorbell
     wmb();
@@ -432,6 +566,36 @@ inline void qp_mgr_eth_mlx5::ring_doorbell(int db_method, int num_wqebb, int num
     m_mlx5_qp.bf.offset ^= m_mlx5_qp.bf.size;
 }
 
+void qp_mgr_eth_mlx5::ring_delayed_doorbell()
+{
+    mpw_close();
+
+    if (!m_sq_wqe_db_pending) {
+        return;
+    }
+
+    uint64_t *dst = (uint64_t *)((uint8_t *)m_mlx5_qp.bf.reg + m_mlx5_qp.bf.offset);
+    struct xlio_mlx5_wqe_ctrl_seg *ctrl =
+        reinterpret_cast<struct xlio_mlx5_wqe_ctrl_seg *>(m_sq_wqe_db_pending);
+
+    // The last WQE of the batch is signaled, its completion releases the whole batch
+    if (!(ctrl->fm_ce_se & MLX5_WQE_CTRL_CQ_UPDATE)) {
+        ctrl->fm_ce_se |= MLX5_WQE_CTRL_CQ_UPDATE;
+        set_unsignaled_count();
+    }
+
+    // A single DB record update and doorbell covers all the WQEs posted since
+    // the last doorbell. The doorbell carries the control segment of the last WQE.
+    wmb();
+    *m_mlx5_qp.sq.dbrec = htonl(m_sq_wqe_counter);
+    wc_wmb();
+    *dst = *reinterpret_cast<uint64_t *>(m_sq_wqe_db_pending);
+    wc_wmb();
+    m_mlx5_qp.bf.offset ^= m_mlx5_qp.bf.size;
+
+    m_sq_wqe_db_pending = nullptr;
+}
+
 inline int qp_mgr_eth_mlx5::fill_inl_segment(sg_array &sga, uint8_t *cur_seg, uint8_t *data_addr,
                                              int max_inline_len, int inline_len)
 {
@@ -747,6 +911,7 @@ void qp_mgr_eth_mlx5::store_current_wqe_prop(mem_buf_desc_t *buf, unsigned credi
     m_sq_wqe_idx_to_prop[m_sq_wqe_hot_index] = sq_wqe_prop {
         .buf = buf,
         .credits = credits,
+        .buf_list = false,
         .ti = ti,
         .next = m_sq_wqe_prop_last,
     };
@@ -756,6 +921,88 @@ void qp_mgr_eth_mlx5::store_current_wqe_prop(mem_buf_desc_t *buf, unsigned credi
     }
 }
 
+/*
+ * Appends a packet to the open enhanced multi-packet WQE, opening a new one if
+ * needed. Packets are inlined, so the WQE never refers to the buffers, but the
+ * buffers are kept until completion like for regular WQEs.
+ * Returns false if the packet must be posted as a regular WQE.
+ */
+inline bool qp_mgr_eth_mlx5::mpw_append(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_attr attr,
+                                        unsigned credits)
+{
+    if (xlio_send_wr_opcode(*p_send_wqe) != XLIO_IBV_WR_SEND || p_send_wqe->num_sge != 1 ||
+        p_send_wqe->sg_list[0].length > get_max_inline_data()) {
+        return false;
+    }
+
+    uint32_t len = p_send_wqe->sg_list[0].length;
+    uint16_t seg_ds = m_mpw.seg_ds(len);
+    uint8_t cs_flags = (uint8_t)(attr & (XLIO_TX_PACKET_L3_CSUM | XLIO_TX_PACKET_L4_CSUM) & 0xff);
+
+    if (m_mpw.wqe && m_mpw.must_close(seg_ds, cs_flags, m_sq_wqes_end)) {
+        mpw_close_session();
+    }
+
+    if (!m_mpw.wqe) {
+        if (!m_mpw.can_open((uint8_t *)m_sq_wqe_hot, seg_ds, m_sq_wqes_end, credits)) {
+            return false;
+        }
+
+        struct xlio_mlx5_wqe_ctrl_seg *ctrl = (struct xlio_mlx5_wqe_ctrl_seg *)m_sq_wqe_hot;
+        struct mlx5_wqe_eth_seg *eseg =
+            (struct mlx5_wqe_eth_seg *)((uint8_t *)m_sq_wqe_hot + sizeof(*ctrl));
+
+        ctrl->opmod_idx_opcode =
+            htonl(((m_sq_wqe_counter & 0xffff) << 8) | XLIO_MLX5_OPCODE_ENHANCED_MPSW);
+        ctrl->fm_ce_se = 0;
+        ctrl->tis_tir_num = 0;
+        // Only the first 16 bytes of eth segment are used, there is no inline header
+        *((uint64_t *)eseg) = 0;
+        eseg->rsvd2 = 0;
+        eseg->cs_flags = cs_flags;
+        eseg->inline_hdr_sz = 0;
+        *(uint16_t *)eseg->inline_hdr_start = 0;
+
+        m_mpw.open((uint8_t *)m_sq_wqe_hot, cs_flags);
+    }
+
+    unsigned grow = m_mpw.grow_wqebbs(seg_ds);
+    if (grow > credits) {
+        mpw_close_session();
+        return false;
+    }
+
+    // Inline data segment
+    uint8_t *data = m_mpw.append(seg_ds, reinterpret_cast<mem_buf_desc_t *>(p_send_wqe->wr_id));
+    *(uint32_t *)data = htonl(0x80000000 | len);
+    memcpy(data + 4, (void *)(uintptr_t)p_send_wqe->sg_list[0].addr, len);
+
+    // The WQE holds only the WQEBBs it actually grew by
+    credits_return(credits - grow);
+
+    return true;
+}
+
+void qp_mgr_eth_mlx5::mpw_close_session()
+{
+    unsigned wqebbs = m_mpw.wqebbs(m_mpw.ds);
+
+    ((struct xlio_mlx5_wqe_ctrl_seg *)m_mpw.wqe)->qpn_ds = htonl((m_mlx5_qp.qpn << 8) | m_mpw.ds);
+
+    store_current_wqe_prop(m_mpw.buf_head, wqebbs, nullptr);
+    m_sq_wqe_idx_to_prop[m_sq_wqe_hot_index].buf_list = true;
+
+    ring_stats_t *p_ring_stat = m_p_ring->m_p_ring_stat.get();
+    ++p_ring_stat->simple.n_tx_mpw_wqes;
+    p_ring_stat->simple.n_tx_mpw_packets += m_mpw.pkts;
+    p_ring_stat->simple.n_tx_mpw_wqebbs += wqebbs;
+
+    m_mpw.wqe = nullptr;
+    // BlueFlame buffer is limited to 4 WQEBBs
+    ring_doorbell(wqebbs <= 4 ? m_db_method : MLX5_DB_METHOD_DB, wqebbs);
+    update_next_wqe_hot();
+}
+
 //! Send one RAW packet by MLX5 BlueFlame
 //
 int qp_mgr_eth_mlx5::send_to_wire(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_attr attr,
@@ -765,6 +1012,13 @@ int qp_mgr_eth_mlx5::send_to_wire(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packe
     struct mlx5_wqe_eth_seg *eseg = NULL;
     uint32_t tisn = tis ? tis->get_tisn() : 0;
 
+    // Packets which request a completion are not delayed by packing
+    if (m_b_mpw_enabled && m_b_db_delayed && !tis && !request_comp &&
+        mpw_append(p_send_wqe, attr, credits)) {
+        return 0;
+    }
+    mpw_close();
+
     ctrl = (struct xlio_mlx5_wqe_ctrl_seg *)m_sq_wqe_hot;
     eseg = (struct mlx5_wqe_eth_seg *)((uint8_t *)m_sq_wqe_hot + sizeof(*ctrl));
 
@@ -1042,6 +1296,8 @@ inline void qp_mgr_eth_mlx5::tls_post_static_params_wqe(xlio_ti *ti,
                                                         uint32_t resync_tcp_sn, bool fence,
                                                         bool is_tx)
 {
+    mpw_close();
+
     struct mlx5_set_tls_static_params_wqe *wqe =
         reinterpret_cast<struct mlx5_set_tls_static_params_wqe *>(m_sq_wqe_hot);
     struct xlio_mlx5_wqe_ctrl_seg *cseg = &wqe->ctrl.ctrl;
@@ -1149,6 +1405,8 @@ inline void qp_mgr_eth_mlx5::tls_post_progress_params_wqe(xlio_ti *ti, uint32_t
                                                           uint32_t next_record_tcp_sn, bool fence,
                                                           bool is_tx)
 {
+    mpw_close();
+
     uint16_t num_wqebbs = TLS_SET_PROGRESS_PARAMS_WQEBBS;
 
     struct mlx5_set_tls_progress_params_wqe *wqe =
@@ -1180,6 +1438,8 @@ inline void qp_mgr_eth_mlx5::tls_post_progress_params_wqe(xlio_ti *ti, uint32_t
 inline void qp_mgr_eth_mlx5::tls_get_progress_params_wqe(xlio_ti *ti, uint32_t tirn, void *buf,
                                                          uint32_t lkey)
 {
+    mpw_close();
+
     uint16_t num_wqebbs = TLS_GET_PROGRESS_WQEBBS;
 
     struct mlx5_get_tls_progress_params_wqe *wqe =
@@ -1341,6 +1601,8 @@ static inline void nvme_fill_progress_wqe(mlx5e_set_nvmeotcp_progress_params_wqe
 
 void qp_mgr_eth_mlx5::nvme_set_static_context(xlio_tis *tis, uint32_t config)
 {
+    mpw_close();
+
     auto *cseg = wqebb_get<xlio_mlx5_wqe_ctrl_seg *>(0U);
     auto *ucseg = wqebb_get<xlio_mlx5_wqe_umr_ctrl_seg *>(0U, sizeof(*cseg));
 
@@ -1357,6 +1619,8 @@ void qp_mgr_eth_mlx5::nvme_set_static_context(xlio_tis *tis, uint32_t config)
 
 void qp_mgr_eth_mlx5::nvme_set_progress_context(xlio_tis *tis, uint32_t tcp_seqno)
 {
+    mpw_close();
+
     auto *wqe = reinterpret_cast<mlx5e_set_nvmeotcp_progress_params_wqe *>(m_sq_wqe_hot);
     nvme_fill_progress_wqe(wqe, m_sq_wqe_counter, m_mlx5_qp.qpn, tis->get_tisn(), tcp_seqno,
                            MLX5_FENCE_MODE_INITIATOR_SMALL);
@@ -1396,6 +1660,8 @@ void qp_mgr_eth_mlx5::put_tir_in_cache(xlio_tir *tir)
 
 void qp_mgr_eth_mlx5::post_nop_fence(void)
 {
+    mpw_close();
+
     struct mlx5_wqe *wqe = reinterpret_cast<struct mlx5_wqe *>(m_sq_wqe_hot);
     struct xlio_mlx5_wqe_ctrl_seg *cseg = &wqe->ctrl;
 
@@ -1415,6 +1681,8 @@ void qp_mgr_eth_mlx5::post_nop_fence(void)
 void qp_mgr_eth_mlx5::post_dump_wqe(xlio_tis *tis, void *addr, uint32_t len, uint32_t lkey,
                                     bool is_first)
 {
+    mpw_close();
+
     struct mlx5_dump_wqe *wqe = reinterpret_cast<struct mlx5_dump_wqe *>(m_sq_wqe_hot);
     struct xlio_mlx5_wqe_ctrl_seg *cseg = &wqe->ctrl.ctrl;
     struct mlx5_wqe_data_seg *dseg = &wqe->data;
@@ -1510,9 +1778,11 @@ void qp_mgr_eth_mlx5::reset_inflight_zc_buffers_ctx(void *ctx)
             return;
         }
         do {
-            mem_buf_desc_t *desc = p->buf;
-            if (desc && desc->tx.zc.ctx == ctx) {
-                desc->tx.zc.ctx = nullptr;
+            for (mem_buf_desc_t *desc = p->buf; desc;
+                 desc = p->buf_list ? desc->p_next_desc : nullptr) {
+                if (desc->tx.zc.ctx == ctx) {
+                    desc->tx.zc.ctx = nullptr;
+                }
             }
             prev = p;
             p = p->next;
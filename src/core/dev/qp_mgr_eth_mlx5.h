@@ -36,6 +36,8 @@
 #include "qp_mgr.h"
 #include "util/sg_array.h"
 #include "dev/dm_mgr.h"
+#include "dev/mpw_session.h"
+#include "dev/srq_mgr.h"
 #include <list>
 #include <vector>
 
@@ -55,6 +57,8 @@ struct sq_wqe_prop {
     mem_buf_desc_t *buf;
     /* Number of credits (usually number of WQEBBs). */
     unsigned credits;
+    /* buf is a p_next_desc list of the packets of a multi-packet WQE. */
+    bool buf_list;
     /* Transport interface (TIS/TIR) current WQE holds reference to. */
     xlio_ti *ti;
     struct sq_wqe_prop *next;
@@ -72,6 +76,7 @@ public:
     void down() override;
     void post_recv_buffer(
         mem_buf_desc_t *p_mem_buf_desc) override; // Post for receive single mem_buf_desc
+    uint32_t get_rx_max_wr_num() override;
     xlio_ib_mlx5_qp_t m_mlx5_qp;
 
 #ifdef DEFINED_UTLS
@@ -130,9 +135,32 @@ public:
         return false;
     }
     void credits_return(unsigned credits) override { m_sq_free_credits += credits; }
+    void set_delayed_doorbell(bool enable, bool flush = true) override
+    {
+        /* Without flush an open multi-packet WQE is kept, so the next delayed post can
+         * extend it. Any regular post closes it first, ring_delayed_doorbell() as well.
+         */
+        if (!enable && flush) {
+            ring_delayed_doorbell();
+        }
+        m_b_db_delayed = enable;
+    }
+    void ring_delayed_doorbell() override;
 
 protected:
     void post_recv_buffer_rq(mem_buf_desc_t *p_mem_buf_desc);
+    void post_recv_buffer_srq(mem_buf_desc_t *p_mem_buf_desc);
+    void srq_post(uint32_t n_wr);
+    inline mem_buf_desc_t *srq_take_buf(uint16_t index)
+    {
+        if (unlikely(m_srq_done_cnt == m_n_sysvar_rx_num_wr_to_post_recv)) {
+            srq_post(0);
+        }
+        m_srq_done[m_srq_done_cnt++] = index;
+        return m_p_srq->take_buf(index);
+    }
+    void release_rx_buffers() override;
+    int prepare_ibv_qp(xlio_ibv_qp_init_attr &qp_init_attr) override;
     void trigger_completion_for_all_sent_packets() override;
     bool init_rx_cq_mgr_prepare();
     void init_qp();
@@ -158,6 +186,15 @@ protected:
     unsigned m_sq_free_credits;
     uint64_t m_rq_wqe_counter;
 
+    /* Shared receive queue of the device or NULL if the QP owns its RQ.
+     * Indexes of consumed SRQ WQEs are collected in m_srq_done and released
+     * together with the next repost.
+     */
+    srq_mgr *m_p_srq;
+    uint16_t *m_srq_done;
+    uint32_t m_srq_done_cnt;
+    uint32_t m_srq_fill;
+
 private:
     void update_next_wqe_hot();
 
@@ -170,6 +207,15 @@ private:
     int send_to_wire(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_attr attr, bool request_comp,
                      xlio_tis *tis, unsigned credits) override;
     inline int fill_wqe(xlio_ibv_send_wr *p_send_wqe);
+    inline bool mpw_append(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_attr attr,
+                           unsigned credits);
+    void mpw_close_session();
+    inline void mpw_close()
+    {
+        if (unlikely(m_mpw.wqe != nullptr)) {
+            mpw_close_session();
+        }
+    }
     inline void store_current_wqe_prop(mem_buf_desc_t *wr_id, unsigned credits, xlio_ti *ti);
     void destroy_tis_cache(void);
 
@@ -212,6 +258,16 @@ private:
     uint16_t m_sq_wqe_counter;
 
     bool m_b_fence_needed;
+    bool m_b_db_delayed;
+    // Control segment of the last WQE posted while the doorbell is delayed
+    struct mlx5_eth_wqe *m_sq_wqe_db_pending;
+
+    /* Enhanced multi-packet send WQE. While the doorbell is delayed, small
+     * packets are appended inline to one open WQE at m_sq_wqe_hot, which is
+     * completed when an incompatible WQE is posted or the doorbell is rung.
+     */
+    bool m_b_mpw_enabled;
+    mpw_session<mem_buf_desc_t> m_mpw;
 
     bool m_dm_enabled;
     dm_mgr m_dm_mgr;
@@ -52,6 +52,9 @@ public:
 
     virtual bool rx_dispatch_packet(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd_ready_array);
 
+    // GRO flows hold aggregated packets until gro_mgr flushes them
+    virtual void flush(void *pv_fd_ready_array) { NOT_IN_USE(pv_fd_ready_array); }
+
 protected:
     virtual bool prepare_flow_spec();
 
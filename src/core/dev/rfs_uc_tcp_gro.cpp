@@ -41,6 +41,9 @@
 #define TCP_H_LEN_NO_OPTIONS 5
 #define TCP_H_LEN_TIMESTAMP  8
 
+#define TCP_H_FLAG_ECE 0x40U
+#define TCP_H_FLAG_CWR 0x80U
+
 inline uint32_t ipv6_get_flowid(const struct ip6_hdr &p_ip6_h)
 {
     const uint8_t *raw = reinterpret_cast<const uint8_t *>(&(p_ip6_h.ip6_flow));
@@ -48,6 +51,17 @@ inline uint32_t ipv6_get_flowid(const struct ip6_hdr &p_ip6_h)
             static_cast<uint32_t>(raw[3]));
 }
 
+inline uint8_t ipv6_get_ecn(const struct ip6_hdr &p_ip6_h)
+{
+    return static_cast<uint8_t>((ntohl(p_ip6_h.ip6_flow) >> 20) & IPTOS_ECN_MASK);
+}
+
+inline uint8_t tcp_get_ecn_flags(const struct tcphdr &p_tcp_h)
+{
+    // glibc folds ECE and CWR into res2, read them from the flags byte.
+    return reinterpret_cast<const uint8_t *>(&p_tcp_h)[13] & (TCP_H_FLAG_ECE | TCP_H_FLAG_CWR);
+}
+
 inline bool ipv4_check(const struct iphdr &p_ip_h)
 {
     return (p_ip_h.ihl == IP_H_LEN_NO_OPTIONS);
@@ -85,6 +99,7 @@ bool rfs_uc_tcp_gro::rx_dispatch_packet(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_in
     struct tcphdr *p_tcp_h = p_rx_pkt_mem_buf_desc_info->rx.tcp.p_tcp_h;
     uint16_t explicit_hdr_len; // L3 header size is not included in IPv6 payload field.
     uint16_t tot_len;
+    uint8_t ecn;
 
     if (!m_b_active) {
         if (!m_b_reserved && m_p_gro_mgr->is_stream_max()) {
@@ -102,6 +117,7 @@ bool rfs_uc_tcp_gro::rx_dispatch_packet(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_in
 
         // For IPv4 we keep tracking in GRO the tot-len including the header size.
         tot_len = ntohs(p_ip_h->tot_len);
+        ecn = p_ip_h->tos & IPTOS_ECN_MASK;
     } else {
         if (unlikely(!ipv6_check(*p_ip6_h))) {
             goto out;
@@ -112,6 +128,7 @@ bool rfs_uc_tcp_gro::rx_dispatch_packet(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_in
 
         // For IPv6 we keep tracking in GRO the tot-len without the header size.
         tot_len = ntohs(p_ip6_h->ip6_plen);
+        ecn = ipv6_get_ecn(*p_ip6_h);
     }
 
     if (unlikely(!tcp_check(p_rx_pkt_mem_buf_desc_info, p_tcp_h))) {
@@ -122,13 +139,18 @@ bool rfs_uc_tcp_gro::rx_dispatch_packet(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_in
         if (!m_b_reserved) {
             m_b_reserved = m_p_gro_mgr->reserve_stream(this);
         }
-        init_gro_desc(p_rx_pkt_mem_buf_desc_info, tot_len, p_tcp_h);
+        init_gro_desc(p_rx_pkt_mem_buf_desc_info, tot_len, p_tcp_h, ecn);
         m_b_active = true;
     } else {
         if ((ntohl(p_tcp_h->seq) != m_gro_desc.next_seq) || !timestamp_check(p_tcp_h)) {
             goto out;
         }
 
+        /* Only the headers of the first segment survive, so keep the ECN marks exact */
+        if (ecn != m_gro_desc.ecn || tcp_get_ecn_flags(*p_tcp_h) != tcp_get_ecn_flags(*m_gro_desc.p_tcp_h)) {
+            goto out;
+        }
+
         void *payload_ptr = reinterpret_cast<u8_t *>(p_rx_pkt_mem_buf_desc_info->p_buffer) +
             p_rx_pkt_mem_buf_desc_info->rx.n_transport_header_len + explicit_hdr_len + tot_len -
             p_rx_pkt_mem_buf_desc_info->rx.sz_payload;
@@ -265,7 +287,7 @@ void rfs_uc_tcp_gro::flush_gro_desc(void *pv_fd_ready_array)
 }
 
 void rfs_uc_tcp_gro::init_gro_desc(mem_buf_desc_t *mem_buf_desc, uint16_t ip_tot_len_pkt,
-                                   tcphdr *p_tcp_h)
+                                   tcphdr *p_tcp_h, uint8_t ecn)
 {
     m_gro_desc.p_first = m_gro_desc.p_last = mem_buf_desc;
     m_gro_desc.buf_count = 1;
@@ -274,6 +296,7 @@ void rfs_uc_tcp_gro::init_gro_desc(mem_buf_desc_t *mem_buf_desc, uint16_t ip_tot
     m_gro_desc.ack = p_tcp_h->ack_seq;
     m_gro_desc.next_seq = ntohl(p_tcp_h->seq) + mem_buf_desc->rx.sz_payload;
     m_gro_desc.wnd = p_tcp_h->window;
+    m_gro_desc.ecn = ecn;
     m_gro_desc.ts_present = 0;
     if (p_tcp_h->doff == TCP_H_LEN_TIMESTAMP) {
         uint32_t *topt = (uint32_t *)(p_tcp_h + 1);
@@ -289,7 +312,8 @@ bool rfs_uc_tcp_gro::tcp_check(mem_buf_desc_t *mem_buf_desc, tcphdr *p_tcp_h)
         return false;
     }
 
-    if (p_tcp_h->urg || !p_tcp_h->ack || p_tcp_h->rst || p_tcp_h->syn || p_tcp_h->fin) {
+    if (p_tcp_h->urg || !p_tcp_h->ack || p_tcp_h->rst || p_tcp_h->syn || p_tcp_h->fin ||
+        (tcp_get_ecn_flags(*p_tcp_h) & TCP_H_FLAG_CWR)) {
         return false;
     }
 
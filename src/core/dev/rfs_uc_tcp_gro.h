@@ -54,6 +54,7 @@ struct gro_mem_buf_desc {
     uint32_t tsecr;
     uint16_t ip_tot_len;
     uint16_t wnd;
+    uint8_t ecn;
 } typedef gro_mem_buf_desc_t;
 
 class gro_mgr;
@@ -72,13 +73,13 @@ public:
 
     virtual bool rx_dispatch_packet(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd_ready_array);
 
-    void flush(void *pv_fd_ready_array);
+    void flush(void *pv_fd_ready_array) override;
 
 private:
     inline void flush_gro_desc(void *pv_fd_ready_array);
     inline bool add_packet(mem_buf_desc_t *mem_buf_desc, void *payload_ptr, tcphdr *p_tcp_h);
     inline void init_gro_desc(mem_buf_desc_t *mem_buf_desc, uint16_t ip_tot_len_pkt,
-                              tcphdr *p_tcp_h);
+                              tcphdr *p_tcp_h, uint8_t ecn);
     inline bool tcp_check(mem_buf_desc_t *mem_buf_desc, tcphdr *p_tcp_h);
     inline bool timestamp_check(tcphdr *p_tcp_h);
 
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "utils/bullseye.h"
+#include "dev/rfs_uc_udp_gro.h"
+#include "dev/gro_mgr.h"
+#include "dev/ring_simple.h"
+#include "sock/pkt_rcvr_sink.h"
+
+#define MODULE_NAME "rfs_uc_udp_gro"
+
+rfs_uc_udp_gro::rfs_uc_udp_gro(flow_tuple *flow_spec_5t, ring_slave *p_ring,
+                               rfs_rule_filter *rule_filter, uint32_t flow_tag_id)
+    : rfs_uc(flow_spec_5t, p_ring, rule_filter, flow_tag_id)
+    , m_b_active(false)
+    , m_b_reserved(false)
+    , m_b_closed(false)
+    , m_p_first(NULL)
+    , m_p_last(NULL)
+    , m_buf_count(0)
+    , m_seg_size(0)
+{
+    ring_simple *p_check_ring = dynamic_cast<ring_simple *>(p_ring);
+
+    if (!p_check_ring) {
+        rfs_logpanic("Incompatible ring type");
+    }
+
+    m_p_gro_mgr = &(p_check_ring->m_gro_mgr);
+    m_n_buf_max = m_p_gro_mgr->get_buf_max();
+    m_n_byte_max = m_p_gro_mgr->get_byte_max();
+}
+
+bool rfs_uc_udp_gro::rx_dispatch_packet(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_info,
+                                        void *pv_fd_ready_array /* = NULL */)
+{
+    // Coalesced datagram is understood only by a receiver which asked for it
+    if (m_n_sinks_list_entries != 1 || !m_sinks_list[0] || !m_sinks_list[0]->rx_gro_enabled()) {
+        goto out;
+    }
+
+    // Reassembled IP fragments and empty datagrams are not aggregated
+    if (p_rx_pkt_mem_buf_desc_info->rx.n_frags != 1 ||
+        p_rx_pkt_mem_buf_desc_info->rx.sz_payload == 0) {
+        goto out;
+    }
+
+    if (!m_b_active) {
+        if (!m_b_reserved) {
+            m_b_reserved = m_p_gro_mgr->reserve_stream(this);
+            if (!m_b_reserved) {
+                goto out;
+            }
+        }
+        init_gro_desc(p_rx_pkt_mem_buf_desc_info);
+        return true;
+    }
+
+    if (!add_packet(p_rx_pkt_mem_buf_desc_info)) {
+        // The packet starts a new aggregation
+        flush_gro_desc(pv_fd_ready_array);
+        init_gro_desc(p_rx_pkt_mem_buf_desc_info);
+        return true;
+    }
+
+    /* Flush gro packet immediately in case
+     * total number of agreggated packets exceeds limit
+     */
+    if (m_buf_count >= m_n_buf_max) {
+        flush_gro_desc(pv_fd_ready_array);
+    }
+
+    return true;
+
+out:
+    if (likely(m_b_active)) {
+        flush_gro_desc(pv_fd_ready_array);
+    }
+
+    return rfs_uc::rx_dispatch_packet(p_rx_pkt_mem_buf_desc_info, pv_fd_ready_array);
+}
+
+bool rfs_uc_udp_gro::add_packet(mem_buf_desc_t *mem_buf_desc)
+{
+    size_t sz_payload = mem_buf_desc->rx.sz_payload;
+
+    // Same source, same size datagrams, a shorter one can be the last only
+    if (m_b_closed || sz_payload > m_seg_size ||
+        (m_p_first->rx.sz_payload + sz_payload) > m_n_byte_max ||
+        !(mem_buf_desc->rx.src == m_p_first->rx.src)) {
+        return false;
+    }
+
+    m_p_first->rx.sz_payload += sz_payload;
+    m_p_first->rx.n_frags++;
+    m_p_last->p_next_desc = mem_buf_desc;
+    mem_buf_desc->p_next_desc = NULL;
+    m_p_last = mem_buf_desc;
+    m_buf_count++;
+    m_b_closed = (sz_payload < m_seg_size);
+
+    return true;
+}
+
+void rfs_uc_udp_gro::flush(void *pv_fd_ready_array)
+{
+    flush_gro_desc(pv_fd_ready_array);
+    m_b_reserved = false;
+}
+
+void rfs_uc_udp_gro::flush_gro_desc(void *pv_fd_ready_array)
+{
+    ring_simple *p_ring = dynamic_cast<ring_simple *>(m_p_ring);
+
+    if (!p_ring) {
+        rfs_logpanic("Incompatible ring type");
+    }
+
+    if (!m_b_active) {
+        return;
+    }
+
+    if (m_buf_count > 1) {
+        m_p_first->rx.udp.gro_size = (uint16_t)m_seg_size;
+        m_p_first->rx.is_xlio_thr = m_p_last->rx.is_xlio_thr;
+    }
+
+    __log_func("Rx GRO UDP datagram info: src=%s, dst_port=%d, payload_sz=%zu, segment_sz=%u, "
+               "num_bufs=%u",
+               m_p_first->rx.src.to_str_ip_port().c_str(), ntohs(m_p_first->rx.dst.get_in_port()),
+               m_p_first->rx.sz_payload, m_seg_size, m_buf_count);
+
+    if (!rfs_uc::rx_dispatch_packet(m_p_first, pv_fd_ready_array)) {
+        p_ring->reclaim_recv_buffers_no_lock(m_p_first);
+    }
+
+    m_b_active = false;
+}
+
+void rfs_uc_udp_gro::init_gro_desc(mem_buf_desc_t *mem_buf_desc)
+{
+    m_p_first = m_p_last = mem_buf_desc;
+    m_buf_count = 1;
+    m_seg_size = mem_buf_desc->rx.sz_payload;
+    m_b_closed = false;
+    m_b_active = true;
+}
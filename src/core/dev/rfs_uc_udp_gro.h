@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RFS_UC_UDP_GRO_H
+#define RFS_UC_UDP_GRO_H
+
+#include "dev/rfs_uc.h"
+
+class gro_mgr;
+
+/**
+ * @class rfs_uc_udp_gro
+ *
+ * Object to manages the sink list of a UC UDP GRO flow
+ * Consecutive same size datagrams of a flow received in a single CQ poll batch are
+ * chained into one descriptor. The descriptor is delivered as a single datagram
+ * and the segment size is reported to the application with UDP_GRO cmsg.
+ * Coalescing is done only for a single sink which enabled UDP_GRO.
+ *
+ */
+class rfs_uc_udp_gro : public rfs_uc {
+public:
+    rfs_uc_udp_gro(flow_tuple *flow_spec_5t, ring_slave *p_ring,
+                   rfs_rule_filter *rule_filter = NULL, uint32_t flow_tag_id = 0);
+
+    virtual bool rx_dispatch_packet(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd_ready_array);
+
+    void flush(void *pv_fd_ready_array) override;
+
+private:
+    inline void flush_gro_desc(void *pv_fd_ready_array);
+    inline void init_gro_desc(mem_buf_desc_t *mem_buf_desc);
+    inline bool add_packet(mem_buf_desc_t *mem_buf_desc);
+
+    gro_mgr *m_p_gro_mgr;
+    bool m_b_active;
+    bool m_b_reserved;
+    bool m_b_closed; // Last datagram was shorter than the segment size
+    mem_buf_desc_t *m_p_first;
+    mem_buf_desc_t *m_p_last;
+    uint32_t m_buf_count;
+    uint32_t m_seg_size;
+    uint32_t m_n_buf_max;
+    uint32_t m_n_byte_max;
+};
+
+#endif /* RFS_UC_UDP_GRO_H */
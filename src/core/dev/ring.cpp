@@ -32,15 +32,49 @@
 
 #include "ring.h"
 #include "proto/route_table_mgr.h"
+#include "utils/lock_wrapper.h"
 
 #undef MODULE_NAME
 #define MODULE_NAME "ring"
 #undef MODULE_HDR
 #define MODULE_HDR MODULE_NAME "%d:%s() "
 
+/* Registry of rings taking part in thread TX scopes. A thread only keeps
+ * (slot, generation) pairs, so a ring destroyed while a doorbell is deferred
+ * is detected by the generation mismatch and skipped.
+ */
+struct ring_tx_scope_entry {
+    int slot;
+    uint32_t gen;
+};
+
+static lock_rw s_tx_scope_lock;
+static ring *s_tx_scope_rings[RING_TX_SCOPE_RINGS_MAX];
+static uint32_t s_tx_scope_gen[RING_TX_SCOPE_RINGS_MAX];
+
+__thread int g_ring_tx_scope_depth = 0;
+static __thread ring_tx_scope_entry t_tx_scope_pending[RING_TX_SCOPE_PENDING_MAX];
+static __thread int t_tx_scope_pending_num = 0;
+static __thread bool t_tx_scope_registered = false;
+static pthread_key_t s_tx_scope_key;
+static pthread_once_t s_tx_scope_key_once = PTHREAD_ONCE_INIT;
+
+static void tx_scope_thread_exit(void *)
+{
+    // A thread exiting with deferred doorbells, e.g. inside an unbalanced scope
+    ring::tx_scope_flush_all();
+}
+
+static void tx_scope_key_create()
+{
+    pthread_key_create(&s_tx_scope_key, tx_scope_thread_exit);
+}
+
 ring::ring()
     : m_p_n_rx_channel_fds(NULL)
     , m_parent(NULL)
+    , m_tx_scope_slot(-1)
+    , m_tx_scope_gen(0)
 {
     m_if_index = 0;
 
@@ -56,3 +90,90 @@ void ring::print_val()
     ring_logdbg("%d: %p: parent %p", m_if_index, this,
                 ((uintptr_t)this == (uintptr_t)m_parent ? 0 : m_parent));
 }
+
+int ring::tx_scope_end()
+{
+    if (g_ring_tx_scope_depth <= 0) {
+        return -1;
+    }
+    if (--g_ring_tx_scope_depth == 0) {
+        tx_scope_flush_all();
+    }
+    return 0;
+}
+
+void ring::tx_scope_flush_all()
+{
+    if (t_tx_scope_pending_num == 0) {
+        return;
+    }
+
+    s_tx_scope_lock.lock_rd();
+    for (int i = 0; i < t_tx_scope_pending_num; ++i) {
+        int slot = t_tx_scope_pending[i].slot;
+        if (s_tx_scope_rings[slot] && s_tx_scope_gen[slot] == t_tx_scope_pending[i].gen) {
+            s_tx_scope_rings[slot]->tx_scope_flush();
+        }
+    }
+    s_tx_scope_lock.unlock();
+    t_tx_scope_pending_num = 0;
+}
+
+void ring::tx_scope_register()
+{
+    s_tx_scope_lock.lock_wr();
+    for (int i = 0; i < RING_TX_SCOPE_RINGS_MAX; ++i) {
+        if (!s_tx_scope_rings[i]) {
+            s_tx_scope_rings[i] = this;
+            m_tx_scope_slot = i;
+            m_tx_scope_gen = s_tx_scope_gen[i];
+            break;
+        }
+    }
+    s_tx_scope_lock.unlock();
+
+    if (m_tx_scope_slot < 0) {
+        ring_logdbg("TX scope registry is full, doorbells are not deferred");
+    }
+}
+
+void ring::tx_scope_unregister()
+{
+    if (m_tx_scope_slot < 0) {
+        return;
+    }
+
+    s_tx_scope_lock.lock_wr();
+    s_tx_scope_rings[m_tx_scope_slot] = NULL;
+    ++s_tx_scope_gen[m_tx_scope_slot];
+    s_tx_scope_lock.unlock();
+    m_tx_scope_slot = -1;
+}
+
+bool ring::tx_scope_enroll()
+{
+    if (m_tx_scope_slot < 0) {
+        return false;
+    }
+    for (int i = 0; i < t_tx_scope_pending_num; ++i) {
+        if (t_tx_scope_pending[i].slot == m_tx_scope_slot) {
+            return true;
+        }
+    }
+    /* Flushing other rings here could deadlock against their TX locks,
+     * so the caller rings the doorbell immediately instead.
+     */
+    if (t_tx_scope_pending_num == RING_TX_SCOPE_PENDING_MAX) {
+        return false;
+    }
+    if (unlikely(!t_tx_scope_registered)) {
+        pthread_once(&s_tx_scope_key_once, tx_scope_key_create);
+        // Any non NULL value, so the key destructor is called on thread exit
+        pthread_setspecific(s_tx_scope_key, t_tx_scope_pending);
+        t_tx_scope_registered = true;
+    }
+    t_tx_scope_pending[t_tx_scope_pending_num].slot = m_tx_scope_slot;
+    t_tx_scope_pending[t_tx_scope_pending_num].gen = m_tx_scope_gen;
+    ++t_tx_scope_pending_num;
+    return true;
+}
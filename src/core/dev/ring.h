@@ -57,6 +57,13 @@ typedef enum { CQT_RX, CQT_TX } cq_type_t;
 
 typedef size_t ring_user_id_t;
 
+/* Maximum number of rings which can take part in thread TX scopes */
+#define RING_TX_SCOPE_RINGS_MAX 64
+/* Maximum number of rings with a deferred doorbell per thread */
+#define RING_TX_SCOPE_PENDING_MAX 16
+
+extern __thread int g_ring_tx_scope_depth;
+
 class ring {
 public:
     ring();
@@ -85,6 +92,12 @@ public:
                                   xlio_wr_tx_packet_attr attr) = 0;
     virtual int send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
                                  xlio_wr_tx_packet_attr attr, xlio_tis *tis) = 0;
+    /* TX batch. The ring TX lock is held between tx_batch_start() and
+     * tx_batch_end() and WQEs posted in between are submitted to HW with a
+     * single doorbell at the end of the batch. Batches can be nested.
+     */
+    virtual void tx_batch_start(ring_user_id_t id) { NOT_IN_USE(id); }
+    virtual void tx_batch_end(ring_user_id_t id) { NOT_IN_USE(id); }
 
     // Funcs taken from cq_mgr.h
     virtual int get_num_resources() const = 0;
@@ -237,14 +250,40 @@ public:
     }
     virtual void credits_return(unsigned credits) { NOT_IN_USE(credits); }
 
+    /* Thread TX scope. While the calling thread is inside a scope, registered
+     * rings post WQEs without ringing the doorbell. On exit from the outermost
+     * scope the thread rings a single doorbell per ring it has used, so
+     * replies to many sockets cost one MMIO write per ring. Scopes can be
+     * nested. tx_scope_end() returns -1 if there is no open scope.
+     * tx_scope_flush_all() rings the deferred doorbells without leaving the
+     * scope. It is called before the thread blocks in a socket call, on
+     * close() and on thread exit, so a scope never holds packets back while
+     * the thread waits.
+     */
+    static void tx_scope_begin() { ++g_ring_tx_scope_depth; }
+    static int tx_scope_end();
+    static void tx_scope_flush_all();
+
 protected:
     inline void set_parent(ring *parent) { m_parent = (parent ? parent : this); }
     inline void set_if_index(int if_index) { m_if_index = if_index; }
 
+    static inline bool tx_scope_active() { return g_ring_tx_scope_depth > 0; }
+    void tx_scope_register();
+    void tx_scope_unregister();
+    /* Adds the ring to the thread's pending list, must be called under the
+     * ring TX lock. Returns false if the doorbell cannot be deferred.
+     */
+    bool tx_scope_enroll();
+    /* Rings the deferred doorbell, called from tx_scope_flush_all() */
+    virtual void tx_scope_flush() {}
+
     int *m_p_n_rx_channel_fds;
     ring *m_parent;
 
     int m_if_index; /* Interface index */
+    int m_tx_scope_slot; /* Index in the TX scope registry, -1 if not registered */
+    uint32_t m_tx_scope_gen;
 };
 
 #endif /* RING_H */
@@ -436,6 +436,21 @@ void ring_bond::send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe
     }
 }
 
+void ring_bond::tx_batch_start(ring_user_id_t id)
+{
+    /* The bond TX lock stays taken until tx_batch_end(), so the active
+     * slave cannot be switched in the middle of the batch.
+     */
+    m_lock_ring_tx.lock();
+    m_xmit_rings[id]->tx_batch_start(id);
+}
+
+void ring_bond::tx_batch_end(ring_user_id_t id)
+{
+    m_xmit_rings[id]->tx_batch_end(id);
+    m_lock_ring_tx.unlock();
+}
+
 int ring_bond::send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
                                 xlio_wr_tx_packet_attr attr, xlio_tis *tis)
 {
@@ -0,0 +1,698 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ring_loopback.h"
+
+#include <sys/eventfd.h>
+#include "util/sg_array.h"
+#include "sock/fd_collection.h"
+#include "sock/sockinfo.h"
+#include "dev/net_device_table_mgr.h"
+
+#undef MODULE_NAME
+#define MODULE_NAME "ring_loopback"
+#undef MODULE_HDR
+#define MODULE_HDR MODULE_NAME "%d:%s() "
+
+ring_loopback::ring_loopback(int if_index, ring *parent)
+    : ring_slave(if_index, parent, RING_LOOPBACK)
+    , m_event_fd(-1)
+    , m_sysvar_qp_compensation_level(safe_mce_sys().qp_compensation_level)
+    , m_n_sysvar_cq_poll_batch_max(safe_mce_sys().cq_poll_batch_max)
+    , m_drop_rate(safe_mce_sys().ring_loopback_drop_rate)
+    , m_rand_state((uint32_t)getpid() | 1U)
+    , m_tso_max_payload_sz(0)
+    , m_latency_tsc(0)
+    , m_lock_rx_pool("ring_loopback:lock_rx_pool")
+    , m_cq(NULL)
+    , m_cq_mask(0)
+    , m_cq_head(0)
+    , m_cq_tail(0)
+    , m_armed(false)
+{
+    uint32_t cq_size = 1;
+
+    /* Completion ring holds up to rx_num_wr packets similar to HW RQ */
+    while (cq_size < safe_mce_sys().rx_num_wr) {
+        cq_size <<= 1;
+    }
+    m_cq = new loopback_cqe[cq_size];
+    m_cq_mask = cq_size - 1;
+
+    if (safe_mce_sys().ring_loopback_latency_usec) {
+        m_latency_tsc = get_tsc_rate_per_second() * safe_mce_sys().ring_loopback_latency_usec /
+            USEC_PER_SEC;
+    }
+    if (safe_mce_sys().enable_tso != option_3::OFF) {
+        m_tso_max_payload_sz = RING_LOOPBACK_TSO_MAX_PAYLOAD;
+    }
+    m_flow_tag_enabled = !safe_mce_sys().disable_flow_tag;
+    m_active = true;
+
+    /* Notification channel for blocking RX */
+    m_event_fd = eventfd(0, EFD_NONBLOCK);
+    if (m_event_fd < 0) {
+        ring_logpanic("eventfd failed (errno=%d %m)", errno);
+    }
+    m_p_n_rx_channel_fds = new int[1];
+    m_p_n_rx_channel_fds[0] = m_event_fd;
+    g_p_fd_collection->add_cq_channel_fd(m_event_fd, this);
+
+    /* Initialize RX buffer poll */
+    request_more_rx_buffers();
+    m_rx_pool.set_id("ring_loopback (%p) : m_rx_pool", this);
+
+    /* Initialize TX buffer poll */
+    request_more_tx_buffers(PBUF_RAM, m_sysvar_qp_compensation_level, 0);
+
+    ring_logdbg("new ring_loopback() cq_size=%u latency=%u usec drop_rate=%u tso=%u", cq_size,
+                safe_mce_sys().ring_loopback_latency_usec, m_drop_rate, m_tso_max_payload_sz);
+}
+
+ring_loopback::~ring_loopback()
+{
+    m_lock_ring_rx.lock();
+    flow_del_all_rfs();
+    m_flow_tags.clear();
+    m_lock_ring_rx.unlock();
+
+    if (g_p_fd_collection) {
+        g_p_fd_collection->del_cq_channel_fd(m_event_fd, true);
+    }
+    orig_os_api.close(m_event_fd);
+
+    /* Release packets which were not polled */
+    while (m_cq_tail.load(std::memory_order_relaxed) != m_cq_head.load(std::memory_order_relaxed)) {
+        uint32_t tail = m_cq_tail.load(std::memory_order_relaxed);
+        m_rx_pool.push_back(m_cq[tail & m_cq_mask].p_desc);
+        m_cq_tail.store(tail + 1, std::memory_order_relaxed);
+    }
+    delete[] m_cq;
+
+    /* Release RX buffer poll */
+    g_buffer_pool_rx_ptr->put_buffers_thread_safe(&m_rx_pool, m_rx_pool.size());
+
+    delete[] m_p_n_rx_channel_fds;
+}
+
+bool ring_loopback::attach_flow(flow_tuple &flow_spec_5t, pkt_rcvr_sink *sink, bool force_5t)
+{
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+    bool ret = ring_slave::attach_flow(flow_spec_5t, sink, force_5t);
+
+    /* Emulate HW flow tag for the flows which ring_slave registered with a tag. HW tags
+     * the packets regardless of the socket state, the fast path checks flow_tag_enabled().
+     */
+    if (ret && m_flow_tag_enabled && (flow_spec_5t.is_tcp() || flow_spec_5t.is_udp_uc())) {
+        sockinfo *si = static_cast<sockinfo *>(sink);
+        uint32_t flow_tag_id = si->get_flow_tag_val();
+        if (flow_tag_id && flow_tag_id != FLOW_TAG_MASK && !si->flow_in_reuse() &&
+            (flow_spec_5t.is_udp_uc() || !flow_spec_5t.is_3_tuple())) {
+            m_flow_tags[flow_spec_5t] = std::make_pair(flow_tag_id, si);
+        }
+    }
+
+    return ret;
+}
+
+bool ring_loopback::detach_flow(flow_tuple &flow_spec_5t, pkt_rcvr_sink *sink)
+{
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+
+    m_flow_tags.erase(flow_spec_5t);
+
+    return ring_slave::detach_flow(flow_spec_5t, sink);
+}
+
+int ring_loopback::poll_and_process_element_rx(uint64_t *, void *pv_fd_ready_array)
+{
+    return process_element_rx(pv_fd_ready_array);
+}
+
+int ring_loopback::wait_for_notification_and_process_element(int, uint64_t *,
+                                                             void *pv_fd_ready_array)
+{
+    uint64_t counter;
+
+    /* Consume the event, the packets are taken from the completion ring */
+    if (orig_os_api.read(m_event_fd, &counter, sizeof(counter)) < 0 && errno != EAGAIN) {
+        ring_logdbg("read: event_fd %d, errno: %d", m_event_fd, errno);
+    }
+
+    return process_element_rx(pv_fd_ready_array);
+}
+
+int ring_loopback::drain_and_proccess()
+{
+    return process_element_rx(NULL);
+}
+
+int ring_loopback::request_notification(cq_type_t cq_type, uint64_t poll_sn)
+{
+    NOT_IN_USE(poll_sn);
+
+    if (unlikely(CQT_RX != cq_type)) {
+        return 0;
+    }
+
+    m_armed.store(true, std::memory_order_seq_cst);
+
+    /* Packets which were posted before arming must be polled by the caller */
+    return (m_cq_head.load(std::memory_order_seq_cst) !=
+            m_cq_tail.load(std::memory_order_relaxed))
+        ? 1
+        : 0;
+}
+
+bool ring_loopback::reclaim_recv_buffers(descq_t *rx_reuse)
+{
+    while (!rx_reuse->empty()) {
+        mem_buf_desc_t *buff = rx_reuse->get_and_pop_front();
+        reclaim_recv_buffers(buff);
+    }
+
+    std::lock_guard<decltype(m_lock_rx_pool)> lock(m_lock_rx_pool);
+    if (m_rx_pool.size() >= m_sysvar_qp_compensation_level * 2) {
+        int buff_to_rel = m_rx_pool.size() - m_sysvar_qp_compensation_level;
+
+        g_buffer_pool_rx_ptr->put_buffers_thread_safe(&m_rx_pool, buff_to_rel);
+        m_p_ring_stat->loopback.n_rx_buffers = m_rx_pool.size();
+    }
+
+    return true;
+}
+
+bool ring_loopback::reclaim_recv_buffers(mem_buf_desc_t *buff)
+{
+    if (buff && (buff->dec_ref_count() <= 1)) {
+        std::lock_guard<decltype(m_lock_rx_pool)> lock(m_lock_rx_pool);
+        mem_buf_desc_t *temp = NULL;
+        while (buff) {
+            if (buff->lwip_pbuf_dec_ref_count() <= 0) {
+                temp = buff;
+                buff = temp->p_next_desc;
+                temp->clear_transport_data();
+                temp->p_next_desc = NULL;
+                temp->p_prev_desc = NULL;
+                temp->reset_ref_count();
+                free_lwip_pbuf(&temp->lwip_pbuf);
+                m_rx_pool.push_back(temp);
+            } else {
+                buff->reset_ref_count();
+                buff = buff->p_next_desc;
+            }
+        }
+        m_p_ring_stat->loopback.n_rx_buffers = m_rx_pool.size();
+        return true;
+    }
+    return false;
+}
+
+void ring_loopback::send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                     xlio_wr_tx_packet_attr attr)
+{
+    NOT_IN_USE(id);
+    NOT_IN_USE(attr);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    int ret = send_buffer(p_send_wqe);
+    send_status_handler(ret, p_send_wqe);
+}
+
+int ring_loopback::send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                    xlio_wr_tx_packet_attr attr, xlio_tis *tis)
+{
+    NOT_IN_USE(id);
+    NOT_IN_USE(attr);
+    NOT_IN_USE(tis);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    int ret = send_buffer(p_send_wqe);
+    send_status_handler(ret, p_send_wqe);
+    return ret;
+}
+
+int ring_loopback::process_element_rx(void *pv_fd_ready_array)
+{
+    int ret = 0;
+    tscval_t now = 0;
+
+    if (m_cq_head.load(std::memory_order_acquire) == m_cq_tail.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+
+    if (m_latency_tsc) {
+        gettimeoftsc(&now);
+    }
+
+    uint32_t tail = m_cq_tail.load(std::memory_order_relaxed);
+    uint32_t head = m_cq_head.load(std::memory_order_acquire);
+    while (tail != head && (uint32_t)ret < m_n_sysvar_cq_poll_batch_max) {
+        loopback_cqe &cqe = m_cq[tail & m_cq_mask];
+        if (m_latency_tsc && cqe.ready_tsc > now) {
+            /* Packet is still on the wire */
+            break;
+        }
+        mem_buf_desc_t *buff = cqe.p_desc;
+        m_cq_tail.store(++tail, std::memory_order_release);
+
+        set_flow_tag(buff);
+        if (!rx_process_buffer(buff, pv_fd_ready_array)) {
+            put_rx_buffer(buff);
+        }
+        ++ret;
+    }
+
+    return ret;
+}
+
+void ring_loopback::set_flow_tag(mem_buf_desc_t *buff)
+{
+    buff->rx.flow_tag_id = 0;
+    if (!m_flow_tag_enabled || m_flow_tags.empty()) {
+        return;
+    }
+
+    size_t l3_offset = ETH_HDR_LEN;
+    if (((struct ethhdr *)buff->p_buffer)->h_proto == htons(ETH_P_8021Q)) {
+        l3_offset = ETH_VLAN_HDR_LEN;
+    }
+
+    struct iphdr *p_ip_h = (struct iphdr *)(buff->p_buffer + l3_offset);
+    ip_address src_ip, dst_ip;
+    sa_family_t family;
+    uint8_t protocol;
+    uint8_t *p_l4_h;
+
+    if (p_ip_h->version == IPV4_VERSION) {
+        src_ip = ip_address(*(in_addr *)&p_ip_h->saddr);
+        dst_ip = ip_address(*(in_addr *)&p_ip_h->daddr);
+        family = AF_INET;
+        protocol = p_ip_h->protocol;
+        p_l4_h = (uint8_t *)p_ip_h + p_ip_h->ihl * 4;
+    } else {
+        struct ip6_hdr *p_ip_h6 = reinterpret_cast<struct ip6_hdr *>(p_ip_h);
+        src_ip = ip_address(p_ip_h6->ip6_src);
+        dst_ip = ip_address(p_ip_h6->ip6_dst);
+        family = AF_INET6;
+        protocol = p_ip_h6->ip6_nxt;
+        p_l4_h = (uint8_t *)p_ip_h + IPV6_HLEN;
+    }
+
+    if (protocol != IPPROTO_TCP && protocol != IPPROTO_UDP) {
+        return;
+    }
+
+    /* Source and destination ports are at the same offsets in TCP and UDP headers */
+    in_port_t src_port = ((struct udphdr *)p_l4_h)->source;
+    in_port_t dst_port = ((struct udphdr *)p_l4_h)->dest;
+    in_protocol_t proto = (protocol == IPPROTO_TCP ? PROTO_TCP : PROTO_UDP);
+
+    auto itr = m_flow_tags.find(flow_tuple(dst_ip, dst_port, src_ip, src_port, proto, family));
+    if (itr == m_flow_tags.end() && proto == PROTO_UDP) {
+        itr = m_flow_tags.find(
+            flow_tuple(dst_ip, dst_port, ip_address::any_addr(), 0, proto, family));
+        if (itr == m_flow_tags.end()) {
+            itr = m_flow_tags.find(flow_tuple(ip_address::any_addr(), dst_port,
+                                              ip_address::any_addr(), 0, proto, family));
+        }
+    }
+    /* Flow tag is a socket fd, so skip flows of closed sockets whose fd was reused */
+    if (itr != m_flow_tags.end() &&
+        g_p_fd_collection->get_sockfd(itr->second.first - 1) == itr->second.second) {
+        buff->rx.flow_tag_id = itr->second.first;
+    }
+}
+
+bool ring_loopback::request_more_rx_buffers()
+{
+    ring_logfuncall("Allocating additional %d buffers for internal use",
+                    m_sysvar_qp_compensation_level);
+
+    bool res = g_buffer_pool_rx_ptr->get_buffers_thread_safe(m_rx_pool, this,
+                                                             m_sysvar_qp_compensation_level, 0);
+    if (!res) {
+        ring_logfunc("Out of mem_buf_desc from RX free pool for internal object pool");
+        return false;
+    }
+
+    m_p_ring_stat->loopback.n_rx_buffers = m_rx_pool.size();
+
+    return true;
+}
+
+mem_buf_desc_t *ring_loopback::get_rx_buffer()
+{
+    std::lock_guard<decltype(m_lock_rx_pool)> lock(m_lock_rx_pool);
+
+    if (unlikely(m_rx_pool.empty()) && !request_more_rx_buffers()) {
+        return NULL;
+    }
+    m_p_ring_stat->loopback.n_rx_buffers--;
+
+    return m_rx_pool.get_and_pop_front();
+}
+
+void ring_loopback::put_rx_buffer(mem_buf_desc_t *buff)
+{
+    std::lock_guard<decltype(m_lock_rx_pool)> lock(m_lock_rx_pool);
+
+    m_rx_pool.push_front(buff);
+    m_p_ring_stat->loopback.n_rx_buffers++;
+}
+
+bool ring_loopback::is_dropped()
+{
+    if (likely(m_drop_rate == 0)) {
+        return false;
+    }
+
+    /* xorshift32 */
+    m_rand_state ^= m_rand_state << 13;
+    m_rand_state ^= m_rand_state >> 17;
+    m_rand_state ^= m_rand_state << 5;
+
+    return (m_rand_state % 1000000U) < m_drop_rate;
+}
+
+bool ring_loopback::post_cqe(mem_buf_desc_t *buff)
+{
+    uint32_t head = m_cq_head.load(std::memory_order_relaxed);
+
+    if (unlikely(head - m_cq_tail.load(std::memory_order_acquire) > m_cq_mask)) {
+        /* Completion ring overflow, HW drops the packet in this case */
+        put_rx_buffer(buff);
+        return false;
+    }
+
+    buff->rx.is_sw_csum_need = 0;
+    buff->rx.is_xlio_thr = false;
+    buff->rx.timestamps.hw_raw = 0;
+    m_cq[head & m_cq_mask].p_desc = buff;
+    m_cq[head & m_cq_mask].ready_tsc = 0;
+    if (m_latency_tsc) {
+        gettimeoftsc(&m_cq[head & m_cq_mask].ready_tsc);
+        m_cq[head & m_cq_mask].ready_tsc += m_latency_tsc;
+    }
+    m_cq_head.store(head + 1, std::memory_order_seq_cst);
+
+    if (m_armed.load(std::memory_order_seq_cst) && m_armed.exchange(false)) {
+        uint64_t counter = 1;
+        if (orig_os_api.write(m_event_fd, &counter, sizeof(counter)) < 0) {
+            ring_logdbg("write: event_fd %d, errno: %d", m_event_fd, errno);
+        }
+    }
+
+    return true;
+}
+
+int ring_loopback::send_buffer(xlio_ibv_send_wr *wr)
+{
+    sg_array sga(wr->sg_list, wr->num_sge);
+    uint8_t *hdr = NULL;
+    int hdr_sz = 0;
+    int mss = 0;
+    int payload_sz = sga.length();
+    int ret = 0;
+
+    if (xlio_send_wr_opcode(*wr) == XLIO_IBV_WR_TSO) {
+        hdr = (uint8_t *)wr->tso.hdr;
+        hdr_sz = wr->tso.hdr_sz;
+        mss = wr->tso.mss;
+    }
+    if (mss == 0) {
+        mss = payload_sz;
+    }
+
+    /* Locate L3/L4 headers within TSO header to update them per segment */
+    size_t l3_offset = ETH_HDR_LEN;
+    struct iphdr *p_ip_h = NULL;
+    uint8_t l4_proto = 0;
+    size_t l4_offset = 0;
+    if (hdr) {
+        if (((struct ethhdr *)hdr)->h_proto == htons(ETH_P_8021Q)) {
+            l3_offset = ETH_VLAN_HDR_LEN;
+        }
+        p_ip_h = (struct iphdr *)(hdr + l3_offset);
+        if (p_ip_h->version == IPV4_VERSION) {
+            l4_proto = p_ip_h->protocol;
+            l4_offset = l3_offset + p_ip_h->ihl * 4;
+        } else {
+            l4_proto = reinterpret_cast<struct ip6_hdr *>(p_ip_h)->ip6_nxt;
+            l4_offset = l3_offset + IPV6_HLEN;
+        }
+    }
+
+    int offset = 0;
+    do {
+        int seg_sz = std::min(mss, payload_sz - offset);
+        bool last = (offset + seg_sz >= payload_sz);
+
+        if (is_dropped()) {
+            m_p_ring_stat->loopback.n_tx_dropped++;
+            /* Skip the segment data */
+            for (int len = seg_sz, n; len > 0; len -= n) {
+                n = len;
+                if (!sga.get_data(&n)) {
+                    break;
+                }
+            }
+            offset += seg_sz;
+            continue;
+        }
+
+        mem_buf_desc_t *buff = get_rx_buffer();
+        if (unlikely(!buff || (size_t)(hdr_sz + seg_sz) > buff->sz_buffer)) {
+            if (buff) {
+                put_rx_buffer(buff);
+            }
+            m_p_ring_stat->loopback.n_tx_dropped++;
+            ring_logfunc("Packet dropped (buff=%p size=%d)", buff, hdr_sz + seg_sz);
+            return -1;
+        }
+
+        uint8_t *p = buff->p_buffer;
+        if (hdr) {
+            memcpy(p, hdr, hdr_sz);
+        }
+        for (int len = seg_sz, n; len > 0; len -= n) {
+            n = len;
+            uint8_t *data = sga.get_data(&n);
+            if (unlikely(!data)) {
+                break;
+            }
+            memcpy(p + hdr_sz, data, n);
+            p += n;
+        }
+        buff->sz_data = hdr_sz + seg_sz;
+
+        /* Emulate HW segmentation: fix up L3/L4 headers of every segment */
+        if (hdr) {
+            struct iphdr *ip_h = (struct iphdr *)(buff->p_buffer + l3_offset);
+            uint8_t *l4_h = buff->p_buffer + l4_offset;
+            int l4_len = hdr_sz - l4_offset + seg_sz;
+            int seg_idx = offset / std::max(mss, 1);
+
+            if (ip_h->version == IPV4_VERSION) {
+                ip_h->tot_len = htons(buff->sz_data - l3_offset);
+                ip_h->id = htons(ntohs(ip_h->id) + seg_idx);
+            } else {
+                reinterpret_cast<struct ip6_hdr *>(ip_h)->ip6_plen = htons(l4_len);
+            }
+            if (l4_proto == IPPROTO_TCP) {
+                struct tcphdr *tcp_h = (struct tcphdr *)l4_h;
+                tcp_h->seq = htonl(ntohl(tcp_h->seq) + offset);
+                if (!last) {
+                    tcp_h->fin = 0;
+                    tcp_h->psh = 0;
+                }
+                if (offset) {
+                    /* CWR is set on the first segment only */
+                    ((uint8_t *)tcp_h)[13] &= ~0x80U;
+                }
+            } else if (l4_proto == IPPROTO_UDP) {
+                ((struct udphdr *)l4_h)->len = htons(l4_len);
+            }
+            if (mss < payload_sz) {
+                m_p_ring_stat->loopback.n_tx_tso_segments++;
+            }
+        }
+
+        if (post_cqe(buff)) {
+            ret += buff->sz_data;
+        } else {
+            m_p_ring_stat->loopback.n_tx_dropped++;
+        }
+        offset += seg_sz;
+    } while (offset < payload_sz);
+
+    /* Dropped packets are reported as sent, they are lost on the wire */
+    return ret ? ret : payload_sz + hdr_sz;
+}
+
+void ring_loopback::send_status_handler(int ret, xlio_ibv_send_wr *p_send_wqe)
+{
+    if (p_send_wqe) {
+        mem_buf_desc_t *p_mem_buf_desc = (mem_buf_desc_t *)(p_send_wqe->wr_id);
+
+        if (likely(ret > 0)) {
+            // Update TX statistics
+            m_p_ring_stat->n_tx_byte_count += ret;
+            ++m_p_ring_stat->n_tx_pkt_count;
+        }
+
+        /* Data was copied, complete the WQE immediately */
+        mem_buf_tx_release(p_mem_buf_desc, true);
+    }
+}
+
+mem_buf_desc_t *ring_loopback::mem_buf_tx_get(ring_user_id_t id, bool b_block, pbuf_type type,
+                                              int n_num_mem_bufs)
+{
+    mem_buf_desc_t *head = NULL;
+
+    NOT_IN_USE(id);
+    NOT_IN_USE(b_block);
+
+    ring_logfuncall("n_num_mem_bufs=%d", n_num_mem_bufs);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    descq_t &pool = type == PBUF_ZEROCOPY ? m_zc_pool : m_tx_pool;
+
+    if (unlikely((int)pool.size() < n_num_mem_bufs)) {
+        request_more_tx_buffers(type, std::max<uint32_t>(m_sysvar_qp_compensation_level,
+                                                         n_num_mem_bufs),
+                                0);
+
+        if (unlikely((int)pool.size() < n_num_mem_bufs)) {
+            return head;
+        }
+    }
+
+    head = pool.get_and_pop_back();
+    head->lwip_pbuf.pbuf.ref = 1;
+    n_num_mem_bufs--;
+
+    mem_buf_desc_t *next = head;
+    while (n_num_mem_bufs) {
+        next->p_next_desc = pool.get_and_pop_back();
+        next = next->p_next_desc;
+        next->lwip_pbuf.pbuf.ref = 1;
+        n_num_mem_bufs--;
+    }
+
+    return head;
+}
+
+inline void ring_loopback::return_to_global_pool()
+{
+    if (m_tx_pool.size() >= m_sysvar_qp_compensation_level * 2) {
+        int return_bufs = m_tx_pool.size() - m_sysvar_qp_compensation_level;
+        g_buffer_pool_tx->put_buffers_thread_safe(&m_tx_pool, return_bufs);
+    }
+    if (m_zc_pool.size() >= m_sysvar_qp_compensation_level * 2) {
+        int return_bufs = m_zc_pool.size() - m_sysvar_qp_compensation_level;
+        g_buffer_pool_zc->put_buffers_thread_safe(&m_zc_pool, return_bufs);
+    }
+}
+
+// call under m_lock_ring_tx lock
+inline void ring_loopback::put_tx_buffer_helper(mem_buf_desc_t *buff)
+{
+    // potential race, ref is protected here by ring_tx lock, and in dst_entry_tcp &
+    // sockinfo_tcp by tcp lock
+    if (likely(buff->lwip_pbuf.pbuf.ref)) {
+        buff->lwip_pbuf.pbuf.ref--;
+    } else {
+        ring_logerr("ref count of %p is already zero, double free??", buff);
+    }
+
+    if (buff->lwip_pbuf.pbuf.ref == 0) {
+        descq_t &pool = buff->lwip_pbuf.pbuf.type == PBUF_ZEROCOPY ? m_zc_pool : m_tx_pool;
+        buff->p_next_desc = NULL;
+        free_lwip_pbuf(&buff->lwip_pbuf);
+        pool.push_back(buff);
+    }
+}
+
+void ring_loopback::mem_buf_desc_return_single_to_owner_tx(mem_buf_desc_t *p_mem_buf_desc)
+{
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+
+    if (likely(p_mem_buf_desc)) {
+        put_tx_buffer_helper(p_mem_buf_desc);
+    }
+
+    return_to_global_pool();
+}
+
+void ring_loopback::mem_buf_desc_return_single_multi_ref(mem_buf_desc_t *p_mem_buf_desc,
+                                                         unsigned ref)
+{
+    if (unlikely(ref == 0)) {
+        return;
+    }
+
+    m_lock_ring_tx.lock();
+    p_mem_buf_desc->lwip_pbuf.pbuf.ref -=
+        std::min<unsigned>(p_mem_buf_desc->lwip_pbuf.pbuf.ref, ref - 1);
+    m_lock_ring_tx.unlock();
+    mem_buf_desc_return_single_to_owner_tx(p_mem_buf_desc);
+}
+
+int ring_loopback::mem_buf_tx_release(mem_buf_desc_t *buff_list, bool b_accounting, bool trylock)
+{
+    int count = 0;
+    mem_buf_desc_t *next;
+
+    NOT_IN_USE(b_accounting);
+
+    if (!trylock) {
+        m_lock_ring_tx.lock();
+    } else if (m_lock_ring_tx.trylock()) {
+        return 0;
+    }
+
+    while (buff_list) {
+        next = buff_list->p_next_desc;
+        put_tx_buffer_helper(buff_list);
+        count++;
+        buff_list = next;
+    }
+
+    return_to_global_pool();
+    m_lock_ring_tx.unlock();
+
+    return count;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RING_LOOPBACK_H_
+#define RING_LOOPBACK_H_
+
+#include <atomic>
+#include <map>
+
+#include "ring_slave.h"
+#include "utils/rdtsc.h"
+
+class sockinfo;
+
+/* TSO capabilities reported by the software ring */
+#define RING_LOOPBACK_TSO_MAX_PAYLOAD (256 * 1024)
+#define RING_LOOPBACK_TSO_MAX_HEADER  94
+#define RING_LOOPBACK_MAX_SEND_SGE    16
+
+/**
+ * Software ring which loops every transmitted packet back to its own RX path.
+ *
+ * TX WQEs are copied into RX buffers at post time, segmented according to the
+ * TSO header and MSS, and queued to an in-memory completion ring. The TX buffers
+ * are completed immediately. RX polling delivers the queued completions through
+ * ring_slave::rx_process_buffer() as if they were received by HW: checksums are
+ * reported as verified and flow tags are assigned from the attached flows.
+ * Packet latency and drop rate are configurable to emulate a wire.
+ *
+ * The completion ring has a single producer (ring TX lock) and a single
+ * consumer (ring RX lock), so TX and RX paths never take each other's lock.
+ */
+class ring_loopback : public ring_slave {
+public:
+    ring_loopback(int if_index, ring *parent = NULL);
+    virtual ~ring_loopback();
+
+    virtual bool is_up() { return m_active; }
+    virtual bool attach_flow(flow_tuple &flow_spec_5t, pkt_rcvr_sink *sink, bool force_5t = false);
+    virtual bool detach_flow(flow_tuple &flow_spec_5t, pkt_rcvr_sink *sink);
+    virtual int poll_and_process_element_rx(uint64_t *p_cq_poll_sn, void *pv_fd_ready_array = NULL);
+    virtual int poll_and_process_element_tx(uint64_t *p_cq_poll_sn)
+    {
+        NOT_IN_USE(p_cq_poll_sn);
+        return 0;
+    }
+    virtual int wait_for_notification_and_process_element(int cq_channel_fd, uint64_t *p_cq_poll_sn,
+                                                          void *pv_fd_ready_array = NULL);
+    virtual int drain_and_proccess();
+    virtual bool reclaim_recv_buffers(descq_t *rx_reuse);
+    virtual bool reclaim_recv_buffers(mem_buf_desc_t *buff);
+    virtual int reclaim_recv_single_buffer(mem_buf_desc_t *rx_reuse)
+    {
+        NOT_IN_USE(rx_reuse);
+        return -1;
+    }
+    virtual void send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                  xlio_wr_tx_packet_attr attr);
+    virtual int send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                 xlio_wr_tx_packet_attr attr, xlio_tis *tis);
+    virtual void mem_buf_desc_return_single_to_owner_tx(mem_buf_desc_t *p_mem_buf_desc);
+    virtual void mem_buf_desc_return_single_multi_ref(mem_buf_desc_t *p_mem_buf_desc, unsigned ref);
+    virtual mem_buf_desc_t *mem_buf_tx_get(ring_user_id_t id, bool b_block, pbuf_type type,
+                                           int n_num_mem_bufs = 1);
+    virtual int mem_buf_tx_release(mem_buf_desc_t *p_mem_buf_desc_list, bool b_accounting,
+                                   bool trylock = false);
+    virtual bool get_hw_dummy_send_support(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe)
+    {
+        NOT_IN_USE(id);
+        NOT_IN_USE(p_send_wqe);
+        return false;
+    }
+    virtual int request_notification(cq_type_t cq_type, uint64_t poll_sn);
+    virtual void adapt_cq_moderation() {}
+
+    virtual int modify_ratelimit(struct xlio_rate_limit_t &rate_limit)
+    {
+        NOT_IN_USE(rate_limit);
+        return 0;
+    }
+    void inc_cq_moderation_stats(size_t sz_data) { NOT_IN_USE(sz_data); }
+    virtual uint32_t get_tx_user_lkey(void *addr, size_t length, void *p_mapping = NULL)
+    {
+        /* Memory is accessed by CPU copy, no registration is needed */
+        NOT_IN_USE(p_mapping);
+        NOT_IN_USE(addr);
+        NOT_IN_USE(length);
+        return 0;
+    }
+    virtual uint32_t get_max_inline_data() { return 0; }
+    ib_ctx_handler *get_ctx(ring_user_id_t id)
+    {
+        NOT_IN_USE(id);
+        return NULL;
+    }
+    virtual uint32_t get_max_send_sge(void) { return RING_LOOPBACK_MAX_SEND_SGE; }
+    virtual uint32_t get_max_payload_sz(void) { return m_tso_max_payload_sz; }
+    virtual uint16_t get_max_header_sz(void)
+    {
+        return m_tso_max_payload_sz ? RING_LOOPBACK_TSO_MAX_HEADER : 0;
+    }
+    virtual uint32_t get_tx_lkey(ring_user_id_t id)
+    {
+        NOT_IN_USE(id);
+        return 0;
+    }
+    virtual bool is_tso(void) { return m_tso_max_payload_sz != 0; }
+
+private:
+    struct loopback_cqe {
+        mem_buf_desc_t *p_desc;
+        tscval_t ready_tsc;
+    };
+
+    inline void return_to_global_pool();
+    inline void put_tx_buffer_helper(mem_buf_desc_t *buff);
+    int process_element_rx(void *pv_fd_ready_array);
+    bool request_more_rx_buffers();
+    mem_buf_desc_t *get_rx_buffer();
+    void put_rx_buffer(mem_buf_desc_t *buff);
+    bool is_dropped();
+    bool post_cqe(mem_buf_desc_t *buff);
+    int send_buffer(xlio_ibv_send_wr *p_send_wqe);
+    void send_status_handler(int ret, xlio_ibv_send_wr *p_send_wqe);
+    void set_flow_tag(mem_buf_desc_t *buff);
+
+    int m_event_fd;
+    const uint32_t m_sysvar_qp_compensation_level;
+    const uint32_t m_n_sysvar_cq_poll_batch_max;
+    const uint32_t m_drop_rate;
+    uint32_t m_rand_state;
+    uint32_t m_tso_max_payload_sz;
+    tscval_t m_latency_tsc;
+
+    /* RX buffers to copy looped back packets into, protected by m_lock_rx_pool */
+    lock_spin m_lock_rx_pool;
+    descq_t m_rx_pool;
+
+    /* Completion ring, single producer and single consumer */
+    loopback_cqe *m_cq;
+    uint32_t m_cq_mask;
+    std::atomic<uint32_t> m_cq_head;
+    std::atomic<uint32_t> m_cq_tail;
+    std::atomic<bool> m_armed;
+
+    /* Flow tags emulation, protected by m_lock_ring_rx */
+    std::map<flow_tuple, std::pair<uint32_t, sockinfo *>> m_flow_tags;
+};
+
+#endif /* RING_LOOPBACK_H_ */
@@ -108,12 +108,14 @@ ring_simple::ring_simple(int if_index, ring *parent, ring_type_t type)
     , m_zc_num_bufs(0)
     , m_tx_num_wr(0)
     , m_missing_buf_ref_count(0)
+    , m_tx_batch_depth(0)
     , m_tx_lkey(0)
     , m_gro_mgr(safe_mce_sys().gro_streams_max, MAX_GRO_BUFS)
     , m_up(false)
     , m_p_rx_comp_event_channel(NULL)
     , m_p_tx_comp_event_channel(NULL)
     , m_p_l2_addr(NULL)
+    , m_b_sysvar_tx_combining(safe_mce_sys().ring_tx_combining)
 {
     net_device_val *p_ndev = g_p_net_device_table_mgr->get_net_device_val(m_parent->get_if_index());
     const slave_data_t *p_slave = p_ndev->get_slave(get_if_index());
@@ -150,6 +152,9 @@ ring_simple::~ring_simple()
 {
     ring_logdbg("delete ring_simple()");
 
+    // Threads may still hold a deferred doorbell for this ring
+    tx_scope_unregister();
+
     // Go over all hash and for each flow: 1.Detach from qp 2.Delete related rfs object 3.Remove
     // flow from hash
     m_lock_ring_rx.lock();
@@ -398,6 +403,8 @@ void ring_simple::create_resources()
         start_active_qp_mgr();
     }
 
+    tx_scope_register();
+
     ring_logdbg("new ring_simple() completed");
 }
 
@@ -537,6 +544,9 @@ mem_buf_desc_t *ring_simple::mem_buf_tx_get(ring_user_id_t id, bool b_block, pbu
     buff_list = get_tx_buffers(type, n_num_mem_bufs);
     while (!buff_list) {
 
+        // Buffers of WQEs posted in a TX batch are not completed until the doorbell
+        m_p_qp_mgr->ring_delayed_doorbell();
+
         // Try to poll once in the hope that we get a few freed tx mem_buf_desc
         ret = m_p_cq_mgr_tx->poll_and_process_element_tx(&poll_sn);
         if (ret < 0) {
@@ -548,6 +558,9 @@ mem_buf_desc_t *ring_simple::mem_buf_tx_get(ring_user_id_t id, bool b_block, pbu
         } else if (ret > 0) {
             ring_logfunc("polling succeeded on tx cq_mgr (%d wce)", ret);
             buff_list = get_tx_buffers(type, n_num_mem_bufs);
+        } else if (b_block && m_tx_batch_depth > 0) {
+            // The ring lock is held by the TX batch, keep polling instead of blocking
+            continue;
         } else if (b_block) { // (ret == 0)
             // Arm & Block on tx cq_mgr notification channel
             // until we get a few freed tx mem_buf_desc & data buffers
@@ -687,6 +700,29 @@ inline int ring_simple::send_buffer(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_pac
     return ret;
 }
 
+/*
+ * called under m_lock_ring_tx lock
+ * Inside a thread TX scope the doorbell is left pending and rung by
+ * tx_scope_flush() when the thread leaves the scope. The multi-packet WQE
+ * session is left open as well, so consecutive scoped packets share it.
+ */
+inline int ring_simple::send_buffer_scoped(xlio_ibv_send_wr *p_send_wqe,
+                                           xlio_wr_tx_packet_attr attr, xlio_tis *tis)
+{
+    if (likely(!tx_scope_active()) || !tx_scope_enroll()) {
+        return send_buffer(p_send_wqe, attr, tis);
+    }
+
+    if (m_tx_batch_depth++ == 0) {
+        m_p_qp_mgr->set_delayed_doorbell(true);
+    }
+    int ret = send_buffer(p_send_wqe, attr, tis);
+    if (--m_tx_batch_depth == 0) {
+        m_p_qp_mgr->set_delayed_doorbell(false, false);
+    }
+    return ret;
+}
+
 bool ring_simple::get_hw_dummy_send_support(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe)
 {
     NOT_IN_USE(id);
@@ -706,8 +742,13 @@ void ring_simple::send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_w
         attr = (xlio_wr_tx_packet_attr)(attr & ~(XLIO_TX_PACKET_L4_CSUM));
     }
 
+    if (m_b_sysvar_tx_combining) {
+        tx_submit(p_send_wqe, attr, 0);
+        return;
+    }
+
     std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
-    int ret = send_buffer(p_send_wqe, attr, 0);
+    int ret = send_buffer_scoped(p_send_wqe, attr, 0);
     send_status_handler(ret, p_send_wqe);
 }
 
@@ -715,12 +756,92 @@ int ring_simple::send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wq
                                   xlio_wr_tx_packet_attr attr, xlio_tis *tis)
 {
     NOT_IN_USE(id);
+    if (m_b_sysvar_tx_combining) {
+        return tx_submit(p_send_wqe, attr, tis);
+    }
+
     std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
-    int ret = send_buffer(p_send_wqe, attr, tis);
+    int ret = send_buffer_scoped(p_send_wqe, attr, tis);
     send_status_handler(ret, p_send_wqe);
     return ret;
 }
 
+/*
+ * Flat-combining TX path. The request is pushed to a lock-free stack and
+ * whichever thread wins m_lock_ring_tx posts all pending requests with a
+ * single doorbell. Other submitters only spin on their own done flag, so
+ * m_lock_ring_tx is not bounced between cores under contention.
+ */
+int ring_simple::tx_submit(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_attr attr,
+                           xlio_tis *tis)
+{
+    tx_submit_req req;
+
+    req.p_send_wqe = p_send_wqe;
+    req.tis = tis;
+    req.attr = attr;
+    req.ret = 0;
+    m_tx_submit_queue.push(&req);
+    m_tx_submit_queue.wait(&req, m_lock_ring_tx, [this]() { tx_combine(); });
+    return req.ret;
+}
+
+/*
+ * called under m_lock_ring_tx lock
+ */
+void ring_simple::tx_combine()
+{
+    /* Bound the number of passes so a combiner is not starved by a steady
+     * stream of new submissions. Leftovers are picked up by their owners.
+     */
+    static const int max_passes = 4;
+
+    if (m_tx_batch_depth++ == 0) {
+        m_p_qp_mgr->set_delayed_doorbell(true);
+    }
+
+    m_tx_submit_queue.combine(
+        [this](tx_combining_node *node) {
+            tx_submit_req *req = static_cast<tx_submit_req *>(node);
+            req->ret = send_buffer(req->p_send_wqe, req->attr, req->tis);
+            send_status_handler(req->ret, req->p_send_wqe);
+        },
+        max_passes);
+
+    if (--m_tx_batch_depth == 0) {
+        m_p_qp_mgr->set_delayed_doorbell(false);
+    }
+}
+
+void ring_simple::tx_batch_start(ring_user_id_t id)
+{
+    NOT_IN_USE(id);
+
+    m_lock_ring_tx.lock();
+    if (m_tx_batch_depth++ == 0) {
+        m_p_qp_mgr->set_delayed_doorbell(true);
+    }
+}
+
+void ring_simple::tx_batch_end(ring_user_id_t id)
+{
+    NOT_IN_USE(id);
+
+    if (--m_tx_batch_depth == 0) {
+        m_p_qp_mgr->set_delayed_doorbell(false);
+    }
+    m_lock_ring_tx.unlock();
+}
+
+void ring_simple::tx_scope_flush()
+{
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    // An open TX batch rings the doorbell when it ends
+    if (m_tx_batch_depth == 0) {
+        m_p_qp_mgr->ring_delayed_doorbell();
+    }
+}
+
 /*
  * called under m_lock_ring_tx lock
  */
@@ -730,6 +851,9 @@ bool ring_simple::is_available_qp_wr(bool b_block, unsigned credits)
     int ret;
     uint64_t poll_sn = 0;
 
+    // Completions are not generated for WQEs which are not submitted yet
+    m_p_qp_mgr->ring_delayed_doorbell();
+
     // TODO credits_get() does TX polling. Call current method only for bocking mode?
 
     do {
@@ -746,7 +870,7 @@ bool ring_simple::is_available_qp_wr(bool b_block, unsigned credits)
             break;
         }
 
-        if (b_block) {
+        if (b_block && m_tx_batch_depth == 0) {
             // Arm & Block on tx cq_mgr notification channel until we get space in SQ
 
             // Only a single thread should block on next Tx cqe event, hence the dedicated lock!
@@ -35,12 +35,14 @@
 
 #include "ring_slave.h"
 
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
 #include "dev/gro_mgr.h"
 #include "dev/qp_mgr.h"
 #include "dev/net_device_table_mgr.h"
+#include "util/tx_combining_queue.h"
 
 struct cq_moderation_info {
     uint32_t period;
@@ -93,6 +95,8 @@ public:
                           xlio_wr_tx_packet_attr attr) override;
     int send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
                          xlio_wr_tx_packet_attr attr, xlio_tis *tis) override;
+    void tx_batch_start(ring_user_id_t id) override;
+    void tx_batch_end(ring_user_id_t id) override;
     void mem_buf_desc_return_single_to_owner_tx(mem_buf_desc_t *p_mem_buf_desc) override;
     void mem_buf_desc_return_single_multi_ref(mem_buf_desc_t *p_mem_buf_desc,
                                               unsigned ref) override;
@@ -292,6 +296,7 @@ public:
     friend class rfs;
     friend class rfs_uc;
     friend class rfs_uc_tcp_gro;
+    friend class rfs_uc_udp_gro;
     friend class rfs_mc;
     friend class ring_bond;
 
@@ -312,7 +317,22 @@ protected:
     std::unordered_map<void *, uint32_t> m_user_lkey_map;
 
 private:
+    /* Pending TX submission published to the combining queue. Lives on the
+     * stack of the submitting thread until the combiner sets done.
+     */
+    struct tx_submit_req : public tx_combining_node {
+        xlio_ibv_send_wr *p_send_wqe;
+        xlio_tis *tis;
+        xlio_wr_tx_packet_attr attr;
+        int ret;
+    };
+
     inline void send_status_handler(int ret, xlio_ibv_send_wr *p_send_wqe);
+    inline int send_buffer_scoped(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_attr attr,
+                                  xlio_tis *tis);
+    void tx_scope_flush() override;
+    int tx_submit(xlio_ibv_send_wr *p_send_wqe, xlio_wr_tx_packet_attr attr, xlio_tis *tis);
+    void tx_combine();
     inline mem_buf_desc_t *get_tx_buffers(pbuf_type type, uint32_t n_num_mem_bufs);
     inline int put_tx_buffer_helper(mem_buf_desc_t *buff);
     inline int put_tx_buffers(mem_buf_desc_t *buff_list);
@@ -337,6 +357,8 @@ private:
     uint32_t m_zc_num_bufs;
     uint32_t m_tx_num_wr;
     uint32_t m_missing_buf_ref_count;
+    uint32_t m_tx_batch_depth; // Protected by m_lock_ring_tx
+    tx_combining_queue m_tx_submit_queue; // Pending sends of the combining TX path
     uint32_t m_tx_lkey; // this is the registered memory lkey for a given specific device for the
                         // buffer pool use
     gro_mgr m_gro_mgr;
@@ -345,6 +367,7 @@ private:
     struct ibv_comp_channel *m_p_tx_comp_event_channel;
     L2_address *m_p_l2_addr;
     uint32_t m_mtu;
+    const bool m_b_sysvar_tx_combining;
 
     struct {
         /* Maximum length of TCP payload for TSO */
@@ -36,6 +36,7 @@
 #include "proto/ip_frag.h"
 #include "dev/rfs_mc.h"
 #include "dev/rfs_uc_tcp_gro.h"
+#include "dev/rfs_uc_udp_gro.h"
 #include "sock/fd_collection.h"
 #include "sock/sockinfo.h"
 
@@ -81,6 +82,7 @@ ring_slave::ring_slave(int if_index, ring *parent, ring_type_t type)
     /* Set the same ring active status as related slave has for all ring types
      * excluding ring with type RING_TAP that does not have related slave device.
      * So it is marked as active just in case related netvsc device is absent.
+     * RING_LOOPBACK and RING_XDP are always active and set the state by themselves.
      */
     m_active = p_slave ? p_slave->active : p_ndev->get_slave_array().empty();
 
@@ -195,8 +197,8 @@ bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t,
                         si);
         }
 
-        auto itr = m_flow_udp_uc_map.find(rfs_key);
-        if (itr == end(m_flow_udp_uc_map)) {
+        p_rfs = m_flow_udp_uc_map.find(rfs_key);
+        if (!p_rfs) {
             // No rfs object exists so a new one must be created and inserted in the flow map
             if (safe_mce_sys().udp_3t_rules) {
                 flow_tuple udp_3t_only(flow_spec_5t.get_dst_ip(), flow_spec_5t.get_dst_port(),
@@ -206,8 +208,13 @@ bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t,
                     new rfs_rule_filter(m_ring.m_udp_uc_dst_port_attach_map, rule_key, udp_3t_only);
             }
             try {
-                p_tmp_rfs =
-                    new (std::nothrow) rfs_uc(&flow_spec_5t, &m_ring, dst_port_filter, flow_tag_id);
+                if (safe_mce_sys().gro_streams_max && m_ring.is_simple()) {
+                    p_tmp_rfs = new (std::nothrow)
+                        rfs_uc_udp_gro(&flow_spec_5t, &m_ring, dst_port_filter, flow_tag_id);
+                } else {
+                    p_tmp_rfs = new (std::nothrow)
+                        rfs_uc(&flow_spec_5t, &m_ring, dst_port_filter, flow_tag_id);
+                }
             } catch (xlio_exception &e) {
                 ring_logerr("%s", e.message);
                 return false;
@@ -224,10 +231,8 @@ bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t,
             if (!g_b_add_second_4t_rule)
 #endif
             {
-                m_flow_udp_uc_map[rfs_key] = p_rfs;
+                m_flow_udp_uc_map.set(rfs_key, p_rfs);
             }
-        } else {
-            p_rfs = itr->second;
         }
     } else if (flow_spec_5t.is_udp_mc()) {
         KEY2T key_udp_mc(flow_spec_5t.get_dst_ip(), flow_spec_5t.get_dst_port());
@@ -308,8 +313,8 @@ bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t,
             flow_tag_id = FLOW_TAG_MASK;
         }
 
-        auto itr = m_flow_tcp_map.find(rfs_key);
-        if (itr == end(m_flow_tcp_map)) {
+        p_rfs = m_flow_tcp_map.find(rfs_key);
+        if (!p_rfs) {
             // It means that no rfs object exists so I need to create a new one and insert it to
             // the flow map
             if (!force_5t && safe_mce_sys().tcp_3t_rules) {
@@ -344,10 +349,8 @@ bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t,
             if (!g_b_add_second_4t_rule)
 #endif
             {
-                m_flow_tcp_map[rfs_key] = p_rfs;
+                m_flow_tcp_map.set(rfs_key, p_rfs);
             }
-        } else {
-            p_rfs = itr->second;
         }
         BULLSEYE_EXCLUDE_BLOCK_START
     } else {
@@ -362,6 +365,7 @@ bool steering_handler<KEY4T, KEY2T, HDR>::attach_flow(flow_tuple &flow_spec_5t,
             // A flow with FlowTag was attached succesfully, check stored rfs for fast path be
             // tag_id
             si->set_flow_tag(flow_tag_id);
+            m_ring.flow_tag_table_set(flow_tag_id, si, p_rfs);
             ring_logdbg("flow_tag: %d registration is done!", flow_tag_id);
         }
     } else {
@@ -413,15 +417,15 @@ bool steering_handler<KEY4T, KEY2T, HDR>::detach_flow(flow_tuple &flow_spec_5t,
                     std::max(0, ((dst_port_iter->second.counter) - 1));
             }
         }
-        auto itr = m_flow_udp_uc_map.find(rfs_key);
+        p_rfs = m_flow_udp_uc_map.find(rfs_key);
         BULLSEYE_EXCLUDE_BLOCK_START
-        if (itr == end(m_flow_udp_uc_map)) {
+        if (!p_rfs) {
             ring_logdbg("Could not find rfs object to detach!");
             return false;
         }
         BULLSEYE_EXCLUDE_BLOCK_END
 
-        p_rfs = itr->second;
+        m_ring.flow_tag_table_clear(static_cast<sockinfo *>(sink), p_rfs);
         p_rfs->detach_flow(sink);
         if (!keep_in_map) {
             m_ring.m_udp_uc_dst_port_attach_map.erase(
@@ -429,7 +433,7 @@ bool steering_handler<KEY4T, KEY2T, HDR>::detach_flow(flow_tuple &flow_spec_5t,
         }
         if (p_rfs->get_num_of_sinks() == 0) {
             BULLSEYE_EXCLUDE_BLOCK_START
-            m_flow_udp_uc_map.erase(itr);
+            m_flow_udp_uc_map.erase(rfs_key);
             BULLSEYE_EXCLUDE_BLOCK_END
             delete p_rfs;
         }
@@ -457,6 +461,7 @@ bool steering_handler<KEY4T, KEY2T, HDR>::detach_flow(flow_tuple &flow_spec_5t,
         }
         BULLSEYE_EXCLUDE_BLOCK_END
         p_rfs = itr->second;
+        m_ring.flow_tag_table_clear(static_cast<sockinfo *>(sink), p_rfs);
         p_rfs->detach_flow(sink);
         if (!keep_in_map) {
             m_ring.m_l2_mc_ip_attach_map.erase(m_ring.m_l2_mc_ip_attach_map.find(rule_key));
@@ -484,22 +489,22 @@ bool steering_handler<KEY4T, KEY2T, HDR>::detach_flow(flow_tuple &flow_spec_5t,
                     std::max(0, ((dst_port_iter->second.counter) - 1));
             }
         }
-        auto itr = m_flow_tcp_map.find(rfs_key);
+        p_rfs = m_flow_tcp_map.find(rfs_key);
         BULLSEYE_EXCLUDE_BLOCK_START
-        if (itr == end(m_flow_tcp_map)) {
+        if (!p_rfs) {
             ring_logdbg("Could not find rfs object to detach!");
             return false;
         }
         BULLSEYE_EXCLUDE_BLOCK_END
 
-        p_rfs = itr->second;
+        m_ring.flow_tag_table_clear(static_cast<sockinfo *>(sink), p_rfs);
         p_rfs->detach_flow(sink);
         if (!keep_in_map) {
             m_ring.m_tcp_dst_port_attach_map.erase(m_ring.m_tcp_dst_port_attach_map.find(rule_key));
         }
         if (p_rfs->get_num_of_sinks() == 0) {
             BULLSEYE_EXCLUDE_BLOCK_START
-            m_flow_tcp_map.erase(itr);
+            m_flow_tcp_map.erase(rfs_key);
             BULLSEYE_EXCLUDE_BLOCK_END
             delete p_rfs;
         }
@@ -528,7 +533,7 @@ rfs_rule *steering_handler<KEY4T, KEY2T, HDR>::tls_rx_create_rule(const flow_tup
 {
     KEY4T rfs_key(flow_spec_5t.get_dst_ip(), flow_spec_5t.get_src_ip(), flow_spec_5t.get_dst_port(),
                   flow_spec_5t.get_src_port());
-    rfs *p_rfs = m_flow_tcp_map.find(rfs_key)->second;
+    rfs *p_rfs = m_flow_tcp_map.find(rfs_key);
     return p_rfs->create_rule(tir, flow_spec_5t);
 }
 
@@ -599,12 +604,9 @@ bool ring_slave::rx_process_buffer(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd
     if (likely(m_flow_tag_enabled && p_rx_wc_buf_desc->rx.flow_tag_id &&
                p_rx_wc_buf_desc->rx.flow_tag_id != FLOW_TAG_MASK &&
                !p_rx_wc_buf_desc->rx.is_sw_csum_need)) {
-        sockinfo *si = NULL;
-        // trying to get sockinfo per flow_tag_id-1 as it was incremented at attach
-        // to allow mapping sockfd=0
-        assert(g_p_fd_collection);
-        si = static_cast<sockinfo *>(
-            g_p_fd_collection->get_sockfd(p_rx_wc_buf_desc->rx.flow_tag_id - 1));
+        // Ring local table is indexed by flow tag directly, no fd_collection lookup
+        const flow_tag_entry *entry = flow_tag_table_get(p_rx_wc_buf_desc->rx.flow_tag_id);
+        sockinfo *si = entry ? entry->si : NULL;
 
         if (likely((si != NULL) && si->flow_tag_enabled())) {
             // will process packets with set flow_tag_id and enabled for the socket
@@ -670,7 +672,7 @@ bool ring_slave::rx_process_buffer(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd
                              p_tcp_h->fin ? "F" : "", ntohl(p_tcp_h->seq), ntohl(p_tcp_h->ack_seq),
                              ntohs(p_tcp_h->window), p_rx_wc_buf_desc->rx.sz_payload);
 
-                return si->rfs_ptr->rx_dispatch_packet(p_rx_wc_buf_desc, pv_fd_ready_array);
+                return entry->p_rfs->rx_dispatch_packet(p_rx_wc_buf_desc, pv_fd_ready_array);
             }
 
             if (likely(protocol == IPPROTO_UDP)) {
@@ -686,6 +688,7 @@ bool ring_slave::rx_process_buffer(mem_buf_desc_t *p_rx_wc_buf_desc, void *pv_fd
                 p_rx_wc_buf_desc->rx.sz_payload = ntohs(p_udp_h->len) - sizeof(struct udphdr);
 
                 p_rx_wc_buf_desc->rx.udp.ifindex = m_parent->get_if_index();
+                p_rx_wc_buf_desc->rx.udp.gro_size = 0;
                 p_rx_wc_buf_desc->rx.n_frags = 1;
 
                 ring_logfunc("FAST PATH Rx UDP datagram info: src_port=%d, dst_port=%d, "
@@ -1030,21 +1033,16 @@ bool steering_handler<KEY4T, KEY2T, HDR>::rx_process_buffer_no_flow_id(
 
         // Update the protocol info
         p_rx_wc_buf_desc->rx.udp.ifindex = m_ring.m_parent->get_if_index();
+        p_rx_wc_buf_desc->rx.udp.gro_size = 0;
 
         // Find the relevant hash map and pass the packet to the rfs for dispatching
         if (!p_rx_wc_buf_desc->rx.dst.is_mc()) { // This is UDP UC packet
-            auto itr =
+            p_rfs =
                 m_flow_udp_uc_map.find(KEY4T(p_rx_wc_buf_desc->rx.dst, p_rx_wc_buf_desc->rx.src));
 
             // If we didn't find a match for 5T, look for a match with 3T
-            if (unlikely(itr == end(m_flow_udp_uc_map))) {
-                auto itr3T =
-                    m_flow_udp_uc_map.find(KEY4T(p_rx_wc_buf_desc->rx.dst, s_sock_addrany));
-                if (likely(itr3T != end(m_flow_udp_uc_map))) {
-                    p_rfs = itr3T->second;
-                }
-            } else {
-                p_rfs = itr->second;
+            if (unlikely(!p_rfs)) {
+                p_rfs = m_flow_udp_uc_map.find(KEY4T(p_rx_wc_buf_desc->rx.dst, s_sock_addrany));
             }
         } else { // This is UDP MC packet
             auto itr = m_flow_udp_mc_map.find(KEY2T(p_rx_wc_buf_desc->rx.dst));
@@ -1088,16 +1086,11 @@ bool steering_handler<KEY4T, KEY2T, HDR>::rx_process_buffer_no_flow_id(
         p_rx_wc_buf_desc->rx.tcp.p_tcp_h = p_tcp_h;
 
         // Find the relevant hash map and pass the packet to the rfs for dispatching
-        auto itr = m_flow_tcp_map.find(KEY4T(p_rx_wc_buf_desc->rx.dst, p_rx_wc_buf_desc->rx.src));
+        p_rfs = m_flow_tcp_map.find(KEY4T(p_rx_wc_buf_desc->rx.dst, p_rx_wc_buf_desc->rx.src));
 
         // If we didn't find a match for 5T, look for a match with 3T
-        if (unlikely(itr == end(m_flow_tcp_map))) {
-            auto itr3T = m_flow_tcp_map.find(KEY4T(p_rx_wc_buf_desc->rx.dst, s_sock_addrany));
-            if (likely(itr3T != end(m_flow_tcp_map))) {
-                p_rfs = itr3T->second;
-            }
-        } else {
-            p_rfs = itr->second;
+        if (unlikely(!p_rfs)) {
+            p_rfs = m_flow_tcp_map.find(KEY4T(p_rx_wc_buf_desc->rx.dst, s_sock_addrany));
         }
     } break;
 
@@ -1130,6 +1123,12 @@ template <typename T> void clear_rfs_map(T &rfs_map)
     }
 }
 
+template <typename K> void clear_rfs_map(flow_hash_map<K, rfs *> &rfs_map)
+{
+    rfs_map.for_each([](const K &, rfs *p_rfs) { delete p_rfs; });
+    rfs_map.clear();
+}
+
 template <typename KEY4T, typename KEY2T, typename HDR>
 void steering_handler<KEY4T, KEY2T, HDR>::flow_del_all_rfs()
 {
@@ -1142,6 +1141,41 @@ void ring_slave::flow_del_all_rfs()
 {
     m_steering_ipv4.flow_del_all_rfs();
     m_steering_ipv6.flow_del_all_rfs();
+    m_flow_tag_table.clear();
+    m_flow_tag_index.clear();
+}
+
+void ring_slave::flow_tag_table_set(uint32_t flow_tag_id, sockinfo *si, rfs *p_rfs)
+{
+    // Flow tag is fd + 1 unless overridden by SO_XLIO_FLOW_TAG, such tags are not
+    // indexed and packets fall back to the steering maps.
+    if (flow_tag_id > static_cast<uint32_t>(g_p_fd_collection->get_fd_map_size())) {
+        ring_logdbg("flow_tag: %u is out of dispatch table range", flow_tag_id);
+        return;
+    }
+    if (flow_tag_id >= m_flow_tag_table.size()) {
+        size_t size = std::max<size_t>(flow_tag_id + 1, m_flow_tag_table.size() * 2);
+        m_flow_tag_table.resize(size, flow_tag_entry {NULL, NULL});
+    }
+
+    // Keep a single entry per socket/rfs pair and per tag
+    flow_tag_table_clear(si, p_rfs);
+    flow_tag_entry &entry = m_flow_tag_table[flow_tag_id];
+    if (entry.si) {
+        m_flow_tag_index.erase(std::make_pair(entry.si, entry.p_rfs));
+    }
+    entry = flow_tag_entry {si, p_rfs};
+    m_flow_tag_index[std::make_pair(si, p_rfs)] = flow_tag_id;
+}
+
+void ring_slave::flow_tag_table_clear(sockinfo *si, rfs *p_rfs)
+{
+    auto itr = m_flow_tag_index.find(std::make_pair(si, p_rfs));
+
+    if (itr != m_flow_tag_index.end()) {
+        m_flow_tag_table[itr->second] = flow_tag_entry {NULL, NULL};
+        m_flow_tag_index.erase(itr);
+    }
 }
 
 bool ring_slave::request_more_tx_buffers(pbuf_type type, uint32_t count, uint32_t lkey)
@@ -34,11 +34,14 @@
 #define RING_SLAVE_H_
 
 #include "ring.h"
+#include <map>
 #include <memory>
 #include "dev/net_device_table_mgr.h"
 #include "util/sock_addr.h"
+#include "util/flow_hash_map.h"
 
 class rfs;
+class sockinfo;
 struct iphdr;
 struct ip6_hdr;
 
@@ -240,6 +243,14 @@ typedef std::unordered_map<sock_addr, struct counter_and_ibv_flows> rule_filter_
 
 class ring_slave;
 
+/* Flow tag dispatch table entry. Flow tag id is the socket fd + 1, so the table is
+ * indexed directly and an entry never straddles a cache line.
+ */
+struct flow_tag_entry {
+    sockinfo *si;
+    rfs *p_rfs;
+};
+
 template <typename KEY4T, typename KEY2T, typename HDR> class steering_handler {
 public:
     steering_handler(ring_slave &ring)
@@ -261,7 +272,7 @@ public:
 #endif /* DEFINED_UTLS */
 
 private:
-    typedef std::unordered_map<KEY4T, rfs *> flow_spec_4t_map;
+    typedef flow_hash_map<KEY4T, rfs *> flow_spec_4t_map;
     typedef std::unordered_map<KEY2T, rfs *> flow_spec_2t_map;
 
     flow_spec_4t_map m_flow_tcp_map;
@@ -300,7 +311,7 @@ public:
     rfs_rule *tls_rx_create_rule(const flow_tuple &flow_spec_5t, xlio_tir *tir);
 #endif /* DEFINED_UTLS */
 
-    inline bool is_simple() const { return m_type != RING_TAP; }
+    inline bool is_simple() const { return m_type == RING_ETH; }
     transport_type_t get_transport_type() const { return m_transport_type; }
     inline ring_type_t get_type() const { return m_type; }
 
@@ -309,6 +320,14 @@ public:
 protected:
     bool request_more_tx_buffers(pbuf_type type, uint32_t count, uint32_t lkey);
     void flow_del_all_rfs();
+    void flow_tag_table_set(uint32_t flow_tag_id, sockinfo *si, rfs *p_rfs);
+    void flow_tag_table_clear(sockinfo *si, rfs *p_rfs);
+
+    inline const flow_tag_entry *flow_tag_table_get(uint32_t flow_tag_id) const
+    {
+        return likely(flow_tag_id < m_flow_tag_table.size()) ? &m_flow_tag_table[flow_tag_id]
+                                                             : NULL;
+    }
 
     steering_handler<flow_spec_4t_key_ipv4, flow_spec_2t_key_ipv4, iphdr> m_steering_ipv4;
     steering_handler<flow_spec_4t_key_ipv6, flow_spec_2t_key_ipv6, ip6_hdr> m_steering_ipv6;
@@ -321,6 +340,11 @@ protected:
     rule_filter_map_t m_tcp_dst_port_attach_map;
     rule_filter_map_t m_udp_uc_dst_port_attach_map;
 
+    // Ring local flow tag -> socket/rfs dispatch table, protected by m_lock_ring_rx
+    std::vector<flow_tag_entry> m_flow_tag_table;
+    // Reverse index of the table, SO_XLIO_FLOW_TAG may change the socket tag after attach
+    std::map<std::pair<sockinfo *, rfs *>, uint32_t> m_flow_tag_index;
+
     lock_spin_recursive m_lock_ring_rx;
     mutable lock_spin_recursive m_lock_ring_tx;
 
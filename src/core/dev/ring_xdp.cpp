@@ -0,0 +1,738 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "ring_xdp.h"
+
+#if defined(DEFINED_XDP)
+
+#include <sys/mman.h>
+#include "util/sg_array.h"
+#include "sock/fd_collection.h"
+#include "dev/net_device_table_mgr.h"
+#include "dev/xdp_prog.h"
+
+#undef MODULE_NAME
+#define MODULE_NAME "ring_xdp"
+#undef MODULE_HDR
+#define MODULE_HDR MODULE_NAME "%d:%s() "
+
+static inline uint32_t roundup_pow_of_two(uint32_t n)
+{
+    uint32_t size = 1;
+
+    while (size < n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+ring_xdp::ring_xdp(int if_index, ring *parent)
+    : ring_slave(if_index, parent, RING_XDP)
+    , m_xsk_fd(-1)
+    , m_queue_id(0)
+    , m_p_xdp_prog(NULL)
+    , m_sysvar_qp_compensation_level(safe_mce_sys().qp_compensation_level)
+    , m_n_sysvar_cq_poll_batch_max(safe_mce_sys().cq_poll_batch_max)
+    , m_umem(NULL)
+    , m_umem_size(0)
+    , m_umem_stride(0)
+    , m_p_rx_spare(NULL)
+{
+    memset(&m_fill, 0, sizeof(m_fill));
+    memset(&m_rx, 0, sizeof(m_rx));
+    memset(&m_tx, 0, sizeof(m_tx));
+    memset(&m_comp, 0, sizeof(m_comp));
+
+    /* Throws on failure, so no ring is created for the interface */
+    xsk_create();
+
+    m_active = true;
+
+    /* AF_XDP socket is readable once RX ring has packets */
+    m_p_n_rx_channel_fds = new int[1];
+    m_p_n_rx_channel_fds[0] = m_xsk_fd;
+    g_p_fd_collection->add_cq_channel_fd(m_xsk_fd, this);
+
+    /* Initialize RX buffer poll and give the buffers to the kernel */
+    m_rx_pool.set_id("ring_xdp (%p) : m_rx_pool", this);
+    m_lock_ring_rx.lock();
+    fill_rx_buffers();
+    m_lock_ring_rx.unlock();
+
+    /* Initialize TX buffer poll */
+    request_more_tx_buffers(PBUF_RAM, m_sysvar_qp_compensation_level, 0);
+
+    m_p_ring_stat->xdp.n_queue_id = m_queue_id;
+
+    ring_logdbg("new ring_xdp() xsk_fd=%d queue=%u umem=%p size=%zu stride=%zu", m_xsk_fd,
+                m_queue_id, m_umem, m_umem_size, m_umem_stride);
+}
+
+ring_xdp::~ring_xdp()
+{
+    m_lock_ring_rx.lock();
+    flow_del_all_rfs();
+    for (auto &itr : m_flows) {
+        m_p_xdp_prog->del_flow(itr.first);
+    }
+    m_flows.clear();
+    m_lock_ring_rx.unlock();
+
+    if (g_p_fd_collection) {
+        g_p_fd_collection->del_cq_channel_fd(m_xsk_fd, true);
+    }
+
+    /* The kernel doesn't access the buffers after the socket is closed */
+    xsk_destroy();
+
+    for (size_t i = 0; i < m_umem_bufs.size(); i++) {
+        if (m_umem_bufs[i]) {
+            m_rx_pool.push_back(m_umem_bufs[i]);
+        }
+    }
+    if (m_p_rx_spare) {
+        m_rx_pool.push_back(m_p_rx_spare);
+    }
+
+    /* Release RX buffer poll */
+    g_buffer_pool_rx_ptr->put_buffers_thread_safe(&m_rx_pool, m_rx_pool.size());
+    g_buffer_pool_rx_ptr->put_buffers_thread_safe(&m_tx_frames, m_tx_frames.size());
+
+    delete[] m_p_n_rx_channel_fds;
+}
+
+void ring_xdp::xsk_create()
+{
+    net_device_val *p_ndev = g_p_net_device_table_mgr->get_net_device_val(m_parent->get_if_index());
+    uint32_t rx_size = roundup_pow_of_two(safe_mce_sys().rx_num_wr);
+    uint32_t tx_size = roundup_pow_of_two(safe_mce_sys().tx_num_wr);
+    struct xdp_mmap_offsets off;
+    struct xdp_umem_reg umem_reg;
+    struct sockaddr_xdp sxdp;
+    socklen_t optlen = sizeof(off);
+    const char *err = NULL;
+
+    /* XDP works on the underlying device of VLAN interfaces */
+    int link_index = if_nametoindex(p_ndev->get_ifname_link());
+
+    m_umem = (uint8_t *)g_buffer_pool_rx_ptr->get_data_block(m_umem_size, m_umem_stride);
+    m_umem_bufs.resize(m_umem_stride ? m_umem_size / m_umem_stride : 0, NULL);
+
+    m_p_xdp_prog = xdp_prog::get(link_index);
+    if (!m_p_xdp_prog) {
+        throw_xlio_exception("XDP program setup failed");
+    }
+    m_queue_id = m_p_xdp_prog->reserve_queue();
+
+    m_xsk_fd = orig_os_api.socket(AF_XDP, SOCK_RAW, 0);
+    if (m_xsk_fd < 0) {
+        err = "AF_XDP socket creation";
+        goto error;
+    }
+
+    memset(&umem_reg, 0, sizeof(umem_reg));
+    umem_reg.addr = (uint64_t)(uintptr_t)m_umem;
+    umem_reg.len = m_umem_size;
+    umem_reg.chunk_size = (uint32_t)m_umem_stride;
+    umem_reg.headroom = 0;
+    umem_reg.flags = XDP_UMEM_UNALIGNED_CHUNK_FLAG;
+    if (!m_umem || orig_os_api.setsockopt(m_xsk_fd, SOL_XDP, XDP_UMEM_REG, &umem_reg,
+                                          sizeof(umem_reg))) {
+        err = "UMEM registration";
+        goto error;
+    }
+
+    if (orig_os_api.setsockopt(m_xsk_fd, SOL_XDP, XDP_UMEM_FILL_RING, &rx_size, sizeof(rx_size)) ||
+        orig_os_api.setsockopt(m_xsk_fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &tx_size,
+                               sizeof(tx_size)) ||
+        orig_os_api.setsockopt(m_xsk_fd, SOL_XDP, XDP_RX_RING, &rx_size, sizeof(rx_size)) ||
+        orig_os_api.setsockopt(m_xsk_fd, SOL_XDP, XDP_TX_RING, &tx_size, sizeof(tx_size))) {
+        err = "Rings creation";
+        goto error;
+    }
+
+    if (orig_os_api.getsockopt(m_xsk_fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optlen) ||
+        !xsk_ring_map(m_fill, rx_size, off.fr, sizeof(uint64_t), XDP_UMEM_PGOFF_FILL_RING) ||
+        !xsk_ring_map(m_comp, tx_size, off.cr, sizeof(uint64_t),
+                      XDP_UMEM_PGOFF_COMPLETION_RING) ||
+        !xsk_ring_map(m_rx, rx_size, off.rx, sizeof(struct xdp_desc), XDP_PGOFF_RX_RING) ||
+        !xsk_ring_map(m_tx, tx_size, off.tx, sizeof(struct xdp_desc), XDP_PGOFF_TX_RING)) {
+        err = "Rings mapping";
+        goto error;
+    }
+
+    memset(&sxdp, 0, sizeof(sxdp));
+    sxdp.sxdp_family = AF_XDP;
+    sxdp.sxdp_ifindex = link_index;
+    sxdp.sxdp_queue_id = m_queue_id;
+    sxdp.sxdp_flags = XDP_COPY | XDP_USE_NEED_WAKEUP;
+    if (orig_os_api.bind(m_xsk_fd, (struct sockaddr *)&sxdp, sizeof(sxdp))) {
+        err = "Socket bind";
+        goto error;
+    }
+
+    if (!m_p_xdp_prog->add_socket(m_queue_id, m_xsk_fd)) {
+        err = "XSKMAP update";
+        goto error;
+    }
+
+    return;
+
+error:
+    ring_logerr("%s failed for %s queue %u (errno=%d %m)", err, p_ndev->get_ifname_link(),
+                m_queue_id, errno);
+    xsk_destroy();
+    throw_xlio_exception("AF_XDP socket creation failed");
+}
+
+void ring_xdp::xsk_destroy()
+{
+    xsk_ring_unmap(m_fill);
+    xsk_ring_unmap(m_comp);
+    xsk_ring_unmap(m_rx);
+    xsk_ring_unmap(m_tx);
+
+    if (m_xsk_fd >= 0) {
+        orig_os_api.close(m_xsk_fd);
+        m_xsk_fd = -1;
+    }
+    if (m_p_xdp_prog) {
+        m_p_xdp_prog->del_socket(m_queue_id);
+        xdp_prog::put(m_p_xdp_prog);
+        m_p_xdp_prog = NULL;
+    }
+}
+
+bool ring_xdp::xsk_ring_map(xsk_ring &r, uint32_t size, const struct xdp_ring_offset &off,
+                            size_t desc_size, off_t pgoff)
+{
+    r.map_len = off.desc + size * desc_size;
+    r.map = mmap(NULL, r.map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_xsk_fd,
+                 pgoff);
+    if (r.map == MAP_FAILED) {
+        r.map = NULL;
+        return false;
+    }
+
+    r.producer = (uint32_t *)((uint8_t *)r.map + off.producer);
+    r.consumer = (uint32_t *)((uint8_t *)r.map + off.consumer);
+    r.flags = (uint32_t *)((uint8_t *)r.map + off.flags);
+    r.descs = (uint8_t *)r.map + off.desc;
+    r.mask = size - 1;
+
+    return true;
+}
+
+void ring_xdp::xsk_ring_unmap(xsk_ring &r)
+{
+    if (r.map) {
+        munmap(r.map, r.map_len);
+        r.map = NULL;
+    }
+}
+
+inline uint64_t ring_xdp::buffer_to_addr(mem_buf_desc_t *buff)
+{
+    return (uint64_t)(buff->p_buffer - m_umem);
+}
+
+inline mem_buf_desc_t *ring_xdp::addr_to_buffer(uint64_t addr)
+{
+    /* Received descriptors keep data offset in the upper bits */
+    addr = (addr & XSK_UNALIGNED_BUF_ADDR_MASK) + (addr >> XSK_UNALIGNED_BUF_OFFSET_SHIFT);
+
+    size_t idx = addr / m_umem_stride;
+    mem_buf_desc_t *buff = m_umem_bufs[idx];
+    m_umem_bufs[idx] = NULL;
+
+    return buff;
+}
+
+bool ring_xdp::attach_flow(flow_tuple &flow_spec_5t, pkt_rcvr_sink *sink, bool force_5t)
+{
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+    bool ret = ring_slave::attach_flow(flow_spec_5t, sink, force_5t);
+
+    if (ret && (flow_spec_5t.is_tcp() || flow_spec_5t.is_udp_uc() || flow_spec_5t.is_udp_mc())) {
+        if (m_flows[flow_spec_5t]++ == 0 && !m_p_xdp_prog->add_flow(flow_spec_5t)) {
+            m_flows.erase(flow_spec_5t);
+            ring_slave::detach_flow(flow_spec_5t, sink);
+            ret = false;
+        }
+    }
+
+    return ret;
+}
+
+bool ring_xdp::detach_flow(flow_tuple &flow_spec_5t, pkt_rcvr_sink *sink)
+{
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+
+    auto itr = m_flows.find(flow_spec_5t);
+    if (itr != m_flows.end() && --itr->second == 0) {
+        m_flows.erase(itr);
+        m_p_xdp_prog->del_flow(flow_spec_5t);
+    }
+
+    return ring_slave::detach_flow(flow_spec_5t, sink);
+}
+
+int ring_xdp::poll_and_process_element_rx(uint64_t *, void *pv_fd_ready_array)
+{
+    return process_element_rx(pv_fd_ready_array);
+}
+
+int ring_xdp::poll_and_process_element_tx(uint64_t *)
+{
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+
+    process_tx_completions();
+    return 0;
+}
+
+int ring_xdp::wait_for_notification_and_process_element(int, uint64_t *, void *pv_fd_ready_array)
+{
+    return process_element_rx(pv_fd_ready_array);
+}
+
+int ring_xdp::drain_and_proccess()
+{
+    return process_element_rx(NULL);
+}
+
+int ring_xdp::request_notification(cq_type_t cq_type, uint64_t poll_sn)
+{
+    NOT_IN_USE(cq_type);
+    NOT_IN_USE(poll_sn);
+
+    /* Socket readiness is level triggered, nothing to arm */
+    return 0;
+}
+
+bool ring_xdp::reclaim_recv_buffers(descq_t *rx_reuse)
+{
+    /* RX path holds the ring lock while delivering to sockets, don't wait for it */
+    if (m_lock_ring_rx.trylock()) {
+        errno = EAGAIN;
+        return false;
+    }
+
+    while (!rx_reuse->empty()) {
+        mem_buf_desc_t *buff = rx_reuse->get_and_pop_front();
+        reclaim_recv_buffers_no_lock(buff);
+    }
+
+    if (m_rx_pool.size() >= m_sysvar_qp_compensation_level * 2) {
+        int buff_to_rel = m_rx_pool.size() - m_sysvar_qp_compensation_level;
+
+        g_buffer_pool_rx_ptr->put_buffers_thread_safe(&m_rx_pool, buff_to_rel);
+        m_p_ring_stat->xdp.n_rx_buffers = m_rx_pool.size();
+    }
+    m_lock_ring_rx.unlock();
+
+    return true;
+}
+
+bool ring_xdp::reclaim_recv_buffers(mem_buf_desc_t *buff)
+{
+    bool ret = false;
+
+    if (!m_lock_ring_rx.trylock()) {
+        ret = reclaim_recv_buffers_no_lock(buff);
+        m_lock_ring_rx.unlock();
+    } else {
+        errno = EAGAIN;
+    }
+
+    return ret;
+}
+
+// call under m_lock_ring_rx lock
+bool ring_xdp::reclaim_recv_buffers_no_lock(mem_buf_desc_t *buff)
+{
+    if (buff && (buff->dec_ref_count() <= 1)) {
+        mem_buf_desc_t *temp = NULL;
+        while (buff) {
+            if (buff->lwip_pbuf_dec_ref_count() <= 0) {
+                temp = buff;
+                buff = temp->p_next_desc;
+                temp->clear_transport_data();
+                temp->p_next_desc = NULL;
+                temp->p_prev_desc = NULL;
+                temp->reset_ref_count();
+                free_lwip_pbuf(&temp->lwip_pbuf);
+                m_rx_pool.push_back(temp);
+            } else {
+                buff->reset_ref_count();
+                buff = buff->p_next_desc;
+            }
+        }
+        m_p_ring_stat->xdp.n_rx_buffers = m_rx_pool.size();
+        return true;
+    }
+    return false;
+}
+
+void ring_xdp::send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                xlio_wr_tx_packet_attr attr)
+{
+    NOT_IN_USE(id);
+    compute_tx_checksum((mem_buf_desc_t *)(p_send_wqe->wr_id), attr & XLIO_TX_PACKET_L3_CSUM,
+                        attr & XLIO_TX_PACKET_L4_CSUM);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    int ret = send_buffer(p_send_wqe);
+    send_status_handler(ret, p_send_wqe);
+}
+
+int ring_xdp::send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                               xlio_wr_tx_packet_attr attr, xlio_tis *tis)
+{
+    NOT_IN_USE(id);
+    NOT_IN_USE(tis);
+    compute_tx_checksum((mem_buf_desc_t *)(p_send_wqe->wr_id), attr & XLIO_TX_PACKET_L3_CSUM,
+                        attr & XLIO_TX_PACKET_L4_CSUM);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    int ret = send_buffer(p_send_wqe);
+    send_status_handler(ret, p_send_wqe);
+    return ret;
+}
+
+int ring_xdp::process_element_rx(void *pv_fd_ready_array)
+{
+    uint32_t cons = *m_rx.consumer;
+
+    if (__atomic_load_n(m_rx.producer, __ATOMIC_ACQUIRE) == cons) {
+        return 0;
+    }
+
+    std::lock_guard<decltype(m_lock_ring_rx)> lock(m_lock_ring_rx);
+
+    cons = *m_rx.consumer;
+    uint32_t count = std::min(__atomic_load_n(m_rx.producer, __ATOMIC_ACQUIRE) - cons,
+                              m_n_sysvar_cq_poll_batch_max);
+    for (uint32_t i = 0; i < count; i++) {
+        struct xdp_desc *desc = (struct xdp_desc *)m_rx.descs + ((cons + i) & m_rx.mask);
+        mem_buf_desc_t *buff = addr_to_buffer(desc->addr);
+
+        buff->sz_data = desc->len;
+        buff->rx.is_sw_csum_need = 1;
+        buff->rx.is_xlio_thr = false;
+        buff->rx.timestamps.hw_raw = 0;
+        buff->rx.flow_tag_id = 0;
+        if (!rx_process_buffer(buff, pv_fd_ready_array)) {
+            m_rx_pool.push_front(buff);
+        }
+    }
+    __atomic_store_n(m_rx.consumer, cons + count, __ATOMIC_RELEASE);
+
+    fill_rx_buffers();
+
+    return (int)count;
+}
+
+bool ring_xdp::request_more_rx_buffers()
+{
+    ring_logfuncall("Allocating additional %d buffers for internal use",
+                    m_sysvar_qp_compensation_level);
+
+    bool res = g_buffer_pool_rx_ptr->get_buffers_thread_safe(m_rx_pool, this,
+                                                             m_sysvar_qp_compensation_level, 0);
+    if (!res) {
+        ring_logfunc("Out of mem_buf_desc from RX free pool for internal object pool");
+        return false;
+    }
+
+    m_p_ring_stat->xdp.n_rx_buffers = m_rx_pool.size();
+
+    return true;
+}
+
+// call under m_lock_ring_rx lock
+void ring_xdp::fill_rx_buffers()
+{
+    uint32_t prod = *m_fill.producer;
+    uint32_t free = m_fill.mask + 1 - (prod - __atomic_load_n(m_fill.consumer, __ATOMIC_ACQUIRE));
+    uint32_t count = 0;
+
+    /* Refill in batches to amortize the producer update */
+    if (free < m_n_sysvar_cq_poll_batch_max) {
+        return;
+    }
+
+    while (count < free && (!m_rx_pool.empty() || request_more_rx_buffers())) {
+        mem_buf_desc_t *buff = m_rx_pool.get_and_pop_front();
+        uint64_t addr = buffer_to_addr(buff);
+
+        if (unlikely(addr < RING_XDP_FRAME_HEADROOM)) {
+            /* The first buffer of the pool has no headroom in UMEM */
+            m_p_rx_spare = buff;
+            continue;
+        }
+        m_umem_bufs[addr / m_umem_stride] = buff;
+        ((uint64_t *)m_fill.descs)[(prod + count) & m_fill.mask] = addr - RING_XDP_FRAME_HEADROOM;
+        count++;
+    }
+    __atomic_store_n(m_fill.producer, prod + count, __ATOMIC_RELEASE);
+
+    m_p_ring_stat->xdp.n_rx_buffers = m_rx_pool.size();
+}
+
+// call under m_lock_ring_tx lock
+mem_buf_desc_t *ring_xdp::get_tx_frame()
+{
+    if (unlikely(m_tx_frames.empty()) &&
+        !g_buffer_pool_rx_ptr->get_buffers_thread_safe(m_tx_frames, this,
+                                                       m_sysvar_qp_compensation_level, 0)) {
+        return NULL;
+    }
+
+    return m_tx_frames.get_and_pop_front();
+}
+
+// call under m_lock_ring_tx lock
+void ring_xdp::process_tx_completions()
+{
+    uint32_t cons = *m_comp.consumer;
+    uint32_t count = __atomic_load_n(m_comp.producer, __ATOMIC_ACQUIRE) - cons;
+
+    if (!count) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t addr = ((uint64_t *)m_comp.descs)[(cons + i) & m_comp.mask];
+        m_tx_frames.push_back(addr_to_buffer(addr));
+    }
+    __atomic_store_n(m_comp.consumer, cons + count, __ATOMIC_RELEASE);
+
+    if (m_tx_frames.size() >= m_sysvar_qp_compensation_level * 2) {
+        int return_bufs = m_tx_frames.size() - m_sysvar_qp_compensation_level;
+        g_buffer_pool_rx_ptr->put_buffers_thread_safe(&m_tx_frames, return_bufs);
+    }
+}
+
+// call under m_lock_ring_tx lock
+void ring_xdp::tx_kick()
+{
+    /* Copy mode transmits descriptors in the context of sendto() */
+    if (__atomic_load_n(m_tx.flags, __ATOMIC_ACQUIRE) & XDP_RING_NEED_WAKEUP) {
+        m_p_ring_stat->xdp.n_tx_kicks++;
+        if (orig_os_api.sendto(m_xsk_fd, NULL, 0, MSG_DONTWAIT, NULL, 0) < 0 &&
+            errno != EAGAIN && errno != EBUSY && errno != ENOBUFS) {
+            ring_logdbg("sendto: xsk_fd %d, errno: %d", m_xsk_fd, errno);
+        }
+    }
+}
+
+int ring_xdp::send_buffer(xlio_ibv_send_wr *wr)
+{
+    uint32_t prod = *m_tx.producer;
+    mem_buf_desc_t *frame;
+    size_t len = 0;
+
+    process_tx_completions();
+
+    if (unlikely(prod - __atomic_load_n(m_tx.consumer, __ATOMIC_ACQUIRE) > m_tx.mask)) {
+        /* TX ring is full, let the kernel progress */
+        tx_kick();
+        m_p_ring_stat->xdp.n_tx_dropped++;
+        return -1;
+    }
+
+    frame = get_tx_frame();
+    if (unlikely(!frame)) {
+        m_p_ring_stat->xdp.n_tx_dropped++;
+        return -1;
+    }
+
+    for (int i = 0; i < wr->num_sge; i++) {
+        if (unlikely(len + wr->sg_list[i].length > m_umem_stride)) {
+            ring_logfunc("Packet dropped (size=%zu)", len + wr->sg_list[i].length);
+            m_tx_frames.push_front(frame);
+            m_p_ring_stat->xdp.n_tx_dropped++;
+            return -1;
+        }
+        memcpy(frame->p_buffer + len, (void *)wr->sg_list[i].addr, wr->sg_list[i].length);
+        len += wr->sg_list[i].length;
+    }
+
+    uint64_t addr = buffer_to_addr(frame);
+    struct xdp_desc *desc = (struct xdp_desc *)m_tx.descs + (prod & m_tx.mask);
+    desc->addr = addr;
+    desc->len = (uint32_t)len;
+    desc->options = 0;
+    m_umem_bufs[addr / m_umem_stride] = frame;
+    __atomic_store_n(m_tx.producer, prod + 1, __ATOMIC_RELEASE);
+
+    tx_kick();
+
+    return (int)len;
+}
+
+void ring_xdp::send_status_handler(int ret, xlio_ibv_send_wr *p_send_wqe)
+{
+    if (p_send_wqe) {
+        mem_buf_desc_t *p_mem_buf_desc = (mem_buf_desc_t *)(p_send_wqe->wr_id);
+
+        if (likely(ret > 0)) {
+            // Update TX statistics
+            m_p_ring_stat->n_tx_byte_count += ret;
+            ++m_p_ring_stat->n_tx_pkt_count;
+        }
+
+        /* Data was copied to UMEM, complete the WQE immediately */
+        mem_buf_tx_release(p_mem_buf_desc, true);
+    }
+}
+
+mem_buf_desc_t *ring_xdp::mem_buf_tx_get(ring_user_id_t id, bool b_block, pbuf_type type,
+                                         int n_num_mem_bufs)
+{
+    mem_buf_desc_t *head = NULL;
+
+    NOT_IN_USE(id);
+    NOT_IN_USE(b_block);
+
+    ring_logfuncall("n_num_mem_bufs=%d", n_num_mem_bufs);
+
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+    descq_t &pool = type == PBUF_ZEROCOPY ? m_zc_pool : m_tx_pool;
+
+    if (unlikely((int)pool.size() < n_num_mem_bufs)) {
+        request_more_tx_buffers(type, std::max<uint32_t>(m_sysvar_qp_compensation_level,
+                                                         n_num_mem_bufs),
+                                0);
+
+        if (unlikely((int)pool.size() < n_num_mem_bufs)) {
+            return head;
+        }
+    }
+
+    head = pool.get_and_pop_back();
+    head->lwip_pbuf.pbuf.ref = 1;
+    n_num_mem_bufs--;
+
+    mem_buf_desc_t *next = head;
+    while (n_num_mem_bufs) {
+        next->p_next_desc = pool.get_and_pop_back();
+        next = next->p_next_desc;
+        next->lwip_pbuf.pbuf.ref = 1;
+        n_num_mem_bufs--;
+    }
+
+    return head;
+}
+
+inline void ring_xdp::return_to_global_pool()
+{
+    if (m_tx_pool.size() >= m_sysvar_qp_compensation_level * 2) {
+        int return_bufs = m_tx_pool.size() - m_sysvar_qp_compensation_level;
+        g_buffer_pool_tx->put_buffers_thread_safe(&m_tx_pool, return_bufs);
+    }
+    if (m_zc_pool.size() >= m_sysvar_qp_compensation_level * 2) {
+        int return_bufs = m_zc_pool.size() - m_sysvar_qp_compensation_level;
+        g_buffer_pool_zc->put_buffers_thread_safe(&m_zc_pool, return_bufs);
+    }
+}
+
+// call under m_lock_ring_tx lock
+inline void ring_xdp::put_tx_buffer_helper(mem_buf_desc_t *buff)
+{
+    // potential race, ref is protected here by ring_tx lock, and in dst_entry_tcp &
+    // sockinfo_tcp by tcp lock
+    if (likely(buff->lwip_pbuf.pbuf.ref)) {
+        buff->lwip_pbuf.pbuf.ref--;
+    } else {
+        ring_logerr("ref count of %p is already zero, double free??", buff);
+    }
+
+    if (buff->lwip_pbuf.pbuf.ref == 0) {
+        descq_t &pool = buff->lwip_pbuf.pbuf.type == PBUF_ZEROCOPY ? m_zc_pool : m_tx_pool;
+        buff->p_next_desc = NULL;
+        free_lwip_pbuf(&buff->lwip_pbuf);
+        pool.push_back(buff);
+    }
+}
+
+void ring_xdp::mem_buf_desc_return_single_to_owner_tx(mem_buf_desc_t *p_mem_buf_desc)
+{
+    std::lock_guard<decltype(m_lock_ring_tx)> lock(m_lock_ring_tx);
+
+    if (likely(p_mem_buf_desc)) {
+        put_tx_buffer_helper(p_mem_buf_desc);
+    }
+
+    return_to_global_pool();
+}
+
+void ring_xdp::mem_buf_desc_return_single_multi_ref(mem_buf_desc_t *p_mem_buf_desc, unsigned ref)
+{
+    if (unlikely(ref == 0)) {
+        return;
+    }
+
+    m_lock_ring_tx.lock();
+    p_mem_buf_desc->lwip_pbuf.pbuf.ref -=
+        std::min<unsigned>(p_mem_buf_desc->lwip_pbuf.pbuf.ref, ref - 1);
+    m_lock_ring_tx.unlock();
+    mem_buf_desc_return_single_to_owner_tx(p_mem_buf_desc);
+}
+
+int ring_xdp::mem_buf_tx_release(mem_buf_desc_t *buff_list, bool b_accounting, bool trylock)
+{
+    int count = 0;
+    mem_buf_desc_t *next;
+
+    NOT_IN_USE(b_accounting);
+
+    if (!trylock) {
+        m_lock_ring_tx.lock();
+    } else if (m_lock_ring_tx.trylock()) {
+        return 0;
+    }
+
+    while (buff_list) {
+        next = buff_list->p_next_desc;
+        put_tx_buffer_helper(buff_list);
+        count++;
+        buff_list = next;
+    }
+
+    return_to_global_pool();
+    m_lock_ring_tx.unlock();
+
+    return count;
+}
+
+#endif /* DEFINED_XDP */
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RING_XDP_H_
+#define RING_XDP_H_
+
+#include <config.h>
+
+#if defined(DEFINED_XDP)
+
+#include <map>
+#include <vector>
+#include <linux/if_xdp.h>
+
+#include "ring_slave.h"
+
+/* Space the kernel reserves in front of a received frame */
+#define RING_XDP_FRAME_HEADROOM 256
+/* Minimal UMEM chunk size accepted by the kernel */
+#define RING_XDP_MIN_CHUNK_SIZE 2048
+#define RING_XDP_MAX_SEND_SGE   16
+
+class xdp_prog;
+
+/**
+ * Ring on top of an AF_XDP socket for NICs without mlx5 support.
+ *
+ * The UMEM is the data memory of the RX buffer pool, registered with
+ * unaligned chunks, so a chunk is a mem_buf_desc_t buffer and the fill,
+ * RX, TX and completion rings carry buffer offsets. A fill address points
+ * RING_XDP_FRAME_HEADROOM bytes before the buffer, so the kernel places the
+ * frame exactly at p_buffer. Transmitted frames are copied into buffers of the
+ * same pool, the WQE is completed at post time.
+ *
+ * The socket is bound to a single queue of the interface. The interface XDP
+ * program (see xdp_prog) redirects packets of the attached flows which are
+ * received on that queue, the rest goes to the kernel.
+ * Checksums are calculated and verified in software, TSO is not supported.
+ */
+class ring_xdp : public ring_slave {
+public:
+    ring_xdp(int if_index, ring *parent = NULL);
+    virtual ~ring_xdp();
+
+    virtual bool is_up() { return m_active; }
+    virtual bool attach_flow(flow_tuple &flow_spec_5t, pkt_rcvr_sink *sink, bool force_5t = false);
+    virtual bool detach_flow(flow_tuple &flow_spec_5t, pkt_rcvr_sink *sink);
+    virtual int poll_and_process_element_rx(uint64_t *p_cq_poll_sn, void *pv_fd_ready_array = NULL);
+    virtual int poll_and_process_element_tx(uint64_t *p_cq_poll_sn);
+    virtual int wait_for_notification_and_process_element(int cq_channel_fd, uint64_t *p_cq_poll_sn,
+                                                          void *pv_fd_ready_array = NULL);
+    virtual int drain_and_proccess();
+    virtual bool reclaim_recv_buffers(descq_t *rx_reuse);
+    virtual bool reclaim_recv_buffers(mem_buf_desc_t *buff);
+    virtual int reclaim_recv_single_buffer(mem_buf_desc_t *rx_reuse)
+    {
+        NOT_IN_USE(rx_reuse);
+        return -1;
+    }
+    virtual void send_ring_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                  xlio_wr_tx_packet_attr attr);
+    virtual int send_lwip_buffer(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe,
+                                 xlio_wr_tx_packet_attr attr, xlio_tis *tis);
+    virtual void mem_buf_desc_return_single_to_owner_tx(mem_buf_desc_t *p_mem_buf_desc);
+    virtual void mem_buf_desc_return_single_multi_ref(mem_buf_desc_t *p_mem_buf_desc, unsigned ref);
+    virtual mem_buf_desc_t *mem_buf_tx_get(ring_user_id_t id, bool b_block, pbuf_type type,
+                                           int n_num_mem_bufs = 1);
+    virtual int mem_buf_tx_release(mem_buf_desc_t *p_mem_buf_desc_list, bool b_accounting,
+                                   bool trylock = false);
+    virtual bool get_hw_dummy_send_support(ring_user_id_t id, xlio_ibv_send_wr *p_send_wqe)
+    {
+        NOT_IN_USE(id);
+        NOT_IN_USE(p_send_wqe);
+        return false;
+    }
+    virtual int request_notification(cq_type_t cq_type, uint64_t poll_sn);
+    virtual void adapt_cq_moderation() {}
+
+    virtual int modify_ratelimit(struct xlio_rate_limit_t &rate_limit)
+    {
+        NOT_IN_USE(rate_limit);
+        return 0;
+    }
+    void inc_cq_moderation_stats(size_t sz_data) { NOT_IN_USE(sz_data); }
+    virtual uint32_t get_tx_user_lkey(void *addr, size_t length, void *p_mapping = NULL)
+    {
+        /* Memory is accessed by CPU copy, no registration is needed */
+        NOT_IN_USE(p_mapping);
+        NOT_IN_USE(addr);
+        NOT_IN_USE(length);
+        return 0;
+    }
+    virtual uint32_t get_max_inline_data() { return 0; }
+    ib_ctx_handler *get_ctx(ring_user_id_t id)
+    {
+        NOT_IN_USE(id);
+        return NULL;
+    }
+    virtual uint32_t get_max_send_sge(void) { return RING_XDP_MAX_SEND_SGE; }
+    virtual uint32_t get_max_payload_sz(void) { return 0; }
+    virtual uint16_t get_max_header_sz(void) { return 0; }
+    virtual uint32_t get_tx_lkey(ring_user_id_t id)
+    {
+        NOT_IN_USE(id);
+        return 0;
+    }
+    virtual bool is_tso(void) { return false; }
+
+private:
+    /* Userspace view of a ring shared with the kernel */
+    struct xsk_ring {
+        uint32_t *producer;
+        uint32_t *consumer;
+        uint32_t *flags;
+        void *descs;
+        void *map;
+        size_t map_len;
+        uint32_t mask;
+    };
+
+    void xsk_create();
+    void xsk_destroy();
+    bool xsk_ring_map(xsk_ring &r, uint32_t size, const struct xdp_ring_offset &off,
+                      size_t desc_size, off_t pgoff);
+    void xsk_ring_unmap(xsk_ring &r);
+    inline uint64_t buffer_to_addr(mem_buf_desc_t *buff);
+    inline mem_buf_desc_t *addr_to_buffer(uint64_t addr);
+
+    bool reclaim_recv_buffers_no_lock(mem_buf_desc_t *buff);
+    inline void return_to_global_pool();
+    inline void put_tx_buffer_helper(mem_buf_desc_t *buff);
+    int process_element_rx(void *pv_fd_ready_array);
+    bool request_more_rx_buffers();
+    void fill_rx_buffers();
+    mem_buf_desc_t *get_tx_frame();
+    void process_tx_completions();
+    void tx_kick();
+    int send_buffer(xlio_ibv_send_wr *p_send_wqe);
+    void send_status_handler(int ret, xlio_ibv_send_wr *p_send_wqe);
+
+    int m_xsk_fd;
+    uint32_t m_queue_id;
+    xdp_prog *m_p_xdp_prog;
+    /* Flows added to the XDP program by this ring, protected by m_lock_ring_rx */
+    std::map<flow_tuple, int> m_flows;
+    const uint32_t m_sysvar_qp_compensation_level;
+    const uint32_t m_n_sysvar_cq_poll_batch_max;
+
+    /* UMEM is the RX buffer pool data, buffers are found by offset */
+    uint8_t *m_umem;
+    size_t m_umem_size;
+    size_t m_umem_stride;
+    std::vector<mem_buf_desc_t *> m_umem_bufs;
+
+    /* Fill and RX rings and RX buffers are protected by m_lock_ring_rx */
+    xsk_ring m_fill;
+    xsk_ring m_rx;
+    descq_t m_rx_pool;
+    /* Buffer which can't be posted to the fill ring due to missing headroom */
+    mem_buf_desc_t *m_p_rx_spare;
+
+    /* TX and completion rings and TX frames are protected by m_lock_ring_tx */
+    xsk_ring m_tx;
+    xsk_ring m_comp;
+    descq_t m_tx_frames;
+};
+
+#endif /* DEFINED_XDP */
+
+#endif /* RING_XDP_H_ */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <mutex>
+
+#include "srq_mgr.h"
+#include "vlogger/vlogger.h"
+#include "util/utils.h"
+#include "util/valgrind.h"
+#include "proto/mem_buf_desc.h"
+#include "dev/buffer_pool.h"
+#include "dev/ib_ctx_handler.h"
+
+#if defined(DEFINED_DIRECT_VERBS)
+
+#undef MODULE_NAME
+#define MODULE_NAME "srq_mgr"
+#undef MODULE_HDR
+#define MODULE_HDR MODULE_NAME "%d:%s() "
+
+#define srq_logerr  __log_info_err
+#define srq_logdbg  __log_info_dbg
+#define srq_logfunc __log_info_func
+
+srq_mgr::srq_mgr(ib_ctx_handler *p_ib_ctx, uint32_t num_wr)
+    : m_lock("srq_mgr")
+{
+    struct ibv_srq_init_attr srq_attr;
+    struct ibv_srq *srq;
+
+    memset(&m_mlx5_srq, 0, sizeof(m_mlx5_srq));
+    memset(&srq_attr, 0, sizeof(srq_attr));
+    srq_attr.attr.max_wr = std::min<uint32_t>(num_wr, p_ib_ctx->get_ibv_device_attr()->max_srq_wr);
+    srq_attr.attr.max_sge = 1;
+
+    srq = ibv_create_srq(p_ib_ctx->get_ibv_pd(), &srq_attr);
+    if (!srq) {
+        throw_xlio_exception("ibv_create_srq failed");
+    }
+    VALGRIND_MAKE_MEM_DEFINED(srq, sizeof(ibv_srq));
+
+    if (0 != xlio_ib_mlx5_get_srq(srq, &m_mlx5_srq)) {
+        ibv_destroy_srq(srq);
+        throw_xlio_exception("xlio_ib_mlx5_get_srq failed");
+    }
+
+    // One WQE of the linked list is always kept free
+    m_links.buf = (uint8_t *)m_mlx5_srq.buf;
+    m_links.wqe_shift = m_mlx5_srq.wqe_shift;
+    m_wqes.init(m_links, m_mlx5_srq.wqe_cnt,
+                std::min<uint32_t>(srq_attr.attr.max_wr, m_mlx5_srq.wqe_cnt - 1), m_mlx5_srq.head,
+                m_mlx5_srq.tail);
+
+    srq_logdbg("Created SRQ %p on %s: size=%u wqe_cnt=%u stride=%u", srq, p_ib_ctx->get_ibname(),
+               m_wqes.get_size(), m_mlx5_srq.wqe_cnt, m_mlx5_srq.stride);
+}
+
+srq_mgr::~srq_mgr()
+{
+    srq_logdbg("Destroying SRQ %p with %u posted buffers", m_mlx5_srq.srq, m_wqes.get_posted());
+
+    IF_VERBS_FAILURE_EX(ibv_destroy_srq(m_mlx5_srq.srq), EIO)
+    {
+        srq_logdbg("SRQ destroy failure (errno = %d %m)", -errno);
+    }
+    ENDIF_VERBS_FAILURE;
+
+    m_wqes.drain([](mem_buf_desc_t *buf) {
+        if (g_buffer_pool_rx_rwqe) {
+            g_buffer_pool_rx_rwqe->put_buffers_thread_safe(buf);
+        }
+    });
+}
+
+uint32_t srq_mgr::get_deficit()
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    return m_wqes.get_deficit();
+}
+
+uint32_t srq_mgr::post_recv(const uint16_t *done, uint32_t n_done, const struct ibv_recv_wr *wr,
+                            uint32_t n_wr)
+{
+    xlio_ib_mlx5_srq_t &srq = m_mlx5_srq;
+
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+
+    m_wqes.release(done, n_done);
+
+    uint32_t posted = m_wqes.post(n_wr, [this, wr](uint32_t i, uint16_t index) {
+        struct mlx5_wqe_data_seg *scat = (struct mlx5_wqe_data_seg *)(m_links.get_wqe(index) + 1);
+
+        scat->byte_count = htonl(wr[i].sg_list[0].length);
+        scat->lkey = htonl(wr[i].sg_list[0].lkey);
+        scat->addr = htonll(wr[i].sg_list[0].addr);
+        return (mem_buf_desc_t *)(uintptr_t)wr[i].wr_id;
+    });
+
+    if (likely(posted)) {
+        srq.counter += posted;
+
+        // Make sure that descriptors are written before doorbell record
+        wmb();
+        *srq.dbrec = htonl(srq.counter);
+    }
+
+    return posted;
+}
+
+#endif /* DEFINED_DIRECT_VERBS */
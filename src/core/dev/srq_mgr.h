@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRQ_MGR_H
+#define SRQ_MGR_H
+
+#include "ib/base/verbs_extra.h"
+#include "utils/lock_wrapper.h"
+#include "dev/srq_wqe_list.h"
+
+class mem_buf_desc_t;
+class ib_ctx_handler;
+
+#if defined(DEFINED_DIRECT_VERBS)
+
+/*
+ * Shared receive queue of a device.
+ * Rings of the same ib_ctx_handler post their receive buffers here instead of
+ * a private RQ and keep their own CQs and steering rules. The ring which
+ * consumes a WQE reposts a buffer for it, so the queue stays full regardless
+ * of the ring the traffic lands on.
+ */
+class srq_mgr {
+public:
+    srq_mgr(ib_ctx_handler *p_ib_ctx, uint32_t num_wr);
+    ~srq_mgr();
+
+    struct ibv_srq *get_ibv_srq() { return m_mlx5_srq.srq; }
+    uint32_t get_size() const { return m_wqes.get_size(); }
+    uint32_t get_posted() const { return m_wqes.get_posted(); }
+    uint32_t get_deficit();
+
+    /* Takes the buffer of a completed WQE. The WQE is not reused until it
+     * is released by post_recv().
+     */
+    inline mem_buf_desc_t *take_buf(uint16_t index) { return m_wqes.take(index); }
+
+    /* Releases completed WQEs and posts new buffers under a single lock.
+     * Returns the number of posted work requests, the rest didn't fit.
+     */
+    uint32_t post_recv(const uint16_t *done, uint32_t n_done, const struct ibv_recv_wr *wr,
+                       uint32_t n_wr);
+
+private:
+    // Free WQEs are linked by the next segment of the WQE
+    struct wqe_links {
+        uint8_t *buf;
+        uint32_t wqe_shift;
+
+        inline struct mlx5_wqe_srq_next_seg *get_wqe(uint16_t index) const
+        {
+            return (struct mlx5_wqe_srq_next_seg *)(buf + ((uint32_t)index << wqe_shift));
+        }
+        inline uint16_t next(uint16_t index) const { return ntohs(get_wqe(index)->next_wqe_index); }
+        inline void link(uint16_t index, uint16_t next)
+        {
+            get_wqe(index)->next_wqe_index = htons(next);
+        }
+    };
+
+    xlio_ib_mlx5_srq_t m_mlx5_srq;
+    wqe_links m_links;
+    srq_wqe_list<mem_buf_desc_t, wqe_links> m_wqes;
+    lock_spin m_lock;
+};
+
+#endif /* DEFINED_DIRECT_VERBS */
+#endif /* SRQ_MGR_H */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SRQ_WQE_LIST_H
+#define SRQ_WQE_LIST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Software state of a shared receive queue.
+ * Free WQEs form a linked list from head to tail through their next WQE
+ * index. The index lives in the WQE itself, so it is accessed through WQES:
+ *     uint16_t next(uint16_t index) const;
+ *     void link(uint16_t index, uint16_t next);
+ * One WQE of the list is always kept free. The list tracks the buffer of
+ * every posted WQE and the number of posted WQEs, the caller serializes
+ * the access.
+ */
+template <typename BUF, typename WQES> class srq_wqe_list {
+public:
+    srq_wqe_list()
+        : m_bufs(nullptr)
+        , m_wqe_cnt(0)
+        , m_size(0)
+        , m_posted(0)
+        , m_head(0)
+        , m_tail(0)
+    {
+    }
+    ~srq_wqe_list() { delete[] m_bufs; }
+
+    // @wqe_cnt is a power of 2, at most @size WQEs are posted at once
+    void init(const WQES &wqes, uint32_t wqe_cnt, uint32_t size, uint16_t head, uint16_t tail)
+    {
+        m_wqes = wqes;
+        m_wqe_cnt = wqe_cnt;
+        m_size = size;
+        m_head = head;
+        m_tail = tail;
+        m_bufs = new BUF *[wqe_cnt]();
+    }
+
+    uint32_t get_size() const { return m_size; }
+    uint32_t get_posted() const { return m_posted; }
+    uint32_t get_deficit() const { return m_size - (m_posted < m_size ? m_posted : m_size); }
+
+    /* Takes the buffer of a completed WQE. The WQE is not reused until it
+     * is released.
+     */
+    inline BUF *take(uint16_t index)
+    {
+        index &= (m_wqe_cnt - 1);
+        BUF *buf = m_bufs[index];
+        m_bufs[index] = nullptr;
+        return buf;
+    }
+
+    // Completed WQEs are linked after the last free one
+    void release(const uint16_t *done, uint32_t n_done)
+    {
+        for (uint32_t i = 0; i < n_done; ++i) {
+            m_wqes.link(m_tail, done[i]);
+            m_tail = done[i];
+        }
+        m_posted -= (n_done < m_posted ? n_done : m_posted);
+    }
+
+    /* Posts up to @n_wr buffers, fill(i, index) writes the i-th work request
+     * to the WQE and returns its buffer. Returns the number of posted work
+     * requests, the rest didn't fit.
+     */
+    template <typename F> uint32_t post(uint32_t n_wr, F fill)
+    {
+        uint32_t i;
+
+        for (i = 0; i < n_wr && m_posted + i < m_size && m_head != m_tail; ++i) {
+            m_bufs[m_head] = fill(i, m_head);
+            m_head = m_wqes.next(m_head);
+        }
+        m_posted += i;
+        return i;
+    }
+
+    // Hands the buffers of the posted WQEs to put(), returns their number
+    template <typename F> uint32_t drain(F put)
+    {
+        uint32_t n = 0;
+
+        for (uint32_t i = 0; i < m_wqe_cnt; ++i) {
+            if (m_bufs[i]) {
+                put(m_bufs[i]);
+                m_bufs[i] = nullptr;
+                ++n;
+            }
+        }
+        return n;
+    }
+
+private:
+    WQES m_wqes;
+    BUF **m_bufs;
+    uint32_t m_wqe_cnt;
+    uint32_t m_size;
+    uint32_t m_posted;
+    uint16_t m_head;
+    uint16_t m_tail;
+};
+
+#endif /* SRQ_WQE_LIST_H */
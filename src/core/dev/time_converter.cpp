@@ -114,6 +114,9 @@ ts_conversion_mode_t time_converter::update_device_converters_status(net_device_
                 slave_data_vector_t slaves = dev_iter->second->get_slave_array();
                 for (slave_data_vector_t::iterator slaves_iter = slaves.begin();
                      slaves_iter != slaves.end(); slaves_iter++) {
+                    if (!(*slaves_iter)->p_ib_ctx) {
+                        continue;
+                    }
                     devs_status &=
                         get_single_converter_status((*slaves_iter)->p_ib_ctx->get_ibv_context());
                 }
@@ -162,6 +165,9 @@ ts_conversion_mode_t time_converter::update_device_converters_status(net_device_
         slave_data_vector_t slaves = dev_iter->second->get_slave_array();
         for (slave_data_vector_t::iterator slaves_iter = slaves.begin();
              slaves_iter != slaves.end(); slaves_iter++) {
+            if (!(*slaves_iter)->p_ib_ctx) {
+                continue;
+            }
             ts_conversion_mode_t dev_ts_conversion_mode =
                 dev_iter->second->get_state() == net_device_val::RUNNING
                 ? ts_conversion_mode
@@ -0,0 +1,515 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "xdp_prog.h"
+
+#if defined(DEFINED_XDP)
+
+#include <mutex>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <net/ethernet.h>
+#include <netinet/ip.h>
+#include <netinet/ip6.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+#include "vlogger/vlogger.h"
+#include "sock/sock-redirect.h"
+
+#undef MODULE_NAME
+#define MODULE_NAME "xdp_prog"
+#undef MODULE_HDR
+#define MODULE_HDR MODULE_NAME "%d:%s() "
+
+#define xdp_logerr  __log_info_err
+#define xdp_logwarn __log_info_warn
+#define xdp_logdbg  __log_info_dbg
+
+/* Key of the flows map, must match the layout the program builds on stack */
+struct xdp_flow_key {
+    uint8_t dst_ip[16];
+    uint8_t src_ip[16];
+    in_port_t dst_port;
+    in_port_t src_port;
+    uint8_t protocol;
+    uint8_t family;
+    uint8_t pad[2];
+} __attribute__((packed));
+
+#define XDP_FLOW_KEY_STACK_OFF (-(int)sizeof(xdp_flow_key))
+#define XDP_FLOW_KEY_OFF(field) (XDP_FLOW_KEY_STACK_OFF + (int)offsetof(xdp_flow_key, field))
+
+lock_mutex xdp_prog::s_lock("xdp_prog:s_lock");
+std::unordered_map<int, xdp_prog *> xdp_prog::s_progs;
+
+static inline int sys_bpf(int cmd, union bpf_attr *attr)
+{
+    return syscall(__NR_bpf, cmd, attr, sizeof(*attr));
+}
+
+static void flow_to_key(const flow_tuple &flow, xdp_flow_key &key)
+{
+    memset(&key, 0, sizeof(key));
+    if (flow.get_family() == AF_INET) {
+        memcpy(key.dst_ip, &flow.get_dst_ip().get_in4_addr(), sizeof(in_addr));
+        memcpy(key.src_ip, &flow.get_src_ip().get_in4_addr(), sizeof(in_addr));
+    } else {
+        memcpy(key.dst_ip, &flow.get_dst_ip().get_in6_addr(), sizeof(in6_addr));
+        memcpy(key.src_ip, &flow.get_src_ip().get_in6_addr(), sizeof(in6_addr));
+    }
+    key.dst_port = flow.get_dst_port();
+    key.src_port = flow.get_src_port();
+    key.protocol = flow.is_tcp() ? IPPROTO_TCP : IPPROTO_UDP;
+    key.family = (uint8_t)flow.get_family();
+}
+
+/**
+ * Minimal eBPF assembler with forward labels, enough to build the steering
+ * program without libbpf and clang.
+ */
+class bpf_asm {
+public:
+    bpf_asm(int labels)
+        : m_labels(labels, -1)
+    {
+    }
+
+    void emit(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm)
+    {
+        struct bpf_insn insn;
+
+        memset(&insn, 0, sizeof(insn));
+        insn.code = code;
+        insn.dst_reg = dst;
+        insn.src_reg = src;
+        insn.off = off;
+        insn.imm = imm;
+        m_insns.push_back(insn);
+    }
+
+    void mov_reg(uint8_t dst, uint8_t src) { emit(BPF_ALU64 | BPF_MOV | BPF_X, dst, src, 0, 0); }
+    void mov_imm(uint8_t dst, int32_t imm) { emit(BPF_ALU64 | BPF_MOV | BPF_K, dst, 0, 0, imm); }
+    void alu_imm(uint8_t op, uint8_t dst, int32_t imm) { emit(BPF_ALU64 | op | BPF_K, dst, 0, 0, imm); }
+    void add_reg(uint8_t dst, uint8_t src) { emit(BPF_ALU64 | BPF_ADD | BPF_X, dst, src, 0, 0); }
+    void ldx(uint8_t size, uint8_t dst, uint8_t src, int16_t off)
+    {
+        emit(BPF_LDX | BPF_MEM | size, dst, src, off, 0);
+    }
+    void stx(uint8_t size, uint8_t dst, uint8_t src, int16_t off)
+    {
+        emit(BPF_STX | BPF_MEM | size, dst, src, off, 0);
+    }
+    void st(uint8_t size, uint8_t dst, int16_t off, int32_t imm)
+    {
+        emit(BPF_ST | BPF_MEM | size, dst, 0, off, imm);
+    }
+    void ld_map_fd(uint8_t dst, int fd)
+    {
+        emit(BPF_LD | BPF_DW | BPF_IMM, dst, BPF_PSEUDO_MAP_FD, 0, fd);
+        emit(0, 0, 0, 0, 0);
+    }
+    void call(int32_t func) { emit(BPF_JMP | BPF_CALL, 0, 0, 0, func); }
+    void exit() { emit(BPF_JMP | BPF_EXIT, 0, 0, 0, 0); }
+    void jmp_imm(uint8_t op, uint8_t dst, int32_t imm, int label)
+    {
+        m_fixups.push_back(std::make_pair(m_insns.size(), label));
+        emit(BPF_JMP | op | BPF_K, dst, 0, 0, imm);
+    }
+    void jmp_reg(uint8_t op, uint8_t dst, uint8_t src, int label)
+    {
+        m_fixups.push_back(std::make_pair(m_insns.size(), label));
+        emit(BPF_JMP | op | BPF_X, dst, src, 0, 0);
+    }
+    void ja(int label) { jmp_imm(BPF_JA, 0, 0, label); }
+    void label(int label) { m_labels[label] = (int)m_insns.size(); }
+
+    /* Make sure [ptr, ptr + len) is within the packet, otherwise jump to the label */
+    void check_pkt(uint8_t ptr, uint8_t tmp, uint8_t end, int32_t len, int label)
+    {
+        mov_reg(tmp, ptr);
+        alu_imm(BPF_ADD, tmp, len);
+        jmp_reg(BPF_JGT, tmp, end, label);
+    }
+
+    std::vector<struct bpf_insn> &link()
+    {
+        for (auto &fixup : m_fixups) {
+            m_insns[fixup.first].off = (int16_t)(m_labels[fixup.second] - (int)fixup.first - 1);
+        }
+        return m_insns;
+    }
+
+private:
+    std::vector<struct bpf_insn> m_insns;
+    std::vector<int> m_labels;
+    std::vector<std::pair<size_t, int>> m_fixups;
+};
+
+xdp_prog *xdp_prog::get(int if_index)
+{
+    std::lock_guard<decltype(s_lock)> lock(s_lock);
+    xdp_prog *prog;
+
+    auto itr = s_progs.find(if_index);
+    if (itr != s_progs.end()) {
+        prog = itr->second;
+    } else {
+        prog = new xdp_prog(if_index);
+        if (!prog->load() || !prog->attach()) {
+            delete prog;
+            return NULL;
+        }
+        s_progs[if_index] = prog;
+    }
+    prog->m_ref++;
+
+    return prog;
+}
+
+void xdp_prog::put(xdp_prog *prog)
+{
+    std::lock_guard<decltype(s_lock)> lock(s_lock);
+
+    if (--prog->m_ref == 0) {
+        s_progs.erase(prog->m_if_index);
+        delete prog;
+    }
+}
+
+xdp_prog::xdp_prog(int if_index)
+    : m_if_index(if_index)
+    , m_ref(0)
+    , m_xsks_map_fd(-1)
+    , m_flows_map_fd(-1)
+    , m_prog_fd(-1)
+    , m_link_fd(-1)
+    , m_lock("xdp_prog:m_lock")
+{
+}
+
+xdp_prog::~xdp_prog()
+{
+    /* Closing the link detaches the program from the interface */
+    int fds[] = {m_link_fd, m_prog_fd, m_flows_map_fd, m_xsks_map_fd};
+
+    for (size_t i = 0; i < sizeof(fds) / sizeof(fds[0]); i++) {
+        if (fds[i] >= 0) {
+            orig_os_api.close(fds[i]);
+        }
+    }
+}
+
+bool xdp_prog::load()
+{
+    enum { L_PASS, L_VLAN_DONE, L_IPV4, L_IPV6, L_L4, L_PORTS, L_REDIRECT, L_MAX };
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(int);
+    attr.max_entries = XDP_PROG_MAX_QUEUES;
+    m_xsks_map_fd = sys_bpf(BPF_MAP_CREATE, &attr);
+    if (m_xsks_map_fd < 0) {
+        xdp_logerr("XSKMAP creation failed (errno=%d %m)", errno);
+        return false;
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_HASH;
+    attr.key_size = sizeof(xdp_flow_key);
+    attr.value_size = sizeof(uint32_t);
+    attr.max_entries = XDP_PROG_MAX_FLOWS;
+    attr.map_flags = BPF_F_NO_PREALLOC;
+    m_flows_map_fd = sys_bpf(BPF_MAP_CREATE, &attr);
+    if (m_flows_map_fd < 0) {
+        xdp_logerr("Flows map creation failed (errno=%d %m)", errno);
+        return false;
+    }
+
+    /*
+     * r6 - xdp_md, r2 - current header, r3 - packet end, r8 - L4 protocol,
+     * flow key is built on stack at XDP_FLOW_KEY_STACK_OFF.
+     */
+    bpf_asm a(L_MAX);
+
+    a.mov_reg(BPF_REG_6, BPF_REG_1);
+    a.ldx(BPF_W, BPF_REG_2, BPF_REG_6, offsetof(struct xdp_md, data));
+    a.ldx(BPF_W, BPF_REG_3, BPF_REG_6, offsetof(struct xdp_md, data_end));
+    a.mov_imm(BPF_REG_4, 0);
+    for (int off = 0; off < (int)sizeof(xdp_flow_key); off += 8) {
+        a.stx(BPF_DW, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_STACK_OFF + off);
+    }
+
+    /* Ethernet and optional VLAN header */
+    a.check_pkt(BPF_REG_2, BPF_REG_4, BPF_REG_3, ETH_HLEN, L_PASS);
+    a.ldx(BPF_H, BPF_REG_5, BPF_REG_2, offsetof(struct ethhdr, h_proto));
+    a.mov_imm(BPF_REG_7, ETH_HLEN);
+    a.jmp_imm(BPF_JNE, BPF_REG_5, htons(ETH_P_8021Q), L_VLAN_DONE);
+    a.check_pkt(BPF_REG_2, BPF_REG_4, BPF_REG_3, ETH_HLEN + 4, L_PASS);
+    a.ldx(BPF_H, BPF_REG_5, BPF_REG_2, ETH_HLEN + 2);
+    a.mov_imm(BPF_REG_7, ETH_HLEN + 4);
+    a.label(L_VLAN_DONE);
+    a.add_reg(BPF_REG_2, BPF_REG_7);
+    a.jmp_imm(BPF_JEQ, BPF_REG_5, htons(ETH_P_IP), L_IPV4);
+    a.jmp_imm(BPF_JEQ, BPF_REG_5, htons(ETH_P_IPV6), L_IPV6);
+    a.ja(L_PASS);
+
+    /* IPv4, fragments are passed to the kernel */
+    a.label(L_IPV4);
+    a.check_pkt(BPF_REG_2, BPF_REG_4, BPF_REG_3, sizeof(struct iphdr), L_PASS);
+    a.ldx(BPF_H, BPF_REG_4, BPF_REG_2, offsetof(struct iphdr, frag_off));
+    a.alu_imm(BPF_AND, BPF_REG_4, htons(IP_MF | IP_OFFMASK));
+    a.jmp_imm(BPF_JNE, BPF_REG_4, 0, L_PASS);
+    a.ldx(BPF_B, BPF_REG_8, BPF_REG_2, offsetof(struct iphdr, protocol));
+    a.ldx(BPF_W, BPF_REG_4, BPF_REG_2, offsetof(struct iphdr, daddr));
+    a.stx(BPF_W, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(dst_ip));
+    a.ldx(BPF_W, BPF_REG_4, BPF_REG_2, offsetof(struct iphdr, saddr));
+    a.stx(BPF_W, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(src_ip));
+    a.st(BPF_B, BPF_REG_10, XDP_FLOW_KEY_OFF(family), AF_INET);
+    a.ldx(BPF_B, BPF_REG_5, BPF_REG_2, 0);
+    a.alu_imm(BPF_AND, BPF_REG_5, 0xf);
+    a.alu_imm(BPF_LSH, BPF_REG_5, 2);
+    a.jmp_imm(BPF_JLT, BPF_REG_5, sizeof(struct iphdr), L_PASS);
+    a.add_reg(BPF_REG_2, BPF_REG_5);
+    a.ja(L_L4);
+
+    /* IPv6, extension headers are passed to the kernel */
+    a.label(L_IPV6);
+    a.check_pkt(BPF_REG_2, BPF_REG_4, BPF_REG_3, sizeof(struct ip6_hdr), L_PASS);
+    a.ldx(BPF_B, BPF_REG_8, BPF_REG_2, offsetof(struct ip6_hdr, ip6_nxt));
+    for (int off = 0; off < (int)sizeof(in6_addr); off += 4) {
+        a.ldx(BPF_W, BPF_REG_4, BPF_REG_2, offsetof(struct ip6_hdr, ip6_dst) + off);
+        a.stx(BPF_W, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(dst_ip) + off);
+        a.ldx(BPF_W, BPF_REG_4, BPF_REG_2, offsetof(struct ip6_hdr, ip6_src) + off);
+        a.stx(BPF_W, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(src_ip) + off);
+    }
+    a.st(BPF_B, BPF_REG_10, XDP_FLOW_KEY_OFF(family), AF_INET6);
+    a.alu_imm(BPF_ADD, BPF_REG_2, sizeof(struct ip6_hdr));
+
+    /* TCP and UDP ports are at the same offsets */
+    a.label(L_L4);
+    a.jmp_imm(BPF_JEQ, BPF_REG_8, IPPROTO_TCP, L_PORTS);
+    a.jmp_imm(BPF_JNE, BPF_REG_8, IPPROTO_UDP, L_PASS);
+    a.label(L_PORTS);
+    a.check_pkt(BPF_REG_2, BPF_REG_4, BPF_REG_3, 2 * sizeof(in_port_t), L_PASS);
+    a.stx(BPF_B, BPF_REG_10, BPF_REG_8, XDP_FLOW_KEY_OFF(protocol));
+    a.ldx(BPF_H, BPF_REG_4, BPF_REG_2, 0);
+    a.stx(BPF_H, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(src_port));
+    a.ldx(BPF_H, BPF_REG_4, BPF_REG_2, sizeof(in_port_t));
+    a.stx(BPF_H, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(dst_port));
+
+    /* 5-tuple */
+    a.ld_map_fd(BPF_REG_1, m_flows_map_fd);
+    a.mov_reg(BPF_REG_2, BPF_REG_10);
+    a.alu_imm(BPF_ADD, BPF_REG_2, XDP_FLOW_KEY_STACK_OFF);
+    a.call(BPF_FUNC_map_lookup_elem);
+    a.jmp_imm(BPF_JNE, BPF_REG_0, 0, L_REDIRECT);
+
+    /* 3-tuple */
+    a.mov_imm(BPF_REG_4, 0);
+    a.stx(BPF_DW, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(src_ip));
+    a.stx(BPF_DW, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(src_ip) + 8);
+    a.stx(BPF_H, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(src_port));
+    a.ld_map_fd(BPF_REG_1, m_flows_map_fd);
+    a.mov_reg(BPF_REG_2, BPF_REG_10);
+    a.alu_imm(BPF_ADD, BPF_REG_2, XDP_FLOW_KEY_STACK_OFF);
+    a.call(BPF_FUNC_map_lookup_elem);
+    a.jmp_imm(BPF_JNE, BPF_REG_0, 0, L_REDIRECT);
+
+    /* 3-tuple with any destination address */
+    a.mov_imm(BPF_REG_4, 0);
+    a.stx(BPF_DW, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(dst_ip));
+    a.stx(BPF_DW, BPF_REG_10, BPF_REG_4, XDP_FLOW_KEY_OFF(dst_ip) + 8);
+    a.ld_map_fd(BPF_REG_1, m_flows_map_fd);
+    a.mov_reg(BPF_REG_2, BPF_REG_10);
+    a.alu_imm(BPF_ADD, BPF_REG_2, XDP_FLOW_KEY_STACK_OFF);
+    a.call(BPF_FUNC_map_lookup_elem);
+    a.jmp_imm(BPF_JEQ, BPF_REG_0, 0, L_PASS);
+
+    /* Packets of queues without a socket fall back to the kernel */
+    a.label(L_REDIRECT);
+    a.ld_map_fd(BPF_REG_1, m_xsks_map_fd);
+    a.ldx(BPF_W, BPF_REG_2, BPF_REG_6, offsetof(struct xdp_md, rx_queue_index));
+    a.mov_imm(BPF_REG_3, XDP_PASS);
+    a.call(BPF_FUNC_redirect_map);
+    a.exit();
+
+    a.label(L_PASS);
+    a.mov_imm(BPF_REG_0, XDP_PASS);
+    a.exit();
+
+    std::vector<struct bpf_insn> &insns = a.link();
+    static char license[] = "Dual BSD/GPL";
+    static char log_buf[4096];
+
+    memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = (uint64_t)(uintptr_t)insns.data();
+    attr.insn_cnt = (uint32_t)insns.size();
+    attr.license = (uint64_t)(uintptr_t)license;
+    m_prog_fd = sys_bpf(BPF_PROG_LOAD, &attr);
+    if (m_prog_fd < 0) {
+        int err = errno;
+
+        /* Load it again to get the verifier output */
+        log_buf[0] = '\0';
+        attr.log_buf = (uint64_t)(uintptr_t)log_buf;
+        attr.log_size = sizeof(log_buf);
+        attr.log_level = 1;
+        m_prog_fd = sys_bpf(BPF_PROG_LOAD, &attr);
+        xdp_logerr("XDP program load failed (errno=%d)", err);
+        xdp_logdbg("Verifier log: %s", log_buf);
+        return false;
+    }
+
+    return true;
+}
+
+bool xdp_prog::attach()
+{
+    union bpf_attr attr;
+
+    /* Prefer driver mode and fall back to generic XDP */
+    uint32_t modes[] = {XDP_FLAGS_DRV_MODE, XDP_FLAGS_SKB_MODE};
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]) && m_link_fd < 0; i++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.link_create.prog_fd = m_prog_fd;
+        attr.link_create.target_ifindex = m_if_index;
+        attr.link_create.attach_type = BPF_XDP;
+        attr.link_create.flags = modes[i];
+        m_link_fd = sys_bpf(BPF_LINK_CREATE, &attr);
+        xdp_logdbg("if_index=%d attach mode=%u link_fd=%d (errno=%d)", m_if_index, modes[i],
+                   m_link_fd, m_link_fd < 0 ? errno : 0);
+    }
+    if (m_link_fd < 0) {
+        xdp_logerr("XDP program attach to if_index=%d failed (errno=%d %m)", m_if_index, errno);
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t xdp_prog::reserve_queue()
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    uint32_t queue_id = 0;
+
+    while (queue_id < m_queues.size() && m_queues[queue_id]) {
+        queue_id++;
+    }
+    if (queue_id == m_queues.size()) {
+        m_queues.push_back(true);
+    } else {
+        m_queues[queue_id] = true;
+    }
+
+    return queue_id;
+}
+
+bool xdp_prog::add_socket(uint32_t queue_id, int xsk_fd)
+{
+    union bpf_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = m_xsks_map_fd;
+    attr.key = (uint64_t)(uintptr_t)&queue_id;
+    attr.value = (uint64_t)(uintptr_t)&xsk_fd;
+    if (sys_bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+        xdp_logerr("XSKMAP update queue=%u failed (errno=%d %m)", queue_id, errno);
+        return false;
+    }
+
+    return true;
+}
+
+void xdp_prog::del_socket(uint32_t queue_id)
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+    union bpf_attr attr;
+
+    if (queue_id < m_queues.size()) {
+        m_queues[queue_id] = false;
+    }
+    memset(&attr, 0, sizeof(attr));
+    attr.map_fd = m_xsks_map_fd;
+    attr.key = (uint64_t)(uintptr_t)&queue_id;
+    if (sys_bpf(BPF_MAP_DELETE_ELEM, &attr) < 0) {
+        xdp_logdbg("XSKMAP delete queue=%u failed (errno=%d)", queue_id, errno);
+    }
+}
+
+bool xdp_prog::add_flow(const flow_tuple &flow)
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+
+    if (m_flows[flow]++ == 0) {
+        union bpf_attr attr;
+        xdp_flow_key key;
+        uint32_t value = 1;
+
+        flow_to_key(flow, key);
+        memset(&attr, 0, sizeof(attr));
+        attr.map_fd = m_flows_map_fd;
+        attr.key = (uint64_t)(uintptr_t)&key;
+        attr.value = (uint64_t)(uintptr_t)&value;
+        if (sys_bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+            xdp_logwarn("Flow %s steering failed (errno=%d %m)", flow.to_str().c_str(), errno);
+            m_flows.erase(flow);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void xdp_prog::del_flow(const flow_tuple &flow)
+{
+    std::lock_guard<decltype(m_lock)> lock(m_lock);
+
+    auto itr = m_flows.find(flow);
+    if (itr != m_flows.end() && --itr->second == 0) {
+        union bpf_attr attr;
+        xdp_flow_key key;
+
+        m_flows.erase(itr);
+        flow_to_key(flow, key);
+        memset(&attr, 0, sizeof(attr));
+        attr.map_fd = m_flows_map_fd;
+        attr.key = (uint64_t)(uintptr_t)&key;
+        if (sys_bpf(BPF_MAP_DELETE_ELEM, &attr) < 0) {
+            xdp_logdbg("Flow %s delete failed (errno=%d)", flow.to_str().c_str(), errno);
+        }
+    }
+}
+
+#endif /* DEFINED_XDP */
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef XDP_PROG_H_
+#define XDP_PROG_H_
+
+#include <config.h>
+
+#if defined(DEFINED_XDP)
+
+#include <unordered_map>
+#include <map>
+#include <vector>
+
+#include "utils/lock_wrapper.h"
+#include "proto/flow_tuple.h"
+
+/* Maximum number of receive queues an XDP program can redirect to */
+#define XDP_PROG_MAX_QUEUES 256
+/* Maximum number of offloaded flows per interface */
+#define XDP_PROG_MAX_FLOWS 65536
+
+/**
+ * XDP program which steers offloaded flows of a network interface to AF_XDP
+ * sockets.
+ *
+ * The program is shared by all AF_XDP rings of the interface. It looks up the
+ * packet in a hash map of flow_tuple keys (5-tuple, then 3-tuple, then 3-tuple
+ * with any destination address, matching the order rfs lookups are done in
+ * ring_slave) and redirects matching packets to the socket bound to the
+ * receive queue. Everything else is passed to the kernel stack.
+ * The program is attached with a BPF link, so it is detached by the kernel
+ * once the process exits.
+ */
+class xdp_prog {
+public:
+    /**
+     * Get the program of the interface, load and attach it on first use.
+     * @return Referenced object or NULL on failure.
+     */
+    static xdp_prog *get(int if_index);
+    static void put(xdp_prog *prog);
+
+    /**
+     * Reserve the lowest receive queue which has no AF_XDP socket.
+     */
+    uint32_t reserve_queue();
+    bool add_socket(uint32_t queue_id, int xsk_fd);
+    /**
+     * Remove the socket of the queue and release the queue.
+     */
+    void del_socket(uint32_t queue_id);
+    bool add_flow(const flow_tuple &flow);
+    void del_flow(const flow_tuple &flow);
+
+private:
+    xdp_prog(int if_index);
+    ~xdp_prog();
+
+    bool load();
+    bool attach();
+
+    int m_if_index;
+    int m_ref;
+    int m_xsks_map_fd;
+    int m_flows_map_fd;
+    int m_prog_fd;
+    int m_link_fd;
+    lock_mutex m_lock;
+    /* Number of rings which attached a flow, protected by m_lock */
+    std::map<flow_tuple, int> m_flows;
+    /* Queues with an AF_XDP socket, protected by m_lock */
+    std::vector<bool> m_queues;
+
+    static lock_mutex s_lock;
+    static std::unordered_map<int, xdp_prog *> s_progs;
+};
+
+#endif /* DEFINED_XDP */
+
+#endif /* XDP_PROG_H_ */
@@ -67,6 +67,8 @@ struct timer_node_t {
     void *user_data;
     timers_group *group;
     timer_req_type_t req_type;
+    /* expiration tick, used by timers groups which keep nodes on a timing wheel */
+    unsigned int group_expiry;
     struct timer_node_t *next;
     struct timer_node_t *prev;
 }; // used by the list
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TIMERS_WHEEL_H
+#define TIMERS_WHEEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "event/delta_timer.h"
+
+/* Number of slots per level and number of levels of the timing wheel.
+ * With 10ms resolution the wheel covers ~46 hours, longer timers are clamped. */
+#define TIMERS_WHEEL_BITS   6
+#define TIMERS_WHEEL_SIZE   (1U << TIMERS_WHEEL_BITS)
+#define TIMERS_WHEEL_MASK   (TIMERS_WHEEL_SIZE - 1)
+#define TIMERS_WHEEL_LEVELS 4
+#define TIMERS_WHEEL_RANGE  (1U << (TIMERS_WHEEL_BITS * TIMERS_WHEEL_LEVELS))
+
+/*
+ * Hierarchical timing wheel of timer nodes, the node keeps its expiration tick
+ * in group_expiry. Slots are circular lists with sentinel nodes, so a node is
+ * unlinked without knowing its slot. A node is on the wheel while its next
+ * pointer is set. The wheel is not thread safe, the owner serializes access.
+ */
+class timers_wheel {
+public:
+    timers_wheel()
+        : m_tick(0)
+    {
+        for (int level = 0; level < TIMERS_WHEEL_LEVELS; level++) {
+            for (unsigned int slot = 0; slot < TIMERS_WHEEL_SIZE; slot++) {
+                list_init(&m_wheel[level][slot]);
+            }
+        }
+        list_init(&m_expired);
+    }
+
+    inline uint32_t get_tick() const { return m_tick; }
+
+    static inline bool is_armed(const timer_node_t *node) { return node->next != NULL; }
+
+    // Add the node to expire on node->group_expiry. Past expirations are moved
+    // to the current tick and too far ones are clamped to the wheel range.
+    void insert(timer_node_t *node)
+    {
+        uint32_t delta = node->group_expiry - m_tick;
+        int level = 0;
+
+        if ((int32_t)delta < 0) {
+            node->group_expiry = m_tick;
+            delta = 0;
+        } else if (delta >= TIMERS_WHEEL_RANGE) {
+            delta = TIMERS_WHEEL_RANGE - 1;
+            node->group_expiry = m_tick + delta;
+        }
+        while (delta >= (1U << (TIMERS_WHEEL_BITS * (level + 1)))) {
+            level++;
+        }
+
+        list_add_tail(
+            &m_wheel[level][(node->group_expiry >> (TIMERS_WHEEL_BITS * level)) & TIMERS_WHEEL_MASK],
+            node);
+    }
+
+    static inline void remove(timer_node_t *node) { list_del(node); }
+
+    // Move the timers of the current tick to the expired list and advance the tick.
+    void advance()
+    {
+        unsigned int slot = m_tick & TIMERS_WHEEL_MASK;
+
+        if (slot == 0) {
+            // The first level has wrapped around, refill it from the upper levels
+            cascade(1);
+        }
+        if (!list_empty(&m_wheel[0][slot])) {
+            timer_node_t *head = &m_wheel[0][slot];
+            m_expired.prev->next = head->next;
+            head->next->prev = m_expired.prev;
+            head->prev->next = &m_expired;
+            m_expired.prev = head->prev;
+            list_init(head);
+        }
+        m_tick++;
+    }
+
+    // Unlink and return the next expired timer, NULL when there are no more.
+    timer_node_t *pop_expired()
+    {
+        timer_node_t *node;
+
+        if (list_empty(&m_expired)) {
+            return NULL;
+        }
+        node = m_expired.next;
+        list_del(node);
+        return node;
+    }
+
+    // Return any timer on the wheel, NULL when the wheel is empty.
+    timer_node_t *first() const
+    {
+        if (!list_empty(&m_expired)) {
+            return m_expired.next;
+        }
+        for (int level = 0; level < TIMERS_WHEEL_LEVELS; level++) {
+            for (unsigned int slot = 0; slot < TIMERS_WHEEL_SIZE; slot++) {
+                if (!list_empty(&m_wheel[level][slot])) {
+                    return m_wheel[level][slot].next;
+                }
+            }
+        }
+        return NULL;
+    }
+
+private:
+    timer_node_t m_wheel[TIMERS_WHEEL_LEVELS][TIMERS_WHEEL_SIZE];
+    timer_node_t m_expired;
+    uint32_t m_tick;
+
+    // Move timers of the current slot of the level to the lower levels.
+    void cascade(int level)
+    {
+        unsigned int slot = (m_tick >> (TIMERS_WHEEL_BITS * level)) & TIMERS_WHEEL_MASK;
+        timer_node_t *head = &m_wheel[level][slot];
+
+        while (!list_empty(head)) {
+            timer_node_t *node = head->next;
+            list_del(node);
+            insert(node);
+        }
+        if (slot == 0 && level + 1 < TIMERS_WHEEL_LEVELS) {
+            cascade(level + 1);
+        }
+    }
+
+    static inline void list_init(timer_node_t *head)
+    {
+        head->next = head;
+        head->prev = head;
+    }
+
+    static inline bool list_empty(const timer_node_t *head) { return head->next == head; }
+
+    static inline void list_add_tail(timer_node_t *head, timer_node_t *node)
+    {
+        node->next = head;
+        node->prev = head->prev;
+        head->prev->next = node;
+        head->prev = node;
+    }
+
+    static inline void list_del(timer_node_t *node)
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->next = NULL;
+        node->prev = NULL;
+    }
+};
+
+#endif /* TIMERS_WHEEL_H */
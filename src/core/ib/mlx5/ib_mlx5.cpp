@@ -149,6 +149,88 @@ int xlio_ib_mlx5_get_cq(struct ibv_cq *cq, xlio_ib_mlx5_cq_t *mlx5_cq)
     return 0;
 }
 
+struct ibv_cq *xlio_ib_mlx5_create_cq_comp(struct ibv_context *context, int cqe, void *cq_context,
+                                           struct ibv_comp_channel *channel, int comp_vector)
+{
+    struct mlx5dv_context dv_attr;
+    struct ibv_cq_init_attr_ex cq_attr;
+    struct mlx5dv_cq_init_attr dv_cq_attr;
+    struct ibv_cq_ex *cq_ex;
+
+    memset(&dv_attr, 0, sizeof(dv_attr));
+    dv_attr.comp_mask = MLX5DV_CONTEXT_MASK_CQE_COMPRESION;
+    if (mlx5dv_query_device(context, &dv_attr) ||
+        !(dv_attr.comp_mask & MLX5DV_CONTEXT_MASK_CQE_COMPRESION) ||
+        !dv_attr.cqe_comp_caps.max_num) {
+        return NULL;
+    }
+
+    memset(&dv_cq_attr, 0, sizeof(dv_cq_attr));
+    dv_cq_attr.comp_mask = MLX5DV_CQ_INIT_ATTR_MASK_COMPRESSED_CQE;
+    /* Only byte count is taken from mini CQEs, so any of the basic formats fits */
+    if (dv_attr.cqe_comp_caps.supported_format & MLX5DV_CQE_RES_FORMAT_HASH) {
+        dv_cq_attr.cqe_comp_res_format = MLX5DV_CQE_RES_FORMAT_HASH;
+    } else if (dv_attr.cqe_comp_caps.supported_format & MLX5DV_CQE_RES_FORMAT_CSUM) {
+        dv_cq_attr.cqe_comp_res_format = MLX5DV_CQE_RES_FORMAT_CSUM;
+    } else {
+        return NULL;
+    }
+
+    memset(&cq_attr, 0, sizeof(cq_attr));
+    cq_attr.cqe = cqe;
+    cq_attr.cq_context = cq_context;
+    cq_attr.channel = channel;
+    cq_attr.comp_vector = comp_vector;
+
+    cq_ex = mlx5dv_create_cq(context, &cq_attr, &dv_cq_attr);
+
+    return cq_ex ? ibv_cq_ex_to_cq(cq_ex) : NULL;
+}
+
+int xlio_ib_mlx5_get_srq(struct ibv_srq *srq, xlio_ib_mlx5_srq_t *mlx5_srq)
+{
+    int ret = 0;
+    struct mlx5dv_obj obj;
+    struct mlx5dv_srq dsrq;
+
+    memset(&obj, 0, sizeof(obj));
+    memset(&dsrq, 0, sizeof(dsrq));
+
+    obj.srq.in = srq;
+    obj.srq.out = &dsrq;
+    ret = xlio_ib_mlx5dv_init_obj(&obj, MLX5DV_OBJ_SRQ);
+    if (ret != 0) {
+        return ret;
+    }
+    VALGRIND_MAKE_MEM_DEFINED(&dsrq, sizeof(dsrq));
+
+    memset(mlx5_srq, 0, sizeof(*mlx5_srq));
+    mlx5_srq->srq = srq;
+    mlx5_srq->dbrec = dsrq.dbrec;
+    mlx5_srq->buf = dsrq.buf;
+    mlx5_srq->stride = dsrq.stride;
+    mlx5_srq->wqe_shift = ilog_2(dsrq.stride);
+    /* Provider links the WQEs in order and leaves the last one free */
+    mlx5_srq->wqe_cnt = dsrq.tail + 1;
+    mlx5_srq->head = dsrq.head;
+    mlx5_srq->tail = dsrq.tail;
+    mlx5_srq->counter = 0;
+
+    return 0;
+}
+
+bool xlio_ib_mlx5_is_empw_supported(struct ibv_context *context)
+{
+    struct mlx5dv_context dv_attr;
+
+    memset(&dv_attr, 0, sizeof(dv_attr));
+    if (mlx5dv_query_device(context, &dv_attr)) {
+        return false;
+    }
+
+    return !!(dv_attr.flags & MLX5DV_CONTEXT_FLAGS_ENHANCED_MPW);
+}
+
 int xlio_ib_mlx5_post_recv(xlio_ib_mlx5_qp_t *mlx5_qp, struct ibv_recv_wr *wr,
                            struct ibv_recv_wr **bad_wr)
 {
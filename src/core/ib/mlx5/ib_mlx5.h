@@ -115,6 +115,22 @@ typedef struct xlio_ib_mlx5_cq {
     void *uar;
 } xlio_ib_mlx5_cq_t;
 
+/* Shared receive queue
+ * WQEs are kept in a linked list, head is the next WQE to post and tail is
+ * the last free one. The list is full when head reaches tail.
+ */
+typedef struct xlio_ib_mlx5_srq {
+    struct ibv_srq *srq;
+    volatile uint32_t *dbrec;
+    void *buf;
+    uint32_t wqe_cnt;
+    uint32_t stride;
+    uint32_t wqe_shift;
+    uint16_t head;
+    uint16_t tail;
+    uint16_t counter;
+} xlio_ib_mlx5_srq_t;
+
 /* TLS PRM structures */
 
 struct mlx5_ifc_tls_static_params_bits {
@@ -226,6 +242,38 @@ typedef struct xlio_mlx5_cqe {
     uint8_t op_own;
 } xlio_mlx5_cqe;
 
+/* Get CQE format, compressed CQE session header has MLX5_CQE_FORMAT_COMPRESSED. */
+#define XLIO_MLX5_CQE_FORMAT(op_own)    (((op_own) >> 2) & 0x3)
+#define XLIO_MLX5_CQE_FORMAT_COMPRESSED 0x3
+
+#define XLIO_MLX5_MINI_CQE_ARRAY_SIZE 8
+
+/* Mini CQE of a compressed session (HASH or CSUM response format).
+ * Eight of them are packed into one 64 byte CQE slot.
+ */
+typedef struct xlio_mlx5_mini_cqe8 {
+    union {
+        __be32 rx_hash_result;
+        struct {
+            __be16 checksum;
+            __be16 stride_idx;
+        } s;
+    };
+    __be32 byte_cnt;
+} xlio_mlx5_mini_cqe8;
+
+/* Compressed CQE session state.
+ * The session header CQE carries the fields shared by all packets of the session
+ * and the number of mini CQEs in byte_cnt. Mini CQE arrays start right after the
+ * header, the following arrays are located every 8 CQE slots from the header.
+ */
+typedef struct xlio_mlx5_cqe_zip {
+    xlio_mlx5_cqe title; /* header copy, byte_cnt is patched per packet */
+    uint32_t ci; /* CQ index of the session header */
+    uint32_t cnt; /* number of mini CQEs, 0 - no open session */
+    uint32_t ai; /* index of the next mini CQE */
+} xlio_mlx5_cqe_zip;
+
 /* WQE segments structures */
 
 typedef struct xlio_mlx5_wqe_ctrl_seg {
@@ -470,6 +518,7 @@ enum {
     XLIO_MLX5_OPCODE_GET_PSV = 0x21,
     XLIO_MLX5_OPCODE_DUMP = 0x23,
     XLIO_MLX5_OPCODE_UMR = 0x25,
+    XLIO_MLX5_OPCODE_ENHANCED_MPSW = 0x29,
 };
 
 /*
@@ -487,8 +536,57 @@ int xlio_ib_mlx5_post_recv(xlio_ib_mlx5_qp_t *mlx5_qp, struct ibv_recv_wr *wr,
                            struct ibv_recv_wr **bad_wr);
 
 int xlio_ib_mlx5_get_cq(struct ibv_cq *cq, xlio_ib_mlx5_cq_t *mlx5_cq);
+int xlio_ib_mlx5_get_srq(struct ibv_srq *srq, xlio_ib_mlx5_srq_t *mlx5_srq);
 int xlio_ib_mlx5_req_notify_cq(xlio_ib_mlx5_cq_t *mlx5_cq, int solicited);
 void xlio_ib_mlx5_get_cq_event(xlio_ib_mlx5_cq_t *mlx5_cq, int count);
+struct ibv_cq *xlio_ib_mlx5_create_cq_comp(struct ibv_context *context, int cqe, void *cq_context,
+                                           struct ibv_comp_channel *channel, int comp_vector);
+bool xlio_ib_mlx5_is_empw_supported(struct ibv_context *context);
+
+static inline struct xlio_mlx5_cqe *xlio_ib_mlx5_cqe_at(xlio_ib_mlx5_cq_t *mlx5_cq, uint32_t idx)
+{
+    return (struct xlio_mlx5_cqe *)(((uint8_t *)mlx5_cq->cq_buf) +
+                                    ((idx & (mlx5_cq->cqe_count - 1)) << mlx5_cq->cqe_size_log));
+}
+
+static inline bool xlio_ib_mlx5_cqe_is_compressed(const struct xlio_mlx5_cqe *cqe)
+{
+    return XLIO_MLX5_CQE_FORMAT(cqe->op_own) == XLIO_MLX5_CQE_FORMAT_COMPRESSED;
+}
+
+/* Open a session for the compressed CQE at mlx5_cq->cq_ci. */
+static inline void xlio_ib_mlx5_cqe_zip_open(xlio_mlx5_cqe_zip *zip, xlio_ib_mlx5_cq_t *mlx5_cq,
+                                             const struct xlio_mlx5_cqe *cqe)
+{
+    zip->title = *cqe;
+    zip->ci = mlx5_cq->cq_ci;
+    zip->cnt = ntohl(cqe->byte_cnt);
+    zip->ai = 0;
+}
+
+/* Expand the next mini CQE of the open session into a full CQE.
+ * When the last one is consumed, the slots of the session are invalidated, so stale
+ * mini CQE bytes are never taken for a SW owned CQE after wrap around, and cq_ci moves
+ * past the session. The returned CQE is valid until the next call.
+ */
+static inline struct xlio_mlx5_cqe *xlio_ib_mlx5_cqe_zip_next(xlio_mlx5_cqe_zip *zip,
+                                                              xlio_ib_mlx5_cq_t *mlx5_cq)
+{
+    uint32_t array = zip->ai / XLIO_MLX5_MINI_CQE_ARRAY_SIZE;
+    xlio_mlx5_mini_cqe8 *mini = (xlio_mlx5_mini_cqe8 *)xlio_ib_mlx5_cqe_at(
+        mlx5_cq, zip->ci + (array ? array * XLIO_MLX5_MINI_CQE_ARRAY_SIZE : 1));
+
+    zip->title.byte_cnt = mini[zip->ai % XLIO_MLX5_MINI_CQE_ARRAY_SIZE].byte_cnt;
+    if (++zip->ai >= zip->cnt) {
+        for (uint32_t i = 0; i < zip->cnt; i++) {
+            xlio_ib_mlx5_cqe_at(mlx5_cq, zip->ci + i)->op_own = MLX5_CQE_INVALID << 4;
+        }
+        mlx5_cq->cq_ci = zip->ci + zip->cnt;
+        zip->cnt = 0;
+    }
+
+    return &zip->title;
+}
 
 #endif /* DEFINED_DIRECT_VERBS */
 
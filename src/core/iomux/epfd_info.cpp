@@ -840,6 +840,11 @@ void epfd_info::statistics_print(vlog_levels_t log_level /* = VLOG_DEBUG */)
                         temp_iomux_stats.n_iomux_poll_miss, temp_iomux_stats.n_iomux_poll_hit,
                         iomux_poll_hit_percentage);
 
+            if (temp_iomux_stats.n_iomux_poll_budget) {
+                vlog_printf(log_level, "Poll budget : %u [usec]\n",
+                            temp_iomux_stats.n_iomux_poll_budget);
+            }
+
             if (temp_iomux_stats.n_iomux_timeouts) {
                 vlog_printf(log_level, "Timeouts : %u\n", temp_iomux_stats.n_iomux_timeouts);
             }
@@ -49,6 +49,7 @@
 uint64_t g_polling_time_usec = 0; // polling time in the last second in usec
 timeval g_last_zero_polling_time; // the last time g_polling_time_usec was zeroed
 int g_n_last_checked_index = 0; // save the last fd index we checked in check_offloaded_rsockets()
+static __thread poll_budget t_select_poll_budget = {0, 0, 0}; // polling usec of the thread
 
 #define MODULE_NAME "io_mux_call:"
 
@@ -171,6 +172,9 @@ io_mux_call::io_mux_call(int *off_fds_buffer, offloaded_mode_t *off_modes_buffer
     , m_n_sysvar_select_skip_os_fd_check(safe_mce_sys().select_skip_os_fd_check)
     , m_n_sysvar_select_poll_os_ratio(safe_mce_sys().select_poll_os_ratio)
     , m_n_sysvar_select_poll_num(safe_mce_sys().select_poll_num)
+    , m_n_sysvar_select_poll_num_min(safe_mce_sys().select_poll_num_min)
+    , m_b_sysvar_select_poll_adaptive(safe_mce_sys().poll_adaptive &&
+                                      m_n_sysvar_select_poll_num > 0)
     , m_b_sysvar_select_poll_os_force(safe_mce_sys().select_poll_os_force)
     , m_b_sysvar_select_handle_cpu_usage_stats(safe_mce_sys().select_handle_cpu_usage_stats)
     , m_p_all_offloaded_fds(off_fds_buffer)
@@ -285,6 +289,8 @@ void io_mux_call::polling_loops()
     int check_timer_countdown = 1; // Poll once before checking the time
     int poll_os_countdown = 0;
     bool multiple_polling_loops, finite_polling;
+    bool poll_duration_reached = false;
+    int32_t poll_num = m_n_sysvar_select_poll_num;
     timeval before_polling_timer = TIMEVAL_INITIALIZER, after_polling_timer = TIMEVAL_INITIALIZER,
             delta;
 
@@ -297,13 +303,17 @@ void io_mux_call::polling_loops()
     ZERO_POLL_COUNT;
 #endif
 
+    if (m_b_sysvar_select_poll_adaptive) {
+        poll_num = t_select_poll_budget.get(m_n_sysvar_select_poll_num);
+    }
+
     poll_counter = 0;
-    finite_polling = m_n_sysvar_select_poll_num != -1;
-    multiple_polling_loops = m_n_sysvar_select_poll_num != 0;
+    finite_polling = poll_num != -1;
+    multiple_polling_loops = poll_num != 0;
 
     timeval poll_duration;
     tv_clear(&poll_duration);
-    poll_duration.tv_usec = m_n_sysvar_select_poll_num;
+    poll_duration.tv_usec = poll_num;
 
     __if_dbg("2nd scenario start");
 
@@ -364,6 +374,7 @@ void io_mux_call::polling_loops()
                          poll_counter, m_elapsed.tv_usec);
                 __if_dbg("timeout reached max poll duration (loop %d, elapsed %d)", poll_counter,
                          m_elapsed.tv_usec);
+                poll_duration_reached = true;
                 break;
             }
 
@@ -396,6 +407,17 @@ void io_mux_call::polling_loops()
         zero_polling_cpu(after_polling_timer);
     }
 
+    if (m_b_sysvar_select_poll_adaptive) {
+        // A user timeout shorter than the budget says nothing about the traffic
+        if (m_n_all_ready_fds) {
+            t_select_poll_budget.hit((int32_t)tv_to_usec(&m_elapsed),
+                                     m_n_sysvar_select_poll_num_min, m_n_sysvar_select_poll_num);
+        } else if (poll_duration_reached) {
+            t_select_poll_budget.miss(m_n_sysvar_select_poll_num_min);
+        }
+        m_p_stats->n_iomux_poll_budget = t_select_poll_budget.budget;
+    }
+
     if (m_n_all_ready_fds) { // TODO: verify!
         ++m_p_stats->n_iomux_poll_hit;
         __log_func("polling_loops found %d ready fds (rfds=%d, wfds=%d, efds=%d)",
@@ -128,4 +128,11 @@ inline void cc_post_recovery(struct tcp_pcb *pcb)
     }
 }
 
+inline void cc_rate_sample(struct tcp_pcb *pcb, const struct tcp_rate_sample *rs)
+{
+    if (pcb->cc_algo->rate_sample != NULL) {
+        pcb->cc_algo->rate_sample(pcb, rs);
+    }
+}
+
 #endif // TCP_CC_ALGO_MOD
@@ -89,7 +89,7 @@ struct tcp_pcb;
 #include <stdint.h>
 
 /* types of different cc algorithms */
-enum cc_algo_mod { CC_MOD_LWIP, CC_MOD_CUBIC, CC_MOD_NONE };
+enum cc_algo_mod { CC_MOD_LWIP, CC_MOD_CUBIC, CC_MOD_NONE, CC_MOD_BBR, CC_MOD_DCTCP };
 
 /* ACK types passed to the ack_received() hook. */
 #define CC_ACK        0x0001 /* Regular in sequence ACK. */
@@ -111,6 +111,22 @@ enum cc_algo_mod { CC_MOD_LWIP, CC_MOD_CUBIC, CC_MOD_NONE };
 
 #define TCP_CA_NAME_MAX 16 /* max congestion control name length */
 
+/* Algorithm flags. */
+#define CC_F_ECN      0x0001 /* Negotiates ECN regardless of the ECN configuration. */
+#define CC_F_ECN_ECHO 0x0002 /* Receiver echoes the CE mark of each segment (RFC 8257). */
+
+/*
+ * Delivery rate sample passed to the rate_sample() hook. A sample covers the
+ * data acknowledged between the transmission of the sampled segment and the
+ * receipt of its ACK, so roughly one sample is taken per round trip.
+ */
+struct tcp_rate_sample {
+    uint64_t delivered; /* Bytes delivered over the interval. */
+    uint64_t interval_us; /* Length of the interval in usec. */
+    uint64_t rtt_us; /* RTT of the sampled segment in usec. */
+    uint8_t is_app_limited; /* The sender was application limited. */
+};
+
 /*
  * Structure to hold data and function pointers that together represent a
  * congestion control algorithm.
@@ -118,6 +134,9 @@ enum cc_algo_mod { CC_MOD_LWIP, CC_MOD_CUBIC, CC_MOD_NONE };
 struct cc_algo {
     char name[TCP_CA_NAME_MAX];
 
+    /* CC_F_* flags */
+    uint32_t flags;
+
     /* Init cc_data */
     int (*init)(struct tcp_pcb *pcb);
 
@@ -138,11 +157,16 @@ struct cc_algo {
 
     /* Called when data transfer resumes after an idle period. */
     void (*after_idle)(struct tcp_pcb *pcb);
+
+    /* Called on a delivery rate sample. Setting it enables the rate sampler. */
+    void (*rate_sample)(struct tcp_pcb *pcb, const struct tcp_rate_sample *rs);
 };
 
 extern struct cc_algo lwip_cc_algo;
 extern struct cc_algo cubic_cc_algo;
 extern struct cc_algo none_cc_algo;
+extern struct cc_algo bbr_cc_algo;
+extern struct cc_algo dctcp_cc_algo;
 
 void cc_init(struct tcp_pcb *pcb);
 void cc_destroy(struct tcp_pcb *pcb);
@@ -150,5 +174,6 @@ void cc_ack_received(struct tcp_pcb *pcb, uint16_t type);
 void cc_conn_init(struct tcp_pcb *pcb);
 void cc_cong_signal(struct tcp_pcb *pcb, uint32_t type);
 void cc_post_recovery(struct tcp_pcb *pcb);
+void cc_rate_sample(struct tcp_pcb *pcb, const struct tcp_rate_sample *rs);
 
 #endif /* CC_H_ */
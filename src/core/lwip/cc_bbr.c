@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * BBR congestion control, version 1.
+ *
+ * Instead of reacting to loss, BBR builds an explicit model of the path from
+ * delivery rate and RTT samples: the bottleneck bandwidth is the windowed
+ * maximum of the delivery rate and the propagation delay is the windowed
+ * minimum of the RTT. The sender paces at a gain over the estimated bandwidth
+ * and bounds the data in flight by a gain over the estimated BDP.
+ *
+ * The model is fed by the delivery rate sampler of the pcb, which provides
+ * about one sample per round trip. The resulting pacing rate is exported in
+ * pcb->pacing_rate in bytes per second.
+ */
+
+#include "core/lwip/cc.h"
+#include "core/lwip/tcp.h"
+#include "core/lwip/tcp_impl.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if TCP_CC_ALGO_MOD
+
+/* Gains are fixed point values with BBR_SCALE bits of fraction. */
+#define BBR_SCALE 8
+#define BBR_UNIT  (1 << BBR_SCALE)
+
+/* 2/ln(2), the smallest gain which doubles the sending rate every round. */
+#define BBR_HIGH_GAIN  (BBR_UNIT * 2885 / 1000 + 1)
+#define BBR_DRAIN_GAIN (BBR_UNIT * 1000 / 2885)
+#define BBR_CWND_GAIN  (BBR_UNIT * 2)
+
+/* Length of the bandwidth filter window in round trips. */
+#define BBR_BW_WIN_RTTS 10
+/* Length of the min RTT filter window. */
+#define BBR_MIN_RTT_WIN_US (10 * 1000000ULL)
+/* Minimum time spent in PROBE_RTT. */
+#define BBR_PROBE_RTT_US (200 * 1000ULL)
+/* Rounds without 25% bandwidth growth after which the pipe is considered full. */
+#define BBR_FULL_BW_THRESH (BBR_UNIT * 5 / 4)
+#define BBR_FULL_BW_CNT    3
+/* Minimum cwnd in segments, also used as the cwnd in PROBE_RTT. */
+#define BBR_MIN_CWND_SEGS 4
+/* Pace 1% below the estimated bandwidth to drain queues built by bursts. */
+#define BBR_PACING_MARGIN_PERCENT 1
+
+#define BBR_RTT_UNKNOWN (~0ULL)
+#define BBR_USEC_PER_SEC 1000000ULL
+
+enum bbr_mode {
+    BBR_STARTUP, /* ramp up the sending rate to fill the pipe */
+    BBR_DRAIN, /* drain the queue created during startup */
+    BBR_PROBE_BW, /* cycle the pacing gain to probe for more bandwidth */
+    BBR_PROBE_RTT /* cut inflight to probe the propagation delay */
+};
+
+static const u32_t bbr_pacing_gain[] = {
+    BBR_UNIT * 5 / 4, BBR_UNIT * 3 / 4, BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT, BBR_UNIT};
+
+#define BBR_CYCLE_LEN (sizeof(bbr_pacing_gain) / sizeof(bbr_pacing_gain[0]))
+
+struct bbr_max_sample {
+    u32_t t; /* round in which the sample was taken */
+    u64_t v;
+};
+
+struct bbr {
+    /* Windowed max filter of the delivery rate in bytes/sec. */
+    struct bbr_max_sample bw[3];
+    /* Number of round trips since the connection start. */
+    u32_t round_count;
+    /* Windowed min filter of the RTT. */
+    u64_t min_rtt_us;
+    u64_t min_rtt_stamp_us;
+    /* End of the PROBE_RTT period, 0 until inflight drops to the minimum. */
+    u64_t probe_rtt_done_us;
+    u32_t probe_rtt_round;
+    /* Start of the current gain cycle phase. */
+    u64_t cycle_stamp_us;
+    /* Bandwidth at which startup stopped growing. */
+    u64_t full_bw;
+    /* cwnd saved on entering recovery or PROBE_RTT. */
+    u32_t prior_cwnd;
+    u32_t pacing_gain;
+    u32_t cwnd_gain;
+    u8_t mode;
+    u8_t cycle_idx;
+    u8_t full_bw_cnt;
+    u8_t full_bw_reached;
+    u8_t probe_rtt_round_done;
+};
+
+static int bbr_cb_init(struct tcp_pcb *pcb);
+static void bbr_cb_destroy(struct tcp_pcb *pcb);
+static void bbr_conn_init(struct tcp_pcb *pcb);
+static void bbr_ack_received(struct tcp_pcb *pcb, uint16_t type);
+static void bbr_cong_signal(struct tcp_pcb *pcb, uint32_t type);
+static void bbr_post_recovery(struct tcp_pcb *pcb);
+static void bbr_rate_sample(struct tcp_pcb *pcb, const struct tcp_rate_sample *rs);
+
+struct cc_algo bbr_cc_algo = {.name = "bbr",
+                              .init = bbr_cb_init,
+                              .destroy = bbr_cb_destroy,
+                              .conn_init = bbr_conn_init,
+                              .ack_received = bbr_ack_received,
+                              .cong_signal = bbr_cong_signal,
+                              .post_recovery = bbr_post_recovery,
+                              .rate_sample = bbr_rate_sample};
+
+static inline u32_t bbr_inflight(struct tcp_pcb *pcb)
+{
+    return pcb->snd_nxt - pcb->lastack;
+}
+
+static inline u32_t bbr_min_cwnd(struct tcp_pcb *pcb)
+{
+    return BBR_MIN_CWND_SEGS * pcb->mss;
+}
+
+static inline u64_t bbr_max_bw(struct bbr *bbr)
+{
+    return bbr->bw[0].v;
+}
+
+/*
+ * Kathleen Nichols' windowed max filter: keeps the best, the 2nd best and the
+ * 3rd best samples from disjoint sub-windows of the window.
+ */
+static u64_t bbr_max_filter_update(struct bbr_max_sample *s, u32_t win, u32_t t, u64_t v)
+{
+    struct bbr_max_sample val = {.t = t, .v = v};
+    u32_t dt;
+
+    if (val.v >= s[0].v || val.t - s[2].t > win) {
+        s[0] = s[1] = s[2] = val;
+        return s[0].v;
+    }
+
+    if (val.v >= s[1].v) {
+        s[2] = s[1] = val;
+    } else if (val.v >= s[2].v) {
+        s[2] = val;
+    }
+
+    dt = val.t - s[0].t;
+    if (dt > win) {
+        /* The best sample expired, promote the next ones. */
+        s[0] = s[1];
+        s[1] = s[2];
+        s[2] = val;
+        if (val.t - s[0].t > win) {
+            s[0] = s[1];
+            s[1] = s[2];
+            s[2] = val;
+        }
+    } else if (s[1].t == s[0].t && dt > win / 4) {
+        /* A quarter of the window passed without a 2nd best sample. */
+        s[2] = s[1] = val;
+    } else if (s[2].t == s[1].t && dt > win / 2) {
+        /* Half of the window passed without a 3rd best sample. */
+        s[2] = val;
+    }
+    return s[0].v;
+}
+
+/*
+ * Return the amount of data in flight needed to fully utilize the path,
+ * scaled by gain, or 0 if there is no model yet.
+ */
+static u32_t bbr_target_cwnd(struct tcp_pcb *pcb, struct bbr *bbr, u32_t gain)
+{
+    u64_t bdp;
+
+    if (bbr->min_rtt_us == BBR_RTT_UNKNOWN || bbr_max_bw(bbr) == 0) {
+        return 0;
+    }
+
+    bdp = bbr_max_bw(bbr) * bbr->min_rtt_us / BBR_USEC_PER_SEC;
+    bdp = (bdp * gain) >> BBR_SCALE;
+    /* Leave room for the segments queued in the TX path. */
+    bdp += 3 * pcb->mss;
+
+    return (bdp > 0x7fffffffULL) ? 0x7fffffffU : (u32_t)bdp;
+}
+
+static void bbr_set_pacing_rate(struct tcp_pcb *pcb, struct bbr *bbr)
+{
+    u64_t rate = (bbr_max_bw(bbr) * bbr->pacing_gain) >> BBR_SCALE;
+
+    rate = rate * (100 - BBR_PACING_MARGIN_PERCENT) / 100;
+    /* Don't slow down in startup until the pipe is known to be full. */
+    if (rate != 0 && (bbr->full_bw_reached || rate > pcb->pacing_rate)) {
+        pcb->pacing_rate = rate;
+    }
+}
+
+static void bbr_reset_startup(struct bbr *bbr)
+{
+    bbr->mode = BBR_STARTUP;
+    bbr->pacing_gain = BBR_HIGH_GAIN;
+    bbr->cwnd_gain = BBR_HIGH_GAIN;
+}
+
+static void bbr_reset_probe_bw(struct bbr *bbr, u64_t now)
+{
+    bbr->mode = BBR_PROBE_BW;
+    bbr->cwnd_gain = BBR_CWND_GAIN;
+    /* Start from a random phase other than the draining one, so flows sharing
+       a bottleneck don't probe in lockstep. */
+    bbr->cycle_idx = (u8_t)((now >> 4) % (BBR_CYCLE_LEN - 1));
+    if (bbr->cycle_idx >= 1) {
+        bbr->cycle_idx++;
+    }
+    bbr->cycle_stamp_us = now;
+    bbr->pacing_gain = bbr_pacing_gain[bbr->cycle_idx];
+}
+
+static void bbr_update_bw(struct bbr *bbr, const struct tcp_rate_sample *rs)
+{
+    u64_t bw = rs->delivered * BBR_USEC_PER_SEC / rs->interval_us;
+
+    /* Application limited samples underestimate the bandwidth, use them only
+       when they raise the estimate. */
+    if (!rs->is_app_limited || bw >= bbr_max_bw(bbr)) {
+        bbr_max_filter_update(bbr->bw, BBR_BW_WIN_RTTS, bbr->round_count, bw);
+    }
+}
+
+static void bbr_update_cycle_phase(struct tcp_pcb *pcb, struct bbr *bbr, u64_t now)
+{
+    u32_t gain = bbr->pacing_gain;
+    u8_t is_full_length;
+
+    if (bbr->mode != BBR_PROBE_BW) {
+        return;
+    }
+
+    is_full_length = (now - bbr->cycle_stamp_us) > bbr->min_rtt_us;
+    if (gain > BBR_UNIT) {
+        /* Probe until the extra data is actually in flight. */
+        if (!is_full_length || bbr_inflight(pcb) < bbr_target_cwnd(pcb, bbr, gain)) {
+            return;
+        }
+    } else if (gain < BBR_UNIT) {
+        /* Drain until the queue is gone or for one round at most. */
+        if (!is_full_length && bbr_inflight(pcb) > bbr_target_cwnd(pcb, bbr, BBR_UNIT)) {
+            return;
+        }
+    } else if (!is_full_length) {
+        return;
+    }
+
+    bbr->cycle_idx = (bbr->cycle_idx + 1) % BBR_CYCLE_LEN;
+    bbr->cycle_stamp_us = now;
+    bbr->pacing_gain = bbr_pacing_gain[bbr->cycle_idx];
+}
+
+static void bbr_check_full_bw_reached(struct bbr *bbr, const struct tcp_rate_sample *rs)
+{
+    if (bbr->full_bw_reached || rs->is_app_limited) {
+        return;
+    }
+
+    if (bbr_max_bw(bbr) >= ((bbr->full_bw * BBR_FULL_BW_THRESH) >> BBR_SCALE)) {
+        bbr->full_bw = bbr_max_bw(bbr);
+        bbr->full_bw_cnt = 0;
+        return;
+    }
+    bbr->full_bw_reached = (++bbr->full_bw_cnt >= BBR_FULL_BW_CNT);
+}
+
+static void bbr_check_drain(struct tcp_pcb *pcb, struct bbr *bbr, u64_t now)
+{
+    if (bbr->mode == BBR_STARTUP && bbr->full_bw_reached) {
+        LWIP_DEBUGF(TCP_CWND_DEBUG,
+                    ("bbr: pipe is full at %" U32_F " bytes/sec\n", (u32_t)bbr_max_bw(bbr)));
+        bbr->mode = BBR_DRAIN;
+        bbr->pacing_gain = BBR_DRAIN_GAIN;
+        bbr->cwnd_gain = BBR_HIGH_GAIN;
+    }
+    if (bbr->mode == BBR_DRAIN && bbr_inflight(pcb) <= bbr_target_cwnd(pcb, bbr, BBR_UNIT)) {
+        bbr_reset_probe_bw(bbr, now);
+    }
+}
+
+static void bbr_update_min_rtt(struct tcp_pcb *pcb, struct bbr *bbr,
+                               const struct tcp_rate_sample *rs, u64_t now)
+{
+    u8_t expired = (now - bbr->min_rtt_stamp_us) > BBR_MIN_RTT_WIN_US;
+
+    if (rs->rtt_us <= bbr->min_rtt_us || expired) {
+        bbr->min_rtt_us = rs->rtt_us;
+        bbr->min_rtt_stamp_us = now;
+    }
+
+    if (expired && bbr->mode != BBR_PROBE_RTT) {
+        bbr->mode = BBR_PROBE_RTT;
+        bbr->pacing_gain = BBR_UNIT;
+        bbr->cwnd_gain = BBR_UNIT;
+        bbr->prior_cwnd = LWIP_MAX(bbr->prior_cwnd, pcb->cwnd);
+        bbr->probe_rtt_done_us = 0;
+    }
+
+    if (bbr->mode != BBR_PROBE_RTT) {
+        return;
+    }
+
+    if (bbr->probe_rtt_done_us == 0) {
+        if (bbr_inflight(pcb) <= bbr_min_cwnd(pcb)) {
+            /* Hold the minimum inflight for at least PROBE_RTT time and one round. */
+            bbr->probe_rtt_done_us = now + BBR_PROBE_RTT_US;
+            bbr->probe_rtt_round = bbr->round_count;
+            bbr->probe_rtt_round_done = 0;
+        }
+        return;
+    }
+
+    if (bbr->round_count != bbr->probe_rtt_round) {
+        bbr->probe_rtt_round_done = 1;
+    }
+    if (bbr->probe_rtt_round_done && now >= bbr->probe_rtt_done_us) {
+        bbr->min_rtt_stamp_us = now;
+        pcb->cwnd = LWIP_MAX(pcb->cwnd, bbr->prior_cwnd);
+        bbr->prior_cwnd = 0;
+        if (bbr->full_bw_reached) {
+            bbr_reset_probe_bw(bbr, now);
+        } else {
+            bbr_reset_startup(bbr);
+        }
+    }
+}
+
+static void bbr_rate_sample(struct tcp_pcb *pcb, const struct tcp_rate_sample *rs)
+{
+    struct bbr *bbr = pcb->cc_data;
+    u64_t now = sys_now_us();
+
+    /* The rate sampler arms a new sample only after the previous one is acked,
+       so every sample starts a new round trip. */
+    bbr->round_count++;
+
+    bbr_update_bw(bbr, rs);
+    bbr_update_cycle_phase(pcb, bbr, now);
+    bbr_check_full_bw_reached(bbr, rs);
+    bbr_check_drain(pcb, bbr, now);
+    bbr_update_min_rtt(pcb, bbr, rs, now);
+    bbr_set_pacing_rate(pcb, bbr);
+}
+
+static void bbr_ack_received(struct tcp_pcb *pcb, uint16_t type)
+{
+    struct bbr *bbr = pcb->cc_data;
+    u32_t target;
+    u32_t cwnd = pcb->cwnd;
+
+    if (type != CC_ACK) {
+        return;
+    }
+
+    target = bbr_target_cwnd(pcb, bbr, bbr->cwnd_gain);
+    if (bbr->full_bw_reached) {
+        cwnd = LWIP_MIN(cwnd + pcb->acked, target);
+    } else if ((cwnd < target || target == 0) && (u32_t)(cwnd + pcb->acked) > cwnd) {
+        /* Grow like slow start until the model says the pipe is full. */
+        cwnd += pcb->acked;
+    }
+    cwnd = LWIP_MAX(cwnd, bbr_min_cwnd(pcb));
+    if (bbr->mode == BBR_PROBE_RTT) {
+        cwnd = LWIP_MIN(cwnd, bbr_min_cwnd(pcb));
+    }
+    pcb->cwnd = cwnd;
+}
+
+static void bbr_cong_signal(struct tcp_pcb *pcb, uint32_t type)
+{
+    struct bbr *bbr = pcb->cc_data;
+
+    switch (type) {
+    case CC_NDUPACK:
+        /* Loss is not a congestion signal for BBR. Keep the data in flight at its
+           current level while recovering and restore the cwnd afterwards. */
+        if (!(pcb->flags & TF_INFR)) {
+            bbr->prior_cwnd = LWIP_MAX(bbr->prior_cwnd, pcb->cwnd);
+            pcb->cwnd = LWIP_MAX(bbr_inflight(pcb), bbr_min_cwnd(pcb));
+        }
+        break;
+
+    case CC_RTO:
+        bbr->prior_cwnd = LWIP_MAX(bbr->prior_cwnd, pcb->cwnd);
+        pcb->cwnd = pcb->mss;
+        break;
+    }
+}
+
+static void bbr_post_recovery(struct tcp_pcb *pcb)
+{
+    struct bbr *bbr = pcb->cc_data;
+
+    pcb->cwnd = LWIP_MAX(pcb->cwnd, bbr->prior_cwnd);
+    bbr->prior_cwnd = 0;
+}
+
+static void bbr_conn_init(struct tcp_pcb *pcb)
+{
+    pcb->cwnd = ((pcb->cwnd == 1) ? (pcb->mss * 2) : pcb->mss);
+    /* BBR doesn't use slow start threshold. */
+    pcb->ssthresh = 0x7fffffffU;
+}
+
+static void bbr_cb_destroy(struct tcp_pcb *pcb)
+{
+    if (pcb->cc_data != NULL) {
+        free(pcb->cc_data);
+        pcb->cc_data = NULL;
+    }
+}
+
+static int bbr_cb_init(struct tcp_pcb *pcb)
+{
+    struct bbr *bbr;
+
+    bbr = malloc(sizeof(struct bbr));
+    if (bbr == NULL) {
+        return (ENOMEM);
+    }
+    memset(bbr, 0, sizeof(*bbr));
+
+    bbr->min_rtt_us = BBR_RTT_UNKNOWN;
+    bbr->min_rtt_stamp_us = sys_now_us();
+    bbr_reset_startup(bbr);
+
+    pcb->cc_data = bbr;
+
+    return (0);
+}
+
+#endif // TCP_CC_ALGO_MOD
@@ -236,6 +236,17 @@ static void cubic_cong_signal(struct tcp_pcb *pcb, uint32_t type)
         }
         break;
 
+    case CC_ECN:
+        if (!(pcb->flags & TF_INFR)) {
+            cubic_ssthresh_update(pcb);
+            cubic_data->num_cong_events++;
+            cubic_data->prev_max_cwnd = cubic_data->max_cwnd;
+            cubic_data->max_cwnd = pcb->cwnd;
+            pcb->cwnd = pcb->ssthresh;
+            cubic_data->t_last_cong = ticks;
+        }
+        break;
+
     case CC_RTO:
         /* Set ssthresh to half of the minimum of the current
          * cwnd and the advertised window */
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * DCTCP congestion control (RFC 8257).
+ *
+ * The switches of a data center fabric mark packets with CE as soon as their
+ * queue exceeds a small threshold, long before it overflows. The receiver
+ * echoes the mark of each segment and the sender estimates the fraction of
+ * marked bytes once per window of data. On ECE the congestion window is reduced
+ * in proportion to that fraction instead of being halved, which keeps the
+ * queues short without giving up throughput.
+ *
+ * Window growth and the response to loss are those of New Reno.
+ */
+
+#include "core/lwip/cc.h"
+#include "core/lwip/tcp.h"
+#include "core/lwip/tcp_impl.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if TCP_CC_ALGO_MOD
+
+/* alpha is a fixed point value with DCTCP_ALPHA_SHIFT bits of fraction. */
+#define DCTCP_ALPHA_SHIFT 10
+#define DCTCP_ALPHA_MAX   (1U << DCTCP_ALPHA_SHIFT)
+/* Estimation gain g = 1/16. */
+#define DCTCP_SHIFT_G 4
+
+struct dctcp {
+    /* Estimated fraction of marked bytes. */
+    u32_t alpha;
+    /* Bytes acknowledged in the current observation window. */
+    u32_t acked_bytes;
+    /* Bytes acknowledged with ECE in the current observation window. */
+    u32_t ece_bytes;
+    /* The observation window ends once this sequence number is acknowledged. */
+    u32_t window_end;
+};
+
+static int dctcp_cb_init(struct tcp_pcb *pcb);
+static void dctcp_cb_destroy(struct tcp_pcb *pcb);
+static void dctcp_conn_init(struct tcp_pcb *pcb);
+static void dctcp_ack_received(struct tcp_pcb *pcb, uint16_t type);
+static void dctcp_cong_signal(struct tcp_pcb *pcb, uint32_t type);
+static void dctcp_post_recovery(struct tcp_pcb *pcb);
+
+struct cc_algo dctcp_cc_algo = {.name = "dctcp",
+                                .flags = CC_F_ECN | CC_F_ECN_ECHO,
+                                .init = dctcp_cb_init,
+                                .destroy = dctcp_cb_destroy,
+                                .conn_init = dctcp_conn_init,
+                                .ack_received = dctcp_ack_received,
+                                .cong_signal = dctcp_cong_signal,
+                                .post_recovery = dctcp_post_recovery};
+
+static void dctcp_reset_window(struct tcp_pcb *pcb, struct dctcp *dctcp)
+{
+    dctcp->acked_bytes = 0;
+    dctcp->ece_bytes = 0;
+    dctcp->window_end = pcb->snd_nxt;
+}
+
+/*
+ * Accounts the bytes of an ACK and updates alpha at the end of each window:
+ * alpha = (1 - g) * alpha + g * F, where F is the fraction of marked bytes.
+ */
+static void dctcp_update_alpha(struct tcp_pcb *pcb, struct dctcp *dctcp)
+{
+    u32_t decay;
+
+    dctcp->acked_bytes += pcb->acked;
+    if (pcb->ecn_ece) {
+        dctcp->ece_bytes += pcb->acked;
+    }
+
+    if (TCP_SEQ_LT(pcb->lastack, dctcp->window_end) || dctcp->acked_bytes == 0) {
+        return;
+    }
+
+    /* Let alpha reach zero once the decay rounds down to nothing. */
+    decay = dctcp->alpha >> DCTCP_SHIFT_G;
+    dctcp->alpha -= decay ? decay : dctcp->alpha;
+    dctcp->alpha += (u32_t)(((u64_t)dctcp->ece_bytes << (DCTCP_ALPHA_SHIFT - DCTCP_SHIFT_G)) /
+                            dctcp->acked_bytes);
+    dctcp->alpha = LWIP_MIN(dctcp->alpha, DCTCP_ALPHA_MAX);
+
+    dctcp_reset_window(pcb, dctcp);
+}
+
+static void dctcp_ack_received(struct tcp_pcb *pcb, uint16_t type)
+{
+    struct dctcp *dctcp = pcb->cc_data;
+
+    if (type == CC_DUPACK) {
+        if ((u32_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
+            pcb->cwnd += pcb->mss;
+        }
+    } else if (type == CC_ACK) {
+        dctcp_update_alpha(pcb, dctcp);
+
+        if (pcb->cwnd < pcb->ssthresh) {
+            if ((u32_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
+                pcb->cwnd += pcb->mss;
+            }
+        } else {
+            u32_t new_cwnd = (pcb->cwnd + ((u32_t)pcb->mss * (u32_t)pcb->mss) / pcb->cwnd);
+            if (new_cwnd > pcb->cwnd) {
+                pcb->cwnd = new_cwnd;
+            }
+        }
+    }
+}
+
+static void dctcp_cong_signal(struct tcp_pcb *pcb, uint32_t type)
+{
+    struct dctcp *dctcp = pcb->cc_data;
+    u32_t reduction;
+
+    switch (type) {
+    case CC_ECN:
+        /* cwnd = cwnd * (1 - alpha / 2) */
+        reduction = (u32_t)(((u64_t)pcb->cwnd * dctcp->alpha) >> (DCTCP_ALPHA_SHIFT + 1));
+        pcb->ssthresh = LWIP_MAX(pcb->cwnd - reduction, 2U * pcb->mss);
+        pcb->cwnd = pcb->ssthresh;
+        break;
+
+    case CC_NDUPACK:
+    case CC_RTO:
+        /* Loss is handled as by a conventional TCP (RFC 8257 3.4). */
+        pcb->ssthresh = LWIP_MAX(LWIP_MIN(pcb->cwnd, pcb->snd_wnd) / 2, 2U * pcb->mss);
+        pcb->cwnd = (type == CC_RTO) ? pcb->mss : pcb->ssthresh + 3 * pcb->mss;
+        break;
+    }
+}
+
+static void dctcp_post_recovery(struct tcp_pcb *pcb)
+{
+    pcb->cwnd = pcb->ssthresh;
+}
+
+static void dctcp_conn_init(struct tcp_pcb *pcb)
+{
+    pcb->cwnd = ((pcb->cwnd == 1) ? (pcb->mss * 2) : pcb->mss);
+    dctcp_reset_window(pcb, pcb->cc_data);
+}
+
+static void dctcp_cb_destroy(struct tcp_pcb *pcb)
+{
+    if (pcb->cc_data != NULL) {
+        free(pcb->cc_data);
+        pcb->cc_data = NULL;
+    }
+}
+
+static int dctcp_cb_init(struct tcp_pcb *pcb)
+{
+    struct dctcp *dctcp;
+
+    dctcp = malloc(sizeof(struct dctcp));
+    if (dctcp == NULL) {
+        return (ENOMEM);
+    }
+    memset(dctcp, 0, sizeof(*dctcp));
+
+    /* Start conservatively, as if all bytes were marked (RFC 8257 4.2). */
+    dctcp->alpha = DCTCP_ALPHA_MAX;
+
+    pcb->cc_data = dctcp;
+
+    return (0);
+}
+
+#endif // TCP_CC_ALGO_MOD
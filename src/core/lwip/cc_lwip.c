@@ -146,6 +146,8 @@ static void lwip_cong_signal(struct tcp_pcb *pcb, uint32_t type)
         pcb->cwnd = pcb->ssthresh + 3 * pcb->mss;
     } else if (type == CC_RTO) {
         pcb->cwnd = pcb->mss;
+    } else if (type == CC_ECN) {
+        pcb->cwnd = pcb->ssthresh;
     }
 }
 
@@ -141,6 +141,23 @@
 #define TCP_CC_ALGO_MOD 1
 #endif
 
+/**
+ * TCP_PACING_TSO_USEC: amount of data, in usec of transmission at the pacing
+ * rate, which a paced connection may put into a single TSO segment.
+ */
+#ifndef TCP_PACING_TSO_USEC
+#define TCP_PACING_TSO_USEC 1000
+#endif
+
+/**
+ * TCP_PACING_CATCHUP_SEGS: number of segments a late paced release may send
+ * ahead of the pacing schedule, in addition to the lwip_tcp_pacing_horizon_us
+ * time limit.
+ */
+#ifndef TCP_PACING_CATCHUP_SEGS
+#define TCP_PACING_CATCHUP_SEGS 4
+#endif
+
 /**
  * window scaling parameter
  */
@@ -168,6 +185,15 @@
 #define TCP_QUEUE_OOSEQ 1
 #endif
 
+/**
+ * TCP_OOSEQ_MAX_BYTES: The maximum number of bytes queued on ooseq per pcb.
+ * Out-of-order segments above the limit are dropped and thus not reported in
+ * SACK blocks. Define to 0 to bound the queue by the receive window only.
+ */
+#ifndef TCP_OOSEQ_MAX_BYTES
+#define TCP_OOSEQ_MAX_BYTES 0
+#endif
+
 /**
  * TCP_CALCULATE_EFF_SEND_MSS: "The maximum size of a segment that TCP really
  * sends, the 'effective send MSS,' MUST be the smaller of the send MSS (which
@@ -205,6 +231,45 @@
 #define LWIP_TCP_TIMESTAMPS 1
 #endif
 
+/**
+ * LWIP_TCP_SACK==1: support the TCP selective acknowledgment option (RFC 2018)
+ * and SACK based loss recovery (RFC 6675).
+ */
+#ifndef LWIP_TCP_SACK
+#define LWIP_TCP_SACK 1
+#endif
+
+/**
+ * TCP_SACK_SB_MAX: maximum number of SACKed ranges kept in the sender
+ * scoreboard of a connection.
+ */
+#ifndef TCP_SACK_SB_MAX
+#define TCP_SACK_SB_MAX 16
+#endif
+
+/**
+ * LWIP_TCP_RACK_TLP==1: support time based loss detection with RACK and
+ * Tail Loss Probe (RFC 8985). Requires LWIP_TCP_SACK.
+ */
+#ifndef LWIP_TCP_RACK_TLP
+#define LWIP_TCP_RACK_TLP LWIP_TCP_SACK
+#endif
+
+/**
+ * TCP_TLP_PTO_INIT_US: probe timeout in usec used before an RTT sample is taken.
+ */
+#ifndef TCP_TLP_PTO_INIT_US
+#define TCP_TLP_PTO_INIT_US 1000000
+#endif
+
+/**
+ * TCP_TLP_WCDELACK_US: worst case delayed ACK time in usec, added to the probe
+ * timeout when a single segment is in flight.
+ */
+#ifndef TCP_TLP_WCDELACK_US
+#define TCP_TLP_WCDELACK_US 200000
+#endif
+
 /**
  * TCP_WND_UPDATE_THRESHOLD: difference in window to trigger an
  * explicit window update
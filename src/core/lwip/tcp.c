@@ -87,9 +87,14 @@ enum cc_algo_mod lwip_cc_algo_module = CC_MOD_LWIP;
 u16_t lwip_tcp_mss = CONST_TCP_MSS;
 u32_t lwip_tcp_snd_buf = 0;
 u32_t lwip_zc_tx_size = 0;
+/* How far a late paced release may catch up with the pacing schedule. */
+u32_t lwip_tcp_pacing_horizon_us = 0;
 
 u8_t enable_push_flag = 1;
 u8_t enable_ts_option = 0;
+u8_t enable_sack_option = 0;
+u8_t enable_ecn_option = TCP_ECN_OFF;
+u8_t enable_rack_tlp_option = 0;
 /* slow timer value */
 static u32_t slow_tmr_interval;
 /* Incremented every coarse grained timer shot (typically every slow_tmr_interval ms). */
@@ -122,6 +127,53 @@ void tcp_tmr(struct tcp_pcb *pcb)
     }
 }
 
+/**
+ * Returns the number of milliseconds until tcp_tmr() has work to do for the pcb.
+ * An idle connection has no timer running except the keepalive one, so the
+ * caller doesn't need to call tcp_tmr() for it periodically.
+ *
+ * @param pcb the tcp_pcb to check
+ * @return 0 if tcp_tmr() must be called periodically, the time until the next
+ *         keepalive check or TCP_TMR_NONE if there is no deadline at all
+ */
+u32_t tcp_tmr_next(struct tcp_pcb *pcb)
+{
+    u32_t idle, limit;
+
+    /* Connection timeouts, retransmission, persist, user timeout, delayed ACK
+     * and refused data are driven by the ticks of tcp_tmr(). */
+    if (get_tcp_state(pcb) != ESTABLISHED || pcb->unacked != NULL || pcb->unsent != NULL ||
+        pcb->persist_backoff > 0 || pcb->ticks_since_data_sent != -1 ||
+        pcb->refused_data != NULL || (pcb->flags & (TF_ACK_DELAY | TF_ACK_NOW))) {
+        return 0;
+    }
+#if TCP_QUEUE_OOSEQ
+    if (pcb->ooseq != NULL) {
+        return 0;
+    }
+#endif /* TCP_QUEUE_OOSEQ */
+#if TCP_CC_ALGO_MOD
+    if (pcb->pacing_pending) {
+        return 0;
+    }
+#endif /* TCP_CC_ALGO_MOD */
+
+    if (!(pcb->so_options & SOF_KEEPALIVE)) {
+        return TCP_TMR_NONE;
+    }
+    /* Next keepalive probe, see tcp_slowtmr() */
+#if LWIP_TCP_KEEPALIVE
+    limit = (pcb->keep_idle + pcb->keep_cnt_sent * pcb->keep_intvl) / slow_tmr_interval;
+#else
+    limit = (pcb->keep_idle + pcb->keep_cnt_sent * TCP_KEEPINTVL_DEFAULT) / slow_tmr_interval;
+#endif /* LWIP_TCP_KEEPALIVE */
+    idle = (u32_t)(tcp_ticks - pcb->tmr);
+    if (idle > limit) {
+        return 0;
+    }
+    return (limit + 1 - idle) * slow_tmr_interval;
+}
+
 /**
  * Closes the TX side of a connection held by the PCB.
  * For tcp_close(), a RST is sent if the application didn't receive all data
@@ -498,20 +550,10 @@ void tcp_recved(struct tcp_pcb *pcb, u32_t len)
                  pcb->rcv_wnd, TCP_WND_SCALED(pcb) - pcb->rcv_wnd));
 }
 
-/**
- * Connects to another host. The function given as the "connected"
- * argument will be called when the connection has been established.
- *
- * @param pcb the tcp_pcb used to establish the connection
- * @param ipaddr the remote ip address to connect to
- * @param port the remote tcp port to connect to
- * @param connected callback function to call when connected (or on error)
- * @return ERR_VAL if invalid arguments are given
- *         ERR_OK if connect request has been sent
- *         other err_t values if connect request couldn't be sent
- */
-err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
-                  tcp_connected_fn connected)
+/* Common part of tcp_connect() and tcp_connect_fastopen() */
+static err_t tcp_connect_syn(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port,
+                             bool is_ipv6, tcp_connected_fn connected, const void *data,
+                             u32_t *len)
 {
     err_t ret;
     u32_t iss;
@@ -552,7 +594,13 @@ err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool
     pcb->connected = connected;
 
     /* Send a SYN together with the MSS option. */
-    ret = tcp_enqueue_flags(pcb, TCP_SYN);
+    if (data != NULL && *len > 0) {
+        ret = tcp_enqueue_syn_data(pcb, data, len);
+        /* Let the window fit the data of the SYN, the initial window is set on SYN-ACK */
+        pcb->cwnd = LWIP_MAX(*len, 1U);
+    } else {
+        ret = tcp_enqueue_flags(pcb, TCP_SYN);
+    }
     if (ret == ERR_OK) {
         /* SYN segment was enqueued, changed the pcbs state now */
         set_tcp_state(pcb, SYN_SENT);
@@ -563,6 +611,48 @@ err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool
     return ret;
 }
 
+/**
+ * Connects to another host. The function given as the "connected"
+ * argument will be called when the connection has been established.
+ *
+ * @param pcb the tcp_pcb used to establish the connection
+ * @param ipaddr the remote ip address to connect to
+ * @param port the remote tcp port to connect to
+ * @param connected callback function to call when connected (or on error)
+ * @return ERR_VAL if invalid arguments are given
+ *         ERR_OK if connect request has been sent
+ *         other err_t values if connect request couldn't be sent
+ */
+err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
+                  tcp_connected_fn connected)
+{
+    return tcp_connect_syn(pcb, ipaddr, port, is_ipv6, connected, NULL, NULL);
+}
+
+/**
+ * Connects to another host using TCP Fast Open (RFC 7413). pcb->fastopen holds
+ * the cookie of the remote host, the data is sent in the SYN with it. An empty
+ * cookie requests one from the remote host and no data is sent.
+ *
+ * @param pcb the tcp_pcb used to establish the connection
+ * @param ipaddr the remote ip address to connect to
+ * @param port the remote tcp port to connect to
+ * @param connected callback function to call when connected (or on error)
+ * @param data data to send in the SYN
+ * @param len in: length of data, out: number of bytes sent in the SYN
+ * @return see tcp_connect()
+ */
+err_t tcp_connect_fastopen(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
+                           tcp_connected_fn connected, const void *data, u32_t *len)
+{
+    pcb->flags |= TF_FASTOPEN;
+    pcb->flags &= ~(TF_FASTOPEN_COOKIE | TF_FASTOPEN_DATA);
+    if (pcb->fastopen.len == 0) {
+        *len = 0;
+    }
+    return tcp_connect_syn(pcb, ipaddr, port, is_ipv6, connected, data, len);
+}
+
 static inline bool tcp_user_timeout_occured(struct tcp_pcb *pcb)
 {
     u32_t user_timeout_ticks = (pcb->user_timeout_ms + slow_tmr_interval - 1U) / slow_tmr_interval;
@@ -724,8 +814,7 @@ void tcp_slowtmr(struct tcp_pcb *pcb)
            be retransmitted). */
 #if TCP_QUEUE_OOSEQ
         if (pcb->ooseq != NULL && (u32_t)tcp_ticks - pcb->tmr >= pcb->rto * TCP_OOSEQ_TIMEOUT) {
-            tcp_segs_free(pcb, pcb->ooseq);
-            pcb->ooseq = NULL;
+            tcp_ooseq_free(pcb);
             LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: dropping OOSEQ queued data\n"));
         }
 #endif /* TCP_QUEUE_OOSEQ */
@@ -813,6 +902,14 @@ void tcp_fasttmr(struct tcp_pcb *pcb)
             }
         }
 
+#if LWIP_TCP_RACK_TLP
+        /* RACK reordering and Tail Loss Probe timers, the caller may serve
+         * them earlier, see tcp_rack_tlp_deadline() */
+        if (pcb && (pcb->rack_reo_timeout_us || pcb->tlp_timeout_us)) {
+            tcp_rack_tlp_tmr(pcb);
+        }
+#endif /* LWIP_TCP_RACK_TLP */
+
         /* send delayed ACKs */
         if (pcb && (pcb->flags & TF_ACK_DELAY)) {
             LWIP_DEBUGF(TCP_DEBUG, ("tcp_fasttmr: delayed ACK\n"));
@@ -820,6 +917,13 @@ void tcp_fasttmr(struct tcp_pcb *pcb)
             tcp_output(pcb);
             pcb->flags &= ~(TF_ACK_DELAY | TF_ACK_NOW);
         }
+
+#if TCP_CC_ALGO_MOD
+        /* send paced data which is due */
+        if (pcb && pcb->pacing_pending) {
+            tcp_output(pcb);
+        }
+#endif /* TCP_CC_ALGO_MOD */
     }
 }
 
@@ -906,6 +1010,170 @@ struct tcp_seg *tcp_seg_copy(struct tcp_pcb *pcb, struct tcp_seg *seg)
     pbuf_ref(cseg->p);
     return cseg;
 }
+
+/* The ooseq queue is a list ordered by sequence number. The same segments are
+ * indexed by a top-down splay tree keyed by seqno, so that the place of an
+ * out-of-order segment is found in O(log n) amortized. Segments on the queue
+ * never overlap, hence the key is unique.
+ */
+#define OOSEQ_SEQNO(seg) ((seg)->tcphdr->seqno)
+
+/**
+ * Splays the tree so that the node with the given seqno, or its predecessor or
+ * successor if there is no such node, becomes the root.
+ *
+ * @return the new root
+ */
+static struct tcp_seg *tcp_ooseq_splay(struct tcp_seg *root, u32_t seqno)
+{
+    struct tcp_seg head;
+    struct tcp_seg *l, *r, *y;
+
+    if (root == NULL) {
+        return NULL;
+    }
+    head.oos_left = head.oos_right = NULL;
+    l = r = &head;
+    for (;;) {
+        if (TCP_SEQ_LT(seqno, OOSEQ_SEQNO(root))) {
+            if (root->oos_left == NULL) {
+                break;
+            }
+            if (TCP_SEQ_LT(seqno, OOSEQ_SEQNO(root->oos_left))) {
+                /* Rotate right */
+                y = root->oos_left;
+                root->oos_left = y->oos_right;
+                y->oos_right = root;
+                root = y;
+                if (root->oos_left == NULL) {
+                    break;
+                }
+            }
+            /* Link right */
+            r->oos_left = root;
+            r = root;
+            root = root->oos_left;
+        } else if (TCP_SEQ_GT(seqno, OOSEQ_SEQNO(root))) {
+            if (root->oos_right == NULL) {
+                break;
+            }
+            if (TCP_SEQ_GT(seqno, OOSEQ_SEQNO(root->oos_right))) {
+                /* Rotate left */
+                y = root->oos_right;
+                root->oos_right = y->oos_left;
+                y->oos_left = root;
+                root = y;
+                if (root->oos_right == NULL) {
+                    break;
+                }
+            }
+            /* Link left */
+            l->oos_right = root;
+            l = root;
+            root = root->oos_right;
+        } else {
+            break;
+        }
+    }
+    /* Assemble */
+    l->oos_right = root->oos_left;
+    r->oos_left = root->oos_right;
+    root->oos_left = head.oos_right;
+    root->oos_right = head.oos_left;
+    return root;
+}
+
+/**
+ * Finds the ooseq segment with the highest seqno that is not above the given
+ * one.
+ *
+ * @param pcb tcp_pcb
+ * @param seqno sequence number to look up
+ * @return the segment or NULL if all the segments start above seqno
+ */
+struct tcp_seg *tcp_ooseq_lookup(struct tcp_pcb *pcb, u32_t seqno)
+{
+    struct tcp_seg *seg;
+
+    pcb->ooseq_root = tcp_ooseq_splay(pcb->ooseq_root, seqno);
+    seg = pcb->ooseq_root;
+    if (seg != NULL && TCP_SEQ_GT(OOSEQ_SEQNO(seg), seqno)) {
+        /* The root is the successor, take the rightmost node on its left */
+        seg = seg->oos_left;
+        while (seg != NULL && seg->oos_right != NULL) {
+            seg = seg->oos_right;
+        }
+    }
+    return seg;
+}
+
+/**
+ * Puts a segment on the ooseq queue right after prev (or first if prev is
+ * NULL). The caller guarantees the order.
+ */
+void tcp_ooseq_link(struct tcp_pcb *pcb, struct tcp_seg *prev, struct tcp_seg *seg)
+{
+    struct tcp_seg **link = (prev != NULL) ? &prev->next : &pcb->ooseq;
+    struct tcp_seg *root = tcp_ooseq_splay(pcb->ooseq_root, OOSEQ_SEQNO(seg));
+
+    seg->next = *link;
+    *link = seg;
+
+    if (root == NULL) {
+        seg->oos_left = seg->oos_right = NULL;
+    } else if (TCP_SEQ_LT(OOSEQ_SEQNO(seg), OOSEQ_SEQNO(root))) {
+        seg->oos_left = root->oos_left;
+        seg->oos_right = root;
+        root->oos_left = NULL;
+    } else {
+        seg->oos_right = root->oos_right;
+        seg->oos_left = root;
+        root->oos_right = NULL;
+    }
+    pcb->ooseq_root = seg;
+    pcb->ooseq_bytes += seg->len;
+}
+
+/**
+ * Removes a segment from the ooseq queue. The segment is not freed.
+ *
+ * @param prev the segment preceding seg on the queue or NULL if seg is first
+ */
+void tcp_ooseq_unlink(struct tcp_pcb *pcb, struct tcp_seg *prev, struct tcp_seg *seg)
+{
+    struct tcp_seg *root = tcp_ooseq_splay(pcb->ooseq_root, OOSEQ_SEQNO(seg));
+
+    LWIP_ASSERT("tcp_ooseq_unlink: segment is not on the queue", root == seg);
+    LWIP_ASSERT("tcp_ooseq_unlink: wrong predecessor",
+                (prev != NULL ? prev->next : pcb->ooseq) == seg);
+
+    if (prev != NULL) {
+        prev->next = seg->next;
+    } else {
+        pcb->ooseq = seg->next;
+    }
+    seg->next = NULL;
+
+    if (root->oos_left == NULL) {
+        pcb->ooseq_root = root->oos_right;
+    } else {
+        /* All the keys on the left are smaller, so the maximum becomes the root */
+        pcb->ooseq_root = tcp_ooseq_splay(root->oos_left, OOSEQ_SEQNO(seg));
+        pcb->ooseq_root->oos_right = root->oos_right;
+    }
+    pcb->ooseq_bytes -= seg->len;
+}
+
+/**
+ * Frees all the segments on the ooseq queue.
+ */
+void tcp_ooseq_free(struct tcp_pcb *pcb)
+{
+    tcp_segs_free(pcb, pcb->ooseq);
+    pcb->ooseq = NULL;
+    pcb->ooseq_root = NULL;
+    pcb->ooseq_bytes = 0;
+}
 #endif /* TCP_QUEUE_OOSEQ */
 
 /**
@@ -924,6 +1192,102 @@ err_t tcp_recv_null(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
     return ERR_OK;
 }
 
+#if TCP_CC_ALGO_MOD
+/**
+ * Reset the delivery rate sampler of a pcb.
+ */
+void tcp_rate_reset(struct tcp_pcb *pcb)
+{
+    pcb->delivered = 0;
+    pcb->delivered_us = 0;
+    pcb->rs_tx_us = 0;
+    pcb->rs_prior_delivered = 0;
+    pcb->rs_prior_us = 0;
+    pcb->rs_seq = 0;
+    pcb->rs_armed = 0;
+    pcb->rs_app_limited = 0;
+    pcb->pacing_rate = 0;
+    pcb->pacing_next_us = 0;
+    pcb->pacing_pending = 0;
+}
+
+/**
+ * Arm a delivery rate sample when new data is sent. Like the RTT estimation,
+ * only one segment is sampled at a time and the sample is dropped if that
+ * segment is retransmitted (Karn's algorithm).
+ *
+ * @param pcb the tcp_pcb sending the segment
+ * @param seg the segment about to be sent
+ */
+void tcp_rate_on_send(struct tcp_pcb *pcb, struct tcp_seg *seg)
+{
+    u64_t now;
+
+    if (TCP_SEQ_LT(seg->seqno, pcb->snd_nxt)) {
+        if (pcb->rs_armed && TCP_SEQ_LT(seg->seqno, pcb->rs_seq) &&
+            TCP_SEQ_GEQ(seg->seqno + TCP_TCPLEN(seg), pcb->rs_seq)) {
+            pcb->rs_armed = 0;
+        }
+        return;
+    }
+    if (pcb->rs_armed || seg->len == 0) {
+        return;
+    }
+
+    now = sys_now_us();
+    if (pcb->snd_nxt == pcb->lastack) {
+        /* Nothing is in flight, start the delivery interval from now rather than
+           from the end of the previous transfer. */
+        pcb->delivered_us = now;
+    }
+    pcb->rs_armed = 1;
+    pcb->rs_seq = seg->seqno + TCP_TCPLEN(seg);
+    pcb->rs_tx_us = now;
+    pcb->rs_prior_delivered = pcb->delivered;
+    pcb->rs_prior_us = pcb->delivered_us;
+    /* The sender is application limited if this segment drains the send buffer
+       while there is still room in the congestion window. */
+    pcb->rs_app_limited =
+        TCP_SEQ_GEQ(pcb->rs_seq, pcb->snd_lbb) && (pcb->rs_seq - pcb->lastack) < pcb->cwnd;
+}
+
+/**
+ * Account newly acknowledged data and pass a delivery rate sample to the
+ * congestion control algorithm once the sampled segment is acknowledged.
+ *
+ * @param pcb the tcp_pcb which received the ACK, pcb->acked holds the number of
+ *        newly acknowledged bytes
+ * @param ackno the acknowledgement number of the received ACK
+ */
+void tcp_rate_on_ack(struct tcp_pcb *pcb, u32_t ackno)
+{
+    struct tcp_rate_sample rs;
+    u64_t now = sys_now_us();
+
+    pcb->delivered += pcb->acked;
+    pcb->delivered_us = now;
+
+    if (!pcb->rs_armed || TCP_SEQ_LT(ackno, pcb->rs_seq)) {
+        return;
+    }
+    pcb->rs_armed = 0;
+
+    rs.delivered = pcb->delivered - pcb->rs_prior_delivered;
+    rs.interval_us = now - pcb->rs_prior_us;
+    rs.rtt_us = now - pcb->rs_tx_us;
+    rs.is_app_limited = pcb->rs_app_limited;
+    if (rs.interval_us == 0) {
+        rs.interval_us = 1;
+    }
+
+    LWIP_DEBUGF(TCP_CWND_DEBUG,
+                ("tcp_rate_on_ack: delivered %" U32_F " in %" U32_F " usec, rtt %" U32_F
+                 " usec\n",
+                 (u32_t)rs.delivered, (u32_t)rs.interval_us, (u32_t)rs.rtt_us));
+    cc_rate_sample(pcb, &rs);
+}
+#endif /* TCP_CC_ALGO_MOD */
+
 void tcp_pcb_init(struct tcp_pcb *pcb, u8_t prio, void *container)
 {
     u32_t iss;
@@ -962,11 +1326,18 @@ void tcp_pcb_init(struct tcp_pcb *pcb, u8_t prio, void *container)
     case CC_MOD_NONE:
         pcb->cc_algo = &none_cc_algo;
         break;
+    case CC_MOD_BBR:
+        pcb->cc_algo = &bbr_cc_algo;
+        break;
+    case CC_MOD_DCTCP:
+        pcb->cc_algo = &dctcp_cc_algo;
+        break;
     case CC_MOD_LWIP:
     default:
         pcb->cc_algo = &lwip_cc_algo;
         break;
     }
+    tcp_rate_reset(pcb);
     cc_init(pcb);
 #endif
     pcb->cwnd = 1;
@@ -994,6 +1365,11 @@ void tcp_pcb_init(struct tcp_pcb *pcb, u8_t prio, void *container)
     pcb->quickack = 0;
     pcb->is_in_input = 0;
     pcb->enable_ts_opt = enable_ts_option;
+#if LWIP_TCP_SACK
+    pcb->enable_sack_opt = enable_sack_option;
+#endif
+    pcb->enable_ecn = enable_ecn_option;
+    pcb->ecn_ece = 0;
     pcb->seg_alloc = NULL;
     pcb->pbuf_alloc = NULL;
 }
@@ -1018,6 +1394,7 @@ void tcp_pcb_recycle(struct tcp_pcb *pcb)
     pcb->dupacks = 0;
     pcb->rtime = -1;
 #if TCP_CC_ALGO_MOD
+    tcp_rate_reset(pcb);
     cc_init(pcb);
 #endif
     pcb->cwnd = 1;
@@ -1042,6 +1419,22 @@ void tcp_pcb_recycle(struct tcp_pcb *pcb)
     pcb->last_unsent = NULL;
     pcb->last_unacked = NULL;
     pcb->unsent_oversize = 0;
+#if LWIP_TCP_SACK
+    pcb->sack_sb_cnt = 0;
+    pcb->sack_bytes = 0;
+#endif
+#if LWIP_TCP_RACK_TLP
+    pcb->rack_xmit_us = 0;
+    pcb->rack_end_seq = 0;
+    pcb->rack_rtt_us = 0;
+    pcb->rack_min_rtt_us = 0;
+    pcb->rack_srtt_us = 0;
+    pcb->rack_reo_timeout_us = 0;
+    pcb->tlp_timeout_us = 0;
+    pcb->tlp_outstanding = 0;
+    pcb->tlp_is_retrans = 0;
+#endif /* LWIP_TCP_RACK_TLP */
+    pcb->fastopen.len = 0;
     if (pcb->seg_alloc != NULL) {
         tcp_tx_seg_free(pcb, pcb->seg_alloc);
         pcb->seg_alloc = NULL;
@@ -1249,13 +1642,16 @@ void tcp_pcb_purge(struct tcp_pcb *pcb)
         if (pcb->ooseq != NULL) {
             LWIP_DEBUGF(TCP_DEBUG, ("tcp_pcb_purge: data left on ->ooseq\n"));
         }
-        tcp_segs_free(pcb, pcb->ooseq);
-        pcb->ooseq = NULL;
+        tcp_ooseq_free(pcb);
 #endif /* TCP_QUEUE_OOSEQ */
 
         /* Stop the retransmission timer as it will expect data on unacked
            queue if it fires */
         pcb->rtime = -1;
+#if LWIP_TCP_RACK_TLP
+        pcb->rack_reo_timeout_us = 0;
+        pcb->tlp_timeout_us = 0;
+#endif /* LWIP_TCP_RACK_TLP */
 
         tcp_tx_segs_free(pcb, pcb->unsent);
         tcp_tx_segs_free(pcb, pcb->unacked);
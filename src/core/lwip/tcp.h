@@ -46,11 +46,15 @@ extern "C" {
 typedef u32_t (*sys_now_fn)(void);
 void register_sys_now(sys_now_fn fn);
 
+typedef u64_t (*sys_now_us_fn)(void);
+void register_sys_now_us(sys_now_us_fn fn);
+
 #define LWIP_MEM_ALIGN_SIZE(size) (((size) + MEM_ALIGNMENT - 1) & ~(MEM_ALIGNMENT - 1))
 
 extern u16_t lwip_tcp_mss;
 extern u32_t lwip_tcp_snd_buf;
 extern u32_t lwip_zc_tx_size;
+extern u32_t lwip_tcp_pacing_horizon_us;
 
 struct tcp_seg;
 typedef err_t (*ip_output_fn)(struct pbuf *p, struct tcp_seg *seg, void *p_conn, u16_t flags);
@@ -226,6 +230,45 @@ extern tcp_state_observer_fn external_tcp_state_observer;
     (pcb)->max_unsent_len = (16 * ((pcb)->max_snd_buff) / ((pcb)->mss));                           \
     (pcb)->tcp_oversize_val = (pcb)->mss;
 
+#if LWIP_TCP_SACK
+/* A range of sequence space [left, right) reported by a SACK option */
+struct tcp_sack_block {
+    u32_t left;
+    u32_t right;
+};
+#endif /* LWIP_TCP_SACK */
+
+/* Connection parameters recovered from a valid SYN cookie. The listener which sent the
+ * cookie has no SYN_RCVD pcb, so the final ACK of the handshake creates it. */
+struct tcp_syncookie {
+    u32_t iss; /* our ISN, i.e. the cookie */
+    u16_t mss; /* MSS of the peer */
+#define TCP_SYNCOOKIE_NO_WSCALE 0x0FU
+    u8_t snd_scale; /* window scale of the peer or TCP_SYNCOOKIE_NO_WSCALE */
+    u8_t sack; /* SACK permitted */
+    u8_t ts; /* timestamps negotiated */
+};
+
+/* TCP Fast Open cookie (RFC 7413). The RFC allows up to 16 bytes, 12 is the most which fits
+ * the SYN next to the MSS, window scale, SACK permitted and timestamp options. */
+#define TCP_FASTOPEN_COOKIE_MIN 4U
+#define TCP_FASTOPEN_COOKIE_MAX 12U
+struct tcp_fastopen {
+    u8_t len; /* 0 for an empty option, i.e. a cookie request */
+    u8_t cookie[TCP_FASTOPEN_COOKIE_MAX];
+};
+
+/* ECN modes of a pcb, as in net.ipv4.tcp_ecn */
+#define TCP_ECN_OFF     0U /* ECN is not used */
+#define TCP_ECN_ENABLE  1U /* request ECN in SYN and accept it in SYN-ACK */
+#define TCP_ECN_PASSIVE 2U /* accept ECN only when requested by the peer */
+
+/* Verdict of the owner on a SYN with the Fast Open option received by a listen pcb */
+struct tcp_fastopen_syn {
+    struct tcp_fastopen cookie; /* cookie for the SYN-ACK, len 0 if none is sent */
+    u8_t accept_data; /* the SYN carries a valid cookie, its data is accepted */
+};
+
 /* the TCP protocol control block */
 struct tcp_pcb {
     /** IP specific PCB members */
@@ -276,6 +319,15 @@ struct tcp_pcb {
 #define TF_NAGLEMEMERR                                                                             \
     ((u16_t)0x0080U) /* nagle enabled, memerr, try to output to prevent delayed ACK to happen */
 #define TF_WND_SCALE ((u16_t)0x0100U) /* Window Scale option enabled */
+#define TF_SACK      ((u16_t)0x0200U) /* Selective ACK option enabled */
+#define TF_FASTOPEN  ((u16_t)0x0400U) /* Fast Open option is sent in SYN or SYN-ACK */
+#define TF_FASTOPEN_COOKIE                                                                         \
+    ((u16_t)0x0800U) /* fastopen holds the cookie received in SYN-ACK */
+#define TF_FASTOPEN_DATA                                                                           \
+    ((u16_t)0x1000U) /* data in SYN was acknowledged (client) or accepted (server) */
+#define TF_ECN      ((u16_t)0x2000U) /* ECN negotiated */
+#define TF_ECN_ECHO ((u16_t)0x4000U) /* Set ECE in outgoing segments */
+#define TF_ECN_CWR  ((u16_t)0x8000U) /* Set CWR in the next new data segment */
 
     /* the rest of the fields are in host byte order
        as we have to do some math with them */
@@ -314,6 +366,20 @@ struct tcp_pcb {
 #if TCP_CC_ALGO_MOD
     struct cc_algo *cc_algo;
     void *cc_data;
+    /* Delivery rate sampling, used only by algorithms with the rate_sample() hook */
+    u64_t delivered; /* total number of bytes cumulatively acknowledged */
+    u64_t delivered_us; /* time of the last delivered update in usec */
+    u64_t rs_tx_us; /* send time of the sequence number being sampled */
+    u64_t rs_prior_delivered; /* delivered at the time the sample was armed */
+    u64_t rs_prior_us; /* delivered_us at the time the sample was armed */
+    u32_t rs_seq; /* end sequence number being sampled */
+    u8_t rs_armed; /* a sample is in flight */
+    u8_t rs_app_limited; /* the sample was armed while the sender was application limited */
+    u64_t pacing_rate; /* pacing rate requested by the algorithm in bytes/sec, 0 - unpaced */
+    /* Software pacing */
+    u64_t max_pacing_rate; /* pacing rate limit set by the user in bytes/sec, 0 - no limit */
+    u64_t pacing_next_us; /* earliest departure time of the next segment */
+    u8_t pacing_pending; /* unsent data is held back until its departure time */
 #endif
     u32_t cwnd;
     u32_t ssthresh;
@@ -351,6 +417,8 @@ struct tcp_pcb {
     struct tcp_seg *last_unacked; /* Last element in unacknowledged segments list. */
 #if TCP_QUEUE_OOSEQ
     struct tcp_seg *ooseq; /* Received out of sequence segments. */
+    struct tcp_seg *ooseq_root; /* Root of the splay tree indexing ooseq by seqno */
+    u32_t ooseq_bytes; /* Number of data bytes held on ooseq */
 #endif /* TCP_QUEUE_OOSEQ */
 
     struct pbuf *refused_data; /* Data previously received but not yet taken by upper layer */
@@ -372,6 +440,43 @@ struct tcp_pcb {
     u32_t ts_recent;
 #endif /* LWIP_TCP_TIMESTAMPS */
 
+#if LWIP_TCP_SACK
+    u8_t enable_sack_opt;
+    /* Receiver: seqno of the most recent out-of-sequence segment, reported in the first block */
+    u32_t sack_recent;
+    /* Sender scoreboard: SACKed ranges above lastack, sorted and merged */
+    struct tcp_sack_block sack_sb[TCP_SACK_SB_MAX];
+    u8_t sack_sb_cnt;
+    u32_t sack_bytes; /* total number of bytes covered by the scoreboard */
+    u32_t recovery_point; /* snd_nxt when loss recovery was entered (RecoveryPoint) */
+    u32_t high_rxt; /* highest seqno retransmitted during loss recovery (HighRxt) */
+#endif /* LWIP_TCP_SACK */
+
+#if LWIP_TCP_RACK_TLP
+    /* RACK (RFC 8985): the most recently sent segment which has been delivered */
+    u64_t rack_xmit_us; /* its transmit time (RACK.xmit_ts) */
+    u32_t rack_end_seq; /* its end sequence number (RACK.end_seq) */
+    u32_t rack_rtt_us; /* RTT measured on it (RACK.rtt) */
+    u32_t rack_min_rtt_us; /* minimum RTT, sets the reordering window */
+    u32_t rack_srtt_us; /* smoothed RTT in usec, sets the probe timeout */
+    u64_t rack_reo_timeout_us; /* deadline of the reordering timer, 0 - not armed */
+    /* Tail Loss Probe */
+    u64_t tlp_timeout_us; /* deadline of the probe timer, 0 - not armed */
+    u32_t tlp_high_seq; /* snd_nxt when the probe was sent (TLP.end_seq) */
+    u8_t tlp_outstanding; /* a probe has been sent and its episode is not over */
+    u8_t tlp_is_retrans; /* the outstanding probe is a retransmission */
+    /* Loss recovery counters */
+    u32_t stat_rto; /* retransmission timeouts */
+    u32_t stat_tlp_probes; /* probes sent */
+    u32_t stat_tlp_recoveries; /* tail losses repaired by a probe */
+    u32_t stat_rack_lost; /* segments marked lost by RACK */
+#endif /* LWIP_TCP_RACK_TLP */
+
+    /* ECN (RFC 3168) */
+    u8_t enable_ecn; /* TCP_ECN_OFF, TCP_ECN_ENABLE or TCP_ECN_PASSIVE */
+    u8_t ecn_ece; /* the ACK being processed carries ECE, for the congestion control */
+    u32_t ecn_recover; /* snd_nxt when cwnd was last reduced in response to ECE */
+
     /* idle time before KEEPALIVE is sent */
     u32_t keep_idle;
 #if LWIP_TCP_KEEPALIVE
@@ -393,6 +498,14 @@ struct tcp_pcb {
     tcp_syn_handled_fn syn_handled_cb;
     tcp_clone_conn_fn clone_conn;
     tcp_accepted_pcb_fn accepted_pcb;
+    /* Listen pcb only: set by the owner before L3_level_tcp_input() when the segment
+     * is an ACK which carries a valid SYN cookie. Consumed by L3_level_tcp_input(). */
+    struct tcp_syncookie *syncookie;
+    /* Listen pcb only: set by the owner before L3_level_tcp_input() when the segment
+     * is a SYN with the Fast Open option. Consumed by L3_level_tcp_input(). */
+    struct tcp_fastopen_syn *fastopen_syn;
+    /* Fast Open cookie sent in SYN or SYN-ACK, see TF_FASTOPEN */
+    struct tcp_fastopen fastopen;
 
     /* Delayed ACK control: number of quick acks */
     u8_t quickack;
@@ -456,6 +569,8 @@ void tcp_recved(struct tcp_pcb *pcb, u32_t len);
 err_t tcp_bind(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6);
 err_t tcp_connect(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
                   tcp_connected_fn connected);
+err_t tcp_connect_fastopen(struct tcp_pcb *pcb, const ip_addr_t *ipaddr, u16_t port, bool is_ipv6,
+                           tcp_connected_fn connected, const void *data, u32_t *len);
 
 err_t tcp_listen(struct tcp_pcb *listen_pcb, struct tcp_pcb *conn_pcb);
 
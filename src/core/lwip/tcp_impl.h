@@ -52,6 +52,9 @@ void tcp_tmr(struct tcp_pcb *pcb); /* Must be called every (slow_tmr_interval /
    intervals (instead of calling tcp_tmr()). */
 void tcp_slowtmr(struct tcp_pcb *pcb);
 void tcp_fasttmr(struct tcp_pcb *pcb);
+/* Returns when tcp_tmr() has work to do for the pcb. */
+#define TCP_TMR_NONE 0xFFFFFFFFU
+u32_t tcp_tmr_next(struct tcp_pcb *pcb);
 
 void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb);
 
@@ -67,8 +70,25 @@ void tcp_split_segment(struct tcp_pcb *pcb, struct tcp_seg *seg, u32_t wnd);
 void tcp_rexmit(struct tcp_pcb *pcb);
 void tcp_rexmit_rto(struct tcp_pcb *pcb);
 void tcp_rexmit_fast(struct tcp_pcb *pcb);
+#if LWIP_TCP_SACK
+void tcp_sack_rexmit(struct tcp_pcb *pcb);
+u8_t tcp_sack_is_lost(struct tcp_pcb *pcb, u32_t seqno);
+#endif /* LWIP_TCP_SACK */
+#if LWIP_TCP_RACK_TLP
+void tcp_rack_update(struct tcp_pcb *pcb, struct tcp_seg *seg, u64_t now);
+u8_t tcp_rack_detect_loss(struct tcp_pcb *pcb, u64_t now);
+void tcp_rack_enter_recovery(struct tcp_pcb *pcb);
+void tcp_tlp_schedule(struct tcp_pcb *pcb, u64_t now);
+u64_t tcp_rack_tlp_deadline(const struct tcp_pcb *pcb);
+void tcp_rack_tlp_tmr(struct tcp_pcb *pcb);
+#endif /* LWIP_TCP_RACK_TLP */
 u32_t tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb);
 void set_tmr_resolution(u32_t v);
+#if TCP_CC_ALGO_MOD
+void tcp_rate_reset(struct tcp_pcb *pcb);
+void tcp_rate_on_send(struct tcp_pcb *pcb, struct tcp_seg *seg);
+void tcp_rate_on_ack(struct tcp_pcb *pcb, u32_t ackno);
+#endif /* TCP_CC_ALGO_MOD */
 
 #if defined(__GNUC__) && (((__GNUC__ == 4) && (__GNUC_MINOR__ >= 4)) || (__GNUC__ > 4))
 #pragma GCC visibility pop
@@ -111,6 +131,12 @@ void set_tmr_resolution(u32_t v);
 #define TCP_CWR                  0x80U
 
 #define TCP_FLAGS 0x3fU
+/* ECN flags are not part of TCP_FLAGS, the state machine ignores them */
+#define TCP_ECN_FLAGS (TCP_ECE | TCP_CWR)
+
+/* ECN field of the IP header (RFC 3168) */
+#define IP_ECN_MASK 0x03U
+#define IP_ECN_CE   0x03U
 
 /* Length of the TCP header, excluding options. */
 #ifndef TCP_HLEN
@@ -160,6 +186,7 @@ PACK_STRUCT_END
 #define TCPH_OFFSET(phdr) (ntohs((phdr)->_hdrlen_rsvd_flags) >> 8)
 #define TCPH_HDRLEN(phdr) (ntohs((phdr)->_hdrlen_rsvd_flags) >> 12)
 #define TCPH_FLAGS(phdr)  (ntohs((phdr)->_hdrlen_rsvd_flags) & TCP_FLAGS)
+#define TCPH_ECN_FLAGS(phdr) (ntohs((phdr)->_hdrlen_rsvd_flags) & TCP_ECN_FLAGS)
 
 #define TCPH_OFFSET_SET(phdr, offset)                                                              \
     (phdr)->_hdrlen_rsvd_flags = htons(((offset) << 8) | TCPH_FLAGS(phdr))
@@ -270,6 +297,11 @@ struct tcp_seg {
 
     u32_t seqno;
     u32_t len; /* the TCP length of this segment should allow >64K size */
+#if TCP_QUEUE_OOSEQ
+    /* Splay tree links, used only while the segment is on the ooseq queue */
+    struct tcp_seg *oos_left;
+    struct tcp_seg *oos_right;
+#endif /* TCP_QUEUE_OOSEQ */
 
 #if TCP_OVERSIZE_DBGCHECK
     u16_t oversize_left; /* Extra bytes available at the end of the last
@@ -279,11 +311,19 @@ struct tcp_seg {
     u8_t flags;
 #define TF_SEG_OPTS_MSS       (u8_t)0x01U /* Include MSS option. */
 #define TF_SEG_OPTS_TS        (u8_t)0x02U /* Include timestamp option. */
+#define TF_SEG_OPTS_SACK_PERM (u8_t)0x04U /* Include SACK permitted option. */
 #define TF_SEG_OPTS_WNDSCALE  (u8_t)0x08U /* Include window scaling option */
 #define TF_SEG_OPTS_DUMMY_MSG (u8_t) TCP_WRITE_DUMMY /* Include dummy send option */
 #define TF_SEG_OPTS_TSO       (u8_t) TCP_WRITE_TSO /* Use TSO send mode */
 #define TF_SEG_OPTS_NOMERGE   (u8_t)0x40U /* Don't merge with other segments */
 #define TF_SEG_OPTS_ZEROCOPY  (u8_t) TCP_WRITE_ZEROCOPY /* Use zerocopy send mode */
+#if LWIP_TCP_RACK_TLP
+    u8_t rack_flags;
+#define TF_SEG_RACK_REXMIT    (u8_t)0x01U /* The segment has been retransmitted */
+#define TF_SEG_RACK_LOST      (u8_t)0x02U /* Marked lost by RACK, not retransmitted yet */
+#define TF_SEG_RACK_DELIVERED (u8_t)0x04U /* SACKed and already taken into account by RACK */
+    u64_t xmit_us; /* Time of the most recent (re)transmission */
+#endif /* LWIP_TCP_RACK_TLP */
 
     /* L2+L3+TCP header for zerocopy segments, it must have enough room for options
        This should have enough space for L2 (ETH+vLAN), L3 (IPv4/6), L4 (TCP)
@@ -306,7 +346,19 @@ struct tcp_seg {
  */
 #define LWIP_TCP_OPT_LENGTH(flags)                                                                 \
     (flags & TF_SEG_OPTS_MSS ? 4 : 0) + (flags & TF_SEG_OPTS_WNDSCALE ? 1 + 3 : 0) +               \
-        (flags & TF_SEG_OPTS_TS ? 12 : 0)
+        (flags & TF_SEG_OPTS_SACK_PERM ? 2 + 2 : 0) + (flags & TF_SEG_OPTS_TS ? 12 : 0)
+
+/* Length of a Fast Open option with a cookie of n bytes, including NOP bytes for alignment */
+#define LWIP_TCP_OPT_LEN_FASTOPEN(n) ((2U + (n) + 3U) & ~3U)
+
+#if LWIP_TCP_SACK
+/* Maximum number of SACK blocks in a single option (40 bytes of option space) */
+#define TCP_SACK_BLOCKS_MAX 4
+/* Length of a SACK option with n blocks, including two NOP bytes for alignment */
+#define LWIP_TCP_SACK_OPT_LEN(n) ((n) ? 2 + 2 + 8 * (n) : 0)
+/* RFC 6675 DupThresh */
+#define TCP_SACK_DUPTHRESH 3
+#endif /* LWIP_TCP_SACK */
 
 /* This macro calculates total length of tcp header including
  * additional options
@@ -322,15 +374,44 @@ struct tcp_seg {
 #define TCP_BUILD_WNDSCALE_OPTION(x, scale)                                                        \
     (x) = PP_HTONL((((u32_t)1 << 24) | ((u32_t)3 << 16) | ((u32_t)3 << 8)) | ((u32_t)scale))
 
+/** This returns a TCP header option for SACK PERMITTED in an u32_t, prefixed by two NOOPs */
+#define TCP_BUILD_SACK_PERM_OPTION(x)                                                              \
+    (x) = PP_HTONL(((u32_t)1 << 24) | ((u32_t)1 << 16) | ((u32_t)4 << 8) | (u32_t)2)
+
 /* Global variables: */
 extern struct tcp_pcb *tcp_input_pcb;
 extern int32_t enable_wnd_scale;
 extern u32_t rcv_wnd_scale;
 extern u8_t enable_push_flag;
 extern u8_t enable_ts_option;
+extern u8_t enable_sack_option;
+extern u8_t enable_ecn_option;
+extern u8_t enable_rack_tlp_option;
 extern u32_t tcp_ticks;
+extern sys_now_us_fn sys_now_us;
 extern ip_route_mtu_fn external_ip_route_mtu;
 
+/* ECN mode of a pcb, an algorithm which relies on ECN enables it regardless of the
+ * configuration. TCP_ECN_ECHO_CE() selects the DCTCP receiver (RFC 8257) which echoes
+ * the CE mark of each segment instead of latching ECE until CWR. */
+#if TCP_CC_ALGO_MOD
+#define TCP_ECN_MODE(pcb)                                                                          \
+    (((pcb)->cc_algo->flags & CC_F_ECN) ? TCP_ECN_ENABLE : (pcb)->enable_ecn)
+#define TCP_ECN_ECHO_CE(pcb) ((pcb)->cc_algo->flags & CC_F_ECN_ECHO)
+#else
+#define TCP_ECN_MODE(pcb)    ((pcb)->enable_ecn)
+#define TCP_ECN_ECHO_CE(pcb) 0
+#endif /* TCP_CC_ALGO_MOD */
+
+/* RACK-TLP relies on the SACK scoreboard, so it is used only when SACK is negotiated. */
+#if LWIP_TCP_RACK_TLP
+#define TCP_RACK_ENABLED(pcb)  (enable_rack_tlp_option && ((pcb)->flags & TF_SACK))
+#define TCP_SEG_RACK_LOST(seg) ((seg)->rack_flags & TF_SEG_RACK_LOST)
+#else
+#define TCP_RACK_ENABLED(pcb)  0
+#define TCP_SEG_RACK_LOST(seg) 0
+#endif /* LWIP_TCP_RACK_TLP */
+
 #if defined(__GNUC__) && (((__GNUC__ == 4) && (__GNUC_MINOR__ >= 4)) || (__GNUC__ > 4))
 #pragma GCC visibility push(hidden)
 #endif
@@ -344,6 +425,10 @@ void tcp_seg_free(struct tcp_pcb *pcb, struct tcp_seg *seg);
 void tcp_tx_segs_free(struct tcp_pcb *pcb, struct tcp_seg *seg);
 void tcp_tx_seg_free(struct tcp_pcb *pcb, struct tcp_seg *seg);
 struct tcp_seg *tcp_seg_copy(struct tcp_pcb *pcb, struct tcp_seg *seg);
+struct tcp_seg *tcp_ooseq_lookup(struct tcp_pcb *pcb, u32_t seqno);
+void tcp_ooseq_link(struct tcp_pcb *pcb, struct tcp_seg *prev, struct tcp_seg *seg);
+void tcp_ooseq_unlink(struct tcp_pcb *pcb, struct tcp_seg *prev, struct tcp_seg *seg);
+void tcp_ooseq_free(struct tcp_pcb *pcb);
 
 #define tcp_ack(pcb)                                                                               \
     do {                                                                                           \
@@ -362,6 +447,8 @@ struct tcp_seg *tcp_seg_copy(struct tcp_pcb *pcb, struct tcp_seg *seg);
 
 err_t tcp_send_fin(struct tcp_pcb *pcb);
 err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags);
+err_t tcp_enqueue_syn_data(struct tcp_pcb *pcb, const void *data, u32_t *len);
+err_t tcp_fastopen_rexmit(struct tcp_pcb *pcb, struct tcp_seg *syn);
 
 void tcp_rst(u32_t seqno, u32_t ackno, u16_t local_port, u16_t remote_port, struct tcp_pcb *pcb);
 
@@ -53,6 +53,7 @@ typedef struct parsed_ip_hdr {
     bool is_ipv6;
     s16_t header_length;
     u16_t total_length;
+    u8_t ecn;
     const void *src, *dest;
 } parsed_ip_hdr_t;
 
@@ -65,7 +66,12 @@ typedef struct tcp_in_data {
     struct tcp_seg inseg;
     u16_t tcplen;
     u8_t flags;
+    u8_t ecn_flags;
     u8_t recv_flags;
+#if LWIP_TCP_SACK
+    struct tcp_sack_block sack[TCP_SACK_BLOCKS_MAX];
+    u8_t sack_cnt;
+#endif /* LWIP_TCP_SACK */
 } tcp_in_data;
 
 /* Forward declarations. */
@@ -73,9 +79,23 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data);
 static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data);
 static bool tcp_parseopt_ts(u8_t *opts, u16_t opts_len, u32_t *tsval);
 static void tcp_parseopt(struct tcp_pcb *pcb, tcp_in_data *in_data);
-
-static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data);
+#if LWIP_TCP_SACK
+static void tcp_sack_update(struct tcp_pcb *pcb, tcp_in_data *in_data);
+#endif /* LWIP_TCP_SACK */
+#if LWIP_TCP_RACK_TLP
+static void tcp_tlp_ack(struct tcp_pcb *pcb, tcp_in_data *in_data, int dupack);
+#endif /* LWIP_TCP_RACK_TLP */
+
+static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data,
+                             const struct tcp_fastopen_syn *fastopen_syn);
+static void tcp_fastopen_accept(struct tcp_pcb *npcb, tcp_in_data *in_data);
+static struct tcp_pcb *tcp_syncookie_input(struct tcp_pcb *pcb,
+                                           const struct tcp_syncookie *cookie,
+                                           tcp_in_data *in_data);
 static err_t tcp_timewait_input(struct tcp_pcb *pcb, tcp_in_data *in_data);
+static void tcp_ecn_syn_input(struct tcp_pcb *pcb, tcp_in_data *in_data);
+static void tcp_ecn_input(struct tcp_pcb *pcb, tcp_in_data *in_data);
+static void tcp_ecn_ack(struct tcp_pcb *pcb, tcp_in_data *in_data);
 static s8_t tcp_quickack(struct tcp_pcb *pcb, tcp_in_data *in_data);
 
 /**
@@ -104,11 +124,13 @@ static inline void fill_parsed_ip_hdr(const void *payload, parsed_ip_hdr_t *iphd
         iphdr->dest = (void *)&view_8bit[24];
         iphdr->header_length = 40;
         iphdr->total_length = ntohs(view_16bit[2U]) + iphdr->header_length;
+        iphdr->ecn = (view_8bit[1] >> 4U) & IP_ECN_MASK;
     } else {
         iphdr->src = (const void *)&view_8bit[12];
         iphdr->dest = (const void *)&view_8bit[16];
         iphdr->header_length = ((view_8bit[0] & 0x0f) * 4);
         iphdr->total_length = ntohs(view_16bit[1U]);
+        iphdr->ecn = view_8bit[1] & IP_ECN_MASK;
     }
 }
 
@@ -117,6 +139,24 @@ void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb)
     u8_t hdrlen;
     err_t err;
     tcp_in_data in_data;
+    struct tcp_pcb *lpcb = NULL;
+    const struct tcp_syncookie *syncookie = NULL;
+    const struct tcp_fastopen_syn *fastopen_syn = NULL;
+    struct tcp_syncookie syncookie_copy;
+    struct tcp_fastopen_syn fastopen_syn_copy;
+
+    /* The cookie and the Fast Open verdict are valid for this segment only. They are
+     * copied, because the owner of the listen pcb is unlocked while the pcb is cloned. */
+    if (pcb != NULL && pcb->syncookie != NULL) {
+        syncookie_copy = *pcb->syncookie;
+        syncookie = &syncookie_copy;
+        pcb->syncookie = NULL;
+    }
+    if (pcb != NULL && pcb->fastopen_syn != NULL) {
+        fastopen_syn_copy = *pcb->fastopen_syn;
+        fastopen_syn = &fastopen_syn_copy;
+        pcb->fastopen_syn = NULL;
+    }
 
     fill_parsed_ip_hdr(p->payload, &in_data.iphdr);
 
@@ -155,7 +195,22 @@ void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb)
     in_data.tcphdr->wnd = ntohs(in_data.tcphdr->wnd);
 
     in_data.flags = TCPH_FLAGS(in_data.tcphdr);
+    in_data.ecn_flags = TCPH_ECN_FLAGS(in_data.tcphdr);
     in_data.tcplen = p->tot_len + ((in_data.flags & (TCP_FIN | TCP_SYN)) ? 1 : 0);
+#if LWIP_TCP_SACK
+    in_data.sack_cnt = 0;
+#endif /* LWIP_TCP_SACK */
+
+    if (syncookie != NULL && PCB_IN_LISTEN_STATE(pcb)) {
+        /* The ACK completes a handshake which the listener answered with a SYN cookie.
+           Create the SYN_RCVD pcb now and let it process the segment. */
+        lpcb = pcb;
+        pcb = tcp_syncookie_input(lpcb, syncookie, &in_data);
+        if (pcb == NULL) {
+            pbuf_free(p);
+            return;
+        }
+    }
 
     if (pcb != NULL) {
 
@@ -202,6 +257,9 @@ void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb)
                 }
             }
             pcb->is_in_input = 1;
+            if (pcb->flags & TF_ECN) {
+                tcp_ecn_input(pcb, &in_data);
+            }
             err = tcp_process(pcb, &in_data);
             /* A return value of ERR_ABRT means that tcp_abort() was called
                and that the pcb has been freed. If so, we don't do anything. */
@@ -301,10 +359,18 @@ void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb)
                 pbuf_free(in_data.inseg.p);
                 in_data.inseg.p = NULL;
             }
+
+            if (lpcb != NULL) {
+                TCP_EVENT_ACCEPTED_PCB(lpcb, pcb);
+            }
         } else if (PCB_IN_LISTEN_STATE(pcb)) {
             LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for LISTENing connection.\n"));
-            tcp_listen_input(pcb, &in_data);
-            pbuf_free(p);
+            /* Data of a Fast Open SYN is passed to the new connection */
+            in_data.inseg.p = p;
+            tcp_listen_input(pcb, &in_data, fastopen_syn);
+            if (in_data.inseg.p != NULL) {
+                pbuf_free(in_data.inseg.p);
+            }
         } else if (PCB_IN_TIME_WAIT_STATE(pcb)) {
             LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for TIME_WAITing connection.\n"));
             tcp_timewait_input(pcb, &in_data);
@@ -331,14 +397,19 @@ void L3_level_tcp_input(struct pbuf *p, struct tcp_pcb *pcb)
  * connection (from L3_level_tcp_input()).
  *
  * @param pcb the listen tcp_pcb for which a segment arrived
+ * @param fastopen_syn Fast Open verdict of the owner on the SYN or NULL
  * @return The new pcb if there is one. Otherwise, NULL.
  *
  * @note the segment which arrived is saved in global variables, therefore only the pcb
  *       involved is passed as a parameter to this function
+ * @note in_data->inseg.p is set to NULL if the data of the segment was passed to
+ *       the new pcb (TCP Fast Open)
  */
-static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
+static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data,
+                             const struct tcp_fastopen_syn *fastopen_syn)
 {
     struct tcp_pcb *npcb = NULL;
+    struct pbuf *p = in_data->inseg.p;
     err_t rc;
 
     if (in_data->flags & (TCP_RST | TCP_FIN)) {
@@ -393,12 +464,28 @@ static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
 
         /* Parse any options in the SYN. */
         tcp_parseopt(npcb, in_data);
+        tcp_ecn_syn_input(npcb, in_data);
 
         npcb->rcv_wnd = TCP_WND_SCALED(npcb);
         npcb->rcv_ann_wnd = TCP_WND_SCALED(npcb);
         npcb->rcv_wnd_max = TCP_WND_SCALED(npcb);
         npcb->rcv_wnd_max_desired = TCP_WND_SCALED(npcb);
 
+        if (fastopen_syn != NULL) {
+            if (fastopen_syn->cookie.len > 0) {
+                npcb->fastopen = fastopen_syn->cookie;
+                npcb->flags |= TF_FASTOPEN;
+            }
+            if (fastopen_syn->accept_data && p->tot_len > 0 && p->tot_len <= npcb->rcv_wnd) {
+                /* The SYN-ACK acknowledges the data */
+                npcb->rcv_nxt += p->tot_len;
+                npcb->rcv_ann_right_edge = npcb->rcv_nxt;
+                npcb->rcv_wnd -= p->tot_len;
+                npcb->rcv_ann_wnd = npcb->rcv_wnd;
+                npcb->flags |= TF_FASTOPEN_DATA;
+            }
+        }
+
         npcb->snd_wnd = SND_WND_SCALE(npcb, in_data->tcphdr->wnd);
         npcb->snd_wnd_max = npcb->snd_wnd;
         npcb->ssthresh = npcb->snd_wnd;
@@ -417,6 +504,9 @@ static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
         /* Send a SYN|ACK together with the MSS option. */
         if (ERR_OK == tcp_enqueue_flags(npcb, TCP_SYN | TCP_ACK)) {
             tcp_output(npcb);
+            if (npcb->flags & TF_FASTOPEN_DATA) {
+                tcp_fastopen_accept(npcb, in_data);
+            }
         } else {
             tcp_abandon(npcb, 0);
         }
@@ -425,6 +515,129 @@ static void tcp_listen_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
     }
 }
 
+/**
+ * Called by tcp_listen_input() when the owner accepted the data of a Fast Open SYN.
+ *
+ * The connection is passed to the application in SYN_RCVD state together with the
+ * data, without waiting for the ACK of the handshake. tcp_process() doesn't accept
+ * the connection again when the handshake completes (TF_FASTOPEN_DATA).
+ */
+static void tcp_fastopen_accept(struct tcp_pcb *npcb, tcp_in_data *in_data)
+{
+    struct pbuf *p = in_data->inseg.p;
+    err_t rc;
+
+    TCP_EVENT_ACCEPT(npcb, ERR_OK, rc);
+    if (rc != ERR_OK) {
+        if (rc != ERR_ABRT) {
+            tcp_abort(npcb);
+        }
+        return;
+    }
+
+    /* The pbuf is passed to the application or kept as refused data */
+    in_data->inseg.p = NULL;
+    if (in_data->flags & TCP_PSH) {
+        p->flags |= PBUF_FLAG_PUSH;
+    }
+    TCP_EVENT_RECV(npcb, p, ERR_OK, rc);
+    if (rc != ERR_OK && rc != ERR_ABRT) {
+        npcb->refused_data = p;
+    }
+}
+
+/**
+ * Called by L3_level_tcp_input() when an ACK arrives for a listening connection
+ * and the owner validated a SYN cookie in it (pcb->syncookie).
+ *
+ * The SYN-ACK was sent without state, so the new pcb is created here as if
+ * tcp_listen_input() had processed the SYN and sent the SYN-ACK. The caller passes
+ * the ACK to tcp_process() of the new pcb to complete the handshake.
+ *
+ * @param pcb the listen tcp_pcb for which a segment arrived
+ * @param cookie the connection parameters decoded from the cookie
+ * @return The new pcb in SYN_RCVD state if there is one. Otherwise, NULL.
+ */
+static struct tcp_pcb *tcp_syncookie_input(struct tcp_pcb *pcb,
+                                           const struct tcp_syncookie *cookie,
+                                           tcp_in_data *in_data)
+{
+    struct tcp_pcb *npcb = NULL;
+    u16_t snd_mss;
+    err_t rc;
+
+    TCP_EVENT_CLONE_PCB(pcb, &npcb, rc);
+    if (npcb == NULL) {
+        LWIP_DEBUGF(TCP_DEBUG, ("tcp_syncookie_input: could not allocate PCB\n"));
+        return NULL;
+    }
+
+    /* Set up the new PCB. */
+    npcb->is_ipv6 = in_data->iphdr.is_ipv6;
+    ip_addr_from_raw(&npcb->local_ip, in_data->iphdr.dest, in_data->iphdr.is_ipv6);
+    npcb->local_port = pcb->local_port;
+    ip_addr_from_raw(&npcb->remote_ip, in_data->iphdr.src, in_data->iphdr.is_ipv6);
+    npcb->remote_port = in_data->tcphdr->src;
+    set_tcp_state(npcb, SYN_RCVD);
+    npcb->rcv_nxt = in_data->seqno;
+    npcb->rcv_ann_right_edge = npcb->rcv_nxt;
+    npcb->snd_wl1 = in_data->seqno - 1; /* initialise to seqno-1 to force window update */
+    npcb->callback_arg = pcb->callback_arg;
+    npcb->accept = pcb->accept;
+    /* inherit socket options */
+    npcb->so_options = pcb->so_options & SOF_INHERITED;
+
+    /* Our SYN-ACK carried the cookie as its sequence number. */
+    npcb->lastack = cookie->iss;
+    npcb->snd_wl2 = cookie->iss;
+    npcb->snd_nxt = cookie->iss + 1;
+    npcb->snd_lbb = cookie->iss + 1;
+
+    /* Options of the SYN which are encoded in the cookie. */
+    npcb->snd_scale = 0;
+    npcb->rcv_scale = 0;
+    if (enable_wnd_scale && cookie->snd_scale != TCP_SYNCOOKIE_NO_WSCALE) {
+        npcb->snd_scale = cookie->snd_scale;
+        npcb->rcv_scale = rcv_wnd_scale;
+        npcb->flags |= TF_WND_SCALE;
+    }
+#if LWIP_TCP_SACK
+    if (cookie->sack && npcb->enable_sack_opt) {
+        npcb->flags |= TF_SACK;
+    }
+#endif /* LWIP_TCP_SACK */
+#if LWIP_TCP_TIMESTAMPS
+    if (cookie->ts && npcb->enable_ts_opt) {
+        /* ts_recent is taken from this ACK by tcp_parseopt() */
+        npcb->ts_lastacksent = npcb->rcv_nxt;
+        npcb->flags |= TF_TIMESTAMP;
+    }
+#endif /* LWIP_TCP_TIMESTAMPS */
+
+    npcb->advtsd_mss = tcp_send_mss(npcb);
+    snd_mss = ((cookie->mss > npcb->advtsd_mss) || (cookie->mss == 0)) ? npcb->advtsd_mss
+                                                                       : cookie->mss;
+    UPDATE_PCB_BY_MSS(npcb, snd_mss);
+
+    npcb->rcv_wnd = TCP_WND_SCALED(npcb);
+    npcb->rcv_ann_wnd = TCP_WND_SCALED(npcb);
+    npcb->rcv_wnd_max = TCP_WND_SCALED(npcb);
+    npcb->rcv_wnd_max_desired = TCP_WND_SCALED(npcb);
+
+    npcb->snd_wnd = SND_WND_SCALE(npcb, in_data->tcphdr->wnd);
+    npcb->snd_wnd_max = npcb->snd_wnd;
+    npcb->ssthresh = npcb->snd_wnd;
+
+    /* Register the new PCB so that we can begin sending segments
+     for it. */
+    TCP_EVENT_SYN_RECEIVED(pcb, npcb, rc);
+    if (rc != ERR_OK) {
+        return NULL;
+    }
+
+    return npcb;
+}
+
 /**
  * Reuse TIME-WAIT socket and move it to SYN-RCVD state.
  */
@@ -440,6 +653,7 @@ static err_t tcp_pcb_reuse(struct tcp_pcb *pcb, tcp_in_data *in_data)
     pcb->mss = pcb->advtsd_mss = tcp_send_mss(pcb);
     /* Parse any options in the SYN. */
     tcp_parseopt(pcb, in_data);
+    tcp_ecn_syn_input(pcb, in_data);
     pcb->rcv_wnd = TCP_WND_SCALED(pcb);
     pcb->rcv_ann_wnd = TCP_WND_SCALED(pcb);
     pcb->rcv_wnd_max = TCP_WND_SCALED(pcb);
@@ -531,6 +745,88 @@ static err_t tcp_timewait_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
     return ERR_OK;
 }
 
+/**
+ * Negotiates ECN (RFC 3168 6.1.1) with a received SYN or SYN-ACK. An ECN-setup SYN
+ * carries both ECE and CWR, an ECN-setup SYN-ACK carries only ECE.
+ *
+ * @param pcb the tcp_pcb which receives the SYN or SYN-ACK
+ */
+static void tcp_ecn_syn_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
+{
+    u8_t mode = TCP_ECN_MODE(pcb);
+    bool setup;
+
+    if (in_data->flags & TCP_ACK) {
+        setup = (mode == TCP_ECN_ENABLE) && (in_data->ecn_flags == TCP_ECE);
+    } else {
+        setup = (mode != TCP_ECN_OFF) && (in_data->ecn_flags == TCP_ECN_FLAGS);
+    }
+    if (setup) {
+        pcb->flags |= TF_ECN;
+        pcb->ecn_recover = pcb->snd_nxt;
+    }
+}
+
+/**
+ * Updates the ECE state of the receiver with the CE mark of a segment.
+ *
+ * The classic receiver sets ECE from the first CE mark until a segment with CWR
+ * arrives (RFC 3168 6.1.3). The DCTCP receiver echoes the mark of each segment and
+ * sends a delayed ACK before the mark changes, so that the sender can estimate the
+ * fraction of marked bytes (RFC 8257 3.2).
+ *
+ * @param pcb the tcp_pcb of an ECN connection
+ */
+static void tcp_ecn_input(struct tcp_pcb *pcb, tcp_in_data *in_data)
+{
+    bool ce = (in_data->iphdr.ecn == IP_ECN_CE);
+
+    if (TCP_ECN_ECHO_CE(pcb)) {
+        if (in_data->inseg.len > 0 && ce != !!(pcb->flags & TF_ECN_ECHO)) {
+            if (pcb->flags & TF_ACK_DELAY) {
+                tcp_send_empty_ack(pcb);
+            }
+            pcb->flags ^= TF_ECN_ECHO;
+        }
+        return;
+    }
+
+    if (in_data->ecn_flags & TCP_CWR) {
+        pcb->flags &= ~TF_ECN_ECHO;
+    }
+    if (ce && in_data->inseg.len > 0) {
+        if (!(pcb->flags & TF_ECN_ECHO)) {
+            /* Let the sender react without waiting for a delayed ACK */
+            tcp_ack_now(pcb);
+        }
+        pcb->flags |= TF_ECN_ECHO;
+    }
+}
+
+/**
+ * Responds to ECE in an ACK of an ECN connection. The congestion window is reduced
+ * at most once per window of data and the next new data segment carries CWR
+ * (RFC 3168 6.1.2).
+ *
+ * @param pcb the tcp_pcb of an ECN connection
+ */
+static void tcp_ecn_ack(struct tcp_pcb *pcb, tcp_in_data *in_data)
+{
+    pcb->ecn_ece = !!(in_data->ecn_flags & TCP_ECE);
+
+    if (pcb->ecn_ece && !(pcb->flags & TF_INFR) &&
+        TCP_SEQ_GT(in_data->ackno, pcb->ecn_recover)) {
+#if TCP_CC_ALGO_MOD
+        cc_cong_signal(pcb, CC_ECN);
+#else
+        pcb->ssthresh = LWIP_MAX(LWIP_MIN(pcb->cwnd, pcb->snd_wnd) / 2, 2U * pcb->mss);
+        pcb->cwnd = pcb->ssthresh;
+#endif
+        pcb->ecn_recover = pcb->snd_nxt;
+        pcb->flags |= TF_ECN_CWR;
+    }
+}
+
 /**
  * Implements the TCP state machine. Called by tcp_input. In some
  * states tcp_receive() is called to receive data. The tcp_seg
@@ -599,9 +895,11 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
         LWIP_DEBUGF(TCP_INPUT_DEBUG,
                     ("SYN-SENT: ackno %" U32_F " pcb->snd_nxt %" U32_F " unacked %" U32_F "\n",
                      in_data->ackno, pcb->snd_nxt, ntohl(pcb->unacked->tcphdr->seqno)));
-        /* received SYN ACK with expected sequence number? */
+        /* received SYN ACK with expected sequence number? A Fast Open SYN may be
+           acknowledged with or without its data. */
         if ((in_data->flags & TCP_ACK) && (in_data->flags & TCP_SYN) &&
-            in_data->ackno == pcb->unacked->seqno + 1) {
+            (in_data->ackno == pcb->unacked->seqno + 1 ||
+             in_data->ackno == pcb->unacked->seqno + TCP_TCPLEN(pcb->unacked))) {
             // pcb->snd_buf++; SND_BUF_FOR_SYN_FIN
             pcb->rcv_nxt = in_data->seqno + 1;
             pcb->rcv_ann_right_edge = pcb->rcv_nxt;
@@ -610,6 +908,7 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
                 pcb, in_data->tcphdr->wnd); // Which means: tcphdr->wnd << pcb->snd_scale;
             pcb->snd_wnd_max = pcb->snd_wnd;
             pcb->snd_wl1 = in_data->seqno - 1; /* initialise to seqno - 1 to force window update */
+            tcp_ecn_syn_input(pcb, in_data);
             set_tcp_state(pcb, ESTABLISHED);
 
 #if TCP_CALCULATE_EFF_SEND_MSS
@@ -620,6 +919,10 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
             /* Set ssthresh again after changing pcb->mss (already set in tcp_connect
              * but for the default value of pcb->mss) */
             pcb->ssthresh = pcb->mss * 10;
+            if (pcb->unacked->len > 0 && pcb->nrtx == 0) {
+                /* cwnd was opened for the data of the SYN, see tcp_connect_fastopen() */
+                pcb->cwnd = 1;
+            }
 #if TCP_CC_ALGO_MOD
             cc_conn_init(pcb);
 #else
@@ -633,6 +936,18 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
             rseg = pcb->unacked;
             pcb->unacked = rseg->next;
 
+            if (rseg->len > 0) {
+                if (in_data->ackno == rseg->seqno + TCP_TCPLEN(rseg)) {
+                    pcb->snd_buf += rseg->len;
+                    pcb->flags |= TF_FASTOPEN_DATA;
+                } else if (tcp_fastopen_rexmit(pcb, rseg) != ERR_OK) {
+                    /* The data can't be sent again */
+                    tcp_tx_seg_free(pcb, rseg);
+                    tcp_abort(pcb);
+                    return ERR_ABRT;
+                }
+            }
+
             /* If there's nothing left to acknowledge, stop the retransmit
                timer, otherwise reset it to start again */
             if (pcb->unacked == NULL) {
@@ -671,8 +986,11 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
                             ("TCP connection established %" U16_F " -> %" U16_F ".\n",
                              in_data->inseg.tcphdr->src, in_data->inseg.tcphdr->dest));
                 LWIP_ASSERT("pcb->accept != NULL", pcb->accept != NULL);
-                /* Call the accept function. */
-                TCP_EVENT_ACCEPT(pcb, ERR_OK, err);
+                /* Call the accept function, unless it was called for a Fast Open SYN. */
+                err = ERR_OK;
+                if (!(pcb->flags & TF_FASTOPEN_DATA)) {
+                    TCP_EVENT_ACCEPT(pcb, ERR_OK, err);
+                }
                 if (err != ERR_OK) {
                     /* If the accept function returns with an error, we abort
                      * the connection. */
@@ -777,39 +1095,127 @@ static err_t tcp_process(struct tcp_pcb *pcb, tcp_in_data *in_data)
 
 #if TCP_QUEUE_OOSEQ
 /**
- * Insert segment into the list (segments covered with new one will be deleted)
+ * Merges the segment following seg on the ooseq queue into seg if they are
+ * contiguous.
+ */
+static void tcp_oos_merge(struct tcp_pcb *pcb, struct tcp_seg *seg)
+{
+    struct tcp_seg *next = seg->next;
+
+    if (next != NULL && !(TCPH_FLAGS(seg->tcphdr) & TCP_FIN) &&
+        seg->tcphdr->seqno + seg->len == next->tcphdr->seqno) {
+        tcp_ooseq_unlink(pcb, seg, next);
+        if (TCPH_FLAGS(next->tcphdr) & TCP_FIN) {
+            TCPH_SET_FLAG(seg->tcphdr, TCP_FIN);
+        }
+        pbuf_cat(seg->p, next->p);
+        next->p = NULL;
+        seg->len += next->len;
+        pcb->ooseq_bytes += next->len;
+        tcp_seg_free(pcb, next);
+    }
+}
+
+/**
+ * Queues the incoming out-of-sequence segment on ooseq. The place is found
+ * with a lookup in the ooseq tree. The previous segment is trimmed if it
+ * overlaps with the incoming one, segments covered with the incoming one are
+ * deleted. Contiguous segments are merged afterwards, so every segment on the
+ * queue is a separate range of the sequence space and maps to a SACK block.
  *
  * Called from tcp_receive()
  */
-static void tcp_oos_insert_segment(struct tcp_pcb *pcb, struct tcp_seg *cseg, struct tcp_seg *next,
-                                   tcp_in_data *in_data)
+static void tcp_oos_insert_segment(struct tcp_pcb *pcb, tcp_in_data *in_data)
 {
-    struct tcp_seg *old_seg;
+    struct tcp_seg *prev, *next, *cseg;
+    u32_t seqno = in_data->seqno;
+
+    prev = tcp_ooseq_lookup(pcb, seqno);
+    if (prev != NULL) {
+        if (TCPH_FLAGS(prev->tcphdr) & TCP_FIN) {
+            /* segment "prev" already contains all data */
+            return;
+        }
+        if (TCP_SEQ_GEQ(prev->tcphdr->seqno + prev->len, seqno + in_data->tcplen)) {
+            /* The incoming segment carries no new data */
+            return;
+        }
+    }
+#if TCP_OOSEQ_MAX_BYTES
+    if (pcb->ooseq_bytes + in_data->inseg.len > TCP_OOSEQ_MAX_BYTES) {
+        LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_receive: ooseq limit is reached, drop segment\n"));
+        return;
+    }
+#endif /* TCP_OOSEQ_MAX_BYTES */
+
+    cseg = tcp_seg_copy(pcb, &in_data->inseg);
+    if (cseg == NULL) {
+        return;
+    }
+
+    /* check if the remote side overruns our receive window */
+    if (TCP_SEQ_GT(seqno + in_data->tcplen, pcb->rcv_nxt + pcb->rcv_wnd)) {
+        LWIP_DEBUGF(TCP_INPUT_DEBUG,
+                    ("tcp_receive: other end overran receive window"
+                     "seqno %" U32_F " len %" U16_F " right edge %" U32_F "\n",
+                     seqno, in_data->tcplen, pcb->rcv_nxt + pcb->rcv_wnd));
+        if (TCPH_FLAGS(cseg->tcphdr) & TCP_FIN) {
+            /* Must remove the FIN from the header as we're trimming
+             * that byte of sequence-space from the packet */
+            TCPH_FLAGS_SET(cseg->tcphdr, TCPH_FLAGS(cseg->tcphdr) & ~TCP_FIN);
+        }
+        /* Adjust length of segment to fit in the window. */
+        cseg->len = pcb->rcv_nxt + pcb->rcv_wnd - seqno;
+        pbuf_realloc(cseg->p, cseg->len);
+    }
+
+    if (prev != NULL) {
+        if (prev->tcphdr->seqno == seqno) {
+            /* The incoming segment is larger than the old segment, replace it. */
+            struct tcp_seg *pprev = tcp_ooseq_lookup(pcb, seqno - 1);
+
+            tcp_ooseq_unlink(pcb, pprev, prev);
+            tcp_seg_free(pcb, prev);
+            prev = pprev;
+        } else if (TCP_SEQ_GT(prev->tcphdr->seqno + prev->len, seqno)) {
+            /* We need to trim the prev segment. */
+            pcb->ooseq_bytes -= prev->tcphdr->seqno + prev->len - seqno;
+            prev->len = (u32_t)(seqno - prev->tcphdr->seqno);
+            pbuf_realloc(prev->p, prev->len);
+        }
+    }
 
+    next = (prev != NULL) ? prev->next : pcb->ooseq;
     if (TCPH_FLAGS(cseg->tcphdr) & TCP_FIN) {
         /* received segment overlaps all following segments */
-        tcp_segs_free(pcb, next);
-        next = NULL;
+        while (next != NULL) {
+            tcp_ooseq_unlink(pcb, prev, next);
+            tcp_seg_free(pcb, next);
+            next = (prev != NULL) ? prev->next : pcb->ooseq;
+        }
     } else {
         /* delete some following segments
            oos queue may have segments with FIN flag */
-        while (next &&
-               TCP_SEQ_GEQ((in_data->seqno + cseg->len), (next->tcphdr->seqno + next->len))) {
-            /* cseg with FIN already processed */
+        while (next && TCP_SEQ_GEQ(seqno + cseg->len, next->tcphdr->seqno + next->len)) {
             if (TCPH_FLAGS(next->tcphdr) & TCP_FIN) {
                 TCPH_SET_FLAG(cseg->tcphdr, TCP_FIN);
             }
-            old_seg = next;
-            next = next->next;
-            tcp_seg_free(pcb, old_seg);
+            tcp_ooseq_unlink(pcb, prev, next);
+            tcp_seg_free(pcb, next);
+            next = (prev != NULL) ? prev->next : pcb->ooseq;
         }
-        if (next && TCP_SEQ_GT(in_data->seqno + cseg->len, next->tcphdr->seqno)) {
+        if (next && TCP_SEQ_GT(seqno + cseg->len, next->tcphdr->seqno)) {
             /* We need to trim the incoming segment. */
-            cseg->len = (u32_t)(next->tcphdr->seqno - in_data->seqno);
+            cseg->len = (u32_t)(next->tcphdr->seqno - seqno);
             pbuf_realloc(cseg->p, cseg->len);
         }
     }
-    cseg->next = next;
+
+    tcp_ooseq_link(pcb, prev, cseg);
+    tcp_oos_merge(pcb, cseg);
+    if (prev != NULL) {
+        tcp_oos_merge(pcb, prev);
+    }
 }
 #endif /* TCP_QUEUE_OOSEQ */
 
@@ -1003,7 +1409,7 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
 {
     struct tcp_seg *next;
 #if TCP_QUEUE_OOSEQ
-    struct tcp_seg *prev, *cseg;
+    struct tcp_seg *cseg;
 #endif /* TCP_QUEUE_OOSEQ */
     struct pbuf *p;
     s32_t off;
@@ -1012,9 +1418,17 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
     u32_t new_tot_len;
     int found_dupack = 0;
     s8_t persist = 0;
+#if LWIP_TCP_RACK_TLP
+    u64_t rack_now = 0;
+#endif /* LWIP_TCP_RACK_TLP */
 
     if (in_data->flags & TCP_ACK) {
         right_wnd_edge = pcb->snd_wnd + pcb->snd_wl2;
+#if LWIP_TCP_RACK_TLP
+        if (TCP_RACK_ENABLED(pcb)) {
+            rack_now = sys_now_us();
+        }
+#endif /* LWIP_TCP_RACK_TLP */
 
         /* Update window. */
         if (TCP_SEQ_LT(pcb->snd_wl1, in_data->seqno) ||
@@ -1051,6 +1465,12 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
 #endif /* TCP_WND_DEBUG */
         }
 
+#if LWIP_TCP_SACK
+        if ((pcb->flags & TF_SACK) && (in_data->sack_cnt || pcb->sack_sb_cnt)) {
+            tcp_sack_update(pcb, in_data);
+        }
+#endif /* LWIP_TCP_SACK */
+
         /* (From Stevens TCP/IP Illustrated Vol II, p970.) Its only a
          * duplicate ack if:
          * 1) It doesn't ACK new data
@@ -1071,6 +1491,10 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
          *
          */
 
+        if (pcb->flags & TF_ECN) {
+            tcp_ecn_ack(pcb, in_data);
+        }
+
         /* Clause 1 */
         if (TCP_SEQ_LEQ(in_data->ackno, pcb->lastack)) {
             pcb->acked = 0;
@@ -1087,15 +1511,22 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
                                 ++pcb->dupacks;
                             }
                             if (pcb->dupacks > 3) {
+#if LWIP_TCP_SACK
+                                /* SACK loss recovery is clocked by the pipe estimation
+                                   rather than by the window inflation. */
+                                if (!(pcb->flags & TF_SACK))
+#endif /* LWIP_TCP_SACK */
+                                {
 #if TCP_CC_ALGO_MOD
-                                cc_ack_received(pcb, CC_DUPACK);
+                                    cc_ack_received(pcb, CC_DUPACK);
 #else
-                                /* Inflate the congestion window, but not if it means that
-                                   the value overflows. */
-                                if ((u32_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
-                                    pcb->cwnd += pcb->mss;
-                                }
+                                    /* Inflate the congestion window, but not if it means that
+                                       the value overflows. */
+                                    if ((u32_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
+                                        pcb->cwnd += pcb->mss;
+                                    }
 #endif // TCP_CC_ALGO_MOD
+                                }
                             } else if (pcb->dupacks == 3) {
                                 /* Do fast retransmit */
                                 tcp_rexmit_fast(pcb);
@@ -1113,6 +1544,14 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
             if (!found_dupack) {
                 pcb->dupacks = 0;
             }
+#if LWIP_TCP_SACK
+            /* RFC 6675: start loss recovery as soon as the scoreboard marks the first
+               unacked segment as lost, even before DupThresh duplicate ACKs arrive. */
+            if (found_dupack && (pcb->flags & TF_SACK) && !(pcb->flags & TF_INFR) &&
+                tcp_sack_is_lost(pcb, pcb->lastack)) {
+                tcp_rexmit_fast(pcb);
+            }
+#endif /* LWIP_TCP_SACK */
         } else if (TCP_SEQ_BETWEEN(in_data->ackno, pcb->lastack + 1, pcb->snd_nxt)) {
             /* We come here when the ACK acknowledges new data. */
 
@@ -1120,12 +1559,20 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
                in fast retransmit. Also reset the congestion window to the
                slow start threshold. */
             if (pcb->flags & TF_INFR) {
+#if LWIP_TCP_SACK
+                /* A partial ACK keeps SACK based loss recovery going until all the data
+                   outstanding at its start is acknowledged (RFC 6675). */
+                if (!(pcb->flags & TF_SACK) ||
+                    TCP_SEQ_GEQ(in_data->ackno, pcb->recovery_point))
+#endif /* LWIP_TCP_SACK */
+                {
 #if TCP_CC_ALGO_MOD
-                cc_post_recovery(pcb);
+                    cc_post_recovery(pcb);
 #else
-                pcb->cwnd = pcb->ssthresh;
+                    pcb->cwnd = pcb->ssthresh;
 #endif
-                pcb->flags &= ~TF_INFR;
+                    pcb->flags &= ~TF_INFR;
+                }
             }
 
             /* Reset the number of retransmissions. */
@@ -1143,9 +1590,15 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
             pcb->dupacks = 0;
             pcb->lastack = in_data->ackno;
 
+#if TCP_CC_ALGO_MOD
+            if (pcb->cc_algo->rate_sample != NULL) {
+                tcp_rate_on_ack(pcb, in_data->ackno);
+            }
+#endif /* TCP_CC_ALGO_MOD */
+
             /* Update the congestion control variables (cwnd and
                ssthresh). */
-            if (get_tcp_state(pcb) >= ESTABLISHED) {
+            if (get_tcp_state(pcb) >= ESTABLISHED && !(pcb->flags & TF_INFR)) {
 #if TCP_CC_ALGO_MOD
                 cc_ack_received(pcb, CC_ACK);
 #else
@@ -1199,6 +1652,12 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
                              ntohl(pcb->unacked->tcphdr->seqno),
                              ntohl(pcb->unacked->tcphdr->seqno) + TCP_TCPLEN(pcb->unacked)));
 
+#if LWIP_TCP_RACK_TLP
+                if (rack_now) {
+                    tcp_rack_update(pcb, pcb->unacked, rack_now);
+                }
+#endif /* LWIP_TCP_RACK_TLP */
+
                 next = pcb->unacked;
                 pcb->unacked = pcb->unacked->next;
                 LWIP_DEBUGF(TCP_QLEN_DEBUG,
@@ -1279,6 +1738,26 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
         }
         /* End of ACK for new data processing. */
 
+#if LWIP_TCP_RACK_TLP
+        if (rack_now) {
+            if (pcb->tlp_outstanding) {
+                tcp_tlp_ack(pcb, in_data, in_data->tcplen == 0 && pcb->acked == 0);
+            }
+            /* RACK: time based loss detection on the SACKed data */
+            if (pcb->unacked != NULL && (pcb->sack_sb_cnt || (pcb->flags & TF_INFR)) &&
+                tcp_rack_detect_loss(pcb, rack_now) && !(pcb->flags & TF_INFR)) {
+                tcp_rack_enter_recovery(pcb);
+            }
+            tcp_tlp_schedule(pcb, rack_now);
+        }
+#endif /* LWIP_TCP_RACK_TLP */
+
+#if LWIP_TCP_SACK
+        if ((pcb->flags & (TF_SACK | TF_INFR)) == (TF_SACK | TF_INFR)) {
+            tcp_sack_rexmit(pcb);
+        }
+#endif /* LWIP_TCP_SACK */
+
         LWIP_DEBUGF(TCP_RTO_DEBUG,
                     ("tcp_receive: pcb->rttest %" U32_F " rtseq %" U32_F " ackno %" U32_F "\n",
                      pcb->rttest, pcb->rtseq, in_data->ackno));
@@ -1451,11 +1930,7 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
                         /* Received in-order FIN means anything that was received
                          * out of order must now have been received in-order, so
                          * bin the ooseq queue */
-                        while (pcb->ooseq != NULL) {
-                            struct tcp_seg *old_ooseq = pcb->ooseq;
-                            pcb->ooseq = pcb->ooseq->next;
-                            tcp_seg_free(pcb, old_ooseq);
-                        }
+                        tcp_ooseq_free(pcb);
                     } else {
                         next = pcb->ooseq;
                         /* Remove all segments on ooseq that are covered by inseg already.
@@ -1469,9 +1944,9 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
                                 TCPH_SET_FLAG(in_data->inseg.tcphdr, TCP_FIN);
                                 in_data->tcplen = TCP_TCPLEN(&in_data->inseg);
                             }
-                            prev = next;
-                            next = next->next;
-                            tcp_seg_free(pcb, prev);
+                            tcp_ooseq_unlink(pcb, NULL, next);
+                            tcp_seg_free(pcb, next);
+                            next = pcb->ooseq;
                         }
                         /* Now trim right side of inseg if it overlaps with the first
                          * segment on ooseq */
@@ -1487,9 +1962,8 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
                             LWIP_ASSERT(
                                 "tcp_receive: segment not trimmed correctly to ooseq queue\n",
                                 (in_data->seqno + in_data->tcplen) ==
-                                    next->in_data->tcphdr->in_data->seqno);
+                                    next->tcphdr->seqno);
                         }
-                        pcb->ooseq = next;
                     }
                 }
 #endif /* TCP_QUEUE_OOSEQ */
@@ -1557,7 +2031,7 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
                         }
                     }
 
-                    pcb->ooseq = cseg->next;
+                    tcp_ooseq_unlink(pcb, NULL, cseg);
                     tcp_seg_free(pcb, cseg);
                 }
 #endif /* TCP_QUEUE_OOSEQ */
@@ -1572,143 +2046,17 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
 
             } else {
                 /* We get here if the incoming segment is out-of-sequence. */
-                tcp_send_empty_ack(pcb);
+#if LWIP_TCP_SACK
+                pcb->sack_recent = in_data->seqno;
+#endif /* LWIP_TCP_SACK */
 #if TCP_QUEUE_OOSEQ
                 /* Suppress coverity warning of uninit array during tcp_seg_copy(). */
                 memset(in_data->inseg.l2_l3_tcphdr_zc, 0, sizeof(in_data->inseg.l2_l3_tcphdr_zc));
-                /* We queue the segment on the ->ooseq queue. */
-                if (pcb->ooseq == NULL) {
-                    pcb->ooseq = tcp_seg_copy(pcb, &in_data->inseg);
-                } else {
-                    /* If the queue is not empty, we walk through the queue and
-                       try to find a place where the sequence number of the
-                       incoming segment is between the sequence numbers of the
-                       previous and the next segment on the ->ooseq queue. That is
-                       the place where we put the incoming segment. If needed, we
-                       trim the second edges of the previous and the incoming
-                       segment so that it will fit into the sequence.
-
-                       If the incoming segment has the same sequence number as a
-                       segment on the ->ooseq queue, we discard the segment that
-                       contains less data. */
-
-                    prev = NULL;
-                    for (next = pcb->ooseq; next != NULL; next = next->next) {
-                        if (in_data->seqno == next->tcphdr->seqno) {
-                            /* The sequence number of the incoming segment is the
-                               same as the sequence number of the segment on
-                               ->ooseq. We check the lengths to see which one to
-                               discard. */
-                            if (in_data->inseg.len > next->len) {
-                                /* The incoming segment is larger than the old
-                                   segment. We replace some segments with the new
-                                   one. */
-                                cseg = tcp_seg_copy(pcb, &in_data->inseg);
-                                if (cseg != NULL) {
-                                    if (prev != NULL) {
-                                        prev->next = cseg;
-                                    } else {
-                                        pcb->ooseq = cseg;
-                                    }
-                                    tcp_oos_insert_segment(pcb, cseg, next, in_data);
-                                }
-                                break;
-                            } else {
-                                /* Either the lenghts are the same or the incoming
-                                   segment was smaller than the old one; in either
-                                   case, we ditch the incoming segment. */
-                                break;
-                            }
-                        } else {
-                            if (prev == NULL) {
-                                if (TCP_SEQ_LT(in_data->seqno, next->tcphdr->seqno)) {
-                                    /* The sequence number of the incoming segment is lower
-                                       than the sequence number of the first segment on the
-                                       queue. We put the incoming segment first on the
-                                       queue. */
-                                    cseg = tcp_seg_copy(pcb, &in_data->inseg);
-                                    if (cseg != NULL) {
-                                        pcb->ooseq = cseg;
-                                        tcp_oos_insert_segment(pcb, cseg, next, in_data);
-                                    }
-                                    break;
-                                }
-                            } else {
-                                /*if (TCP_SEQ_LT(prev->tcphdr->seqno, seqno) &&
-                                  TCP_SEQ_LT(seqno, next->tcphdr->seqno)) {*/
-                                if (TCP_SEQ_BETWEEN(in_data->seqno, prev->tcphdr->seqno + 1,
-                                                    next->tcphdr->seqno - 1)) {
-                                    /* The sequence number of the incoming segment is in
-                                       between the sequence numbers of the previous and
-                                       the next segment on ->ooseq. We trim trim the previous
-                                       segment, delete next segments that included in received
-                                       segment and trim received, if needed. */
-                                    cseg = tcp_seg_copy(pcb, &in_data->inseg);
-                                    if (cseg != NULL) {
-                                        if (TCP_SEQ_GT(prev->tcphdr->seqno + prev->len,
-                                                       in_data->seqno)) {
-                                            /* We need to trim the prev segment. */
-                                            prev->len =
-                                                (u32_t)(in_data->seqno - prev->tcphdr->seqno);
-                                            pbuf_realloc(prev->p, prev->len);
-                                        }
-                                        prev->next = cseg;
-                                        tcp_oos_insert_segment(pcb, cseg, next, in_data);
-                                    }
-                                    break;
-                                }
-                            }
-                            /* If the "next" segment is the last segment on the
-                               ooseq queue, we add the incoming segment to the end
-                               of the list. */
-                            if (next->next == NULL &&
-                                TCP_SEQ_GT(in_data->seqno, next->tcphdr->seqno)) {
-                                if (TCPH_FLAGS(next->tcphdr) & TCP_FIN) {
-                                    /* segment "next" already contains all data */
-                                    break;
-                                }
-                                next->next = tcp_seg_copy(pcb, &in_data->inseg);
-                                if (next->next != NULL) {
-                                    if (TCP_SEQ_GT(next->tcphdr->seqno + next->len,
-                                                   in_data->seqno)) {
-                                        /* We need to trim the last segment. */
-                                        next->len = (u32_t)(in_data->seqno - next->tcphdr->seqno);
-                                        pbuf_realloc(next->p, next->len);
-                                    }
-                                    /* check if the remote side overruns our receive window */
-                                    if ((u32_t)in_data->tcplen + in_data->seqno >
-                                        pcb->rcv_nxt + (u32_t)pcb->rcv_wnd) {
-                                        LWIP_DEBUGF(TCP_INPUT_DEBUG,
-                                                    ("tcp_receive: other end overran receive window"
-                                                     "seqno %" U32_F " len %" U16_F
-                                                     " right edge %" U32_F "\n",
-                                                     in_data->seqno, in_data->tcplen,
-                                                     pcb->rcv_nxt + pcb->rcv_wnd));
-                                        if (TCPH_FLAGS(next->next->tcphdr) & TCP_FIN) {
-                                            /* Must remove the FIN from the header as we're trimming
-                                             * that byte of sequence-space from the packet */
-                                            TCPH_FLAGS_SET(
-                                                next->next->tcphdr,
-                                                TCPH_FLAGS(next->next->tcphdr) & ~TCP_FIN);
-                                        }
-                                        /* Adjust length of segment to fit in the window. */
-                                        next->next->len =
-                                            pcb->rcv_nxt + pcb->rcv_wnd - in_data->seqno;
-                                        pbuf_realloc(next->next->p, next->next->len);
-                                        in_data->tcplen = TCP_TCPLEN(next->next);
-                                        LWIP_ASSERT("tcp_receive: segment not trimmed correctly to "
-                                                    "rcv_wnd\n",
-                                                    (in_data->seqno + in_data->tcplen) ==
-                                                        (pcb->rcv_nxt + pcb->rcv_wnd));
-                                    }
-                                }
-                                break;
-                            }
-                        }
-                        prev = next;
-                    }
-                }
+                tcp_oos_insert_segment(pcb, in_data);
 #endif /* TCP_QUEUE_OOSEQ */
+                /* The immediate ACK is sent after queueing, so its SACK blocks
+                   include the segment. */
+                tcp_send_empty_ack(pcb);
             }
         } else {
             /* The incoming segment is not withing the window. */
@@ -1725,6 +2073,130 @@ static void tcp_receive(struct tcp_pcb *pcb, tcp_in_data *in_data)
     }
 }
 
+#if LWIP_TCP_SACK
+/**
+ * Adds a SACKed range to the sender scoreboard. The scoreboard is kept
+ * sorted and overlapping or adjacent ranges are merged. A new range is
+ * dropped if the scoreboard is full.
+ */
+static void tcp_sack_sb_add(struct tcp_pcb *pcb, u32_t left, u32_t right)
+{
+    struct tcp_sack_block *sb = pcb->sack_sb;
+    u8_t i, j;
+
+    for (i = 0; i < pcb->sack_sb_cnt && TCP_SEQ_LT(sb[i].right, left); ++i) {
+        ;
+    }
+    for (j = i; j < pcb->sack_sb_cnt && TCP_SEQ_LEQ(sb[j].left, right); ++j) {
+        if (TCP_SEQ_LT(sb[j].left, left)) {
+            left = sb[j].left;
+        }
+        if (TCP_SEQ_GT(sb[j].right, right)) {
+            right = sb[j].right;
+        }
+    }
+
+    if (i == j) {
+        if (pcb->sack_sb_cnt == TCP_SACK_SB_MAX) {
+            return;
+        }
+        memmove(&sb[i + 1], &sb[i], (pcb->sack_sb_cnt - i) * sizeof(sb[0]));
+        ++pcb->sack_sb_cnt;
+    } else if (j > i + 1) {
+        memmove(&sb[i + 1], &sb[j], (pcb->sack_sb_cnt - j) * sizeof(sb[0]));
+        pcb->sack_sb_cnt -= j - i - 1;
+    }
+    sb[i].left = left;
+    sb[i].right = right;
+}
+
+/**
+ * Updates the sender scoreboard with an incoming ACK: ranges below the
+ * cumulative ACK are removed and the received SACK blocks are merged in.
+ * Blocks outside of the outstanding data (including D-SACK) are ignored.
+ *
+ * @param pcb the tcp_pcb for which the ACK arrived
+ */
+static void tcp_sack_update(struct tcp_pcb *pcb, tcp_in_data *in_data)
+{
+    u32_t ackno = pcb->lastack;
+    u8_t i, j;
+
+    if (TCP_SEQ_BETWEEN(in_data->ackno, pcb->lastack, pcb->snd_nxt)) {
+        ackno = in_data->ackno;
+    }
+
+    for (i = 0, j = 0; i < pcb->sack_sb_cnt; ++i) {
+        if (TCP_SEQ_GT(pcb->sack_sb[i].right, ackno)) {
+            pcb->sack_sb[j].left =
+                TCP_SEQ_LT(pcb->sack_sb[i].left, ackno) ? ackno : pcb->sack_sb[i].left;
+            pcb->sack_sb[j].right = pcb->sack_sb[i].right;
+            ++j;
+        }
+    }
+    pcb->sack_sb_cnt = j;
+
+    for (i = 0; i < in_data->sack_cnt; ++i) {
+        u32_t left = in_data->sack[i].left;
+        u32_t right = in_data->sack[i].right;
+
+        if (TCP_SEQ_LT(left, right) && TCP_SEQ_GT(left, ackno) &&
+            TCP_SEQ_LEQ(right, pcb->snd_nxt)) {
+            tcp_sack_sb_add(pcb, left, right);
+        }
+    }
+
+    pcb->sack_bytes = 0;
+    for (i = 0; i < pcb->sack_sb_cnt; ++i) {
+        pcb->sack_bytes += pcb->sack_sb[i].right - pcb->sack_sb[i].left;
+    }
+}
+#endif /* LWIP_TCP_SACK */
+
+#if LWIP_TCP_RACK_TLP
+/**
+ * Detects whether an outstanding Tail Loss Probe repaired a loss (RFC 8985 7.4).
+ * The episode ends once the ACK covers the probe. A repaired loss reduces the
+ * congestion window as a fast recovery would. A D-SACK or a duplicate ACK shows
+ * that the original segment arrived as well and the probe was not needed.
+ *
+ * @param pcb the tcp_pcb with an outstanding probe
+ * @param in_data the incoming ACK
+ * @param dupack whether the ACK carries neither data nor new acknowledgment
+ */
+static void tcp_tlp_ack(struct tcp_pcb *pcb, tcp_in_data *in_data, int dupack)
+{
+    if (TCP_SEQ_LT(in_data->ackno, pcb->tlp_high_seq) ||
+        TCP_SEQ_GT(in_data->ackno, pcb->snd_nxt)) {
+        return;
+    }
+
+    if (!pcb->tlp_is_retrans) {
+        /* The probe carried new data, there is nothing to learn */
+        pcb->tlp_outstanding = 0;
+    } else if (in_data->sack_cnt && TCP_SEQ_LEQ(in_data->sack[0].right, in_data->ackno)) {
+        /* D-SACK for the probe */
+        pcb->tlp_outstanding = 0;
+    } else if (TCP_SEQ_GT(in_data->ackno, pcb->tlp_high_seq)) {
+        LWIP_DEBUGF(TCP_FR_DEBUG,
+                    ("tcp_tlp_ack: probe repaired a loss before %" U32_F "\n", pcb->tlp_high_seq));
+        pcb->tlp_outstanding = 0;
+        ++pcb->stat_tlp_recoveries;
+        if (!(pcb->flags & TF_INFR)) {
+#if TCP_CC_ALGO_MOD
+            cc_cong_signal(pcb, CC_NDUPACK);
+            cc_post_recovery(pcb);
+#else
+            pcb->ssthresh = LWIP_MAX(pcb->cwnd / 2, 2U * pcb->mss);
+            pcb->cwnd = pcb->ssthresh;
+#endif
+        }
+    } else if (dupack && !in_data->sack_cnt) {
+        pcb->tlp_outstanding = 0;
+    }
+}
+#endif /* LWIP_TCP_RACK_TLP */
+
 /**
  * Looks for TIMESTAMP option and returns its value.
  *
@@ -1777,7 +2249,7 @@ static bool tcp_parseopt_ts(u8_t *opts, u16_t opts_len, u32_t *tsval)
  * Parses the options contained in the incoming segment.
  *
  * Called from tcp_listen_input(), tcp_process() and tcp_pcb_reuse().
- * Currently, only the MSS, window scaling and TIMESTAMP options are
+ * Currently, only the MSS, window scaling, SACK, TIMESTAMP and Fast Open options are
  * supported!
  *
  * @param pcb the tcp_pcb for which a segment arrived
@@ -1845,6 +2317,62 @@ static void tcp_parseopt(struct tcp_pcb *pcb, tcp_in_data *in_data)
                 /* Advance to next option */
                 c += 0x03;
                 break;
+#if LWIP_TCP_SACK
+            case 0x04:
+                LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: SACK PERM\n"));
+                if (opts[c + 1] != 0x02 || (c + 0x02 > max_c)) {
+                    /* Bad length */
+                    LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+                    return;
+                }
+                if ((in_data->flags & TCP_SYN) && pcb->enable_sack_opt) {
+                    pcb->flags |= TF_SACK;
+                }
+                /* Advance to next option */
+                c += 0x02;
+                break;
+            case 0x05:
+                LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: SACK\n"));
+                if (opts[c + 1] < 0x0A || ((opts[c + 1] - 2) & 0x7) || (c + opts[c + 1] > max_c)) {
+                    /* Bad length */
+                    LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+                    return;
+                }
+                if ((pcb->flags & TF_SACK) && !(in_data->flags & TCP_SYN)) {
+                    u16_t b;
+                    for (b = c + 2; b < c + opts[c + 1] && in_data->sack_cnt < TCP_SACK_BLOCKS_MAX;
+                         b += 8) {
+                        in_data->sack[in_data->sack_cnt].left = read32_be(&opts[b]);
+                        in_data->sack[in_data->sack_cnt].right = read32_be(&opts[b + 4]);
+                        ++in_data->sack_cnt;
+                    }
+                }
+                /* Advance to next option */
+                c += opts[c + 1];
+                break;
+#endif /* LWIP_TCP_SACK */
+            case 0x22:
+                LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: FASTOPEN\n"));
+                if (opts[c + 1] < 0x02 || (c + opts[c + 1] > max_c)) {
+                    /* Bad length */
+                    LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+                    return;
+                }
+                /* A cookie in the SYN-ACK replies to our Fast Open SYN. The SYN of a
+                   listen pcb is validated by the owner, see tcp_fastopen_syn. */
+                if ((in_data->flags & TCP_SYN) && (in_data->flags & TCP_ACK) &&
+                    (pcb->flags & TF_FASTOPEN)) {
+                    u8_t cookie_len = opts[c + 1] - 2;
+                    if (cookie_len >= TCP_FASTOPEN_COOKIE_MIN &&
+                        cookie_len <= TCP_FASTOPEN_COOKIE_MAX) {
+                        pcb->fastopen.len = cookie_len;
+                        memcpy(pcb->fastopen.cookie, &opts[c + 2], cookie_len);
+                        pcb->flags |= TF_FASTOPEN_COOKIE;
+                    }
+                }
+                /* Advance to next option */
+                c += opts[c + 1];
+                break;
 #if LWIP_TCP_TIMESTAMPS
             case 0x08:
                 LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: TS\n"));
@@ -83,6 +83,12 @@ void register_sys_now(sys_now_fn fn)
     sys_now = fn;
 }
 
+sys_now_us_fn sys_now_us;
+void register_sys_now_us(sys_now_us_fn fn)
+{
+    sys_now_us = fn;
+}
+
 ip_route_mtu_fn external_ip_route_mtu;
 
 void register_ip_route_mtu(ip_route_mtu_fn fn)
@@ -92,6 +98,7 @@ void register_ip_route_mtu(ip_route_mtu_fn fn)
 
 /* Forward declarations.*/
 static err_t tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb);
+static err_t tcp_enqueue_ctrl(struct tcp_pcb *pcb, u8_t flags, const void *data, u32_t *len);
 
 /** Allocate a pbuf and create a tcphdr at p->payload, used for output
  * functions other than the default tcp_output -> tcp_output_segment
@@ -116,7 +123,8 @@ static struct pbuf *tcp_output_alloc_header(struct tcp_pcb *pcb, u16_t optlen, u
         tcphdr->dest = htons(pcb->remote_port);
         tcphdr->seqno = seqno_be;
         tcphdr->ackno = htonl(pcb->rcv_nxt);
-        TCPH_HDRLEN_FLAGS_SET(tcphdr, (5 + optlen / 4), TCP_ACK);
+        TCPH_HDRLEN_FLAGS_SET(tcphdr, (5 + optlen / 4),
+                              TCP_ACK | ((pcb->flags & TF_ECN_ECHO) ? TCP_ECE : 0));
         tcphdr->wnd = htons(TCPWND_MIN16(RCV_WND_SCALE(pcb, pcb->rcv_ann_wnd)));
         tcphdr->chksum = 0;
         tcphdr->urgp = 0;
@@ -176,6 +184,10 @@ static struct tcp_seg *tcp_create_segment(struct tcp_pcb *pcb, struct pbuf *p, u
     struct tcp_seg *seg;
     u8_t optlen = LWIP_TCP_OPT_LENGTH(optflags);
 
+    if ((flags & TCP_SYN) && (pcb->flags & TF_FASTOPEN)) {
+        optlen += LWIP_TCP_OPT_LEN_FASTOPEN(pcb->fastopen.len);
+    }
+
     if (!pcb->seg_alloc) {
         // seg_alloc is not valid, we should allocate a new segment.
         if ((seg = external_tcp_seg_alloc(pcb)) == NULL) {
@@ -200,6 +212,10 @@ static struct tcp_seg *tcp_create_segment(struct tcp_pcb *pcb, struct pbuf *p, u
     }
 
     seg->flags = optflags;
+#if LWIP_TCP_RACK_TLP
+    seg->rack_flags = 0;
+    seg->xmit_us = 0;
+#endif /* LWIP_TCP_RACK_TLP */
     seg->p = p;
     seg->len = p->tot_len - optlen;
     seg->seqno = seqno;
@@ -521,7 +537,8 @@ err_t tcp_write(struct tcp_pcb *pcb, const void *arg, u32_t len, u16_t apiflags,
          * the end.
          */
         if (!(apiflags & (TCP_WRITE_FILE | TCP_WRITE_ZEROCOPY)) && (pos < len) && (space > 0) &&
-            (pcb->last_unsent->len > 0) && (tot_p < (int)pcb->tso.max_send_sge)) {
+            (pcb->last_unsent->len > 0) && !(TCPH_FLAGS(pcb->last_unsent->tcphdr) & TCP_SYN) &&
+            (tot_p < (int)pcb->tso.max_send_sge)) {
 
             u16_t seglen = space < len - pos ? space : len - pos;
 
@@ -750,11 +767,34 @@ memerr:
  * @param optlen length of TCP options in bytes.
  */
 err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
+{
+    u32_t len = 0;
+
+    return tcp_enqueue_ctrl(pcb, flags, NULL, &len);
+}
+
+/**
+ * Enqueue a SYN which carries data (TCP Fast Open, RFC 7413).
+ *
+ * Called by tcp_connect_fastopen().
+ *
+ * @param pcb Protocol control block for the TCP connection.
+ * @param data data to send in the SYN
+ * @param len in: length of data, out: number of bytes queued in the SYN.
+ *            Data is limited by one segment and by the send buffer.
+ */
+err_t tcp_enqueue_syn_data(struct tcp_pcb *pcb, const void *data, u32_t *len)
+{
+    return tcp_enqueue_ctrl(pcb, TCP_SYN, data, len);
+}
+
+static err_t tcp_enqueue_ctrl(struct tcp_pcb *pcb, u8_t flags, const void *data, u32_t *len)
 {
     struct pbuf *p;
     struct tcp_seg *seg;
     u8_t optflags = 0;
     u8_t optlen = 0;
+    u32_t datalen = 0;
 
     LWIP_DEBUGF(TCP_QLEN_DEBUG,
                 ("tcp_enqueue_flags: queuelen: %" U16_F "\n", (u16_t)pcb->snd_queuelen));
@@ -782,6 +822,12 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
                 be sent if we received a window scale option from the remote host. */
             optflags |= TF_SEG_OPTS_WNDSCALE;
         }
+#if LWIP_TCP_SACK
+        if (pcb->enable_sack_opt && (!(flags & TCP_ACK) || (pcb->flags & TF_SACK))) {
+            /* Same as window scaling: <SYN,ACK> carries SACK permitted only in reply to it. */
+            optflags |= TF_SEG_OPTS_SACK_PERM;
+        }
+#endif
 #if LWIP_TCP_TIMESTAMPS
         if (pcb->enable_ts_opt && !(flags & TCP_ACK)) {
             // enable initial timestamp announcement only for the connecting side. accepting side
@@ -789,6 +835,13 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
             optflags |= TF_SEG_OPTS_TS;
         }
 #endif
+        if (!(flags & TCP_ACK) && TCP_ECN_MODE(pcb) == TCP_ECN_ENABLE) {
+            /* ECN-setup SYN */
+            flags |= TCP_ECE | TCP_CWR;
+        } else if ((flags & TCP_ACK) && (pcb->flags & TF_ECN)) {
+            /* ECN-setup SYN-ACK */
+            flags |= TCP_ECE;
+        }
     }
 #if LWIP_TCP_TIMESTAMPS
     if ((pcb->flags & TF_TIMESTAMP)) {
@@ -796,6 +849,12 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
     }
 #endif /* LWIP_TCP_TIMESTAMPS */
     optlen = LWIP_TCP_OPT_LENGTH(optflags);
+    if ((flags & TCP_SYN) && (pcb->flags & TF_FASTOPEN)) {
+        optlen += LWIP_TCP_OPT_LEN_FASTOPEN(pcb->fastopen.len);
+    }
+    if (data != NULL && pcb->mss > optlen) {
+        datalen = LWIP_MIN(*len, LWIP_MIN(pcb->snd_buf, (u32_t)(pcb->mss - optlen)));
+    }
 
     /* tcp_enqueue_flags is always called with either SYN or FIN in flags.
      * We need one available snd_buf byte to do that.
@@ -807,12 +866,16 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
       return ERR_MEM;
     }*/ //to consider snd_buf for syn or fin, unmarked sections with SND_BUF_FOR_SYN_FIN
 
-    /* Allocate pbuf with room for TCP header + options */
-    if ((p = tcp_tx_pbuf_alloc(pcb, optlen, PBUF_RAM, NULL, NULL)) == NULL) {
+    /* Allocate pbuf with room for TCP header + options + data */
+    if ((p = tcp_tx_pbuf_alloc(pcb, optlen + datalen, PBUF_RAM, NULL, NULL)) == NULL) {
         pcb->flags |= TF_NAGLEMEMERR;
         return ERR_MEM;
     }
-    LWIP_ASSERT("tcp_enqueue_flags: check that first pbuf can hold optlen", (p->len >= optlen));
+    LWIP_ASSERT("tcp_enqueue_flags: check that first pbuf can hold optlen",
+                (p->len >= optlen + datalen));
+    if (datalen > 0) {
+        memcpy((u8_t *)p->payload + optlen, data, datalen);
+    }
 
     /* Allocate memory for tcp_seg, and fill in fields. */
     if ((seg = tcp_create_segment(pcb, p, flags, pcb->snd_lbb, optflags)) == NULL) {
@@ -820,7 +883,7 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
         tcp_tx_pbuf_free(pcb, p);
         return ERR_MEM;
     }
-    LWIP_ASSERT("tcp_enqueue_flags: invalid segment length", seg->len == 0);
+    LWIP_ASSERT("tcp_enqueue_flags: invalid segment length", seg->len == datalen);
 
     LWIP_DEBUGF(
         TCP_OUTPUT_DEBUG | LWIP_DBG_TRACE,
@@ -849,6 +912,9 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
         /* optlen does not influence snd_buf */
         // pcb->snd_buf--; SND_BUF_FOR_SYN_FIN
     }
+    pcb->snd_lbb += datalen;
+    pcb->snd_buf -= datalen;
+    *len = datalen;
     if (flags & TCP_FIN) {
         pcb->flags |= TF_FIN;
     }
@@ -865,6 +931,76 @@ err_t tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
     return ERR_OK;
 }
 
+/**
+ * Requeue the data of a SYN which the peer acknowledged without the data, i.e.
+ * it didn't accept TCP Fast Open. The data is sent again as a regular segment.
+ *
+ * Called by tcp_process() in SYN_SENT state. The SYN segment isn't freed.
+ *
+ * @param pcb the tcp_pcb
+ * @param syn the SYN segment which was removed from the unacked queue
+ */
+err_t tcp_fastopen_rexmit(struct tcp_pcb *pcb, struct tcp_seg *syn)
+{
+    struct pbuf *p;
+    struct tcp_seg *seg;
+    u8_t optflags = 0;
+    u8_t optlen;
+
+#if LWIP_TCP_TIMESTAMPS
+    if (pcb->flags & TF_TIMESTAMP) {
+        optflags |= TF_SEG_OPTS_TS;
+    }
+#endif /* LWIP_TCP_TIMESTAMPS */
+    optlen = LWIP_TCP_OPT_LENGTH(optflags);
+
+    if ((p = tcp_tx_pbuf_alloc(pcb, optlen + syn->len, PBUF_RAM, NULL, NULL)) == NULL) {
+        return ERR_MEM;
+    }
+    memcpy((u8_t *)p->payload + optlen, (u8_t *)syn->tcphdr + LWIP_TCP_HDRLEN(syn->tcphdr),
+           syn->len);
+
+    if ((seg = tcp_create_segment(pcb, p, 0, syn->seqno + 1, optflags)) == NULL) {
+        tcp_tx_pbuf_free(pcb, p);
+        return ERR_MEM;
+    }
+
+    /* The data precedes anything written after the SYN */
+    seg->next = pcb->unsent;
+    if (pcb->unsent == NULL) {
+        pcb->last_unsent = seg;
+#if TCP_OVERSIZE
+        pcb->unsent_oversize = 0;
+#endif /* TCP_OVERSIZE */
+    }
+    pcb->unsent = seg;
+    pcb->snd_queuelen += pbuf_clen(p);
+    pcb->snd_nxt = seg->seqno;
+
+    return ERR_OK;
+}
+
+/* Build a Fast Open option with the cookie of the pcb at the specified options pointer.
+ * The option is padded with leading NOPs to a multiple of 4 bytes.
+ *
+ * @param pcb tcp_pcb
+ * @param opts option pointer where to store the option
+ * @return option pointer after the option
+ */
+static u32_t *tcp_build_fastopen_option(struct tcp_pcb *pcb, u32_t *opts)
+{
+    u8_t *p = (u8_t *)opts;
+    u8_t optlen = LWIP_TCP_OPT_LEN_FASTOPEN(pcb->fastopen.len);
+    u8_t pad = optlen - 2 - pcb->fastopen.len;
+
+    memset(p, 0x01, pad);
+    p[pad] = 0x22;
+    p[pad + 1] = 2 + pcb->fastopen.len;
+    memcpy(&p[pad + 2], pcb->fastopen.cookie, pcb->fastopen.len);
+
+    return opts + optlen / 4;
+}
+
 #if LWIP_TCP_TIMESTAMPS
 /* Build a timestamp option (12 bytes long) at the specified options pointer)
  *
@@ -880,6 +1016,62 @@ static void tcp_build_timestamp_option(struct tcp_pcb *pcb, u32_t *opts)
 }
 #endif
 
+#if LWIP_TCP_SACK
+/* Build SACK blocks (RFC 2018) from the out-of-sequence queue. Contiguous
+ * segments are merged on ooseq, so every segment is reported as a block. The
+ * block which contains the most recently received segment is reported first.
+ *
+ * @param pcb tcp_pcb
+ * @param blocks array to store the blocks
+ * @param max maximum number of blocks to build
+ * @return number of the built blocks
+ */
+static u8_t tcp_build_sack_blocks(struct tcp_pcb *pcb, struct tcp_sack_block *blocks, u8_t max)
+{
+    struct tcp_seg *recent = tcp_ooseq_lookup(pcb, pcb->sack_recent);
+    struct tcp_seg *seg;
+    u8_t cnt = 0;
+
+    if (recent != NULL &&
+        TCP_SEQ_LT(pcb->sack_recent, recent->tcphdr->seqno + TCP_TCPLEN(recent))) {
+        blocks[cnt].left = recent->tcphdr->seqno;
+        blocks[cnt].right = recent->tcphdr->seqno + TCP_TCPLEN(recent);
+        ++cnt;
+    } else {
+        /* The segment was not queued */
+        recent = NULL;
+    }
+
+    for (seg = pcb->ooseq; seg != NULL && cnt < max; seg = seg->next) {
+        if (seg != recent) {
+            blocks[cnt].left = seg->tcphdr->seqno;
+            blocks[cnt].right = seg->tcphdr->seqno + TCP_TCPLEN(seg);
+            ++cnt;
+        }
+    }
+
+    return cnt;
+}
+
+/* Build a SACK option at the specified options pointer
+ *
+ * @param blocks SACK blocks to report
+ * @param cnt number of the blocks
+ * @param opts option pointer where to store the SACK option
+ */
+static void tcp_build_sack_option(struct tcp_sack_block *blocks, u8_t cnt, u32_t *opts)
+{
+    u8_t i;
+
+    /* Pad with two NOP options to make everything nicely aligned */
+    opts[0] = htonl(0x01010500 | (2 + 8 * cnt));
+    for (i = 0; i < cnt; ++i) {
+        opts[1 + 2 * i] = htonl(blocks[i].left);
+        opts[2 + 2 * i] = htonl(blocks[i].right);
+    }
+}
+#endif /* LWIP_TCP_SACK */
+
 /** Send an ACK without data.
  *
  * @param pcb Protocol control block for the TCP connection to send the ACK
@@ -890,12 +1082,25 @@ err_t tcp_send_empty_ack(struct tcp_pcb *pcb)
     struct tcp_hdr *tcphdr;
     u8_t optlen = 0;
     u32_t *opts;
+#if LWIP_TCP_SACK
+    struct tcp_sack_block sack_blocks[TCP_SACK_BLOCKS_MAX];
+    u8_t sack_cnt = 0;
+#endif
 
 #if LWIP_TCP_TIMESTAMPS
     if (pcb->flags & TF_TIMESTAMP) {
         optlen = LWIP_TCP_OPT_LENGTH(TF_SEG_OPTS_TS);
     }
 #endif
+#if LWIP_TCP_SACK
+    if ((pcb->flags & TF_SACK) && pcb->ooseq != NULL) {
+        /* 3 blocks fit into the option space together with the timestamp option */
+        sack_cnt = tcp_build_sack_blocks(pcb, sack_blocks,
+                                         (pcb->flags & TF_TIMESTAMP) ? TCP_SACK_BLOCKS_MAX - 1
+                                                                     : TCP_SACK_BLOCKS_MAX);
+        optlen += LWIP_TCP_SACK_OPT_LEN(sack_cnt);
+    }
+#endif
 
     p = tcp_output_alloc_header(pcb, optlen, 0, htonl(pcb->snd_nxt));
     if (p == NULL) {
@@ -917,6 +1122,12 @@ err_t tcp_send_empty_ack(struct tcp_pcb *pcb)
         tcp_build_timestamp_option(pcb, opts);
         opts += 3;
     }
+#endif
+#if LWIP_TCP_SACK
+    if (sack_cnt) {
+        tcp_build_sack_option(sack_blocks, sack_cnt, opts);
+        opts += 1 + 2 * sack_cnt;
+    }
 #endif
     pcb->ip_output(p, NULL, pcb, 0);
     tcp_tx_pbuf_free(pcb, p);
@@ -1110,6 +1321,10 @@ static struct tcp_seg *tcp_split_one_segment(struct tcp_pcb *pcb, struct tcp_seg
         /* New segment update */
         new_seg->next = cur_seg->next;
         new_seg->flags = cur_seg->flags;
+#if LWIP_TCP_RACK_TLP
+        new_seg->rack_flags = cur_seg->rack_flags;
+        new_seg->xmit_us = cur_seg->xmit_us;
+#endif /* LWIP_TCP_RACK_TLP */
 
         /* Update original buffer */
         cur_seg->p->next = NULL;
@@ -1251,6 +1466,10 @@ __attribute__((unused)) static struct tcp_seg *tcp_rexmit_segment(struct tcp_pcb
         /* New segment update */
         new_seg->next = cur_seg->next;
         new_seg->flags = cur_seg->flags;
+#if LWIP_TCP_RACK_TLP
+        new_seg->rack_flags = cur_seg->rack_flags;
+        new_seg->xmit_us = cur_seg->xmit_us;
+#endif /* LWIP_TCP_RACK_TLP */
 
         /* Original segment update */
         cur_seg->next = new_seg;
@@ -1351,6 +1570,10 @@ void tcp_split_rexmit(struct tcp_pcb *pcb, struct tcp_seg *seg)
         /* New segment update */
         new_seg->next = cur_seg->next;
         new_seg->flags = cur_seg->flags;
+#if LWIP_TCP_RACK_TLP
+        new_seg->rack_flags = cur_seg->rack_flags;
+        new_seg->xmit_us = cur_seg->xmit_us;
+#endif /* LWIP_TCP_RACK_TLP */
 
         /* Original segment update */
         cur_seg->next = new_seg;
@@ -1458,6 +1681,10 @@ void tcp_split_segment(struct tcp_pcb *pcb, struct tcp_seg *seg, u32_t wnd)
         /* New segment update */
         newseg->next = seg->next;
         newseg->flags = seg->flags;
+#if LWIP_TCP_RACK_TLP
+        newseg->rack_flags = seg->rack_flags;
+        newseg->xmit_us = seg->xmit_us;
+#endif /* LWIP_TCP_RACK_TLP */
 
         /* Original segment update */
         seg->next = newseg;
@@ -1517,6 +1744,10 @@ void tcp_split_segment(struct tcp_pcb *pcb, struct tcp_seg *seg, u32_t wnd)
         /* New segment update */
         newseg->next = seg->next;
         newseg->flags = seg->flags;
+#if LWIP_TCP_RACK_TLP
+        newseg->rack_flags = seg->rack_flags;
+        newseg->xmit_us = seg->xmit_us;
+#endif /* LWIP_TCP_RACK_TLP */
 
         /* Original segment update */
         seg->next = newseg;
@@ -1586,6 +1817,60 @@ s32_t tcp_is_wnd_available(struct tcp_pcb *pcb, u32_t data_len)
     return ((wnd - tot_unacked_len) >= (tot_unsent_len + (tot_opts_hdrs_len + (s32_t)data_len)));
 }
 
+#if TCP_CC_ALGO_MOD
+/**
+ * Return the rate at which the pcb is paced in bytes/sec, 0 if it isn't paced.
+ */
+static inline u64_t tcp_pacing_rate(struct tcp_pcb *pcb)
+{
+    u64_t rate = pcb->pacing_rate;
+
+    if (pcb->max_pacing_rate && (rate == 0 || rate > pcb->max_pacing_rate)) {
+        rate = pcb->max_pacing_rate;
+    }
+    return rate;
+}
+
+/**
+ * Check whether the earliest departure time of the next segment has come.
+ *
+ * A release which comes late may catch up with the schedule, but by no more
+ * than lwip_tcp_pacing_horizon_us and TCP_PACING_CATCHUP_SEGS segments, and
+ * a connection with nothing in flight starts a new schedule, so neither of
+ * them bursts at line rate.
+ */
+static u8_t tcp_pacing_can_send(struct tcp_pcb *pcb, u64_t rate)
+{
+    u64_t now = sys_now_us();
+    u64_t horizon = (u64_t)TCP_PACING_CATCHUP_SEGS * pcb->mss * 1000000 / rate;
+
+    horizon = LWIP_MIN(horizon, (u64_t)lwip_tcp_pacing_horizon_us);
+    if (pcb->snd_nxt == pcb->lastack) {
+        if (pcb->pacing_next_us < now) {
+            pcb->pacing_next_us = now;
+        }
+    } else if (pcb->pacing_next_us + horizon < now) {
+        pcb->pacing_next_us = now - horizon;
+    }
+
+    return pcb->pacing_next_us <= now;
+}
+
+/**
+ * Limit the window passed to TSO, so a paced connection doesn't send more
+ * than TCP_PACING_TSO_USEC worth of data in one TSO segment.
+ */
+static inline u32_t tcp_pacing_tso_wnd(struct tcp_pcb *pcb, struct tcp_seg *seg, u32_t wnd,
+                                       u64_t rate)
+{
+    u64_t budget = rate * TCP_PACING_TSO_USEC / 1000000;
+
+    budget = LWIP_MAX(budget, 2U * pcb->mss);
+    budget += seg->seqno - pcb->lastack;
+    return (budget < wnd) ? (u32_t)budget : wnd;
+}
+#endif /* TCP_CC_ALGO_MOD */
+
 /**
  * Find out what we can send and send it
  *
@@ -1598,6 +1883,9 @@ err_t tcp_output(struct tcp_pcb *pcb)
     struct tcp_seg *seg, *useg;
     u32_t wnd, snd_nxt;
     err_t rc = ERR_OK;
+#if TCP_CC_ALGO_MOD
+    u64_t pacing_rate;
+#endif /* TCP_CC_ALGO_MOD */
 #if TCP_CWND_DEBUG
     s16_t i = 0;
 #endif /* TCP_CWND_DEBUG */
@@ -1665,6 +1953,11 @@ err_t tcp_output(struct tcp_pcb *pcb)
     }
 #endif /* TCP_TSO_DEBUG */
 
+#if TCP_CC_ALGO_MOD
+    pacing_rate = tcp_pacing_rate(pcb);
+    pcb->pacing_pending = 0;
+#endif /* TCP_CC_ALGO_MOD */
+
     while (seg && rc == ERR_OK) {
         /* TSO segment can be in unsent queue only in case of retransmission.
          * Clear TSO flag, tcp_split_segment() and tcp_tso_segment() will handle
@@ -1705,11 +1998,30 @@ err_t tcp_output(struct tcp_pcb *pcb)
                 }
             }
 
+#if TCP_CC_ALGO_MOD
+            /* Hold the segment back until its earliest departure time. The
+             * release comes from the next tcp_output() call: an incoming ACK,
+             * a write or the TCP timer. */
+            if (pacing_rate && !LWIP_IS_DUMMY_SEGMENT(seg) &&
+                !tcp_pacing_can_send(pcb, pacing_rate)) {
+                pcb->pacing_pending = 1;
+                if (pcb->flags & TF_ACK_NOW) {
+                    tcp_send_empty_ack(pcb);
+                }
+                break;
+            }
+#endif /* TCP_CC_ALGO_MOD */
+
             /* Use TSO send operation in case TSO is enabled
              * and current segment is not retransmitted
              */
             if (tcp_tso(pcb)) {
+#if TCP_CC_ALGO_MOD
+                tcp_tso_segment(pcb, seg,
+                                pacing_rate ? tcp_pacing_tso_wnd(pcb, seg, wnd, pacing_rate) : wnd);
+#else
                 tcp_tso_segment(pcb, seg, wnd);
+#endif /* TCP_CC_ALGO_MOD */
             }
 
 #if TCP_CWND_DEBUG
@@ -1737,6 +2049,12 @@ err_t tcp_output(struct tcp_pcb *pcb)
 #endif /* TCP_OVERSIZE_DBGCHECK */
 
             rc = tcp_output_segment(seg, pcb);
+#if TCP_CC_ALGO_MOD
+            if (pacing_rate && !LWIP_IS_DUMMY_SEGMENT(seg)) {
+                /* The next segment departs once this one is sent at the pacing rate. */
+                pcb->pacing_next_us += (u64_t)seg->len * 1000000 / pacing_rate;
+            }
+#endif /* TCP_CC_ALGO_MOD */
             if (rc != ERR_OK && pcb->unacked) {
                 /* Transmission failed, skip moving the segment to unacked, so we
                  * retry with the next tcp_output(). We must have at least one unacked
@@ -1810,6 +2128,13 @@ err_t tcp_output(struct tcp_pcb *pcb)
 #endif /* TCP_OVERSIZE */
     }
 
+#if LWIP_TCP_RACK_TLP
+    /* Arm the probe timer for the data in flight */
+    if (pcb->tlp_timeout_us == 0 && pcb->unacked != NULL && TCP_RACK_ENABLED(pcb)) {
+        tcp_tlp_schedule(pcb, sys_now_us());
+    }
+#endif /* LWIP_TCP_RACK_TLP */
+
     pcb->flags &= ~TF_NAGLEMEMERR;
 
     // Fetch buffers for the next packet.
@@ -1826,6 +2151,24 @@ err_t tcp_output(struct tcp_pcb *pcb)
     return rc == ERR_WOULDBLOCK ? ERR_OK : rc;
 }
 
+/**
+ * Sets the ECN flags of a non-SYN segment of an ECN connection before it is sent.
+ * ECE reflects the current receiver state. CWR is set on the first new data segment
+ * after the congestion window was reduced, never on a retransmission (RFC 3168 6.1.2).
+ */
+static void tcp_ecn_output(struct tcp_pcb *pcb, struct tcp_seg *seg)
+{
+    /* TCPH_UNSET_FLAG() doesn't clear flags out of TCP_FLAGS */
+    seg->tcphdr->_hdrlen_rsvd_flags &= PP_HTONS((u16_t)(~(u16_t)TCP_ECN_FLAGS));
+    if (pcb->flags & TF_ECN_ECHO) {
+        TCPH_SET_FLAG(seg->tcphdr, TCP_ECE);
+    }
+    if ((pcb->flags & TF_ECN_CWR) && seg->len > 0 && !TCP_SEQ_LT(seg->seqno, pcb->snd_nxt)) {
+        TCPH_SET_FLAG(seg->tcphdr, TCP_CWR);
+        pcb->flags &= ~TF_ECN_CWR;
+    }
+}
+
 /**
  * Called by tcp_output() to actually send a TCP segment over IP.
  *
@@ -1873,6 +2216,20 @@ static err_t tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
                    // we added 1 byte NOOP padding => total 4 bytes
     }
 
+    if (seg->flags & TF_SEG_OPTS_SACK_PERM) {
+        TCP_BUILD_SACK_PERM_OPTION(*opts);
+        opts += 1; // 2 bytes long option + 2 bytes NOOP padding
+    }
+
+    if ((TCPH_FLAGS(seg->tcphdr) & TCP_SYN) && (pcb->flags & TF_FASTOPEN)) {
+        opts = tcp_build_fastopen_option(pcb, opts);
+    }
+
+    if ((pcb->flags & TF_ECN) && !(TCPH_FLAGS(seg->tcphdr) & TCP_SYN) &&
+        !LWIP_IS_DUMMY_SEGMENT(seg)) {
+        tcp_ecn_output(pcb, seg);
+    }
+
 #if LWIP_TCP_TIMESTAMPS
     if (!LWIP_IS_DUMMY_SEGMENT(seg)) {
         pcb->ts_lastacksent = pcb->rcv_nxt;
@@ -1911,6 +2268,20 @@ static err_t tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
 
             LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_output_segment: rtseq %" U32_F "\n", pcb->rtseq));
         }
+#if LWIP_TCP_RACK_TLP
+        if (TCP_RACK_ENABLED(pcb)) {
+            seg->rack_flags &= ~(TF_SEG_RACK_LOST | TF_SEG_RACK_DELIVERED);
+            if (TCP_SEQ_LT(seg->seqno, pcb->snd_nxt)) {
+                seg->rack_flags |= TF_SEG_RACK_REXMIT;
+            }
+            seg->xmit_us = sys_now_us();
+        }
+#endif /* LWIP_TCP_RACK_TLP */
+#if TCP_CC_ALGO_MOD
+        if (pcb->cc_algo->rate_sample != NULL) {
+            tcp_rate_on_send(pcb, seg);
+        }
+#endif /* TCP_CC_ALGO_MOD */
     }
     LWIP_DEBUGF(TCP_OUTPUT_DEBUG,
                 ("tcp_output_segment: %" U32_F ":%" U32_F "\n", htonl(seg->tcphdr->seqno),
@@ -2034,6 +2405,19 @@ void tcp_rexmit_rto(struct tcp_pcb *pcb)
     /* unacked queue is now empty */
     pcb->unacked = NULL;
 
+#if LWIP_TCP_SACK
+    /* RFC 2018: the SACK information must be discarded after a retransmission timeout. */
+    pcb->sack_sb_cnt = 0;
+    pcb->sack_bytes = 0;
+#endif
+#if LWIP_TCP_RACK_TLP
+    /* The timeout ends any probe episode, the data is sent again from the start. */
+    ++pcb->stat_rto;
+    pcb->rack_reo_timeout_us = 0;
+    pcb->tlp_timeout_us = 0;
+    pcb->tlp_outstanding = 0;
+#endif /* LWIP_TCP_RACK_TLP */
+
     /* increment number of retransmissions */
     ++pcb->nrtx;
 
@@ -2045,26 +2429,26 @@ void tcp_rexmit_rto(struct tcp_pcb *pcb)
 }
 
 /**
- * Requeue the first unacked segment for retransmission
- *
- * Called by tcp_receive() for fast retramsmit.
+ * Move a segment from the unacked queue to the unsent queue for retransmission
  *
- * @param pcb the tcp_pcb for which to retransmit the first unacked segment
+ * @param pcb the tcp_pcb
+ * @param prev the segment which precedes seg on the unacked queue or NULL
+ * @param seg the segment to retransmit
  */
-void tcp_rexmit(struct tcp_pcb *pcb)
+static void tcp_rexmit_requeue(struct tcp_pcb *pcb, struct tcp_seg *prev, struct tcp_seg *seg)
 {
-    struct tcp_seg *seg;
     struct tcp_seg **cur_seg;
 
-    if (pcb->unacked == NULL) {
-        return;
+    if (prev != NULL) {
+        prev->next = seg->next;
+    } else {
+        pcb->unacked = seg->next;
+    }
+    if (pcb->last_unacked == seg) {
+        pcb->last_unacked = prev;
     }
 
-    /* Move the first unacked segment to the unsent queue */
     /* Keep the unsent queue sorted. */
-    seg = pcb->unacked;
-    pcb->unacked = seg->next;
-
     cur_seg = &(pcb->unsent);
     while (*cur_seg && TCP_SEQ_LT((*cur_seg)->seqno, seg->seqno)) {
         cur_seg = &((*cur_seg)->next);
@@ -2078,6 +2462,23 @@ void tcp_rexmit(struct tcp_pcb *pcb)
         pcb->unsent_oversize = 0;
 #endif /* TCP_OVERSIZE */
     }
+}
+
+/**
+ * Requeue the first unacked segment for retransmission
+ *
+ * Called by tcp_receive() for fast retramsmit.
+ *
+ * @param pcb the tcp_pcb for which to retransmit the first unacked segment
+ */
+void tcp_rexmit(struct tcp_pcb *pcb)
+{
+    if (pcb->unacked == NULL) {
+        return;
+    }
+
+    /* Move the first unacked segment to the unsent queue */
+    tcp_rexmit_requeue(pcb, NULL, pcb->unacked);
 
     ++pcb->nrtx;
 
@@ -2085,6 +2486,38 @@ void tcp_rexmit(struct tcp_pcb *pcb)
     pcb->rttest = 0;
 }
 
+/**
+ * Reduce the congestion window on entering loss recovery.
+ *
+ * @param pcb the tcp_pcb which detected a loss
+ */
+static void tcp_cc_enter_recovery(struct tcp_pcb *pcb)
+{
+#if TCP_CC_ALGO_MOD
+    cc_cong_signal(pcb, CC_NDUPACK);
+#else
+    /* Set ssthresh to half of the minimum of the current
+     * cwnd and the advertised window */
+    if (pcb->cwnd > pcb->snd_wnd) {
+        pcb->ssthresh = pcb->snd_wnd / 2;
+    } else {
+        pcb->ssthresh = pcb->cwnd / 2;
+    }
+
+    /* The minimum value for ssthresh should be 2 MSS */
+    if (pcb->ssthresh < (2U * pcb->mss)) {
+        LWIP_DEBUGF(TCP_FR_DEBUG,
+                    ("tcp_receive: The minimum value for ssthresh %" U16_F
+                     " should be min 2 mss %" U16_F "...\n",
+                     pcb->ssthresh, 2 * pcb->mss));
+        pcb->ssthresh = 2 * pcb->mss;
+    }
+
+    pcb->cwnd = pcb->ssthresh + 3 * pcb->mss;
+#endif
+    pcb->flags |= TF_INFR;
+}
+
 /**
  * Handle retransmission after three dupacks received
  *
@@ -2097,32 +2530,363 @@ void tcp_rexmit_fast(struct tcp_pcb *pcb)
         LWIP_DEBUGF(TCP_FR_DEBUG,
                     ("tcp_receive: dupacks %" U16_F " (%" U32_F "), fast retransmit %" U32_F "\n",
                      (u16_t)pcb->dupacks, pcb->lastack, pcb->unacked->seqno));
+#if LWIP_TCP_SACK
+        pcb->recovery_point = pcb->snd_nxt;
+        pcb->high_rxt = pcb->unacked->seqno + TCP_TCPLEN(pcb->unacked);
+#endif
         tcp_rexmit(pcb);
-#if TCP_CC_ALGO_MOD
-        cc_cong_signal(pcb, CC_NDUPACK);
-#else
-        /* Set ssthresh to half of the minimum of the current
-         * cwnd and the advertised window */
-        if (pcb->cwnd > pcb->snd_wnd) {
-            pcb->ssthresh = pcb->snd_wnd / 2;
+        tcp_cc_enter_recovery(pcb);
+    }
+}
+
+#if LWIP_TCP_SACK
+/**
+ * Check whether the data starting at seqno is considered lost (RFC 6675 IsLost):
+ * either DupThresh discontiguous SACKed ranges or more than (DupThresh - 1) * MSS
+ * bytes are SACKed above it.
+ *
+ * @param pcb the tcp_pcb
+ * @param seqno the first sequence number of the data to check
+ * @return 1 if the data is lost and 0 otherwise
+ */
+u8_t tcp_sack_is_lost(struct tcp_pcb *pcb, u32_t seqno)
+{
+    u32_t sacked = 0;
+    u8_t ranges = 0;
+    s8_t i;
+
+    for (i = (s8_t)pcb->sack_sb_cnt - 1; i >= 0 && TCP_SEQ_GT(pcb->sack_sb[i].right, seqno); --i) {
+        if (TCP_SEQ_GT(pcb->sack_sb[i].left, seqno)) {
+            sacked += pcb->sack_sb[i].right - pcb->sack_sb[i].left;
+            ++ranges;
         } else {
-            pcb->ssthresh = pcb->cwnd / 2;
+            sacked += pcb->sack_sb[i].right - seqno;
+        }
+    }
+
+    return (ranges >= TCP_SACK_DUPTHRESH) ||
+        (sacked > (u32_t)(TCP_SACK_DUPTHRESH - 1) * pcb->mss);
+}
+
+/* Check whether the whole segment is covered by a single scoreboard range. */
+static u8_t tcp_sack_is_sacked(struct tcp_pcb *pcb, struct tcp_seg *seg)
+{
+    u8_t i;
+
+    for (i = 0; i < pcb->sack_sb_cnt && TCP_SEQ_LEQ(pcb->sack_sb[i].left, seg->seqno); ++i) {
+        if (TCP_SEQ_GEQ(pcb->sack_sb[i].right, seg->seqno + TCP_TCPLEN(seg))) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Requeue lost segments for retransmission during SACK based loss recovery.
+ *
+ * The number of bytes in flight (RFC 6675 SetPipe) is estimated from the
+ * unacked queue: segments below HighRxt have been retransmitted, segments
+ * above it are in flight unless they are lost. Holes are retransmitted in
+ * sequence order while the estimate allows one more MSS within cwnd.
+ *
+ * Called by tcp_receive() for each ACK received in loss recovery.
+ *
+ * @param pcb the tcp_pcb in loss recovery
+ */
+void tcp_sack_rexmit(struct tcp_pcb *pcb)
+{
+    struct tcp_seg *seg, *prev, *next;
+    u32_t pipe = 0;
+    u8_t sacked;
+
+    if (TCP_SEQ_LT(pcb->high_rxt, pcb->lastack)) {
+        pcb->high_rxt = pcb->lastack;
+    }
+
+    for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+        if (!tcp_sack_is_sacked(pcb, seg) && !TCP_SEG_RACK_LOST(seg) &&
+            (TCP_SEQ_LT(seg->seqno, pcb->high_rxt) || !tcp_sack_is_lost(pcb, seg->seqno))) {
+            pipe += seg->len;
         }
+    }
 
-        /* The minimum value for ssthresh should be 2 MSS */
-        if (pcb->ssthresh < (2U * pcb->mss)) {
+    prev = NULL;
+    for (seg = pcb->unacked; seg != NULL && pipe + pcb->mss <= pcb->cwnd; seg = next) {
+        next = seg->next;
+        sacked = tcp_sack_is_sacked(pcb, seg);
+        if (!sacked &&
+            (TCP_SEG_RACK_LOST(seg) ||
+             (TCP_SEQ_GEQ(seg->seqno, pcb->high_rxt) && tcp_sack_is_lost(pcb, seg->seqno)))) {
             LWIP_DEBUGF(TCP_FR_DEBUG,
-                        ("tcp_receive: The minimum value for ssthresh %" U16_F
-                         " should be min 2 mss %" U16_F "...\n",
-                         pcb->ssthresh, 2 * pcb->mss));
-            pcb->ssthresh = 2 * pcb->mss;
+                        ("tcp_sack_rexmit: retransmit %" U32_F ":%" U32_F ", pipe %" U32_F "\n",
+                         seg->seqno, seg->seqno + seg->len, pipe));
+            if (TCP_SEQ_GT(seg->seqno + TCP_TCPLEN(seg), pcb->high_rxt)) {
+                pcb->high_rxt = seg->seqno + TCP_TCPLEN(seg);
+            }
+            pipe += seg->len;
+            tcp_rexmit_requeue(pcb, prev, seg);
+            pcb->rttest = 0;
+        } else if (!sacked && TCP_SEQ_GEQ(seg->seqno, pcb->high_rxt) && !TCP_RACK_ENABLED(pcb)) {
+            /* Segments above are not lost either, only RACK may mark them lost */
+            break;
+        } else {
+            prev = seg;
         }
+    }
+}
+#endif /* LWIP_TCP_SACK */
 
-        pcb->cwnd = pcb->ssthresh + 3 * pcb->mss;
-#endif
-        pcb->flags |= TF_INFR;
+#if LWIP_TCP_RACK_TLP
+/**
+ * Update the RACK state with a segment which has been delivered (RFC 8985 6.2).
+ *
+ * Called by tcp_receive() for cumulatively acknowledged segments and by
+ * tcp_rack_detect_loss() for SACKed ones.
+ *
+ * @param pcb the tcp_pcb
+ * @param seg the delivered segment
+ * @param now current time in usec
+ */
+void tcp_rack_update(struct tcp_pcb *pcb, struct tcp_seg *seg, u64_t now)
+{
+    u32_t rtt;
+
+    if (seg->xmit_us == 0) {
+        return;
+    }
+    rtt = (u32_t)(now - seg->xmit_us);
+
+    if (seg->rack_flags & TF_SEG_RACK_REXMIT) {
+        /* The ACK may be for the original transmission, ignore a sample which is
+           shorter than the minimum RTT. */
+        if (rtt < pcb->rack_min_rtt_us) {
+            return;
+        }
+    } else {
+        if (pcb->rack_min_rtt_us == 0 || rtt < pcb->rack_min_rtt_us) {
+            pcb->rack_min_rtt_us = rtt;
+        }
+        if (pcb->rack_srtt_us == 0) {
+            pcb->rack_srtt_us = rtt;
+        } else {
+            pcb->rack_srtt_us = pcb->rack_srtt_us - (pcb->rack_srtt_us >> 3) + (rtt >> 3);
+        }
+    }
+
+    if (pcb->rack_xmit_us < seg->xmit_us ||
+        (pcb->rack_xmit_us == seg->xmit_us &&
+         TCP_SEQ_GT(seg->seqno + TCP_TCPLEN(seg), pcb->rack_end_seq))) {
+        pcb->rack_rtt_us = rtt;
+        pcb->rack_xmit_us = seg->xmit_us;
+        pcb->rack_end_seq = seg->seqno + TCP_TCPLEN(seg);
+    }
+}
+
+/**
+ * Mark the unacked segments which were sent before the most recently delivered
+ * segment and are not delivered within the reordering window as lost (RFC 8985 6.2).
+ * The reordering timer is armed for the segments whose window has not expired yet.
+ *
+ * @param pcb the tcp_pcb
+ * @param now current time in usec
+ * @return 1 if any segment has been marked lost and 0 otherwise
+ */
+u8_t tcp_rack_detect_loss(struct tcp_pcb *pcb, u64_t now)
+{
+    struct tcp_seg *seg;
+    u64_t deadline;
+    u64_t timeout = 0;
+    u32_t reo_wnd;
+    u32_t sacked = 0;
+    u8_t lost = 0;
+
+    for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+        if (seg->rack_flags & TF_SEG_RACK_DELIVERED) {
+            ++sacked;
+        } else if (tcp_sack_is_sacked(pcb, seg)) {
+            seg->rack_flags |= TF_SEG_RACK_DELIVERED;
+            tcp_rack_update(pcb, seg, now);
+            ++sacked;
+        }
+    }
+
+    pcb->rack_reo_timeout_us = 0;
+    if (pcb->rack_xmit_us == 0) {
+        return 0;
+    }
+
+    /* Reordering is not tracked, so the window is closed once loss recovery is
+       started or DupThresh segments are SACKed (RFC 8985 6.2 step 4). */
+    if ((pcb->flags & TF_INFR) || sacked >= TCP_SACK_DUPTHRESH) {
+        reo_wnd = 0;
+    } else {
+        reo_wnd = LWIP_MIN(pcb->rack_min_rtt_us >> 2, pcb->rack_srtt_us);
+    }
+
+    for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+        if ((seg->rack_flags & (TF_SEG_RACK_DELIVERED | TF_SEG_RACK_LOST)) ||
+            seg->xmit_us > pcb->rack_xmit_us ||
+            (seg->xmit_us == pcb->rack_xmit_us &&
+             TCP_SEQ_GEQ(seg->seqno + TCP_TCPLEN(seg), pcb->rack_end_seq))) {
+            continue;
+        }
+        deadline = seg->xmit_us + pcb->rack_rtt_us + reo_wnd;
+        if (deadline <= now) {
+            LWIP_DEBUGF(TCP_FR_DEBUG,
+                        ("tcp_rack_detect_loss: lost %" U32_F ":%" U32_F "\n", seg->seqno,
+                         seg->seqno + seg->len));
+            seg->rack_flags |= TF_SEG_RACK_LOST;
+            ++pcb->stat_rack_lost;
+            lost = 1;
+        } else if (timeout == 0 || deadline < timeout) {
+            timeout = deadline;
+        }
+    }
+    pcb->rack_reo_timeout_us = timeout;
+
+    return lost;
+}
+
+/**
+ * Enter SACK based loss recovery after RACK has marked segments lost.
+ * The lost segments are retransmitted by tcp_sack_rexmit().
+ *
+ * @param pcb the tcp_pcb
+ */
+void tcp_rack_enter_recovery(struct tcp_pcb *pcb)
+{
+    pcb->recovery_point = pcb->snd_nxt;
+    pcb->high_rxt = pcb->lastack;
+    pcb->tlp_timeout_us = 0;
+    tcp_cc_enter_recovery(pcb);
+}
+
+/**
+ * Arm the Tail Loss Probe timer (RFC 8985 7.2) or disarm it when a probe is
+ * not allowed: in loss recovery, after an RTO or while a probe is outstanding.
+ *
+ * @param pcb the tcp_pcb
+ * @param now current time in usec
+ */
+void tcp_tlp_schedule(struct tcp_pcb *pcb, u64_t now)
+{
+    u32_t pto;
+
+    if (!TCP_RACK_ENABLED(pcb) || pcb->unacked == NULL || (pcb->flags & TF_INFR) ||
+        pcb->nrtx != 0 || pcb->tlp_outstanding ||
+        (get_tcp_state(pcb) != ESTABLISHED && get_tcp_state(pcb) != CLOSE_WAIT)) {
+        pcb->tlp_timeout_us = 0;
+        return;
+    }
+
+    pto = pcb->rack_srtt_us ? 2 * pcb->rack_srtt_us : TCP_TLP_PTO_INIT_US;
+    if (pcb->unacked->next == NULL) {
+        /* A single segment in flight may be acknowledged by a delayed ACK */
+        pto += TCP_TLP_WCDELACK_US;
+    }
+    pcb->tlp_timeout_us = now + pto;
+}
+
+/**
+ * Send a Tail Loss Probe (RFC 8985 7.3): new data if the windows allow it,
+ * otherwise a retransmission of the last unacked segment.
+ *
+ * @param pcb the tcp_pcb
+ */
+static void tcp_tlp_send_probe(struct tcp_pcb *pcb)
+{
+    struct tcp_seg *seg, *prev = NULL;
+    u32_t snd_nxt = pcb->snd_nxt;
+    u16_t nodelay;
+
+    pcb->tlp_timeout_us = 0;
+    if (pcb->unsent != NULL) {
+        tcp_output(pcb);
+    }
+
+    pcb->tlp_is_retrans = 0;
+    if (pcb->snd_nxt == snd_nxt && pcb->unacked != NULL) {
+        for (seg = pcb->unacked; seg->next != NULL; seg = seg->next) {
+            prev = seg;
+        }
+        if (tcp_sack_is_sacked(pcb, seg)) {
+            return;
+        }
+        LWIP_DEBUGF(TCP_RTO_DEBUG,
+                    ("tcp_tlp_send_probe: retransmit %" U32_F ":%" U32_F "\n", seg->seqno,
+                     seg->seqno + seg->len));
+        tcp_rexmit_requeue(pcb, prev, seg);
+        pcb->rttest = 0;
+        pcb->tlp_is_retrans = 1;
+
+        /* The probe must not be held back by the Nagle algorithm */
+        nodelay = pcb->flags & TF_NODELAY;
+        pcb->flags |= TF_NODELAY;
+        tcp_output(pcb);
+        pcb->flags = (pcb->flags & ~TF_NODELAY) | nodelay;
+    }
+
+    /* One probe per episode, the retransmission timer takes over from here */
+    pcb->tlp_high_seq = pcb->snd_nxt;
+    pcb->tlp_outstanding = 1;
+    pcb->tlp_timeout_us = 0;
+    ++pcb->stat_tlp_probes;
+}
+
+/**
+ * Returns the earliest deadline of the RACK reordering timer and the Tail Loss
+ * Probe timer in usec, or 0 if none of them is armed.
+ *
+ * The timers are shorter than the fast timer period, so the caller uses the
+ * deadline to call tcp_rack_tlp_tmr() in time.
+ *
+ * @param pcb the tcp_pcb
+ */
+u64_t tcp_rack_tlp_deadline(const struct tcp_pcb *pcb)
+{
+    u64_t reo = pcb->rack_reo_timeout_us;
+    u64_t tlp = pcb->tlp_timeout_us;
+
+    if (reo && tlp) {
+        return LWIP_MIN(reo, tlp);
+    }
+    return reo ? reo : tlp;
+}
+
+/**
+ * Serve the RACK reordering timer and the Tail Loss Probe timer.
+ *
+ * Called by tcp_fasttmr() and by the caller's own timer of the deadline
+ * reported by tcp_rack_tlp_deadline().
+ *
+ * @param pcb the tcp_pcb
+ */
+void tcp_rack_tlp_tmr(struct tcp_pcb *pcb)
+{
+    u64_t now;
+
+    if (!TCP_RACK_ENABLED(pcb) || pcb->unacked == NULL) {
+        pcb->rack_reo_timeout_us = 0;
+        pcb->tlp_timeout_us = 0;
+        return;
+    }
+
+    now = sys_now_us();
+    if (pcb->rack_reo_timeout_us && pcb->rack_reo_timeout_us <= now &&
+        tcp_rack_detect_loss(pcb, now)) {
+        if (!(pcb->flags & TF_INFR)) {
+            tcp_rack_enter_recovery(pcb);
+        }
+        tcp_sack_rexmit(pcb);
+        tcp_output(pcb);
+        return;
+    }
+
+    if (pcb->tlp_timeout_us && pcb->tlp_timeout_us <= now) {
+        tcp_tlp_send_probe(pcb);
     }
 }
+#endif /* LWIP_TCP_RACK_TLP */
 
 /**
  * Send keepalive packets to keep a connection active although
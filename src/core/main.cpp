@@ -55,6 +55,7 @@
 #include "dev/buffer_pool.h"
 #include "dev/ib_ctx_handler_collection.h"
 #include "dev/net_device_table_mgr.h"
+#include "dev/ring_xdp.h"
 #include "proto/ip_frag.h"
 #include "proto/xlio_lwip.h"
 #include "proto/route_table_mgr.h"
@@ -515,9 +516,30 @@ void print_xlio_global_settings()
                           MCE_DEFAULT_RING_LIMIT_PER_INTERFACE, SYS_VAR_RING_LIMIT_PER_INTERFACE,
                           "(no limit)");
     }
+    VLOG_PARAM_STRING("Ring TX combining", safe_mce_sys().ring_tx_combining,
+                      MCE_DEFAULT_RING_TX_COMBINING, SYS_VAR_RING_TX_COMBINING,
+                      safe_mce_sys().ring_tx_combining ? "Enabled" : "Disabled");
+    VLOG_PARAM_STRING("Ring TX doorbell coalescing", safe_mce_sys().ring_tx_db_coalesce,
+                      MCE_DEFAULT_RING_TX_DB_COALESCE, SYS_VAR_RING_TX_DB_COALESCE,
+                      safe_mce_sys().ring_tx_db_coalesce ? "Enabled" : "Disabled");
 
     VLOG_PARAM_NUMBER("Ring On Device Memory TX", safe_mce_sys().ring_dev_mem_tx,
                       MCE_DEFAULT_RING_DEV_MEM_TX, SYS_VAR_RING_DEV_MEM_TX);
+    VLOG_PARAM_STRING("Software loopback ring", safe_mce_sys().ring_loopback,
+                      MCE_DEFAULT_RING_LOOPBACK, SYS_VAR_RING_LOOPBACK,
+                      safe_mce_sys().ring_loopback ? "Enabled " : "Disabled");
+    if (safe_mce_sys().ring_loopback) {
+        VLOG_PARAM_NUMSTR("Loopback ring latency", safe_mce_sys().ring_loopback_latency_usec,
+                          MCE_DEFAULT_RING_LOOPBACK_LATENCY, SYS_VAR_RING_LOOPBACK_LATENCY,
+                          "(usec)");
+        VLOG_PARAM_NUMSTR("Loopback ring drop rate", safe_mce_sys().ring_loopback_drop_rate,
+                          MCE_DEFAULT_RING_LOOPBACK_DROP_RATE, SYS_VAR_RING_LOOPBACK_DROP_RATE,
+                          "(per million)");
+    }
+#if defined(DEFINED_XDP)
+    VLOG_PARAM_STRING("AF_XDP ring", safe_mce_sys().ring_xdp, MCE_DEFAULT_RING_XDP,
+                      SYS_VAR_RING_XDP, safe_mce_sys().ring_xdp ? "Enabled " : "Disabled");
+#endif
 
     if (safe_mce_sys().tcp_max_syn_rate) {
         VLOG_PARAM_NUMSTR("TCP max syn rate", safe_mce_sys().tcp_max_syn_rate,
@@ -557,8 +579,14 @@ void print_xlio_global_settings()
                       MCE_DEFAULT_TX_BUFS_BATCH_TCP, SYS_VAR_TX_BUFS_BATCH_TCP);
     VLOG_PARAM_NUMBER("Tx Segs Batch TCP", safe_mce_sys().tx_segs_batch_tcp,
                       MCE_DEFAULT_TX_SEGS_BATCH_TCP, SYS_VAR_TX_SEGS_BATCH_TCP);
+    VLOG_PARAM_STRING("Tx Multi-Packet WQE", safe_mce_sys().tx_mpw, MCE_DEFAULT_TX_MPW,
+                      SYS_VAR_TX_MPW, safe_mce_sys().tx_mpw ? "Enabled" : "Disabled");
+    VLOG_PARAM_NUMBER("Buffer Pool Cache Size", safe_mce_sys().buffer_pool_cache_size,
+                      MCE_DEFAULT_BUFFER_POOL_CACHE_SIZE, SYS_VAR_BUFFER_POOL_CACHE_SIZE);
     VLOG_PARAM_NUMBER("TCP Send Buffer size", safe_mce_sys().tcp_send_buffer_size,
                       MCE_DEFAULT_TCP_SEND_BUFFER_SIZE, SYS_VAR_TCP_SEND_BUFFER_SIZE);
+    VLOG_PARAM_NUMBER("TCP Rcvbuf autotune max", safe_mce_sys().tcp_rcvbuf_autotune_max,
+                      MCE_DEFAULT_TCP_RCVBUF_AUTOTUNE_MAX, SYS_VAR_TCP_RCVBUF_AUTOTUNE_MAX);
     VLOG_PARAM_NUMBER(
         "Rx Mem Bufs", safe_mce_sys().rx_num_bufs,
         (safe_mce_sys().enable_striding_rq ? MCE_DEFAULT_STRQ_NUM_BUFS : MCE_DEFAULT_RX_NUM_BUFS),
@@ -567,6 +595,8 @@ void print_xlio_global_settings()
         "Rx QP WRE", safe_mce_sys().rx_num_wr,
         (safe_mce_sys().enable_striding_rq ? MCE_DEFAULT_STRQ_NUM_WRE : MCE_DEFAULT_RX_NUM_WRE),
         SYS_VAR_RX_NUM_WRE);
+    VLOG_PARAM_NUMBER("Rx SRQ WRE", safe_mce_sys().rx_srq_num_wr, MCE_DEFAULT_RX_SRQ_NUM_WRE,
+                      SYS_VAR_RX_SRQ_NUM_WRE);
     VLOG_PARAM_NUMBER("Rx QP WRE Batching", safe_mce_sys().rx_num_wr_to_post_recv,
                       (safe_mce_sys().enable_striding_rq ? MCE_DEFAULT_STRQ_NUM_WRE_TO_POST_RECV
                                                          : MCE_DEFAULT_RX_NUM_WRE_TO_POST_RECV),
@@ -577,6 +607,10 @@ void print_xlio_global_settings()
                       SYS_VAR_RX_NUM_POLLS);
     VLOG_PARAM_NUMBER("Rx Poll Init Loops", safe_mce_sys().rx_poll_num_init,
                       MCE_DEFAULT_RX_NUM_POLLS_INIT, SYS_VAR_RX_NUM_POLLS_INIT);
+    VLOG_PARAM_STRING("Adaptive Poll", safe_mce_sys().poll_adaptive, MCE_DEFAULT_POLL_ADAPTIVE,
+                      SYS_VAR_POLL_ADAPTIVE, safe_mce_sys().poll_adaptive ? "Enabled " : "Disabled");
+    VLOG_PARAM_NUMBER("Rx Poll Min Loops", safe_mce_sys().rx_poll_num_min,
+                      MCE_DEFAULT_RX_NUM_POLLS_MIN, SYS_VAR_RX_NUM_POLLS_MIN);
     if (safe_mce_sys().rx_udp_poll_os_ratio) {
         VLOG_PARAM_NUMBER("Rx UDP Poll OS Ratio", safe_mce_sys().rx_udp_poll_os_ratio,
                           MCE_DEFAULT_RX_UDP_POLL_OS_RATIO, SYS_VAR_RX_UDP_POLL_OS_RATIO);
@@ -640,6 +674,8 @@ void print_xlio_global_settings()
         MCE_DEFAULT_STRQ_STRIDES_COMPENSATION_LEVEL, SYS_VAR_STRQ_STRIDES_COMPENSATION_LEVEL);
     VLOG_PARAM_NUMBER("Select Poll (usec)", safe_mce_sys().select_poll_num,
                       MCE_DEFAULT_SELECT_NUM_POLLS, SYS_VAR_SELECT_NUM_POLLS);
+    VLOG_PARAM_NUMBER("Select Poll Min (usec)", safe_mce_sys().select_poll_num_min,
+                      MCE_DEFAULT_SELECT_NUM_POLLS_MIN, SYS_VAR_SELECT_NUM_POLLS_MIN);
     VLOG_PARAM_STRING("Select Poll OS Force", safe_mce_sys().select_poll_os_force,
                       MCE_DEFAULT_SELECT_POLL_OS_FORCE, SYS_VAR_SELECT_POLL_OS_FORCE,
                       safe_mce_sys().select_poll_os_force ? "Enabled " : "Disabled");
@@ -700,6 +736,12 @@ void print_xlio_global_settings()
     VLOG_PARAM_STRING("CQ Keeps QP Full", safe_mce_sys().cq_keep_qp_full,
                       MCE_DEFAULT_CQ_KEEP_QP_FULL, SYS_VAR_CQ_KEEP_QP_FULL,
                       safe_mce_sys().cq_keep_qp_full ? "Enabled" : "Disabled");
+    VLOG_PARAM_STRING("CQ Rx Batch Prefetch", safe_mce_sys().cq_rx_batch_prefetch,
+                      MCE_DEFAULT_CQ_RX_BATCH_PREFETCH, SYS_VAR_CQ_RX_BATCH_PREFETCH,
+                      safe_mce_sys().cq_rx_batch_prefetch ? "Enabled" : "Disabled");
+    VLOG_PARAM_STRING("Rx CQE Compression", safe_mce_sys().rx_cqe_compression,
+                      MCE_DEFAULT_RX_CQE_COMPRESSION, SYS_VAR_RX_CQE_COMPRESSION,
+                      safe_mce_sys().rx_cqe_compression ? "Enabled" : "Disabled");
     VLOG_PARAM_NUMBER("QP Compensation Level", safe_mce_sys().qp_compensation_level,
                       (safe_mce_sys().enable_striding_rq ? MCE_DEFAULT_STRQ_COMPENSATION_LEVEL
                                                          : MCE_DEFAULT_QP_COMPENSATION_LEVEL),
@@ -714,12 +756,26 @@ void print_xlio_global_settings()
     VLOG_PARAM_NUMSTR("TCP control thread", safe_mce_sys().tcp_ctl_thread,
                       MCE_DEFAULT_TCP_CTL_THREAD, SYS_VAR_TCP_CTL_THREAD,
                       ctl_thread_str(safe_mce_sys().tcp_ctl_thread));
+    VLOG_PARAM_NUMSTR("TCP SYN cookies threshold", safe_mce_sys().tcp_syncookies,
+                      MCE_DEFAULT_TCP_SYNCOOKIES, SYS_VAR_TCP_SYNCOOKIES,
+                      safe_mce_sys().tcp_syncookies ? "(half-open connections)" : "(Disabled)");
+    VLOG_PARAM_NUMSTR("TCP Fast Open", safe_mce_sys().tcp_fastopen, MCE_DEFAULT_TCP_FASTOPEN,
+                      SYS_VAR_TCP_FASTOPEN, tcp_fastopen_str(safe_mce_sys().tcp_fastopen));
+    VLOG_PARAM_NUMSTR("TCP ECN", safe_mce_sys().tcp_ecn, MCE_DEFAULT_TCP_ECN, SYS_VAR_TCP_ECN,
+                      tcp_ecn_str(safe_mce_sys().tcp_ecn));
     VLOG_PARAM_NUMBER("TCP timestamp option", safe_mce_sys().tcp_ts_opt,
                       MCE_DEFAULT_TCP_TIMESTAMP_OPTION, SYS_VAR_TCP_TIMESTAMP_OPTION);
     VLOG_PARAM_NUMBER("TCP nodelay", safe_mce_sys().tcp_nodelay, MCE_DEFAULT_TCP_NODELAY,
                       SYS_VAR_TCP_NODELAY);
     VLOG_PARAM_NUMBER("TCP quickack", safe_mce_sys().tcp_quickack, MCE_DEFAULT_TCP_QUICKACK,
                       SYS_VAR_TCP_QUICKACK);
+    VLOG_PARAM_STRING("TCP SACK", safe_mce_sys().tcp_sack, MCE_DEFAULT_TCP_SACK, SYS_VAR_TCP_SACK,
+                      safe_mce_sys().tcp_sack ? "Enabled" : "Disabled");
+    VLOG_PARAM_STRING("TCP RACK-TLP", safe_mce_sys().tcp_rack_tlp, MCE_DEFAULT_TCP_RACK_TLP,
+                      SYS_VAR_TCP_RACK_TLP, safe_mce_sys().tcp_rack_tlp ? "Enabled" : "Disabled");
+    VLOG_PARAM_STRING("TCP software pacing", safe_mce_sys().tcp_sw_pacing,
+                      MCE_DEFAULT_TCP_SW_PACING, SYS_VAR_TCP_SW_PACING,
+                      safe_mce_sys().tcp_sw_pacing ? "Enabled" : "Disabled");
     VLOG_PARAM_NUMSTR(xlio_exception_handling::getName(), (int)safe_mce_sys().exception_handling,
                       xlio_exception_handling::MODE_DEFAULT, xlio_exception_handling::getSysVar(),
                       safe_mce_sys().exception_handling.to_str());
@@ -979,6 +1035,20 @@ static size_t calc_rx_wqe_buff_size()
             buff_size = g_p_net_device_table_mgr->get_max_mtu() + ETH_VLAN_HDR_LEN;
         }
     }
+    if (safe_mce_sys().ring_loopback) {
+        /* Software loopback ring copies whole frames including L2 header */
+        buff_size = std::max<size_t>(buff_size,
+                                     g_p_net_device_table_mgr->get_max_mtu() + ETH_VLAN_HDR_LEN);
+    }
+#if defined(DEFINED_XDP)
+    if (safe_mce_sys().ring_xdp) {
+        /* Buffers are UMEM chunks, the kernel places a frame after XDP headroom */
+        buff_size = std::max<size_t>(buff_size,
+                                     g_p_net_device_table_mgr->get_max_mtu() + ETH_VLAN_HDR_LEN +
+                                         RING_XDP_FRAME_HEADROOM);
+        buff_size = std::max<size_t>(buff_size, RING_XDP_MIN_CHUNK_SIZE);
+    }
+#endif
 
     return buff_size;
 }
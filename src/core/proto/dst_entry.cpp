@@ -66,6 +66,7 @@ dst_entry::dst_entry(const sock_addr &dst, uint16_t src_port, socket_data &sock_
     , m_b_tx_mem_buf_desc_list_pending(false)
     , m_ttl_hop_limit(sock_data.ttl_hop_limit)
     , m_tos(sock_data.tos)
+    , m_ecn(0)
     , m_pcp(sock_data.pcp)
     , m_id(0)
     , m_src_port(src_port)
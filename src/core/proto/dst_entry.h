@@ -106,17 +106,32 @@ public:
     {
         m_header->set_ip_ttl_hop_limit(ttl_hop_limit);
     }
-    inline void set_ip_tos(uint8_t tos) { m_header->set_ip_tos(tos); }
+    inline void set_ip_tos(uint8_t tos)
+    {
+        m_header->set_ip_tos(tos);
+        if (m_ecn) {
+            m_header->set_ip_ecn(m_ecn);
+        }
+    }
+    // ECN codepoint of the outgoing packets, negotiated by the transport.
+    inline void set_ip_ecn(uint8_t ecn)
+    {
+        m_ecn = ecn;
+        m_header->set_ip_ecn(ecn);
+    }
     inline bool set_pcp(uint32_t pcp)
     {
         return m_header->set_vlan_pcp(get_priority_by_tc_class(pcp));
     }
     inline void set_src_sel_prefs(uint8_t sel_flags) { m_src_sel_prefs = sel_flags; }
     inline ring *get_ring() { return m_p_ring; }
+    inline void tx_batch_start() { m_p_ring->tx_batch_start(m_id); }
+    inline void tx_batch_end() { m_p_ring->tx_batch_end(m_id); }
     inline ib_ctx_handler *get_ctx() { return m_p_ring->get_ctx(m_id); }
     inline sa_family_t get_sa_family() { return m_family; }
 
     uint8_t get_tos() const { return m_tos; }
+    uint8_t get_ecn() const { return m_ecn; }
     uint8_t get_ttl_hop_limit() const { return m_ttl_hop_limit; }
 
     void reset_inflight_zc_buffers_ctx(void *ctx)
@@ -166,6 +181,7 @@ protected:
     uint8_t m_ttl_hop_limit;
 
     uint8_t m_tos;
+    uint8_t m_ecn;
     uint8_t m_pcp;
     bool m_b_is_initialized;
 
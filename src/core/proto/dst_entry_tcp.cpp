@@ -34,6 +34,9 @@
 #include "mapping.h"
 #include "mem_desc.h"
 #include <netinet/tcp.h>
+#include <map>
+#include <mutex>
+#include "lwip/tcp.h"
 
 #define MODULE_NAME "dst_tcp"
 
@@ -46,6 +49,15 @@
 #define dst_tcp_logfine    __log_info_fine
 #define dst_tcp_logfuncall __log_info_finer
 
+/* Fast Open cookies are cached per destination and source address, as Linux does in
+ * tcp_metrics. The number of entries is bounded, new destinations are not cached once
+ * the limit is reached.
+ */
+#define FASTOPEN_CACHE_MAX 4096U
+
+static std::map<flow_tuple, struct tcp_fastopen> s_fastopen_cookies;
+static lock_spin s_fastopen_lock("dst_entry_tcp::fastopen");
+
 dst_entry_tcp::dst_entry_tcp(const sock_addr &dst, uint16_t src_port, socket_data &sock_data,
                              resource_allocation_key &ring_alloc_logic)
     : dst_entry(dst, src_port, sock_data, ring_alloc_logic)
@@ -59,6 +71,42 @@ dst_entry_tcp::~dst_entry_tcp()
 {
 }
 
+flow_tuple dst_entry_tcp::fastopen_key()
+{
+    return flow_tuple(get_dst_addr(), 0, get_src_addr(), 0, PROTO_TCP, get_sa_family());
+}
+
+bool dst_entry_tcp::get_fastopen_cookie(struct tcp_fastopen &cookie)
+{
+    flow_tuple key = fastopen_key();
+    std::lock_guard<decltype(s_fastopen_lock)> lock(s_fastopen_lock);
+    auto itr = s_fastopen_cookies.find(key);
+
+    if (itr == s_fastopen_cookies.end()) {
+        return false;
+    }
+    cookie = itr->second;
+    return true;
+}
+
+void dst_entry_tcp::set_fastopen_cookie(const struct tcp_fastopen &cookie)
+{
+    flow_tuple key = fastopen_key();
+    std::lock_guard<decltype(s_fastopen_lock)> lock(s_fastopen_lock);
+
+    if (s_fastopen_cookies.size() < FASTOPEN_CACHE_MAX || s_fastopen_cookies.count(key)) {
+        s_fastopen_cookies[key] = cookie;
+    }
+}
+
+void dst_entry_tcp::erase_fastopen_cookie()
+{
+    flow_tuple key = fastopen_key();
+    std::lock_guard<decltype(s_fastopen_lock)> lock(s_fastopen_lock);
+
+    s_fastopen_cookies.erase(key);
+}
+
 transport_t dst_entry_tcp::get_transport(const sock_addr &to)
 {
     NOT_IN_USE(to);
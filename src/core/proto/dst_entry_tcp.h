@@ -35,6 +35,8 @@
 
 #include "core/proto/dst_entry.h"
 
+struct tcp_fastopen;
+
 /* Structure for TCP scatter/gather I/O.  */
 typedef struct tcp_iovec {
     struct iovec iovec;
@@ -59,6 +61,14 @@ public:
     void put_buffer(mem_buf_desc_t *p_desc);
     void put_zc_buffer(mem_buf_desc_t *p_desc);
 
+    /* Fast Open cookie (RFC 7413) which the destination issued to the source address of
+     * the route. It outlives the connection and is shared by all the connections which
+     * use the same pair of addresses.
+     */
+    bool get_fastopen_cookie(struct tcp_fastopen &cookie);
+    void set_fastopen_cookie(const struct tcp_fastopen &cookie);
+    void erase_fastopen_cookie();
+
 protected:
     transport_t get_transport(const sock_addr &to);
     virtual uint8_t get_protocol_type() const { return IPPROTO_TCP; };
@@ -70,6 +80,8 @@ protected:
     virtual ssize_t pass_buff_to_neigh(const iovec *p_iov, size_t sz_iov, uint32_t packet_id = 0);
 
 private:
+    flow_tuple fastopen_key();
+
     const uint32_t m_n_sysvar_tx_bufs_batch_tcp;
     const uint32_t m_n_sysvar_user_huge_page_size;
     uint64_t m_user_huge_page_mask;
@@ -30,6 +30,8 @@
  * SOFTWARE.
  */
 
+#include <vector>
+
 #include "utils/bullseye.h"
 #include "core/util/utils.h"
 #include "dst_entry_udp.h"
@@ -475,6 +477,190 @@ ssize_t dst_entry_udp::fast_send_fragmented(const iovec *p_iov, const ssize_t sz
     return sz_data_payload;
 }
 
+// Build L2/L3/UDP headers in front of the payload of a GSO buffer.
+// sz_udp_payload is the UDP length of the whole WQE, udp_len is the length of a single datagram.
+inline void dst_entry_udp::fill_gso_hdrs(mem_buf_desc_t *p_mem_buf_desc, size_t sz_udp_payload,
+                                         uint16_t udp_len)
+{
+    void *p_pkt = p_mem_buf_desc->p_buffer;
+    void *p_ip_hdr;
+    void *p_udp_hdr;
+
+    m_header->copy_l2_ip_udp_hdr(p_pkt);
+
+    uint16_t payload_length_ipv4 = m_header->m_ip_header_len + sz_udp_payload;
+    if (get_sa_family() == AF_INET6) {
+        fill_hdrs<tx_ipv6_hdr_template_t>(p_pkt, p_ip_hdr, p_udp_hdr);
+        set_ipv6_len(p_ip_hdr, htons(payload_length_ipv4 - IPV6_HLEN));
+    } else {
+        fill_hdrs<tx_ipv4_hdr_template_t>(p_pkt, p_ip_hdr, p_udp_hdr);
+        set_ipv4_len(p_ip_hdr, htons(payload_length_ipv4));
+        reinterpret_cast<iphdr *>(p_ip_hdr)->frag_off = htons(0);
+        reinterpret_cast<iphdr *>(p_ip_hdr)->id = 0;
+    }
+
+    reinterpret_cast<udphdr *>(p_udp_hdr)->len = htons(udp_len);
+    p_mem_buf_desc->tx.p_ip_h = p_ip_hdr;
+    p_mem_buf_desc->tx.p_udp_h = reinterpret_cast<udphdr *>(p_udp_hdr);
+}
+
+// Every buffer of the list carries a single segment, so a group of buffers is posted
+// as one LSO WQE and HW replicates the headers. m_sge[0] is kept for the inline WQE.
+inline void dst_entry_udp::fast_send_gso_lso(mem_buf_desc_t *p_mem_buf_desc, int n_num_segs,
+                                             xlio_wr_tx_packet_attr attr, uint16_t gso_size,
+                                             ssize_t sz_data_payload)
+{
+    xlio_ibv_send_wr send_wqe;
+    size_t hdr_len = m_header->m_transport_header_len + m_header->m_ip_header_len + UDP_HLEN;
+    int n_max_segs_per_wqe = std::min<int>(m_p_ring->get_max_send_sge() - 1,
+                                           m_p_ring->get_max_payload_sz() / gso_size);
+    size_t sz_user_data_offset = 0;
+    uint32_t lkey = m_p_ring->get_tx_lkey(m_id);
+
+    while (n_num_segs > 0) {
+        int n_wqe_segs = std::min(n_num_segs, n_max_segs_per_wqe);
+        size_t sz_wqe_data =
+            std::min((size_t)n_wqe_segs * gso_size, sz_data_payload - sz_user_data_offset);
+        mem_buf_desc_t *p_wqe_desc = p_mem_buf_desc;
+        uint8_t *p_hdr = p_wqe_desc->p_buffer + m_header->m_transport_header_tx_offset;
+
+        fill_gso_hdrs(p_wqe_desc, sz_wqe_data + UDP_HLEN,
+                      (n_wqe_segs > 1 ? gso_size : sz_wqe_data) + UDP_HLEN);
+
+        for (int i = 1; i <= n_wqe_segs; ++i) {
+            size_t sz_seg = std::min((size_t)gso_size, sz_data_payload - sz_user_data_offset);
+            mem_buf_desc_t *tmp = p_mem_buf_desc->p_next_desc;
+
+            m_sge[i].addr = (uintptr_t)(p_mem_buf_desc->p_buffer +
+                                        m_header->m_transport_header_tx_offset + hdr_len);
+            m_sge[i].length = sz_seg;
+            m_sge[i].lkey = lkey;
+            sz_user_data_offset += sz_seg;
+
+            // The WQE owns its buffers only, they are released by the completion
+            if (i == n_wqe_segs) {
+                p_mem_buf_desc->p_next_desc = NULL;
+            }
+            p_mem_buf_desc = tmp;
+        }
+
+        m_p_send_wqe_handler->init_not_inline_wqe(send_wqe, &m_sge[1], n_wqe_segs);
+        if (n_wqe_segs > 1) {
+            m_p_send_wqe_handler->enable_tso(send_wqe, p_hdr, hdr_len, gso_size);
+        } else {
+            // Single datagram is sent as is, the headers precede the payload
+            m_sge[1].addr = (uintptr_t)p_hdr;
+            m_sge[1].length += hdr_len;
+        }
+        send_wqe.wr_id = (uintptr_t)p_wqe_desc;
+
+        dst_udp_logfunc("LSO: segs=%d, payload_sz=%zu, mss=%u", n_wqe_segs, sz_wqe_data,
+                        gso_size);
+
+        send_ring_buffer(m_id, &send_wqe, attr);
+        n_num_segs -= n_wqe_segs;
+    }
+}
+
+// Software segmentation: every datagram gets a copy of the header template
+inline void dst_entry_udp::fast_send_gso_sw(mem_buf_desc_t *p_mem_buf_desc, int n_num_segs,
+                                            xlio_wr_tx_packet_attr attr, uint16_t gso_size,
+                                            ssize_t sz_data_payload)
+{
+    size_t hdr_len = m_header->m_transport_header_len + m_header->m_ip_header_len + UDP_HLEN;
+    size_t sz_user_data_offset = 0;
+    uint32_t lkey = m_p_ring->get_tx_lkey(m_id);
+
+    m_p_send_wqe = &m_not_inline_send_wqe;
+
+    while (n_num_segs--) {
+        size_t sz_seg = std::min((size_t)gso_size, sz_data_payload - sz_user_data_offset);
+        mem_buf_desc_t *tmp = p_mem_buf_desc->p_next_desc;
+
+        fill_gso_hdrs(p_mem_buf_desc, sz_seg + UDP_HLEN, sz_seg + UDP_HLEN);
+
+        m_sge[1].addr =
+            (uintptr_t)(p_mem_buf_desc->p_buffer + m_header->m_transport_header_tx_offset);
+        m_sge[1].length = sz_seg + hdr_len;
+        m_sge[1].lkey = lkey;
+        m_p_send_wqe->wr_id = (uintptr_t)p_mem_buf_desc;
+
+        p_mem_buf_desc->p_next_desc = NULL;
+        send_ring_buffer(m_id, m_p_send_wqe, attr);
+
+        p_mem_buf_desc = tmp;
+        sz_user_data_offset += sz_seg;
+    }
+}
+
+ssize_t dst_entry_udp::fast_send_gso(const iovec *p_iov, const ssize_t sz_iov,
+                                     xlio_wr_tx_packet_attr attr, uint16_t gso_size,
+                                     ssize_t sz_data_payload)
+{
+    bool b_blocked = is_set(attr, XLIO_TX_PACKET_BLOCK);
+    int n_num_segs = (sz_data_payload + gso_size - 1) / gso_size;
+    size_t hdr_len = m_header->m_transport_header_len + m_header->m_ip_header_len + UDP_HLEN;
+
+    dst_udp_logfunc("udp gso: payload_sz=%d, gso_size=%u, segs=%d, blocked=%s", sz_data_payload,
+                    gso_size, n_num_segs, b_blocked ? "true" : "false");
+
+    // Same as the kernel, a segment must not require IP fragmentation
+    if (unlikely(((size_t)gso_size + UDP_HLEN) > (size_t)m_max_udp_payload_size) ||
+        unlikely(n_num_segs > UDP_MAX_SEGMENTS)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Get a tx buffer per segment
+    mem_buf_desc_t *p_mem_buf_desc =
+        m_p_ring->mem_buf_tx_get(m_id, b_blocked, PBUF_RAM, n_num_segs);
+
+    if (unlikely(p_mem_buf_desc == NULL)) {
+        if (b_blocked) {
+            dst_udp_logdbg("Error when blocking for next tx buffer (errno=%d %m)", errno);
+        } else {
+            dst_udp_logfunc(
+                "Packet dropped. NonBlocked call but not enough tx buffers. Returning OK");
+            if (!m_b_sysvar_tx_nonblocked_eagains) {
+                return sz_data_payload;
+            }
+        }
+        errno = EAGAIN;
+        return -1;
+    }
+
+    // Copy user data to our tx buffers, the headers room is left in front of each segment
+    size_t sz_user_data_offset = 0;
+    for (mem_buf_desc_t *p_desc = p_mem_buf_desc; p_desc; p_desc = p_desc->p_next_desc) {
+        size_t sz_seg = std::min((size_t)gso_size, sz_data_payload - sz_user_data_offset);
+        uint8_t *p_payload = p_desc->p_buffer + m_header->m_transport_header_tx_offset + hdr_len;
+
+        int ret = memcpy_fromiovec(p_payload, p_iov, sz_iov, sz_user_data_offset, sz_seg);
+        BULLSEYE_EXCLUDE_BLOCK_START
+        if (ret != (int)sz_seg) {
+            dst_udp_logerr("memcpy_fromiovec error (sz_user_data_to_copy=%lu, ret=%d)", sz_seg,
+                           ret);
+            m_p_ring->mem_buf_tx_release(p_mem_buf_desc, true);
+            errno = EINVAL;
+            return -1;
+        }
+        BULLSEYE_EXCLUDE_BLOCK_END
+        sz_user_data_offset += sz_seg;
+    }
+
+    // All datagrams are submitted to HW with a single doorbell
+    m_p_ring->tx_batch_start(m_id);
+    if (m_p_ring->is_tso() && m_p_ring->get_max_send_sge() > 2 &&
+        m_p_ring->get_max_payload_sz() >= 2U * gso_size) {
+        fast_send_gso_lso(p_mem_buf_desc, n_num_segs, attr, gso_size, sz_data_payload);
+    } else {
+        fast_send_gso_sw(p_mem_buf_desc, n_num_segs, attr, gso_size, sz_data_payload);
+    }
+    m_p_ring->tx_batch_end(m_id);
+
+    return sz_data_payload;
+}
+
 ssize_t dst_entry_udp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_send_attr attr)
 {
     /* Suppress flags that should not be used anymore
@@ -482,6 +668,13 @@ ssize_t dst_entry_udp::fast_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
      */
     attr.flags = (xlio_wr_tx_packet_attr)(attr.flags & ~(XLIO_TX_PACKET_ZEROCOPY | XLIO_TX_FILE));
 
+    // UDP GSO, the payload is split into datagrams of attr.mss bytes
+    if (attr.mss && attr.length > attr.mss) {
+        attr.flags =
+            (xlio_wr_tx_packet_attr)(attr.flags | XLIO_TX_PACKET_L3_CSUM | XLIO_TX_PACKET_L4_CSUM);
+        return fast_send_gso(p_iov, sz_iov, attr.flags, attr.mss, attr.length);
+    }
+
     // Calc udp payload size
     size_t sz_udp_payload = attr.length + sizeof(struct udphdr);
     if (sz_udp_payload <= (size_t)m_max_udp_payload_size) {
@@ -512,7 +705,11 @@ ssize_t dst_entry_udp::slow_send(const iovec *p_iov, const ssize_t sz_iov, xlio_
                               to_saddr.get_socklen());
     } else {
         if (!is_valid()) { // That means that the neigh is not resolved yet
-            ret_val = pass_buff_to_neigh(p_iov, sz_iov);
+            if (attr.mss && attr.length > attr.mss) {
+                ret_val = pass_buff_to_neigh_gso(p_iov, sz_iov, attr.mss, attr.length);
+            } else {
+                ret_val = pass_buff_to_neigh(p_iov, sz_iov);
+            }
         } else {
             ret_val = fast_send(p_iov, sz_iov, attr);
         }
@@ -537,3 +734,46 @@ ssize_t dst_entry_udp::pass_buff_to_neigh(const iovec *p_iov, size_t sz_iov, uin
 
     return (dst_entry::pass_buff_to_neigh(p_iov, sz_iov, packet_id));
 }
+
+// Queue every GSO segment to the neigh as a separate datagram
+ssize_t dst_entry_udp::pass_buff_to_neigh_gso(const iovec *p_iov, const ssize_t sz_iov,
+                                              uint16_t gso_size, ssize_t sz_data_payload)
+{
+    std::vector<iovec> seg_iov;
+    size_t sz_user_data_offset = 0;
+    ssize_t i = 0;
+    size_t iov_offset = 0;
+
+    if (unlikely(((size_t)gso_size + UDP_HLEN) > (size_t)m_max_udp_payload_size)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    while (sz_user_data_offset < (size_t)sz_data_payload) {
+        size_t sz_seg = std::min((size_t)gso_size, sz_data_payload - sz_user_data_offset);
+        size_t sz_left = sz_seg;
+
+        // Slice [sz_user_data_offset, sz_user_data_offset + sz_seg) of the user iovec
+        seg_iov.clear();
+        while (sz_left && i < sz_iov) {
+            size_t sz_chunk = std::min(sz_left, p_iov[i].iov_len - iov_offset);
+            if (sz_chunk) {
+                seg_iov.push_back({(uint8_t *)p_iov[i].iov_base + iov_offset, sz_chunk});
+            }
+            sz_left -= sz_chunk;
+            iov_offset += sz_chunk;
+            if (iov_offset == p_iov[i].iov_len) {
+                iov_offset = 0;
+                i++;
+            }
+        }
+
+        ssize_t ret = pass_buff_to_neigh(seg_iov.data(), seg_iov.size());
+        if (ret < 0) {
+            return ret;
+        }
+        sz_user_data_offset += sz_seg;
+    }
+
+    return sz_data_payload;
+}
@@ -35,6 +35,11 @@
 
 #include "core/proto/dst_entry.h"
 
+/* Maximum number of datagrams a single UDP GSO send can be split into */
+#ifndef UDP_MAX_SEGMENTS
+#define UDP_MAX_SEGMENTS (1 << 7UL)
+#endif
+
 class dst_entry_udp : public dst_entry {
 public:
     dst_entry_udp(const sock_addr &dst, uint16_t src_port, socket_data &sock_data,
@@ -93,6 +98,18 @@ private:
     ssize_t fast_send_fragmented(const iovec *p_iov, const ssize_t sz_iov,
                                  xlio_wr_tx_packet_attr attr, size_t sz_udp_payload,
                                  ssize_t sz_data_payload);
+    inline void fill_gso_hdrs(mem_buf_desc_t *p_mem_buf_desc, size_t sz_udp_payload,
+                              uint16_t udp_len);
+    inline void fast_send_gso_lso(mem_buf_desc_t *p_mem_buf_desc, int n_num_segs,
+                                  xlio_wr_tx_packet_attr attr, uint16_t gso_size,
+                                  ssize_t sz_data_payload);
+    inline void fast_send_gso_sw(mem_buf_desc_t *p_mem_buf_desc, int n_num_segs,
+                                 xlio_wr_tx_packet_attr attr, uint16_t gso_size,
+                                 ssize_t sz_data_payload);
+    ssize_t fast_send_gso(const iovec *p_iov, const ssize_t sz_iov, xlio_wr_tx_packet_attr attr,
+                          uint16_t gso_size, ssize_t sz_data_payload);
+    ssize_t pass_buff_to_neigh_gso(const iovec *p_iov, const ssize_t sz_iov, uint16_t gso_size,
+                                   ssize_t sz_data_payload);
 
     const uint32_t m_n_sysvar_tx_bufs_batch_udp;
     const bool m_b_sysvar_tx_nonblocked_eagains;
@@ -118,6 +118,22 @@ void header_ipv4::set_ip_tos(uint8_t tos)
     p_hdr->tos = tos;
 }
 
+void header_ipv4::set_ip_ecn(uint8_t ecn)
+{
+    iphdr *p_hdr = &m_header.hdr.m_ip_hdr;
+
+    p_hdr->tos = (p_hdr->tos & ~IPTOS_ECN_MASK) | (ecn & IPTOS_ECN_MASK);
+}
+
+void header_ipv6::set_ip_ecn(uint8_t ecn)
+{
+    ip6_hdr *p_hdr = &m_header.hdr.m_ip_hdr;
+
+    // ECN is the low 2 bits of the traffic class: version(4) + tclass(8) + flow_lbl(20)
+    p_hdr->ip6_flow = (p_hdr->ip6_flow & ~htonl(IPTOS_ECN_MASK << 20)) |
+        htonl((ecn & IPTOS_ECN_MASK) << 20);
+}
+
 void header::configure_eth_headers(const L2_address &src, const L2_address &dst,
                                    uint16_t encapsulated_proto)
 {
@@ -207,6 +223,10 @@ void header_ipv4::configure_ip_header(uint8_t protocol, const ip_address &src,
 
     m_ip_header_len = IPV4_HDR_LEN_WITHOUT_OPTIONS;
     m_total_hdr_len += m_ip_header_len;
+
+    if (_dst_entry.get_ecn()) {
+        set_ip_ecn(_dst_entry.get_ecn());
+    }
 }
 
 void header_ipv4::copy_l2_hdr(void *p_h)
@@ -292,6 +312,7 @@ void header_ipv6::configure_ip_header(uint8_t protocol, const ip_address &src,
     NOT_IN_USE(packet_id);
     configure_ip_header(protocol, src, dest);
     set_ip_ttl_hop_limit(_dst_entry.get_ttl_hop_limit());
+    set_ip_ecn(_dst_entry.get_ecn());
 }
 
 void header_ipv6::copy_l2_hdr(void *p_h)
@@ -133,6 +133,7 @@ public:
                                      uint16_t packet_id = 0) = 0;
     virtual void set_ip_ttl_hop_limit(uint8_t ttl_hop_limit) = 0;
     virtual void set_ip_tos(uint8_t tos) { NOT_IN_USE(tos); };
+    virtual void set_ip_ecn(uint8_t ecn) = 0;
     virtual void *get_hdr_addr() = 0;
     virtual l2_hdr_template_t *get_l2_hdr() = 0;
     virtual void *get_ip_hdr() = 0;
@@ -164,6 +165,7 @@ public:
                              const dst_entry &_dst_entry, uint16_t packet_id = 0) override;
     void set_ip_ttl_hop_limit(uint8_t ttl_hop_limit) override;
     void set_ip_tos(uint8_t tos) override;
+    void set_ip_ecn(uint8_t ecn) override;
     void *get_hdr_addr() override { return (static_cast<void *>(&m_header)); }
     l2_hdr_template_t *get_l2_hdr() override { return &m_header.hdr.m_l2_hdr; }
     void *get_ip_hdr() override { return static_cast<void *>(&m_header.hdr.m_ip_hdr); }
@@ -190,6 +192,7 @@ public:
     void configure_ip_header(uint8_t protocol, const ip_address &src, const ip_address &dest,
                              const dst_entry &_dst_entry, uint16_t packet_id = 0) override;
     void set_ip_ttl_hop_limit(uint8_t ttl_hop_limit) override;
+    void set_ip_ecn(uint8_t ecn) override;
     void *get_hdr_addr() override { return (static_cast<void *>(&m_header)); }
     l2_hdr_template_t *get_l2_hdr() override { return &m_header.hdr.m_l2_hdr; }
     void *get_ip_hdr() override { return static_cast<void *>(&m_header.hdr.m_ip_hdr); }
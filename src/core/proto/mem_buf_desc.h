@@ -134,6 +134,7 @@ public:
                 } tcp;
                 struct {
                     int ifindex; // Incoming interface index
+                    uint16_t gro_size; // Segment size of coalesced datagrams, 0 - not coalesced
                 } udp;
             };
 
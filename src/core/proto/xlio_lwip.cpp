@@ -65,6 +65,14 @@ u32_t xlio_lwip::sys_now(void)
     return now.tv_sec * 1000 + now.tv_nsec / 1000000;
 }
 
+u64_t xlio_lwip::sys_now_us(void)
+{
+    struct timespec now;
+
+    gettimefromtsc(&now);
+    return (u64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
 u8_t xlio_lwip::read_tcp_timestamp_option(void)
 {
     u8_t res = (safe_mce_sys().tcp_ts_opt == TCP_TS_OPTION_FOLLOW_OS)
@@ -99,17 +107,24 @@ xlio_lwip::xlio_lwip()
     lwip_logdbg("");
 
     lwip_cc_algo_module = (enum cc_algo_mod)safe_mce_sys().lwip_cc_algo_mod;
+    enable_ecn_option = (u8_t)safe_mce_sys().tcp_ecn;
 
     lwip_tcp_mss = get_lwip_tcp_mss(safe_mce_sys().mtu, safe_mce_sys().lwip_mss);
     lwip_tcp_snd_buf = safe_mce_sys().tcp_send_buffer_size;
     lwip_zc_tx_size = safe_mce_sys().zc_tx_size;
+    // Paced data is released at least once per timer tick
+    lwip_tcp_pacing_horizon_us = safe_mce_sys().timer_resolution_msec * 1000;
     BULLSEYE_EXCLUDE_BLOCK_END
 
     enable_push_flag = !!safe_mce_sys().tcp_push_flag;
     enable_ts_option = read_tcp_timestamp_option();
+    enable_sack_option = safe_mce_sys().tcp_sack && safe_mce_sys().sysctl_reader.get_tcp_sack();
+    enable_rack_tlp_option = !!safe_mce_sys().tcp_rack_tlp;
     int is_window_scaling_enabled = safe_mce_sys().sysctl_reader.get_tcp_window_scaling();
     if (is_window_scaling_enabled) {
-        int rmem_max_value = safe_mce_sys().sysctl_reader.get_tcp_rmem()->max_value;
+        // The window scale must allow the receive buffer auto-tuning to reach its maximum
+        int rmem_max_value = std::max(safe_mce_sys().sysctl_reader.get_tcp_rmem()->max_value,
+                                      safe_mce_sys().tcp_rcvbuf_autotune_max);
         int core_rmem_max = safe_mce_sys().sysctl_reader.get_net_core_rmem_max();
         enable_wnd_scale = 1;
         rcv_wnd_scale = get_window_scaling_factor(rmem_max_value, core_rmem_max);
@@ -129,6 +144,7 @@ xlio_lwip::xlio_lwip()
     register_tcp_state_observer(sockinfo_tcp::tcp_state_observer);
     register_ip_route_mtu(sockinfo_tcp::get_route_mtu);
     register_sys_now(sys_now);
+    register_sys_now_us(sys_now_us);
     set_tmr_resolution(safe_mce_sys().tcp_timer_resolution_msec);
     // tcp_ticks increases in the rate of tcp slow_timer
     void *node = g_p_event_handler_manager->register_timer_event(
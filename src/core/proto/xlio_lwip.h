@@ -87,6 +87,10 @@ static inline const char *lwip_cc_algo_str(uint32_t algo)
         return "(CUBIC)";
     case CC_MOD_NONE:
         return "(NONE)";
+    case CC_MOD_BBR:
+        return "(BBR)";
+    case CC_MOD_DCTCP:
+        return "(DCTCP)";
     case CC_MOD_LWIP:
     default:
         return "(LWIP)";
@@ -101,6 +105,7 @@ public:
     virtual void handle_timer_expired(void *user_data);
 
     static u32_t sys_now(void);
+    static u64_t sys_now_us(void);
 
 private:
     bool m_run_timers;
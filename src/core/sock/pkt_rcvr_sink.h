@@ -62,6 +62,9 @@ public:
 
     // Callback from lower layer notifying before RX resources deallocation
     virtual void rx_del_ring_cb(ring *p_ring) = 0;
+
+    // Whether the receiver accepts datagrams coalesced by UDP GRO
+    virtual bool rx_gro_enabled() { return false; }
 };
 
 #endif
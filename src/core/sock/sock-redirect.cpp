@@ -46,6 +46,7 @@
 #include "utils/lock_wrapper.h"
 #include <proto/ip_frag.h>
 #include <dev/buffer_pool.h>
+#include <dev/ring.h>
 #include <event/event_handler_manager.h>
 #include <event/vlogger_timer_handler.h>
 #include <iomux/poll_call.h>
@@ -507,6 +508,21 @@ extern "C" int xlio_thread_offload(int offload, pthread_t tid)
     return 0;
 }
 
+extern "C" int xlio_tx_batch_begin(void)
+{
+    ring::tx_scope_begin();
+    return 0;
+}
+
+extern "C" int xlio_tx_batch_end(void)
+{
+    if (ring::tx_scope_end() < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
 extern "C" int xlio_dump_fd_stats(int fd, int log_level)
 {
     if (g_p_fd_collection) {
@@ -640,7 +656,11 @@ extern "C" EXPORT_SYMBOL int close(int __fd)
 
     srdr_logdbg_entry("fd=%d", __fd);
 
+    // The socket may release the last reference to a ring with a deferred doorbell,
+    // and packets sent on close, e.g. a FIN, must not wait for the next flush either.
+    ring::tx_scope_flush_all();
     bool toclose = handle_close(__fd);
+    ring::tx_scope_flush_all();
     int rc = toclose ? orig_os_api.close(__fd) : 0;
 
     return rc;
@@ -927,6 +947,8 @@ extern "C" EXPORT_SYMBOL int getsockopt(int __fd, int __level, int __optname, vo
                           XLIO_EXTRA_API_GET_SOCKET_RINGS_FDS);
             SET_EXTRA_API(dump_fd_stats, xlio_dump_fd_stats, XLIO_EXTRA_API_DUMP_FD_STATS);
             SET_EXTRA_API(ioctl, xlio_ioctl, XLIO_EXTRA_API_IOCTL);
+            SET_EXTRA_API(tx_batch_begin, xlio_tx_batch_begin, XLIO_EXTRA_API_TX_BATCH);
+            SET_EXTRA_API(tx_batch_end, xlio_tx_batch_end, XLIO_EXTRA_API_TX_BATCH);
         }
 
         *((xlio_api_t **)__optval) = xlio_api;
@@ -1343,20 +1365,6 @@ extern "C" EXPORT_SYMBOL ssize_t recvmsg(int __fd, struct msghdr *__msg, int __f
     return orig_os_api.recvmsg(__fd, __msg, __flags);
 }
 
-/* The following definitions are for kernels previous to 2.6.32 which dont support recvmmsg */
-#ifndef HAVE_STRUCT_MMSGHDR
-#ifndef __INTEL_COMPILER
-struct mmsghdr {
-    struct msghdr msg_hdr; // Message header
-    unsigned int msg_len; // Number of received bytes for header
-};
-#endif
-#endif
-
-#ifndef MSG_WAITFORONE
-#define MSG_WAITFORONE 0x10000 // recvmmsg(): block until 1+ packets avail
-#endif
-
 /* Receive multiple messages as described by MESSAGE from socket FD.
    Returns the number of messages received or -1 for errors.
 
@@ -1373,10 +1381,6 @@ extern "C" EXPORT_SYMBOL
              struct timespec *__timeout)
 #endif
 {
-    int num_of_msg = 0;
-    struct timespec start_time = TIMESPEC_INITIALIZER, current_time = TIMESPEC_INITIALIZER,
-                    delta_time = TIMESPEC_INITIALIZER;
-
     srdr_logfuncall_entry("fd=%d, mmsghdr length=%d flags=%x", __fd, __vlen, __flags);
 
     if (__mmsghdr == NULL) {
@@ -1385,42 +1389,10 @@ extern "C" EXPORT_SYMBOL
         return -1;
     }
 
-    if (__timeout) {
-        gettime(&start_time);
-    }
     socket_fd_api *p_socket_object = NULL;
     p_socket_object = fd_collection_get_sockfd(__fd);
     if (p_socket_object) {
-        int ret = 0;
-        for (unsigned int i = 0; i < __vlen; i++) {
-            int flags = __flags;
-            __mmsghdr[i].msg_hdr.msg_flags = 0;
-            ret = p_socket_object->rx(
-                RX_RECVMSG, __mmsghdr[i].msg_hdr.msg_iov, __mmsghdr[i].msg_hdr.msg_iovlen, &flags,
-                (__SOCKADDR_ARG)__mmsghdr[i].msg_hdr.msg_name,
-                (socklen_t *)&__mmsghdr[i].msg_hdr.msg_namelen, &__mmsghdr[i].msg_hdr);
-            if (ret < 0) {
-                break;
-            }
-            num_of_msg++;
-            __mmsghdr[i].msg_len = ret;
-            if ((i == 0) && (flags & MSG_WAITFORONE)) {
-                __flags |= MSG_DONTWAIT;
-            }
-            if (__timeout) {
-                gettime(&current_time);
-                ts_sub(&current_time, &start_time, &delta_time);
-                if (ts_cmp(&delta_time, __timeout, >)) {
-                    break;
-                }
-            }
-        }
-        if (num_of_msg || ret == 0) {
-            // todo save ret for so_error if ret != 0(see kernel)
-            return num_of_msg;
-        } else {
-            return ret;
-        }
+        return p_socket_object->rx_mmsg(__mmsghdr, __vlen, __flags, __timeout);
     }
     BULLSEYE_EXCLUDE_BLOCK_START
     if (!orig_os_api.recvmmsg) {
@@ -1676,8 +1648,6 @@ extern "C" EXPORT_SYMBOL ssize_t sendmsg(int __fd, __const struct msghdr *__msg,
 extern "C" EXPORT_SYMBOL int sendmmsg(int __fd, struct mmsghdr *__mmsghdr, unsigned int __vlen,
                                       int __flags)
 {
-    int num_of_msg = 0;
-
     srdr_logfuncall_entry("fd=%d, mmsghdr length=%d flags=%x", __fd, __vlen, __flags);
 
     if (__mmsghdr == NULL) {
@@ -1689,29 +1659,7 @@ extern "C" EXPORT_SYMBOL int sendmmsg(int __fd, struct mmsghdr *__mmsghdr, unsig
     socket_fd_api *p_socket_object = NULL;
     p_socket_object = fd_collection_get_sockfd(__fd);
     if (p_socket_object) {
-        for (unsigned int i = 0; i < __vlen; i++) {
-            xlio_tx_call_attr_t tx_arg;
-
-            tx_arg.opcode = TX_SENDMSG;
-            tx_arg.attr.iov = __mmsghdr[i].msg_hdr.msg_iov;
-            tx_arg.attr.sz_iov = (ssize_t)__mmsghdr[i].msg_hdr.msg_iovlen;
-            tx_arg.attr.flags = __flags;
-            tx_arg.attr.addr = (struct sockaddr *)(__SOCKADDR_ARG)__mmsghdr[i].msg_hdr.msg_name;
-            tx_arg.attr.len = (socklen_t)__mmsghdr[i].msg_hdr.msg_namelen;
-            tx_arg.attr.hdr = &__mmsghdr[i].msg_hdr;
-
-            int ret = p_socket_object->tx(tx_arg);
-            if (ret < 0) {
-                if (num_of_msg) {
-                    return num_of_msg;
-                } else {
-                    return ret;
-                }
-            }
-            num_of_msg++;
-            __mmsghdr[i].msg_len = ret;
-        }
-        return num_of_msg;
+        return p_socket_object->tx_mmsg(__mmsghdr, __vlen, __flags);
     }
 
     // Ignore dummy messages for OS
@@ -2032,6 +1980,29 @@ const char *dbg_sprintf_fdset(char *buf, int buflen, int __nfds, fd_set *__fds)
     return buf;
 }
 
+/* Implicit TX scope around handling of iomux events, see XLIO_RING_TX_DB_COALESCE.
+   The scope opened when the iomux returns ready fds is closed on the next iomux
+   call, so all replies sent in between share one doorbell per ring. Blocking
+   socket calls, close() and thread exit ring the deferred doorbells earlier,
+   see ring::tx_scope_flush_all().  */
+static __thread bool t_iomux_tx_scope = false;
+
+static inline void iomux_tx_scope_enter()
+{
+    if (t_iomux_tx_scope) {
+        t_iomux_tx_scope = false;
+        ring::tx_scope_end();
+    }
+}
+
+static inline void iomux_tx_scope_leave(int rc)
+{
+    if (rc > 0 && safe_mce_sys().ring_tx_db_coalesce) {
+        t_iomux_tx_scope = true;
+        ring::tx_scope_begin();
+    }
+}
+
 /* Check the first NFDS descriptors each in READFDS (if not NULL) for read
    readiness, in WRITEFDS (if not NULL) for write readiness, and in EXCEPTFDS
    (if not NULL) for exceptional conditions.  If TIMis not NULL, time out
@@ -2057,6 +2028,8 @@ static int select_helper(int __nfds, fd_set *__readfds, fd_set *__writefds, fd_s
                      dbg_sprintf_fdset(tmpbuf2, tmpbufsize, __nfds, __writefds));
     }
 
+    iomux_tx_scope_enter();
+
     try {
         select_call scall(off_rfds_buffer, off_modes_buffer, __nfds, __readfds, __writefds,
                           __exceptfds, __timeout, __sigmask);
@@ -2073,6 +2046,7 @@ static int select_helper(int __nfds, fd_set *__readfds, fd_set *__writefds, fd_s
                               dbg_sprintf_fdset(tmpbuf2, tmpbufsize, __nfds, __writefds));
         }
 
+        iomux_tx_scope_leave(rc);
         return rc;
     } catch (io_mux_call::io_error &) {
         srdr_logfunc_exit("io_mux_call::io_error (errno=%d %m)", errno);
@@ -2142,12 +2116,15 @@ static int poll_helper(struct pollfd *__fds, nfds_t __nfds, int __timeout,
     int lookup_buffer[__nfds];
     pollfd working_fds_arr[__nfds + 1];
 
+    iomux_tx_scope_enter();
+
     try {
         poll_call pcall(off_rfd_buffer, off_modes_buffer, lookup_buffer, working_fds_arr, __fds,
                         __nfds, __timeout, __sigmask);
 
         int rc = pcall.call();
         srdr_logfunc_exit("rc = %d", rc);
+        iomux_tx_scope_leave(rc);
         return rc;
     } catch (io_mux_call::io_error &) {
         srdr_logfunc_exit("io_mux_call::io_error (errno=%d %m)", errno);
@@ -2359,6 +2336,8 @@ inline int epoll_wait_helper(int __epfd, struct epoll_event *__events, int __max
 
     epoll_event extra_events_buffer[__maxevents];
 
+    iomux_tx_scope_enter();
+
     try {
         epoll_wait_call epcall(extra_events_buffer, NULL, __epfd, __events, __maxevents, __timeout,
                                __sigmask);
@@ -2372,6 +2351,7 @@ inline int epoll_wait_helper(int __epfd, struct epoll_event *__events, int __max
         }
 
         srdr_logfunc_exit("rc = %d", rc);
+        iomux_tx_scope_leave(rc);
         return rc;
     } catch (io_mux_call::io_error &) {
         srdr_logfunc_exit("io_mux_call::io_error (errno=%d %m)", errno);
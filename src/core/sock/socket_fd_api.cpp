@@ -173,6 +173,75 @@ int socket_fd_api::getsockopt(int __level, int __optname, void *__optval, sockle
     return ret;
 }
 
+int socket_fd_api::rx_mmsg(struct mmsghdr *mmsghdr, unsigned int vlen, int flags,
+                           const struct timespec *timeout)
+{
+    int num_of_msg = 0;
+    int ret = 0;
+    struct timespec start_time = TIMESPEC_INITIALIZER, current_time = TIMESPEC_INITIALIZER,
+                    delta_time = TIMESPEC_INITIALIZER;
+
+    if (timeout) {
+        gettime(&start_time);
+    }
+
+    for (unsigned int i = 0; i < vlen; i++) {
+        int in_flags = flags;
+        mmsghdr[i].msg_hdr.msg_flags = 0;
+        ret = rx(RX_RECVMSG, mmsghdr[i].msg_hdr.msg_iov, mmsghdr[i].msg_hdr.msg_iovlen, &in_flags,
+                 (__SOCKADDR_ARG)mmsghdr[i].msg_hdr.msg_name,
+                 (socklen_t *)&mmsghdr[i].msg_hdr.msg_namelen, &mmsghdr[i].msg_hdr);
+        if (ret < 0) {
+            break;
+        }
+        num_of_msg++;
+        mmsghdr[i].msg_len = ret;
+        if ((i == 0) && (in_flags & MSG_WAITFORONE)) {
+            flags |= MSG_DONTWAIT;
+        }
+        if (timeout) {
+            gettime(&current_time);
+            ts_sub(&current_time, &start_time, &delta_time);
+            if (ts_cmp(&delta_time, timeout, >)) {
+                break;
+            }
+        }
+    }
+    if (num_of_msg || ret == 0) {
+        // todo save ret for so_error if ret != 0(see kernel)
+        return num_of_msg;
+    }
+    return ret;
+}
+
+int socket_fd_api::tx_mmsg(struct mmsghdr *mmsghdr, unsigned int vlen, int flags)
+{
+    int num_of_msg = 0;
+
+    for (unsigned int i = 0; i < vlen; i++) {
+        xlio_tx_call_attr_t tx_arg;
+
+        tx_arg.opcode = TX_SENDMSG;
+        tx_arg.attr.iov = mmsghdr[i].msg_hdr.msg_iov;
+        tx_arg.attr.sz_iov = (ssize_t)mmsghdr[i].msg_hdr.msg_iovlen;
+        tx_arg.attr.flags = flags;
+        tx_arg.attr.addr = (struct sockaddr *)(__SOCKADDR_ARG)mmsghdr[i].msg_hdr.msg_name;
+        tx_arg.attr.len = (socklen_t)mmsghdr[i].msg_hdr.msg_namelen;
+        tx_arg.attr.hdr = &mmsghdr[i].msg_hdr;
+
+        int ret = tx(tx_arg);
+        if (ret < 0) {
+            if (num_of_msg) {
+                return num_of_msg;
+            }
+            return ret;
+        }
+        num_of_msg++;
+        mmsghdr[i].msg_len = ret;
+    }
+    return num_of_msg;
+}
+
 bool socket_fd_api::is_readable(uint64_t *p_poll_sn, fd_array_t *p_fd_array)
 {
     NOT_IN_USE(p_poll_sn);
@@ -53,6 +53,20 @@
 
 #define IS_DUMMY_PACKET(flags) (flags & XLIO_SND_FLAGS_DUMMY)
 
+/* The following definitions are for kernels previous to 2.6.32 which dont support recvmmsg */
+#ifndef HAVE_STRUCT_MMSGHDR
+#ifndef __INTEL_COMPILER
+struct mmsghdr {
+    struct msghdr msg_hdr; // Message header
+    unsigned int msg_len; // Number of received bytes for header
+};
+#endif
+#endif
+
+#ifndef MSG_WAITFORONE
+#define MSG_WAITFORONE 0x10000 // recvmmsg(): block until 1+ packets avail
+#endif
+
 class cq_mgr;
 class epfd_info;
 class mem_buf_desc_t;
@@ -180,6 +194,14 @@ public:
                        int *p_flags = 0, sockaddr *__from = NULL, socklen_t *__fromlen = NULL,
                        struct msghdr *__msg = NULL) = 0;
 
+    /**
+     * Receive up to vlen messages (recvmmsg() semantics).
+     * Default implementation calls rx() once per message, sockets with
+     * a faster batch path override it.
+     */
+    virtual int rx_mmsg(struct mmsghdr *mmsghdr, unsigned int vlen, int flags,
+                        const struct timespec *timeout);
+
     virtual bool is_readable(uint64_t *p_poll_sn, fd_array_t *p_fd_array = NULL);
 
     virtual bool is_writeable();
@@ -212,6 +234,12 @@ public:
 
     virtual ssize_t tx(xlio_tx_call_attr_t &tx_arg) = 0;
 
+    /**
+     * Send up to vlen messages (sendmmsg() semantics).
+     * Default implementation calls tx() once per message.
+     */
+    virtual int tx_mmsg(struct mmsghdr *mmsghdr, unsigned int vlen, int flags);
+
     virtual void statistics_print(vlog_levels_t log_level = VLOG_DEBUG);
 
     virtual int recvfrom_zcopy_free_packets(struct xlio_recvfrom_zcopy_packet_t *pkts,
@@ -59,6 +59,8 @@
 #define si_logfunc    __log_info_func
 #define si_logfuncall __log_info_funcall
 
+__thread poll_budget g_rx_poll_budget = {0, 0, 0};
+
 sockinfo::sockinfo(int fd, int domain)
     : socket_fd_api(fd)
     , m_b_blocking(true)
@@ -85,12 +87,15 @@ sockinfo::sockinfo(int fd, int domain)
     , m_rx_ready_byte_count(0)
     , m_n_sysvar_rx_num_buffs_reuse(safe_mce_sys().rx_bufs_batch)
     , m_n_sysvar_rx_poll_num(safe_mce_sys().rx_poll_num)
+    , m_n_sysvar_rx_poll_num_min(safe_mce_sys().rx_poll_num_min)
+    , m_b_sysvar_rx_poll_adaptive(safe_mce_sys().poll_adaptive && m_n_sysvar_rx_poll_num > 0)
     , m_ring_alloc_log_rx(safe_mce_sys().ring_allocation_logic_rx)
     , m_ring_alloc_log_tx(safe_mce_sys().ring_allocation_logic_tx)
     , m_pcp(0)
     , m_fd_context((void *)((uintptr_t)m_fd))
     , m_flow_tag_id(0)
     , m_flow_tag_enabled(false)
+    , m_b_udp_gro(false)
     , m_rx_cq_wait_ctrl(safe_mce_sys().rx_cq_wait_ctrl)
     , m_n_uc_ttl_hop_lim(m_family == AF_INET
                              ? safe_mce_sys().sysctl_reader.get_net_ipv4_ttl()
@@ -1415,6 +1420,10 @@ void sockinfo::statistics_print(vlog_levels_t log_level /* = VLOG_DEBUG */)
         vlog_printf(log_level, "Rx poll : %d / %d (%2.2f%%) [miss/hit]\n",
                     m_p_socket_stats->counters.n_rx_poll_miss,
                     m_p_socket_stats->counters.n_rx_poll_hit, rx_poll_hit_percentage);
+        if (m_p_socket_stats->n_rx_poll_budget) {
+            vlog_printf(log_level, "Rx poll budget : %u [loops]\n",
+                        m_p_socket_stats->n_rx_poll_budget);
+        }
         b_any_activity = true;
     }
     if (b_any_activity == false) {
@@ -2117,6 +2126,7 @@ void sockinfo::handle_cmsg(struct msghdr *msg, int flags)
     if (m_b_pktinfo) {
         handle_ip_pktinfo(&cm_state);
     }
+    handle_udp_gro(&cm_state);
     if (m_b_rcvtstamp || m_n_tsing_flags) {
         handle_recv_timestamping(&cm_state);
     }
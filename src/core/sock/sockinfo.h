@@ -42,6 +42,7 @@
 #include "util/xlio_stats.h"
 #include "util/sys_vars.h"
 #include "util/wakeup_pipe.h"
+#include "util/poll_budget.h"
 #include "proto/flow_tuple.h"
 #include "proto/mem_buf_desc.h"
 #include "proto/dst_entry.h"
@@ -150,6 +151,9 @@ typedef struct {
 
 typedef std::unordered_map<ring *, ring_info_t *> rx_ring_map_t;
 
+// Rx polling loops budget of the calling thread (XLIO_POLL_ADAPTIVE)
+extern __thread poll_budget g_rx_poll_budget;
+
 // see route.c in Linux kernel
 const uint8_t ip_tos2prio[16] = {0, 0, 0, 0, 2, 2, 2, 2, 6, 6, 6, 6, 4, 4, 4, 4};
 
@@ -188,7 +192,8 @@ public:
         m_flow_tag_id = FLOW_TAG_MASK;
         return false;
     }
-    inline bool flow_tag_enabled(void) { return m_flow_tag_enabled; }
+    // Coalescing is done by the rfs, which the flow tag fast path would bypass
+    inline bool flow_tag_enabled(void) { return m_flow_tag_enabled && !m_b_udp_gro; }
     inline int get_rx_epfd(void) { return m_rx_epfd; }
     inline bool is_blocking(void) { return m_b_blocking; }
 
@@ -288,6 +293,8 @@ protected:
 
     int m_n_sysvar_rx_num_buffs_reuse;
     const int32_t m_n_sysvar_rx_poll_num;
+    const int32_t m_n_sysvar_rx_poll_num_min;
+    const bool m_b_sysvar_rx_poll_adaptive;
     ring_alloc_logic_attr m_ring_alloc_log_rx;
     ring_alloc_logic_attr m_ring_alloc_log_tx;
     uint32_t m_pcp;
@@ -313,6 +320,7 @@ protected:
     void *m_fd_context; // Context data stored with socket
     uint32_t m_flow_tag_id; // Flow Tag for this socket
     bool m_flow_tag_enabled; // for this socket
+    bool m_b_udp_gro; // UDP_GRO, receive coalesced datagrams
     bool m_rx_cq_wait_ctrl;
     uint8_t m_n_uc_ttl_hop_lim;
     bool m_is_ipv6only;
@@ -385,6 +393,7 @@ protected:
     int ipv6_get_addr_sel_pref();
 
     virtual void handle_ip_pktinfo(struct cmsg_state *cm_state) = 0;
+    virtual void handle_udp_gro(struct cmsg_state *cm_state) { NOT_IN_USE(cm_state); }
     inline void handle_recv_timestamping(struct cmsg_state *cm_state);
     inline void handle_recv_errqueue(struct cmsg_state *cm_state);
     void insert_cmsg(struct cmsg_state *cm_state, int level, int type, void *data, int len);
@@ -402,6 +411,29 @@ protected:
         socket_fd_api::notify_epoll_context((uint32_t)events);
     }
 
+    // Polling loops before a blocking receive arms the CQ and goes to sleep
+    inline int32_t rx_poll_budget()
+    {
+        return m_b_sysvar_rx_poll_adaptive ? g_rx_poll_budget.get(m_n_sysvar_rx_poll_num)
+                                           : m_n_sysvar_rx_poll_num;
+    }
+
+    inline void rx_poll_budget_hit(int32_t loops)
+    {
+        if (m_b_sysvar_rx_poll_adaptive) {
+            g_rx_poll_budget.hit(loops, m_n_sysvar_rx_poll_num_min, m_n_sysvar_rx_poll_num);
+            m_p_socket_stats->n_rx_poll_budget = g_rx_poll_budget.budget;
+        }
+    }
+
+    inline void rx_poll_budget_miss()
+    {
+        if (m_b_sysvar_rx_poll_adaptive) {
+            g_rx_poll_budget.miss(m_n_sysvar_rx_poll_num_min);
+            m_p_socket_stats->n_rx_poll_budget = g_rx_poll_budget.budget;
+        }
+    }
+
     inline void save_strq_stats(uint32_t packet_strides)
     {
         m_socket_stats.strq_counters.n_strq_total_strides += static_cast<uint64_t>(packet_strides);
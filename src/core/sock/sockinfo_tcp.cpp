@@ -53,6 +53,7 @@
 #include "sock-redirect.h"
 #include "fd_collection.h"
 #include "sockinfo_tcp.h"
+#include "syncookie.h"
 
 // debugging macros
 #define MODULE_NAME "si_tcp"
@@ -76,6 +77,9 @@ extern global_stats_t g_global_stat_static;
 tcp_seg_pool *g_tcp_seg_pool = NULL;
 tcp_timers_collection *g_tcp_timers_collection = NULL;
 
+// Timers of a socket on the TCP timers collection
+enum sockinfo_tcp_timers { TCP_TIMER, TCP_RACK_TLP_TIMER };
+
 /*
  * The following socket options are inherited by a connected TCP socket from the listening socket:
  * SO_DEBUG, SO_DONTROUTE, SO_KEEPALIVE, SO_LINGER, SO_OOBINLINE, SO_RCVBUF, SO_RCVLOWAT, SO_SNDBUF,
@@ -152,6 +156,7 @@ inline int sockinfo_tcp::rx_wait_lockless(int &poll_count, bool blocking)
     if (m_timer_pending) {
         m_tcp_con_lock.lock();
         tcp_timer();
+        arm_tcp_timer();
         m_tcp_con_lock.unlock();
     }
 
@@ -244,6 +249,12 @@ sockinfo_tcp::sockinfo_tcp(int fd, int domain)
     : sockinfo(fd, domain)
     , m_timer_handle(NULL)
     , m_timer_pending(false)
+    , m_timer_armed(false)
+    , m_timer_expiry(0)
+#if LWIP_TCP_RACK_TLP
+    , m_rack_tlp_timer_handle(NULL)
+    , m_rack_tlp_deadline_us(0)
+#endif /* LWIP_TCP_RACK_TLP */
     , m_sysvar_buffer_batching_mode(safe_mce_sys().buffer_batching_mode)
     , m_sysvar_tx_segs_batch_tcp(safe_mce_sys().tx_segs_batch_tcp)
     , m_sysvar_tcp_ctl_thread(safe_mce_sys().tcp_ctl_thread)
@@ -309,7 +320,19 @@ sockinfo_tcp::sockinfo_tcp(int fd, int domain)
 
     m_rcvbuff_current = 0;
     m_rcvbuff_non_tcp_recved = 0;
+    m_rcvbuff_autotune_max = safe_mce_sys().tcp_rcvbuf_autotune_max < 0
+        ? safe_mce_sys().sysctl_reader.get_tcp_rmem()->max_value
+        : safe_mce_sys().tcp_rcvbuf_autotune_max;
     m_received_syn_num = 0;
+    memset(&m_syncookie, 0, sizeof(m_syncookie));
+    m_syncookie_sent_time = 0;
+    m_b_syncookie_sent = false;
+    m_fastopen_qlen = 0;
+    memset(&m_fastopen_syn, 0, sizeof(m_fastopen_syn));
+    m_fastopen_iov = NULL;
+    m_fastopen_len = 0;
+    m_b_fastopen_connect = false;
+    m_b_fastopen_deferred = false;
     m_xlio_thr = false;
 
     m_ready_conn_cnt = 0;
@@ -396,6 +419,8 @@ sockinfo_tcp::~sockinfo_tcp()
         delete (opt);
     }
 
+    clear_syncookie_dst();
+
     unlock_tcp_con();
 
     if (m_n_rx_pkt_ready_list_count || m_rx_ready_byte_count || m_rx_pkt_ready_list.size() ||
@@ -429,10 +454,20 @@ void sockinfo_tcp::clean_obj()
     lock_tcp_con();
     set_cleaned();
 
+    if (paced_node.is_list_member()) {
+        g_tcp_timers_collection->remove_paced_socket(this);
+    }
+
     /* Remove group timers from g_tcp_timers_collection */
     if (g_p_event_handler_manager->is_running() && m_timer_handle) {
         g_p_event_handler_manager->unregister_timer_event(this, m_timer_handle);
     }
+#if LWIP_TCP_RACK_TLP
+    if (g_p_event_handler_manager->is_running() && m_rack_tlp_timer_handle) {
+        g_p_event_handler_manager->unregister_timer_event(this, m_rack_tlp_timer_handle);
+    }
+    m_rack_tlp_timer_handle = NULL;
+#endif /* LWIP_TCP_RACK_TLP */
 
     m_timer_handle = NULL;
     if (g_p_event_handler_manager->is_running()) {
@@ -464,13 +499,14 @@ bool sockinfo_tcp::prepare_listen_to_close()
     }
 
     // remove the sockets from the syn_received connections list
-    syn_received_map_t::iterator syn_received_itr;
-    for (syn_received_itr = m_syn_received.begin(); syn_received_itr != m_syn_received.end();) {
-        sockinfo_tcp *new_sock = (sockinfo_tcp *)(syn_received_itr->second->my_container);
+    std::vector<tcp_pcb *> syn_received_pcbs;
+    syn_received_pcbs.reserve(m_syn_received.size());
+    m_syn_received.for_each(
+        [&syn_received_pcbs](const flow_tuple &, tcp_pcb *pcb) { syn_received_pcbs.push_back(pcb); });
+    m_syn_received.clear();
+    for (tcp_pcb *syn_received_pcb : syn_received_pcbs) {
+        sockinfo_tcp *new_sock = (sockinfo_tcp *)(syn_received_pcb->my_container);
         new_sock->m_sock_state = TCP_SOCK_INITED;
-        syn_received_map_t::iterator syn_received_itr_erase = syn_received_itr;
-        syn_received_itr++;
-        m_syn_received.erase(syn_received_itr_erase);
         m_received_syn_num--;
         new_sock->lock_tcp_con();
         new_sock->m_parent = NULL;
@@ -691,10 +727,129 @@ void sockinfo_tcp::tcp_timer()
     tcp_tmr(&m_pcb);
     m_timer_pending = false;
 
+    if (m_pcb.pacing_pending) {
+        schedule_pacing_release();
+    }
+    update_loss_recovery_stats();
+
     return_pending_rx_buffs();
     return_pending_tx_buffs();
 }
 
+// The loss recovery counters are kept by lwIP, they are copied to the socket statistics
+// on the TCP timer and on state changes.
+void sockinfo_tcp::update_loss_recovery_stats()
+{
+#if LWIP_TCP_RACK_TLP
+    m_p_socket_stats->counters.n_tx_rto = m_pcb.stat_rto;
+    m_p_socket_stats->counters.n_tx_tlp_probes = m_pcb.stat_tlp_probes;
+    m_p_socket_stats->counters.n_tx_tlp_recoveries = m_pcb.stat_tlp_recoveries;
+    m_p_socket_stats->counters.n_tx_rack_losses = m_pcb.stat_rack_lost;
+#endif /* LWIP_TCP_RACK_TLP */
+}
+
+// Assume locked by m_tcp_con_lock
+void sockinfo_tcp::arm_tcp_timer()
+{
+    unsigned int timeout_msec;
+    uint32_t ticks;
+
+    if (unlikely(!m_timer_handle)) {
+        return;
+    }
+
+#if LWIP_TCP_RACK_TLP
+    arm_rack_tlp_timer();
+#endif /* LWIP_TCP_RACK_TLP */
+
+    if (m_sysvar_tcp_ctl_thread > CTL_THREAD_DISABLE || m_state != SOCKINFO_OPENED ||
+        (m_rx_reuse_buff.n_buff_num &&
+         m_sysvar_buffer_batching_mode != BUFFER_BATCHING_NO_RECLAIM)) {
+        timeout_msec = 0;
+    } else {
+        timeout_msec = tcp_tmr_next(&m_pcb);
+        if (timeout_msec == TCP_TMR_NONE) {
+            return;
+        }
+    }
+    if (timeout_msec == 0) {
+        timeout_msec = g_tcp_timers_collection->get_period();
+    }
+
+    ticks = g_tcp_timers_collection->msec_to_ticks(timeout_msec);
+    if (m_timer_armed &&
+        (int32_t)(m_timer_expiry - (g_tcp_timers_collection->get_tick() + ticks - 1)) <= 0) {
+        // Already armed to expire in time
+        return;
+    }
+    m_timer_expiry = g_tcp_timers_collection->arm_timer(m_timer_handle, timeout_msec);
+    m_timer_armed = true;
+}
+
+#if LWIP_TCP_RACK_TLP
+// Assume locked by m_tcp_con_lock
+void sockinfo_tcp::arm_rack_tlp_timer()
+{
+    uint64_t deadline = tcp_rack_tlp_deadline(&m_pcb);
+
+    // An expiry before the deadline is harmless, the timer is armed again
+    if (likely(!deadline) || !m_rack_tlp_timer_handle ||
+        (m_rack_tlp_deadline_us && m_rack_tlp_deadline_us <= deadline)) {
+        return;
+    }
+
+    uint64_t now = xlio_lwip::sys_now_us();
+    unsigned int timeout_msec = deadline > now ? (unsigned int)((deadline - now + 999) / 1000) : 0;
+
+    g_tcp_timers_collection->arm_timer(m_rack_tlp_timer_handle, timeout_msec);
+    m_rack_tlp_deadline_us = deadline;
+}
+
+// Execute RACK reordering and TLP timers of this connection
+void sockinfo_tcp::rack_tlp_timer()
+{
+    if (m_tcp_con_lock.trylock()) {
+        // The deadline is left as is, so the lock owner doesn't re-arm the timer. Retry on the
+        // next tick instead.
+        g_tcp_timers_collection->arm_timer(m_rack_tlp_timer_handle, 0);
+        return;
+    }
+
+    // The wheel has dropped the expired timer
+    m_rack_tlp_deadline_us = 0;
+    if (m_state != SOCKINFO_DESTROYING) {
+        tcp_rack_tlp_tmr(&m_pcb);
+        update_loss_recovery_stats();
+    }
+    arm_tcp_timer();
+    m_tcp_con_lock.unlock();
+}
+#endif /* LWIP_TCP_RACK_TLP */
+
+// Assume locked by m_tcp_con_lock
+void sockinfo_tcp::schedule_pacing_release()
+{
+    if (!paced_node.is_list_member() && !is_cleaned()) {
+        g_tcp_timers_collection->add_paced_socket(this);
+    }
+}
+
+// Called by the TCP timers collection with its pacing lock held
+void sockinfo_tcp::pacing_release(paced_sock_list_t &paced_list)
+{
+    if (m_tcp_con_lock.trylock()) {
+        // The lock owner sends the paced data, otherwise we retry on the next tick
+        return;
+    }
+
+    tcp_output(&m_pcb);
+    if (!m_pcb.pacing_pending) {
+        paced_list.erase(this);
+    }
+    arm_tcp_timer();
+    m_tcp_con_lock.unlock();
+}
+
 bool sockinfo_tcp::prepare_dst_to_send(bool is_accepted_socket /* = false */)
 {
     bool ret_val = false;
@@ -841,6 +996,9 @@ void sockinfo_tcp::put_agent_msg(void *arg)
 
 ssize_t sockinfo_tcp::tx(xlio_tx_call_attr_t &tx_arg)
 {
+    if (unlikely(tx_arg.attr.flags & MSG_FASTOPEN) || unlikely(m_b_fastopen_deferred)) {
+        return fastopen_tx(tx_arg);
+    }
     return m_ops->tx(tx_arg);
 }
 
@@ -1323,6 +1481,13 @@ err_t sockinfo_tcp::ip_output_syn_ack(struct pbuf *p, struct tcp_seg *seg, void
 {
     sockinfo_tcp *p_si_tcp = (sockinfo_tcp *)pcb_container;
     p_si_tcp->m_p_socket_stats->tcp_state = new_state;
+    p_si_tcp->update_loss_recovery_stats();
+
+    /* Mark the outgoing packets as ECN capable once the handshake negotiated it. */
+    if (new_state == ESTABLISHED && p_si_tcp->m_p_connected_dst_entry) {
+        p_si_tcp->m_p_connected_dst_entry->set_ip_ecn(
+            (p_si_tcp->m_pcb.flags & TF_ECN) ? IPTOS_ECN_ECT0 : 0);
+    }
 
     if (p_si_tcp->m_state == SOCKINFO_CLOSING && (new_state == CLOSED || new_state == TIME_WAIT)) {
         /*
@@ -1485,6 +1650,12 @@ bool sockinfo_tcp::process_peer_ctl_packets(xlio_desc_list_t &peer_packets)
                     m_last_syn_tsc = tsc_now;
                 }
             }
+            if (safe_mce_sys().tcp_syncookies && get_tcp_state(&m_pcb) == LISTEN) {
+                syncookie_check_ack(desc);
+            }
+            if (is_fastopen_listener() && get_tcp_state(&m_pcb) == LISTEN) {
+                fastopen_check_syn(desc);
+            }
         } else { // child socket from a listener context - switch to child lock
             m_tcp_con_lock.unlock();
             if (sock->m_tcp_con_lock.trylock()) {
@@ -1664,38 +1835,45 @@ void sockinfo_tcp::handle_timer_expired(void *user_data)
     NOT_IN_USE(user_data);
     si_tcp_logfunc("");
 
+#if LWIP_TCP_RACK_TLP
+    if ((uint64_t)user_data == TCP_RACK_TLP_TIMER) {
+        rack_tlp_timer();
+        return;
+    }
+#endif /* LWIP_TCP_RACK_TLP */
+
     if (m_sysvar_tcp_ctl_thread > CTL_THREAD_DISABLE) {
         process_rx_ctl_packets();
     }
 
+    if (m_tcp_con_lock.trylock()) {
+        // The lock owner runs the timer in unlock_tcp_con(). In the rare case of a race with
+        // unlock_tcp_con() we retry on the next period, so the timer cannot be lost.
+        // The expiry is updated as well, so arm_tcp_timer() of the lock owner doesn't rely
+        // on the tick which has just passed.
+        m_timer_pending = true;
+        if (m_timer_handle) {
+            m_timer_expiry = g_tcp_timers_collection->arm_timer(
+                m_timer_handle, g_tcp_timers_collection->get_period());
+        }
+        return;
+    }
+
     if (m_sysvar_internal_thread_tcp_timer_handling ==
-        INTERNAL_THREAD_TCP_TIMER_HANDLING_DEFERRED) {
+            INTERNAL_THREAD_TCP_TIMER_HANDLING_DEFERRED &&
+        !m_timer_pending) {
         // DEFERRED. if Internal thread is here first and m_timer_pending is false it jsut
         // sets it as true for its next iteration (within 100ms), letting
         // application threads have a chance of running tcp_timer()
-        if (m_timer_pending) {
-            if (m_tcp_con_lock.trylock()) {
-                return;
-            }
-            tcp_timer();
-            m_tcp_con_lock.unlock();
-        }
         m_timer_pending = true;
-    } else { // IMMEDIATE
-        // Set the pending flag before getting the lock, so in the rare case of
-        // a race with unlock_tcp_con(), the timer will be called twice. If we set
-        // the flag after trylock(), the timer may not be called in case of a race.
-
-        // any thread (internal or application) will try locking
-        // and running the tcp_timer
-        m_timer_pending = true;
-        if (m_tcp_con_lock.trylock()) {
-            return;
-        }
-
+    } else {
         tcp_timer();
-        m_tcp_con_lock.unlock();
     }
+
+    // The wheel has dropped the expired timer, arm it again if there are deadlines
+    m_timer_armed = false;
+    arm_tcp_timer();
+    m_tcp_con_lock.unlock();
 }
 
 void sockinfo_tcp::abort_connection()
@@ -1896,6 +2074,10 @@ err_t sockinfo_tcp::rx_lwip_cb(void *arg, struct tcp_pcb *pcb, struct pbuf *p, e
     // OLG: Now we should wakeup all threads that are sleeping on this socket.
     conn->do_wakeup();
 
+    if (conn->m_rcvbuff_autotune_max) {
+        conn->rcvbuff_autotune_rx();
+    }
+
     /*
      * RCVBUFF Accounting: tcp_recved here(stream into the 'internal' buffer) only if the user
      * buffer is not 'filled'
@@ -2125,6 +2307,9 @@ ssize_t sockinfo_tcp::rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov
             tcp_recved(&m_pcb, bytes_to_tcp_recved);
             m_rcvbuff_non_tcp_recved -= bytes_to_tcp_recved;
         }
+        if (m_rcvbuff_autotune_max) {
+            rcvbuff_autotune_read(total_rx);
+        }
     }
 
     unlock_tcp_con();
@@ -2145,8 +2330,15 @@ void sockinfo_tcp::register_timer()
 {
     if (m_timer_handle == NULL) {
         m_timer_handle = g_p_event_handler_manager->register_timer_event(
-            safe_mce_sys().tcp_timer_resolution_msec, this, PERIODIC_TIMER, 0,
+            safe_mce_sys().tcp_timer_resolution_msec, this, PERIODIC_TIMER, (void *)TCP_TIMER,
             g_tcp_timers_collection);
+#if LWIP_TCP_RACK_TLP
+        if (safe_mce_sys().tcp_rack_tlp) {
+            m_rack_tlp_timer_handle = g_p_event_handler_manager->register_timer_event(
+                safe_mce_sys().timer_resolution_msec, this, PERIODIC_TIMER,
+                (void *)TCP_RACK_TLP_TIMER, g_tcp_timers_collection);
+        }
+#endif /* LWIP_TCP_RACK_TLP */
     } else {
         si_tcp_logdbg("register_timer was called more than once. Something might be wrong, or "
                       "connect was called twice.");
@@ -2196,6 +2388,14 @@ bool sockinfo_tcp::rx_input_cb(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_info, void
         if (!pcb) {
             pcb = &m_pcb;
 
+            // Answer a SYN with a SYN cookie instead of adding a half-open connection
+            const struct tcphdr *p_tcp_h = p_rx_pkt_mem_buf_desc_info->rx.tcp.p_tcp_h;
+            if (unlikely(is_syncookie_active()) && p_tcp_h->syn && !p_tcp_h->ack &&
+                !p_tcp_h->rst && syncookie_send_synack(p_rx_pkt_mem_buf_desc_info)) {
+                unlock_tcp_con();
+                return false; // return without inc_ref_count() => packet will be dropped
+            }
+
             /// respect TCP listen backlog - See redmine issue #565962
             /// distinguish between backlog of established sockets vs. backlog of syn-rcvd
             static const unsigned int MAX_SYN_RCVD = m_sysvar_tcp_ctl_thread > CTL_THREAD_DISABLE
@@ -2233,6 +2433,12 @@ bool sockinfo_tcp::rx_input_cb(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_info, void
             unlock_tcp_con();
             return true;
         }
+        if (pcb == &m_pcb && safe_mce_sys().tcp_syncookies) {
+            syncookie_check_ack(p_rx_pkt_mem_buf_desc_info);
+        }
+        if (pcb == &m_pcb && is_fastopen_listener()) {
+            fastopen_check_syn(p_rx_pkt_mem_buf_desc_info);
+        }
     } else {
         pcb = &m_pcb;
     }
@@ -2271,6 +2477,7 @@ bool sockinfo_tcp::rx_input_cb(mem_buf_desc_t *p_rx_pkt_mem_buf_desc_info, void
     sock->m_xlio_thr = false;
 
     if (sock != this) {
+        sock->arm_tcp_timer();
         sock->m_tcp_con_lock.unlock();
     }
 
@@ -2396,10 +2603,34 @@ int sockinfo_tcp::connect(const sockaddr *__to, socklen_t __tolen)
     fit_rcv_wnd(true);
     report_connected = true;
 
+    // TCP_FASTOPEN_CONNECT: with a cached cookie the SYN carries the data of the first write
+    if (unlikely(is_fastopen_connect()) && !m_fastopen_iov &&
+        ((dst_entry_tcp *)m_p_connected_dst_entry)->get_fastopen_cookie(m_pcb.fastopen)) {
+        m_b_fastopen_deferred = true;
+        m_sock_state = TCP_SOCK_ASYNC_CONNECT;
+        unlock_tcp_con();
+        si_tcp_logdbg("Fast Open connect is deferred to the first write");
+        return 0;
+    }
+
+    return start_connect();
+}
+
+/*
+ * Sends the SYN of an offloaded connection and waits for the handshake if the
+ * socket is blocking. Called with m_tcp_con_lock taken, returns with it released.
+ */
+int sockinfo_tcp::start_connect()
+{
     const ip_address &ip = m_connected.get_ip_addr();
-    int err =
-        tcp_connect(&m_pcb, reinterpret_cast<const ip_addr_t *>(&ip),
-                    ntohs(m_connected.get_in_port()), m_pcb.is_ipv6, sockinfo_tcp::connect_lwip_cb);
+    int err;
+    if (unlikely(m_fastopen_iov) || unlikely(is_fastopen_connect())) {
+        err = fastopen_connect();
+    } else {
+        err = tcp_connect(&m_pcb, reinterpret_cast<const ip_addr_t *>(&ip),
+                          ntohs(m_connected.get_in_port()), m_pcb.is_ipv6,
+                          sockinfo_tcp::connect_lwip_cb);
+    }
     if (err != ERR_OK) {
         // todo consider setPassthrough and go to OS
         destructor_helper();
@@ -3156,14 +3387,7 @@ void sockinfo_tcp::push_back_m_rx_pkt_ready_list(mem_buf_desc_t *buff)
 
 struct tcp_pcb *sockinfo_tcp::get_syn_received_pcb(const flow_tuple &key) const
 {
-    struct tcp_pcb *ret_val = NULL;
-    syn_received_map_t::const_iterator itr;
-
-    itr = m_syn_received.find(key);
-    if (itr != m_syn_received.end()) {
-        ret_val = itr->second;
-    }
-    return ret_val;
+    return m_syn_received.find(key);
 }
 
 struct tcp_pcb *sockinfo_tcp::get_syn_received_pcb(const sock_addr &src, const sock_addr &dst)
@@ -3174,6 +3398,348 @@ struct tcp_pcb *sockinfo_tcp::get_syn_received_pcb(const sock_addr &src, const s
     return get_syn_received_pcb(key);
 }
 
+// Max number of cached routes for SYN cookies per listen socket
+#define SYNCOOKIE_DST_MAX 1024
+
+dst_entry_tcp *sockinfo_tcp::get_syncookie_dst(const sock_addr &src, const sock_addr &dst)
+{
+    flow_tuple key(src.get_ip_addr(), 0, dst.get_ip_addr(), dst.get_in_port(), PROTO_TCP,
+                   dst.get_sa_family());
+    dst_entry_tcp *p_dst = m_syncookie_dst.find(key);
+
+    if (likely(p_dst)) {
+        return p_dst;
+    }
+
+    if (m_syncookie_dst.size() >= SYNCOOKIE_DST_MAX) {
+        clear_syncookie_dst();
+    }
+
+    socket_data data = {m_fd, m_n_uc_ttl_hop_lim, m_pcb.tos, m_pcp};
+    p_dst = new dst_entry_tcp(src, dst.get_in_port(), data, m_ring_alloc_log_tx);
+    p_dst->set_bound_addr(dst.get_ip_addr());
+    // pass true for passive socket to skip the transport rules checking
+    if (!p_dst->prepare_to_send(m_so_ratelimit, true, false)) {
+        si_tcp_logdbg("No offloaded route for SYN cookie to %s", src.to_str_ip_port().c_str());
+        delete p_dst;
+        return NULL;
+    }
+
+    m_syncookie_dst.set(key, p_dst);
+    return p_dst;
+}
+
+void sockinfo_tcp::clear_syncookie_dst()
+{
+    m_syncookie_dst.for_each([](const flow_tuple &, dst_entry_tcp *p_dst) { delete p_dst; });
+    m_syncookie_dst.clear();
+}
+
+/*
+ * Answers a SYN with a SYN-ACK which carries a SYN cookie. No state is kept,
+ * the options are built the same way tcp_enqueue_flags() does for a SYN_RCVD pcb.
+ */
+bool sockinfo_tcp::syncookie_send_synack(mem_buf_desc_t *p_desc)
+{
+    const struct tcphdr *p_syn = p_desc->rx.tcp.p_tcp_h;
+    const sock_addr &src = p_desc->rx.src;
+    const sock_addr &dst = p_desc->rx.dst;
+    syncookie::options opts;
+    uint16_t adv_mss;
+    uint16_t hdr_len;
+    struct {
+        struct tcphdr hdr;
+        uint32_t opts[6]; // MSS, WS, SACK permitted, TS (3)
+    } synack;
+    uint32_t *p_opt = synack.opts;
+
+    dst_entry_tcp *p_dst = get_syncookie_dst(src, dst);
+    if (!p_dst) {
+        return false;
+    }
+
+    syncookie::parse_options(p_syn, opts);
+    // Window scale and SACK permitted survive only in the timestamp echo
+    opts.ts = opts.ts && m_pcb.enable_ts_opt;
+    if (!opts.ts || !enable_wnd_scale) {
+        opts.wscale = TCP_SYNCOOKIE_NO_WSCALE;
+    }
+    opts.sack = opts.ts && opts.sack && m_pcb.enable_sack_opt;
+
+    hdr_len = (dst.get_sa_family() == AF_INET6 ? sizeof(struct ip6_hdr) : sizeof(struct iphdr)) +
+        sizeof(struct tcphdr);
+    adv_mss = p_dst->get_route_mtu() > hdr_len ? p_dst->get_route_mtu() - hdr_len : 536U;
+    if (LWIP_TCP_MSS > 0) {
+        adv_mss = std::min<uint16_t>(adv_mss, LWIP_TCP_MSS);
+    }
+    // MSS of the peer, as tcp_parseopt() limits it
+    uint16_t mss = (opts.mss == 0 || opts.mss > adv_mss) ? adv_mss : opts.mss;
+    uint32_t now = xlio_lwip::sys_now();
+
+    memset(&synack.hdr, 0, sizeof(synack.hdr));
+    synack.hdr.source = dst.get_in_port();
+    synack.hdr.dest = src.get_in_port();
+    synack.hdr.seq = htonl(syncookie::make_isn(src, dst, ntohl(p_syn->seq), mss, now));
+    synack.hdr.ack_seq = htonl(ntohl(p_syn->seq) + 1);
+    synack.hdr.syn = 1;
+    synack.hdr.ack = 1;
+    synack.hdr.window = htons(TCP_WND);
+
+    TCP_BUILD_MSS_OPTION(*p_opt, adv_mss);
+    ++p_opt;
+    if (opts.wscale != TCP_SYNCOOKIE_NO_WSCALE) {
+        TCP_BUILD_WNDSCALE_OPTION(*p_opt, rcv_wnd_scale);
+        ++p_opt;
+    }
+    if (opts.sack) {
+        TCP_BUILD_SACK_PERM_OPTION(*p_opt);
+        ++p_opt;
+    }
+    if (opts.ts) {
+        p_opt[0] = PP_HTONL(0x0101080A);
+        p_opt[1] = htonl(syncookie::make_tsval(now, opts));
+        p_opt[2] = htonl(opts.tsval);
+        p_opt += 3;
+    }
+    size_t len = (uint8_t *)p_opt - (uint8_t *)&synack.hdr;
+    synack.hdr.doff = len >> 2;
+
+    iovec iov = {&synack, len};
+    if (p_dst->slow_send_neigh(&iov, 1, m_so_ratelimit) <= 0) {
+        return false;
+    }
+
+    m_syncookie_sent_time = now;
+    m_b_syncookie_sent = true;
+    m_p_socket_stats->listen_counters.n_syncookie_sent++;
+    return true;
+}
+
+/*
+ * Passes the options of a valid SYN cookie in the final ACK of the handshake
+ * to lwIP, which creates the connection in tcp_syncookie_input().
+ */
+void sockinfo_tcp::syncookie_check_ack(mem_buf_desc_t *p_desc)
+{
+    const struct tcphdr *p_tcp_h = p_desc->rx.tcp.p_tcp_h;
+    syncookie::options opts;
+    uint16_t mss;
+
+    if (!p_tcp_h->ack || p_tcp_h->syn || p_tcp_h->rst) {
+        return;
+    }
+
+    // Stray ACKs are not hashed unless a cookie which may still be valid was sent
+    uint32_t now = xlio_lwip::sys_now();
+    if (!m_b_syncookie_sent || !syncookie::is_recent(m_syncookie_sent_time, now)) {
+        return;
+    }
+
+    uint32_t iss = ntohl(p_tcp_h->ack_seq) - 1;
+    if (!syncookie::check_isn(p_desc->rx.src, p_desc->rx.dst, ntohl(p_tcp_h->seq) - 1, iss, now,
+                              mss)) {
+        return;
+    }
+
+    syncookie::parse_options(p_tcp_h, opts);
+    m_syncookie.iss = iss;
+    m_syncookie.mss = mss;
+    m_syncookie.ts = opts.ts && m_pcb.enable_ts_opt;
+    m_syncookie.snd_scale = TCP_SYNCOOKIE_NO_WSCALE;
+    m_syncookie.sack = 0;
+    if (m_syncookie.ts) {
+        bool sack;
+        syncookie::decode_tsecr(opts.tsecr, m_syncookie.snd_scale, sack);
+        m_syncookie.sack = sack;
+    }
+    m_pcb.syncookie = &m_syncookie;
+
+    m_p_socket_stats->listen_counters.n_syncookie_recv++;
+}
+
+/*
+ * Validates the Fast Open cookie of an incoming SYN and passes the verdict to
+ * lwIP: either accept the SYN data or answer with a fresh cookie.
+ * The TCP_FASTOPEN queue length limits the half-open connections which may
+ * deliver data before the handshake completes.
+ */
+void sockinfo_tcp::fastopen_check_syn(mem_buf_desc_t *p_desc)
+{
+    const struct tcphdr *p_tcp_h = p_desc->rx.tcp.p_tcp_h;
+    syncookie::options opts;
+
+    if (!p_tcp_h->syn || p_tcp_h->ack || p_tcp_h->rst) {
+        return;
+    }
+
+    syncookie::parse_options(p_tcp_h, opts);
+    if (!opts.fastopen) {
+        return;
+    }
+
+    memset(&m_fastopen_syn, 0, sizeof(m_fastopen_syn));
+    if (opts.fastopen_cookie.len > 0 &&
+        syncookie::check_fastopen_cookie(p_desc->rx.src, p_desc->rx.dst, opts.fastopen_cookie)) {
+        m_fastopen_syn.accept_data = m_syn_received.size() < (size_t)m_fastopen_qlen;
+        if (m_fastopen_syn.accept_data && p_desc->rx.sz_payload > 0) {
+            m_p_socket_stats->listen_counters.n_fastopen_accepted++;
+        }
+    } else {
+        syncookie::make_fastopen_cookie(p_desc->rx.src, p_desc->rx.dst, m_fastopen_syn.cookie);
+        m_p_socket_stats->listen_counters.n_fastopen_cookie_sent++;
+    }
+    m_pcb.fastopen_syn = &m_fastopen_syn;
+}
+
+/*
+ * Starts the handshake with the cached Fast Open cookie of the destination.
+ * Without a cookie, or without data, the SYN carries no data. Without a cookie
+ * it carries an empty cookie request.
+ */
+err_t sockinfo_tcp::fastopen_connect()
+{
+    dst_entry_tcp *p_dst = (dst_entry_tcp *)m_p_connected_dst_entry;
+    const ip_address &ip = m_connected.get_ip_addr();
+    const void *data = NULL;
+    uint32_t len = 0;
+
+    if (m_fastopen_iov) {
+        data = m_fastopen_iov->iov_base;
+        len = (uint32_t)std::min<size_t>(m_fastopen_iov->iov_len, UINT32_MAX);
+    }
+    if (!p_dst->get_fastopen_cookie(m_pcb.fastopen)) {
+        m_pcb.fastopen.len = 0;
+    }
+
+    err_t err = tcp_connect_fastopen(&m_pcb, reinterpret_cast<const ip_addr_t *>(&ip),
+                                     ntohs(m_connected.get_in_port()), m_pcb.is_ipv6,
+                                     sockinfo_tcp::connect_lwip_cb, data, &len);
+    m_fastopen_len = (err == ERR_OK) ? len : 0;
+    return err;
+}
+
+/*
+ * Remembers the cookie the server returned in its SYN-ACK and forgets a
+ * cookie that didn't get the SYN data accepted.
+ */
+void sockinfo_tcp::fastopen_update_cache()
+{
+    dst_entry_tcp *p_dst = (dst_entry_tcp *)m_p_connected_dst_entry;
+
+    if (!p_dst) {
+        return;
+    }
+    if (m_pcb.flags & TF_FASTOPEN_COOKIE) {
+        p_dst->set_fastopen_cookie(m_pcb.fastopen);
+    } else if (m_fastopen_len > 0 && !(m_pcb.flags & TF_FASTOPEN_DATA)) {
+        p_dst->erase_fastopen_cookie();
+    }
+}
+
+/*
+ * sendto()/sendmsg() with MSG_FASTOPEN, or the first write after a connect()
+ * deferred by TCP_FASTOPEN_CONNECT: starts the handshake with the first iovec
+ * in the SYN. For a non-blocking socket the call returns the number of bytes
+ * queued with the SYN, as Linux does.
+ */
+ssize_t sockinfo_tcp::fastopen_tx(xlio_tx_call_attr_t &tx_arg)
+{
+    const struct sockaddr *addr = tx_arg.attr.addr;
+    socklen_t addrlen = tx_arg.attr.len;
+    int flags = tx_arg.attr.flags;
+    struct iovec *p_iov = tx_arg.attr.iov;
+    ssize_t sz_iov = tx_arg.attr.sz_iov;
+    bool with_data = (m_ops == m_ops_tcp && sz_iov > 0 && p_iov);
+    int ret;
+
+    tx_arg.attr.flags &= ~MSG_FASTOPEN;
+
+    if (m_b_fastopen_deferred) {
+        lock_tcp_con();
+        if (!m_b_fastopen_deferred) {
+            // Another thread has started the handshake meanwhile
+            unlock_tcp_con();
+            return m_ops->tx(tx_arg);
+        }
+        m_b_fastopen_deferred = false;
+        m_fastopen_iov = with_data ? p_iov : NULL;
+        m_fastopen_len = 0;
+        ret = start_connect();
+        m_fastopen_iov = NULL;
+    } else {
+        if (!(safe_mce_sys().tcp_fastopen & TFO_CLIENT_ENABLE)) {
+            errno = EOPNOTSUPP;
+            return -1;
+        }
+        if (!addr) {
+            errno = EDESTADDRREQ;
+            return -1;
+        }
+        if (m_sock_state != TCP_SOCK_INITED && m_sock_state != TCP_SOCK_BOUND) {
+            errno = EISCONN;
+            return -1;
+        }
+
+        tx_arg.attr.addr = NULL;
+        tx_arg.attr.len = 0;
+
+        if (!with_data) {
+            if (connect(addr, addrlen) < 0) {
+                return -1;
+            }
+            return m_ops->tx(tx_arg);
+        }
+
+        m_fastopen_iov = p_iov;
+        m_fastopen_len = 0;
+        ret = connect(addr, addrlen);
+        m_fastopen_iov = NULL;
+
+        if (isPassthrough()) {
+            return tx_os(tx_arg.opcode, p_iov, sz_iov, flags, addr, addrlen);
+        }
+    }
+
+    if (ret < 0 && (errno != EINPROGRESS || m_fastopen_len == 0)) {
+        return -1;
+    }
+
+    uint32_t sent = m_fastopen_len;
+    if (sent > 0) {
+        m_p_socket_stats->counters.n_tx_sent_byte_count += sent;
+        m_p_socket_stats->counters.n_tx_sent_pkt_count++;
+    }
+    if (ret < 0) {
+        return sent;
+    }
+
+    /* Blocking connect succeeded: send what the SYN didn't carry in the established
+     * connection.
+     */
+    ssize_t first = 0;
+    size_t skip = sent;
+    while (first < sz_iov && skip >= p_iov[first].iov_len) {
+        skip -= p_iov[first].iov_len;
+        ++first;
+    }
+    if (first >= sz_iov) {
+        return sent;
+    }
+
+    std::vector<struct iovec> rest_iov(p_iov + first, p_iov + sz_iov);
+    rest_iov[0].iov_base = (uint8_t *)rest_iov[0].iov_base + skip;
+    rest_iov[0].iov_len -= skip;
+    tx_arg.attr.iov = rest_iov.data();
+    tx_arg.attr.sz_iov = (ssize_t)rest_iov.size();
+    ssize_t rest = m_ops->tx(tx_arg);
+    tx_arg.attr.iov = p_iov;
+    tx_arg.attr.sz_iov = sz_iov;
+    if (rest < 0) {
+        return sent > 0 ? (ssize_t)sent : -1;
+    }
+    return sent + rest;
+}
+
 err_t sockinfo_tcp::clone_conn_cb(void *arg, struct tcp_pcb **newpcb)
 {
     sockinfo_tcp *new_sock;
@@ -3273,7 +3839,7 @@ err_t sockinfo_tcp::syn_received_timewait_cb(void *arg, struct tcp_pcb *newpcb)
 
     flow_tuple key;
     create_flow_tuple_key_from_pcb(key, newpcb);
-    listen_sock->m_syn_received[key] = newpcb;
+    listen_sock->m_syn_received.set(key, newpcb);
 
     listen_sock->m_received_syn_num++;
     listen_sock->m_p_socket_stats->listen_counters.n_rx_syn_tw++;
@@ -3338,7 +3904,7 @@ err_t sockinfo_tcp::syn_received_lwip_cb(void *arg, struct tcp_pcb *newpcb)
     flow_tuple key;
     create_flow_tuple_key_from_pcb(key, newpcb);
 
-    listen_sock->m_syn_received[key] = newpcb;
+    listen_sock->m_syn_received.set(key, newpcb);
 
     listen_sock->m_received_syn_num++;
 
@@ -3430,6 +3996,9 @@ err_t sockinfo_tcp::connect_lwip_cb(void *arg, struct tcp_pcb *tpcb, err_t err)
             conn->m_rcvbuff_max = 2 * conn->m_pcb.mss;
         }
         conn->fit_rcv_wnd(false);
+        if (conn->m_pcb.flags & TF_FASTOPEN) {
+            conn->fastopen_update_cache();
+        }
     } else {
         conn->m_error_status = ECONNREFUSED;
         conn->m_conn_state = TCP_CONN_FAILED;
@@ -3590,6 +4159,9 @@ bool sockinfo_tcp::is_writeable()
             si_tcp_logdbg("++++ async connect ready");
             m_sock_state = TCP_SOCK_CONNECTED_RDWR;
             goto noblock;
+        } else if (m_b_fastopen_deferred) {
+            // TCP_FASTOPEN_CONNECT: the first write sends the SYN
+            goto noblock;
         } else if (m_conn_state != TCP_CONN_CONNECTING) {
             // async connect failed for some reason. Reset our state and return ready fd
             si_tcp_logerr("async connect failed");
@@ -3823,6 +4395,44 @@ void sockinfo_tcp::fit_rcv_wnd(bool force_fit)
     }
 }
 
+// RCVBUF auto-tuning, see rcvbuf_autotune.
+// Assume locked by m_tcp_con_lock
+void sockinfo_tcp::rcvbuff_autotune_rx()
+{
+    tscval_t now;
+    int rcvbuff_default;
+
+    gettimeoftsc(&now);
+    if (m_rcvbuff_autotune.rx(now, get_tsc_rate_per_second() * RCVBUFF_AUTOTUNE_IDLE_SEC,
+                              m_pcb.rcv_nxt, m_pcb.rcv_wnd)) {
+        rcvbuff_default =
+            std::max(safe_mce_sys().sysctl_reader.get_tcp_rmem()->default_value, 2 * m_pcb.mss);
+        if (m_rcvbuff_max > rcvbuff_default) {
+            si_tcp_logfunc("rcvbuf auto-tuning: idle, shrink %d -> %d", m_rcvbuff_max,
+                           rcvbuff_default);
+            // The window is not retracted, rx_lwip_cb() shrinks it as data arrives.
+            m_rcvbuff_max = rcvbuff_default;
+            fit_rcv_wnd(false);
+        }
+    }
+}
+
+// Assume locked by m_tcp_con_lock
+void sockinfo_tcp::rcvbuff_autotune_read(int copied)
+{
+    tscval_t now;
+    int rcvbuff;
+
+    gettimeoftsc(&now);
+    rcvbuff = m_rcvbuff_autotune.read(copied, now, m_pcb.mss, m_rcvbuff_autotune_max);
+    if (rcvbuff > m_rcvbuff_max) {
+        si_tcp_logfunc("rcvbuf auto-tuning: %d bytes per RTT, grow %d -> %d",
+                       m_rcvbuff_autotune.space, m_rcvbuff_max, rcvbuff);
+        m_rcvbuff_max = rcvbuff;
+        fit_rcv_wnd(false);
+    }
+}
+
 void sockinfo_tcp::fit_snd_bufs(unsigned int new_max_snd_buff)
 {
     uint32_t sent_buffs_num = 0;
@@ -3955,6 +4565,20 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
             unlock_tcp_con();
             si_tcp_logdbg("(TCP_QUICKACK) value: %d", val);
             break;
+        case TCP_FASTOPEN:
+            val = *(int *)__optval;
+            lock_tcp_con();
+            m_fastopen_qlen = std::max(val, 0);
+            unlock_tcp_con();
+            si_tcp_logdbg("(TCP_FASTOPEN) qlen: %d", val);
+            break;
+        case TCP_FASTOPEN_CONNECT:
+            val = *(int *)__optval;
+            lock_tcp_con();
+            m_b_fastopen_connect = (val != 0);
+            unlock_tcp_con();
+            si_tcp_logdbg("(TCP_FASTOPEN_CONNECT) value: %d", val);
+            break;
         case TCP_ULP: {
             sockinfo_tcp_ops *ops {nullptr};
             if (__optval && __optlen >= 4 && strncmp((char *)__optval, "nvme", 4) == 0) {
@@ -4014,6 +4638,10 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
                     algo = &cubic_cc_algo;
                 } else if (cc_name == "none") {
                     algo = &none_cc_algo;
+                } else if (cc_name == "bbr") {
+                    algo = &bbr_cc_algo;
+                } else if (cc_name == "dctcp") {
+                    algo = &dctcp_cc_algo;
                 }
                 if (algo) {
                     lock_tcp_con();
@@ -4091,6 +4719,8 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
             // OS allocates double the size of memory requested by the application - not sure we
             // need it.
             m_rcvbuff_max = std::max(2 * m_pcb.mss, 2 * val);
+            // A buffer size set by the application disables auto-tuning.
+            m_rcvbuff_autotune_max = 0;
 
             fit_rcv_wnd(!is_connected());
             unlock_tcp_con();
@@ -4214,7 +4844,13 @@ int sockinfo_tcp::tcp_setsockopt(int __level, int __optname, __const void *__opt
             }
 
             lock_tcp_con();
-            ret = modify_ratelimit(m_p_connected_dst_entry, rate_limit);
+            if (safe_mce_sys().tcp_sw_pacing) {
+                // Pace in software instead of using a hardware rate limit context
+                m_pcb.max_pacing_rate = KB_TO_BYTE((uint64_t)rate_limit.rate);
+                ret = 0;
+            } else {
+                ret = modify_ratelimit(m_p_connected_dst_entry, rate_limit);
+            }
             unlock_tcp_con();
             if (ret) {
                 si_tcp_logdbg("error setting setsockopt SO_MAX_PACING_RATE: %d bytes/second ",
@@ -4286,7 +4922,8 @@ void sockinfo_tcp::get_tcp_info(struct tcp_info *ti)
 
     ti->tcpi_state = state < TCP_STATE_NR ? pcb_to_tcp_state[state] : 0;
     ti->tcpi_options = (!!(m_pcb.flags & TF_TIMESTAMP) * TCPI_OPT_TIMESTAMPS) |
-        (!!(m_pcb.flags & TF_WND_SCALE) * TCPI_OPT_WSCALE);
+        (!!(m_pcb.flags & TF_WND_SCALE) * TCPI_OPT_WSCALE) |
+        (!!(m_pcb.flags & TF_SACK) * TCPI_OPT_SACK);
     // We keep rto with TCP slow timer granularity and need to convert it to usec.
     ti->tcpi_rto = m_pcb.rto * safe_mce_sys().tcp_timer_resolution_msec * 2 * 1000U;
     ti->tcpi_advmss = m_pcb.advtsd_mss;
@@ -4335,6 +4972,24 @@ int sockinfo_tcp::getsockopt_offload(int __level, int __optname, void *__optval,
                 errno = EINVAL;
             }
             break;
+        case TCP_FASTOPEN:
+            if (*__optlen >= sizeof(int)) {
+                *(int *)__optval = m_fastopen_qlen;
+                si_tcp_logdbg("(TCP_FASTOPEN) qlen: %d", *(int *)__optval);
+                ret = 0;
+            } else {
+                errno = EINVAL;
+            }
+            break;
+        case TCP_FASTOPEN_CONNECT:
+            if (*__optlen >= sizeof(int)) {
+                *(int *)__optval = m_b_fastopen_connect;
+                si_tcp_logdbg("(TCP_FASTOPEN_CONNECT) value: %d", *(int *)__optval);
+                ret = 0;
+            } else {
+                errno = EINVAL;
+            }
+            break;
         case TCP_INFO:
             struct tcp_info ti;
             unsigned len;
@@ -4651,6 +5306,11 @@ int sockinfo_tcp::rx_wait_helper(int &poll_count, bool blocking)
     n = 0;
     // if in listen state go directly to wait part
 
+    if (blocking) {
+        // The thread may sleep, packets of its TX scope must not wait for it
+        ring::tx_scope_flush_all();
+    }
+
     consider_rings_migration();
 
     // There's only one CQ
@@ -4675,6 +5335,9 @@ int sockinfo_tcp::rx_wait_helper(int &poll_count, bool blocking)
 
         if (m_n_rx_pkt_ready_list_count) {
             m_p_socket_stats->counters.n_rx_poll_hit++;
+            if (blocking) {
+                rx_poll_budget_hit(poll_count);
+            }
         }
         return n;
     }
@@ -4685,11 +5348,12 @@ int sockinfo_tcp::rx_wait_helper(int &poll_count, bool blocking)
         return -1;
     }
 
-    if (poll_count < m_n_sysvar_rx_poll_num || m_n_sysvar_rx_poll_num == -1) {
+    if (poll_count < rx_poll_budget() || m_n_sysvar_rx_poll_num == -1) {
         return 0;
     }
 
     m_p_socket_stats->counters.n_rx_poll_miss++;
+    rx_poll_budget_miss();
     // if we polling too much - go to sleep
     si_tcp_logfuncall("%d: too many polls without data blocking=%d", m_fd, blocking);
     if (g_b_exit) {
@@ -5093,6 +5757,14 @@ void sockinfo_tcp::statistics_print(vlog_levels_t log_level /* = VLOG_DEBUG */)
                     pcb.ts_recent);
     }
 #endif
+
+    // Selective acknowledgment
+#if LWIP_TCP_SACK
+    if (pcb.flags & TF_SACK) {
+        vlog_printf(log_level, "SACK : ranges %u, sacked bytes %u, recovery_point %u, high_rxt %u\n",
+                    pcb.sack_sb_cnt, pcb.sack_bytes, pcb.recovery_point, pcb.high_rxt);
+    }
+#endif
 }
 
 int sockinfo_tcp::recvfrom_zcopy_free_packets(struct xlio_recvfrom_zcopy_packet_t *pkts,
@@ -5135,6 +5807,9 @@ int sockinfo_tcp::recvfrom_zcopy_free_packets(struct xlio_recvfrom_zcopy_packet_
             tcp_recved(&m_pcb, bytes_to_tcp_recved);
             m_rcvbuff_non_tcp_recved -= bytes_to_tcp_recved;
         }
+        if (m_rcvbuff_autotune_max) {
+            rcvbuff_autotune_read(total_rx);
+        }
     }
 
     unlock_tcp_con();
@@ -5468,23 +6143,11 @@ void tcp_seg_pool::put_tcp_segs(tcp_seg *seg_list)
 }
 
 tcp_timers_collection::tcp_timers_collection(int period, int resolution)
+    : m_wheel_lock("tcp_timers_wheel")
 {
     m_n_period = period;
     m_n_resolution = resolution;
-    m_n_intervals_size = period / resolution;
     m_timer_handle = NULL;
-    m_p_intervals = new timer_node_t *[m_n_intervals_size];
-    BULLSEYE_EXCLUDE_BLOCK_START
-    if (!m_p_intervals) {
-        __log_dbg("failed to allocate memory");
-        free_tta_resources();
-        throw_xlio_exception("failed to allocate memory");
-    }
-
-    BULLSEYE_EXCLUDE_BLOCK_END
-    memset(m_p_intervals, 0, sizeof(timer_node_t *) * m_n_intervals_size);
-    m_n_location = 0;
-    m_n_next_insert_bucket = 0;
     m_n_count = 0;
 }
 
@@ -5496,18 +6159,17 @@ tcp_timers_collection::~tcp_timers_collection()
 void tcp_timers_collection::free_tta_resources(void)
 {
     if (m_n_count) {
-        for (int i = 0; i < m_n_intervals_size; i++) {
-            if (m_p_intervals[i]) {
-                remove_timer(m_p_intervals[i]);
-            }
+        timer_node_t *node;
+
+        // Only armed timers are on the wheel
+        while ((node = m_wheel.first())) {
+            remove_timer(node);
         }
 
         if (m_n_count) {
             __log_dbg("not all TCP timers have been removed, count=%d", m_n_count);
         }
     }
-
-    delete[] m_p_intervals;
 }
 
 void tcp_timers_collection::clean_obj()
@@ -5528,16 +6190,20 @@ void tcp_timers_collection::clean_obj()
 void tcp_timers_collection::handle_timer_expired(void *user_data)
 {
     NOT_IN_USE(user_data);
-    timer_node_t *iter = m_p_intervals[m_n_location];
+    timer_node_t *iter;
     sockinfo_tcp *p_sock;
-    while (iter) {
+
+    m_wheel_lock.lock();
+    m_wheel.advance();
+
+    while ((iter = m_wheel.pop_expired())) {
+        m_wheel_lock.unlock();
+
         __log_funcall("timer expired on %p", iter->handler);
         p_sock = dynamic_cast<sockinfo_tcp *>(iter->handler);
 
-        /* It is not guaranteed that the same sockinfo object is met once
-         * in this loop.
-         * So in case sockinfo object is destroyed other processing
-         * of the same object mast be ingored.
+        /* The node is freed only by remove_timer() which is called from
+         * the internal thread, so it stays valid during this call.
          * TODO Check on is_cleaned() is not safe completely.
          */
         if (p_sock && !p_sock->is_cleaned()) {
@@ -5546,9 +6212,11 @@ void tcp_timers_collection::handle_timer_expired(void *user_data)
                 g_p_fd_collection->destroy_sockfd(p_sock);
             }
         }
-        iter = iter->next;
+        m_wheel_lock.lock();
     }
-    m_n_location = (m_n_location + 1) % m_n_intervals_size;
+    m_wheel_lock.unlock();
+
+    release_paced_sockets();
 
     /* Processing all messages for the daemon */
     if (g_p_agent != NULL) {
@@ -5556,20 +6224,74 @@ void tcp_timers_collection::handle_timer_expired(void *user_data)
     }
 }
 
+void tcp_timers_collection::add_paced_socket(sockinfo_tcp *sock)
+{
+    m_paced_lock.lock();
+    m_paced_sockets.push_back(sock);
+    m_paced_lock.unlock();
+}
+
+void tcp_timers_collection::remove_paced_socket(sockinfo_tcp *sock)
+{
+    m_paced_lock.lock();
+    m_paced_sockets.erase(sock);
+    m_paced_lock.unlock();
+}
+
+void tcp_timers_collection::release_paced_sockets()
+{
+    // Sockets are added by other threads, so even the emptiness check needs the lock
+    m_paced_lock.lock();
+    sockinfo_tcp::paced_sock_list_t::iterator iter = m_paced_sockets.begin();
+    while (iter != m_paced_sockets.end()) {
+        sockinfo_tcp *p_sock = *iter;
+        ++iter;
+        p_sock->pacing_release(m_paced_sockets);
+    }
+    m_paced_lock.unlock();
+}
+
+uint32_t tcp_timers_collection::arm_timer(void *timer_handle, unsigned int timeout_msec)
+{
+    timer_node_t *node = (timer_node_t *)timer_handle;
+    uint32_t expiry;
+
+    m_wheel_lock.lock();
+    // The earliest expiration is the next tick
+    expiry = m_wheel.get_tick() + std::max(msec_to_ticks(timeout_msec), 1U) - 1;
+    if (node->group != this) {
+        // Not registered yet, add_new_timer() arms it
+        m_wheel_lock.unlock();
+        return expiry;
+    }
+    if (timers_wheel::is_armed(node)) {
+        if ((int32_t)(node->group_expiry - expiry) <= 0) {
+            expiry = node->group_expiry;
+            m_wheel_lock.unlock();
+            return expiry;
+        }
+        timers_wheel::remove(node);
+    }
+    node->group_expiry = expiry;
+    m_wheel.insert(node);
+    m_wheel_lock.unlock();
+
+    return expiry;
+}
+
 void tcp_timers_collection::add_new_timer(timer_node_t *node, timer_handler *handler,
                                           void *user_data)
 {
+    m_wheel_lock.lock();
     node->handler = handler;
     node->user_data = user_data;
     node->group = this;
     node->next = NULL;
     node->prev = NULL;
-    if (m_p_intervals[m_n_next_insert_bucket] != NULL) {
-        m_p_intervals[m_n_next_insert_bucket]->prev = node;
-        node->next = m_p_intervals[m_n_next_insert_bucket];
-    }
-    m_p_intervals[m_n_next_insert_bucket] = node;
-    m_n_next_insert_bucket = (m_n_next_insert_bucket + 1) % m_n_intervals_size;
+    // New sockets are visited after a period, they arm their deadlines afterwards
+    node->group_expiry = m_wheel.get_tick() + msec_to_ticks(m_n_period) - 1;
+    m_wheel.insert(node);
+    m_wheel_lock.unlock();
 
     if (m_n_count == 0) {
         m_timer_handle = g_p_event_handler_manager->register_timer_event(m_n_resolution, this,
@@ -5586,22 +6308,12 @@ void tcp_timers_collection::remove_timer(timer_node_t *node)
         return;
     }
 
+    m_wheel_lock.lock();
     node->group = NULL;
-
-    if (node->prev) {
-        node->prev->next = node->next;
-    } else {
-        for (int i = 0; i < m_n_intervals_size; i++) {
-            if (m_p_intervals[i] == node) {
-                m_p_intervals[i] = node->next;
-                break;
-            }
-        }
-    }
-
-    if (node->next) {
-        node->next->prev = node->prev;
+    if (timers_wheel::is_armed(node)) {
+        timers_wheel::remove(node);
     }
+    m_wheel_lock.unlock();
 
     m_n_count--;
     if (m_n_count == 0) {
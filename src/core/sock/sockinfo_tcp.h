@@ -34,6 +34,9 @@
 #define TCP_SOCKINFO_H
 
 #include "utils/lock_wrapper.h"
+#include "util/flow_hash_map.h"
+#include "util/rcvbuf_autotune.h"
+#include "event/timers_wheel.h"
 #include "proto/mem_buf_desc.h"
 #include "sock/socket_fd_api.h"
 #include "dev/buffer_pool.h"
@@ -50,6 +53,10 @@
 
 #define BLOCK_THIS_RUN(blocking, flags) (blocking && !(flags & MSG_DONTWAIT))
 
+#ifndef TCP_FASTOPEN_CONNECT
+#define TCP_FASTOPEN_CONNECT 30
+#endif
+
 /**
  * Tcp socket states: rdma_offload or os_passthrough. in rdma_offload:
  * init --/bind()/ --> bound -- /listen()/ --> accept_ready -- /accept()may go to connected/ -->
@@ -111,9 +118,12 @@ struct socket_option_t {
     }
 };
 
+class dst_entry_tcp;
+
 typedef std::deque<socket_option_t *> socket_options_list_t;
 typedef std::map<tcp_pcb *, int> ready_pcb_map_t;
-typedef std::map<flow_tuple, tcp_pcb *> syn_received_map_t;
+typedef flow_hash_map<flow_tuple, tcp_pcb *> syn_received_map_t;
+typedef flow_hash_map<flow_tuple, dst_entry_tcp *> syncookie_dst_map_t;
 typedef std::map<sock_addr, xlio_desc_list_t> peer_map_t;
 
 /* taken from inet_ecn.h in kernel */
@@ -132,6 +142,8 @@ public:
         return NODE_OFFSET(sockinfo_tcp, accepted_conns_node);
     }
     typedef xlio_list_t<sockinfo_tcp, sockinfo_tcp::accepted_conns_node_offset> sock_list_t;
+    static inline size_t paced_node_offset(void) { return NODE_OFFSET(sockinfo_tcp, paced_node); }
+    typedef xlio_list_t<sockinfo_tcp, sockinfo_tcp::paced_node_offset> paced_sock_list_t;
     sockinfo_tcp(int fd, int domain);
     virtual ~sockinfo_tcp();
 
@@ -218,7 +230,7 @@ public:
     bool inline is_errorable(int *errors);
     bool is_closable()
     {
-        return get_tcp_state(&m_pcb) == CLOSED && m_syn_received.empty() &&
+        return get_tcp_state(&m_pcb) == CLOSED && m_syn_received.size() == 0 &&
             m_accepted_conns.empty();
     }
     bool inline is_destroyable_lock(void)
@@ -310,10 +322,19 @@ public:
         if (m_timer_pending) {
             tcp_timer();
         }
+        if (unlikely(m_pcb.pacing_pending)) {
+            schedule_pacing_release();
+        }
+        arm_tcp_timer();
         m_tcp_con_lock.unlock();
     }
 
+    void pacing_release(paced_sock_list_t &paced_list);
+
     list_node<sockinfo_tcp, sockinfo_tcp::accepted_conns_node_offset> accepted_conns_node;
+    /* Member of the TCP timers collection pacing list, protected by both the
+     * collection pacing lock and m_tcp_con_lock. */
+    list_node<sockinfo_tcp, sockinfo_tcp::paced_node_offset> paced_node;
 
     inline void set_reguired_send_block(unsigned sz) { m_required_send_block = sz; }
 
@@ -348,6 +369,10 @@ private:
     int m_rcvbuff_max;
     int m_rcvbuff_current;
     int m_rcvbuff_non_tcp_recved;
+    /* RCVBUF auto-tuning, 0 - disabled (also by SO_RCVBUF) */
+    static const unsigned RCVBUFF_AUTOTUNE_IDLE_SEC = 1;
+    int m_rcvbuff_autotune_max;
+    rcvbuf_autotune m_rcvbuff_autotune;
     tcp_conn_state_e m_conn_state;
     fd_array_t *m_iomux_ready_fd_array;
     struct linger m_linger;
@@ -363,6 +388,26 @@ private:
     // We need this map since for syn received connection no sockinfo is created yet!
     syn_received_map_t m_syn_received;
     uint32_t m_received_syn_num;
+    // Relevant only for listen sockets: routes for SYN-ACKs sent with a SYN cookie, keyed by
+    // the local and remote addresses. The connection gets its own dst_entry once accepted.
+    syncookie_dst_map_t m_syncookie_dst;
+    // Options of a valid SYN cookie, passed to lwIP through m_pcb.syncookie
+    struct tcp_syncookie m_syncookie;
+    // Time of the last SYN-ACK with a SYN cookie, ACKs are not validated long after it
+    uint32_t m_syncookie_sent_time;
+    bool m_b_syncookie_sent;
+    // Relevant only for listen sockets: TCP_FASTOPEN queue length, 0 if Fast Open is disabled
+    int m_fastopen_qlen;
+    // Verdict on a Fast Open SYN, passed to lwIP through m_pcb.fastopen_syn
+    struct tcp_fastopen_syn m_fastopen_syn;
+    // Relevant only for clients: data of sendto(MSG_FASTOPEN) during connect() and the number
+    // of its bytes which were sent in the SYN
+    const struct iovec *m_fastopen_iov;
+    uint32_t m_fastopen_len;
+    // Relevant only for clients: TCP_FASTOPEN_CONNECT, and whether connect() left the SYN
+    // to the first write
+    bool m_b_fastopen_connect;
+    bool m_b_fastopen_deferred;
 
     /* pending connections */
     sock_list_t m_accepted_conns;
@@ -373,6 +418,25 @@ private:
     void *m_timer_handle;
     lock_spin_recursive m_tcp_con_lock;
     bool m_timer_pending;
+    /* The TCP timer is armed on the timers collection wheel to expire at
+     * m_timer_expiry tick. Protected by m_tcp_con_lock, except for the re-arm of
+     * an expired timer which finds the lock busy, see handle_timer_expired(). */
+    bool m_timer_armed;
+    uint32_t m_timer_expiry;
+#if LWIP_TCP_RACK_TLP
+    /* RACK reordering and TLP deadlines are shorter than the TCP timer period, so
+     * they have a timer of their own on the wheel, armed to expire not later than
+     * m_rack_tlp_deadline_us (0 - not armed). Protected by m_tcp_con_lock. */
+    void *m_rack_tlp_timer_handle;
+    uint64_t m_rack_tlp_deadline_us;
+
+    void arm_rack_tlp_timer();
+    void rack_tlp_timer();
+#endif /* LWIP_TCP_RACK_TLP */
+
+    void arm_tcp_timer();
+
+    void schedule_pacing_release();
 
     // used for reporting 'connected' on second non-blocking call to connect or
     // second call to failed connect blocking socket.
@@ -407,6 +471,7 @@ private:
     inline void init_pbuf_custom(mem_buf_desc_t *p_desc);
 
     void tcp_timer();
+    void update_loss_recovery_stats();
 
     bool prepare_listen_to_close();
 
@@ -534,6 +599,32 @@ private:
     struct tcp_pcb *get_syn_received_pcb(const flow_tuple &key) const;
     struct tcp_pcb *get_syn_received_pcb(const sock_addr &src, const sock_addr &dst);
 
+    // SYN cookies are used once the half-open connections reach the threshold or the backlog
+    inline bool is_syncookie_active() const
+    {
+        size_t threshold = safe_mce_sys().tcp_syncookies;
+        return threshold &&
+            (m_syn_received.size() >= threshold || m_syn_received.size() >= (size_t)m_backlog);
+    }
+    bool syncookie_send_synack(mem_buf_desc_t *p_desc);
+    void syncookie_check_ack(mem_buf_desc_t *p_desc);
+    dst_entry_tcp *get_syncookie_dst(const sock_addr &src, const sock_addr &dst);
+    void clear_syncookie_dst();
+
+    inline bool is_fastopen_listener() const
+    {
+        return m_fastopen_qlen > 0 && (safe_mce_sys().tcp_fastopen & TFO_SERVER_ENABLE);
+    }
+    inline bool is_fastopen_connect() const
+    {
+        return m_b_fastopen_connect && (safe_mce_sys().tcp_fastopen & TFO_CLIENT_ENABLE);
+    }
+    void fastopen_check_syn(mem_buf_desc_t *p_desc);
+    ssize_t fastopen_tx(xlio_tx_call_attr_t &tx_arg);
+    err_t fastopen_connect();
+    void fastopen_update_cache();
+    int start_connect();
+
     virtual mem_buf_desc_t *get_front_m_rx_pkt_ready_list();
     virtual size_t get_size_m_rx_pkt_ready_list();
     virtual void pop_front_m_rx_pkt_ready_list();
@@ -550,6 +641,8 @@ private:
     inline int rx_wait_lockless(int &poll_count, bool blocking);
     int rx_wait_helper(int &poll_count, bool blocking);
     void fit_rcv_wnd(bool force_fit);
+    void rcvbuff_autotune_rx();
+    void rcvbuff_autotune_read(int copied);
     void fit_snd_bufs(unsigned int new_max);
     void fit_snd_bufs_to_nagle(bool disable_nagle);
 
@@ -582,6 +675,9 @@ private:
 
 extern tcp_seg_pool *g_tcp_seg_pool;
 
+/* Hierarchical timing wheel of the TCP sockets timers. A socket arms its timer
+ * only when lwIP has a deadline for the connection, so idle connections cost
+ * nothing on the timer ticks. */
 class tcp_timers_collection : public timers_group, public cleanable_obj {
 public:
     tcp_timers_collection(int period, int resolution);
@@ -591,6 +687,21 @@ public:
 
     virtual void handle_timer_expired(void *user_data);
 
+    // sockets with paced data are released on every timer tick
+    void add_paced_socket(sockinfo_tcp *sock);
+    void remove_paced_socket(sockinfo_tcp *sock);
+
+    // Arm the timer to expire not later than in the given time. A timer which
+    // is armed to expire earlier is left as is. Returns the expiration tick.
+    uint32_t arm_timer(void *node, unsigned int timeout_msec);
+
+    inline uint32_t get_tick() const { return m_wheel.get_tick(); }
+    inline uint32_t msec_to_ticks(unsigned int msec) const
+    {
+        return (msec + m_n_resolution - 1) / m_n_resolution;
+    }
+    inline int get_period() const { return m_n_period; }
+
 protected:
     // add a new timer
     void add_new_timer(timer_node_t *node, timer_handler *handler, void *user_data);
@@ -601,16 +712,19 @@ protected:
 
 private:
     void *m_timer_handle;
-    timer_node_t **m_p_intervals;
 
     int m_n_period;
     int m_n_resolution;
-    int m_n_intervals_size;
-    int m_n_location;
     int m_n_count;
-    int m_n_next_insert_bucket;
+
+    lock_spin m_wheel_lock;
+    timers_wheel m_wheel;
+
+    lock_spin m_paced_lock;
+    sockinfo_tcp::paced_sock_list_t m_paced_sockets;
 
     void free_tta_resources();
+    void release_paced_sockets();
 };
 
 extern tcp_timers_collection *g_tcp_timers_collection;
@@ -119,6 +119,16 @@ inline int sockinfo_udp::rx_wait(bool blocking)
     ssize_t ret = 0;
     int32_t loops = 0;
     int32_t loops_to_go = blocking ? m_loops_to_go : 1;
+    // Rings are attached, the adaptive budget replaces the fixed loops number
+    bool poll_budget = blocking && m_loops_to_go == m_n_sysvar_rx_poll_num;
+
+    if (poll_budget) {
+        loops_to_go = rx_poll_budget();
+    }
+    if (blocking) {
+        // The thread may sleep, packets of its TX scope must not wait for it
+        ring::tx_scope_flush_all();
+    }
     epoll_event rx_epfd_events[SI_RX_EPFD_EVENT_MAX];
     uint64_t poll_sn = 0;
 
@@ -146,6 +156,9 @@ inline int sockinfo_udp::rx_wait(bool blocking)
         m_rx_udp_poll_os_ratio_counter++;
         if (is_readable(&poll_sn)) {
             m_p_socket_stats->counters.n_rx_poll_hit++;
+            if (poll_budget) {
+                rx_poll_budget_hit(loops);
+            }
             return 0;
         }
 
@@ -169,6 +182,9 @@ inline int sockinfo_udp::rx_wait(bool blocking)
         }
     } // End polling loop
     m_p_socket_stats->counters.n_rx_poll_miss++;
+    if (poll_budget) {
+        rx_poll_budget_miss();
+    }
 
     while (blocking) {
         if (unlikely(m_state == SOCKINFO_DESTROYING)) {
@@ -384,6 +400,9 @@ sockinfo_udp::sockinfo_udp(int fd, int domain)
     , m_port_map_lock("sockinfo_udp::m_ports_map_lock")
     , m_port_map_index(0)
     , m_p_last_dst_entry(NULL)
+    , m_b_tx_batch(false)
+    , m_udp_gso_size(0)
+    , m_p_tx_batch_dst(NULL)
     , m_tos(0)
     , m_n_sysvar_rx_poll_yield_loops(safe_mce_sys().rx_poll_yield_loops)
     , m_n_sysvar_rx_udp_poll_os_ratio(safe_mce_sys().rx_udp_poll_os_ratio)
@@ -1255,6 +1274,29 @@ int sockinfo_udp::setsockopt(int __level, int __optname, __const void *__optval,
             m_port_map_lock.unlock();
             return 0;
         }
+        case UDP_SEGMENT: {
+            if (!__optval || __optlen < sizeof(int)) {
+                si_udp_logdbg("UDP_SEGMENT, bad optval/optlen, passing to OS");
+                break;
+            }
+            int val = *(const int *)__optval;
+            if (val < 0 || val > USHRT_MAX) {
+                si_udp_logdbg("UDP_SEGMENT, bad segment size %d, passing to OS", val);
+                break;
+            }
+            m_udp_gso_size = (uint16_t)val;
+            si_udp_logdbg("IPPROTO_UDP, UDP_SEGMENT=%u", m_udp_gso_size);
+            break;
+        }
+        case UDP_GRO: {
+            if (!__optval || __optlen < sizeof(int)) {
+                si_udp_logdbg("UDP_GRO, bad optval/optlen, passing to OS");
+                break;
+            }
+            m_b_udp_gro = (*(const int *)__optval != 0);
+            si_udp_logdbg("IPPROTO_UDP, UDP_GRO=%s", m_b_udp_gro ? "true" : "false");
+            break;
+        }
         default:
             si_udp_logdbg("IPPROTO_UDP, optname=%s (%d)", setsockopt_ip_opt_to_str(__optname),
                           __optname);
@@ -1862,6 +1904,110 @@ out:
     return ret;
 }
 
+int sockinfo_udp::rx_mmsg(struct mmsghdr *mmsghdr, unsigned int vlen, int flags,
+                          const struct timespec *timeout)
+{
+    int errno_tmp = errno;
+    int ret = 0;
+    unsigned int num_of_msg = 0;
+    struct timespec start_time = TIMESPEC_INITIALIZER, current_time = TIMESPEC_INITIALIZER,
+                    delta_time = TIMESPEC_INITIALIZER;
+
+    si_udp_logfunc("vlen=%u flags=%x", vlen, flags);
+
+    // Peek and zero copy keep packets referenced per message, use the generic path
+    if (unlikely(flags & (MSG_PEEK | MSG_XLIO_ZCOPY | MSG_XLIO_ZCOPY_FORCE | MSG_ERRQUEUE))) {
+        return socket_fd_api::rx_mmsg(mmsghdr, vlen, flags, timeout);
+    }
+
+    if (timeout) {
+        gettime(&start_time);
+    }
+
+    while (num_of_msg < vlen) {
+        /* Drain the ready list under a single lock. Follow rx() and leave the
+         * first packet to the regular path when the OS must be sampled or the
+         * CQ drain rate is limited.
+         */
+        if (m_n_rx_pkt_ready_list_count > 0 &&
+            (num_of_msg > 0 ||
+             (m_n_sysvar_rx_cq_drain_rate_nsec == MCE_RX_CQ_DRAIN_RATE_DISABLED &&
+              !(m_n_sysvar_rx_udp_poll_os_ratio > 0 &&
+                m_rx_udp_poll_os_ratio_counter >= m_n_sysvar_rx_udp_poll_os_ratio)))) {
+            m_lock_rcv.lock();
+            if (unlikely(m_state == SOCKINFO_DESTROYING)) {
+                m_lock_rcv.unlock();
+                errno = EBADFD;
+                ret = -1;
+                break;
+            }
+            if (num_of_msg == 0) {
+                save_stats_threadid_rx();
+            }
+            num_of_msg += rx_ready_list_drain(mmsghdr + num_of_msg, vlen - num_of_msg, flags);
+            m_lock_rcv.unlock();
+
+            if (num_of_msg == vlen) {
+                break;
+            }
+        }
+
+        if (num_of_msg > 0) {
+            if (flags & MSG_WAITFORONE) {
+                flags |= MSG_DONTWAIT;
+            }
+            if (timeout) {
+                gettime(&current_time);
+                ts_sub(&current_time, &start_time, &delta_time);
+                if (ts_cmp(&delta_time, timeout, >)) {
+                    break;
+                }
+            }
+        }
+
+        /* Regular path: polls the CQ (refilling the ready list in bulk),
+         * samples the OS or blocks according to the socket settings.
+         */
+        int in_flags = flags;
+        struct msghdr *msg = &mmsghdr[num_of_msg].msg_hdr;
+        msg->msg_flags = 0;
+        ret = rx(RX_RECVMSG, msg->msg_iov, msg->msg_iovlen, &in_flags,
+                 (__SOCKADDR_ARG)msg->msg_name, (socklen_t *)&msg->msg_namelen, msg);
+        if (ret < 0) {
+            break;
+        }
+        mmsghdr[num_of_msg].msg_len = ret;
+        num_of_msg++;
+    }
+
+    if (num_of_msg || ret == 0) {
+        errno = errno_tmp;
+        return num_of_msg;
+    }
+    return ret;
+}
+
+unsigned int sockinfo_udp::rx_ready_list_drain(struct mmsghdr *mmsghdr, unsigned int vlen,
+                                               int flags)
+{
+    unsigned int i;
+
+    for (i = 0; i < vlen && m_n_rx_pkt_ready_list_count > 0; i++) {
+        struct msghdr *msg = &mmsghdr[i].msg_hdr;
+        int out_flags = 0;
+
+        msg->msg_flags = 0;
+        handle_cmsg(msg, flags);
+        mmsghdr[i].msg_len =
+            dequeue_packet(msg->msg_iov, msg->msg_iovlen, (sockaddr *)msg->msg_name,
+                           &msg->msg_namelen, flags, &out_flags);
+        msg->msg_flags |= out_flags & MSG_TRUNC;
+    }
+    m_rx_udp_poll_os_ratio_counter += i;
+
+    return i;
+}
+
 void sockinfo_udp::handle_ip_pktinfo(struct cmsg_state *cm_state)
 {
     mem_buf_desc_t *p_desc = m_rx_pkt_ready_list.front();
@@ -1902,6 +2048,20 @@ void sockinfo_udp::handle_ip_pktinfo(struct cmsg_state *cm_state)
     }
 }
 
+void sockinfo_udp::handle_udp_gro(struct cmsg_state *cm_state)
+{
+    if (!m_b_udp_gro) {
+        return;
+    }
+
+    mem_buf_desc_t *p_desc = m_rx_pkt_ready_list.front();
+
+    if (p_desc && p_desc->rx.udp.gro_size) {
+        int gro_size = p_desc->rx.udp.gro_size;
+        insert_cmsg(cm_state, SOL_UDP, UDP_GRO, &gro_size, sizeof(gro_size));
+    }
+}
+
 // This function is relevant only for non-blocking socket
 void sockinfo_udp::set_immediate_os_sample()
 {
@@ -2024,6 +2184,87 @@ int sockinfo_udp::rx_request_notification(uint64_t poll_sn)
 }
 
 ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
+{
+    si_udp_logfunc("");
+
+    m_lock_snd.lock();
+    ssize_t ret = tx_helper(tx_arg);
+    m_lock_snd.unlock();
+    return ret;
+}
+
+int sockinfo_udp::tx_mmsg(struct mmsghdr *mmsghdr, unsigned int vlen, int flags)
+{
+    /* A single message gains nothing from batching and MSG_OOB always goes
+     * to the OS, so let the generic implementation handle these cases.
+     */
+    if (vlen <= 1 || (flags & MSG_OOB)) {
+        return socket_fd_api::tx_mmsg(mmsghdr, vlen, flags);
+    }
+
+    si_udp_logfunc("vlen=%u flags=%x", vlen, flags);
+
+    int num_of_msg = 0;
+    ssize_t ret = 0;
+
+    m_lock_snd.lock();
+
+    m_b_tx_batch = true;
+    for (unsigned int i = 0; i < vlen; i++) {
+        xlio_tx_call_attr_t tx_arg;
+
+        tx_arg.opcode = TX_SENDMSG;
+        tx_arg.attr.iov = mmsghdr[i].msg_hdr.msg_iov;
+        tx_arg.attr.sz_iov = (ssize_t)mmsghdr[i].msg_hdr.msg_iovlen;
+        tx_arg.attr.flags = flags;
+        tx_arg.attr.addr = (struct sockaddr *)(__SOCKADDR_ARG)mmsghdr[i].msg_hdr.msg_name;
+        tx_arg.attr.len = (socklen_t)mmsghdr[i].msg_hdr.msg_namelen;
+        tx_arg.attr.hdr = &mmsghdr[i].msg_hdr;
+
+        ret = tx_helper(tx_arg);
+        if (ret < 0) {
+            break;
+        }
+        num_of_msg++;
+        mmsghdr[i].msg_len = ret;
+    }
+    m_b_tx_batch = false;
+
+    // Ring migration is postponed until the batch is submitted
+    dst_entry *p_last_dst = m_p_tx_batch_dst;
+    tx_batch_close();
+    if (p_last_dst && unlikely(p_last_dst->try_migrate_ring(m_lock_snd))) {
+        m_p_socket_stats->counters.n_tx_migrations++;
+    }
+
+    m_lock_snd.unlock();
+
+    return num_of_msg ? num_of_msg : ret;
+}
+
+void sockinfo_udp::tx_batch_switch(dst_entry *p_dst)
+{
+    if (m_p_tx_batch_dst) {
+        if (m_p_tx_batch_dst->get_ring() == p_dst->get_ring()) {
+            // Same ring, the batch can be continued
+            m_p_tx_batch_dst = p_dst;
+            return;
+        }
+        m_p_tx_batch_dst->tx_batch_end();
+    }
+    m_p_tx_batch_dst = p_dst;
+    m_p_tx_batch_dst->tx_batch_start();
+}
+
+void sockinfo_udp::tx_batch_close()
+{
+    if (m_p_tx_batch_dst) {
+        m_p_tx_batch_dst->tx_batch_end();
+        m_p_tx_batch_dst = NULL;
+    }
+}
+
+ssize_t sockinfo_udp::tx_helper(xlio_tx_call_attr_t &tx_arg)
 {
     const iovec *p_iov = tx_arg.attr.iov;
     const ssize_t sz_iov = tx_arg.attr.sz_iov;
@@ -2036,10 +2277,6 @@ ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
     dst_entry *p_dst_entry = m_p_connected_dst_entry; // Default for connected() socket but we'll
                                                       // update it on a specific sendTO(__to) call
 
-    si_udp_logfunc("");
-
-    m_lock_snd.lock();
-
     save_stats_threadid_tx();
 
     /* Let allow OS to process all invalid scenarios to avoid any
@@ -2109,7 +2346,6 @@ ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
                         INC_ERR_TX_COUNT;
 #endif
                         errno = EAGAIN;
-                        m_lock_snd.unlock();
                         return -1;
                     }
                 }
@@ -2158,24 +2394,40 @@ ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
 
     {
         xlio_send_attr attr = {(xlio_wr_tx_packet_attr)0, 0, 0, 0};
+        uint16_t gso_size = m_udp_gso_size;
+        if (tx_arg.opcode == TX_SENDMSG && tx_arg.attr.hdr &&
+            tx_arg.attr.hdr->msg_controllen > 0) {
+            if (unlikely(tx_get_gso_size(tx_arg.attr.hdr, gso_size) < 0)) {
+                errno = EINVAL;
+                return -1;
+            }
+        }
         bool b_blocking = m_b_blocking;
         if (unlikely(__flags & MSG_DONTWAIT)) {
             b_blocking = false;
         }
 
         attr.length = static_cast<size_t>(sz_data_payload);
+        if (gso_size && attr.length > gso_size) {
+            attr.mss = gso_size;
+        }
         attr.flags = (xlio_wr_tx_packet_attr)((b_blocking * XLIO_TX_PACKET_BLOCK) |
                                               (is_dummy * XLIO_TX_PACKET_DUMMY));
         if (likely(p_dst_entry->is_valid())) {
+            if (m_b_tx_batch) {
+                tx_batch_switch(p_dst_entry);
+            }
             // All set for fast path packet sending - this is our best performance flow
             ret = p_dst_entry->fast_send(p_iov, sz_iov, attr);
         } else {
+            // Slow path can replace the dst_entry ring, so submit the batch first
+            tx_batch_close();
             // updates the dst_entry internal information and packet headers
             ret = p_dst_entry->slow_send(p_iov, sz_iov, attr, m_so_ratelimit, __flags, this,
                                          tx_arg.opcode);
         }
 
-        if (unlikely(p_dst_entry->try_migrate_ring(m_lock_snd))) {
+        if (!m_b_tx_batch && unlikely(p_dst_entry->try_migrate_ring(m_lock_snd))) {
             m_p_socket_stats->counters.n_tx_migrations++;
         }
 
@@ -2194,7 +2446,6 @@ ssize_t sockinfo_udp::tx(xlio_tx_call_attr_t &tx_arg)
 #ifdef XLIO_TIME_MEASURE
         TAKE_T_TX_END;
 #endif
-        m_lock_snd.unlock();
 
         /* Restore errno on function entry in case success */
         if (ret >= 0) {
@@ -2210,15 +2461,33 @@ tx_packet_to_os:
 #ifdef XLIO_TIME_MEASURE
     INC_GO_TO_OS_TX_COUNT;
 #endif
+    // Keep the order of offloaded and OS packets
+    tx_batch_close();
     // Calling OS transmit
     ret = socket_fd_api::tx_os(tx_arg.opcode, p_iov, sz_iov, __flags, __dst, __dstlen);
 
 tx_packet_to_os_stats:
     save_stats_tx_os(ret);
-    m_lock_snd.unlock();
     return ret;
 }
 
+// Segment size from UDP_SEGMENT cmsg overrides the socket option
+int sockinfo_udp::tx_get_gso_size(const struct msghdr *msg, uint16_t &gso_size)
+{
+    struct cmsghdr *cmsg;
+
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR((struct msghdr *)msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_SEGMENT) {
+            if (cmsg->cmsg_len != CMSG_LEN(sizeof(uint16_t))) {
+                si_udp_logdbg("UDP_SEGMENT cmsg has wrong length %zu", (size_t)cmsg->cmsg_len);
+                return -1;
+            }
+            gso_size = *(uint16_t *)CMSG_DATA(cmsg);
+        }
+    }
+    return 0;
+}
+
 ssize_t sockinfo_udp::check_payload_size(const iovec *p_iov, ssize_t sz_iov)
 {
     // Calc user data payload size
@@ -53,6 +53,14 @@
 #include "sock-redirect.h"
 #include "sockinfo.h"
 
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
 // Send flow dst_entry map
 typedef std::unordered_map<sock_addr, dst_entry *> dst_entry_map_t;
 
@@ -125,6 +133,12 @@ public:
      */
     ssize_t rx(const rx_call_t call_type, iovec *p_iov, ssize_t sz_iov, int *p_flags,
                sockaddr *__from = NULL, socklen_t *__fromlen = NULL, struct msghdr *__msg = NULL);
+    /**
+     * Batch receive for recvmmsg(): packets already queued in the ready list
+     * are dequeued under a single lock and only the CQ poll/wait goes through rx()
+     */
+    int rx_mmsg(struct mmsghdr *mmsghdr, unsigned int vlen, int flags,
+                const struct timespec *timeout);
     /**
      * Check that a call to this sockinfo rx() will not block
      * -> meaning, we got an offloaded ready rx datagram
@@ -146,11 +160,17 @@ public:
      * true)
      */
     ssize_t tx(xlio_tx_call_attr_t &tx_arg);
+    /**
+     * Batch send for sendmmsg(): the socket lock is taken once and messages
+     * sent over the same ring are submitted to HW with a single doorbell
+     */
+    int tx_mmsg(struct mmsghdr *mmsghdr, unsigned int vlen, int flags);
     /**
      * Check that a call to this sockinof rx() will not block
      * -> meaning, we got a ready rx packet
      */
     void rx_add_ring_cb(ring *p_ring);
+    bool rx_gro_enabled() { return m_b_udp_gro; }
     void rx_del_ring_cb(ring *p_ring);
     virtual int rx_verify_available_data();
 
@@ -212,6 +232,10 @@ private:
     dst_entry *m_p_last_dst_entry;
     sock_addr m_last_sock_addr;
 
+    bool m_b_tx_batch; // Protected by m_lock_snd
+    uint16_t m_udp_gso_size; // UDP_SEGMENT, 0 - disabled
+    dst_entry *m_p_tx_batch_dst; // dst_entry whose ring TX batch is open
+
     chunk_list_t<mem_buf_desc_t *> m_rx_pkt_ready_list;
 
     uint8_t m_tos;
@@ -257,6 +281,11 @@ private:
     void save_stats_tx_offload(int bytes, bool is_dummy);
 
     inline int rx_wait(bool blocking);
+    ssize_t tx_helper(xlio_tx_call_attr_t &tx_arg);
+    int tx_get_gso_size(const struct msghdr *msg, uint16_t &gso_size);
+    void tx_batch_switch(dst_entry *p_dst);
+    void tx_batch_close();
+    unsigned int rx_ready_list_drain(struct mmsghdr *mmsghdr, unsigned int vlen, int flags);
     inline int poll_os();
 
     virtual inline void reuse_buffer(mem_buf_desc_t *buff);
@@ -298,6 +327,7 @@ private:
     virtual size_t handle_msg_trunc(size_t total_rx, size_t payload_size, int in_flags,
                                     int *p_out_flags);
     virtual void handle_ip_pktinfo(struct cmsg_state *cm_state);
+    virtual void handle_udp_gro(struct cmsg_state *cm_state);
 
     virtual mem_buf_desc_t *get_front_m_rx_pkt_ready_list();
     virtual size_t get_size_m_rx_pkt_ready_list();
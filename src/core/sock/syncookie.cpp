@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include <arpa/inet.h>
+#include <algorithm>
+#include <random>
+
+#include "lwip/tcp.h"
+#include "syncookie.h"
+
+/* A cookie is accepted for this number of counter periods (2^16 msec each) */
+#define SYNCOOKIE_MAX_AGE 2U
+
+#define SYNCOOKIE_COUNT_SHIFT 16
+#define SYNCOOKIE_SEQ_BITS    24
+#define SYNCOOKIE_SEQ_MASK    ((1U << SYNCOOKIE_SEQ_BITS) - 1)
+
+/* TSval bits which carry the options: window scale [0..3] and SACK permitted [4] */
+#define SYNCOOKIE_TS_OPT_BITS 6
+#define SYNCOOKIE_TS_OPT_MASK ((1U << SYNCOOKIE_TS_OPT_BITS) - 1)
+#define SYNCOOKIE_TS_WSCALE   0x0FU
+#define SYNCOOKIE_TS_SACK     0x10U
+
+#define TCPOPT_FASTOPEN     34
+#define FASTOPEN_COOKIE_LEN 8U
+
+/* MSS values which can be encoded, the peer MSS is rounded down to one of them */
+static const uint16_t s_syncookie_mss[] = {536, 1220, 1300, 1420, 1440, 1460, 4312, 8940};
+
+#define SIPROUND(v0, v1, v2, v3)                                                                   \
+    do {                                                                                           \
+        v0 += v1;                                                                                  \
+        v1 = (v1 << 13) | (v1 >> 51);                                                              \
+        v1 ^= v0;                                                                                  \
+        v0 = (v0 << 32) | (v0 >> 32);                                                              \
+        v2 += v3;                                                                                  \
+        v3 = (v3 << 16) | (v3 >> 48);                                                              \
+        v3 ^= v2;                                                                                  \
+        v0 += v3;                                                                                  \
+        v3 = (v3 << 21) | (v3 >> 43);                                                              \
+        v3 ^= v0;                                                                                  \
+        v2 += v1;                                                                                  \
+        v1 = (v1 << 17) | (v1 >> 47);                                                              \
+        v1 ^= v2;                                                                                  \
+        v2 = (v2 << 32) | (v2 >> 32);                                                              \
+    } while (0)
+
+/* SipHash-2-4 of whole 64-bit words */
+static uint64_t siphash24(const uint64_t key[2], const uint64_t *data, size_t words)
+{
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key[0];
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key[1];
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key[0];
+    uint64_t v3 = 0x7465646279746573ULL ^ key[1];
+    uint64_t b = (uint64_t)(words * sizeof(uint64_t)) << 56;
+
+    for (size_t i = 0; i < words; ++i) {
+        v3 ^= data[i];
+        SIPROUND(v0, v1, v2, v3);
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= data[i];
+    }
+    v3 ^= b;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= b;
+    v2 ^= 0xff;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+struct syncookie_secret {
+    uint64_t key[2];
+
+    syncookie_secret()
+    {
+        std::random_device rd;
+        key[0] = ((uint64_t)rd() << 32) | rd();
+        key[1] = ((uint64_t)rd() << 32) | rd();
+    }
+};
+
+static const syncookie_secret &get_secret()
+{
+    static const syncookie_secret secret;
+    return secret;
+}
+
+uint32_t syncookie::hash(const sock_addr &src, const sock_addr &dst, uint32_t count, uint8_t c)
+{
+    const syncookie_secret &secret = get_secret();
+    uint64_t data[5];
+
+    memcpy(&data[0], &src.get_ip_addr().get_in6_addr(), sizeof(in6_addr));
+    memcpy(&data[2], &dst.get_ip_addr().get_in6_addr(), sizeof(in6_addr));
+    data[4] = ((uint64_t)src.get_in_port() << 48) | ((uint64_t)dst.get_in_port() << 32) |
+        ((uint64_t)(count & 0xFFFFFFU) << 8) | c;
+
+    return (uint32_t)siphash24(secret.key, data, sizeof(data) / sizeof(data[0]));
+}
+
+uint32_t syncookie::make_isn(const sock_addr &src, const sock_addr &dst, uint32_t peer_isn,
+                             uint16_t &mss, uint32_t now)
+{
+    uint32_t count = now >> SYNCOOKIE_COUNT_SHIFT;
+    uint32_t idx;
+
+    for (idx = sizeof(s_syncookie_mss) / sizeof(s_syncookie_mss[0]) - 1; idx > 0; --idx) {
+        if (mss >= s_syncookie_mss[idx]) {
+            break;
+        }
+    }
+    mss = s_syncookie_mss[idx];
+
+    return hash(src, dst, 0, 0) + peer_isn + (count << SYNCOOKIE_SEQ_BITS) +
+        ((hash(src, dst, count, 1) + idx) & SYNCOOKIE_SEQ_MASK);
+}
+
+bool syncookie::check_isn(const sock_addr &src, const sock_addr &dst, uint32_t peer_isn,
+                          uint32_t cookie, uint32_t now, uint16_t &mss)
+{
+    uint32_t count = now >> SYNCOOKIE_COUNT_SHIFT;
+    uint32_t diff;
+    uint32_t idx;
+
+    cookie -= hash(src, dst, 0, 0) + peer_isn;
+
+    /* Cookie is now reduced to (count << 24) + (hash + idx) */
+    diff = (count - (cookie >> SYNCOOKIE_SEQ_BITS)) & (0xFFFFFFFFU >> SYNCOOKIE_SEQ_BITS);
+    if (diff >= SYNCOOKIE_MAX_AGE) {
+        return false;
+    }
+
+    idx = (cookie - hash(src, dst, count - diff, 1)) & SYNCOOKIE_SEQ_MASK;
+    if (idx >= sizeof(s_syncookie_mss) / sizeof(s_syncookie_mss[0])) {
+        return false;
+    }
+    mss = s_syncookie_mss[idx];
+
+    return true;
+}
+
+bool syncookie::is_recent(uint32_t sent, uint32_t now)
+{
+    return (now >> SYNCOOKIE_COUNT_SHIFT) - (sent >> SYNCOOKIE_COUNT_SHIFT) < SYNCOOKIE_MAX_AGE;
+}
+
+uint32_t syncookie::make_tsval(uint32_t now, const options &opts)
+{
+    uint32_t tsval = (now & ~SYNCOOKIE_TS_OPT_MASK) | (opts.wscale & SYNCOOKIE_TS_WSCALE) |
+        (opts.sack ? SYNCOOKIE_TS_SACK : 0U);
+
+    /* Keep the clock monotonic for the connection which adopts it */
+    if (tsval > now) {
+        tsval -= (1U << SYNCOOKIE_TS_OPT_BITS);
+    }
+    return tsval;
+}
+
+void syncookie::decode_tsecr(uint32_t tsecr, uint8_t &wscale, bool &sack)
+{
+    wscale = tsecr & SYNCOOKIE_TS_WSCALE;
+    sack = !!(tsecr & SYNCOOKIE_TS_SACK);
+}
+
+void syncookie::make_fastopen_cookie(const sock_addr &src, const sock_addr &dst,
+                                     struct tcp_fastopen &cookie)
+{
+    uint64_t data[4];
+    uint64_t mac;
+
+    /* Ports and time aren't a part of the cookie, it is valid for any connection of the client */
+    memcpy(&data[0], &src.get_ip_addr().get_in6_addr(), sizeof(in6_addr));
+    memcpy(&data[2], &dst.get_ip_addr().get_in6_addr(), sizeof(in6_addr));
+    mac = siphash24(get_secret().key, data, sizeof(data) / sizeof(data[0]));
+
+    static_assert(sizeof(mac) == FASTOPEN_COOKIE_LEN, "Fast Open cookie is a 64-bit MAC");
+    cookie.len = FASTOPEN_COOKIE_LEN;
+    memcpy(cookie.cookie, &mac, sizeof(mac));
+}
+
+bool syncookie::check_fastopen_cookie(const sock_addr &src, const sock_addr &dst,
+                                      const struct tcp_fastopen &cookie)
+{
+    struct tcp_fastopen expected;
+
+    if (cookie.len != FASTOPEN_COOKIE_LEN) {
+        return false;
+    }
+    make_fastopen_cookie(src, dst, expected);
+    return memcmp(cookie.cookie, expected.cookie, FASTOPEN_COOKIE_LEN) == 0;
+}
+
+void syncookie::parse_options(const struct tcphdr *p_tcp_h, options &opts)
+{
+    const uint8_t *p_opt = reinterpret_cast<const uint8_t *>(p_tcp_h + 1);
+    size_t len = p_tcp_h->doff * 4U - sizeof(*p_tcp_h);
+    size_t i = 0;
+
+    memset(&opts, 0, sizeof(opts));
+    opts.wscale = TCP_SYNCOOKIE_NO_WSCALE;
+
+    while (i < len) {
+        uint8_t kind = p_opt[i];
+        uint8_t opt_len;
+
+        if (kind == TCPOPT_EOL) {
+            break;
+        }
+        if (kind == TCPOPT_NOP) {
+            ++i;
+            continue;
+        }
+        if (i + 1 >= len || (opt_len = p_opt[i + 1]) < 2 || i + opt_len > len) {
+            break;
+        }
+        switch (kind) {
+        case TCPOPT_MAXSEG:
+            if (opt_len == TCPOLEN_MAXSEG) {
+                opts.mss = (p_opt[i + 2] << 8) | p_opt[i + 3];
+            }
+            break;
+        case TCPOPT_WINDOW:
+            if (opt_len == TCPOLEN_WINDOW) {
+                opts.wscale = std::min<uint8_t>(p_opt[i + 2], 14U);
+            }
+            break;
+        case TCPOPT_SACK_PERMITTED:
+            opts.sack = (opt_len == TCPOLEN_SACK_PERMITTED);
+            break;
+        case TCPOPT_TIMESTAMP:
+            if (opt_len == TCPOLEN_TIMESTAMP) {
+                opts.ts = true;
+                memcpy(&opts.tsval, &p_opt[i + 2], sizeof(opts.tsval));
+                memcpy(&opts.tsecr, &p_opt[i + 6], sizeof(opts.tsecr));
+                opts.tsval = ntohl(opts.tsval);
+                opts.tsecr = ntohl(opts.tsecr);
+            }
+            break;
+        case TCPOPT_FASTOPEN:
+            /* An empty option requests a cookie */
+            opts.fastopen = true;
+            if (opt_len - 2U <= TCP_FASTOPEN_COOKIE_MAX) {
+                opts.fastopen_cookie.len = opt_len - 2U;
+                memcpy(opts.fastopen_cookie.cookie, &p_opt[i + 2], opts.fastopen_cookie.len);
+            }
+            break;
+        default:
+            break;
+        }
+        i += opt_len;
+    }
+}
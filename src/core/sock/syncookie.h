@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SYNCOOKIE_H
+#define SYNCOOKIE_H
+
+#include <stdint.h>
+#include <netinet/tcp.h>
+
+#include "lwip/tcp.h"
+#include "util/sock_addr.h"
+
+/**
+ * Stateless SYN cookies for offloaded listen sockets (RFC 4987).
+ *
+ * The cookie is the ISN of the SYN-ACK. It carries a coarse time counter and
+ * the MSS of the peer and is authenticated by a keyed hash of the 4-tuple:
+ *
+ *   cookie = H0(tuple) + peer_isn + (count << 24) + ((H1(tuple, count) + mss_idx) & 0xFFFFFF)
+ *
+ * Window scale and SACK permitted do not fit the cookie. They are kept in the
+ * low bits of the TSval of the SYN-ACK and recovered from the TSecr of the ACK,
+ * so they are negotiated only if the peer uses timestamps.
+ *
+ * The same key authenticates TCP Fast Open cookies (RFC 7413), which are a
+ * keyed hash of the client and server addresses.
+ */
+class syncookie {
+public:
+    /* TCP options of a SYN or of the ACK which completes the handshake */
+    struct options {
+        uint16_t mss; /* 0 if not present */
+        uint8_t wscale; /* TCP_SYNCOOKIE_NO_WSCALE if not present */
+        bool sack;
+        bool ts;
+        uint32_t tsval;
+        uint32_t tsecr;
+        bool fastopen; /* Fast Open option is present */
+        struct tcp_fastopen fastopen_cookie;
+    };
+
+    static void parse_options(const struct tcphdr *p_tcp_h, options &opts);
+
+    /* Returns the ISN for the SYN-ACK. The mss is rounded down to an encodable value. */
+    static uint32_t make_isn(const sock_addr &src, const sock_addr &dst, uint32_t peer_isn,
+                             uint16_t &mss, uint32_t now);
+    /* Validates the ISN acknowledged by the ACK and returns the MSS encoded in it. */
+    static bool check_isn(const sock_addr &src, const sock_addr &dst, uint32_t peer_isn,
+                          uint32_t cookie, uint32_t now, uint16_t &mss);
+    /* Whether a cookie made at time sent may still be valid at time now. */
+    static bool is_recent(uint32_t sent, uint32_t now);
+
+    /* Encodes wscale and sack of opts into a TSval not later than now. */
+    static uint32_t make_tsval(uint32_t now, const options &opts);
+    static void decode_tsecr(uint32_t tsecr, uint8_t &wscale, bool &sack);
+
+    /* Fast Open cookie of the client src for the server dst */
+    static void make_fastopen_cookie(const sock_addr &src, const sock_addr &dst,
+                                     struct tcp_fastopen &cookie);
+    static bool check_fastopen_cookie(const sock_addr &src, const sock_addr &dst,
+                                      const struct tcp_fastopen &cookie);
+
+private:
+    static uint32_t hash(const sock_addr &src, const sock_addr &dst, uint32_t count, uint8_t c);
+};
+
+#endif /* SYNCOOKIE_H */
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef FLOW_HASH_MAP_H_
+#define FLOW_HASH_MAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "core/util/vtypes.h"
+
+#define FLOW_HASH_MAP_INIT_SIZE 16U // Initial number of slots, must be a power of two.
+
+/*
+ * Open addressing hash table for the RX steering fallback path.
+ *
+ * Keys are stored inline next to the value, so a lookup that hits its home
+ * slot costs a single cache miss instead of a bucket and a node dereference
+ * as with std::unordered_map. Collisions are resolved by linear probing and
+ * removal uses backward shift, so there are no tombstones and probe sequences
+ * stay short under churn. The load factor is kept at or below 1/2.
+ *
+ * V must be a pointer type: NULL marks an empty slot.
+ * K must provide hash() and operator==.
+ */
+template <typename K, typename V> class flow_hash_map {
+public:
+    flow_hash_map()
+        : m_slots(FLOW_HASH_MAP_INIT_SIZE)
+        , m_mask(FLOW_HASH_MAP_INIT_SIZE - 1)
+        , m_size(0)
+    {
+    }
+
+    inline V find(const K &key) const
+    {
+        size_t idx = home(key);
+
+        while (m_slots[idx].value) {
+            if (likely(m_slots[idx].key == key)) {
+                return m_slots[idx].value;
+            }
+            idx = (idx + 1) & m_mask;
+        }
+        return NULL;
+    }
+
+    // Insert or replace the value for the key.
+    void set(const K &key, V value)
+    {
+        if (unlikely((m_size + 1) * 2 > m_slots.size())) {
+            rehash(m_slots.size() * 2);
+        }
+        size_t idx = home(key);
+
+        while (m_slots[idx].value) {
+            if (m_slots[idx].key == key) {
+                m_slots[idx].value = value;
+                return;
+            }
+            idx = (idx + 1) & m_mask;
+        }
+        m_slots[idx].key = key;
+        m_slots[idx].value = value;
+        ++m_size;
+    }
+
+    bool erase(const K &key)
+    {
+        size_t idx = home(key);
+
+        while (m_slots[idx].value) {
+            if (m_slots[idx].key == key) {
+                shift_back(idx);
+                --m_size;
+                return true;
+            }
+            idx = (idx + 1) & m_mask;
+        }
+        return false;
+    }
+
+    template <typename F> void for_each(F func)
+    {
+        for (auto &slot : m_slots) {
+            if (slot.value) {
+                func(slot.key, slot.value);
+            }
+        }
+    }
+
+    void clear()
+    {
+        std::vector<slot_t>(FLOW_HASH_MAP_INIT_SIZE).swap(m_slots);
+        m_mask = FLOW_HASH_MAP_INIT_SIZE - 1;
+        m_size = 0;
+    }
+
+    size_t size() const { return m_size; }
+
+private:
+    struct slot_t {
+        K key;
+        V value = NULL;
+    };
+
+    /* The key hash() methods are not avalanching (e.g. std::hash<size_t> is identity),
+     * and the low bits used for the slot index would be mostly constant for flows of
+     * one local address. Mix them with the 64-bit murmur3 finalizer.
+     */
+    inline size_t home(const K &key) const
+    {
+        uint64_t h = static_cast<uint64_t>(key.hash());
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h) & m_mask;
+    }
+
+    // Remove the entry at idx and pull the following entries of the cluster back.
+    void shift_back(size_t idx)
+    {
+        size_t next = idx;
+
+        while (true) {
+            next = (next + 1) & m_mask;
+            if (!m_slots[next].value) {
+                break;
+            }
+            size_t h = home(m_slots[next].key);
+            // Keep the entry in place if its home is cyclically within (idx, next]
+            if ((idx <= next) ? (idx < h && h <= next) : (idx < h || h <= next)) {
+                continue;
+            }
+            m_slots[idx] = m_slots[next];
+            idx = next;
+        }
+        m_slots[idx].value = NULL;
+    }
+
+    void rehash(size_t new_size)
+    {
+        std::vector<slot_t> old_slots(new_size);
+
+        old_slots.swap(m_slots);
+        m_mask = new_size - 1;
+        for (auto &slot : old_slots) {
+            if (slot.value) {
+                size_t idx = home(slot.key);
+                while (m_slots[idx].value) {
+                    idx = (idx + 1) & m_mask;
+                }
+                m_slots[idx] = slot;
+            }
+        }
+    }
+
+    std::vector<slot_t> m_slots;
+    size_t m_mask;
+    size_t m_size;
+};
+
+#endif /* FLOW_HASH_MAP_H_ */
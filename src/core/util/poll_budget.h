@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef POLL_BUDGET_H
+#define POLL_BUDGET_H
+
+#include <stdint.h>
+#include <algorithm>
+
+#include "utils/types.h"
+
+#define POLL_BUDGET_EWMA_SHIFT 3
+#define POLL_BUDGET_RATE_ONE   1024
+
+/*
+ * Adaptive busy-poll budget.
+ * Replaces a fixed number of polling loops (or usec) before the caller arms
+ * the CQ and blocks. Keeps an average of how far into the spin events were
+ * found and the share of spins which ended with an event:
+ * - an event found in the second half of the spin doubles the budget, so the
+ *   next event with a similar gap is still caught by polling;
+ * - a spin which ends without an event shrinks the budget. While most spins
+ *   hit, it is trimmed slowly and never below twice the average gap. When most
+ *   spins miss, it is halved towards the lower bound.
+ * The state is kept per thread and has no constructor so it can be __thread.
+ * A zero budget means the state is not initialized yet, the lower bound must
+ * be at least 1.
+ */
+struct poll_budget {
+    int32_t budget;
+    int32_t gap_avg;
+    int32_t hit_rate; // POLL_BUDGET_RATE_ONE == all spins hit
+
+    inline int32_t get(int32_t max)
+    {
+        if (unlikely(budget == 0)) {
+            budget = max;
+            gap_avg = 0;
+            hit_rate = POLL_BUDGET_RATE_ONE;
+        }
+        return budget;
+    }
+
+    // An event was found after 'spent' units of the spin
+    inline void hit(int32_t spent, int32_t min, int32_t max)
+    {
+        gap_avg += (spent - gap_avg) / (1 << POLL_BUDGET_EWMA_SHIFT);
+        hit_rate += (POLL_BUDGET_RATE_ONE - hit_rate) >> POLL_BUDGET_EWMA_SHIFT;
+        if (spent >= budget / 2) {
+            budget = (int32_t)std::min<int64_t>(max, std::max<int64_t>(min, 2LL * budget));
+        }
+    }
+
+    // The whole budget was spent without an event
+    inline void miss(int32_t min)
+    {
+        int32_t target;
+
+        hit_rate -= hit_rate >> POLL_BUDGET_EWMA_SHIFT;
+        if (hit_rate < POLL_BUDGET_RATE_ONE / 2) {
+            target = budget / 2;
+        } else {
+            target = std::min(budget, std::max(budget - budget / 8, 2 * gap_avg));
+        }
+        budget = std::max(min, target);
+    }
+};
+
+#endif /* POLL_BUDGET_H */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RCVBUF_AUTOTUNE_H
+#define RCVBUF_AUTOTUNE_H
+
+#include <stdint.h>
+#include <algorithm>
+
+#include "utils/rdtsc.h"
+
+/*
+ * RCVBUF auto-tuning (dynamic right-sizing). The receiver RTT is estimated as the
+ * minimum time to receive a window of data, which is an upper bound of the RTT.
+ * Once per RTT the buffer grows to twice the data the application consumed, so a
+ * flow is not limited by the window. A connection which was idle starts over
+ * from the default buffer size.
+ * The caller owns the buffer size and serializes the calls.
+ */
+struct rcvbuf_autotune {
+    int space; /* the most data consumed by the application within an RTT */
+    int space_copied; /* data consumed within the current RTT */
+    tscval_t space_tsc; /* start of the current RTT */
+    tscval_t rtt_est; /* receiver side RTT estimation */
+    tscval_t rtt_tsc; /* start of the current RTT measurement */
+    uint32_t rtt_seq; /* the measurement ends when rcv_nxt reaches it */
+    tscval_t last_tsc; /* last time data was received */
+
+    rcvbuf_autotune()
+        : rtt_est(0)
+        , last_tsc(0)
+    {
+        reset();
+    }
+
+    // Start over, the RTT estimation is kept
+    inline void reset()
+    {
+        space = 0;
+        space_copied = 0;
+        space_tsc = 0;
+        rtt_tsc = 0;
+        rtt_seq = 0;
+    }
+
+    // Data was received at 'now', rcv_nxt and rcv_wnd are taken after it.
+    // Returns true if the connection was idle for longer than 'idle', the
+    // buffer should shrink back to the default then.
+    inline bool rx(tscval_t now, tscval_t idle, uint32_t rcv_nxt, uint32_t rcv_wnd)
+    {
+        bool was_idle = last_tsc && now - last_tsc > idle;
+
+        if (was_idle) {
+            reset();
+        }
+        last_tsc = now;
+
+        if (!rtt_tsc || (int32_t)(rcv_nxt - rtt_seq) >= 0) {
+            if (rtt_tsc && (!rtt_est || now - rtt_tsc < rtt_est)) {
+                rtt_est = now - rtt_tsc;
+            }
+            rtt_seq = rcv_nxt + rcv_wnd;
+            rtt_tsc = now;
+        }
+        return was_idle;
+    }
+
+    // The application consumed 'copied' bytes at 'now'. Returns the buffer size
+    // the connection needs, up to 'max', once per RTT in which the consumed data
+    // exceeded the previous maximum, and 0 otherwise.
+    inline int read(int copied, tscval_t now, int mss, int max)
+    {
+        int rcvbuf = 0;
+
+        space_copied += copied;
+        if (!rtt_est) {
+            return 0;
+        }
+        if (!space_tsc) {
+            space_tsc = now;
+            space_copied = copied;
+            return 0;
+        }
+        if (now - space_tsc < rtt_est) {
+            return 0;
+        }
+
+        if (space_copied > space) {
+            space = space_copied;
+            // Room for the sender to grow its window for another RTT.
+            rcvbuf = std::min(2 * space + 16 * mss, max);
+        }
+        space_copied = 0;
+        space_tsc = now;
+        return rcvbuf;
+    }
+};
+
+#endif /* RCVBUF_AUTOTUNE_H */
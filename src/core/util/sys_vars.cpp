@@ -657,7 +657,13 @@ void mce_sys_var::get_env_params()
     ring_migration_ratio_tx = MCE_DEFAULT_RING_MIGRATION_RATIO_TX;
     ring_migration_ratio_rx = MCE_DEFAULT_RING_MIGRATION_RATIO_RX;
     ring_limit_per_interface = MCE_DEFAULT_RING_LIMIT_PER_INTERFACE;
+    ring_tx_combining = MCE_DEFAULT_RING_TX_COMBINING;
+    ring_tx_db_coalesce = MCE_DEFAULT_RING_TX_DB_COALESCE;
     ring_dev_mem_tx = MCE_DEFAULT_RING_DEV_MEM_TX;
+    ring_loopback = MCE_DEFAULT_RING_LOOPBACK;
+    ring_loopback_latency_usec = MCE_DEFAULT_RING_LOOPBACK_LATENCY;
+    ring_loopback_drop_rate = MCE_DEFAULT_RING_LOOPBACK_DROP_RATE;
+    ring_xdp = MCE_DEFAULT_RING_XDP;
 
     tcp_max_syn_rate = MCE_DEFAULT_TCP_MAX_SYN_RATE;
 
@@ -676,14 +682,19 @@ void mce_sys_var::get_env_params()
     tx_bufs_batch_udp = MCE_DEFAULT_TX_BUFS_BATCH_UDP;
     tx_bufs_batch_tcp = MCE_DEFAULT_TX_BUFS_BATCH_TCP;
     tx_segs_batch_tcp = MCE_DEFAULT_TX_SEGS_BATCH_TCP;
+    tx_mpw = MCE_DEFAULT_TX_MPW;
+    buffer_pool_cache_size = MCE_DEFAULT_BUFFER_POOL_CACHE_SIZE;
 
     rx_num_bufs = MCE_DEFAULT_RX_NUM_BUFS;
     rx_buf_size = MCE_DEFAULT_RX_BUF_SIZE;
     rx_bufs_batch = MCE_DEFAULT_RX_BUFS_BATCH;
     rx_num_wr = MCE_DEFAULT_RX_NUM_WRE;
+    rx_srq_num_wr = MCE_DEFAULT_RX_SRQ_NUM_WRE;
     rx_num_wr_to_post_recv = MCE_DEFAULT_RX_NUM_WRE_TO_POST_RECV;
     rx_poll_num = MCE_DEFAULT_RX_NUM_POLLS;
     rx_poll_num_init = MCE_DEFAULT_RX_NUM_POLLS_INIT;
+    rx_poll_num_min = MCE_DEFAULT_RX_NUM_POLLS_MIN;
+    poll_adaptive = MCE_DEFAULT_POLL_ADAPTIVE;
     rx_udp_poll_os_ratio = MCE_DEFAULT_RX_UDP_POLL_OS_RATIO;
     hw_ts_conversion_mode = MCE_DEFAULT_HW_TS_CONVERSION_MODE;
     rx_poll_yield_loops = MCE_DEFAULT_RX_POLL_YIELD;
@@ -709,6 +720,7 @@ void mce_sys_var::get_env_params()
     mc_force_flowtag = MCE_DEFAULT_MC_FORCE_FLOWTAG;
 
     select_poll_num = MCE_DEFAULT_SELECT_NUM_POLLS;
+    select_poll_num_min = MCE_DEFAULT_SELECT_NUM_POLLS_MIN;
     select_poll_os_force = MCE_DEFAULT_SELECT_POLL_OS_FORCE;
     select_poll_os_ratio = MCE_DEFAULT_SELECT_POLL_OS_RATIO;
     select_skip_os_fd_check = MCE_DEFAULT_SELECT_SKIP_OS;
@@ -725,6 +737,8 @@ void mce_sys_var::get_env_params()
     progress_engine_interval_msec = MCE_DEFAULT_PROGRESS_ENGINE_INTERVAL_MSEC;
     progress_engine_wce_max = MCE_DEFAULT_PROGRESS_ENGINE_WCE_MAX;
     cq_keep_qp_full = MCE_DEFAULT_CQ_KEEP_QP_FULL;
+    cq_rx_batch_prefetch = MCE_DEFAULT_CQ_RX_BATCH_PREFETCH;
+    rx_cqe_compression = MCE_DEFAULT_RX_CQE_COMPRESSION;
     qp_compensation_level = MCE_DEFAULT_QP_COMPENSATION_LEVEL;
     user_huge_page_size = MCE_DEFAULT_USER_HUGE_PAGE_SIZE;
     internal_thread_arm_cq_enabled = MCE_DEFAULT_INTERNAL_THREAD_ARM_CQ_ENABLED;
@@ -734,10 +748,16 @@ void mce_sys_var::get_env_params()
     tcp_timer_resolution_msec = MCE_DEFAULT_TCP_TIMER_RESOLUTION_MSEC;
     internal_thread_tcp_timer_handling = MCE_DEFAULT_INTERNAL_THREAD_TCP_TIMER_HANDLING;
     tcp_ctl_thread = MCE_DEFAULT_TCP_CTL_THREAD;
+    tcp_syncookies = MCE_DEFAULT_TCP_SYNCOOKIES;
+    tcp_fastopen = MCE_DEFAULT_TCP_FASTOPEN;
+    tcp_ecn = MCE_DEFAULT_TCP_ECN;
     tcp_ts_opt = MCE_DEFAULT_TCP_TIMESTAMP_OPTION;
     tcp_nodelay = MCE_DEFAULT_TCP_NODELAY;
     tcp_quickack = MCE_DEFAULT_TCP_QUICKACK;
     tcp_push_flag = MCE_DEFAULT_TCP_PUSH_FLAG;
+    tcp_sack = MCE_DEFAULT_TCP_SACK;
+    tcp_rack_tlp = MCE_DEFAULT_TCP_RACK_TLP;
+    tcp_sw_pacing = MCE_DEFAULT_TCP_SW_PACING;
     //	exception_handling is handled by its CTOR
     avoid_sys_calls_on_tcp_fd = MCE_DEFAULT_AVOID_SYS_CALLS_ON_TCP_FD;
     allow_privileged_sock_opt = MCE_DEFAULT_ALLOW_PRIVILEGED_SOCK_OPT;
@@ -779,6 +799,7 @@ void mce_sys_var::get_env_params()
     rx_cq_wait_ctrl = MCE_DEFAULT_RX_CQ_WAIT_CTRL;
     trigger_dummy_send_getsockname = MCE_DEFAULT_TRIGGER_DUMMY_SEND_GETSOCKNAME;
     tcp_send_buffer_size = MCE_DEFAULT_TCP_SEND_BUFFER_SIZE;
+    tcp_rcvbuf_autotune_max = MCE_DEFAULT_TCP_RCVBUF_AUTOTUNE_MAX;
     skip_poll_in_rx = MCE_DEFAULT_SKIP_POLL_IN_RX;
 #ifdef XLIO_TIME_MEASURE
     xlio_time_measure_num_samples = MCE_DEFAULT_TIME_MEASURE_NUM_SAMPLES;
@@ -792,6 +813,26 @@ void mce_sys_var::get_env_params()
     }
 #endif
 
+    if ((env_ptr = getenv(SYS_VAR_RING_LOOPBACK)) != NULL) {
+        ring_loopback = atoi(env_ptr) ? true : false;
+    }
+#if defined(DEFINED_XDP)
+    if ((env_ptr = getenv(SYS_VAR_RING_XDP)) != NULL) {
+        ring_xdp = atoi(env_ptr) ? true : false;
+    }
+#endif
+    if ((env_ptr = getenv(SYS_VAR_RX_SRQ_NUM_WRE)) != NULL) {
+        rx_srq_num_wr = (uint32_t)atoi(env_ptr);
+    }
+    if (ring_loopback || ring_xdp) {
+        // Software rings receive packets into regular RX buffers
+        enable_strq_env = option_strq::OFF;
+    }
+    if (rx_srq_num_wr) {
+        // Shared receive queue replaces the legacy RQ of the rings
+        enable_strq_env = option_strq::OFF;
+    }
+
     enable_striding_rq =
         (enable_strq_env == option_strq::ON || enable_strq_env == option_strq::AUTO);
     enable_dpcp_rq = (enable_striding_rq || (enable_strq_env == option_strq::REGULAR_RQ));
@@ -1219,6 +1260,14 @@ void mce_sys_var::get_env_params()
         }
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TX_MPW)) != NULL) {
+        tx_mpw = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_BUFFER_POOL_CACHE_SIZE)) != NULL) {
+        buffer_pool_cache_size = (uint32_t)atoi(env_ptr);
+    }
+
     if ((env_ptr = getenv(SYS_VAR_RING_ALLOCATION_LOGIC_TX)) != NULL) {
         ring_allocation_logic_tx = (ring_logic_t)atoi(env_ptr);
         if (!is_ring_logic_valid(ring_allocation_logic_tx)) {
@@ -1251,10 +1300,26 @@ void mce_sys_var::get_env_params()
         ring_limit_per_interface = std::max(0, atoi(env_ptr));
     }
 
+    if ((env_ptr = getenv(SYS_VAR_RING_TX_COMBINING)) != NULL) {
+        ring_tx_combining = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_RING_TX_DB_COALESCE)) != NULL) {
+        ring_tx_db_coalesce = atoi(env_ptr) ? true : false;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_RING_DEV_MEM_TX)) != NULL) {
         ring_dev_mem_tx = std::max(0, atoi(env_ptr));
     }
 
+    if ((env_ptr = getenv(SYS_VAR_RING_LOOPBACK_LATENCY)) != NULL) {
+        ring_loopback_latency_usec = (uint32_t)atoi(env_ptr);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_RING_LOOPBACK_DROP_RATE)) != NULL) {
+        ring_loopback_drop_rate = std::min(1000000U, (uint32_t)atoi(env_ptr));
+    }
+
     if ((env_ptr = getenv(SYS_VAR_TCP_MAX_SYN_RATE)) != NULL) {
         tcp_max_syn_rate = std::min(TCP_MAX_SYN_RATE_TOP_LIMIT, std::max(0, atoi(env_ptr)));
     }
@@ -1309,6 +1374,22 @@ void mce_sys_var::get_env_params()
         rx_poll_num = 1; // Force at least one good polling loop
     }
 
+    if ((env_ptr = getenv(SYS_VAR_POLL_ADAPTIVE)) != NULL) {
+        poll_adaptive = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_RX_NUM_POLLS_MIN)) != NULL) {
+        rx_poll_num_min = atoi(env_ptr);
+    }
+    if (rx_poll_num_min < 1 || rx_poll_num_min > MCE_MAX_RX_NUM_POLLS) {
+        vlog_printf(VLOG_WARNING, " Rx Poll min loops should be between %d and %d [%d]\n", 1,
+                    MCE_MAX_RX_NUM_POLLS, rx_poll_num_min);
+        rx_poll_num_min = MCE_DEFAULT_RX_NUM_POLLS_MIN;
+    }
+    if (rx_poll_num > 0 && rx_poll_num_min > rx_poll_num) {
+        rx_poll_num_min = rx_poll_num;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_RX_UDP_POLL_OS_RATIO)) != NULL) {
         rx_udp_poll_os_ratio = (uint32_t)atoi(env_ptr);
     }
@@ -1421,6 +1502,18 @@ void mce_sys_var::get_env_params()
         select_poll_num = MCE_DEFAULT_SELECT_NUM_POLLS;
     }
 
+    if ((env_ptr = getenv(SYS_VAR_SELECT_NUM_POLLS_MIN)) != NULL) {
+        select_poll_num_min = atoi(env_ptr);
+    }
+    if (select_poll_num_min < 1 || select_poll_num_min > MCE_MAX_RX_NUM_POLLS) {
+        vlog_printf(VLOG_WARNING, " Select Poll min usec should be between %d and %d [%d]\n", 1,
+                    MCE_MAX_RX_NUM_POLLS, select_poll_num_min);
+        select_poll_num_min = MCE_DEFAULT_SELECT_NUM_POLLS_MIN;
+    }
+    if (select_poll_num > 0 && select_poll_num_min > select_poll_num) {
+        select_poll_num_min = select_poll_num;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_SELECT_POLL_OS_FORCE)) != NULL) {
         select_poll_os_force = (uint32_t)atoi(env_ptr);
     }
@@ -1535,6 +1628,14 @@ void mce_sys_var::get_env_params()
         cq_keep_qp_full = atoi(env_ptr) ? true : false;
     }
 
+    if ((env_ptr = getenv(SYS_VAR_CQ_RX_BATCH_PREFETCH)) != NULL) {
+        cq_rx_batch_prefetch = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_RX_CQE_COMPRESSION)) != NULL) {
+        rx_cqe_compression = atoi(env_ptr) ? true : false;
+    }
+
     if ((env_ptr = getenv(SYS_VAR_QP_COMPENSATION_LEVEL)) != NULL) {
         qp_compensation_level = (uint32_t)atoi(env_ptr);
     }
@@ -1574,6 +1675,23 @@ void mce_sys_var::get_env_params()
         }
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TCP_SYNCOOKIES)) != NULL) {
+        tcp_syncookies = (uint32_t)atoi(env_ptr);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TCP_FASTOPEN)) != NULL) {
+        tcp_fastopen = (uint32_t)atoi(env_ptr) & (TFO_CLIENT_ENABLE | TFO_SERVER_ENABLE);
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TCP_ECN)) != NULL) {
+        tcp_ecn = (uint32_t)atoi(env_ptr);
+        if (tcp_ecn > 2) {
+            vlog_printf(VLOG_WARNING, "%s = %u is not valid, setting to default = %d\n",
+                        SYS_VAR_TCP_ECN, tcp_ecn, MCE_DEFAULT_TCP_ECN);
+            tcp_ecn = MCE_DEFAULT_TCP_ECN;
+        }
+    }
+
     if ((env_ptr = getenv(SYS_VAR_TCP_TIMESTAMP_OPTION)) != NULL) {
         tcp_ts_opt = (tcp_ts_opt_t)atoi(env_ptr);
         if ((uint32_t)tcp_ts_opt >= TCP_TS_OPTION_LAST) {
@@ -1598,6 +1716,18 @@ void mce_sys_var::get_env_params()
         tcp_push_flag = atoi(env_ptr) ? true : false;
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TCP_SACK)) != NULL) {
+        tcp_sack = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TCP_RACK_TLP)) != NULL) {
+        tcp_rack_tlp = atoi(env_ptr) ? true : false;
+    }
+
+    if ((env_ptr = getenv(SYS_VAR_TCP_SW_PACING)) != NULL) {
+        tcp_sw_pacing = atoi(env_ptr) ? true : false;
+    }
+
     // TODO: this should be replaced by calling "exception_handling.init()" that will be called from
     // init()
     if ((env_ptr = getenv(xlio_exception_handling::getSysVar())) != NULL) {
@@ -1821,6 +1951,10 @@ void mce_sys_var::get_env_params()
         tcp_send_buffer_size = (uint32_t)atoi(env_ptr);
     }
 
+    if ((env_ptr = getenv(SYS_VAR_TCP_RCVBUF_AUTOTUNE_MAX)) != NULL) {
+        tcp_rcvbuf_autotune_max = std::max(atoi(env_ptr), -1);
+    }
+
     if ((env_ptr = getenv(SYS_VAR_SKIP_POLL_IN_RX)) != NULL) {
         int temp = atoi(env_ptr);
         if (temp < 0 || temp > SKIP_POLL_IN_RX_EPOLL_ONLY) {
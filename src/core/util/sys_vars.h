@@ -121,6 +121,22 @@ static inline const char *ring_logic_str(ring_logic_t logic)
     return "unsupported";
 }
 
+/* Values of XLIO_TCP_ECN, as in net.ipv4.tcp_ecn */
+static inline const char *tcp_ecn_str(uint32_t mode)
+{
+    switch (mode) {
+    case 0:
+        return "(Disabled)";
+    case 1:
+        return "(Enabled)";
+    case 2:
+        return "(Passive)";
+    default:
+        break;
+    }
+    return "unsupported";
+}
+
 typedef enum {
     THREAD_MODE_SINGLE = 0,
     THREAD_MODE_MULTI,
@@ -192,6 +208,26 @@ static inline const char *ctl_thread_str(tcp_ctl_thread_t logic)
     return "unsupported";
 }
 
+/* Bits of XLIO_TCP_FASTOPEN, as in net.ipv4.tcp_fastopen */
+typedef enum { TFO_CLIENT_ENABLE = 0x1, TFO_SERVER_ENABLE = 0x2 } tcp_fastopen_t;
+
+static inline const char *tcp_fastopen_str(uint32_t mode)
+{
+    switch (mode) {
+    case 0:
+        return "(Disabled)";
+    case TFO_CLIENT_ENABLE:
+        return "(Client)";
+    case TFO_SERVER_ENABLE:
+        return "(Server)";
+    case TFO_CLIENT_ENABLE | TFO_SERVER_ENABLE:
+        return "(Client and server)";
+    default:
+        break;
+    }
+    return "unsupported";
+}
+
 typedef enum {
     INTERNAL_THREAD_TCP_TIMER_HANDLING_DEFERRED = 0,
     INTERNAL_THREAD_TCP_TIMER_HANDLING_IMMEDIATE
@@ -359,7 +395,13 @@ public:
     int ring_migration_ratio_tx;
     int ring_migration_ratio_rx;
     int ring_limit_per_interface;
+    bool ring_tx_combining;
+    bool ring_tx_db_coalesce;
     int ring_dev_mem_tx;
+    bool ring_loopback;
+    uint32_t ring_loopback_latency_usec;
+    uint32_t ring_loopback_drop_rate;
+    bool ring_xdp;
     int tcp_max_syn_rate;
 
     uint32_t zc_num_bufs;
@@ -377,14 +419,19 @@ public:
     uint32_t tx_bufs_batch_udp;
     uint32_t tx_bufs_batch_tcp;
     uint32_t tx_segs_batch_tcp;
+    bool tx_mpw;
+    uint32_t buffer_pool_cache_size;
 
     uint32_t rx_num_bufs;
     uint32_t rx_buf_size;
     uint32_t rx_bufs_batch;
     uint32_t rx_num_wr;
+    uint32_t rx_srq_num_wr;
     uint32_t rx_num_wr_to_post_recv;
     int32_t rx_poll_num;
     int32_t rx_poll_num_init;
+    int32_t rx_poll_num_min;
+    bool poll_adaptive;
     uint32_t rx_udp_poll_os_ratio;
     ts_conversion_mode_t hw_ts_conversion_mode;
     uint32_t rx_poll_yield_loops;
@@ -412,6 +459,7 @@ public:
     bool mc_force_flowtag;
 
     int32_t select_poll_num;
+    int32_t select_poll_num_min;
     bool select_poll_os_force;
     uint32_t select_poll_os_ratio;
     uint32_t select_skip_os_fd_check;
@@ -429,6 +477,8 @@ public:
     uint32_t progress_engine_interval_msec;
     uint32_t progress_engine_wce_max;
     bool cq_keep_qp_full;
+    bool cq_rx_batch_prefetch;
+    bool rx_cqe_compression;
     uint32_t qp_compensation_level;
     size_t user_huge_page_size;
 
@@ -436,10 +486,16 @@ public:
     uint32_t timer_resolution_msec;
     uint32_t tcp_timer_resolution_msec;
     tcp_ctl_thread_t tcp_ctl_thread;
+    uint32_t tcp_syncookies;
+    uint32_t tcp_fastopen;
+    uint32_t tcp_ecn;
     tcp_ts_opt_t tcp_ts_opt;
     bool tcp_nodelay;
     bool tcp_quickack;
     bool tcp_push_flag;
+    bool tcp_sack;
+    bool tcp_rack_tlp;
+    bool tcp_sw_pacing;
     xlio_exception_handling exception_handling;
     bool avoid_sys_calls_on_tcp_fd;
     bool allow_privileged_sock_opt;
@@ -496,6 +552,7 @@ public:
     int nginx_udp_socket_pool_rx_num_buffs_reuse;
 #endif
     uint32_t tcp_send_buffer_size;
+    int tcp_rcvbuf_autotune_max;
     FILE *stats_file;
     /* This field should be used to store and use data for XLIO_EXTRA_API_IOCTL */
     struct {
@@ -555,7 +612,13 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_RING_MIGRATION_RATIO_TX  "XLIO_RING_MIGRATION_RATIO_TX"
 #define SYS_VAR_RING_MIGRATION_RATIO_RX  "XLIO_RING_MIGRATION_RATIO_RX"
 #define SYS_VAR_RING_LIMIT_PER_INTERFACE "XLIO_RING_LIMIT_PER_INTERFACE"
+#define SYS_VAR_RING_TX_COMBINING        "XLIO_RING_TX_COMBINING"
+#define SYS_VAR_RING_TX_DB_COALESCE      "XLIO_RING_TX_DB_COALESCE"
 #define SYS_VAR_RING_DEV_MEM_TX          "XLIO_RING_DEV_MEM_TX"
+#define SYS_VAR_RING_LOOPBACK            "XLIO_RING_LOOPBACK"
+#define SYS_VAR_RING_LOOPBACK_LATENCY    "XLIO_RING_LOOPBACK_LATENCY"
+#define SYS_VAR_RING_LOOPBACK_DROP_RATE  "XLIO_RING_LOOPBACK_DROP_RATE"
+#define SYS_VAR_RING_XDP                 "XLIO_RING_XDP"
 
 #define SYS_VAR_ZC_NUM_BUFS           "XLIO_ZC_BUFS"
 #define SYS_VAR_ZC_CACHE_THRESHOLD    "XLIO_ZC_CACHE_THRESHOLD"
@@ -571,6 +634,8 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_TX_PREFETCH_BYTES     "XLIO_TX_PREFETCH_BYTES"
 #define SYS_VAR_TX_BUFS_BATCH_TCP     "XLIO_TX_BUFS_BATCH_TCP"
 #define SYS_VAR_TX_SEGS_BATCH_TCP     "XLIO_TX_SEGS_BATCH_TCP"
+#define SYS_VAR_TX_MPW                "XLIO_TX_MPW"
+#define SYS_VAR_BUFFER_POOL_CACHE_SIZE "XLIO_BUFFER_POOL_CACHE_SIZE"
 
 #define SYS_VAR_STRQ                            "XLIO_STRQ"
 #define SYS_VAR_STRQ_NUM_STRIDES                "XLIO_STRQ_NUM_STRIDES"
@@ -581,9 +646,12 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_RX_NUM_BUFS             "XLIO_RX_BUFS"
 #define SYS_VAR_RX_BUF_SIZE             "XLIO_RX_BUF_SIZE"
 #define SYS_VAR_RX_NUM_WRE              "XLIO_RX_WRE"
+#define SYS_VAR_RX_SRQ_NUM_WRE          "XLIO_RX_SRQ_WRE"
 #define SYS_VAR_RX_NUM_WRE_TO_POST_RECV "XLIO_RX_WRE_BATCHING"
 #define SYS_VAR_RX_NUM_POLLS            "XLIO_RX_POLL"
 #define SYS_VAR_RX_NUM_POLLS_INIT       "XLIO_RX_POLL_INIT"
+#define SYS_VAR_RX_NUM_POLLS_MIN        "XLIO_RX_POLL_MIN"
+#define SYS_VAR_POLL_ADAPTIVE           "XLIO_POLL_ADAPTIVE"
 #define SYS_VAR_RX_UDP_POLL_OS_RATIO    "XLIO_RX_UDP_POLL_OS_RATIO"
 #define SYS_VAR_HW_TS_CONVERSION_MODE   "XLIO_HW_TS_CONVERSION"
 // The following 2 params were replaced by XLIO_RX_UDP_POLL_OS_RATIO
@@ -603,6 +671,7 @@ extern mce_sys_var &safe_mce_sys();
 
 #define SYS_VAR_SELECT_CPU_USAGE_STATS "XLIO_CPU_USAGE_STATS"
 #define SYS_VAR_SELECT_NUM_POLLS       "XLIO_SELECT_POLL"
+#define SYS_VAR_SELECT_NUM_POLLS_MIN   "XLIO_SELECT_POLL_MIN"
 #define SYS_VAR_SELECT_POLL_OS_FORCE   "XLIO_SELECT_POLL_OS_FORCE"
 #define SYS_VAR_SELECT_POLL_OS_RATIO   "XLIO_SELECT_POLL_OS_RATIO"
 #define SYS_VAR_SELECT_SKIP_OS         "XLIO_SELECT_SKIP_OS"
@@ -619,16 +688,24 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_PROGRESS_ENGINE_INTERVAL  "XLIO_PROGRESS_ENGINE_INTERVAL"
 #define SYS_VAR_PROGRESS_ENGINE_WCE_MAX   "XLIO_PROGRESS_ENGINE_WCE_MAX"
 #define SYS_VAR_CQ_KEEP_QP_FULL           "XLIO_CQ_KEEP_QP_FULL"
+#define SYS_VAR_CQ_RX_BATCH_PREFETCH      "XLIO_CQ_RX_BATCH_PREFETCH"
+#define SYS_VAR_RX_CQE_COMPRESSION        "XLIO_RX_CQE_COMPRESSION"
 #define SYS_VAR_QP_COMPENSATION_LEVEL     "XLIO_QP_COMPENSATION_LEVEL"
 #define SYS_VAR_USER_HUGE_PAGE_SIZE       "XLIO_USER_HUGE_PAGE_SIZE"
 #define SYS_VAR_OFFLOADED_SOCKETS         "XLIO_OFFLOADED_SOCKETS"
 #define SYS_VAR_TIMER_RESOLUTION_MSEC     "XLIO_TIMER_RESOLUTION_MSEC"
 #define SYS_VAR_TCP_TIMER_RESOLUTION_MSEC "XLIO_TCP_TIMER_RESOLUTION_MSEC"
 #define SYS_VAR_TCP_CTL_THREAD            "XLIO_TCP_CTL_THREAD"
+#define SYS_VAR_TCP_SYNCOOKIES            "XLIO_TCP_SYNCOOKIES"
+#define SYS_VAR_TCP_FASTOPEN              "XLIO_TCP_FASTOPEN"
+#define SYS_VAR_TCP_ECN                   "XLIO_TCP_ECN"
 #define SYS_VAR_TCP_TIMESTAMP_OPTION      "XLIO_TCP_TIMESTAMP_OPTION"
 #define SYS_VAR_TCP_NODELAY               "XLIO_TCP_NODELAY"
 #define SYS_VAR_TCP_QUICKACK              "XLIO_TCP_QUICKACK"
 #define SYS_VAR_TCP_PUSH_FLAG             "XLIO_TCP_PUSH_FLAG"
+#define SYS_VAR_TCP_SACK                  "XLIO_TCP_SACK"
+#define SYS_VAR_TCP_RACK_TLP              "XLIO_TCP_RACK_TLP"
+#define SYS_VAR_TCP_SW_PACING             "XLIO_TCP_SW_PACING"
 #define SYS_VAR_AVOID_SYS_CALLS_ON_TCP_FD "XLIO_AVOID_SYS_CALLS_ON_TCP_FD"
 #define SYS_VAR_ALLOW_PRIVILEGED_SOCK_OPT "XLIO_ALLOW_PRIVILEGED_SOCK_OPT"
 #define SYS_VAR_WAIT_AFTER_JOIN_MSEC      "XLIO_WAIT_AFTER_JOIN_MSEC"
@@ -680,6 +757,7 @@ extern mce_sys_var &safe_mce_sys();
 #define SYS_VAR_RX_CQ_WAIT_CTRL                "XLIO_RX_CQ_WAIT_CTRL"
 #define SYS_VAR_TRIGGER_DUMMY_SEND_GETSOCKNAME "XLIO_TRIGGER_DUMMY_SEND_GETSOCKNAME"
 #define SYS_VAR_TCP_SEND_BUFFER_SIZE           "XLIO_TCP_SEND_BUFFER_SIZE"
+#define SYS_VAR_TCP_RCVBUF_AUTOTUNE_MAX        "XLIO_TCP_RCVBUF_AUTOTUNE_MAX"
 #define SYS_VAR_SKIP_POLL_IN_RX                "XLIO_SKIP_POLL_IN_RX"
 
 /*
@@ -687,6 +765,7 @@ extern mce_sys_var &safe_mce_sys();
  * configuration variables
  */
 #define MCE_DEFAULT_TCP_SEND_BUFFER_SIZE     (1000000)
+#define MCE_DEFAULT_TCP_RCVBUF_AUTOTUNE_MAX  (-1)
 #define MCE_DEFAULT_LOG_FILE                 ("")
 #define MCE_DEFAULT_CONF_FILE                ("/etc/libxlio.conf")
 #define MCE_DEFAULT_STATS_FILE               ("")
@@ -704,7 +783,13 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_RING_MIGRATION_RATIO_TX  (100)
 #define MCE_DEFAULT_RING_MIGRATION_RATIO_RX  (100)
 #define MCE_DEFAULT_RING_LIMIT_PER_INTERFACE (0)
+#define MCE_DEFAULT_RING_TX_COMBINING        (false)
+#define MCE_DEFAULT_RING_TX_DB_COALESCE      (false)
 #define MCE_DEFAULT_RING_DEV_MEM_TX          (0)
+#define MCE_DEFAULT_RING_LOOPBACK            (false)
+#define MCE_DEFAULT_RING_LOOPBACK_LATENCY    (0)
+#define MCE_DEFAULT_RING_LOOPBACK_DROP_RATE  (0)
+#define MCE_DEFAULT_RING_XDP                 (false)
 #define MCE_DEFAULT_TCP_MAX_SYN_RATE         (0)
 #define MCE_DEFAULT_ZC_NUM_BUFS              (200000)
 #define MCE_DEFAULT_ZC_TX_SIZE               (32768)
@@ -722,6 +807,8 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_TX_BUFS_BATCH_UDP        (8)
 #define MCE_DEFAULT_TX_BUFS_BATCH_TCP        (16)
 #define MCE_DEFAULT_TX_SEGS_BATCH_TCP        (64)
+#define MCE_DEFAULT_TX_MPW                   (false)
+#define MCE_DEFAULT_BUFFER_POOL_CACHE_SIZE   (0)
 #define MCE_DEFAULT_TX_NUM_SGE               (4)
 
 #if defined(DEFINED_DPCP)
@@ -743,10 +830,13 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_RX_BUF_SIZE                   (0)
 #define MCE_DEFAULT_RX_BUFS_BATCH                 (64)
 #define MCE_DEFAULT_RX_NUM_WRE                    (16000)
+#define MCE_DEFAULT_RX_SRQ_NUM_WRE                (0)
 #define MCE_DEFAULT_RX_NUM_WRE_TO_POST_RECV       (64)
 #define MCE_DEFAULT_RX_NUM_SGE                    (1)
 #define MCE_DEFAULT_RX_NUM_POLLS                  (100000)
 #define MCE_DEFAULT_RX_NUM_POLLS_INIT             (0)
+#define MCE_DEFAULT_RX_NUM_POLLS_MIN              (1000)
+#define MCE_DEFAULT_POLL_ADAPTIVE                 (false)
 #define MCE_DEFAULT_RX_UDP_POLL_OS_RATIO          (100)
 #define MCE_DEFAULT_HW_TS_CONVERSION_MODE         (TS_CONVERSION_MODE_SYNC)
 #define MCE_DEFAULT_RX_POLL_YIELD                 (0)
@@ -761,6 +851,7 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_ETH_MC_L2_ONLY_RULES          (false)
 #define MCE_DEFAULT_MC_FORCE_FLOWTAG              (false)
 #define MCE_DEFAULT_SELECT_NUM_POLLS              (100000)
+#define MCE_DEFAULT_SELECT_NUM_POLLS_MIN          (10)
 #define MCE_DEFAULT_SELECT_POLL_OS_FORCE          (0)
 #define MCE_DEFAULT_SELECT_POLL_OS_RATIO          (10)
 #define MCE_DEFAULT_SELECT_SKIP_OS                (4)
@@ -780,6 +871,8 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_PROGRESS_ENGINE_INTERVAL_MSEC  (10)
 #define MCE_DEFAULT_PROGRESS_ENGINE_WCE_MAX        (10000)
 #define MCE_DEFAULT_CQ_KEEP_QP_FULL                (true)
+#define MCE_DEFAULT_CQ_RX_BATCH_PREFETCH           (false)
+#define MCE_DEFAULT_RX_CQE_COMPRESSION             (false)
 #define MCE_DEFAULT_QP_COMPENSATION_LEVEL          (256)
 #define MCE_DEFAULT_USER_HUGE_PAGE_SIZE            (2 * 1024 * 1024)
 #define MCE_DEFAULT_INTERNAL_THREAD_ARM_CQ_ENABLED (false)
@@ -788,10 +881,16 @@ extern mce_sys_var &safe_mce_sys();
 #define MCE_DEFAULT_TIMER_RESOLUTION_MSEC          (10)
 #define MCE_DEFAULT_TCP_TIMER_RESOLUTION_MSEC      (100)
 #define MCE_DEFAULT_TCP_CTL_THREAD                 (CTL_THREAD_DISABLE)
+#define MCE_DEFAULT_TCP_SYNCOOKIES                 (0)
+#define MCE_DEFAULT_TCP_FASTOPEN                   (TFO_CLIENT_ENABLE)
+#define MCE_DEFAULT_TCP_ECN                        (0)
 #define MCE_DEFAULT_TCP_TIMESTAMP_OPTION           (TCP_TS_OPTION_DISABLE)
 #define MCE_DEFAULT_TCP_NODELAY                    (false)
 #define MCE_DEFAULT_TCP_QUICKACK                   (false)
 #define MCE_DEFAULT_TCP_PUSH_FLAG                  (true)
+#define MCE_DEFAULT_TCP_SACK                       (true)
+#define MCE_DEFAULT_TCP_RACK_TLP                   (true)
+#define MCE_DEFAULT_TCP_SW_PACING                  (false)
 #define MCE_DEFAULT_AVOID_SYS_CALLS_ON_TCP_FD      (false)
 #define MCE_DEFAULT_ALLOW_PRIVILEGED_SOCK_OPT      (true)
 #define MCE_DEFAULT_WAIT_AFTER_JOIN_MSEC           (0)
@@ -97,6 +97,7 @@ public:
         get_tcp_wmem(true);
         get_tcp_rmem(true);
         get_tcp_window_scaling(true);
+        get_tcp_sack(true);
         get_net_core_rmem_max(true);
         get_net_core_wmem_max(true);
         get_net_ipv4_tcp_timestamps(true);
@@ -188,6 +189,15 @@ public:
         return val;
     }
 
+    int get_tcp_sack(bool update = false)
+    {
+        static int val;
+        if (update) {
+            val = read_file_to_int("/proc/sys/net/ipv4/tcp_sack", 1);
+        }
+        return val;
+    }
+
     int get_net_core_rmem_max(bool update = false)
     {
         static int val;
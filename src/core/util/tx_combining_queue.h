@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TX_COMBINING_QUEUE_H
+#define TX_COMBINING_QUEUE_H
+
+#include <atomic>
+
+/*
+ * Flat-combining submission queue.
+ * Requests are pushed to a lock-free stack and whichever submitter wins the
+ * lock processes all pending requests in submission order. Other submitters
+ * only spin on their own done flag, so the lock is not bounced between cores
+ * under contention. A request lives on the stack of the submitting thread and
+ * may be reused as soon as its done flag is set.
+ */
+struct tx_combining_node {
+    tx_combining_node *next;
+    std::atomic<bool> done;
+};
+
+class tx_combining_queue {
+public:
+    tx_combining_queue()
+        : m_head(nullptr)
+    {
+    }
+
+    void push(tx_combining_node *node)
+    {
+        node->done.store(false, std::memory_order_relaxed);
+        node->next = m_head.load(std::memory_order_relaxed);
+        while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        }
+    }
+
+    /* Wait until the node is processed, combining the pending requests whenever
+     * the lock is free. LOCK::trylock() returns 0 on success.
+     */
+    template <typename LOCK, typename F>
+    void wait(tx_combining_node *node, LOCK &lock, F combine) const
+    {
+        while (!node->done.load(std::memory_order_acquire)) {
+            if (lock.trylock() == 0) {
+                combine();
+                lock.unlock();
+            }
+        }
+    }
+
+    /* Process the pending requests, must be called under the lock. The number
+     * of passes is bounded, so a combiner is not starved by a steady stream of
+     * new submissions. Leftovers are picked up by their owners in wait().
+     * Returns the number of processed requests.
+     */
+    template <typename F> int combine(F process, int max_passes)
+    {
+        int processed = 0;
+
+        for (int pass = 0; pass < max_passes; ++pass) {
+            tx_combining_node *head = m_head.exchange(nullptr, std::memory_order_acquire);
+            if (!head) {
+                break;
+            }
+
+            // Restore submission order
+            tx_combining_node *fifo = nullptr;
+            while (head) {
+                tx_combining_node *next = head->next;
+                head->next = fifo;
+                fifo = head;
+                head = next;
+            }
+
+            while (fifo) {
+                // The node memory may be reused as soon as done is set
+                tx_combining_node *next = fifo->next;
+                process(fifo);
+                fifo->done.store(true, std::memory_order_release);
+                fifo = next;
+                ++processed;
+            }
+        }
+        return processed;
+    }
+
+private:
+    std::atomic<tx_combining_node *> m_head; // Lock-free MPSC stack of pending requests
+};
+
+#endif /* TX_COMBINING_QUEUE_H */
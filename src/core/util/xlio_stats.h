@@ -51,6 +51,7 @@
 #define NUM_OF_SUPPORTED_BPOOLS      4
 #define NUM_OF_SUPPORTED_GLOBALS     1
 #define NUM_OF_SUPPORTED_EPFDS       32
+#define NUM_OF_CQ_RX_BATCH_BUCKETS   8 // log2 buckets of CQEs per Rx poll, 1 ... 128
 #define SHMEM_STATS_SIZE(fds_num)    sizeof(sh_mem_t) + (fds_num * sizeof(socket_instance_block_t))
 #define FILE_NAME_MAX_SIZE           (NAME_MAX + 1)
 #define MC_TABLE_SIZE                1024
@@ -81,6 +82,7 @@ typedef struct {
     uint32_t n_iomux_rx_ready;
     uint32_t n_iomux_os_rx_ready;
     uint32_t n_iomux_polling_time;
+    uint32_t n_iomux_poll_budget;
 } iomux_func_stats_t;
 
 typedef enum { e_totals = 1, e_deltas } print_details_mode_t;
@@ -157,6 +159,10 @@ typedef struct {
     uint32_t n_tx_errors;
     uint32_t n_tx_eagain;
     uint32_t n_tx_retransmits;
+    uint32_t n_tx_rto;
+    uint32_t n_tx_tlp_probes;
+    uint32_t n_tx_tlp_recoveries;
+    uint32_t n_tx_rack_losses;
     uint32_t n_tx_os_packets;
     uint32_t n_tx_os_errors;
     uint32_t n_tx_os_eagain;
@@ -193,6 +199,10 @@ typedef struct {
     uint32_t n_conn_accepted;
     uint32_t n_conn_dropped;
     uint32_t n_conn_backlog;
+    uint32_t n_syncookie_sent;
+    uint32_t n_syncookie_recv;
+    uint32_t n_fastopen_accepted;
+    uint32_t n_fastopen_cookie_sent;
 } socket_listen_counters_t;
 
 typedef struct socket_stats_t {
@@ -218,6 +228,7 @@ typedef struct socket_stats_t {
     uint64_t n_rx_ready_byte_count;
     uint64_t n_tx_ready_byte_count;
     uint32_t n_rx_zcopy_pkt_count;
+    uint32_t n_rx_poll_budget;
     socket_counters_t counters;
 #ifdef DEFINED_UTLS
     bool tls_tx_offload;
@@ -245,7 +256,7 @@ typedef struct socket_stats_t {
         bound_port = connected_port = (in_port_t)0;
         threadid_last_rx = threadid_last_tx = pid_t(0);
         n_rx_ready_pkt_count = n_rx_ready_byte_count = n_rx_ready_byte_limit =
-            n_rx_zcopy_pkt_count = n_tx_ready_byte_count = 0;
+            n_rx_zcopy_pkt_count = n_rx_poll_budget = n_tx_ready_byte_count = 0;
         memset(&counters, 0, sizeof(counters));
 #ifdef DEFINED_UTLS
         tls_tx_offload = tls_rx_offload = false;
@@ -306,6 +317,9 @@ typedef struct {
     uint64_t n_rx_pkt_drop;
     uint64_t n_rx_lro_packets;
     uint64_t n_rx_lro_bytes;
+    uint64_t n_rx_batch_hist[NUM_OF_CQ_RX_BATCH_BUCKETS];
+    uint64_t n_rx_cqe_zip_packets;
+    uint64_t n_rx_cqe_zip_slots;
     uint32_t n_rx_sw_queue_len;
     uint32_t n_rx_drained_at_once_max;
     uint32_t n_buffer_pool_len;
@@ -313,14 +327,22 @@ typedef struct {
     uint16_t n_rx_max_stirde_per_packet;
 } cq_stats_t;
 
+// Bucket of n_rx_batch_hist for a poll of num_cqes > 0 completions
+static inline uint32_t cq_rx_batch_bucket(uint32_t num_cqes)
+{
+    uint32_t bucket = 31U - __builtin_clz(num_cqes);
+
+    return bucket < NUM_OF_CQ_RX_BATCH_BUCKETS ? bucket : NUM_OF_CQ_RX_BATCH_BUCKETS - 1U;
+}
+
 typedef struct {
     bool b_enabled;
     cq_stats_t cq_stats;
 } cq_instance_block_t;
 
-typedef enum { RING_ETH = 0, RING_TAP } ring_type_t;
+typedef enum { RING_ETH = 0, RING_TAP, RING_LOOPBACK, RING_XDP } ring_type_t;
 
-static const char *const ring_type_str[] = {"RING_ETH", "RING_TAP"};
+static const char *const ring_type_str[] = {"RING_ETH", "RING_TAP", "RING_LOOPBACK", "RING_XDP"};
 
 // Ring stat info
 typedef struct {
@@ -346,6 +368,11 @@ typedef struct {
             uint64_t n_tx_dev_mem_byte_count;
             uint64_t n_tx_dev_mem_oob;
             uint32_t n_tx_dev_mem_allocated;
+            uint64_t n_tx_mpw_wqes;
+            uint64_t n_tx_mpw_packets;
+            uint64_t n_tx_mpw_wqebbs;
+            uint32_t n_rx_srq_size;
+            uint32_t n_rx_srq_posted;
         } simple;
         struct {
             char s_tap_name[IFNAMSIZ];
@@ -353,6 +380,17 @@ typedef struct {
             uint32_t n_rx_buffers;
             uint32_t n_vf_plugouts;
         } tap;
+        struct {
+            uint64_t n_tx_dropped;
+            uint64_t n_tx_tso_segments;
+            uint32_t n_rx_buffers;
+        } loopback;
+        struct {
+            uint64_t n_tx_dropped;
+            uint64_t n_tx_kicks;
+            uint32_t n_rx_buffers;
+            uint32_t n_queue_id;
+        } xdp;
     };
 } ring_stats_t;
 
@@ -368,6 +406,8 @@ typedef struct {
     uint32_t n_buffer_pool_size;
     uint32_t n_buffer_pool_no_bufs;
     uint32_t n_buffer_pool_expands;
+    uint32_t n_buffer_pool_cache_refills;
+    uint32_t n_buffer_pool_cache_flushes;
 } bpool_stats_t;
 
 typedef struct {
@@ -217,6 +217,7 @@ enum {
     XLIO_EXTRA_API_GET_SOCKET_RINGS_FDS = (1 << 6),
     XLIO_EXTRA_API_DUMP_FD_STATS = (1 << 11),
     XLIO_EXTRA_API_IOCTL = (1 << 12),
+    XLIO_EXTRA_API_TX_BATCH = (1 << 13),
 };
 
 /**
@@ -353,6 +354,29 @@ struct __attribute__((packed)) xlio_api_t {
      * @return -1 on failure and 0 on success
      */
     int (*ioctl)(void *cmsg_hdr, size_t cmsg_len);
+
+    /**
+     * Open a TX batch scope for the calling thread.
+     *
+     * Until the matching tx_batch_end(), packets sent by this thread are
+     * posted to the hardware send queues without notifying the device.
+     * The outermost tx_batch_end() notifies each used ring once, so replies
+     * to many sockets cost a single doorbell per ring. Scopes can be nested.
+     * The device is also notified when the thread blocks in an offloaded
+     * socket call, closes a socket or exits.
+     *
+     * @return 0 on success.
+     */
+    int (*tx_batch_begin)(void);
+
+    /**
+     * Close a TX batch scope opened by tx_batch_begin().
+     *
+     * @return 0 on success, -1 on failure
+     *
+     * errno is set to: EINVAL - no open scope in the calling thread
+     */
+    int (*tx_batch_end)(void);
 };
 
 /**
@@ -223,6 +223,9 @@ void print_full_stats(socket_stats_t *p_si_stats, mc_grp_info_t *p_mc_grp_info,
         fprintf(filename, "Rx poll: %u / %u (%2.2f%%) [miss/hit]\n",
                 p_si_stats->counters.n_rx_poll_miss, p_si_stats->counters.n_rx_poll_hit,
                 rx_poll_hit_percentage);
+        if (p_si_stats->n_rx_poll_budget) {
+            fprintf(filename, "Rx poll budget: cur %u [loops]\n", p_si_stats->n_rx_poll_budget);
+        }
         b_any_activiy = true;
     }
 
@@ -235,6 +238,14 @@ void print_full_stats(socket_stats_t *p_si_stats, mc_grp_info_t *p_mc_grp_info,
         fprintf(filename, "Retransmissions: %u\n", p_si_stats->counters.n_tx_retransmits);
     }
 
+    if (p_si_stats->counters.n_tx_rto || p_si_stats->counters.n_tx_tlp_probes ||
+        p_si_stats->counters.n_tx_rack_losses) {
+        fprintf(filename,
+                "Loss recovery: %u / %u / %u / %u [RTO/TLP probes/TLP recovered/RACK lost]\n",
+                p_si_stats->counters.n_tx_rto, p_si_stats->counters.n_tx_tlp_probes,
+                p_si_stats->counters.n_tx_tlp_recoveries, p_si_stats->counters.n_tx_rack_losses);
+    }
+
     if (p_si_stats->counters.n_tx_sendfile_fallbacks) {
         fprintf(filename, "Sendfile: fallbacks %u / overflows %u\n",
                 p_si_stats->counters.n_tx_sendfile_fallbacks,
@@ -290,10 +301,24 @@ void print_full_stats(socket_stats_t *p_si_stats, mc_grp_info_t *p_mc_grp_info,
                     p_si_stats->listen_counters.n_conn_dropped,
                     p_si_stats->listen_counters.n_rx_fin, post_fix);
         }
+        if (p_si_stats->listen_counters.n_syncookie_sent != 0) {
+            fprintf(filename, "Listen SYN cookies: %u / %u [sent/validated]%s\n",
+                    p_si_stats->listen_counters.n_syncookie_sent,
+                    p_si_stats->listen_counters.n_syncookie_recv, post_fix);
+        }
+        if (p_si_stats->listen_counters.n_fastopen_accepted != 0 ||
+            p_si_stats->listen_counters.n_fastopen_cookie_sent != 0) {
+            fprintf(filename, "Listen Fast Open: %u / %u [accepted/cookies sent]%s\n",
+                    p_si_stats->listen_counters.n_fastopen_accepted,
+                    p_si_stats->listen_counters.n_fastopen_cookie_sent, post_fix);
+        }
         b_any_activiy = b_any_activiy || p_si_stats->listen_counters.n_conn_accepted ||
             p_si_stats->listen_counters.n_conn_established ||
             p_si_stats->listen_counters.n_rx_syn || p_si_stats->listen_counters.n_rx_syn_tw ||
-            p_si_stats->listen_counters.n_conn_dropped;
+            p_si_stats->listen_counters.n_conn_dropped ||
+            p_si_stats->listen_counters.n_syncookie_sent ||
+            p_si_stats->listen_counters.n_fastopen_accepted ||
+            p_si_stats->listen_counters.n_fastopen_cookie_sent;
     }
 
     if (b_any_activiy == false) {
@@ -106,6 +106,8 @@ typedef enum { e_K = 1024, e_M = 1048576 } units_t;
 #define FORMAT_RING_INTERRUPT  "%-20s %zu / %zu [requests/received] %-3s\n"
 #define FORMAT_RING_MODERATION "%-20s %u / %u [frames/usec period] %-3s\n"
 #define FORMAT_RING_DM_STATS   "%-20s %zu / %zu / %zu [kilobytes/packets/oob] %-3s\n"
+#define FORMAT_RING_MPW_STATS  "%-20s %zu / %zu / %zu [wqes/packets/wqebbs] %-3s\n"
+#define FORMAT_RING_SRQ_STATS  "%-20s %u / %u [posted/size]\n"
 #define FORMAT_RING_TAP_NAME   "%-20s %s\n"
 #define FORMAT_RING_MASTER     "%-20s %p\n"
 
@@ -249,6 +251,7 @@ void update_delta_stat(socket_stats_t *p_curr_stat, socket_stats_t *p_prev_stat)
     p_prev_stat->n_rx_ready_pkt_count = p_curr_stat->n_rx_ready_pkt_count;
     p_prev_stat->counters.n_rx_ready_pkt_max = p_curr_stat->counters.n_rx_ready_pkt_max;
     p_prev_stat->n_rx_zcopy_pkt_count = p_curr_stat->n_rx_zcopy_pkt_count;
+    p_prev_stat->n_rx_poll_budget = p_curr_stat->n_rx_poll_budget;
     p_prev_stat->strq_counters.n_strq_total_strides =
         (p_curr_stat->strq_counters.n_strq_total_strides -
          p_prev_stat->strq_counters.n_strq_total_strides) /
@@ -298,6 +301,15 @@ void update_delta_stat(socket_stats_t *p_curr_stat, socket_stats_t *p_prev_stat)
         (p_curr_stat->counters.n_tx_migrations - p_prev_stat->counters.n_tx_migrations) / delay;
     p_prev_stat->counters.n_tx_retransmits =
         (p_curr_stat->counters.n_tx_retransmits - p_prev_stat->counters.n_tx_retransmits) / delay;
+    p_prev_stat->counters.n_tx_rto =
+        (p_curr_stat->counters.n_tx_rto - p_prev_stat->counters.n_tx_rto) / delay;
+    p_prev_stat->counters.n_tx_tlp_probes =
+        (p_curr_stat->counters.n_tx_tlp_probes - p_prev_stat->counters.n_tx_tlp_probes) / delay;
+    p_prev_stat->counters.n_tx_tlp_recoveries =
+        (p_curr_stat->counters.n_tx_tlp_recoveries - p_prev_stat->counters.n_tx_tlp_recoveries) /
+        delay;
+    p_prev_stat->counters.n_tx_rack_losses =
+        (p_curr_stat->counters.n_tx_rack_losses - p_prev_stat->counters.n_tx_rack_losses) / delay;
     p_prev_stat->counters.n_tx_sendfile_fallbacks =
         (p_curr_stat->counters.n_tx_sendfile_fallbacks -
          p_prev_stat->counters.n_tx_sendfile_fallbacks) /
@@ -324,6 +336,22 @@ void update_delta_stat(socket_stats_t *p_curr_stat, socket_stats_t *p_prev_stat)
     p_prev_stat->listen_counters.n_conn_dropped = (p_curr_stat->listen_counters.n_conn_dropped -
                                                    p_prev_stat->listen_counters.n_conn_dropped) /
         delay;
+    p_prev_stat->listen_counters.n_syncookie_sent =
+        (p_curr_stat->listen_counters.n_syncookie_sent -
+         p_prev_stat->listen_counters.n_syncookie_sent) /
+        delay;
+    p_prev_stat->listen_counters.n_syncookie_recv =
+        (p_curr_stat->listen_counters.n_syncookie_recv -
+         p_prev_stat->listen_counters.n_syncookie_recv) /
+        delay;
+    p_prev_stat->listen_counters.n_fastopen_accepted =
+        (p_curr_stat->listen_counters.n_fastopen_accepted -
+         p_prev_stat->listen_counters.n_fastopen_accepted) /
+        delay;
+    p_prev_stat->listen_counters.n_fastopen_cookie_sent =
+        (p_curr_stat->listen_counters.n_fastopen_cookie_sent -
+         p_prev_stat->listen_counters.n_fastopen_cookie_sent) /
+        delay;
 }
 
 void update_delta_iomux_stat(iomux_func_stats_t *p_curr_stats, iomux_func_stats_t *p_prev_stats)
@@ -342,6 +370,7 @@ void update_delta_iomux_stat(iomux_func_stats_t *p_curr_stats, iomux_func_stats_
             (p_curr_stats->n_iomux_rx_ready - p_prev_stats->n_iomux_rx_ready) / delay;
         p_prev_stats->n_iomux_timeouts =
             (p_curr_stats->n_iomux_timeouts - p_prev_stats->n_iomux_timeouts) / delay;
+        p_prev_stats->n_iomux_poll_budget = p_curr_stats->n_iomux_poll_budget;
         p_prev_stats->threadid_last = p_curr_stats->threadid_last;
     }
 }
@@ -378,6 +407,24 @@ void update_delta_ring_stat(ring_stats_t *p_curr_ring_stats, ring_stats_t *p_pre
             p_prev_ring_stats->tap.n_rx_buffers = p_curr_ring_stats->tap.n_rx_buffers;
             p_prev_ring_stats->tap.n_vf_plugouts =
                 (p_curr_ring_stats->tap.n_vf_plugouts - p_prev_ring_stats->tap.n_vf_plugouts);
+        } else if (p_prev_ring_stats->n_type == RING_LOOPBACK) {
+            p_prev_ring_stats->loopback.n_tx_dropped =
+                (p_curr_ring_stats->loopback.n_tx_dropped -
+                 p_prev_ring_stats->loopback.n_tx_dropped) /
+                delay;
+            p_prev_ring_stats->loopback.n_tx_tso_segments =
+                (p_curr_ring_stats->loopback.n_tx_tso_segments -
+                 p_prev_ring_stats->loopback.n_tx_tso_segments) /
+                delay;
+            p_prev_ring_stats->loopback.n_rx_buffers = p_curr_ring_stats->loopback.n_rx_buffers;
+        } else if (p_prev_ring_stats->n_type == RING_XDP) {
+            p_prev_ring_stats->xdp.n_tx_dropped =
+                (p_curr_ring_stats->xdp.n_tx_dropped - p_prev_ring_stats->xdp.n_tx_dropped) /
+                delay;
+            p_prev_ring_stats->xdp.n_tx_kicks =
+                (p_curr_ring_stats->xdp.n_tx_kicks - p_prev_ring_stats->xdp.n_tx_kicks) / delay;
+            p_prev_ring_stats->xdp.n_rx_buffers = p_curr_ring_stats->xdp.n_rx_buffers;
+            p_prev_ring_stats->xdp.n_queue_id = p_curr_ring_stats->xdp.n_queue_id;
         } else {
             p_prev_ring_stats->simple.n_rx_interrupt_received =
                 (p_curr_ring_stats->simple.n_rx_interrupt_received -
@@ -405,6 +452,19 @@ void update_delta_ring_stat(ring_stats_t *p_curr_ring_stats, ring_stats_t *p_pre
                 (p_curr_ring_stats->simple.n_tx_dev_mem_oob -
                  p_prev_ring_stats->simple.n_tx_dev_mem_oob) /
                 delay;
+            p_prev_ring_stats->simple.n_tx_mpw_wqes =
+                (p_curr_ring_stats->simple.n_tx_mpw_wqes - p_prev_ring_stats->simple.n_tx_mpw_wqes) /
+                delay;
+            p_prev_ring_stats->simple.n_tx_mpw_packets =
+                (p_curr_ring_stats->simple.n_tx_mpw_packets -
+                 p_prev_ring_stats->simple.n_tx_mpw_packets) /
+                delay;
+            p_prev_ring_stats->simple.n_tx_mpw_wqebbs =
+                (p_curr_ring_stats->simple.n_tx_mpw_wqebbs -
+                 p_prev_ring_stats->simple.n_tx_mpw_wqebbs) /
+                delay;
+            p_prev_ring_stats->simple.n_rx_srq_size = p_curr_ring_stats->simple.n_rx_srq_size;
+            p_prev_ring_stats->simple.n_rx_srq_posted = p_curr_ring_stats->simple.n_rx_srq_posted;
         }
     }
 }
@@ -429,6 +489,15 @@ void update_delta_cq_stat(cq_stats_t *p_curr_cq_stats, cq_stats_t *p_prev_cq_sta
             (p_curr_cq_stats->n_rx_packet_count - p_prev_cq_stats->n_rx_packet_count) / delay;
         p_prev_cq_stats->n_rx_max_stirde_per_packet = p_curr_cq_stats->n_rx_max_stirde_per_packet;
         p_prev_cq_stats->n_rx_cqe_error = p_curr_cq_stats->n_rx_cqe_error;
+        p_prev_cq_stats->n_rx_cqe_zip_packets =
+            (p_curr_cq_stats->n_rx_cqe_zip_packets - p_prev_cq_stats->n_rx_cqe_zip_packets) /
+            delay;
+        p_prev_cq_stats->n_rx_cqe_zip_slots =
+            (p_curr_cq_stats->n_rx_cqe_zip_slots - p_prev_cq_stats->n_rx_cqe_zip_slots) / delay;
+        for (int i = 0; i < NUM_OF_CQ_RX_BATCH_BUCKETS; i++) {
+            p_prev_cq_stats->n_rx_batch_hist[i] =
+                (p_curr_cq_stats->n_rx_batch_hist[i] - p_prev_cq_stats->n_rx_batch_hist[i]) / delay;
+        }
     }
 }
 
@@ -440,6 +509,14 @@ void update_delta_bpool_stat(bpool_stats_t *p_curr_bpool_stats, bpool_stats_t *p
         p_prev_bpool_stats->n_buffer_pool_no_bufs = (p_curr_bpool_stats->n_buffer_pool_no_bufs -
                                                      p_prev_bpool_stats->n_buffer_pool_no_bufs) /
             delay;
+        p_prev_bpool_stats->n_buffer_pool_cache_refills =
+            (p_curr_bpool_stats->n_buffer_pool_cache_refills -
+             p_prev_bpool_stats->n_buffer_pool_cache_refills) /
+            delay;
+        p_prev_bpool_stats->n_buffer_pool_cache_flushes =
+            (p_curr_bpool_stats->n_buffer_pool_cache_flushes -
+             p_prev_bpool_stats->n_buffer_pool_cache_flushes) /
+            delay;
     }
 }
 
@@ -516,6 +593,26 @@ void print_ring_stats(ring_instance_block_t *p_ring_inst_arr)
                 }
                 printf(FORMAT_STATS_32bit, "Tap fd:", p_ring_stats->tap.n_tap_fd);
                 printf(FORMAT_RING_TAP_NAME, "Tap Device:", p_ring_stats->tap.s_tap_name);
+            } else if (p_ring_stats->n_type == RING_LOOPBACK) {
+                printf(FORMAT_STATS_32bit, "Rx Buffers:", p_ring_stats->loopback.n_rx_buffers);
+                if (p_ring_stats->loopback.n_tx_tso_segments) {
+                    printf(FORMAT_STATS_64bit,
+                           "Tx TSO Segments:", p_ring_stats->loopback.n_tx_tso_segments, post_fix);
+                }
+                if (p_ring_stats->loopback.n_tx_dropped) {
+                    printf(FORMAT_STATS_64bit, "Tx Dropped:", p_ring_stats->loopback.n_tx_dropped,
+                           post_fix);
+                }
+            } else if (p_ring_stats->n_type == RING_XDP) {
+                printf(FORMAT_STATS_32bit, "Rx Buffers:", p_ring_stats->xdp.n_rx_buffers);
+                printf(FORMAT_STATS_32bit, "Queue Id:", p_ring_stats->xdp.n_queue_id);
+                if (p_ring_stats->xdp.n_tx_kicks) {
+                    printf(FORMAT_STATS_64bit, "Tx Kicks:", p_ring_stats->xdp.n_tx_kicks, post_fix);
+                }
+                if (p_ring_stats->xdp.n_tx_dropped) {
+                    printf(FORMAT_STATS_64bit, "Tx Dropped:", p_ring_stats->xdp.n_tx_dropped,
+                           post_fix);
+                }
             } else {
                 if (p_ring_stats->simple.n_rx_interrupt_requests ||
                     p_ring_stats->simple.n_rx_interrupt_received) {
@@ -537,6 +634,15 @@ void print_ring_stats(ring_instance_block_t *p_ring_inst_arr)
                            p_ring_stats->simple.n_tx_dev_mem_pkt_count,
                            p_ring_stats->simple.n_tx_dev_mem_oob, post_fix);
                 }
+                if (p_ring_stats->simple.n_tx_mpw_wqes) {
+                    printf(FORMAT_RING_MPW_STATS, "Tx MPW:", p_ring_stats->simple.n_tx_mpw_wqes,
+                           p_ring_stats->simple.n_tx_mpw_packets,
+                           p_ring_stats->simple.n_tx_mpw_wqebbs, post_fix);
+                }
+                if (p_ring_stats->simple.n_rx_srq_size) {
+                    printf(FORMAT_RING_SRQ_STATS, "Rx SRQ:", p_ring_stats->simple.n_rx_srq_posted,
+                           p_ring_stats->simple.n_rx_srq_size);
+                }
             }
         }
     }
@@ -581,6 +687,25 @@ void print_cq_stats(cq_instance_block_t *p_cq_inst_arr)
                        "Rx lro:", p_cq_stats->n_rx_lro_bytes / BYTES_TRAFFIC_UNIT,
                        p_cq_stats->n_rx_lro_packets, post_fix);
             }
+            if (p_cq_stats->n_rx_cqe_zip_packets) {
+                printf(FORMAT_STATS_64bit, "Zipped packets:", p_cq_stats->n_rx_cqe_zip_packets,
+                       post_fix);
+                printf(FORMAT_STATS_double, "Zip packets/cqe:",
+                       p_cq_stats->n_rx_cqe_zip_packets /
+                           static_cast<double>(p_cq_stats->n_rx_cqe_zip_slots + 1U));
+            }
+            for (int j = 0; j < NUM_OF_CQ_RX_BATCH_BUCKETS; j++) {
+                if (p_cq_stats->n_rx_batch_hist[j]) {
+                    char label[32];
+                    if (j == 0) {
+                        snprintf(label, sizeof(label), "Rx batch 1:");
+                    } else {
+                        snprintf(label, sizeof(label), "Rx batch %u-%u:", 1U << j,
+                                 (2U << j) - 1U);
+                    }
+                    printf(FORMAT_STATS_64bit, label, p_cq_stats->n_rx_batch_hist[j], post_fix);
+                }
+            }
         }
     }
     printf("======================================================\n");
@@ -611,6 +736,12 @@ void print_bpool_stats(bpool_instance_block_t *p_bpool_inst_arr)
             if (p_bpool_stats->n_buffer_pool_expands) {
                 printf(FORMAT_STATS_32bit, "Expands:", p_bpool_stats->n_buffer_pool_expands);
             }
+            if (p_bpool_stats->n_buffer_pool_cache_refills) {
+                printf(FORMAT_STATS_32bit, "Cache refills:",
+                       p_bpool_stats->n_buffer_pool_cache_refills);
+                printf(FORMAT_STATS_32bit, "Cache flushes:",
+                       p_bpool_stats->n_buffer_pool_cache_flushes);
+            }
         }
     }
     printf("======================================================\n");
@@ -905,6 +1036,9 @@ void print_full_iomux_stats(const char *func_name, iomux_func_stats_t *p_iomux_s
             printf("Polls [miss/hit]%s: %u / %u (%2.2f%%)\n", post_fix,
                    p_iomux_stats->n_iomux_poll_miss, p_iomux_stats->n_iomux_poll_hit,
                    iomux_poll_hit_percentage);
+            if (p_iomux_stats->n_iomux_poll_budget) {
+                printf("Poll budget: %u [usec]\n", p_iomux_stats->n_iomux_poll_budget);
+            }
             if (p_iomux_stats->n_iomux_timeouts) {
                 printf("Timeouts%s: %u\n", post_fix, p_iomux_stats->n_iomux_timeouts);
             }
@@ -1735,6 +1869,12 @@ void zero_ring_stats(ring_stats_t *p_ring_stats)
 #endif /* DEFINED_UTLS */
     if (p_ring_stats->n_type == RING_TAP) {
         p_ring_stats->tap.n_vf_plugouts = 0;
+    } else if (p_ring_stats->n_type == RING_LOOPBACK) {
+        p_ring_stats->loopback.n_tx_dropped = 0;
+        p_ring_stats->loopback.n_tx_tso_segments = 0;
+    } else if (p_ring_stats->n_type == RING_XDP) {
+        p_ring_stats->xdp.n_tx_dropped = 0;
+        p_ring_stats->xdp.n_tx_kicks = 0;
     } else {
         p_ring_stats->simple.n_rx_interrupt_received = 0;
         p_ring_stats->simple.n_rx_interrupt_requests = 0;
@@ -1742,6 +1882,9 @@ void zero_ring_stats(ring_stats_t *p_ring_stats)
         p_ring_stats->simple.n_tx_dev_mem_byte_count = 0;
         p_ring_stats->simple.n_tx_dev_mem_pkt_count = 0;
         p_ring_stats->simple.n_tx_dev_mem_oob = 0;
+        p_ring_stats->simple.n_tx_mpw_wqes = 0;
+        p_ring_stats->simple.n_tx_mpw_packets = 0;
+        p_ring_stats->simple.n_tx_mpw_wqebbs = 0;
     }
 }
 
@@ -1754,6 +1897,8 @@ void zero_bpool_stats(bpool_stats_t *p_bpool_stats)
 {
     p_bpool_stats->n_buffer_pool_size = 0;
     p_bpool_stats->n_buffer_pool_no_bufs = 0;
+    p_bpool_stats->n_buffer_pool_cache_refills = 0;
+    p_bpool_stats->n_buffer_pool_cache_flushes = 0;
 }
 
 void zero_counters(sh_mem_t *p_sh_mem)
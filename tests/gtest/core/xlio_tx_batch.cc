@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#if defined(EXTRA_API_ENABLED) && (EXTRA_API_ENABLED == 1)
+
+#include "xlio_base.h"
+
+class xlio_tx_batch : public xlio_base {
+protected:
+    void SetUp()
+    {
+        uint64_t xlio_extra_api_cap = XLIO_EXTRA_API_TX_BATCH;
+
+        xlio_base::SetUp();
+
+        SKIP_TRUE((xlio_api->cap_mask & xlio_extra_api_cap) == xlio_extra_api_cap,
+                  "This test requires XLIO capabilities as XLIO_EXTRA_API_TX_BATCH");
+    }
+    void TearDown() { xlio_base::TearDown(); }
+};
+
+/**
+ * @test xlio_tx_batch.ti_1
+ * @brief
+ *    Closing a TX batch without an open one fails
+ * @details
+ */
+TEST_F(xlio_tx_batch, ti_1)
+{
+    int rc = EOK;
+
+    errno = EOK;
+    rc = xlio_api->tx_batch_end();
+    EXPECT_EQ(-1, rc);
+    EXPECT_TRUE(EINVAL == errno);
+}
+
+/**
+ * @test xlio_tx_batch.ti_2
+ * @brief
+ *    Nested TX batches with UDP sends inside
+ * @details
+ */
+TEST_F(xlio_tx_batch, ti_2)
+{
+    int rc = EOK;
+    int fd;
+    char buf[] = "hello";
+
+    fd = socket(m_family, SOCK_DGRAM, IPPROTO_IP);
+    ASSERT_LE(0, fd);
+
+    rc = xlio_api->tx_batch_begin();
+    EXPECT_EQ(0, rc);
+    rc = xlio_api->tx_batch_begin();
+    EXPECT_EQ(0, rc);
+
+    rc = sendto(fd, (void *)buf, sizeof(buf), 0, (struct sockaddr *)&server_addr,
+                sizeof(server_addr));
+    EXPECT_EQ((int)sizeof(buf), rc);
+
+    rc = xlio_api->tx_batch_end();
+    EXPECT_EQ(0, rc);
+    rc = xlio_api->tx_batch_end();
+    EXPECT_EQ(0, rc);
+
+    errno = EOK;
+    rc = xlio_api->tx_batch_end();
+    EXPECT_EQ(-1, rc);
+    EXPECT_TRUE(EINVAL == errno);
+
+    close(fd);
+}
+
+/**
+ * @test xlio_tx_batch.ti_3
+ * @brief
+ *    Datagrams sent inside a TX batch are delivered after tx_batch_end()
+ * @details
+ *    The doorbell of every send is deferred to tx_batch_end(), the receiver
+ *    must get all datagrams and in order.
+ */
+TEST_F(xlio_tx_batch, ti_3)
+{
+    const int count = 64;
+    int pid = fork();
+
+    if (0 == pid) { /* I am the child */
+        int fd = socket(m_family, SOCK_DGRAM, IPPROTO_IP);
+        EXPECT_LE(0, fd);
+        int rc = bind(fd, (struct sockaddr *)&server_addr, sizeof(server_addr));
+        EXPECT_EQ(0, rc);
+        struct timeval tv = {5, 0};
+        rc = setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        EXPECT_EQ(0, rc);
+
+        // The parent sends once the socket is bound
+        barrier_fork(pid, true);
+
+        int received = 0;
+        while (0 == rc && received < count) {
+            int value = -1;
+            ssize_t rcs = recv(fd, &value, sizeof(value), 0);
+            if (rcs != (ssize_t)sizeof(value)) {
+                break;
+            }
+            EXPECT_EQ(received, value);
+            received++;
+        }
+        EXPECT_EQ(count, received);
+
+        close(fd);
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int fd = socket(m_family, SOCK_DGRAM, IPPROTO_IP);
+        ASSERT_LE(0, fd);
+
+        barrier_fork(pid, true);
+
+        int rc = xlio_api->tx_batch_begin();
+        EXPECT_EQ(0, rc);
+        for (int i = 0; i < count; i++) {
+            rc = sendto(fd, (void *)&i, sizeof(i), 0, (struct sockaddr *)&server_addr,
+                        sizeof(server_addr));
+            EXPECT_EQ((int)sizeof(i), rc);
+        }
+        rc = xlio_api->tx_batch_end();
+        EXPECT_EQ(0, rc);
+
+        close(fd);
+
+        EXPECT_EQ(0, wait_fork(pid));
+    }
+}
+
+#endif /* EXTRA_API_ENABLED */
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+
+#include "lwip_base.h"
+
+/* Room for the L2/L3 headers in front of the TCP header */
+#define LWIP_BASE_HDR_ROOM 128
+#define LWIP_BASE_BUF_SIZE (LWIP_BASE_HDR_ROOM + 4096)
+
+const u32_t lwip_base::ISS;
+const u16_t lwip_base::MSS;
+u64_t lwip_base::m_now_us = 0;
+
+void lwip_base::SetUp()
+{
+    errno = EOK;
+
+    m_now_us = 1000000U;
+    register_sys_now(clock_ms);
+    register_sys_now_us(clock_us);
+    register_tcp_state_observer(state_observer);
+    register_tcp_tx_pbuf_alloc(tx_pbuf_alloc);
+    register_tcp_tx_pbuf_free(tx_pbuf_free);
+    register_tcp_seg_alloc(seg_alloc);
+    register_tcp_seg_free(seg_free);
+    register_ip_route_mtu(route_mtu);
+
+    /* XLIO_TCP_TIMER_RESOLUTION_MSEC default */
+    set_tmr_resolution(100U);
+    lwip_cc_algo_module = m_cc_algo;
+    pcb_init(&m_pcb);
+    set_tcp_state(&m_pcb, ESTABLISHED);
+    UPDATE_PCB_BY_MSS(&m_pcb, MSS);
+    m_pcb.snd_nxt = ISS;
+    m_pcb.lastack = ISS;
+    m_pcb.snd_lbb = ISS;
+    m_pcb.rcv_nxt = ISS;
+    m_pcb.snd_wnd = m_pcb.snd_wnd_max = 0x100000U;
+    m_pcb.local_port = 80;
+    m_pcb.remote_port = 12345;
+    m_rx_bytes = 0;
+}
+
+void lwip_base::TearDown()
+{
+    tcp_pcb_purge(&m_pcb);
+    tcp_tx_preallocted_buffers_free(&m_pcb);
+}
+
+void lwip_base::pcb_init(struct tcp_pcb *pcb)
+{
+    tcp_pcb_init(pcb, 0, this);
+    tcp_ip_output(pcb, ip_output);
+    tcp_arg(pcb, this);
+    tcp_recv(pcb, recv);
+    pcb->max_snd_buff = pcb->snd_buf = 0x100000U;
+}
+
+err_t lwip_base::write(u32_t len)
+{
+    std::vector<char> data(len, 'x');
+
+    return tcp_write(&m_pcb, data.data(), len, TCP_WRITE_FLAG_COPY, nullptr);
+}
+
+void lwip_base::input(u32_t seqno, u32_t ackno, u32_t len,
+                      const std::vector<struct tcp_sack_block> &sack, u8_t flags, u8_t ecn,
+                      struct tcp_pcb *pcb)
+{
+    struct pbuf_custom *pc = (struct pbuf_custom *)calloc(
+        1, sizeof(struct pbuf_custom) + IP_HLEN + TCP_HLEN + 40 + len);
+    u8_t *iphdr = (u8_t *)(pc + 1);
+    struct tcp_hdr *tcphdr = (struct tcp_hdr *)(iphdr + IP_HLEN);
+    u32_t *opts = (u32_t *)(tcphdr + 1);
+    u8_t optlen = 0;
+
+    ASSERT_TRUE(pc);
+    ASSERT_GE(4U, sack.size());
+
+    if (!sack.empty()) {
+        opts[0] = htonl(0x01010500 | (2 + 8 * sack.size()));
+        for (size_t i = 0; i < sack.size(); ++i) {
+            opts[1 + 2 * i] = htonl(sack[i].left);
+            opts[2 + 2 * i] = htonl(sack[i].right);
+        }
+        optlen = 4 + 8 * sack.size();
+    }
+
+    u16_t total_len = IP_HLEN + TCP_HLEN + optlen + len;
+
+    iphdr[0] = 0x45;
+    iphdr[1] = ecn;
+    *(u16_t *)&iphdr[2] = htons(total_len);
+    iphdr[8] = 64;
+    iphdr[9] = 6;
+
+    tcphdr->src = htons(m_pcb.remote_port);
+    tcphdr->dest = htons(m_pcb.local_port);
+    tcphdr->seqno = htonl(seqno);
+    tcphdr->ackno = htonl(ackno);
+    TCPH_HDRLEN_FLAGS_SET(tcphdr, (TCP_HLEN + optlen) / 4, flags);
+    tcphdr->wnd = htons(0xffff);
+    memset((u8_t *)tcphdr + TCP_HLEN + optlen, 'y', len);
+
+    pc->custom_free_function = rx_pbuf_free;
+    pc->pbuf.payload = iphdr;
+    pc->pbuf.len = pc->pbuf.tot_len = total_len;
+    pc->pbuf.type = PBUF_REF;
+    pc->pbuf.flags = PBUF_FLAG_IS_CUSTOM;
+    pc->pbuf.ref = 1;
+
+    L3_level_tcp_input(&pc->pbuf, pcb ? pcb : &m_pcb);
+}
+
+void lwip_base::rx_pbuf_free(struct pbuf *p)
+{
+    free(p);
+}
+
+err_t lwip_base::recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t)
+{
+    lwip_base *self = (lwip_base *)arg;
+
+    if (p != NULL) {
+        self->m_rx_bytes += p->tot_len;
+        tcp_recved(pcb, p->tot_len);
+        pbuf_free(p);
+    }
+    return ERR_OK;
+}
+
+u16_t lwip_base::route_mtu(struct tcp_pcb *)
+{
+    return IP_HLEN + TCP_HLEN + MSS;
+}
+
+struct pbuf *lwip_base::tx_pbuf_alloc(void *, pbuf_type, pbuf_desc *, struct pbuf *)
+{
+    struct pbuf *p = (struct pbuf *)calloc(1, sizeof(struct pbuf) + LWIP_BASE_BUF_SIZE);
+
+    if (p) {
+        p->payload = (u8_t *)(p + 1) + LWIP_BASE_HDR_ROOM;
+    }
+    return p;
+}
+
+void lwip_base::tx_pbuf_free(void *, struct pbuf *p)
+{
+    free(p);
+}
+
+struct tcp_seg *lwip_base::seg_alloc(void *)
+{
+    return (struct tcp_seg *)calloc(1, sizeof(struct tcp_seg));
+}
+
+void lwip_base::seg_free(void *, struct tcp_seg *seg)
+{
+    free(seg);
+}
+
+err_t lwip_base::ip_output(struct pbuf *p, struct tcp_seg *, void *p_conn, u16_t flags)
+{
+    struct tcp_pcb *pcb = (struct tcp_pcb *)p_conn;
+    lwip_base *self = (lwip_base *)pcb->my_container;
+    struct tcp_hdr *tcphdr = (struct tcp_hdr *)p->payload;
+    tx_record record;
+
+    record.seqno = ntohl(tcphdr->seqno);
+    record.ackno = ntohl(tcphdr->ackno);
+    record.len = p->tot_len - TCPH_HDRLEN(tcphdr) * 4;
+    record.flags = TCPH_FLAGS(tcphdr) | TCPH_ECN_FLAGS(tcphdr);
+    record.rexmit = !!(flags & TCP_WRITE_REXMIT);
+    record.time_us = m_now_us;
+
+    /* SACK blocks */
+    u8_t *opts = (u8_t *)(tcphdr + 1);
+    u8_t optlen = TCPH_HDRLEN(tcphdr) * 4 - TCP_HLEN;
+    for (u8_t i = 0; i < optlen && opts[i] != 0;) {
+        if (opts[i] == 1) {
+            ++i;
+            continue;
+        }
+        if (opts[i] == 5) {
+            for (u8_t j = i + 2; j + 8 <= i + opts[i + 1]; j += 8) {
+                struct tcp_sack_block block;
+                block.left = ntohl(*(u32_t *)&opts[j]);
+                block.right = ntohl(*(u32_t *)&opts[j + 4]);
+                record.sack.push_back(block);
+            }
+        }
+        i += opts[i + 1];
+    }
+    self->m_tx.push_back(record);
+
+    return ERR_OK;
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TESTS_GTEST_LWIP_BASE_H_
+#define TESTS_GTEST_LWIP_BASE_H_
+
+#include <vector>
+
+#include "core/lwip/tcp.h"
+#include "core/lwip/tcp_impl.h"
+
+/* Entry points to the static lwIP functions, see lwip_stack.c */
+extern "C" {
+void lwip_test_sack_update(struct tcp_pcb *pcb, u32_t ackno, const struct tcp_sack_block *sack,
+                           u8_t cnt);
+u8_t lwip_test_bbr_mode(struct tcp_pcb *pcb);
+u64_t lwip_test_bbr_max_bw(struct tcp_pcb *pcb);
+u32_t lwip_test_dctcp_alpha(struct tcp_pcb *pcb);
+}
+
+/**
+ * LWIP Base class for tests
+ * The tests drive a single tcp_pcb directly, there is no socket, ring or
+ * device behind it. Time is controlled by the test, segments from the peer
+ * are passed to L3_level_tcp_input() by input() and every segment passed
+ * to ip_output() is recorded in m_tx.
+ */
+class lwip_base : public testing::Test {
+protected:
+    lwip_base()
+        : m_cc_algo(CC_MOD_LWIP)
+    {
+    }
+
+    virtual void SetUp();
+    virtual void TearDown();
+
+    /* Initial sequence number of the connection */
+    static const u32_t ISS = 0xfffff000U;
+    static const u16_t MSS = 1000U;
+
+    static u32_t clock_ms() { return (u32_t)(m_now_us / 1000U); }
+    static u64_t clock_us() { return m_now_us; }
+    static void advance_us(u64_t us) { m_now_us += us; }
+    static void state_observer(void *, enum tcp_state) {}
+
+    /* Queue len bytes to the send buffer */
+    err_t write(u32_t len);
+
+    /* Initialize a pcb which records its output in m_tx and counts the received bytes */
+    void pcb_init(struct tcp_pcb *pcb);
+
+    /* Pass an IPv4 segment with len bytes of data from the peer to the pcb,
+     * m_pcb if pcb is not set */
+    void input(u32_t seqno, u32_t ackno, u32_t len,
+               const std::vector<struct tcp_sack_block> &sack = {}, u8_t flags = TCP_ACK,
+               u8_t ecn = 0, struct tcp_pcb *pcb = nullptr);
+
+    struct tx_record {
+        u32_t seqno;
+        u32_t ackno;
+        u32_t len;
+        u8_t flags;
+        bool rexmit;
+        u64_t time_us;
+        std::vector<struct tcp_sack_block> sack;
+    };
+
+protected:
+    /* Congestion control module of the connection, set by the derived fixture */
+    enum cc_algo_mod m_cc_algo;
+    struct tcp_pcb m_pcb;
+    std::vector<tx_record> m_tx;
+    /* Number of bytes passed to the receive callback */
+    u32_t m_rx_bytes;
+
+    static u64_t m_now_us;
+
+private:
+    static struct pbuf *tx_pbuf_alloc(void *p_conn, pbuf_type type, pbuf_desc *desc,
+                                      struct pbuf *p_buff);
+    static void tx_pbuf_free(void *p_conn, struct pbuf *p);
+    static struct tcp_seg *seg_alloc(void *p_conn);
+    static void seg_free(void *p_conn, struct tcp_seg *seg);
+    static err_t ip_output(struct pbuf *p, struct tcp_seg *seg, void *p_conn, u16_t flags);
+    static err_t recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err);
+    static void rx_pbuf_free(struct pbuf *p);
+    static u16_t route_mtu(struct tcp_pcb *pcb);
+};
+
+#endif /* TESTS_GTEST_LWIP_BASE_H_ */
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* The lwIP sources are compiled into the test binary in a single translation
+ * unit, so the tests can reach the static functions through the entry points
+ * below. Nothing else of libxlio is linked in.
+ */
+#include "core/lwip/init.c"
+#include "core/lwip/pbuf.c"
+#include "core/lwip/tcp.c"
+#include "core/lwip/tcp_in.c"
+#include "core/lwip/tcp_out.c"
+#include "core/lwip/cc.c"
+#include "core/lwip/cc_lwip.c"
+#include "core/lwip/cc_cubic.c"
+#include "core/lwip/cc_none.c"
+#include "core/lwip/cc_bbr.c"
+#include "core/lwip/cc_dctcp.c"
+
+/* Defined by proto/xlio_lwip.cpp in libxlio */
+int32_t enable_wnd_scale = 0;
+u32_t rcv_wnd_scale = 0;
+
+#if LWIP_TCP_SACK
+void lwip_test_sack_update(struct tcp_pcb *pcb, u32_t ackno, const struct tcp_sack_block *sack,
+                           u8_t cnt)
+{
+    tcp_in_data in_data;
+
+    memset(&in_data, 0, sizeof(in_data));
+    in_data.ackno = ackno;
+    memcpy(in_data.sack, sack, cnt * sizeof(sack[0]));
+    in_data.sack_cnt = cnt;
+    tcp_sack_update(pcb, &in_data);
+}
+#endif /* LWIP_TCP_SACK */
+
+#if TCP_CC_ALGO_MOD
+u8_t lwip_test_bbr_mode(struct tcp_pcb *pcb)
+{
+    return ((struct bbr *)pcb->cc_data)->mode;
+}
+
+u64_t lwip_test_bbr_max_bw(struct tcp_pcb *pcb)
+{
+    return bbr_max_bw((struct bbr *)pcb->cc_data);
+}
+
+u32_t lwip_test_dctcp_alpha(struct tcp_pcb *pcb)
+{
+    return ((struct dctcp *)pcb->cc_data)->alpha;
+}
+#endif /* TCP_CC_ALGO_MOD */
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "lwip_base.h"
+
+#if TCP_CC_ALGO_MOD
+
+/* enum bbr_mode of cc_bbr.c */
+enum { BBR_STARTUP, BBR_DRAIN, BBR_PROBE_BW, BBR_PROBE_RTT };
+
+class tcp_bbr : public lwip_base {
+protected:
+    tcp_bbr() { m_cc_algo = CC_MOD_BBR; }
+
+    void SetUp() override
+    {
+        lwip_base::SetUp();
+
+        cc_conn_init(&m_pcb);
+    }
+
+    static const u64_t RTT_US = 1000U;
+    static const u64_t BW = 10000000U;
+
+    /* Take a delivery rate sample of bw bytes/sec one RTT after the previous one */
+    void sample(u64_t bw, u64_t rtt_us = RTT_US, bool app_limited = false)
+    {
+        struct tcp_rate_sample rs;
+
+        advance_us(rtt_us);
+        rs.delivered = bw * rtt_us / 1000000U;
+        rs.interval_us = rtt_us;
+        rs.rtt_us = rtt_us;
+        rs.is_app_limited = app_limited;
+        cc_rate_sample(&m_pcb, &rs);
+    }
+
+    void ack(u32_t acked)
+    {
+        m_pcb.acked = acked;
+        cc_ack_received(&m_pcb, CC_ACK);
+    }
+
+    void set_inflight(u32_t bytes) { m_pcb.snd_nxt = m_pcb.lastack + bytes; }
+
+    /* Go through STARTUP and DRAIN with nothing in flight */
+    void fill_pipe(u64_t bw)
+    {
+        for (int i = 0; i < 4; ++i) {
+            sample(bw);
+        }
+        ASSERT_EQ(BBR_PROBE_BW, lwip_test_bbr_mode(&m_pcb));
+    }
+};
+
+const u64_t tcp_bbr::RTT_US;
+const u64_t tcp_bbr::BW;
+
+/**
+ * @test tcp_bbr.ti_1
+ * @brief
+ *    STARTUP paces with the high gain and grows cwnd by the acked data
+ * @details
+ */
+TEST_F(tcp_bbr, ti_1)
+{
+    /* 2/ln(2) in 1/256 units */
+    const u64_t high_gain = 739U;
+    u64_t bw = BW;
+
+    EXPECT_EQ(BBR_STARTUP, lwip_test_bbr_mode(&m_pcb));
+    EXPECT_EQ(2U * MSS, m_pcb.cwnd);
+    EXPECT_EQ(0x7fffffffU, m_pcb.ssthresh);
+
+    for (int i = 0; i < 5; ++i) {
+        sample(bw);
+        EXPECT_EQ(BBR_STARTUP, lwip_test_bbr_mode(&m_pcb));
+        EXPECT_EQ(bw, lwip_test_bbr_max_bw(&m_pcb));
+        EXPECT_EQ(((bw * high_gain) >> 8) * 99 / 100, m_pcb.pacing_rate);
+        bw *= 2;
+    }
+
+    /* BDP is far above cwnd, every ACK grows it above the 4 segments minimum */
+    ack(MSS);
+    EXPECT_EQ(4U * MSS, m_pcb.cwnd);
+    for (u32_t i = 1; i <= 10; ++i) {
+        ack(MSS);
+        EXPECT_EQ((4U + i) * MSS, m_pcb.cwnd);
+    }
+}
+
+/**
+ * @test tcp_bbr.ti_2
+ * @brief
+ *    Pipe is full after 3 rounds without 25% bandwidth growth
+ * @details
+ *    STARTUP is followed by DRAIN until inflight drops to the BDP,
+ *    then by PROBE_BW.
+ */
+TEST_F(tcp_bbr, ti_2)
+{
+    set_inflight(100 * MSS);
+
+    sample(BW);
+    sample(BW * 5 / 4);
+    for (int i = 0; i < 2; ++i) {
+        sample(BW * 5 / 4 + i * 1000);
+        EXPECT_EQ(BBR_STARTUP, lwip_test_bbr_mode(&m_pcb));
+    }
+    u64_t startup_rate = m_pcb.pacing_rate;
+    EXPECT_GT(startup_rate, BW * 5 / 4);
+
+    sample(BW * 5 / 4);
+    EXPECT_EQ(BBR_DRAIN, lwip_test_bbr_mode(&m_pcb));
+
+    /* The drain gain paces below the bandwidth once the pipe is full */
+    EXPECT_LT(m_pcb.pacing_rate, BW * 5 / 4);
+
+    sample(BW * 5 / 4);
+    EXPECT_EQ(BBR_DRAIN, lwip_test_bbr_mode(&m_pcb));
+
+    /* BDP is 1250 bytes */
+    set_inflight(MSS);
+    sample(BW * 5 / 4);
+    EXPECT_EQ(BBR_PROBE_BW, lwip_test_bbr_mode(&m_pcb));
+}
+
+/**
+ * @test tcp_bbr.ti_3
+ * @brief
+ *    Bandwidth estimate is a windowed max filter
+ * @details
+ *    Application limited samples do not lower the estimate, regular
+ *    samples replace the maximum once it is more than 10 rounds old.
+ */
+TEST_F(tcp_bbr, ti_3)
+{
+    /* The maximum is taken in round 4 */
+    fill_pipe(BW);
+
+    for (int i = 0; i < 5; ++i) {
+        sample(BW / 10, RTT_US, true);
+        EXPECT_EQ(BW, lwip_test_bbr_max_bw(&m_pcb));
+    }
+
+    /* Rounds 10 - 14 */
+    for (int i = 0; i < 5; ++i) {
+        sample(BW / 2);
+        EXPECT_EQ(BW, lwip_test_bbr_max_bw(&m_pcb));
+    }
+    sample(BW / 2);
+    EXPECT_EQ(BW / 2, lwip_test_bbr_max_bw(&m_pcb));
+
+    /* A higher sample is taken at once */
+    sample(BW * 2);
+    EXPECT_EQ(BW * 2, lwip_test_bbr_max_bw(&m_pcb));
+}
+
+/**
+ * @test tcp_bbr.ti_4
+ * @brief
+ *    PROBE_RTT after 10 seconds without a new min RTT
+ * @details
+ *    cwnd is cut to 4 segments for at least 200 msec and one round,
+ *    then restored.
+ */
+TEST_F(tcp_bbr, ti_4)
+{
+    fill_pipe(BW);
+    m_pcb.cwnd = 50 * MSS;
+    set_inflight(2 * MSS);
+
+    /* Higher RTT samples do not refresh the min RTT */
+    for (int i = 0; i < 9; ++i) {
+        sample(BW, 1000000U);
+        EXPECT_EQ(BBR_PROBE_BW, lwip_test_bbr_mode(&m_pcb));
+    }
+    sample(BW, 1000001U);
+    EXPECT_EQ(BBR_PROBE_RTT, lwip_test_bbr_mode(&m_pcb));
+
+    ack(MSS);
+    EXPECT_EQ(4U * MSS, m_pcb.cwnd);
+
+    sample(BW, 100000U);
+    EXPECT_EQ(BBR_PROBE_RTT, lwip_test_bbr_mode(&m_pcb));
+    EXPECT_EQ(4U * MSS, m_pcb.cwnd);
+
+    sample(BW, 100001U);
+    EXPECT_EQ(BBR_PROBE_BW, lwip_test_bbr_mode(&m_pcb));
+    EXPECT_EQ(50U * MSS, m_pcb.cwnd);
+}
+
+/**
+ * @test tcp_bbr.ti_5
+ * @brief
+ *    Loss keeps the data in flight and cwnd is restored after recovery
+ * @details
+ */
+TEST_F(tcp_bbr, ti_5)
+{
+    fill_pipe(BW);
+    m_pcb.cwnd = 50 * MSS;
+    set_inflight(30 * MSS);
+
+    cc_cong_signal(&m_pcb, CC_NDUPACK);
+    EXPECT_EQ(30U * MSS, m_pcb.cwnd);
+    cc_post_recovery(&m_pcb);
+    EXPECT_EQ(50U * MSS, m_pcb.cwnd);
+
+    set_inflight(MSS);
+    cc_cong_signal(&m_pcb, CC_NDUPACK);
+    EXPECT_EQ(4U * MSS, m_pcb.cwnd);
+    cc_post_recovery(&m_pcb);
+    EXPECT_EQ(50U * MSS, m_pcb.cwnd);
+
+    cc_cong_signal(&m_pcb, CC_RTO);
+    EXPECT_EQ((u32_t)MSS, m_pcb.cwnd);
+    cc_post_recovery(&m_pcb);
+    EXPECT_EQ(50U * MSS, m_pcb.cwnd);
+}
+
+#endif /* TCP_CC_ALGO_MOD */
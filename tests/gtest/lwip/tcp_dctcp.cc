@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "lwip_base.h"
+
+#if TCP_CC_ALGO_MOD
+
+/* alpha fixed point of cc_dctcp.c */
+#define ALPHA_MAX 1024U
+
+class tcp_dctcp : public lwip_base {
+protected:
+    tcp_dctcp() { m_cc_algo = CC_MOD_DCTCP; }
+
+    void SetUp() override
+    {
+        lwip_base::SetUp();
+
+        m_pcb.flags |= TF_ECN;
+        m_pcb.ecn_recover = m_pcb.snd_nxt;
+        /* The first observation window is the first flight */
+        m_pcb.snd_nxt += FLIGHT * MSS;
+        cc_conn_init(&m_pcb);
+        m_pcb.snd_nxt -= FLIGHT * MSS;
+        m_alpha = ALPHA_MAX;
+    }
+
+    static const u32_t FLIGHT = 10U;
+
+    void ack(u32_t acked, bool ece)
+    {
+        m_pcb.lastack += acked;
+        m_pcb.acked = acked;
+        m_pcb.ecn_ece = ece;
+        cc_ack_received(&m_pcb, CC_ACK);
+    }
+
+    /* Acknowledge a flight segment by segment, the first 'marked' ACKs carry
+     * ECE. The next flight is in flight meanwhile, so the window ends with the
+     * last ACK and alpha is updated once.
+     */
+    void window(u32_t marked)
+    {
+        m_pcb.snd_nxt = m_pcb.lastack + 2 * FLIGHT * MSS;
+        for (u32_t i = 0; i < FLIGHT; ++i) {
+            EXPECT_EQ(m_alpha, lwip_test_dctcp_alpha(&m_pcb)) << "segment " << i;
+            ack(MSS, i < marked);
+        }
+
+        /* alpha = (1 - g) * alpha + g * F, g = 1/16 */
+        u32_t decay = m_alpha >> 4;
+        m_alpha -= decay ? decay : m_alpha;
+        m_alpha += ((marked * MSS) << 6) / (FLIGHT * MSS);
+        m_alpha = std::min(m_alpha, ALPHA_MAX);
+        EXPECT_EQ(m_alpha, lwip_test_dctcp_alpha(&m_pcb)) << "marked " << marked;
+    }
+
+    u32_t m_alpha;
+};
+
+const u32_t tcp_dctcp::FLIGHT;
+
+/**
+ * @test tcp_dctcp.ti_1
+ * @brief
+ *    alpha follows the fraction of marked bytes once per window
+ * @details
+ */
+TEST_F(tcp_dctcp, ti_1)
+{
+    const u32_t marked[] = {0, 10, 5, 3, 0, 1, 10, 10, 0, 7};
+
+    EXPECT_EQ(ALPHA_MAX, lwip_test_dctcp_alpha(&m_pcb));
+    for (u32_t m : marked) {
+        window(m);
+    }
+}
+
+/**
+ * @test tcp_dctcp.ti_2
+ * @brief
+ *    alpha decays to zero without marks and saturates with all bytes marked
+ * @details
+ */
+TEST_F(tcp_dctcp, ti_2)
+{
+    int windows = 0;
+
+    while (lwip_test_dctcp_alpha(&m_pcb) && windows < 100) {
+        window(0);
+        ++windows;
+    }
+    EXPECT_EQ(0U, lwip_test_dctcp_alpha(&m_pcb));
+    window(0);
+    EXPECT_EQ(0U, lwip_test_dctcp_alpha(&m_pcb));
+
+    /* A single marked window gives g * F */
+    window(FLIGHT);
+    EXPECT_EQ(ALPHA_MAX / 16, lwip_test_dctcp_alpha(&m_pcb));
+
+    for (int i = 0; i < 100; ++i) {
+        window(FLIGHT);
+    }
+    EXPECT_EQ(ALPHA_MAX, lwip_test_dctcp_alpha(&m_pcb));
+}
+
+/**
+ * @test tcp_dctcp.ti_3
+ * @brief
+ *    ECE reduces cwnd by alpha / 2, loss halves it
+ * @details
+ */
+TEST_F(tcp_dctcp, ti_3)
+{
+    m_pcb.cwnd = 100U * MSS;
+    cc_cong_signal(&m_pcb, CC_ECN);
+    EXPECT_EQ(50U * MSS, m_pcb.ssthresh);
+    EXPECT_EQ(50U * MSS, m_pcb.cwnd);
+
+    window(0);
+    window(0);
+    window(2);
+    ASSERT_GT(ALPHA_MAX, m_alpha);
+
+    m_pcb.cwnd = 100U * MSS;
+    cc_cong_signal(&m_pcb, CC_ECN);
+    EXPECT_EQ(100U * MSS - ((100U * MSS * m_alpha) >> 11), m_pcb.cwnd);
+    EXPECT_EQ(m_pcb.cwnd, m_pcb.ssthresh);
+
+    m_pcb.cwnd = 2U * MSS;
+    cc_cong_signal(&m_pcb, CC_ECN);
+    EXPECT_EQ(2U * MSS, m_pcb.cwnd);
+
+    m_pcb.cwnd = 100U * MSS;
+    cc_cong_signal(&m_pcb, CC_NDUPACK);
+    EXPECT_EQ(50U * MSS, m_pcb.ssthresh);
+}
+
+/**
+ * @test tcp_dctcp.ti_4
+ * @brief
+ *    ECE from the peer reduces cwnd once per window and sends CWR
+ * @details
+ */
+TEST_F(tcp_dctcp, ti_4)
+{
+    m_pcb.cwnd = 2U * FLIGHT * MSS;
+    ASSERT_EQ(ERR_OK, write(FLIGHT * MSS));
+    ASSERT_EQ(ERR_OK, tcp_output(&m_pcb));
+    ASSERT_EQ(FLIGHT, m_tx.size());
+
+    /* alpha starts at 1, the first reduction halves cwnd */
+    input(ISS, ISS + MSS, 0, {}, TCP_ACK | TCP_ECE);
+    EXPECT_EQ(FLIGHT * MSS, m_pcb.ssthresh);
+    EXPECT_TRUE(m_pcb.flags & TF_ECN_CWR);
+
+    input(ISS, ISS + 2 * MSS, 0, {}, TCP_ACK | TCP_ECE);
+    EXPECT_EQ(FLIGHT * MSS, m_pcb.ssthresh);
+
+    m_tx.clear();
+    ASSERT_EQ(ERR_OK, write(2 * MSS));
+    ASSERT_EQ(ERR_OK, tcp_output(&m_pcb));
+    ASSERT_EQ(2U, m_tx.size());
+    EXPECT_EQ(ISS + FLIGHT * MSS, m_tx[0].seqno);
+    EXPECT_TRUE(m_tx[0].flags & TCP_CWR);
+    EXPECT_FALSE(m_tx[1].flags & TCP_CWR);
+    EXPECT_FALSE(m_pcb.flags & TF_ECN_CWR);
+
+    /* The next reduction waits for the data sent after the previous one */
+    u32_t ssthresh = m_pcb.ssthresh;
+    input(ISS, ISS + FLIGHT * MSS, 0, {}, TCP_ACK | TCP_ECE);
+    EXPECT_EQ(ssthresh, m_pcb.ssthresh);
+    input(ISS, ISS + (FLIGHT + 1) * MSS, 0, {}, TCP_ACK | TCP_ECE);
+    EXPECT_GT(ssthresh, m_pcb.ssthresh);
+}
+
+/**
+ * @test tcp_dctcp.ti_5
+ * @brief
+ *    The receiver echoes the CE mark of each segment
+ * @details
+ *    Every ACK acknowledges only segments with the same mark and carries ECE
+ *    if they were marked, so a pending delayed ACK is sent before the mark
+ *    changes.
+ */
+TEST_F(tcp_dctcp, ti_5)
+{
+    const bool ce[] = {false, true, true, false, false, false, true, false, true, true, true};
+    const u32_t count = sizeof(ce) / sizeof(ce[0]);
+    u32_t acked = 0;
+
+    for (u32_t i = 0; i < count; ++i) {
+        input(ISS + i * MSS, ISS, MSS, {}, TCP_ACK, ce[i] ? IP_ECN_CE : 0);
+    }
+    tcp_ack_now(&m_pcb);
+    tcp_output(&m_pcb);
+
+    EXPECT_EQ(count * MSS, m_rx_bytes);
+    ASSERT_FALSE(m_tx.empty());
+    EXPECT_EQ(ISS + count * MSS, m_tx.back().ackno);
+    for (const tx_record &tx : m_tx) {
+        u32_t last = (tx.ackno - ISS) / MSS;
+
+        ASSERT_LT(acked, last);
+        for (u32_t i = acked; i < last; ++i) {
+            EXPECT_EQ(ce[i], !!(tx.flags & TCP_ECE)) << "segment " << i << " acked by " << last;
+        }
+        acked = last;
+    }
+}
+
+#endif /* TCP_CC_ALGO_MOD */
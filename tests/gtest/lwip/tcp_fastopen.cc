@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "lwip_base.h"
+
+class tcp_fastopen_test : public lwip_base {
+protected:
+    void SetUp() override
+    {
+        lwip_base::SetUp();
+
+        m_cloned = false;
+        m_accepted = 0;
+        m_connected = 0;
+        memset(&m_cookie, 0, sizeof(m_cookie));
+        m_cookie.len = 8;
+        memcpy(m_cookie.cookie, "cookie!!", m_cookie.len);
+    }
+
+    void TearDown() override
+    {
+        if (m_cloned) {
+            tcp_pcb_purge(&m_child);
+            tcp_tx_preallocted_buffers_free(&m_child);
+        }
+        lwip_base::TearDown();
+    }
+
+    static const u32_t PEER_ISS = 0x10000000U;
+    static const u32_t DATA_LEN = 100U;
+
+    /* m_pcb listens, the connection of a SYN is m_child */
+    void listen()
+    {
+        set_tcp_state(&m_pcb, LISTEN);
+        tcp_clone_conn(&m_pcb, clone_conn);
+        tcp_syn_handled(&m_pcb, syn_handled);
+        tcp_accept(&m_pcb, accept);
+    }
+
+    /* The SYN with data is answered by the regular handshake, the data is
+     * received once the client sends it again after the SYN-ACK */
+    void fallback(struct tcp_fastopen_syn *verdict)
+    {
+        listen();
+        m_pcb.fastopen_syn = verdict;
+        input(PEER_ISS, 0, DATA_LEN, {}, TCP_SYN);
+
+        ASSERT_TRUE(m_cloned);
+        EXPECT_EQ(SYN_RCVD, get_tcp_state(&m_child));
+        EXPECT_FALSE(m_child.flags & TF_FASTOPEN_DATA);
+        EXPECT_EQ(0, m_accepted);
+        EXPECT_EQ(0U, m_rx_bytes);
+
+        /* The SYN-ACK acknowledges the SYN only */
+        ASSERT_EQ(1U, m_tx.size());
+        EXPECT_EQ(TCP_SYN | TCP_ACK, m_tx[0].flags);
+        EXPECT_EQ(PEER_ISS + 1, m_tx[0].ackno);
+
+        input(PEER_ISS + 1, m_tx[0].seqno + 1, DATA_LEN, {}, TCP_ACK, 0, &m_child);
+        EXPECT_EQ(ESTABLISHED, get_tcp_state(&m_child));
+        EXPECT_EQ(1, m_accepted);
+        EXPECT_EQ(DATA_LEN, m_rx_bytes);
+    }
+
+    /* m_pcb connects with the cookie in m_pcb.fastopen and DATA_LEN bytes for the SYN */
+    err_t connect(u32_t &len)
+    {
+        std::vector<char> data(DATA_LEN, 'x');
+        ip_addr_t remote;
+
+        set_tcp_state(&m_pcb, CLOSED);
+        m_pcb.local_ip.ip4.addr = htonl(0xc0000201);
+        remote.ip4.addr = htonl(0xc6336401);
+        len = DATA_LEN;
+        return tcp_connect_fastopen(&m_pcb, &remote, m_pcb.remote_port, false, connected,
+                                    data.data(), &len);
+    }
+
+    struct tcp_pcb m_child;
+    bool m_cloned;
+    int m_accepted;
+    int m_connected;
+    struct tcp_fastopen m_cookie;
+
+private:
+    static err_t clone_conn(void *arg, struct tcp_pcb **newpcb)
+    {
+        tcp_fastopen_test *self = (tcp_fastopen_test *)arg;
+
+        self->pcb_init(&self->m_child);
+        self->m_cloned = true;
+        *newpcb = &self->m_child;
+        return ERR_OK;
+    }
+
+    static err_t syn_handled(void *, struct tcp_pcb *) { return ERR_OK; }
+
+    static err_t accept(void *arg, struct tcp_pcb *, err_t)
+    {
+        ((tcp_fastopen_test *)arg)->m_accepted++;
+        return ERR_OK;
+    }
+
+    static err_t connected(void *arg, struct tcp_pcb *, err_t)
+    {
+        ((tcp_fastopen_test *)arg)->m_connected++;
+        return ERR_OK;
+    }
+};
+
+const u32_t tcp_fastopen_test::PEER_ISS;
+const u32_t tcp_fastopen_test::DATA_LEN;
+
+/**
+ * @test tcp_fastopen_test.ti_1
+ * @brief
+ *    Server delivers the data of a SYN with a valid cookie before the handshake
+ *    completes and accepts the connection once
+ * @details
+ */
+TEST_F(tcp_fastopen_test, ti_1)
+{
+    struct tcp_fastopen_syn verdict;
+
+    listen();
+    memset(&verdict, 0, sizeof(verdict));
+    verdict.accept_data = 1;
+    m_pcb.fastopen_syn = &verdict;
+    input(PEER_ISS, 0, DATA_LEN, {}, TCP_SYN);
+
+    ASSERT_TRUE(m_cloned);
+    EXPECT_EQ(SYN_RCVD, get_tcp_state(&m_child));
+    EXPECT_TRUE(m_child.flags & TF_FASTOPEN_DATA);
+    EXPECT_EQ(1, m_accepted);
+    EXPECT_EQ(DATA_LEN, m_rx_bytes);
+
+    /* The SYN-ACK acknowledges the data */
+    ASSERT_EQ(1U, m_tx.size());
+    EXPECT_EQ(TCP_SYN | TCP_ACK, m_tx[0].flags);
+    EXPECT_EQ(PEER_ISS + 1 + DATA_LEN, m_tx[0].ackno);
+
+    input(PEER_ISS + 1 + DATA_LEN, m_tx[0].seqno + 1, 0, {}, TCP_ACK, 0, &m_child);
+    EXPECT_EQ(ESTABLISHED, get_tcp_state(&m_child));
+    EXPECT_EQ(1, m_accepted);
+    EXPECT_EQ(DATA_LEN, m_rx_bytes);
+}
+
+/**
+ * @test tcp_fastopen_test.ti_2
+ * @brief
+ *    Server falls back to the regular handshake for a SYN with an invalid
+ *    cookie and sends a fresh cookie
+ * @details
+ */
+TEST_F(tcp_fastopen_test, ti_2)
+{
+    struct tcp_fastopen_syn verdict;
+
+    memset(&verdict, 0, sizeof(verdict));
+    verdict.cookie = m_cookie;
+    fallback(&verdict);
+    EXPECT_TRUE(m_child.flags & TF_FASTOPEN);
+}
+
+/**
+ * @test tcp_fastopen_test.ti_3
+ * @brief
+ *    Server ignores the data of a SYN without the Fast Open option
+ * @details
+ */
+TEST_F(tcp_fastopen_test, ti_3)
+{
+    fallback(NULL);
+    EXPECT_FALSE(m_child.flags & TF_FASTOPEN);
+}
+
+/**
+ * @test tcp_fastopen_test.ti_4
+ * @brief
+ *    Client sends the data in the SYN with a cached cookie and doesn't send it
+ *    again when the SYN-ACK acknowledges it
+ * @details
+ */
+TEST_F(tcp_fastopen_test, ti_4)
+{
+    u32_t len;
+
+    m_pcb.fastopen = m_cookie;
+    ASSERT_EQ(ERR_OK, connect(len));
+    EXPECT_EQ(DATA_LEN, len);
+
+    ASSERT_EQ(1U, m_tx.size());
+    EXPECT_EQ(TCP_SYN, m_tx[0].flags);
+    EXPECT_EQ(DATA_LEN, m_tx[0].len);
+    u32_t iss = m_tx[0].seqno;
+
+    m_tx.clear();
+    input(PEER_ISS, iss + 1 + DATA_LEN, 0, {}, TCP_SYN | TCP_ACK);
+    EXPECT_EQ(ESTABLISHED, get_tcp_state(&m_pcb));
+    EXPECT_EQ(1, m_connected);
+    EXPECT_TRUE(m_pcb.flags & TF_FASTOPEN_DATA);
+    EXPECT_TRUE(m_pcb.unacked == NULL);
+    EXPECT_TRUE(m_pcb.unsent == NULL);
+
+    /* Only the ACK of the handshake is sent */
+    ASSERT_EQ(1U, m_tx.size());
+    EXPECT_EQ(0U, m_tx[0].len);
+    EXPECT_EQ(iss + 1 + DATA_LEN, m_tx[0].seqno);
+    EXPECT_EQ(PEER_ISS + 1, m_tx[0].ackno);
+}
+
+/**
+ * @test tcp_fastopen_test.ti_5
+ * @brief
+ *    Client sends the data of the SYN again when the server acknowledges the
+ *    SYN only
+ * @details
+ */
+TEST_F(tcp_fastopen_test, ti_5)
+{
+    u32_t len;
+
+    m_pcb.fastopen = m_cookie;
+    ASSERT_EQ(ERR_OK, connect(len));
+    ASSERT_EQ(1U, m_tx.size());
+    u32_t iss = m_tx[0].seqno;
+
+    m_tx.clear();
+    input(PEER_ISS, iss + 1, 0, {}, TCP_SYN | TCP_ACK);
+    EXPECT_EQ(ESTABLISHED, get_tcp_state(&m_pcb));
+    EXPECT_EQ(1, m_connected);
+    EXPECT_FALSE(m_pcb.flags & TF_FASTOPEN_DATA);
+
+    u32_t sent = 0;
+    for (const tx_record &tx : m_tx) {
+        EXPECT_FALSE(tx.flags & TCP_SYN);
+        if (tx.len > 0) {
+            EXPECT_EQ(iss + 1 + sent, tx.seqno);
+            sent += tx.len;
+        }
+    }
+    EXPECT_EQ(DATA_LEN, sent);
+
+    input(PEER_ISS + 1, iss + 1 + DATA_LEN, 0);
+    EXPECT_TRUE(m_pcb.unacked == NULL);
+    EXPECT_TRUE(m_pcb.unsent == NULL);
+}
+
+/**
+ * @test tcp_fastopen_test.ti_6
+ * @brief
+ *    Client without a cookie requests one and sends no data in the SYN
+ * @details
+ */
+TEST_F(tcp_fastopen_test, ti_6)
+{
+    u32_t len;
+
+    ASSERT_EQ(ERR_OK, connect(len));
+    EXPECT_EQ(0U, len);
+    EXPECT_TRUE(m_pcb.flags & TF_FASTOPEN);
+
+    ASSERT_EQ(1U, m_tx.size());
+    EXPECT_EQ(TCP_SYN, m_tx[0].flags);
+    EXPECT_EQ(0U, m_tx[0].len);
+}
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <functional>
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "lwip_base.h"
+
+#if TCP_QUEUE_OOSEQ
+
+class tcp_ooseq : public lwip_base {
+protected:
+    void SetUp() override
+    {
+        lwip_base::SetUp();
+
+        m_pcb.flags |= TF_SACK;
+    }
+
+    /* Sequence number of the n-th segment from the peer */
+    static u32_t seg(u32_t n) { return ISS + n * MSS; }
+
+    void data(u32_t left, u32_t right) { input(left, m_pcb.snd_nxt, right - left); }
+
+    /* Check the queue against the expected ranges and the tree against the queue */
+    void expect_ooseq(const std::vector<std::pair<u32_t, u32_t>> &expected)
+    {
+        std::vector<struct tcp_seg *> list;
+        std::vector<struct tcp_seg *> tree;
+        std::function<void(struct tcp_seg *)> walk = [&](struct tcp_seg *node) {
+            if (node) {
+                walk(node->oos_left);
+                tree.push_back(node);
+                walk(node->oos_right);
+            }
+        };
+        u32_t bytes = 0;
+
+        for (struct tcp_seg *cur = m_pcb.ooseq; cur; cur = cur->next) {
+            list.push_back(cur);
+        }
+        ASSERT_EQ(expected.size(), list.size());
+        for (size_t i = 0; i < list.size(); ++i) {
+            EXPECT_EQ(expected[i].first, list[i]->tcphdr->seqno) << "range " << i;
+            EXPECT_EQ(expected[i].second - expected[i].first, list[i]->len) << "range " << i;
+            EXPECT_EQ(list[i]->len, list[i]->p->tot_len) << "range " << i;
+            bytes += list[i]->len;
+        }
+        EXPECT_EQ(bytes, m_pcb.ooseq_bytes);
+
+        walk(m_pcb.ooseq_root);
+        EXPECT_TRUE(list == tree);
+
+        for (size_t i = 0; i < list.size(); ++i) {
+            u32_t left = list[i]->tcphdr->seqno;
+            EXPECT_EQ(list[i], tcp_ooseq_lookup(&m_pcb, left));
+            EXPECT_EQ(list[i], tcp_ooseq_lookup(&m_pcb, left + list[i]->len - 1));
+            EXPECT_EQ(i ? list[i - 1] : nullptr, tcp_ooseq_lookup(&m_pcb, left - 1));
+        }
+    }
+
+    void expect_sack(const std::vector<std::pair<u32_t, u32_t>> &expected)
+    {
+        ASSERT_FALSE(m_tx.empty());
+        const tx_record &ack = m_tx.back();
+
+        EXPECT_EQ(m_pcb.rcv_nxt, ack.ackno);
+        ASSERT_EQ(expected.size(), ack.sack.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(expected[i].first, ack.sack[i].left) << "block " << i;
+            EXPECT_EQ(expected[i].second, ack.sack[i].right) << "block " << i;
+        }
+    }
+};
+
+/**
+ * @test tcp_ooseq.ti_1
+ * @brief
+ *    Segments arriving in reverse order are merged into one range
+ * @details
+ *    The missing head segment delivers the whole range.
+ */
+TEST_F(tcp_ooseq, ti_1)
+{
+    for (u32_t i = 20; i > 0; --i) {
+        data(seg(i), seg(i + 1));
+        expect_ooseq({{seg(i), seg(21)}});
+        expect_sack({{seg(i), seg(21)}});
+    }
+    EXPECT_EQ(0U, m_rx_bytes);
+
+    data(seg(0), seg(1));
+    expect_ooseq({});
+    EXPECT_EQ(seg(21), m_pcb.rcv_nxt);
+    EXPECT_EQ(21U * MSS, m_rx_bytes);
+}
+
+/**
+ * @test tcp_ooseq.ti_2
+ * @brief
+ *    Queue stays ordered when the holes are filled in random order
+ * @details
+ *    Every segment is checked against a model of the received ranges.
+ */
+TEST_F(tcp_ooseq, ti_2)
+{
+    const u32_t count = 40;
+    std::vector<bool> received(count + 1, false);
+    std::vector<u32_t> order;
+
+    /* All the odd segments first, then the even ones. The permutations visit
+       every segment as 7 and 9 are coprime with 20 and 19. */
+    for (u32_t i = 0; i < count / 2; ++i) {
+        order.push_back(2 * ((i * 7) % (count / 2)) + 1);
+    }
+    for (u32_t i = 0; i < count / 2 - 1; ++i) {
+        order.push_back(2 * ((i * 9) % (count / 2 - 1)) + 2);
+    }
+
+    for (u32_t n : order) {
+        std::vector<std::pair<u32_t, u32_t>> ranges;
+
+        data(seg(n), seg(n + 1));
+        received[n] = true;
+        for (u32_t i = 1; i <= count; ++i) {
+            if (!received[i]) {
+                continue;
+            }
+            if (!ranges.empty() && ranges.back().second == seg(i)) {
+                ranges.back().second = seg(i + 1);
+            } else {
+                ranges.push_back({seg(i), seg(i + 1)});
+            }
+        }
+        ASSERT_NO_FATAL_FAILURE(expect_ooseq(ranges)) << "segment " << n;
+    }
+    expect_ooseq({{seg(1), seg(count)}});
+
+    data(seg(0), seg(1));
+    expect_ooseq({});
+    EXPECT_EQ(count * MSS, m_rx_bytes);
+}
+
+/**
+ * @test tcp_ooseq.ti_3
+ * @brief
+ *    Lookup returns the range starting at or below the sequence number
+ * @details
+ */
+TEST_F(tcp_ooseq, ti_3)
+{
+    data(seg(6), seg(7));
+    data(seg(2), seg(3));
+    data(seg(4), seg(5));
+
+    EXPECT_EQ(nullptr, tcp_ooseq_lookup(&m_pcb, seg(0)));
+    EXPECT_EQ(nullptr, tcp_ooseq_lookup(&m_pcb, seg(2) - 1));
+    EXPECT_EQ(seg(2), tcp_ooseq_lookup(&m_pcb, seg(2))->tcphdr->seqno);
+    EXPECT_EQ(seg(2), tcp_ooseq_lookup(&m_pcb, seg(3) + 10)->tcphdr->seqno);
+    EXPECT_EQ(seg(4), tcp_ooseq_lookup(&m_pcb, seg(4))->tcphdr->seqno);
+    EXPECT_EQ(seg(6), tcp_ooseq_lookup(&m_pcb, seg(100))->tcphdr->seqno);
+}
+
+/**
+ * @test tcp_ooseq.ti_4
+ * @brief
+ *    Overlapping segments are trimmed and merged
+ * @details
+ */
+TEST_F(tcp_ooseq, ti_4)
+{
+    data(seg(2), seg(3));
+    data(seg(4), seg(5));
+    data(seg(6), seg(7));
+    expect_ooseq({{seg(2), seg(3)}, {seg(4), seg(5)}, {seg(6), seg(7)}});
+
+    /* Overlaps both the first and the second range */
+    data(seg(2) + 500, seg(4) + 500);
+    expect_ooseq({{seg(2), seg(5)}, {seg(6), seg(7)}});
+
+    /* Duplicate */
+    data(seg(6), seg(7));
+    expect_ooseq({{seg(2), seg(5)}, {seg(6), seg(7)}});
+
+    /* Same start, more data */
+    data(seg(6), seg(8));
+    expect_ooseq({{seg(2), seg(5)}, {seg(6), seg(8)}});
+
+    /* Covers everything */
+    data(seg(1), seg(9));
+    expect_ooseq({{seg(1), seg(9)}});
+
+    data(seg(0), seg(1));
+    expect_ooseq({});
+    EXPECT_EQ(9U * MSS, m_rx_bytes);
+}
+
+/**
+ * @test tcp_ooseq.ti_5
+ * @brief
+ *    ACK reports the range of the latest segment first
+ * @details
+ *    The other ranges follow in sequence order, 4 blocks at most.
+ */
+TEST_F(tcp_ooseq, ti_5)
+{
+    data(seg(2), seg(3));
+    expect_sack({{seg(2), seg(3)}});
+
+    data(seg(4), seg(5));
+    data(seg(6), seg(7));
+    data(seg(8), seg(9));
+    data(seg(10), seg(11));
+    expect_sack({{seg(10), seg(11)}, {seg(2), seg(3)}, {seg(4), seg(5)}, {seg(6), seg(7)}});
+
+    data(seg(5), seg(6));
+    expect_sack({{seg(4), seg(7)}, {seg(2), seg(3)}, {seg(8), seg(9)}, {seg(10), seg(11)}});
+
+    /* In order data moves the cumulative ACK */
+    data(seg(0), seg(3));
+    EXPECT_EQ(seg(3), m_pcb.rcv_nxt);
+    expect_ooseq({{seg(4), seg(7)}, {seg(8), seg(9)}, {seg(10), seg(11)}});
+}
+
+#endif /* TCP_QUEUE_OOSEQ */
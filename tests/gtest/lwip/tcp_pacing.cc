@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "lwip_base.h"
+
+#if TCP_CC_ALGO_MOD
+
+class tcp_pacing : public lwip_base {
+protected:
+    void SetUp() override
+    {
+        lwip_base::SetUp();
+
+        m_pcb.cwnd = 0x100000U;
+        m_horizon_us = lwip_tcp_pacing_horizon_us;
+        lwip_tcp_pacing_horizon_us = 0;
+    }
+
+    void TearDown() override
+    {
+        lwip_tcp_pacing_horizon_us = m_horizon_us;
+
+        lwip_base::TearDown();
+    }
+
+    /* 1 MSS per msec */
+    static const u64_t RATE = 1000000U;
+
+    /* Call tcp_output() and return the number of the sent segments */
+    size_t output()
+    {
+        size_t sent = m_tx.size();
+
+        tcp_output(&m_pcb);
+        return m_tx.size() - sent;
+    }
+
+    u32_t m_horizon_us;
+};
+
+const u64_t tcp_pacing::RATE;
+
+/**
+ * @test tcp_pacing.ti_1
+ * @brief
+ *    Unpaced connection sends the whole window at once
+ * @details
+ */
+TEST_F(tcp_pacing, ti_1)
+{
+    ASSERT_EQ(ERR_OK, write(10 * MSS));
+    EXPECT_EQ(10U, output());
+    EXPECT_FALSE(m_pcb.pacing_pending);
+}
+
+/**
+ * @test tcp_pacing.ti_2
+ * @brief
+ *    Segments depart one transmission time apart
+ * @details
+ */
+TEST_F(tcp_pacing, ti_2)
+{
+    m_pcb.max_pacing_rate = RATE;
+
+    ASSERT_EQ(ERR_OK, write(10 * MSS));
+    EXPECT_EQ(1U, output());
+    EXPECT_TRUE(m_pcb.pacing_pending);
+
+    advance_us(999);
+    EXPECT_EQ(0U, output());
+    EXPECT_TRUE(m_pcb.pacing_pending);
+
+    for (int i = 1; i < 10; ++i) {
+        advance_us(i == 1 ? 1 : 1000);
+        EXPECT_EQ(1U, output());
+    }
+    EXPECT_FALSE(m_pcb.pacing_pending);
+
+    ASSERT_EQ(10U, m_tx.size());
+    for (size_t i = 1; i < m_tx.size(); ++i) {
+        EXPECT_EQ(m_tx[i - 1].seqno + MSS, m_tx[i].seqno);
+        EXPECT_EQ(1000U, m_tx[i].time_us - m_tx[i - 1].time_us);
+    }
+}
+
+/**
+ * @test tcp_pacing.ti_3
+ * @brief
+ *    Pacing rate is the lower of the algorithm rate and the user limit
+ * @details
+ */
+TEST_F(tcp_pacing, ti_3)
+{
+    ASSERT_EQ(ERR_OK, write(20 * MSS));
+
+    /* Algorithm rate only */
+    m_pcb.pacing_rate = RATE / 2;
+    EXPECT_EQ(1U, output());
+    advance_us(1999);
+    EXPECT_EQ(0U, output());
+    advance_us(1);
+    EXPECT_EQ(1U, output());
+
+    /* The user limit is higher */
+    m_pcb.max_pacing_rate = RATE;
+    advance_us(1999);
+    EXPECT_EQ(0U, output());
+    advance_us(1);
+    EXPECT_EQ(1U, output());
+
+    /* The user limit is lower */
+    m_pcb.max_pacing_rate = RATE / 4;
+    advance_us(2000);
+    EXPECT_EQ(1U, output());
+    advance_us(3999);
+    EXPECT_EQ(0U, output());
+    advance_us(1);
+    EXPECT_EQ(1U, output());
+}
+
+/**
+ * @test tcp_pacing.ti_4
+ * @brief
+ *    Late release catches up by no more than the horizon
+ * @details
+ */
+TEST_F(tcp_pacing, ti_4)
+{
+    m_pcb.max_pacing_rate = RATE;
+    ASSERT_EQ(ERR_OK, write(20 * MSS));
+    EXPECT_EQ(1U, output());
+
+    /* No horizon, the schedule restarts from now */
+    advance_us(10000);
+    EXPECT_EQ(1U, output());
+
+    lwip_tcp_pacing_horizon_us = 2000;
+    advance_us(10000);
+    EXPECT_EQ(3U, output());
+
+    /* On schedule the horizon doesn't matter */
+    advance_us(1000);
+    EXPECT_EQ(1U, output());
+}
+
+/**
+ * @test tcp_pacing.ti_5
+ * @brief
+ *    Connection with nothing in flight starts a new schedule
+ * @details
+ */
+TEST_F(tcp_pacing, ti_5)
+{
+    m_pcb.max_pacing_rate = RATE;
+    lwip_tcp_pacing_horizon_us = 5000;
+
+    ASSERT_EQ(ERR_OK, write(MSS));
+    EXPECT_EQ(1U, output());
+
+    /* Everything is acked and the connection idles */
+    m_pcb.lastack = m_pcb.snd_nxt;
+    tcp_tx_segs_free(&m_pcb, m_pcb.unacked);
+    m_pcb.unacked = NULL;
+    advance_us(100000);
+
+    ASSERT_EQ(ERR_OK, write(10 * MSS));
+    EXPECT_EQ(1U, output());
+    EXPECT_TRUE(m_pcb.pacing_pending);
+}
+
+/**
+ * @test tcp_pacing.ti_6
+ * @brief
+ *    TSO segment of a paced connection is limited to 1 msec of data
+ * @details
+ *    At least 2 MSS are allowed, so slow connections still use TSO.
+ */
+TEST_F(tcp_pacing, ti_6)
+{
+    m_pcb.tso.max_payload_sz = 0x10000U;
+    m_pcb.tso.max_buf_sz = MSS;
+    m_pcb.max_send_sge = 64U;
+    m_pcb.max_pacing_rate = 20 * RATE;
+
+    ASSERT_EQ(ERR_OK, write(50 * MSS));
+    EXPECT_EQ(1U, output());
+    ASSERT_EQ(1U, m_tx.size());
+    EXPECT_EQ(20U * MSS, m_tx[0].len);
+
+    advance_us(1000);
+    m_pcb.max_pacing_rate = RATE;
+    EXPECT_EQ(1U, output());
+    ASSERT_EQ(2U, m_tx.size());
+    EXPECT_EQ(2U * MSS, m_tx[1].len);
+}
+
+/**
+ * @test tcp_pacing.ti_7
+ * @brief
+ *    Late release catches up by no more than TCP_PACING_CATCHUP_SEGS segments
+ * @details
+ *    The time horizon alone would let this release send 11 segments.
+ */
+TEST_F(tcp_pacing, ti_7)
+{
+    m_pcb.max_pacing_rate = RATE;
+    lwip_tcp_pacing_horizon_us = 10000;
+
+    ASSERT_EQ(ERR_OK, write(40 * MSS));
+    EXPECT_EQ(1U, output());
+
+    advance_us(20000);
+    EXPECT_EQ(TCP_PACING_CATCHUP_SEGS + 1U, output());
+    EXPECT_TRUE(m_pcb.pacing_pending);
+
+    /* Back on schedule */
+    advance_us(1000);
+    EXPECT_EQ(1U, output());
+}
+
+#endif /* TCP_CC_ALGO_MOD */
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "lwip_base.h"
+
+#if LWIP_TCP_RACK_TLP
+
+class tcp_rack : public lwip_base {
+protected:
+    void SetUp() override
+    {
+        lwip_base::SetUp();
+
+        m_pcb.flags |= TF_SACK;
+        m_pcb.cwnd = 100U * MSS;
+        m_rack_tlp = enable_rack_tlp_option;
+        enable_rack_tlp_option = 1;
+        m_start_us = clock_us();
+    }
+
+    void TearDown() override
+    {
+        enable_rack_tlp_option = m_rack_tlp;
+
+        lwip_base::TearDown();
+    }
+
+    static const u32_t FLIGHT = 10U;
+    static const u64_t RTT_US = 10000U;
+    static const u64_t GAP_US = 100U;
+
+    /* Sequence number of the n-th segment */
+    static u32_t seg(u32_t n) { return ISS + n * MSS; }
+
+    /* Send FLIGHT segments GAP_US apart, the first one at m_start_us */
+    void send_flight()
+    {
+        for (u32_t i = 0; i < FLIGHT; ++i) {
+            ASSERT_EQ(ERR_OK, write(MSS));
+            ASSERT_EQ(ERR_OK, tcp_output(&m_pcb));
+            advance_us(GAP_US);
+        }
+        ASSERT_EQ(FLIGHT, m_tx.size());
+        m_tx.clear();
+    }
+
+    void set_time(u64_t us) { advance_us(m_start_us + us - clock_us()); }
+
+    /* Fire the probe timer */
+    void probe()
+    {
+        ASSERT_NE(0U, m_pcb.tlp_timeout_us);
+        advance_us(m_pcb.tlp_timeout_us - clock_us());
+        tcp_rack_tlp_tmr(&m_pcb);
+    }
+
+    u32_t m_rack_tlp;
+    u64_t m_start_us;
+};
+
+const u32_t tcp_rack::FLIGHT;
+const u64_t tcp_rack::RTT_US;
+const u64_t tcp_rack::GAP_US;
+
+/**
+ * @test tcp_rack.ti_1
+ * @brief
+ *    Segments sent before a SACKed one are lost after the reordering window
+ * @details
+ *    The window is RTT / 4 before the recovery and zero in the recovery.
+ */
+TEST_F(tcp_rack, ti_1)
+{
+    const u64_t rtt = RTT_US - 5 * GAP_US;
+    const u64_t reo_wnd = rtt / 4;
+
+    send_flight();
+
+    set_time(RTT_US);
+    input(ISS, seg(0), 0, {{seg(5), seg(6)}});
+    EXPECT_EQ(0U, m_pcb.stat_rack_lost);
+    EXPECT_FALSE(m_pcb.flags & TF_INFR);
+    EXPECT_EQ(rtt, m_pcb.rack_rtt_us);
+    EXPECT_EQ(m_start_us + rtt + reo_wnd, m_pcb.rack_reo_timeout_us);
+
+    /* Only the first segment is out of the window */
+    set_time(rtt + reo_wnd);
+    tcp_rack_tlp_tmr(&m_pcb);
+    EXPECT_EQ(1U, m_pcb.stat_rack_lost);
+    EXPECT_TRUE(m_pcb.flags & TF_INFR);
+    ASSERT_FALSE(m_tx.empty());
+    EXPECT_EQ(seg(0), m_tx[0].seqno);
+    EXPECT_TRUE(m_tx[0].rexmit);
+    EXPECT_EQ(m_start_us + GAP_US + rtt + reo_wnd, m_pcb.rack_reo_timeout_us);
+
+    set_time(GAP_US + rtt + reo_wnd);
+    m_tx.clear();
+    tcp_rack_tlp_tmr(&m_pcb);
+    EXPECT_EQ(5U, m_pcb.stat_rack_lost);
+    ASSERT_EQ(4U, m_tx.size());
+    for (u32_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(seg(i + 1), m_tx[i].seqno);
+        EXPECT_TRUE(m_tx[i].rexmit);
+    }
+    EXPECT_EQ(0U, m_pcb.rack_reo_timeout_us);
+}
+
+/**
+ * @test tcp_rack.ti_2
+ * @brief
+ *    DupThresh SACKed segments close the reordering window
+ * @details
+ *    All the segments sent before the SACKed ones are lost at once.
+ */
+TEST_F(tcp_rack, ti_2)
+{
+    send_flight();
+
+    set_time(RTT_US);
+    input(ISS, seg(0), 0, {{seg(5), seg(8)}});
+    /* The first segment is lost by the SACK scoreboard as well and the fast
+     * retransmit sends it before RACK looks at the segments.
+     */
+    EXPECT_EQ(4U, m_pcb.stat_rack_lost);
+    EXPECT_TRUE(m_pcb.flags & TF_INFR);
+    EXPECT_EQ(RTT_US - 7 * GAP_US, m_pcb.rack_rtt_us);
+    ASSERT_LE(5U, m_tx.size());
+    for (u32_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(seg(i), m_tx[i].seqno);
+        EXPECT_TRUE(m_tx[i].rexmit);
+    }
+}
+
+/**
+ * @test tcp_rack.ti_3
+ * @brief
+ *    Reordering within the window is not a loss
+ * @details
+ */
+TEST_F(tcp_rack, ti_3)
+{
+    send_flight();
+
+    set_time(RTT_US);
+    input(ISS, seg(0), 0, {{seg(5), seg(6)}});
+    ASSERT_NE(0U, m_pcb.rack_reo_timeout_us);
+
+    set_time(RTT_US + 1000);
+    input(ISS, seg(6), 0);
+
+    /* The timer may still fire, but it finds nothing to mark */
+    if (m_pcb.rack_reo_timeout_us) {
+        advance_us(m_pcb.rack_reo_timeout_us - clock_us());
+        tcp_rack_tlp_tmr(&m_pcb);
+    }
+    EXPECT_EQ(0U, m_pcb.stat_rack_lost);
+    EXPECT_FALSE(m_pcb.flags & TF_INFR);
+    EXPECT_EQ(0U, m_pcb.rack_reo_timeout_us);
+    EXPECT_TRUE(m_tx.empty());
+}
+
+/**
+ * @test tcp_rack.ti_4
+ * @brief
+ *    Tail Loss Probe retransmits the last segment and repairs the loss
+ * @details
+ *    The probe timeout is 2 * SRTT. The episode ends with a reduction of
+ *    cwnd once the ACK covers data sent after the probe.
+ */
+TEST_F(tcp_rack, ti_4)
+{
+    u32_t srtt = RTT_US;
+
+    send_flight();
+    /* The timer is armed by the first segment with the initial timeout
+     * before an RTT sample and the delayed ACK allowance.
+     */
+    EXPECT_EQ(m_start_us + TCP_TLP_PTO_INIT_US + TCP_TLP_WCDELACK_US, m_pcb.tlp_timeout_us);
+
+    set_time(RTT_US);
+    input(ISS, seg(5), 0);
+    for (u32_t i = 1; i < 5; ++i) {
+        srtt = srtt - (srtt >> 3) + ((RTT_US - i * GAP_US) >> 3);
+    }
+    EXPECT_EQ(srtt, m_pcb.rack_srtt_us);
+    EXPECT_EQ(clock_us() + 2 * m_pcb.rack_srtt_us, m_pcb.tlp_timeout_us);
+
+    /* The tail is lost, nothing comes back */
+    advance_us(2 * m_pcb.rack_srtt_us);
+    tcp_rack_tlp_tmr(&m_pcb);
+    ASSERT_EQ(1U, m_tx.size());
+    EXPECT_EQ(seg(FLIGHT - 1), m_tx[0].seqno);
+    EXPECT_TRUE(m_tx[0].rexmit);
+    EXPECT_EQ(1U, m_pcb.stat_tlp_probes);
+    EXPECT_TRUE(m_pcb.tlp_outstanding);
+    EXPECT_TRUE(m_pcb.tlp_is_retrans);
+    EXPECT_EQ(seg(FLIGHT), m_pcb.tlp_high_seq);
+    /* A single probe per episode */
+    EXPECT_EQ(0U, m_pcb.tlp_timeout_us);
+
+    ASSERT_EQ(ERR_OK, write(MSS));
+    ASSERT_EQ(ERR_OK, tcp_output(&m_pcb));
+    EXPECT_EQ(0U, m_pcb.tlp_timeout_us);
+
+    u32_t cwnd = m_pcb.cwnd;
+
+    /* The probe acknowledged together with the original of the last segment
+     * leaves the episode open, it is not known which of them arrived.
+     */
+    advance_us(RTT_US);
+    input(ISS, seg(FLIGHT), 0);
+    EXPECT_TRUE(m_pcb.tlp_outstanding);
+    EXPECT_EQ(0U, m_pcb.stat_tlp_recoveries);
+
+    input(ISS, seg(FLIGHT + 1), 0);
+    EXPECT_FALSE(m_pcb.tlp_outstanding);
+    EXPECT_EQ(1U, m_pcb.stat_tlp_recoveries);
+    EXPECT_GT(cwnd, m_pcb.cwnd);
+}
+
+/**
+ * @test tcp_rack.ti_5
+ * @brief
+ *    Episode of an unnecessary probe ends without a cwnd reduction
+ * @details
+ *    A D-SACK of the probe or a duplicate ACK without SACK shows that the
+ *    original segment arrived.
+ */
+TEST_F(tcp_rack, ti_5)
+{
+    for (int dsack = 1; dsack >= 0; --dsack) {
+        send_flight();
+        probe();
+        ASSERT_TRUE(m_pcb.tlp_outstanding);
+        ASSERT_TRUE(m_pcb.tlp_is_retrans);
+
+        u32_t ackno = m_pcb.snd_nxt;
+        u32_t cwnd = m_pcb.cwnd;
+        u32_t probes = m_pcb.stat_tlp_probes;
+
+        if (dsack) {
+            input(ISS, ackno, 0, {{ackno - MSS, ackno}});
+        } else {
+            input(ISS, ackno, 0);
+            EXPECT_TRUE(m_pcb.tlp_outstanding);
+            input(ISS, ackno, 0);
+        }
+        EXPECT_FALSE(m_pcb.tlp_outstanding) << "dsack " << dsack;
+        EXPECT_EQ(0U, m_pcb.stat_tlp_recoveries);
+        EXPECT_LE(cwnd, m_pcb.cwnd);
+        EXPECT_EQ(probes, m_pcb.stat_tlp_probes);
+
+        m_start_us = clock_us();
+        m_tx.clear();
+    }
+}
+
+/**
+ * @test tcp_rack.ti_6
+ * @brief
+ *    Tail Loss Probe sends new data when there is some
+ * @details
+ */
+TEST_F(tcp_rack, ti_6)
+{
+    send_flight();
+    ASSERT_EQ(ERR_OK, write(MSS));
+
+    probe();
+    ASSERT_EQ(1U, m_tx.size());
+    EXPECT_EQ(seg(FLIGHT), m_tx[0].seqno);
+    EXPECT_FALSE(m_tx[0].rexmit);
+    EXPECT_TRUE(m_pcb.tlp_outstanding);
+    EXPECT_FALSE(m_pcb.tlp_is_retrans);
+    EXPECT_EQ(seg(FLIGHT + 1), m_pcb.tlp_high_seq);
+
+    u32_t cwnd = m_pcb.cwnd;
+
+    input(ISS, seg(FLIGHT + 1), 0);
+    EXPECT_FALSE(m_pcb.tlp_outstanding);
+    EXPECT_EQ(0U, m_pcb.stat_tlp_recoveries);
+    EXPECT_LE(cwnd, m_pcb.cwnd);
+}
+
+/**
+ * @test tcp_rack.ti_7
+ * @brief
+ *    Earliest RACK and TLP deadline is reported for the caller's timer
+ * @details
+ *    The deadlines are much shorter than the TCP timer period, the losses
+ *    are detected when the timer is served at the reported deadline.
+ */
+TEST_F(tcp_rack, ti_7)
+{
+    EXPECT_EQ(0U, tcp_rack_tlp_deadline(&m_pcb));
+
+    send_flight();
+    ASSERT_NE(0U, m_pcb.tlp_timeout_us);
+    EXPECT_EQ(0U, m_pcb.rack_reo_timeout_us);
+    EXPECT_EQ(m_pcb.tlp_timeout_us, tcp_rack_tlp_deadline(&m_pcb));
+
+    set_time(RTT_US);
+    input(ISS, seg(0), 0, {{seg(5), seg(6)}});
+    ASSERT_NE(0U, m_pcb.rack_reo_timeout_us);
+    ASSERT_NE(0U, m_pcb.tlp_timeout_us);
+    u64_t deadline = tcp_rack_tlp_deadline(&m_pcb);
+    EXPECT_EQ(std::min(m_pcb.rack_reo_timeout_us, m_pcb.tlp_timeout_us), deadline);
+    EXPECT_GT(100000U, deadline - clock_us());
+
+    advance_us(deadline - clock_us());
+    tcp_rack_tlp_tmr(&m_pcb);
+    EXPECT_EQ(1U, m_pcb.stat_rack_lost);
+    EXPECT_LT(deadline, tcp_rack_tlp_deadline(&m_pcb));
+}
+
+#endif /* LWIP_TCP_RACK_TLP */
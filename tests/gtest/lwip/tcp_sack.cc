@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "lwip_base.h"
+
+#if LWIP_TCP_SACK
+
+class tcp_sack : public lwip_base {
+protected:
+    void SetUp() override
+    {
+        lwip_base::SetUp();
+
+        /* 100 segments are outstanding */
+        m_pcb.flags |= TF_SACK;
+        m_pcb.snd_nxt = ISS + 100 * MSS;
+    }
+
+    /* Sequence number of the n-th outstanding segment */
+    static u32_t seg(u32_t n) { return ISS + n * MSS; }
+
+    void ack(u32_t ackno, std::initializer_list<tcp_sack_block> sack)
+    {
+        std::vector<tcp_sack_block> blocks(sack);
+
+        lwip_test_sack_update(&m_pcb, ackno, blocks.data(), (u8_t)blocks.size());
+        /* tcp_receive() moves lastack after the scoreboard update */
+        if (TCP_SEQ_GT(ackno, m_pcb.lastack) && TCP_SEQ_LEQ(ackno, m_pcb.snd_nxt)) {
+            m_pcb.lastack = ackno;
+        }
+    }
+
+    void expect_scoreboard(std::initializer_list<tcp_sack_block> expected)
+    {
+        u32_t bytes = 0;
+        u8_t i = 0;
+
+        ASSERT_EQ(expected.size(), m_pcb.sack_sb_cnt);
+        for (const tcp_sack_block &block : expected) {
+            EXPECT_EQ(block.left, m_pcb.sack_sb[i].left) << "block " << (int)i;
+            EXPECT_EQ(block.right, m_pcb.sack_sb[i].right) << "block " << (int)i;
+            bytes += block.right - block.left;
+            ++i;
+        }
+        EXPECT_EQ(bytes, m_pcb.sack_bytes);
+    }
+};
+
+/**
+ * @test tcp_sack.ti_1
+ * @brief
+ *    Scoreboard keeps the ranges sorted
+ * @details
+ */
+TEST_F(tcp_sack, ti_1)
+{
+    ack(seg(0), {{seg(10), seg(11)}, {seg(2), seg(3)}});
+    expect_scoreboard({{seg(2), seg(3)}, {seg(10), seg(11)}});
+
+    ack(seg(0), {{seg(20), seg(22)}, {seg(5), seg(6)}, {seg(0) + 1, seg(1)}});
+    expect_scoreboard({{seg(0) + 1, seg(1)},
+                       {seg(2), seg(3)},
+                       {seg(5), seg(6)},
+                       {seg(10), seg(11)},
+                       {seg(20), seg(22)}});
+}
+
+/**
+ * @test tcp_sack.ti_2
+ * @brief
+ *    Overlapping and adjacent ranges are merged
+ * @details
+ */
+TEST_F(tcp_sack, ti_2)
+{
+    ack(seg(0), {{seg(2), seg(3)}, {seg(5), seg(6)}, {seg(8), seg(9)}});
+    expect_scoreboard({{seg(2), seg(3)}, {seg(5), seg(6)}, {seg(8), seg(9)}});
+
+    /* Adjacent to the first range */
+    ack(seg(0), {{seg(3), seg(4)}});
+    expect_scoreboard({{seg(2), seg(4)}, {seg(5), seg(6)}, {seg(8), seg(9)}});
+
+    /* Covers the gap between all the ranges */
+    ack(seg(0), {{seg(3) + 10, seg(8) + 10}});
+    expect_scoreboard({{seg(2), seg(9)}});
+
+    /* Already known */
+    ack(seg(0), {{seg(4), seg(5)}});
+    expect_scoreboard({{seg(2), seg(9)}});
+}
+
+/**
+ * @test tcp_sack.ti_3
+ * @brief
+ *    Cumulative ACK removes and trims the ranges below it
+ * @details
+ */
+TEST_F(tcp_sack, ti_3)
+{
+    ack(seg(0), {{seg(2), seg(3)}, {seg(5), seg(7)}, {seg(9), seg(10)}});
+    expect_scoreboard({{seg(2), seg(3)}, {seg(5), seg(7)}, {seg(9), seg(10)}});
+
+    ack(seg(6), {});
+    expect_scoreboard({{seg(6), seg(7)}, {seg(9), seg(10)}});
+
+    ack(seg(10), {});
+    expect_scoreboard({});
+}
+
+/**
+ * @test tcp_sack.ti_4
+ * @brief
+ *    Blocks outside of the outstanding data are ignored
+ * @details
+ *    D-SACK blocks below the cumulative ACK, blocks above snd_nxt and
+ *    empty blocks do not change the scoreboard.
+ */
+TEST_F(tcp_sack, ti_4)
+{
+    ack(seg(5), {});
+    ASSERT_EQ(seg(5), m_pcb.lastack);
+
+    ack(seg(5), {{seg(3), seg(4)}, {seg(99), seg(101)}, {seg(7), seg(7)}, {seg(8), seg(7)}});
+    expect_scoreboard({});
+
+    /* D-SACK is followed by a regular block */
+    ack(seg(5), {{seg(4), seg(5)}, {seg(7), seg(8)}});
+    expect_scoreboard({{seg(7), seg(8)}});
+}
+
+/**
+ * @test tcp_sack.ti_5
+ * @brief
+ *    New ranges are dropped when the scoreboard is full
+ * @details
+ */
+TEST_F(tcp_sack, ti_5)
+{
+    for (u32_t i = 0; i < TCP_SACK_SB_MAX; ++i) {
+        ack(seg(0), {{seg(2 * i + 1), seg(2 * i + 2)}});
+    }
+    ASSERT_EQ(TCP_SACK_SB_MAX, m_pcb.sack_sb_cnt);
+    EXPECT_EQ((u32_t)TCP_SACK_SB_MAX * MSS, m_pcb.sack_bytes);
+
+    /* No room for a new range */
+    ack(seg(0), {{seg(2 * TCP_SACK_SB_MAX + 1), seg(2 * TCP_SACK_SB_MAX + 2)}});
+    EXPECT_EQ(TCP_SACK_SB_MAX, m_pcb.sack_sb_cnt);
+    EXPECT_EQ(seg(2 * TCP_SACK_SB_MAX), m_pcb.sack_sb[TCP_SACK_SB_MAX - 1].right);
+
+    /* Merging into the existing ranges still works */
+    ack(seg(0), {{seg(1), seg(4)}});
+    EXPECT_EQ(TCP_SACK_SB_MAX - 1, m_pcb.sack_sb_cnt);
+    EXPECT_EQ(seg(1), m_pcb.sack_sb[0].left);
+    EXPECT_EQ(seg(4), m_pcb.sack_sb[0].right);
+}
+
+/**
+ * @test tcp_sack.ti_6
+ * @brief
+ *    Data is lost once DupThresh ranges are SACKed above it
+ * @details
+ */
+TEST_F(tcp_sack, ti_6)
+{
+    ack(seg(0), {{seg(2), seg(3)}, {seg(4), seg(5)}});
+    EXPECT_FALSE(tcp_sack_is_lost(&m_pcb, seg(0)));
+
+    ack(seg(0), {{seg(6), seg(7)}});
+    EXPECT_TRUE(tcp_sack_is_lost(&m_pcb, seg(0)));
+    EXPECT_TRUE(tcp_sack_is_lost(&m_pcb, seg(1)));
+    /* Only two ranges are above the hole at seg(3) */
+    EXPECT_FALSE(tcp_sack_is_lost(&m_pcb, seg(3)));
+    EXPECT_FALSE(tcp_sack_is_lost(&m_pcb, seg(7)));
+}
+
+/**
+ * @test tcp_sack.ti_7
+ * @brief
+ *    Data is lost once more than (DupThresh - 1) * MSS bytes are SACKed above it
+ * @details
+ */
+TEST_F(tcp_sack, ti_7)
+{
+    const u32_t limit = (TCP_SACK_DUPTHRESH - 1) * MSS;
+
+    ack(seg(0), {{seg(1), seg(1) + limit}});
+    EXPECT_FALSE(tcp_sack_is_lost(&m_pcb, seg(0)));
+
+    ack(seg(0), {{seg(1), seg(1) + limit + 1}});
+    EXPECT_TRUE(tcp_sack_is_lost(&m_pcb, seg(0)));
+
+    /* Only the part of the range above seqno counts */
+    EXPECT_FALSE(tcp_sack_is_lost(&m_pcb, seg(1) + 1));
+    EXPECT_FALSE(tcp_sack_is_lost(&m_pcb, seg(1) + limit + 1));
+}
+
+#endif /* LWIP_TCP_SACK */
@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <set>
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/dev/buffer_pool_cache.h"
+
+struct cache_buf {
+    cache_buf *p_next_desc;
+};
+
+#define CACHE_TEST_POOLS 3
+
+typedef buffer_cache<cache_buf> test_cache_t;
+typedef buffer_thread_caches<cache_buf, CACHE_TEST_POOLS> test_thread_caches_t;
+
+class buffer_pool_cache_test : public mix_base {
+protected:
+    void SetUp() override
+    {
+        mix_base::SetUp();
+
+        m_bufs.resize(256);
+        INIT_LIST_HEAD(&m_threads);
+    }
+
+    static void init(test_cache_t &cache)
+    {
+        cache.head = NULL;
+        cache.tail = NULL;
+        cache.count = 0;
+    }
+
+    // Check the list links count buffers and ends at last
+    static void check_list(cache_buf *first, cache_buf *last, size_t count)
+    {
+        cache_buf *buff = first;
+
+        for (size_t i = 1; i < count; i++) {
+            ASSERT_TRUE(buff != NULL);
+            buff = buff->p_next_desc;
+        }
+        EXPECT_EQ(last, buff);
+        if (buff) {
+            EXPECT_EQ(NULL, buff->p_next_desc);
+        }
+    }
+
+    static void check_cache(test_cache_t &cache)
+    {
+        if (cache.count) {
+            check_list(cache.head, cache.tail, cache.count);
+        } else {
+            EXPECT_EQ(NULL, cache.head);
+        }
+    }
+
+    // Link m_bufs[from, from + n) into a list
+    void make_list(size_t from, size_t n, cache_buf *&first, cache_buf *&last)
+    {
+        for (size_t i = from; i < from + n; i++) {
+            m_bufs[i].p_next_desc = (i + 1 < from + n) ? &m_bufs[i + 1] : NULL;
+        }
+        first = &m_bufs[from];
+        last = &m_bufs[from + n - 1];
+    }
+
+    std::vector<cache_buf> m_bufs;
+    struct list_head m_threads;
+};
+
+/**
+ * @test buffer_pool_cache_test.ti_1
+ * @brief
+ *    Cache is a LIFO stack
+ * @details
+ *    The last freed buffer is the hottest and is reused first.
+ */
+TEST_F(buffer_pool_cache_test, ti_1)
+{
+    test_cache_t cache;
+
+    init(cache);
+    for (size_t i = 0; i < 4; i++) {
+        cache.push(&m_bufs[i]);
+        EXPECT_EQ(&m_bufs[0], cache.tail);
+        check_cache(cache);
+    }
+    EXPECT_EQ(4U, cache.count);
+
+    for (size_t i = 4; i > 0; i--) {
+        cache_buf *buff = cache.pop();
+        EXPECT_EQ(&m_bufs[i - 1], buff);
+        EXPECT_EQ(NULL, buff->p_next_desc);
+    }
+    EXPECT_EQ(0U, cache.count);
+    EXPECT_EQ(NULL, cache.head);
+
+    cache.push(&m_bufs[5]);
+    EXPECT_EQ(&m_bufs[5], cache.tail);
+    check_cache(cache);
+}
+
+/**
+ * @test buffer_pool_cache_test.ti_2
+ * @brief
+ *    Refill puts a batch from the pool on top of the cache
+ * @details
+ */
+TEST_F(buffer_pool_cache_test, ti_2)
+{
+    test_cache_t cache;
+    cache_buf *first, *last;
+
+    init(cache);
+    make_list(0, 8, first, last);
+    cache.push_list(first, last, 8);
+    EXPECT_EQ(8U, cache.count);
+    EXPECT_EQ(&m_bufs[0], cache.head);
+    EXPECT_EQ(&m_bufs[7], cache.tail);
+    check_cache(cache);
+
+    // The cached buffers stay below the new batch
+    make_list(8, 4, first, last);
+    cache.push_list(first, last, 4);
+    EXPECT_EQ(12U, cache.count);
+    EXPECT_EQ(&m_bufs[8], cache.head);
+    EXPECT_EQ(&m_bufs[7], cache.tail);
+    EXPECT_EQ(&m_bufs[0], m_bufs[11].p_next_desc);
+    check_cache(cache);
+
+    for (size_t i = 0; i < 12; i++) {
+        cache.pop();
+    }
+    EXPECT_EQ(0U, cache.count);
+    EXPECT_EQ(NULL, cache.head);
+}
+
+/**
+ * @test buffer_pool_cache_test.ti_3
+ * @brief
+ *    Flush returns the cold bottom part and keeps the hot buffers
+ * @details
+ */
+TEST_F(buffer_pool_cache_test, ti_3)
+{
+    test_cache_t cache;
+    cache_buf *first, *last;
+
+    init(cache);
+    for (size_t i = 0; i < 10; i++) {
+        cache.push(&m_bufs[i]);
+    }
+
+    EXPECT_EQ(7U, cache.trim(3, first, last));
+    EXPECT_EQ(3U, cache.count);
+    EXPECT_EQ(&m_bufs[9], cache.head);
+    EXPECT_EQ(&m_bufs[7], cache.tail);
+    check_cache(cache);
+
+    EXPECT_EQ(&m_bufs[6], first);
+    EXPECT_EQ(&m_bufs[0], last);
+    check_list(first, last, 7);
+
+    // The cache keeps working after a flush
+    cache.push(&m_bufs[20]);
+    EXPECT_EQ(4U, cache.count);
+    EXPECT_EQ(&m_bufs[7], cache.tail);
+    check_cache(cache);
+}
+
+/**
+ * @test buffer_pool_cache_test.ti_4
+ * @brief
+ *    Flush of the whole cache
+ * @details
+ *    This is what a thread does on exit.
+ */
+TEST_F(buffer_pool_cache_test, ti_4)
+{
+    test_cache_t cache;
+    cache_buf *first, *last;
+
+    init(cache);
+    for (size_t i = 0; i < 5; i++) {
+        cache.push(&m_bufs[i]);
+    }
+
+    EXPECT_EQ(5U, cache.trim(0, first, last));
+    EXPECT_EQ(0U, cache.count);
+    EXPECT_EQ(NULL, cache.head);
+    EXPECT_EQ(&m_bufs[4], first);
+    EXPECT_EQ(&m_bufs[0], last);
+    check_list(first, last, 5);
+
+    make_list(10, 2, first, last);
+    cache.push_list(first, last, 2);
+    EXPECT_EQ(&m_bufs[11], cache.tail);
+    check_cache(cache);
+}
+
+/**
+ * @test buffer_pool_cache_test.ti_5
+ * @brief
+ *    Pool teardown drains its caches of all threads
+ * @details
+ *    Caches of other pools are left intact, empty caches are skipped.
+ */
+TEST_F(buffer_pool_cache_test, ti_5)
+{
+    test_thread_caches_t threads[4];
+    cache_buf *first, *last;
+    size_t used = 0;
+
+    memset(threads, 0, sizeof(threads));
+    for (size_t t = 0; t < 4; t++) {
+        list_add_tail(&threads[t].node, &m_threads);
+    }
+
+    // Thread 2 has nothing in the cache of pool 1
+    for (size_t t = 0; t < 4; t++) {
+        for (int id = 0; id < CACHE_TEST_POOLS; id++) {
+            size_t n = (t == 2 && id == 1) ? 0 : t + 1;
+            for (size_t i = 0; i < n; i++) {
+                threads[t].cache[id].push(&m_bufs[used++]);
+            }
+        }
+    }
+
+    size_t n = buffer_thread_caches_drain<cache_buf, CACHE_TEST_POOLS>(&m_threads, 1, first, last);
+    EXPECT_EQ(1U + 2U + 4U, n);
+    check_list(first, last, n);
+
+    std::set<cache_buf *> drained;
+    for (cache_buf *buff = first; buff; buff = buff->p_next_desc) {
+        EXPECT_TRUE(drained.insert(buff).second);
+    }
+    EXPECT_EQ(n, drained.size());
+
+    for (size_t t = 0; t < 4; t++) {
+        EXPECT_EQ(0U, threads[t].cache[1].count);
+        EXPECT_EQ(t + 1, threads[t].cache[0].count);
+        EXPECT_EQ(t + 1, threads[t].cache[2].count);
+        check_cache(threads[t].cache[0]);
+        check_cache(threads[t].cache[2]);
+    }
+
+    // Nothing is left to drain
+    EXPECT_EQ(0U,
+              (buffer_thread_caches_drain<cache_buf, CACHE_TEST_POOLS>(&m_threads, 1, first, last)));
+    EXPECT_EQ(NULL, first);
+}
+
+static pthread_mutex_t s_threads_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread test_thread_caches_t t_test_caches;
+
+struct cache_thread_arg {
+    struct list_head *threads;
+    pthread_barrier_t *barrier;
+    cache_buf *bufs;
+    size_t count;
+};
+
+static void *cache_thread(void *arg)
+{
+    cache_thread_arg *ctx = (cache_thread_arg *)arg;
+
+    pthread_mutex_lock(&s_threads_lock);
+    list_add_tail(&t_test_caches.node, ctx->threads);
+    pthread_mutex_unlock(&s_threads_lock);
+
+    // Cache churn which leaves every other buffer in the cache
+    test_cache_t &cache = t_test_caches.cache[0];
+    for (size_t i = 0; i < ctx->count; i++) {
+        cache.push(&ctx->bufs[i]);
+        if (i % 2) {
+            cache.pop();
+            cache.push(&ctx->bufs[i]);
+        }
+    }
+    for (size_t i = 0; i < ctx->count / 2; i++) {
+        cache.pop();
+    }
+
+    // The thread stays alive until its cache is drained
+    pthread_barrier_wait(ctx->barrier);
+    pthread_barrier_wait(ctx->barrier);
+
+    pthread_mutex_lock(&s_threads_lock);
+    list_del(&t_test_caches.node);
+    pthread_mutex_unlock(&s_threads_lock);
+    return NULL;
+}
+
+/**
+ * @test buffer_pool_cache_test.ti_6
+ * @brief
+ *    Buffers left in the caches of running threads are drained once
+ * @details
+ *    The threads are idle, as they are when the pools are destroyed.
+ */
+TEST_F(buffer_pool_cache_test, ti_6)
+{
+    const size_t threads_num = 4;
+    const size_t per_thread = m_bufs.size() / threads_num;
+    pthread_t threads[threads_num];
+    cache_thread_arg args[threads_num];
+    pthread_barrier_t barrier;
+    cache_buf *first, *last;
+
+    ASSERT_EQ(0, pthread_barrier_init(&barrier, NULL, threads_num + 1));
+    for (size_t t = 0; t < threads_num; t++) {
+        args[t].threads = &m_threads;
+        args[t].barrier = &barrier;
+        args[t].bufs = &m_bufs[t * per_thread];
+        args[t].count = per_thread;
+        ASSERT_EQ(0, pthread_create(&threads[t], NULL, cache_thread, &args[t]));
+    }
+    pthread_barrier_wait(&barrier);
+
+    pthread_mutex_lock(&s_threads_lock);
+    size_t n = buffer_thread_caches_drain<cache_buf, CACHE_TEST_POOLS>(&m_threads, 0, first, last);
+    pthread_mutex_unlock(&s_threads_lock);
+
+    pthread_barrier_wait(&barrier);
+    for (size_t t = 0; t < threads_num; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+
+    EXPECT_EQ(threads_num * (per_thread - per_thread / 2), n);
+    check_list(first, last, n);
+
+    std::set<cache_buf *> drained;
+    for (cache_buf *buff = first; buff; buff = buff->p_next_desc) {
+        EXPECT_TRUE(drained.insert(buff).second);
+    }
+    EXPECT_EQ(n, drained.size());
+    EXPECT_TRUE(list_empty(&m_threads));
+}
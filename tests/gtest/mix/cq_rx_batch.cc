@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/xlio_stats.h"
+#include "src/core/util/sys_vars.h"
+
+class cq_rx_batch : public mix_base {
+};
+
+/**
+ * @test cq_rx_batch.ti_1
+ * @brief
+ *    Polls are counted in log2 buckets
+ * @details
+ *    Bucket i counts polls of 2^i ... 2^(i+1) - 1 completions, as labeled
+ *    by xlio_stats.
+ */
+TEST_F(cq_rx_batch, ti_1)
+{
+    EXPECT_EQ(0U, cq_rx_batch_bucket(1));
+    EXPECT_EQ(1U, cq_rx_batch_bucket(2));
+    EXPECT_EQ(1U, cq_rx_batch_bucket(3));
+    EXPECT_EQ(2U, cq_rx_batch_bucket(4));
+    EXPECT_EQ(3U, cq_rx_batch_bucket(15));
+    EXPECT_EQ(4U, cq_rx_batch_bucket(16));
+    EXPECT_EQ(6U, cq_rx_batch_bucket(127));
+
+    for (uint32_t i = 0; i < NUM_OF_CQ_RX_BATCH_BUCKETS - 1U; i++) {
+        EXPECT_EQ(i, cq_rx_batch_bucket(1U << i));
+        EXPECT_EQ(i, cq_rx_batch_bucket((2U << i) - 1U));
+    }
+}
+
+/**
+ * @test cq_rx_batch.ti_2
+ * @brief
+ *    The largest poll falls into the last bucket
+ * @details
+ *    Larger numbers never index past the histogram.
+ */
+TEST_F(cq_rx_batch, ti_2)
+{
+    EXPECT_EQ(NUM_OF_CQ_RX_BATCH_BUCKETS - 1U, cq_rx_batch_bucket(MCE_MAX_CQ_POLL_BATCH));
+    EXPECT_EQ(NUM_OF_CQ_RX_BATCH_BUCKETS - 1U, cq_rx_batch_bucket(MCE_MAX_CQ_POLL_BATCH + 1U));
+    EXPECT_EQ(NUM_OF_CQ_RX_BATCH_BUCKETS - 1U, cq_rx_batch_bucket(0xFFFFFFFFU));
+}
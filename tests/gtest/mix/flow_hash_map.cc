@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <map>
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/flow_hash_map.h"
+
+struct flow_hash_key {
+    uint64_t value;
+
+    size_t hash() const { return static_cast<size_t>(value); }
+    bool operator==(const flow_hash_key &other) const { return value == other.value; }
+};
+
+class flow_hash_map_test : public mix_base {
+protected:
+    void SetUp() override
+    {
+        mix_base::SetUp();
+
+        m_values.resize(1024);
+    }
+
+    // Same mixing as flow_hash_map::home()
+    static size_t home(uint64_t h, size_t mask)
+    {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<size_t>(h) & mask;
+    }
+
+    // Keys which all hash to the given slot of a table with FLOW_HASH_MAP_INIT_SIZE slots
+    static std::vector<flow_hash_key> colliding_keys(size_t slot, size_t count)
+    {
+        std::vector<flow_hash_key> keys;
+
+        for (uint64_t v = 1; keys.size() < count; v++) {
+            if (home(v, FLOW_HASH_MAP_INIT_SIZE - 1) == slot) {
+                keys.push_back(flow_hash_key {v});
+            }
+        }
+        return keys;
+    }
+
+    int *value(size_t i) { return &m_values[i]; }
+
+    std::vector<int> m_values;
+};
+
+/**
+ * @test flow_hash_map_test.ti_1
+ * @brief
+ *    Insert, replace, find and erase
+ * @details
+ */
+TEST_F(flow_hash_map_test, ti_1)
+{
+    flow_hash_map<flow_hash_key, int *> map;
+
+    EXPECT_EQ(0U, map.size());
+    EXPECT_EQ(NULL, map.find(flow_hash_key {1}));
+
+    map.set(flow_hash_key {1}, value(1));
+    map.set(flow_hash_key {2}, value(2));
+    EXPECT_EQ(2U, map.size());
+    EXPECT_EQ(value(1), map.find(flow_hash_key {1}));
+    EXPECT_EQ(value(2), map.find(flow_hash_key {2}));
+
+    map.set(flow_hash_key {1}, value(3));
+    EXPECT_EQ(2U, map.size());
+    EXPECT_EQ(value(3), map.find(flow_hash_key {1}));
+
+    EXPECT_TRUE(map.erase(flow_hash_key {1}));
+    EXPECT_FALSE(map.erase(flow_hash_key {1}));
+    EXPECT_EQ(1U, map.size());
+    EXPECT_EQ(NULL, map.find(flow_hash_key {1}));
+    EXPECT_EQ(value(2), map.find(flow_hash_key {2}));
+
+    map.clear();
+    EXPECT_EQ(0U, map.size());
+    EXPECT_EQ(NULL, map.find(flow_hash_key {2}));
+}
+
+/**
+ * @test flow_hash_map_test.ti_2
+ * @brief
+ *    Erase from a cluster which wraps around the end of the table
+ * @details
+ *    All keys share the last slot, so the probe sequence continues from
+ *    slot 0. Every erase order must keep the remaining keys reachable.
+ */
+TEST_F(flow_hash_map_test, ti_2)
+{
+    const size_t count = FLOW_HASH_MAP_INIT_SIZE / 2;
+    std::vector<flow_hash_key> keys = colliding_keys(FLOW_HASH_MAP_INIT_SIZE - 1, count);
+
+    for (size_t first = 0; first < count; first++) {
+        flow_hash_map<flow_hash_key, int *> map;
+
+        for (size_t i = 0; i < count; i++) {
+            map.set(keys[i], value(i));
+        }
+        ASSERT_EQ(count, map.size());
+
+        // Erase starting from 'first' and wrapping around the key list
+        for (size_t n = 0; n < count; n++) {
+            size_t victim = (first + n) % count;
+
+            EXPECT_TRUE(map.erase(keys[victim]));
+            EXPECT_EQ(NULL, map.find(keys[victim]));
+            for (size_t i = n + 1; i < count; i++) {
+                size_t left = (first + i) % count;
+                EXPECT_EQ(value(left), map.find(keys[left]));
+            }
+        }
+        EXPECT_EQ(0U, map.size());
+    }
+}
+
+/**
+ * @test flow_hash_map_test.ti_3
+ * @brief
+ *    Keys of a wrapped cluster and of slot 0 mixed together
+ * @details
+ *    Entries homed at slot 0 are pushed behind the wrapped entries, erasing
+ *    a wrapped entry must not move them before their home slot.
+ */
+TEST_F(flow_hash_map_test, ti_3)
+{
+    std::vector<flow_hash_key> tail = colliding_keys(FLOW_HASH_MAP_INIT_SIZE - 1, 3);
+    std::vector<flow_hash_key> head = colliding_keys(0, 3);
+    flow_hash_map<flow_hash_key, int *> map;
+
+    for (size_t i = 0; i < 3; i++) {
+        map.set(tail[i], value(i));
+        map.set(head[i], value(10 + i));
+    }
+    EXPECT_EQ(6U, map.size());
+
+    EXPECT_TRUE(map.erase(tail[0]));
+    EXPECT_TRUE(map.erase(head[1]));
+    EXPECT_TRUE(map.erase(tail[2]));
+
+    EXPECT_EQ(value(1), map.find(tail[1]));
+    EXPECT_EQ(value(10), map.find(head[0]));
+    EXPECT_EQ(value(12), map.find(head[2]));
+    EXPECT_EQ(NULL, map.find(tail[0]));
+    EXPECT_EQ(NULL, map.find(head[1]));
+    EXPECT_EQ(NULL, map.find(tail[2]));
+    EXPECT_EQ(3U, map.size());
+}
+
+/**
+ * @test flow_hash_map_test.ti_4
+ * @brief
+ *    Fully loaded table grows and keeps all entries
+ * @details
+ *    The table holds at most half of its slots, inserting into a fully
+ *    loaded table rehashes it. Colliding keys make the worst case cluster.
+ */
+TEST_F(flow_hash_map_test, ti_4)
+{
+    const size_t count = FLOW_HASH_MAP_INIT_SIZE / 2;
+    std::vector<flow_hash_key> keys = colliding_keys(FLOW_HASH_MAP_INIT_SIZE - 1, count + 1);
+    flow_hash_map<flow_hash_key, int *> map;
+
+    for (size_t i = 0; i < count; i++) {
+        map.set(keys[i], value(i));
+    }
+    EXPECT_EQ(count, map.size());
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_EQ(value(i), map.find(keys[i]));
+    }
+    EXPECT_EQ(NULL, map.find(keys[count]));
+
+    // Replacing a value of a fully loaded table does not grow it
+    map.set(keys[0], value(100));
+    EXPECT_EQ(value(100), map.find(keys[0]));
+
+    map.set(keys[count], value(count));
+    EXPECT_EQ(count + 1, map.size());
+    for (size_t i = 1; i <= count; i++) {
+        EXPECT_EQ(value(i), map.find(keys[i]));
+    }
+
+    size_t visited = 0;
+    map.for_each([&visited](const flow_hash_key &, int *) { visited++; });
+    EXPECT_EQ(count + 1, visited);
+}
+
+/**
+ * @test flow_hash_map_test.ti_5
+ * @brief
+ *    Random insert and erase churn matches std::map
+ * @details
+ */
+TEST_F(flow_hash_map_test, ti_5)
+{
+    flow_hash_map<flow_hash_key, int *> map;
+    std::map<uint64_t, int *> ref;
+
+    srand(1);
+    for (int i = 0; i < 20000; i++) {
+        uint64_t key = rand() % 512;
+        int *val = value(rand() % m_values.size());
+
+        if (rand() % 3) {
+            map.set(flow_hash_key {key}, val);
+            ref[key] = val;
+        } else {
+            EXPECT_EQ(ref.erase(key) == 1, map.erase(flow_hash_key {key}));
+        }
+        ASSERT_EQ(ref.size(), map.size());
+    }
+    for (uint64_t key = 0; key < 512; key++) {
+        auto itr = ref.find(key);
+        EXPECT_EQ(itr == ref.end() ? NULL : itr->second, map.find(flow_hash_key {key}));
+    }
+}
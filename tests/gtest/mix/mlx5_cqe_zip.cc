@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#if defined(DEFINED_DIRECT_VERBS)
+
+#include "src/core/ib/mlx5/ib_mlx5.h"
+
+#define CQE_NUM 16U
+
+class mlx5_cqe_zip_test : public mix_base {
+public:
+    xlio_mlx5_cqe cqes[CQE_NUM];
+    xlio_ib_mlx5_cq_t cq;
+    xlio_mlx5_cqe_zip zip;
+
+    mlx5_cqe_zip_test()
+    {
+        memset(cqes, 0, sizeof(cqes));
+        for (uint32_t i = 0; i < CQE_NUM; i++) {
+            cqes[i].op_own = MLX5_CQE_INVALID << 4;
+        }
+        memset(&cq, 0, sizeof(cq));
+        cq.cq_buf = cqes;
+        cq.cqe_count = CQE_NUM;
+        cq.cqe_size = sizeof(xlio_mlx5_cqe);
+        cq.cqe_size_log = 6;
+        memset(&zip, 0, sizeof(zip));
+    }
+
+    /* Write a compressed session of cnt packets at index ci, packet i has byte count
+     * 100 + i. Mini CQE arrays follow the header and then every 8 slots.
+     */
+    void write_session(uint32_t ci, uint32_t cnt)
+    {
+        xlio_mlx5_cqe *hdr = &cqes[ci % CQE_NUM];
+
+        hdr->byte_cnt = htonl(cnt);
+        hdr->flow_table_metadata = htonl(0x1234);
+        hdr->hds_ip_ext = MLX5_CQE_L3_OK | MLX5_CQE_L4_OK;
+        hdr->op_own = (MLX5_CQE_RESP_SEND << 4) | (XLIO_MLX5_CQE_FORMAT_COMPRESSED << 2) |
+            (!!(ci & CQE_NUM));
+        for (uint32_t i = 0; i < cnt; i++) {
+            uint32_t array = i / XLIO_MLX5_MINI_CQE_ARRAY_SIZE;
+            uint32_t slot = (ci + (array ? array * XLIO_MLX5_MINI_CQE_ARRAY_SIZE : 1)) % CQE_NUM;
+            xlio_mlx5_mini_cqe8 *mini = (xlio_mlx5_mini_cqe8 *)&cqes[slot];
+            mini[i % XLIO_MLX5_MINI_CQE_ARRAY_SIZE].byte_cnt = htonl(100 + i);
+        }
+    }
+
+    void expand_session(uint32_t ci, uint32_t cnt)
+    {
+        cq.cq_ci = ci;
+        write_session(ci, cnt);
+
+        xlio_mlx5_cqe *cqe = xlio_ib_mlx5_cqe_at(&cq, cq.cq_ci);
+        ASSERT_TRUE(xlio_ib_mlx5_cqe_is_compressed(cqe));
+        xlio_ib_mlx5_cqe_zip_open(&zip, &cq, cqe);
+        ASSERT_EQ(cnt, zip.cnt);
+
+        for (uint32_t i = 0; i < cnt; i++) {
+            EXPECT_EQ(ci, cq.cq_ci);
+            cqe = xlio_ib_mlx5_cqe_zip_next(&zip, &cq);
+            EXPECT_EQ(100 + i, ntohl(cqe->byte_cnt));
+            EXPECT_EQ(0x1234U, ntohl(cqe->flow_table_metadata));
+            EXPECT_EQ(MLX5_CQE_L3_OK | MLX5_CQE_L4_OK, cqe->hds_ip_ext);
+            EXPECT_EQ(MLX5_CQE_RESP_SEND, cqe->op_own >> 4);
+        }
+
+        EXPECT_EQ(0U, zip.cnt);
+        EXPECT_EQ(ci + cnt, cq.cq_ci);
+        for (uint32_t i = 0; i < cnt; i++) {
+            EXPECT_EQ(MLX5_CQE_INVALID << 4, cqes[(ci + i) % CQE_NUM].op_own);
+        }
+    }
+};
+
+//! Regular CQE is not taken for a compressed session
+TEST_F(mlx5_cqe_zip_test, ti_1)
+{
+    cqes[0].op_own = MLX5_CQE_RESP_SEND << 4;
+    EXPECT_FALSE(xlio_ib_mlx5_cqe_is_compressed(&cqes[0]));
+
+    cqes[0].op_own |= XLIO_MLX5_CQE_FORMAT_COMPRESSED << 2;
+    EXPECT_TRUE(xlio_ib_mlx5_cqe_is_compressed(&cqes[0]));
+}
+
+//! Session that fits a single mini CQE array
+TEST_F(mlx5_cqe_zip_test, ti_2)
+{
+    expand_session(2, 5);
+}
+
+//! Session with several mini CQE arrays
+TEST_F(mlx5_cqe_zip_test, ti_3)
+{
+    expand_session(0, 14);
+}
+
+//! Session that wraps around the end of the CQ
+TEST_F(mlx5_cqe_zip_test, ti_4)
+{
+    expand_session(CQE_NUM + 12, 10);
+}
+
+#endif /* DEFINED_DIRECT_VERBS */
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/dev/mpw_session.h"
+
+struct mpw_buf {
+    mpw_buf *p_next_desc;
+};
+
+class mpw_session_test : public mix_base {
+protected:
+    typedef mpw_session<mpw_buf> session_t;
+
+    enum { WQEBB = 64, SQ_WQEBBS = 64 };
+
+    void SetUp() override
+    {
+        mix_base::SetUp();
+        memset(&m_mpw, 0, sizeof(m_mpw));
+        m_sq_end = m_sq + sizeof(m_sq);
+    }
+
+    // Append a packet of len bytes the way qp_mgr_eth_mlx5::mpw_append() does
+    bool append(uint8_t *hot, uint32_t len, uint8_t cs_flags, mpw_buf *buf)
+    {
+        uint16_t seg = session_t::seg_ds(len);
+
+        if (m_mpw.wqe && m_mpw.must_close(seg, cs_flags, m_sq_end)) {
+            m_closed.push_back(m_mpw.pkts);
+            m_mpw.wqe = nullptr;
+        }
+        if (!m_mpw.wqe) {
+            if (!session_t::can_open(hot, seg, m_sq_end, SQ_WQEBBS)) {
+                return false;
+            }
+            m_mpw.open(hot, cs_flags);
+        }
+        m_mpw.append(seg, buf);
+        return true;
+    }
+
+    session_t m_mpw;
+    uint8_t m_sq[SQ_WQEBBS * WQEBB];
+    uint8_t *m_sq_end;
+    std::vector<uint16_t> m_closed; // Packets of every closed session
+};
+
+/**
+ * @test mpw_session_test.ti_1
+ * @brief
+ *    Session is closed at the packet limit
+ * @details
+ */
+TEST_F(mpw_session_test, ti_1)
+{
+    // A 12 byte packet takes a single data segment
+    ASSERT_EQ(1U, session_t::seg_ds(12));
+
+    for (int i = 0; i < XLIO_MLX5_MPW_MAX_PACKETS; i++) {
+        ASSERT_TRUE(append(m_sq, 12, 0, nullptr));
+    }
+    EXPECT_TRUE(m_closed.empty());
+    EXPECT_EQ(XLIO_MLX5_MPW_MAX_PACKETS, m_mpw.pkts);
+    EXPECT_EQ(2 + XLIO_MLX5_MPW_MAX_PACKETS, m_mpw.ds);
+
+    ASSERT_TRUE(append(m_sq, 12, 0, nullptr));
+    ASSERT_EQ(1U, m_closed.size());
+    EXPECT_EQ(XLIO_MLX5_MPW_MAX_PACKETS, m_closed[0]);
+    EXPECT_EQ(1, m_mpw.pkts);
+}
+
+/**
+ * @test mpw_session_test.ti_2
+ * @brief
+ *    Session is closed at the DS limit
+ * @details
+ *    A 100 byte packet takes 7 data segments, so 8 of them fit into 63 DS
+ *    together with ctrl and eth segments.
+ */
+TEST_F(mpw_session_test, ti_2)
+{
+    ASSERT_EQ(7U, session_t::seg_ds(100));
+
+    for (int i = 0; i < 8; i++) {
+        ASSERT_TRUE(append(m_sq, 100, 0, nullptr));
+    }
+    EXPECT_TRUE(m_closed.empty());
+    EXPECT_EQ(58, m_mpw.ds);
+    EXPECT_LE(m_mpw.ds, XLIO_MLX5_MPW_MAX_DS);
+
+    // Still fits a smaller packet
+    EXPECT_FALSE(m_mpw.must_close(session_t::seg_ds(12), 0, m_sq_end));
+
+    ASSERT_TRUE(append(m_sq, 100, 0, nullptr));
+    ASSERT_EQ(1U, m_closed.size());
+    EXPECT_EQ(8, m_closed[0]);
+    EXPECT_EQ(2 + 7, m_mpw.ds);
+}
+
+/**
+ * @test mpw_session_test.ti_3
+ * @brief
+ *    Session is closed when checksum offload flags change
+ * @details
+ */
+TEST_F(mpw_session_test, ti_3)
+{
+    ASSERT_TRUE(append(m_sq, 12, 0x3, nullptr));
+    ASSERT_TRUE(append(m_sq, 12, 0x3, nullptr));
+    EXPECT_TRUE(m_closed.empty());
+
+    ASSERT_TRUE(append(m_sq, 12, 0x1, nullptr));
+    ASSERT_EQ(1U, m_closed.size());
+    EXPECT_EQ(2, m_closed[0]);
+    EXPECT_EQ(0x1, m_mpw.cs_flags);
+}
+
+/**
+ * @test mpw_session_test.ti_4
+ * @brief
+ *    Session does not wrap around the SQ end
+ * @details
+ *    A WQE is not opened if its first packet crosses the SQ end, and an open
+ *    WQE is closed before a packet which would cross it.
+ */
+TEST_F(mpw_session_test, ti_4)
+{
+    // The last WQEBB fits ctrl, eth and 2 data segments
+    uint8_t *last = m_sq_end - WQEBB;
+
+    EXPECT_TRUE(session_t::can_open(last, 2, m_sq_end, SQ_WQEBBS));
+    EXPECT_FALSE(session_t::can_open(last, 3, m_sq_end, SQ_WQEBBS));
+
+    ASSERT_TRUE(append(last, 12, 0, nullptr));
+    ASSERT_TRUE(append(last, 12, 0, nullptr));
+    EXPECT_EQ(m_sq_end, m_mpw.cur);
+    EXPECT_TRUE(m_mpw.must_close(1, 0, m_sq_end));
+
+    // The next packet cannot be opened at the SQ end, it goes as a regular WQE
+    ASSERT_FALSE(append(m_sq_end, 12, 0, nullptr));
+    ASSERT_EQ(1U, m_closed.size());
+    EXPECT_EQ(2, m_closed[0]);
+    EXPECT_EQ(nullptr, m_mpw.wqe);
+
+    // After the wrap around a session starts at the SQ beginning
+    ASSERT_TRUE(append(m_sq, 12, 0, nullptr));
+    EXPECT_EQ(m_sq, m_mpw.wqe);
+}
+
+/**
+ * @test mpw_session_test.ti_5
+ * @brief
+ *    WQEBB accounting of a growing session
+ * @details
+ *    The first packet takes all WQEBBs of the new WQE, next packets take
+ *    only the WQEBBs the WQE grows by.
+ */
+TEST_F(mpw_session_test, ti_5)
+{
+    EXPECT_FALSE(session_t::can_open(m_sq, 3, m_sq_end, 1));
+    EXPECT_TRUE(session_t::can_open(m_sq, 3, m_sq_end, 2));
+
+    m_mpw.open(m_sq, 0);
+    EXPECT_EQ(1U, m_mpw.grow_wqebbs(1));
+    EXPECT_EQ(2U, m_mpw.grow_wqebbs(3));
+    m_mpw.append(1, nullptr);
+
+    // 3 DS, one more segment still fits the first WQEBB
+    EXPECT_EQ(0U, m_mpw.grow_wqebbs(1));
+    EXPECT_EQ(1U, m_mpw.grow_wqebbs(2));
+    m_mpw.append(2, nullptr);
+    EXPECT_EQ(2U, session_t::wqebbs(m_mpw.ds));
+}
+
+/**
+ * @test mpw_session_test.ti_6
+ * @brief
+ *    Buffers of a session are chained and released at once
+ * @details
+ *    Packets without a buffer are not chained. Every buffer is released
+ *    once, in posting order, with p_next_desc cleared.
+ */
+TEST_F(mpw_session_test, ti_6)
+{
+    mpw_buf bufs[4];
+    std::vector<mpw_buf *> released;
+
+    for (int i = 0; i < 4; i++) {
+        bufs[i].p_next_desc = &bufs[(i + 1) % 4];
+    }
+
+    ASSERT_TRUE(append(m_sq, 12, 0, &bufs[0]));
+    ASSERT_TRUE(append(m_sq, 12, 0, nullptr));
+    ASSERT_TRUE(append(m_sq, 12, 0, &bufs[1]));
+    ASSERT_TRUE(append(m_sq, 12, 0, &bufs[2]));
+    EXPECT_EQ(&bufs[0], m_mpw.buf_head);
+    EXPECT_EQ(&bufs[2], m_mpw.buf_tail);
+    EXPECT_EQ(nullptr, bufs[2].p_next_desc);
+
+    mpw_release_chain(m_mpw.buf_head, [&](mpw_buf *buf) { released.push_back(buf); });
+    ASSERT_EQ(3U, released.size());
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(&bufs[i], released[i]);
+        EXPECT_EQ(nullptr, bufs[i].p_next_desc);
+    }
+
+    // A new session does not refer to the released buffers
+    m_mpw.open(m_sq, 0);
+    EXPECT_EQ(nullptr, m_mpw.buf_head);
+    ASSERT_TRUE(append(m_sq, 12, 0, &bufs[3]));
+    EXPECT_EQ(&bufs[3], m_mpw.buf_head);
+    EXPECT_EQ(&bufs[3], m_mpw.buf_tail);
+    EXPECT_EQ(nullptr, bufs[3].p_next_desc);
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/poll_budget.h"
+
+#define MIN_BUDGET 10
+#define MAX_BUDGET 1000
+
+class poll_budget_test : public mix_base {
+protected:
+    void SetUp() override
+    {
+        mix_base::SetUp();
+        // The state has no constructor, like the __thread instances
+        m_pb = {0, 0, 0};
+    }
+
+    poll_budget m_pb;
+};
+
+/**
+ * @test poll_budget_test.ti_1
+ * @brief
+ *    The first get() initializes the budget to the upper bound
+ * @details
+ */
+TEST_F(poll_budget_test, ti_1)
+{
+    EXPECT_EQ(MAX_BUDGET, m_pb.get(MAX_BUDGET));
+    EXPECT_EQ(0, m_pb.gap_avg);
+    EXPECT_EQ(POLL_BUDGET_RATE_ONE, m_pb.hit_rate);
+
+    // Initialized once, a different bound doesn't reset it
+    m_pb.miss(MIN_BUDGET);
+    EXPECT_GT(MAX_BUDGET, m_pb.get(2 * MAX_BUDGET));
+}
+
+/**
+ * @test poll_budget_test.ti_2
+ * @brief
+ *    Hits in the second half of the spin double the budget up to the upper bound
+ * @details
+ *    Hits in the first half leave the budget as is.
+ */
+TEST_F(poll_budget_test, ti_2)
+{
+    m_pb.get(MAX_BUDGET);
+    m_pb.budget = 100;
+
+    m_pb.hit(10, MIN_BUDGET, MAX_BUDGET);
+    EXPECT_EQ(100, m_pb.budget);
+    m_pb.hit(49, MIN_BUDGET, MAX_BUDGET);
+    EXPECT_EQ(100, m_pb.budget);
+
+    m_pb.hit(50, MIN_BUDGET, MAX_BUDGET);
+    EXPECT_EQ(200, m_pb.budget);
+    m_pb.hit(199, MIN_BUDGET, MAX_BUDGET);
+    EXPECT_EQ(400, m_pb.budget);
+    m_pb.hit(400, MIN_BUDGET, MAX_BUDGET);
+    EXPECT_EQ(800, m_pb.budget);
+    m_pb.hit(800, MIN_BUDGET, MAX_BUDGET);
+    EXPECT_EQ(MAX_BUDGET, m_pb.budget);
+    m_pb.hit(MAX_BUDGET, MIN_BUDGET, MAX_BUDGET);
+    EXPECT_EQ(MAX_BUDGET, m_pb.budget);
+}
+
+/**
+ * @test poll_budget_test.ti_3
+ * @brief
+ *    Occasional misses trim the budget slowly but not below twice the average gap
+ * @details
+ */
+TEST_F(poll_budget_test, ti_3)
+{
+    m_pb.get(MAX_BUDGET);
+    for (int i = 0; i < 100; i++) {
+        m_pb.hit(400, MIN_BUDGET, MAX_BUDGET);
+    }
+    EXPECT_EQ(MAX_BUDGET, m_pb.budget);
+    EXPECT_LE(390, m_pb.gap_avg);
+    EXPECT_GE(400, m_pb.gap_avg);
+    EXPECT_EQ(POLL_BUDGET_RATE_ONE, m_pb.hit_rate);
+
+    int32_t floor = 2 * m_pb.gap_avg;
+
+    m_pb.miss(MIN_BUDGET);
+    EXPECT_EQ(MAX_BUDGET - MAX_BUDGET / 8, m_pb.budget);
+    for (int i = 0; i < 3; i++) {
+        m_pb.miss(MIN_BUDGET);
+        EXPECT_EQ(floor, m_pb.budget);
+    }
+    EXPECT_LE(POLL_BUDGET_RATE_ONE / 2, m_pb.hit_rate);
+
+    // A shorter gap in the first half of the spin lowers the floor
+    m_pb.hit(300, MIN_BUDGET, MAX_BUDGET);
+    EXPECT_EQ(floor, m_pb.budget);
+    EXPECT_GT(floor, 2 * m_pb.gap_avg);
+    m_pb.miss(MIN_BUDGET);
+    EXPECT_EQ(2 * m_pb.gap_avg, m_pb.budget);
+}
+
+/**
+ * @test poll_budget_test.ti_4
+ * @brief
+ *    When most spins miss the budget is halved down to the lower bound
+ * @details
+ *    Hits in the second half of the spin grow it back.
+ */
+TEST_F(poll_budget_test, ti_4)
+{
+    int32_t budget;
+    int misses = 0;
+
+    m_pb.get(MAX_BUDGET);
+    for (int i = 0; i < 100; i++) {
+        m_pb.hit(400, MIN_BUDGET, MAX_BUDGET);
+    }
+
+    while (m_pb.hit_rate >= POLL_BUDGET_RATE_ONE / 2) {
+        m_pb.miss(MIN_BUDGET);
+        misses++;
+    }
+    // The hit rate average drops by 1/8 per miss
+    EXPECT_EQ(6, misses);
+
+    budget = m_pb.budget;
+    m_pb.miss(MIN_BUDGET);
+    EXPECT_EQ(budget / 2, m_pb.budget);
+
+    for (int i = 0; i < 20; i++) {
+        m_pb.miss(MIN_BUDGET);
+    }
+    EXPECT_EQ(MIN_BUDGET, m_pb.budget);
+
+    for (int i = 0; i < 7; i++) {
+        m_pb.hit(m_pb.budget, MIN_BUDGET, MAX_BUDGET);
+    }
+    EXPECT_EQ(MAX_BUDGET, m_pb.budget);
+}
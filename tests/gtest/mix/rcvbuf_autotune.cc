@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/rcvbuf_autotune.h"
+
+#define RTT     1000U
+#define IDLE    100000U
+#define WND     65536U
+#define MSS     1000
+#define RCV_MAX (6 * 1024 * 1024)
+
+class rcvbuf_autotune_test : public mix_base {
+protected:
+    rcvbuf_autotune_test()
+        : m_now(1000000U)
+        , m_rcv_nxt(0xffff0000U)
+    {
+    }
+
+    /* Receive len bytes 'after' time units after the previous segment */
+    bool rx(uint32_t len, tscval_t after)
+    {
+        m_now += after;
+        m_rcv_nxt += len;
+        return m_at.rx(m_now, IDLE, m_rcv_nxt, WND);
+    }
+
+    /* Measure the RTT with a window of data received in RTT */
+    void measure_rtt()
+    {
+        rx(1, 0);
+        rx(WND - 1, RTT / 2);
+        rx(1, RTT / 2);
+        ASSERT_EQ(RTT, m_at.rtt_est);
+    }
+
+    int read(int copied, tscval_t after)
+    {
+        m_now += after;
+        return m_at.read(copied, m_now, MSS, RCV_MAX);
+    }
+
+    rcvbuf_autotune m_at;
+    tscval_t m_now;
+    uint32_t m_rcv_nxt;
+};
+
+/**
+ * @test rcvbuf_autotune_test.ti_1
+ * @brief
+ *    RTT is the minimum time to receive a window of data
+ * @details
+ *    Sequence numbers wrap around during the measurements.
+ */
+TEST_F(rcvbuf_autotune_test, ti_1)
+{
+    EXPECT_FALSE(rx(1, 0));
+    EXPECT_EQ(0U, m_at.rtt_est);
+
+    /* The window is not received yet */
+    EXPECT_FALSE(rx(WND - 1, 2 * RTT));
+    EXPECT_EQ(0U, m_at.rtt_est);
+
+    EXPECT_FALSE(rx(1, RTT));
+    EXPECT_EQ(3 * RTT, m_at.rtt_est);
+
+    /* A longer measurement doesn't change it */
+    rx(WND, 4 * RTT);
+    EXPECT_EQ(3 * RTT, m_at.rtt_est);
+
+    rx(WND, RTT);
+    EXPECT_EQ(RTT, m_at.rtt_est);
+}
+
+/**
+ * @test rcvbuf_autotune_test.ti_2
+ * @brief
+ *    Buffer grows once per RTT to twice the data consumed
+ * @details
+ */
+TEST_F(rcvbuf_autotune_test, ti_2)
+{
+    /* Nothing before the RTT is known */
+    EXPECT_EQ(0, read(100000, 10 * RTT));
+
+    measure_rtt();
+
+    /* The first read starts the measurement */
+    EXPECT_EQ(0, read(10000, 0));
+    EXPECT_EQ(0, read(40000, RTT / 2));
+    EXPECT_EQ(2 * 100000 + 16 * MSS, read(50000, RTT / 2));
+    EXPECT_EQ(100000, m_at.space);
+
+    /* Less than the maximum doesn't change the buffer */
+    EXPECT_EQ(0, read(80000, RTT / 2));
+    EXPECT_EQ(0, read(10000, RTT / 2));
+    EXPECT_EQ(100000, m_at.space);
+
+    EXPECT_EQ(0, read(150000, RTT / 2));
+    EXPECT_EQ(2 * 200000 + 16 * MSS, read(50000, RTT));
+
+    /* Up to the limit */
+    EXPECT_EQ(0, read(RCV_MAX, RTT / 2));
+    EXPECT_EQ(RCV_MAX, read(0, RTT / 2));
+}
+
+/**
+ * @test rcvbuf_autotune_test.ti_3
+ * @brief
+ *    Idle connection starts over
+ * @details
+ *    The consumed data maximum is dropped, the RTT estimation is kept.
+ */
+TEST_F(rcvbuf_autotune_test, ti_3)
+{
+    measure_rtt();
+
+    read(0, 0);
+    EXPECT_LT(0, read(500000, RTT));
+    EXPECT_EQ(500000, m_at.space);
+
+    /* Not idle yet */
+    EXPECT_FALSE(rx(MSS, 0));
+    EXPECT_FALSE(rx(MSS, IDLE));
+    EXPECT_EQ(500000, m_at.space);
+
+    EXPECT_TRUE(rx(MSS, IDLE + 1));
+    EXPECT_EQ(0, m_at.space);
+    EXPECT_EQ(RTT, m_at.rtt_est);
+
+    /* A small flow grows from the default again */
+    EXPECT_EQ(0, read(10000, 0));
+    EXPECT_EQ(2 * 10000 + 16 * MSS, read(0, RTT));
+}
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/dev/srq_wqe_list.h"
+
+struct srq_buf {
+    uint32_t id;
+};
+
+// Next WQE indexes of a software SRQ
+struct srq_links {
+    std::vector<uint16_t> *next_idx;
+
+    uint16_t next(uint16_t index) const { return (*next_idx)[index]; }
+    void link(uint16_t index, uint16_t next) { (*next_idx)[index] = next; }
+};
+
+typedef srq_wqe_list<srq_buf, srq_links> srq_list_t;
+
+class srq_wqe_list_test : public mix_base {
+protected:
+    enum { WQE_CNT = 64, POOL_SIZE = 256, BATCH = 8, DONE_MAX = 8 };
+
+    /* Rings of one device share the SRQ, the ring which consumes a WQE
+     * reposts a buffer for it, as qp_mgr_eth_mlx5 does.
+     */
+    struct test_ring {
+        srq_wqe_list_test *dev;
+        std::vector<srq_buf *> pending; // Batch which is not posted yet
+        std::vector<uint16_t> done; // Consumed WQEs which are not released yet
+        uint32_t stat_posted; // n_rx_srq_posted
+
+        void post(uint32_t n_wr)
+        {
+            uint32_t posted = dev->m_srq->post(n_wr, [this](uint32_t i, uint16_t index) {
+                dev->m_hw_posted.push_back(index);
+                return pending[i];
+            });
+            // Other rings have filled the shared queue meanwhile
+            for (uint32_t i = posted; i < n_wr; ++i) {
+                dev->pool_put(pending[i]);
+            }
+            pending.erase(pending.begin(), pending.begin() + n_wr);
+            stat_posted = dev->m_srq->get_posted();
+        }
+
+        void flush()
+        {
+            dev->m_srq->release(done.data(), done.size());
+            done.clear();
+            post(0);
+        }
+
+        void post_buffer(srq_buf *buf)
+        {
+            pending.push_back(buf);
+            if (pending.size() == BATCH) {
+                dev->m_srq->release(done.data(), done.size());
+                done.clear();
+                post(pending.size());
+            }
+        }
+
+        void up()
+        {
+            // A ring fills only the WQEs which are missing in the shared queue
+            uint32_t fill = dev->m_srq->get_deficit();
+            for (uint32_t i = 0; i < fill && !dev->m_pool.empty(); ++i) {
+                post_buffer(dev->pool_get());
+            }
+            post(pending.size());
+        }
+
+        // Receive a packet on the WQE and return the buffer to the pool
+        void receive(uint16_t index)
+        {
+            if (done.size() == DONE_MAX) {
+                flush();
+            }
+            done.push_back(index);
+            srq_buf *buf = dev->m_srq->take(index);
+            ASSERT_TRUE(buf);
+            dev->pool_put(buf);
+            if (!dev->m_pool.empty()) {
+                post_buffer(dev->pool_get());
+            }
+        }
+
+        void down()
+        {
+            flush();
+            for (srq_buf *buf : pending) {
+                dev->pool_put(buf);
+            }
+            pending.clear();
+        }
+    };
+
+    void SetUp() override
+    {
+        mix_base::SetUp();
+
+        m_bufs.resize(POOL_SIZE);
+        for (uint32_t i = 0; i < POOL_SIZE; ++i) {
+            m_bufs[i].id = i;
+            m_pool.push_back(&m_bufs[i]);
+        }
+        m_srq_ref = 0;
+        m_seed = 1;
+    }
+
+    srq_buf *pool_get()
+    {
+        srq_buf *buf = m_pool.back();
+        m_pool.pop_back();
+        return buf;
+    }
+    void pool_put(srq_buf *buf) { m_pool.push_back(buf); }
+
+    // ib_ctx_handler creates the SRQ for the first ring and destroys it with the last one
+    void ring_up(test_ring &ring)
+    {
+        if (m_srq_ref++ == 0) {
+            m_next_idx.resize(WQE_CNT);
+            for (uint32_t i = 0; i < WQE_CNT; ++i) {
+                m_next_idx[i] = (i + 1) % WQE_CNT;
+            }
+            srq_links links = {&m_next_idx};
+            m_srq.reset(new srq_list_t());
+            m_srq->init(links, WQE_CNT, WQE_CNT - 1, 0, WQE_CNT - 1);
+            m_hw_posted.clear();
+        }
+        ring.dev = this;
+        ring.stat_posted = 0;
+        ring.up();
+    }
+
+    void ring_down(test_ring &ring)
+    {
+        ring.down();
+        if (--m_srq_ref == 0) {
+            uint32_t n = m_srq->drain([this](srq_buf *buf) { pool_put(buf); });
+            EXPECT_EQ(m_hw_posted.size(), n);
+            m_srq.reset();
+        }
+    }
+
+    // The device completes a random posted WQE on the given ring
+    void hw_receive(test_ring &ring)
+    {
+        m_seed = m_seed * 1103515245 + 12345;
+        size_t pos = (m_seed >> 16) % m_hw_posted.size();
+        uint16_t index = m_hw_posted[pos];
+
+        m_hw_posted[pos] = m_hw_posted.back();
+        m_hw_posted.pop_back();
+        ring.receive(index);
+    }
+
+    /* Consumed WQEs stay accounted as posted until their ring releases them.
+     * Every buffer is in the pool, in the device or in a batch of a ring.
+     */
+    void check_accounting(const std::vector<test_ring *> &rings)
+    {
+        size_t held = 0;
+        size_t consumed = 0;
+
+        for (test_ring *ring : rings) {
+            held += ring->pending.size();
+            consumed += ring->done.size();
+        }
+        EXPECT_EQ(m_hw_posted.size() + consumed, m_srq->get_posted());
+        EXPECT_EQ((size_t)POOL_SIZE, m_pool.size() + m_hw_posted.size() + held);
+    }
+
+    std::vector<srq_buf> m_bufs;
+    std::vector<srq_buf *> m_pool;
+    std::vector<uint16_t> m_next_idx;
+    std::vector<uint16_t> m_hw_posted; // Posted WQEs in the device
+    std::unique_ptr<srq_list_t> m_srq;
+    int m_srq_ref;
+    uint32_t m_seed;
+};
+
+/**
+ * @test srq_wqe_list_test.ti_1
+ * @brief
+ *    Posting stops at the SRQ size and released WQEs are reused
+ * @details
+ */
+TEST_F(srq_wqe_list_test, ti_1)
+{
+    srq_links links = {&m_next_idx};
+    srq_list_t srq;
+    uint16_t done[2];
+
+    m_next_idx.resize(8);
+    for (uint16_t i = 0; i < 8; ++i) {
+        m_next_idx[i] = (i + 1) % 8;
+    }
+    srq.init(links, 8, 7, 0, 7);
+    EXPECT_EQ(7U, srq.get_deficit());
+
+    EXPECT_EQ(7U, srq.post(10, [this](uint32_t i, uint16_t) { return &m_bufs[i]; }));
+    EXPECT_EQ(7U, srq.get_posted());
+    EXPECT_EQ(0U, srq.get_deficit());
+    EXPECT_EQ(0U, srq.post(1, [this](uint32_t, uint16_t) { return &m_bufs[0]; }));
+
+    // WQE indexes wrap around the queue
+    EXPECT_EQ(&m_bufs[3], srq.take(3 + 8));
+    EXPECT_EQ(nullptr, srq.take(3));
+    EXPECT_EQ(&m_bufs[5], srq.take(5));
+
+    done[0] = 3;
+    done[1] = 5;
+    srq.release(done, 2);
+    EXPECT_EQ(5U, srq.get_posted());
+    EXPECT_EQ(2U, srq.get_deficit());
+
+    std::vector<uint16_t> reused;
+    EXPECT_EQ(2U, srq.post(2, [&](uint32_t i, uint16_t index) {
+        reused.push_back(index);
+        return &m_bufs[10 + i];
+    }));
+    ASSERT_EQ(2U, reused.size());
+    EXPECT_EQ(7, reused[0]);
+    EXPECT_EQ(3, reused[1]);
+
+    EXPECT_EQ(7U, srq.drain([](srq_buf *) {}));
+    EXPECT_EQ(0U, srq.drain([](srq_buf *) {}));
+}
+
+/**
+ * @test srq_wqe_list_test.ti_2
+ * @brief
+ *    Rings going up and down on one device keep SRQ accounting
+ * @details
+ *    Traffic lands on random WQEs of random rings, which repost buffers for
+ *    them. The SRQ stays full while a ring is up, its occupancy statistics
+ *    match the device, and every buffer returns to the pool after the last
+ *    ring is down.
+ */
+TEST_F(srq_wqe_list_test, ti_2)
+{
+    test_ring rings[3];
+
+    for (int cycle = 0; cycle < 4; ++cycle) {
+        std::vector<test_ring *> active;
+
+        for (test_ring &ring : rings) {
+            ring_up(ring);
+            active.push_back(&ring);
+            EXPECT_EQ((uint32_t)WQE_CNT - 1, m_srq->get_posted());
+            EXPECT_EQ(m_srq->get_posted(), ring.stat_posted);
+            check_accounting(active);
+        }
+
+        for (int i = 0; i < 1000; ++i) {
+            hw_receive(*active[i % active.size()]);
+        }
+        check_accounting(active);
+
+        // Take a ring down in the middle of traffic, the others fill its share
+        ring_down(*active[cycle % active.size()]);
+        active.erase(active.begin() + cycle % active.size());
+        check_accounting(active);
+        for (int i = 0; i < 100; ++i) {
+            hw_receive(*active[i % active.size()]);
+        }
+        for (test_ring *ring : active) {
+            ring->flush();
+        }
+        check_accounting(active);
+
+        // A ring coming up again fills the WQEs of the stopped one
+        ring_up(rings[cycle % 3]);
+        EXPECT_EQ((uint32_t)WQE_CNT - 1, m_srq->get_posted());
+        EXPECT_EQ(m_srq->get_posted(), rings[cycle % 3].stat_posted);
+
+        for (test_ring &ring : rings) {
+            ring_down(ring);
+        }
+        EXPECT_EQ(0, m_srq_ref);
+        EXPECT_EQ((size_t)POOL_SIZE, m_pool.size());
+    }
+}
@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+/* The cookies don't depend on the rest of libxlio, so the source is compiled
+ * into the test binary.
+ */
+#include "src/core/sock/syncookie.cpp"
+
+#define SYNCOOKIE_PERIOD (1U << SYNCOOKIE_COUNT_SHIFT)
+
+class syncookie_test : public mix_base {
+protected:
+    syncookie_test()
+    {
+        in_addr client4;
+        in_addr server4;
+        in6_addr client6;
+        in6_addr server6;
+
+        inet_pton(AF_INET, "192.0.2.1", &client4);
+        inet_pton(AF_INET, "198.51.100.1", &server4);
+        inet_pton(AF_INET6, "2001:db8::1", &client6);
+        inet_pton(AF_INET6, "2001:db8::2", &server6);
+
+        m_client4 = sock_addr(AF_INET, &client4, htons(40000));
+        m_server4 = sock_addr(AF_INET, &server4, htons(80));
+        m_client6 = sock_addr(AF_INET6, &client6, htons(40000));
+        m_server6 = sock_addr(AF_INET6, &server6, htons(80));
+    }
+
+    sock_addr m_client4;
+    sock_addr m_server4;
+    sock_addr m_client6;
+    sock_addr m_server6;
+};
+
+/**
+ * @test syncookie_test.ti_1
+ * @brief
+ *    Cookie decodes to the peer MSS rounded down to an encodable value
+ * @details
+ */
+TEST_F(syncookie_test, ti_1)
+{
+    const struct {
+        uint16_t peer;
+        uint16_t encoded;
+    } mss[] = {{0, 536},       {536, 536},   {1000, 536},   {1220, 1220},
+               {1419, 1300},   {1440, 1440}, {1460, 1460},  {1500, 1460},
+               {8940, 8940},   {9000, 8940}, {65535, 8940}};
+    const uint32_t now = 0x12345678U;
+
+    for (size_t i = 0; i < sizeof(mss) / sizeof(mss[0]); i++) {
+        for (int v6 = 0; v6 < 2; v6++) {
+            const sock_addr &client = v6 ? m_client6 : m_client4;
+            const sock_addr &server = v6 ? m_server6 : m_server4;
+            uint32_t peer_isn = 0xfffffff0U + (uint32_t)i;
+            uint16_t value = mss[i].peer;
+            uint16_t decoded = 0;
+            uint32_t cookie;
+
+            cookie = syncookie::make_isn(client, server, peer_isn, value, now);
+            EXPECT_EQ(mss[i].encoded, value);
+            EXPECT_TRUE(syncookie::check_isn(client, server, peer_isn, cookie, now, decoded));
+            EXPECT_EQ(mss[i].encoded, decoded);
+        }
+    }
+}
+
+/**
+ * @test syncookie_test.ti_2
+ * @brief
+ *    Cookie expires after SYNCOOKIE_MAX_AGE counter periods
+ * @details
+ *    A cookie from the future is rejected too.
+ */
+TEST_F(syncookie_test, ti_2)
+{
+    const uint32_t sent = 10 * SYNCOOKIE_PERIOD + 100;
+    const uint32_t peer_isn = 12345;
+    uint16_t mss = 1460;
+    uint32_t cookie;
+
+    cookie = syncookie::make_isn(m_client4, m_server4, peer_isn, mss, sent);
+
+    for (uint32_t age = 0; age < SYNCOOKIE_MAX_AGE; age++) {
+        uint32_t now = (sent & ~(SYNCOOKIE_PERIOD - 1)) + age * SYNCOOKIE_PERIOD;
+        mss = 0;
+        EXPECT_TRUE(syncookie::check_isn(m_client4, m_server4, peer_isn, cookie, now, mss));
+        EXPECT_EQ(1460, mss);
+        EXPECT_TRUE(
+            syncookie::check_isn(m_client4, m_server4, peer_isn, cookie, now + SYNCOOKIE_PERIOD - 1,
+                                 mss));
+        EXPECT_TRUE(syncookie::is_recent(sent, now));
+        EXPECT_TRUE(syncookie::is_recent(sent, now + SYNCOOKIE_PERIOD - 1));
+    }
+
+    uint32_t expired = (sent & ~(SYNCOOKIE_PERIOD - 1)) + SYNCOOKIE_MAX_AGE * SYNCOOKIE_PERIOD;
+    EXPECT_FALSE(syncookie::check_isn(m_client4, m_server4, peer_isn, cookie, expired, mss));
+    EXPECT_FALSE(syncookie::is_recent(sent, expired));
+
+    uint32_t early = (sent & ~(SYNCOOKIE_PERIOD - 1)) - 1;
+    EXPECT_FALSE(syncookie::check_isn(m_client4, m_server4, peer_isn, cookie, early, mss));
+    EXPECT_FALSE(syncookie::is_recent(sent, early));
+}
+
+/**
+ * @test syncookie_test.ti_3
+ * @brief
+ *    Cookie is bound to the 4-tuple and to the peer ISN
+ * @details
+ */
+TEST_F(syncookie_test, ti_3)
+{
+    const uint32_t now = 5 * SYNCOOKIE_PERIOD;
+    const uint32_t peer_isn = 0x80000000U;
+    uint16_t mss = 1460;
+    uint32_t cookie;
+    sock_addr other;
+
+    cookie = syncookie::make_isn(m_client4, m_server4, peer_isn, mss, now);
+
+    /* The peer ISN is added to the cookie, a small difference in it shifts the
+     * MSS index and a larger one is rejected.
+     */
+    EXPECT_FALSE(
+        syncookie::check_isn(m_client4, m_server4, peer_isn + 0x10000U, cookie, now, mss));
+    EXPECT_FALSE(syncookie::check_isn(m_server4, m_client4, peer_isn, cookie, now, mss));
+    EXPECT_FALSE(syncookie::check_isn(m_client6, m_server6, peer_isn, cookie, now, mss));
+    // The MSS index is in the low bits, the hash rejects a change above them
+    EXPECT_FALSE(
+        syncookie::check_isn(m_client4, m_server4, peer_isn, cookie ^ 0x00800000U, now, mss));
+
+    other = m_client4;
+    other.set_in_port(htons(40001));
+    EXPECT_FALSE(syncookie::check_isn(other, m_server4, peer_isn, cookie, now, mss));
+
+    EXPECT_TRUE(syncookie::check_isn(m_client4, m_server4, peer_isn, cookie, now, mss));
+}
+
+/**
+ * @test syncookie_test.ti_4
+ * @brief
+ *    Window scale and SACK permitted round trip through the TSval
+ * @details
+ *    The TSval is never later than the clock and at most one encoding
+ *    period behind it.
+ */
+TEST_F(syncookie_test, ti_4)
+{
+    const uint32_t clocks[] = {0x1000U, 0x1000U + 0x3fU, 0x12345678U, 0xffffffffU};
+    syncookie::options opts;
+
+    memset(&opts, 0, sizeof(opts));
+    for (size_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++) {
+        for (uint8_t wscale = 0; wscale <= TCP_SYNCOOKIE_NO_WSCALE; wscale++) {
+            for (int sack = 0; sack < 2; sack++) {
+                uint32_t now = clocks[c];
+                uint32_t tsval;
+                uint8_t decoded_wscale;
+                bool decoded_sack;
+
+                opts.wscale = wscale;
+                opts.sack = sack;
+                tsval = syncookie::make_tsval(now, opts);
+                EXPECT_LE(tsval, now);
+                EXPECT_GT(2U << SYNCOOKIE_TS_OPT_BITS, now - tsval);
+
+                syncookie::decode_tsecr(tsval, decoded_wscale, decoded_sack);
+                EXPECT_EQ(wscale, decoded_wscale);
+                EXPECT_EQ(!!sack, decoded_sack);
+            }
+        }
+    }
+}
+
+/**
+ * @test syncookie_test.ti_5
+ * @brief
+ *    Fast Open cookie is valid for any port of the client
+ * @details
+ */
+TEST_F(syncookie_test, ti_5)
+{
+    struct tcp_fastopen cookie;
+    struct tcp_fastopen other;
+    sock_addr client = m_client4;
+
+    syncookie::make_fastopen_cookie(m_client4, m_server4, cookie);
+    EXPECT_EQ(FASTOPEN_COOKIE_LEN, cookie.len);
+    EXPECT_TRUE(syncookie::check_fastopen_cookie(m_client4, m_server4, cookie));
+
+    client.set_in_port(htons(50000));
+    EXPECT_TRUE(syncookie::check_fastopen_cookie(client, m_server4, cookie));
+
+    EXPECT_FALSE(syncookie::check_fastopen_cookie(m_client6, m_server4, cookie));
+    EXPECT_FALSE(syncookie::check_fastopen_cookie(m_client4, m_server6, cookie));
+
+    other = cookie;
+    other.cookie[3] ^= 1;
+    EXPECT_FALSE(syncookie::check_fastopen_cookie(m_client4, m_server4, other));
+    other = cookie;
+    other.len = 4;
+    EXPECT_FALSE(syncookie::check_fastopen_cookie(m_client4, m_server4, other));
+}
+
+/**
+ * @test syncookie_test.ti_6
+ * @brief
+ *    SYN options are parsed, malformed options stop the parsing
+ * @details
+ */
+TEST_F(syncookie_test, ti_6)
+{
+    struct {
+        struct tcphdr hdr;
+        uint8_t opt[40];
+    } syn;
+    const uint8_t opt[] = {TCPOPT_MAXSEG, TCPOLEN_MAXSEG, 0x05, 0xb4,
+                           TCPOPT_SACK_PERMITTED, TCPOLEN_SACK_PERMITTED,
+                           TCPOPT_TIMESTAMP, TCPOLEN_TIMESTAMP, 0, 0, 0, 1, 0, 0, 0, 2,
+                           TCPOPT_NOP, TCPOPT_WINDOW, TCPOLEN_WINDOW, 15,
+                           TCPOPT_FASTOPEN, 2 + 8, 1, 2, 3, 4, 5, 6, 7, 8,
+                           TCPOPT_EOL, TCPOPT_EOL};
+    syncookie::options opts;
+
+    static_assert(sizeof(opt) % 4 == 0, "Options are padded to 32-bit words");
+    memset(&syn, 0, sizeof(syn));
+    memcpy(syn.opt, opt, sizeof(opt));
+    syn.hdr.doff = (sizeof(syn.hdr) + sizeof(opt)) / 4;
+
+    syncookie::parse_options(&syn.hdr, opts);
+    EXPECT_EQ(1460, opts.mss);
+    EXPECT_TRUE(opts.sack);
+    EXPECT_TRUE(opts.ts);
+    EXPECT_EQ(1U, opts.tsval);
+    EXPECT_EQ(2U, opts.tsecr);
+    // Window scale is limited to 14 (RFC 7323)
+    EXPECT_EQ(14, opts.wscale);
+    EXPECT_TRUE(opts.fastopen);
+    EXPECT_EQ(8, opts.fastopen_cookie.len);
+    EXPECT_EQ(8, opts.fastopen_cookie.cookie[7]);
+
+    // An option which runs past the header is ignored with everything after it
+    syn.opt[1] = 40;
+    syncookie::parse_options(&syn.hdr, opts);
+    EXPECT_EQ(0, opts.mss);
+    EXPECT_FALSE(opts.sack);
+    EXPECT_EQ(TCP_SYNCOOKIE_NO_WSCALE, opts.wscale);
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <map>
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/event/timers_wheel.h"
+
+class timers_wheel_test : public mix_base {
+protected:
+    // Nodes are off the wheel until they are armed, see add_new_timer()
+    static void init(timer_node_t *nodes, size_t count)
+    {
+        for (size_t i = 0; i < count; i++) {
+            nodes[i].next = NULL;
+            nodes[i].prev = NULL;
+        }
+    }
+
+    void arm(timer_node_t &node, uint32_t expiry)
+    {
+        if (timers_wheel::is_armed(&node)) {
+            timers_wheel::remove(&node);
+        }
+        node.group_expiry = expiry;
+        m_wheel.insert(&node);
+    }
+
+    /* Advance the wheel by the given number of ticks and record the tick on
+     * which every node has expired.
+     */
+    void run(uint32_t ticks)
+    {
+        while (ticks--) {
+            uint32_t tick = m_wheel.get_tick();
+            timer_node_t *node;
+
+            m_wheel.advance();
+            while ((node = m_wheel.pop_expired())) {
+                EXPECT_FALSE(timers_wheel::is_armed(node));
+                m_fired[node].push_back(tick);
+            }
+        }
+    }
+
+    timers_wheel m_wheel;
+    std::map<timer_node_t *, std::vector<uint32_t>> m_fired;
+};
+
+/**
+ * @test timers_wheel_test.ti_1
+ * @brief
+ *    Timers expire exactly on their tick on every level of the wheel
+ * @details
+ */
+TEST_F(timers_wheel_test, ti_1)
+{
+    const uint32_t expiry[] = {0,    1,    63,   64,   65,    127,   4095,
+                               4096, 4097, 5000, 70000, 262143, 262144, 300000};
+    const size_t count = sizeof(expiry) / sizeof(expiry[0]);
+    timer_node_t nodes[count];
+
+    init(nodes, count);
+    for (size_t i = 0; i < count; i++) {
+        arm(nodes[i], expiry[i]);
+        EXPECT_TRUE(timers_wheel::is_armed(&nodes[i]));
+    }
+
+    run(300001);
+
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(1U, m_fired[&nodes[i]].size()) << "expiry " << expiry[i];
+        EXPECT_EQ(expiry[i], m_fired[&nodes[i]][0]);
+    }
+    EXPECT_TRUE(m_wheel.first() == NULL);
+}
+
+/**
+ * @test timers_wheel_test.ti_2
+ * @brief
+ *    Past and too far expirations are adjusted on insert
+ * @details
+ *    A timer in the past expires on the current tick, a timer beyond the wheel
+ *    range is clamped to the longest timer the wheel can hold.
+ */
+TEST_F(timers_wheel_test, ti_2)
+{
+    timer_node_t nodes[2];
+    timer_node_t &past = nodes[0];
+    timer_node_t &far = nodes[1];
+
+    init(nodes, 2);
+    run(100);
+
+    arm(past, 50);
+    EXPECT_EQ(100U, past.group_expiry);
+    arm(far, 100 + TIMERS_WHEEL_RANGE + 1000);
+    EXPECT_EQ(100 + TIMERS_WHEEL_RANGE - 1, far.group_expiry);
+
+    run(1);
+    ASSERT_EQ(1U, m_fired[&past].size());
+    EXPECT_EQ(100U, m_fired[&past][0]);
+    EXPECT_TRUE(timers_wheel::is_armed(&far));
+
+    timers_wheel::remove(&far);
+    EXPECT_FALSE(timers_wheel::is_armed(&far));
+    EXPECT_TRUE(m_wheel.first() == NULL);
+}
+
+/**
+ * @test timers_wheel_test.ti_3
+ * @brief
+ *    Removed and rearmed timers
+ * @details
+ *    A removed timer never expires, a rearmed timer expires only on its
+ *    last expiration.
+ */
+TEST_F(timers_wheel_test, ti_3)
+{
+    timer_node_t nodes[3];
+    timer_node_t &removed = nodes[0];
+    timer_node_t &earlier = nodes[1];
+    timer_node_t &later = nodes[2];
+
+    init(nodes, 3);
+    arm(removed, 10);
+    arm(earlier, 5000);
+    arm(later, 20);
+
+    run(5);
+    timers_wheel::remove(&removed);
+    arm(earlier, 30);
+    arm(later, 4100);
+
+    run(5000);
+    EXPECT_EQ(0U, m_fired.count(&removed));
+    ASSERT_EQ(1U, m_fired[&earlier].size());
+    EXPECT_EQ(30U, m_fired[&earlier][0]);
+    ASSERT_EQ(1U, m_fired[&later].size());
+    EXPECT_EQ(4100U, m_fired[&later][0]);
+}
+
+/**
+ * @test timers_wheel_test.ti_4
+ * @brief
+ *    Random timers against a model
+ * @details
+ *    Timers are rearmed from the expiration loop like the TCP sockets do, every
+ *    expiration must match the model.
+ */
+TEST_F(timers_wheel_test, ti_4)
+{
+    const size_t count = 256;
+    timer_node_t nodes[count];
+    std::map<timer_node_t *, std::vector<uint32_t>> expected;
+    uint32_t seed = 12345;
+    uint32_t deadline = 100000;
+
+    init(nodes, count);
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245U + 12345U;
+        uint32_t expiry = (seed >> 8) % (i % 2 ? 100U : 10000U);
+        arm(nodes[i], expiry);
+        expected[&nodes[i]].push_back(expiry);
+    }
+
+    while (m_wheel.get_tick() < deadline) {
+        uint32_t tick = m_wheel.get_tick();
+        timer_node_t *node;
+
+        m_wheel.advance();
+        while ((node = m_wheel.pop_expired())) {
+            m_fired[node].push_back(tick);
+            seed = seed * 1103515245U + 12345U;
+            uint32_t expiry = tick + 1 + (seed >> 8) % 5000U;
+            if (expiry < deadline) {
+                arm(*node, expiry);
+                expected[node].push_back(expiry);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        EXPECT_TRUE(expected[&nodes[i]] == m_fired[&nodes[i]]) << "node " << i;
+    }
+    EXPECT_TRUE(m_wheel.first() == NULL);
+}
+
+/**
+ * @test timers_wheel_test.ti_5
+ * @brief
+ *    first() returns every armed timer until the wheel is empty
+ * @details
+ */
+TEST_F(timers_wheel_test, ti_5)
+{
+    timer_node_t nodes[4];
+    timer_node_t *node;
+    int removed = 0;
+
+    init(nodes, 4);
+    arm(nodes[0], 0);
+    arm(nodes[1], 100);
+    arm(nodes[2], 10000);
+    arm(nodes[3], 1000000);
+    // The first timer is moved to the expired list
+    m_wheel.advance();
+
+    while ((node = m_wheel.first())) {
+        timers_wheel::remove(node);
+        removed++;
+    }
+    EXPECT_EQ(4, removed);
+    EXPECT_TRUE(m_wheel.pop_expired() == NULL);
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <time.h>
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+
+#include "mix_base.h"
+
+#include "src/core/util/tx_combining_queue.h"
+
+struct test_req : public tx_combining_node {
+    uint32_t id;
+};
+
+// Same trylock() convention as the XLIO locks, 0 on success
+class test_spin_lock {
+public:
+    test_spin_lock() { pthread_spin_init(&m_lock, PTHREAD_PROCESS_PRIVATE); }
+    ~test_spin_lock() { pthread_spin_destroy(&m_lock); }
+    int trylock() { return pthread_spin_trylock(&m_lock); }
+    void unlock() { pthread_spin_unlock(&m_lock); }
+
+private:
+    pthread_spinlock_t m_lock;
+};
+
+class tx_combining_queue_test : public mix_base {
+protected:
+    // Called under m_lock, as ring_simple::tx_combine()
+    void combine(int max_passes)
+    {
+        m_queue.combine(
+            [this](tx_combining_node *node) {
+                m_posted.push_back(static_cast<test_req *>(node)->id);
+            },
+            max_passes);
+    }
+
+    struct thread_arg {
+        tx_combining_queue_test *self;
+        uint32_t thread_id;
+        uint32_t count;
+        int max_passes;
+    };
+
+    static void *submitter(void *arg)
+    {
+        thread_arg *ctx = (thread_arg *)arg;
+        tx_combining_queue_test *self = ctx->self;
+
+        for (uint32_t i = 0; i < ctx->count; i++) {
+            test_req req;
+
+            req.id = (ctx->thread_id << 24) | i;
+            self->m_queue.push(&req);
+            self->m_queue.wait(&req, self->m_lock,
+                               [self, ctx]() { self->combine(ctx->max_passes); });
+        }
+        return nullptr;
+    }
+
+    tx_combining_queue m_queue;
+    test_spin_lock m_lock;
+    std::vector<uint32_t> m_posted;
+};
+
+/**
+ * @test tx_combining_queue_test.ti_1
+ * @brief
+ *    Combiner processes pending requests in submission order
+ * @details
+ */
+TEST_F(tx_combining_queue_test, ti_1)
+{
+    test_req req[3];
+
+    for (uint32_t i = 0; i < 3; i++) {
+        req[i].id = i;
+        m_queue.push(&req[i]);
+        EXPECT_FALSE(req[i].done.load());
+    }
+
+    combine(4);
+    ASSERT_EQ(3U, m_posted.size());
+    for (uint32_t i = 0; i < 3; i++) {
+        EXPECT_EQ(i, m_posted[i]);
+        EXPECT_TRUE(req[i].done.load());
+    }
+
+    // Nothing is pending
+    combine(4);
+    EXPECT_EQ(3U, m_posted.size());
+}
+
+/**
+ * @test tx_combining_queue_test.ti_2
+ * @brief
+ *    Request left over after max_passes is posted by its owner
+ * @details
+ *    Every pass publishes a new request, so the combiner stops after
+ *    max_passes. The owner of the leftover must not wait forever.
+ */
+TEST_F(tx_combining_queue_test, ti_2)
+{
+    const int max_passes = 2;
+    test_req req[max_passes + 1];
+    int submitted = 1;
+
+    for (int i = 0; i <= max_passes; i++) {
+        req[i].id = i;
+    }
+    m_queue.push(&req[0]);
+
+    ASSERT_EQ(0, m_lock.trylock());
+    m_queue.combine(
+        [&](tx_combining_node *node) {
+            m_posted.push_back(static_cast<test_req *>(node)->id);
+            // A request of another thread arrives while this one is posted
+            if (submitted <= max_passes) {
+                m_queue.push(&req[submitted++]);
+            }
+        },
+        max_passes);
+    m_lock.unlock();
+
+    ASSERT_EQ((size_t)max_passes, m_posted.size());
+    EXPECT_TRUE(req[max_passes - 1].done.load());
+    EXPECT_FALSE(req[max_passes].done.load());
+
+    m_queue.wait(&req[max_passes], m_lock, [this]() { combine(max_passes); });
+    EXPECT_TRUE(req[max_passes].done.load());
+    ASSERT_EQ((size_t)max_passes + 1U, m_posted.size());
+    for (int i = 0; i <= max_passes; i++) {
+        EXPECT_EQ((uint32_t)i, m_posted[i]);
+    }
+}
+
+/**
+ * @test tx_combining_queue_test.ti_3
+ * @brief
+ *    Concurrent submitters, every request is posted exactly once
+ * @details
+ *    A single pass per combiner leaves requests over all the time. Each
+ *    thread must finish and its requests must be posted in its order.
+ */
+TEST_F(tx_combining_queue_test, ti_3)
+{
+    const uint32_t threads_num = 8;
+    const uint32_t per_thread = 20000;
+    pthread_t threads[threads_num];
+    thread_arg args[threads_num];
+
+    for (uint32_t t = 0; t < threads_num; t++) {
+        args[t].self = this;
+        args[t].thread_id = t;
+        args[t].count = per_thread;
+        args[t].max_passes = 1;
+        ASSERT_EQ(0, pthread_create(&threads[t], nullptr, submitter, &args[t]));
+    }
+
+    // A waiter which spins forever fails the join instead of hanging the test
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += 60;
+    for (uint32_t t = 0; t < threads_num; t++) {
+        ASSERT_EQ(0, pthread_timedjoin_np(threads[t], nullptr, &deadline));
+    }
+
+    ASSERT_EQ((size_t)threads_num * per_thread, m_posted.size());
+    std::vector<uint32_t> next(threads_num, 0);
+    for (uint32_t id : m_posted) {
+        uint32_t t = id >> 24;
+        ASSERT_LT(t, threads_num);
+        EXPECT_EQ(next[t], id & 0xFFFFFFU);
+        next[t] = (id & 0xFFFFFFU) + 1;
+    }
+    for (uint32_t t = 0; t < threads_num; t++) {
+        EXPECT_EQ(per_thread, next[t]);
+    }
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <pthread.h>
+#include <vector>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+#include "tcp_base.h"
+
+/**
+ * Software loopback ring (XLIO_RING_LOOPBACK=1) delivers the packets back to
+ * the ring of the sending process, so both peers live in this process: the
+ * server runs in a thread and echoes everything it receives.
+ */
+class tcp_loopback : public tcp_base {
+protected:
+    void SetUp() override
+    {
+        tcp_base::SetUp();
+
+        m_listen_fd = -1;
+        m_echoed = 0;
+
+        SKIP_TRUE(env_value("XLIO_RING_LOOPBACK") != 0, "Software loopback ring is not enabled");
+    }
+    void TearDown() override
+    {
+        if (m_listen_fd >= 0) {
+            close(m_listen_fd);
+        }
+
+        tcp_base::TearDown();
+    }
+
+    static long env_value(const char *name)
+    {
+        const char *value = getenv(name);
+
+        return value ? strtol(value, nullptr, 0) : 0;
+    }
+
+    static uint8_t pattern(size_t offset) { return (uint8_t)(offset * 7 + (offset >> 8)); }
+
+    static void *echo_server(void *arg)
+    {
+        tcp_loopback *self = (tcp_loopback *)arg;
+        std::vector<char> buf(64 * 1024);
+
+        int fd = accept(self->m_listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            log_trace("accept() failed: errno=%d\n", errno);
+            return nullptr;
+        }
+        set_socket_rcv_timeout(fd, 10);
+
+        while (true) {
+            ssize_t rcvd = recv(fd, buf.data(), buf.size(), 0);
+            if (rcvd <= 0) {
+                break;
+            }
+            ssize_t sent = 0;
+            while (sent < rcvd) {
+                ssize_t rc = send(fd, buf.data() + sent, rcvd - sent, MSG_NOSIGNAL);
+                if (rc <= 0) {
+                    break;
+                }
+                sent += rc;
+            }
+            self->m_echoed += sent;
+            if (sent < rcvd) {
+                break;
+            }
+        }
+
+        close(fd);
+        return nullptr;
+    }
+
+    /* Connect to the echo server, send 'size' bytes in 'chunk' sized writes
+     * and verify the echoed stream.
+     */
+    void round_trip(size_t size, size_t chunk)
+    {
+        pthread_t server_thread = 0;
+        std::vector<uint8_t> tx_buf(size);
+        std::vector<uint8_t> rx_buf(size);
+        size_t sent = 0;
+        size_t received = 0;
+        int rc;
+
+        for (size_t i = 0; i < size; i++) {
+            tx_buf[i] = pattern(i);
+        }
+
+        m_listen_fd = tcp_base::sock_create();
+        ASSERT_LE(0, m_listen_fd);
+
+        rc = bind(m_listen_fd, &server_addr.addr, sizeof(server_addr));
+        ASSERT_EQ(0, rc);
+
+        rc = listen(m_listen_fd, 5);
+        ASSERT_EQ(0, rc);
+
+        rc = set_socket_rcv_timeout(m_listen_fd, 10);
+        ASSERT_EQ(0, rc);
+
+        rc = pthread_create(&server_thread, nullptr, echo_server, this);
+        ASSERT_EQ(0, rc);
+
+        int fd = tcp_base::sock_create();
+        EXPECT_LE(0, fd);
+        if (0 <= fd) {
+            rc = set_socket_rcv_timeout(fd, 10);
+            EXPECT_EQ_ERRNO(0, rc);
+
+            /* Both sockets use the server address, so the SYN leaves and comes
+             * back through the same ring.
+             */
+            rc = connect(fd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+            if (0 == rc) {
+                log_trace("Established connection: fd=%d to %s\n", fd,
+                          sys_addr2str(&server_addr.addr));
+
+                /* Interleave non-blocking writes and reads, otherwise both
+                 * directions fill up while neither side reads.
+                 */
+                while (received < size) {
+                    if (sent < size) {
+                        ssize_t rcs = send(fd, tx_buf.data() + sent, std::min(chunk, size - sent),
+                                           MSG_NOSIGNAL | MSG_DONTWAIT);
+                        if (rcs < 0 && (errno == EAGAIN || errno == EINTR)) {
+                            rcs = 0;
+                        }
+                        EXPECT_LE(0, rcs);
+                        if (rcs < 0) {
+                            break;
+                        }
+                        sent += rcs;
+                    }
+                    ssize_t rcs = recv(fd, rx_buf.data() + received, size - received,
+                                       sent < size ? MSG_DONTWAIT : 0);
+                    if (rcs < 0 && (errno == EAGAIN || errno == EINTR)) {
+                        continue;
+                    }
+                    EXPECT_LT(0, rcs);
+                    if (rcs <= 0) {
+                        break;
+                    }
+                    received += rcs;
+                }
+                log_trace("Sent %zu, received %zu\n", sent, received);
+            }
+
+            close(fd);
+        }
+
+        pthread_join(server_thread, nullptr);
+
+        EXPECT_EQ(size, sent);
+        EXPECT_EQ(size, received);
+        EXPECT_EQ(size, m_echoed);
+        EXPECT_TRUE(tx_buf == rx_buf);
+    }
+
+    int m_listen_fd;
+    size_t m_echoed;
+};
+
+/**
+ * @test tcp_loopback.ti_1
+ * @brief
+ *    Small writes round trip over the software loopback ring
+ * @details
+ */
+TEST_F(tcp_loopback, ti_1)
+{
+    round_trip(64 * 1024, 100);
+}
+
+/**
+ * @test tcp_loopback.ti_2
+ * @brief
+ *    Writes larger than the MSS round trip over the software loopback ring
+ * @details
+ *    With XLIO_TSO enabled the ring receives TSO WQEs and segments them by MSS.
+ */
+TEST_F(tcp_loopback, ti_2)
+{
+    round_trip(4 * 1024 * 1024, 256 * 1024);
+}
+
+/**
+ * @test tcp_loopback.ti_3
+ * @brief
+ *    Stream stays intact when the software loopback ring drops packets
+ * @details
+ *    Requires XLIO_RING_LOOPBACK_DROP_RATE, the lost segments are
+ *    retransmitted by TCP.
+ */
+TEST_F(tcp_loopback, ti_3)
+{
+    SKIP_TRUE(env_value("XLIO_RING_LOOPBACK_DROP_RATE") != 0, "Packet drop is not enabled");
+
+    round_trip(1024 * 1024, 16 * 1024);
+}
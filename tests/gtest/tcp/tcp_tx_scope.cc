@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2001-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ *
+ * This software is available to you under a choice of one of two
+ * licenses.  You may choose to be licensed under the terms of the GNU
+ * General Public License (GPL) Version 2, available from the file
+ * COPYING in the main directory of this source tree, or the
+ * BSD license below:
+ *
+ *     Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *      - Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *
+ *      - Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <sys/epoll.h>
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+#include "common/cmn.h"
+#include "tcp_base.h"
+
+/**
+ * With XLIO_RING_TX_DB_COALESCE=1 a thread returning from the iomux with
+ * events keeps its doorbells until it calls the iomux again, unless it
+ * blocks in a socket call before that.
+ */
+class tcp_tx_scope : public tcp_base {
+protected:
+    void SetUp() override
+    {
+        tcp_base::SetUp();
+
+        const char *value = getenv("XLIO_RING_TX_DB_COALESCE");
+        SKIP_TRUE(value && atoi(value), "TX doorbell coalescing is not enabled");
+    }
+
+    int connect_to_server()
+    {
+        int fd = tcp_base::sock_create();
+        if (fd < 0) {
+            return fd;
+        }
+        if (bind(fd, &client_addr.addr, sizeof(client_addr)) != 0 ||
+            connect(fd, &server_addr.addr, sizeof(server_addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+};
+
+/**
+ * @test tcp_tx_scope.ti_1
+ * @brief
+ *    Reply sent after epoll_wait() leaves before a blocking recv() on another
+ *    socket
+ * @details
+ *    The server replies to the request of the front connection and then waits
+ *    in recv() on the back connection. The client answers on the back
+ *    connection only after it received the reply, so the server hangs if the
+ *    reply is held back by the TX scope of the event loop.
+ */
+TEST_F(tcp_tx_scope, ti_1)
+{
+    const char request[] = "request";
+    const char reply[] = "reply";
+    const char release[] = "release";
+
+    int pid = fork();
+    if (0 == pid) { // Child
+        barrier_fork(pid);
+
+        int front = connect_to_server();
+        EXPECT_LE_ERRNO(0, front);
+        int back = connect_to_server();
+        EXPECT_LE_ERRNO(0, back);
+        if (0 <= front && 0 <= back) {
+            char buf[sizeof(reply)] = {0};
+            struct pollfd pfd = {front, POLLIN, 0};
+
+            ssize_t rcs = send(front, request, sizeof(request), 0);
+            EXPECT_EQ_ERRNO((ssize_t)sizeof(request), rcs);
+
+            int rc = poll(&pfd, 1, 3000);
+            EXPECT_EQ(1, rc);
+            if (1 == rc) {
+                rcs = recv(front, buf, sizeof(buf), MSG_WAITALL);
+                EXPECT_EQ_ERRNO((ssize_t)sizeof(reply), rcs);
+                EXPECT_STREQ(reply, buf);
+            }
+
+            // Release the server in any case
+            rcs = send(back, release, sizeof(release), 0);
+            EXPECT_EQ_ERRNO((ssize_t)sizeof(release), rcs);
+            peer_wait(back);
+        }
+        if (0 <= front) {
+            close(front);
+        }
+        if (0 <= back) {
+            close(back);
+        }
+
+        /* This exit is very important, otherwise the fork
+         * keeps running and may duplicate other tests.
+         */
+        exit(testing::Test::HasFailure());
+    } else { /* I am the parent */
+        int l_fd = tcp_base::sock_create();
+        ASSERT_LE(0, l_fd);
+
+        int rc = bind(l_fd, &server_addr.addr, sizeof(server_addr));
+        EXPECT_EQ_ERRNO(0, rc);
+        rc = listen(l_fd, 5);
+        EXPECT_EQ_ERRNO(0, rc);
+        if (0 == rc) {
+            barrier_fork(pid);
+
+            int front = accept(l_fd, nullptr, 0U);
+            EXPECT_LE_ERRNO(0, front);
+            int back = accept(l_fd, nullptr, 0U);
+            EXPECT_LE_ERRNO(0, back);
+            int epfd = epoll_create1(0);
+            EXPECT_LE_ERRNO(0, epfd);
+
+            if (0 <= front && 0 <= back && 0 <= epfd) {
+                struct epoll_event event;
+                char buf[sizeof(release)] = {0};
+
+                rc = set_socket_rcv_timeout(back, 10);
+                EXPECT_EQ_ERRNO(0, rc);
+
+                event.events = EPOLLIN;
+                event.data.fd = front;
+                rc = epoll_ctl(epfd, EPOLL_CTL_ADD, front, &event);
+                EXPECT_EQ_ERRNO(0, rc);
+
+                rc = epoll_wait(epfd, &event, 1, 5000);
+                EXPECT_EQ(1, rc);
+                if (1 == rc) {
+                    ssize_t rcs = recv(front, buf, sizeof(request), MSG_WAITALL);
+                    EXPECT_EQ_ERRNO((ssize_t)sizeof(request), rcs);
+                    rcs = send(front, reply, sizeof(reply), 0);
+                    EXPECT_EQ_ERRNO((ssize_t)sizeof(reply), rcs);
+
+                    // A synchronous call to a backend
+                    rcs = recv(back, buf, sizeof(release), MSG_WAITALL);
+                    EXPECT_EQ_ERRNO((ssize_t)sizeof(release), rcs);
+                    EXPECT_STREQ(release, buf);
+                }
+            }
+            if (0 <= epfd) {
+                close(epfd);
+            }
+            if (0 <= front) {
+                close(front);
+            }
+            if (0 <= back) {
+                close(back);
+            }
+        }
+        close(l_fd);
+
+        EXPECT_EQ(0, wait_fork(pid));
+    }
+}
@@ -31,6 +31,7 @@
  */
 
 #include <sys/mman.h>
+#include <netinet/udp.h>
 #include "common/def.h"
 #include "common/log.h"
 #include "common/sys.h"
@@ -38,6 +39,10 @@
 #include "src/core/util/sock_addr.h"
 #include "udp_base.h"
 
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
 class udp_recv : public udp_base {
 };
 
@@ -148,3 +153,258 @@ TEST_F(udp_recv, mapped_ipv4_recv)
         EXPECT_EQ(0, wait_fork(pid));
     }
 }
+
+/**
+ * @test udp_recv.recvmmsg_waitforone
+ * @brief
+ *    recvmmsg() with MSG_WAITFORONE returns the queued datagrams
+ *
+ * @details
+ *    The call blocks for the first datagram only and returns what is
+ *    queued instead of waiting for vlen datagrams.
+ */
+TEST_F(udp_recv, recvmmsg_waitforone)
+{
+    const int num_sent = 3;
+
+    int pid = fork();
+
+    if (0 == pid) { // Child
+        barrier_fork(pid);
+
+        int fd = udp_base::sock_create();
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            for (int i = 0; i < num_sent; i++) {
+                char buffer[8];
+                memset(buffer, 'a' + i, sizeof(buffer));
+                ssize_t rcs = sendto(fd, buffer, sizeof(buffer), 0, &server_addr.addr,
+                                     sizeof(server_addr));
+                EXPECT_EQ_ERRNO(static_cast<ssize_t>(sizeof(buffer)), rcs);
+            }
+
+            close(fd);
+        }
+
+        // This exit is very important, otherwise the fork
+        // keeps running and may duplicate other tests.
+        exit(testing::Test::HasFailure());
+    } else { // Parent
+        int fd = udp_base::sock_create_to(m_family, false, 10);
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            int rc = bind(fd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+            if (0 == rc) {
+                barrier_fork(pid);
+                EXPECT_EQ(0, wait_fork(pid));
+                usleep(100000);
+
+                const unsigned int vlen = 8;
+                char buffers[vlen][16];
+                iovec vec[vlen];
+                mmsghdr mmsg[vlen];
+                memset(mmsg, 0, sizeof(mmsg));
+                for (unsigned int i = 0; i < vlen; i++) {
+                    vec[i].iov_base = buffers[i];
+                    vec[i].iov_len = sizeof(buffers[i]);
+                    mmsg[i].msg_hdr.msg_iov = &vec[i];
+                    mmsg[i].msg_hdr.msg_iovlen = 1U;
+                }
+
+                rc = recvmmsg(fd, mmsg, vlen, MSG_WAITFORONE, nullptr);
+                EXPECT_EQ_ERRNO(num_sent, rc);
+                for (int i = 0; i < rc && i < num_sent; i++) {
+                    EXPECT_EQ(8U, mmsg[i].msg_len);
+                    EXPECT_EQ('a' + i, buffers[i][0]);
+                    EXPECT_EQ('a' + i, buffers[i][7]);
+                }
+
+                rc = recvmmsg(fd, mmsg, vlen, MSG_DONTWAIT, nullptr);
+                EXPECT_EQ(-1, rc);
+                EXPECT_EQ(EAGAIN, errno);
+            }
+
+            close(fd);
+        }
+    }
+}
+
+/**
+ * @test udp_recv.recvmmsg_timeout
+ * @brief
+ *    recvmmsg() stops at an expired timeout
+ *
+ * @details
+ *    Like the kernel, the timeout is checked after each datagram, so a zero
+ *    timeout returns the first datagram only and leaves the others queued.
+ */
+TEST_F(udp_recv, recvmmsg_timeout)
+{
+    const int num_sent = 4;
+
+    int pid = fork();
+
+    if (0 == pid) { // Child
+        barrier_fork(pid);
+
+        int fd = udp_base::sock_create();
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            for (int i = 0; i < num_sent; i++) {
+                char buffer[8];
+                memset(buffer, 'a' + i, sizeof(buffer));
+                ssize_t rcs = sendto(fd, buffer, sizeof(buffer), 0, &server_addr.addr,
+                                     sizeof(server_addr));
+                EXPECT_EQ_ERRNO(static_cast<ssize_t>(sizeof(buffer)), rcs);
+            }
+
+            close(fd);
+        }
+
+        // This exit is very important, otherwise the fork
+        // keeps running and may duplicate other tests.
+        exit(testing::Test::HasFailure());
+    } else { // Parent
+        int fd = udp_base::sock_create_to(m_family, false, 10);
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            int rc = bind(fd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+            if (0 == rc) {
+                barrier_fork(pid);
+                EXPECT_EQ(0, wait_fork(pid));
+                usleep(100000);
+
+                const unsigned int vlen = num_sent;
+                char buffers[vlen][16];
+                iovec vec[vlen];
+                mmsghdr mmsg[vlen];
+                memset(mmsg, 0, sizeof(mmsg));
+                for (unsigned int i = 0; i < vlen; i++) {
+                    vec[i].iov_base = buffers[i];
+                    vec[i].iov_len = sizeof(buffers[i]);
+                    mmsg[i].msg_hdr.msg_iov = &vec[i];
+                    mmsg[i].msg_hdr.msg_iovlen = 1U;
+                }
+
+                struct timespec timeout = {0, 0};
+                rc = recvmmsg(fd, mmsg, vlen, 0, &timeout);
+                EXPECT_EQ_ERRNO(1, rc);
+                EXPECT_EQ(8U, mmsg[0].msg_len);
+                EXPECT_EQ('a', buffers[0][0]);
+
+                rc = recvmmsg(fd, mmsg, vlen, MSG_DONTWAIT, nullptr);
+                EXPECT_EQ_ERRNO(num_sent - 1, rc);
+                for (int i = 0; i < rc && i < num_sent - 1; i++) {
+                    EXPECT_EQ(8U, mmsg[i].msg_len);
+                    EXPECT_EQ('b' + i, buffers[i][0]);
+                }
+            }
+
+            close(fd);
+        }
+    }
+}
+
+/**
+ * @test udp_recv.udp_gro
+ * @brief
+ *    UDP_GRO cmsg carries the segment size of coalesced datagrams
+ *
+ * @details
+ *    Whether datagrams get coalesced depends on the receive batch, so every
+ *    read is either a single datagram without the cmsg or a multiple of the
+ *    segment size with it. The payload must keep the datagrams order.
+ */
+TEST_F(udp_recv, udp_gro)
+{
+    const int num_sent = 16;
+    const int seg_size = 1000;
+
+    int pid = fork();
+
+    if (0 == pid) { // Child
+        barrier_fork(pid);
+
+        int fd = udp_base::sock_create();
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            for (int i = 0; i < num_sent; i++) {
+                char buffer[seg_size];
+                memset(buffer, 'a' + i, sizeof(buffer));
+                ssize_t rcs = sendto(fd, buffer, sizeof(buffer), 0, &server_addr.addr,
+                                     sizeof(server_addr));
+                EXPECT_EQ_ERRNO(static_cast<ssize_t>(sizeof(buffer)), rcs);
+            }
+
+            close(fd);
+        }
+
+        // This exit is very important, otherwise the fork
+        // keeps running and may duplicate other tests.
+        exit(testing::Test::HasFailure());
+    } else { // Parent
+        int fd = udp_base::sock_create_to(m_family, false, 10);
+        EXPECT_LE_ERRNO(0, fd);
+        if (0 <= fd) {
+            int val = 1;
+            int rc = setsockopt(fd, SOL_UDP, UDP_GRO, &val, sizeof(val));
+            EXPECT_EQ_ERRNO(0, rc);
+
+            rc = bind(fd, &server_addr.addr, sizeof(server_addr));
+            EXPECT_EQ_ERRNO(0, rc);
+            if (0 == rc) {
+                barrier_fork(pid);
+
+                std::vector<char> buf(65536);
+                int received = 0;
+                while (received < num_sent) {
+                    char control[CMSG_SPACE(sizeof(int))];
+                    iovec vec = {.iov_base = buf.data(), .iov_len = buf.size()};
+                    msghdr msg;
+                    msg.msg_iov = &vec;
+                    msg.msg_iovlen = 1U;
+                    msg.msg_name = nullptr;
+                    msg.msg_namelen = 0;
+                    msg.msg_control = control;
+                    msg.msg_controllen = sizeof(control);
+                    msg.msg_flags = 0;
+
+                    ssize_t rcs = recvmsg(fd, &msg, 0);
+                    EXPECT_LT(0, rcs);
+                    if (rcs <= 0) {
+                        break;
+                    }
+
+                    int gro_size = 0;
+                    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg;
+                         cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                            gro_size = *(int *)CMSG_DATA(cmsg);
+                        }
+                    }
+                    log_trace("Received %zd bytes, gro_size=%d\n", rcs, gro_size);
+
+                    if (gro_size) {
+                        EXPECT_EQ(seg_size, gro_size);
+                        EXPECT_EQ(0, rcs % seg_size);
+                    } else {
+                        EXPECT_EQ(seg_size, rcs);
+                    }
+
+                    for (ssize_t off = 0; off < rcs; off += seg_size) {
+                        EXPECT_EQ('a' + received, buf[off]);
+                        EXPECT_EQ('a' + received, buf[std::min<ssize_t>(off + seg_size, rcs) - 1]);
+                        received++;
+                    }
+                }
+                EXPECT_EQ(num_sent, received);
+            }
+
+            close(fd);
+        }
+
+        EXPECT_EQ(0, wait_fork(pid));
+    }
+}
@@ -31,6 +31,7 @@
  */
 
 #include <sys/uio.h>
+#include <netinet/udp.h>
 #include <string>
 #include "common/def.h"
 #include "common/log.h"
@@ -40,6 +41,10 @@
 #include "udp_base.h"
 #include "src/core/util/sock_addr.h"
 
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
 class udp_send : public udp_base {
 };
 
@@ -785,3 +790,196 @@ TEST_F(udp_send, DISABLED_null_iov_elements_fragmented)
         EXPECT_EQ(0, wait_fork(pid));
     }
 }
+
+class udp_send_gso : public udp_base {
+protected:
+    static uint8_t pattern(size_t offset) { return (uint8_t)(offset % 251); }
+
+    /* Child sends 'size' bytes with segment size 'gso_size' taken from the
+     * socket option or from the cmsg, parent checks the datagrams boundaries
+     * and payload.
+     */
+    void check_segments(size_t size, uint16_t gso_size, bool use_cmsg)
+    {
+        int pid = fork();
+        if (0 == pid) { // Child
+            barrier_fork(pid);
+
+            int fd = udp_base::sock_create();
+            EXPECT_LE_ERRNO(0, fd);
+            if (0 <= fd) {
+                std::vector<uint8_t> data(size);
+                for (size_t i = 0; i < size; i++) {
+                    data[i] = pattern(i);
+                }
+
+                iovec vec = {.iov_base = data.data(), .iov_len = data.size()};
+                char control[CMSG_SPACE(sizeof(uint16_t))] = {0};
+                msghdr msg;
+                msg.msg_iov = &vec;
+                msg.msg_iovlen = 1U;
+                msg.msg_name = &server_addr;
+                msg.msg_namelen = sizeof(server_addr);
+                msg.msg_control = nullptr;
+                msg.msg_controllen = 0;
+                msg.msg_flags = 0;
+
+                if (use_cmsg) {
+                    msg.msg_control = control;
+                    msg.msg_controllen = sizeof(control);
+                    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+                    cmsg->cmsg_level = SOL_UDP;
+                    cmsg->cmsg_type = UDP_SEGMENT;
+                    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    *(uint16_t *)CMSG_DATA(cmsg) = gso_size;
+                } else {
+                    int val = gso_size;
+                    int rc = setsockopt(fd, SOL_UDP, UDP_SEGMENT, &val, sizeof(val));
+                    EXPECT_EQ_ERRNO(0, rc);
+                }
+
+                ssize_t rcs = sendmsg(fd, &msg, 0);
+                EXPECT_EQ_ERRNO(static_cast<ssize_t>(size), rcs);
+
+                close(fd);
+            }
+
+            // This exit is very important, otherwise the fork
+            // keeps running and may duplicate other tests.
+            exit(testing::Test::HasFailure());
+        } else { // Parent
+            int fd = udp_base::sock_create_to(m_family, false, 10);
+            EXPECT_LE_ERRNO(0, fd);
+            if (0 <= fd) {
+                int rc = bind(fd, &server_addr.addr, sizeof(server_addr));
+                EXPECT_EQ_ERRNO(0, rc);
+                if (0 == rc) {
+                    barrier_fork(pid);
+
+                    std::vector<uint8_t> buf(65536);
+                    size_t offset = 0;
+                    while (offset < size) {
+                        ssize_t rcs = recv(fd, buf.data(), buf.size(), 0);
+                        EXPECT_EQ_ERRNO(static_cast<ssize_t>(std::min<size_t>(gso_size, size - offset)),
+                                        rcs);
+                        if (rcs <= 0) {
+                            break;
+                        }
+                        for (ssize_t i = 0; i < rcs; i++) {
+                            if (buf[i] != pattern(offset + i)) {
+                                ADD_FAILURE() << "Wrong payload at offset " << offset + i;
+                                break;
+                            }
+                        }
+                        offset += rcs;
+                    }
+                    EXPECT_EQ(size, offset);
+                }
+
+                close(fd);
+            }
+
+            EXPECT_EQ(0, wait_fork(pid));
+        }
+    }
+};
+
+/**
+ * @test udp_send_gso.sockopt
+ * @brief
+ *    UDP_SEGMENT socket option cuts a send into datagrams
+ *
+ * @details
+ *    The last datagram carries the remainder.
+ */
+TEST_F(udp_send_gso, sockopt)
+{
+    check_segments(3500, 1000, false);
+}
+
+/**
+ * @test udp_send_gso.cmsg
+ * @brief
+ *    UDP_SEGMENT cmsg cuts a sendmsg() into datagrams
+ *
+ * @details
+ */
+TEST_F(udp_send_gso, cmsg)
+{
+    check_segments(3000, 1200, true);
+}
+
+/**
+ * @test udp_send_gso.exact_segments
+ * @brief
+ *    Payload which is a multiple of the segment size
+ *
+ * @details
+ */
+TEST_F(udp_send_gso, exact_segments)
+{
+    check_segments(8 * 1000, 1000, false);
+}
+
+/**
+ * @test udp_send_gso.einval
+ * @brief
+ *    Sends the kernel rejects for UDP_SEGMENT
+ *
+ * @details
+ *    A segment which requires IP fragmentation and more segments than
+ *    UDP_MAX_SEGMENTS fail with EINVAL.
+ */
+TEST_F(udp_send_gso, einval)
+{
+    std::vector<char> data(65000);
+
+    int fd = udp_base::sock_create();
+    EXPECT_LE_ERRNO(0, fd);
+    if (0 <= fd) {
+        int rc = connect(fd, &server_addr.addr, sizeof(server_addr));
+        EXPECT_EQ_ERRNO(0, rc);
+
+        int mtu = 0;
+        socklen_t len = sizeof(mtu);
+        if (m_family == AF_INET) {
+            rc = getsockopt(fd, IPPROTO_IP, IP_MTU, &mtu, &len);
+        } else {
+            rc = getsockopt(fd, IPPROTO_IPV6, IPV6_MTU, &mtu, &len);
+        }
+        EXPECT_EQ_ERRNO(0, rc);
+
+        char control[CMSG_SPACE(sizeof(uint16_t))] = {0};
+        iovec vec = {.iov_base = data.data(), .iov_len = 0};
+        msghdr msg;
+        msg.msg_iov = &vec;
+        msg.msg_iovlen = 1U;
+        msg.msg_name = nullptr;
+        msg.msg_namelen = 0;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        msg.msg_flags = 0;
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+
+        // A segment of MTU size does not fit with the headers
+        if (0 < mtu && 2 * mtu <= static_cast<int>(data.size())) {
+            *(uint16_t *)CMSG_DATA(cmsg) = static_cast<uint16_t>(mtu);
+            vec.iov_len = 2 * mtu;
+            ssize_t rcs = sendmsg(fd, &msg, 0);
+            EXPECT_EQ(-1, rcs);
+            EXPECT_EQ(EINVAL, errno);
+        }
+
+        // 200 segments exceed UDP_MAX_SEGMENTS
+        *(uint16_t *)CMSG_DATA(cmsg) = 100;
+        vec.iov_len = 200 * 100;
+        ssize_t rcs = sendmsg(fd, &msg, 0);
+        EXPECT_EQ(-1, rcs);
+        EXPECT_EQ(EINVAL, errno);
+
+        close(fd);
+    }
+}
@@ -0,0 +1,112 @@
+#!/bin/bash
+
+# Check flow steering of the AF_XDP ring (XLIO_RING_XDP=1) over a veth pair.
+#
+# XLIO runs the server on VETH0 in the current network namespace, the client
+# uses the kernel stack on VETH1 in namespace NETNS. iptables drops the test
+# ports on VETH0, so only packets redirected by the XDP program to an AF_XDP
+# socket reach the server, and an echo proves the flow was steered:
+#   CASE 1 - TCP listener (3-tuple flow) and the accepted connection (5-tuple)
+#   CASE 2 - connected UDP socket (5-tuple flow)
+#
+# Requires root, iproute2, ethtool, iptables and python3.
+#
+# Usage Example:
+# export XDP_XLIO_PATH=/usr/lib/libxlio.so
+# sudo -E ./run_test_xdp_veth.sh
+
+#set -x
+
+XLIO_PATH=${XDP_XLIO_PATH:-libxlio.so}
+NETNS=${XDP_NETNS:-xlio_xdp_peer}
+VETH0=${XDP_VETH0:-xlio_xdp0}
+VETH1=${XDP_VETH1:-xlio_xdp1}
+ADDR0=${XDP_ADDR0:-10.199.0.1}
+ADDR1=${XDP_ADDR1:-10.199.0.2}
+PORT=${XDP_PORT:-19397}
+
+SCRIPT_DIR=$(dirname $(realpath $0))
+SRV_PATH=$SCRIPT_DIR/xdp_server.py
+CLT_PATH=$SCRIPT_DIR/xdp_client.py
+
+rc=0
+
+cleanup() {
+	iptables -D INPUT -i $VETH0 -p tcp --dport $PORT -j DROP 2>/dev/null
+	iptables -D INPUT -i $VETH0 -p udp --dport $PORT -j DROP 2>/dev/null
+	ip link del $VETH0 2>/dev/null
+	ip netns del $NETNS 2>/dev/null
+}
+
+setup() {
+	ip netns add $NETNS || return 1
+	ip link add $VETH0 type veth peer name $VETH1 || return 1
+	ip link set $VETH1 netns $NETNS || return 1
+	ip addr add $ADDR0/24 dev $VETH0
+	ip link set $VETH0 up
+	ip netns exec $NETNS ip addr add $ADDR1/24 dev $VETH1
+	ip netns exec $NETNS ip link set $VETH1 up
+	ip netns exec $NETNS ip link set lo up
+	# The AF_XDP ring verifies checksums in software, so the peer must not
+	# leave them to a checksum offload
+	ip netns exec $NETNS ethtool -K $VETH1 tx off >/dev/null || return 1
+	iptables -I INPUT -i $VETH0 -p tcp --dport $PORT -j DROP || return 1
+	iptables -I INPUT -i $VETH0 -p udp --dport $PORT -j DROP || return 1
+	sleep 1
+}
+
+# $1 - case name, $2.. - server arguments, client arguments follow '--'
+run_case() {
+	local name=$1
+	shift
+	local srv_args=()
+	while [ "$1" != "--" ]; do
+		srv_args+=("$1")
+		shift
+	done
+	shift
+
+	echo "$name"
+	env LD_PRELOAD=$XLIO_PATH XLIO_RING_XDP=1 XLIO_RX_UDP_POLL_OS_RATIO=0 \
+		XLIO_LOG_FILE=/tmp/xlio_xdp.log python3 $SRV_PATH "${srv_args[@]}" &
+	local srv_pid=$!
+	sleep 2
+
+	if ! ip link show dev $VETH0 | grep -q "prog/xdp"; then
+		echo "FAILED: no XDP program on $VETH0"
+		rc=$((rc + 1))
+	fi
+
+	if ! ip netns exec $NETNS python3 $CLT_PATH "$@"; then
+		echo "FAILED: $name"
+		rc=$((rc + 1))
+	fi
+
+	if ! wait $srv_pid; then
+		echo "FAILED: $name server"
+		rc=$((rc + 1))
+	fi
+}
+
+for tool in ip ethtool iptables python3; do
+	if ! command -v $tool >/dev/null 2>&1; then
+		echo "[SKIP] $tool tool does not exist"
+		exit 0
+	fi
+done
+
+trap cleanup EXIT
+cleanup
+if ! setup; then
+	echo "[SKIP] failed to set up $VETH0/$VETH1 in $NETNS"
+	exit 0
+fi
+
+run_case "[CASE 1] TCP listener and accepted connection" \
+	tcp $ADDR0 $PORT -- tcp $ADDR0 $PORT
+
+run_case "[CASE 2] Connected UDP socket" \
+	udp $ADDR0 $PORT $ADDR1 $((PORT + 1)) -- udp $ADDR0 $PORT $((PORT + 1))
+
+echo "[${0##*/}] exit code = $rc"
+exit $rc
@@ -0,0 +1,30 @@
+#!/usr/bin/env python3
+# Send a message to <addr>:<port> and expect it echoed back.
+# Exit status is 0 when the echo matches.
+import socket
+import sys
+
+if len(sys.argv) < 4:
+    print("Usage: %s <tcp|udp> <addr> <port> [src-port]" % sys.argv[0])
+    sys.exit(2)
+
+proto = sys.argv[1]
+addr = (sys.argv[2], int(sys.argv[3]))
+msg = b"hello xdp"
+
+sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM if proto == "tcp" else socket.SOCK_DGRAM)
+sock.settimeout(5)
+if len(sys.argv) > 4:
+    sock.bind(("", int(sys.argv[4])))
+try:
+    sock.connect(addr)
+    sock.send(msg)
+    data = sock.recv(64)
+except OSError as e:
+    print("FAILED:", e)
+    sys.exit(1)
+finally:
+    sock.close()
+
+print("Received", len(data), "bytes:", data)
+sys.exit(0 if data == msg else 1)
@@ -0,0 +1,38 @@
+#!/usr/bin/env python3
+# Echo one message back to the peer and exit.
+# TCP: listen on <addr>:<port> (3-tuple flow), the accepted connection is a
+#      5-tuple flow.
+# UDP: bind to <addr>:<port> and connect to <peer-addr>:<peer-port> (5-tuple flow).
+import socket
+import sys
+
+if len(sys.argv) < 4:
+    print("Usage: %s <tcp|udp> <addr> <port> [peer-addr peer-port]" % sys.argv[0])
+    sys.exit(2)
+
+proto = sys.argv[1]
+addr = (sys.argv[2], int(sys.argv[3]))
+
+if proto == "tcp":
+    lsock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    lsock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    lsock.bind(addr)
+    lsock.listen(1)
+    lsock.settimeout(15)
+    sock, peer = lsock.accept()
+    sock.settimeout(15)
+    print("Accepted connection from", peer)
+    data = sock.recv(64)
+    sock.sendall(data)
+    sock.close()
+    lsock.close()
+else:
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(addr)
+    sock.connect((sys.argv[4], int(sys.argv[5])))
+    sock.settimeout(15)
+    data = sock.recv(64)
+    sock.send(data)
+    sock.close()
+
+print("Echoed", len(data), "bytes:", data)